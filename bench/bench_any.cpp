@@ -0,0 +1,95 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/any.h>
+
+#include <any>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using open_cpp_utils::any;
+using open_cpp_utils::any_cast;
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+
+namespace
+{
+
+/// Typical property bag payload: too large for std::any's inline buffer, fits any<48>
+struct transform
+{
+    std::array<float, 10> values{ };
+};
+
+constexpr std::size_t bag_size = 256;
+
+}
+
+OCU_BENCHMARK("any/construct_destroy_40B")(state& s)
+{
+    for(auto _ : s)
+    {
+        any<48> a = transform{ };
+        do_not_optimize(a);
+    }
+}
+
+OCU_BENCHMARK("any/construct_destroy_40B_std")(state& s)
+{
+    for(auto _ : s)
+    {
+        std::any a = transform{ };
+        do_not_optimize(a);
+    }
+}
+
+OCU_BENCHMARK("any/cast_hit")(state& s)
+{
+    std::vector<any<48>> bag(bag_size, transform{ });
+    s.set_ops_per_iteration(bag_size);
+    for(auto _ : s)
+    {
+        float sum = 0;
+        for(auto& a : bag) sum += any_cast<transform>(&a)->values[0];
+        do_not_optimize(sum);
+    }
+}
+
+OCU_BENCHMARK("any/cast_hit_std")(state& s)
+{
+    std::vector<std::any> bag(bag_size, transform{ });
+    s.set_ops_per_iteration(bag_size);
+    for(auto _ : s)
+    {
+        float sum = 0;
+        for(auto& a : bag) sum += std::any_cast<transform>(&a)->values[0];
+        do_not_optimize(sum);
+    }
+}
+
+OCU_BENCHMARK("any/vector_grow_256")(state& s)
+{
+    s.set_ops_per_iteration(bag_size);
+    for(auto _ : s)
+    {
+        std::vector<any<48>> bag;
+        for(std::size_t i = 0; i < bag_size; ++i) bag.emplace_back(transform{ });
+        do_not_optimize(bag.data());
+    }
+}
+
+OCU_BENCHMARK("any/vector_grow_256_std")(state& s)
+{
+    s.set_ops_per_iteration(bag_size);
+    for(auto _ : s)
+    {
+        std::vector<std::any> bag;
+        for(std::size_t i = 0; i < bag_size; ++i) bag.emplace_back(transform{ });
+        do_not_optimize(bag.data());
+    }
+}
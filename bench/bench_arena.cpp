@@ -0,0 +1,77 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/arena.h>
+
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+
+namespace
+{
+
+/// Shape of a typical request handler: a few dozen short-lived vectors and strings that are dropped at the end
+template<typename Vector, typename String>
+std::size_t handle_request(const typename Vector::allocator_type& alloc, const typename String::allocator_type& salloc)
+{
+    std::size_t checksum = 0;
+    for(int i = 0; i < 24; ++i)
+    {
+        Vector values(alloc);
+        for(int j = 0; j < 32; ++j) values.push_back(j * i);
+
+        String text("request-header-value-that-does-not-fit-sso-", salloc);
+        text += static_cast<char>('a' + i);
+        checksum += values.back() + text.size();
+    }
+    return checksum;
+}
+
+}
+
+OCU_BENCHMARK("arena/request_std_allocator")(state& s)
+{
+    for(auto _ : s)
+    {
+        do_not_optimize(handle_request<std::vector<int>, std::string>({ }, { }));
+    }
+}
+
+OCU_BENCHMARK("arena/request_pmr_arena_reset")(state& s)
+{
+    open_cpp_utils::inline_arena<16 * 1024> arena;
+    open_cpp_utils::arena_resource          resource(arena);
+    for(auto _ : s)
+    {
+        do_not_optimize(handle_request<std::pmr::vector<int>, std::pmr::string>(&resource, &resource));
+        arena.reset();
+    }
+}
+
+OCU_BENCHMARK("arena/request_pmr_monotonic_buffer_resource")(state& s)
+{
+    std::byte buffer[16 * 1024];
+    for(auto _ : s)
+    {
+        std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer));
+        do_not_optimize(handle_request<std::pmr::vector<int>, std::pmr::string>(&resource, &resource));
+    }
+}
+
+OCU_BENCHMARK("arena/allocate_64B")(state& s)
+{
+    open_cpp_utils::monotonic_arena arena;
+    std::size_t n = 0;
+    for(auto _ : s)
+    {
+        do_not_optimize(arena.allocate(64, 16));
+        if(++n == 1024) { arena.reset(); n = 0; }
+    }
+}
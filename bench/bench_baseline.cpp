@@ -0,0 +1,40 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+// Reference points for the harness itself and for the global allocator every container is compared against.
+
+#include "harness.h"
+
+#include <memory>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+
+OCU_BENCHMARK("baseline/empty_loop")(state& s)
+{
+    for(auto _ : s) { open_cpp_utils::bench::clobber_memory(); }
+}
+
+OCU_BENCHMARK("baseline/new_delete_64B")(state& s)
+{
+    for(auto _ : s)
+    {
+        auto* p = new std::byte[64];
+        do_not_optimize(p);
+        delete[] p;
+    }
+}
+
+OCU_BENCHMARK("baseline/std_vector_push_back_8")(state& s)
+{
+    s.set_ops_per_iteration(8);
+    for(auto _ : s)
+    {
+        std::vector<int> v;
+        for(int i = 0; i < 8; ++i) v.push_back(i);
+        do_not_optimize(v.data());
+    }
+}
@@ -0,0 +1,186 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/bitset.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::dynamic_bitset;
+using open_cpp_utils::rank_select_index;
+
+namespace
+{
+
+/// A visibility mask over 4M items
+constexpr std::size_t bit_count = std::size_t(1) << 22;
+constexpr std::size_t queries   = 4096;
+
+/// Bits set with probability one in (1 << sparsity)
+std::vector<bool> random_bools(std::uint32_t seed, unsigned sparsity)
+{
+    std::vector<bool> v(bit_count);
+    std::mt19937_64   rng(seed);
+    for(std::size_t i = 0; i < bit_count; ++i) v[i] = (rng() & ((std::uint64_t(1) << sparsity) - 1)) == 0;
+    return v;
+}
+
+dynamic_bitset to_bitset(const std::vector<bool>& v)
+{
+    dynamic_bitset b(v.size());
+    for(std::size_t i = 0; i < v.size(); ++i) b.set(i, v[i]);
+    return b;
+}
+
+const std::vector<bool>& visible()  { static const std::vector<bool> v = random_bools(3, 1); return v; }
+const std::vector<bool>& selected() { static const std::vector<bool> v = random_bools(5, 1); return v; }
+const std::vector<bool>& sparse()   { static const std::vector<bool> v = random_bools(7, 5); return v; }
+
+const std::vector<std::size_t>& positions()
+{
+    static const std::vector<std::size_t> p = []
+    {
+        std::vector<std::size_t> v(queries);
+        std::mt19937_64          rng(9);
+        for(std::size_t& i : v) i = rng() % bit_count;
+        return v;
+    }();
+    return p;
+}
+
+}
+
+OCU_BENCHMARK("bitset/and_4m")(state& s)
+{
+    dynamic_bitset       a = to_bitset(visible());
+    const dynamic_bitset b = to_bitset(selected());
+    s.set_ops_per_iteration(bit_count);
+    for(auto _ : s)
+    {
+        a &= b;
+        do_not_optimize(a.words().data());
+    }
+}
+
+OCU_BENCHMARK("bitset/baseline_vector_bool_and_4m")(state& s)
+{
+    std::vector<bool>        a = visible();
+    const std::vector<bool>& b = selected();
+    s.set_ops_per_iteration(bit_count);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < bit_count; ++i) a[i] = a[i] && b[i];
+        do_not_optimize(a);
+    }
+}
+
+OCU_BENCHMARK("bitset/count_4m")(state& s)
+{
+    const dynamic_bitset a = to_bitset(visible());
+    s.set_ops_per_iteration(bit_count);
+    for(auto _ : s) do_not_optimize(a.count());
+}
+
+OCU_BENCHMARK("bitset/baseline_vector_bool_count_4m")(state& s)
+{
+    const std::vector<bool>& a = visible();
+    s.set_ops_per_iteration(bit_count);
+    for(auto _ : s) do_not_optimize(std::count(a.begin(), a.end(), true));
+}
+
+OCU_BENCHMARK("bitset/scalar_count_4m")(state& s)
+{
+    const dynamic_bitset a = to_bitset(visible());
+    s.set_ops_per_iteration(bit_count);
+    for(auto _ : s)
+    {
+        do_not_optimize(open_cpp_utils::detail::scalar_bitset_kernels.popcount(a.words().data(), a.word_count()));
+    }
+}
+
+OCU_BENCHMARK("bitset/for_each_set_bit_sparse_4m")(state& s)
+{
+    const dynamic_bitset a   = to_bitset(sparse());
+    std::size_t          sum = 0;
+    s.set_ops_per_iteration(bit_count);
+    for(auto _ : s) a.for_each_set_bit([&](std::size_t i) { sum += i; });
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("bitset/baseline_vector_bool_scan_sparse_4m")(state& s)
+{
+    const std::vector<bool>& a   = sparse();
+    std::size_t              sum = 0;
+    s.set_ops_per_iteration(bit_count);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < bit_count; ++i)
+        {
+            if(a[i]) sum += i;
+        }
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("bitset/rank")(state& s)
+{
+    const dynamic_bitset    a = to_bitset(visible());
+    const rank_select_index ix(a);
+    std::size_t             sum = 0;
+    s.set_ops_per_iteration(queries);
+    for(auto _ : s)
+    {
+        for(std::size_t i : positions()) sum += ix.rank(i);
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("bitset/select")(state& s)
+{
+    const dynamic_bitset    a = to_bitset(visible());
+    const rank_select_index ix(a);
+    std::size_t             sum = 0;
+    s.set_ops_per_iteration(queries);
+    for(auto _ : s)
+    {
+        for(std::size_t i : positions()) sum += ix.select(i % ix.count());
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("bitset/baseline_popcount_scan_select")(state& s)
+{
+    const dynamic_bitset a     = to_bitset(visible());
+    const auto           words = a.words();
+    const std::size_t    ones  = a.count();
+    std::size_t          sum   = 0;
+    s.set_ops_per_iteration(queries / 64);
+    for(auto _ : s)
+    {
+        for(std::size_t q = 0; q < queries / 64; ++q)
+        {
+            std::size_t k = positions()[q] % ones;
+            std::size_t w = 0;
+            for(std::size_t c; k >= (c = static_cast<std::size_t>(std::popcount(words[w]))); ++w) k -= c;
+            sum += w * 64 + open_cpp_utils::detail::select_in_word(words[w], static_cast<unsigned>(k));
+        }
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("bitset/build_rank_select_index")(state& s)
+{
+    const dynamic_bitset a = to_bitset(visible());
+    s.set_ops_per_iteration(bit_count);
+    for(auto _ : s) do_not_optimize(rank_select_index(a).count());
+}
@@ -0,0 +1,201 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/cache.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::cache;
+using open_cpp_utils::cache_policy;
+using open_cpp_utils::concurrent_cache;
+
+namespace
+{
+
+constexpr std::size_t capacity = std::size_t(1) << 16;
+constexpr std::size_t accesses = 4096;
+
+/// The list + unordered_map LRU every team writes: two allocations per entry and a node hop per access
+class std_lru
+{
+public:
+    explicit std_lru(std::size_t capacity) : capacity_(capacity) { }
+
+    std::uint64_t* find(std::uint64_t key)
+    {
+        const auto it = index_.find(key);
+        if(it == index_.end()) return nullptr;
+        order_.splice(order_.begin(), order_, it->second);
+        return &it->second->second;
+    }
+
+    void insert(std::uint64_t key, std::uint64_t value)
+    {
+        if(std::uint64_t* v = find(key))
+        {
+            *v = value;
+            return;
+        }
+        order_.emplace_front(key, value);
+        index_.emplace(key, order_.begin());
+        if(index_.size() > capacity_)
+        {
+            index_.erase(order_.back().first);
+            order_.pop_back();
+        }
+    }
+
+private:
+    using list_type = std::list<std::pair<std::uint64_t, std::uint64_t>>;
+
+    std::size_t                                              capacity_;
+    list_type                                                order_;
+    std::unordered_map<std::uint64_t, list_type::iterator>   index_;
+};
+
+/// Spreads dense ranks over 64 bits like real ids, which std::hash's identity mapping cannot exploit
+constexpr std::uint64_t id(std::uint64_t rank) noexcept { return rank * 0x9E3779B97F4A7C15ull; }
+
+/// Keys drawn so that their popularity falls off like a power law, over 16 times more keys than fit
+const std::vector<std::uint64_t>& skewed_keys()
+{
+    static const std::vector<std::uint64_t> k = []
+    {
+        std::vector<std::uint64_t>             v(accesses * 16);
+        std::mt19937_64                        rng(3);
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        for(std::uint64_t& key : v) key = id(static_cast<std::uint64_t>(std::pow(double(capacity * 16), u(rng))));
+        return v;
+    }();
+    return k;
+}
+
+/// Keys that are all resident, in random order
+const std::vector<std::uint64_t>& hit_keys()
+{
+    static const std::vector<std::uint64_t> k = []
+    {
+        std::vector<std::uint64_t> v(accesses);
+        std::mt19937_64            rng(5);
+        for(std::uint64_t& key : v) key = id(rng() % capacity);
+        return v;
+    }();
+    return k;
+}
+
+}
+
+OCU_BENCHMARK("cache/lru_find_hit")(state& s)
+{
+    cache<std::uint64_t, std::uint64_t> c(capacity);
+    for(std::uint64_t k = 0; k < capacity; ++k) c.insert(id(k), k);
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(accesses);
+    for(auto _ : s)
+    {
+        for(std::uint64_t k : hit_keys()) sum += *c.find(k);
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("cache/tiny_lfu_find_hit")(state& s)
+{
+    cache<std::uint64_t, std::uint64_t> c(capacity, cache_policy::tiny_lfu);
+    for(std::uint64_t k = 0; k < capacity; ++k) c.insert(id(k), k);
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(accesses);
+    for(auto _ : s)
+    {
+        for(std::uint64_t k : hit_keys())
+        {
+            if(const std::uint64_t* v = c.find(k)) sum += *v;
+        }
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("cache/baseline_std_list_lru_find_hit")(state& s)
+{
+    std_lru c(capacity);
+    for(std::uint64_t k = 0; k < capacity; ++k) c.insert(id(k), k);
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(accesses);
+    for(auto _ : s)
+    {
+        for(std::uint64_t k : hit_keys()) sum += *c.find(k);
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("cache/lru_skewed_get_or_insert")(state& s)
+{
+    cache<std::uint64_t, std::uint64_t> c(capacity);
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(skewed_keys().size());
+    for(auto _ : s)
+    {
+        for(std::uint64_t k : skewed_keys()) sum += *c.get_or_insert(k, [k] { return k; });
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("cache/tiny_lfu_skewed_get_or_insert")(state& s)
+{
+    cache<std::uint64_t, std::uint64_t> c(capacity, cache_policy::tiny_lfu);
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(skewed_keys().size());
+    for(auto _ : s)
+    {
+        for(std::uint64_t k : skewed_keys())
+        {
+            if(const std::uint64_t* v = c.get_or_insert(k, [k] { return k; })) sum += *v;
+        }
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("cache/baseline_std_list_lru_skewed_get_or_insert")(state& s)
+{
+    std_lru       c(capacity);
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(skewed_keys().size());
+    for(auto _ : s)
+    {
+        for(std::uint64_t k : skewed_keys())
+        {
+            if(const std::uint64_t* v = c.find(k)) sum += *v;
+            else c.insert(k, k);
+        }
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("cache/concurrent_find_hit")(state& s)
+{
+    // The budget is split evenly over the shards but keys are not, so leave headroom for every key to stay resident
+    concurrent_cache<std::uint64_t, std::uint64_t> c(2 * capacity);
+    for(std::uint64_t k = 0; k < capacity; ++k) c.insert(id(k), k);
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(accesses);
+    for(auto _ : s)
+    {
+        for(std::uint64_t k : hit_keys())
+        {
+            if(const auto v = c.find(k)) sum += *v;
+        }
+    }
+    do_not_optimize(sum);
+}
@@ -0,0 +1,113 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/concurrent_hash_map.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::concurrent_hash_map;
+
+namespace
+{
+
+/// 64K entries: a lookup cache that fits in L2 of most server cores
+constexpr std::uint64_t key_count = 1u << 16;
+
+/// Lookups per iteration of the threaded runs, large enough to amortize waking and joining 32 threads
+constexpr std::uint64_t lookups_per_iteration = 1u << 16;
+
+std::uint64_t key_at(std::uint64_t i) { return (i * 0x9E3779B97F4A7C15ull) % key_count; }
+
+class sharded_map
+{
+public:
+    sharded_map() { for(std::uint64_t k = 0; k < key_count; ++k) map_.insert_or_assign(k, k); }
+
+    std::uint64_t find(std::uint64_t k) const { return map_.find(k).value_or(0); }
+
+private:
+    concurrent_hash_map<std::uint64_t, std::uint64_t> map_;
+};
+
+/// The structure the map replaces: a std::unordered_map behind a std::shared_mutex
+class locked_map
+{
+public:
+    locked_map() { for(std::uint64_t k = 0; k < key_count; ++k) map_.emplace(k, k); }
+
+    std::uint64_t find(std::uint64_t k) const
+    {
+        std::shared_lock lock(mutex_);
+        const auto it = map_.find(k);
+        return it == map_.end() ? 0 : it->second;
+    }
+
+private:
+    mutable std::shared_mutex                        mutex_;
+    std::unordered_map<std::uint64_t, std::uint64_t> map_;
+};
+
+/**
+ * Performs state.iterations() * lookups_per_iteration lookups of present keys split over Threads readers. Every
+ * thread is running before the clock starts. Results are per lookup, so linear scaling shows as the time per
+ * operation dividing by the thread count up to the number of cores.
+ */
+template<typename Map, int Threads>
+void run_reads(state& s)
+{
+    s.set_ops_per_iteration(lookups_per_iteration);
+    const std::uint64_t total = s.iterations() * lookups_per_iteration;
+    const Map           map;
+
+    std::atomic<bool>        go{ false };
+    std::atomic<int>         ready{ 0 };
+    std::vector<std::thread> threads;
+    threads.reserve(Threads);
+
+    for(int t = 0; t < Threads; ++t)
+    {
+        threads.emplace_back([&, t]
+        {
+            ready.fetch_add(1, std::memory_order_relaxed);
+            while(!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            const std::uint64_t begin = total * t / Threads;
+            const std::uint64_t end   = total * (t + 1) / Threads;
+            std::uint64_t       sum   = 0;
+            for(std::uint64_t i = begin; i < end; ++i) sum += map.find(key_at(i));
+            do_not_optimize(sum);
+        });
+    }
+
+    while(ready.load(std::memory_order_relaxed) < Threads) std::this_thread::yield();
+    auto timed = s.timed();
+    go.store(true, std::memory_order_release);
+    for(auto& t : threads) t.join();
+}
+
+}
+
+OCU_BENCHMARK("concurrent_hash_map/reads_threads_1")(state& s)  { run_reads<sharded_map, 1>(s); }
+OCU_BENCHMARK("concurrent_hash_map/reads_threads_2")(state& s)  { run_reads<sharded_map, 2>(s); }
+OCU_BENCHMARK("concurrent_hash_map/reads_threads_4")(state& s)  { run_reads<sharded_map, 4>(s); }
+OCU_BENCHMARK("concurrent_hash_map/reads_threads_8")(state& s)  { run_reads<sharded_map, 8>(s); }
+OCU_BENCHMARK("concurrent_hash_map/reads_threads_16")(state& s) { run_reads<sharded_map, 16>(s); }
+OCU_BENCHMARK("concurrent_hash_map/reads_threads_32")(state& s) { run_reads<sharded_map, 32>(s); }
+
+OCU_BENCHMARK("concurrent_hash_map/baseline_shared_mutex_reads_threads_1")(state& s)  { run_reads<locked_map, 1>(s); }
+OCU_BENCHMARK("concurrent_hash_map/baseline_shared_mutex_reads_threads_2")(state& s)  { run_reads<locked_map, 2>(s); }
+OCU_BENCHMARK("concurrent_hash_map/baseline_shared_mutex_reads_threads_4")(state& s)  { run_reads<locked_map, 4>(s); }
+OCU_BENCHMARK("concurrent_hash_map/baseline_shared_mutex_reads_threads_8")(state& s)  { run_reads<locked_map, 8>(s); }
+OCU_BENCHMARK("concurrent_hash_map/baseline_shared_mutex_reads_threads_16")(state& s) { run_reads<locked_map, 16>(s); }
+OCU_BENCHMARK("concurrent_hash_map/baseline_shared_mutex_reads_threads_32")(state& s) { run_reads<locked_map, 32>(s); }
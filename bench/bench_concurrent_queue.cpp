@@ -0,0 +1,232 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/concurrent_queue.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::mpmc_queue;
+using open_cpp_utils::spsc_queue;
+
+namespace
+{
+
+constexpr std::size_t queue_capacity = 1024;
+constexpr std::size_t batch_size     = 32;
+
+/// Items moved per iteration of the threaded runs, large enough to amortize waking and joining 64 threads
+constexpr std::uint64_t items_per_iteration = 4096;
+
+/// The structure the queues replace: a std::deque guarded by a std::mutex
+class locked_queue
+{
+public:
+    explicit locked_queue(std::size_t) { }
+
+    bool try_push(std::uint64_t v)
+    {
+        std::lock_guard lock(mutex_);
+        items_.push_back(v);
+        return true;
+    }
+
+    bool try_pop(std::uint64_t& v)
+    {
+        std::lock_guard lock(mutex_);
+        if(items_.empty()) return false;
+        v = items_.front();
+        items_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex                mutex_;
+    std::deque<std::uint64_t> items_;
+};
+
+/**
+ * Moves state.iterations() * items_per_iteration items through Queue with Threads / 2 producers and Threads / 2
+ * consumers (a single thread alternates push and pop). Every thread is running before the clock starts, and threads
+ * yield whenever the queue is full or empty so oversubscribed runs measure the queue rather than the scheduler.
+ */
+template<typename Queue, int Threads>
+void run_throughput(state& s)
+{
+    s.set_ops_per_iteration(items_per_iteration);
+    const std::uint64_t total = s.iterations() * items_per_iteration;
+    Queue queue(queue_capacity);
+
+    if constexpr(Threads == 1)
+    {
+        auto timed = s.timed();
+        std::uint64_t sum = 0;
+        for(std::uint64_t i = 0; i < total; ++i)
+        {
+            static_cast<void>(queue.try_push(i));
+            std::uint64_t v;
+            if(queue.try_pop(v)) sum += v;
+        }
+        do_not_optimize(sum);
+        return;
+    }
+    else
+    {
+        constexpr int producers = Threads / 2;
+        constexpr int consumers = Threads - producers;
+
+        std::atomic<bool>          go{ false };
+        std::atomic<int>           ready{ 0 };
+        std::atomic<std::uint64_t> consumed{ 0 };
+        std::vector<std::thread>   threads;
+        threads.reserve(Threads);
+
+        for(int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]
+            {
+                ready.fetch_add(1, std::memory_order_relaxed);
+                while(!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                const std::uint64_t begin = total * p / producers;
+                const std::uint64_t end   = total * (p + 1) / producers;
+                for(std::uint64_t i = begin; i < end; ++i)
+                {
+                    while(!queue.try_push(i)) std::this_thread::yield();
+                }
+            });
+        }
+
+        for(int c = 0; c < consumers; ++c)
+        {
+            threads.emplace_back([&]
+            {
+                ready.fetch_add(1, std::memory_order_relaxed);
+                while(!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                std::uint64_t sum = 0;
+                std::uint64_t v;
+                while(consumed.load(std::memory_order_relaxed) < total)
+                {
+                    if(queue.try_pop(v))
+                    {
+                        sum += v;
+                        consumed.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                do_not_optimize(sum);
+            });
+        }
+
+        while(ready.load(std::memory_order_relaxed) < Threads) std::this_thread::yield();
+        auto timed = s.timed();
+        go.store(true, std::memory_order_release);
+        for(auto& t : threads) t.join();
+    }
+}
+
+/// Same shape as run_throughput but producers and consumers move batch_size items per call
+template<int Threads>
+void run_batched(state& s)
+{
+    s.set_ops_per_iteration(items_per_iteration);
+    const std::uint64_t total = s.iterations() * items_per_iteration;
+    mpmc_queue<std::uint64_t> queue(queue_capacity);
+
+    constexpr int producers = Threads / 2 > 0 ? Threads / 2 : 1;
+    constexpr int consumers = Threads - producers > 0 ? Threads - producers : 1;
+
+    std::atomic<bool>          go{ false };
+    std::atomic<int>           ready{ 0 };
+    std::atomic<std::uint64_t> consumed{ 0 };
+    std::vector<std::thread>   threads;
+
+    for(int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&, p]
+        {
+            ready.fetch_add(1, std::memory_order_relaxed);
+            while(!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            std::array<std::uint64_t, batch_size> items;
+            std::uint64_t i   = total * p / producers;
+            std::uint64_t end = total * (p + 1) / producers;
+            while(i < end)
+            {
+                const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(batch_size, end - i));
+                for(std::size_t k = 0; k < n; ++k) items[k] = i + k;
+
+                std::size_t pushed = 0;
+                while(pushed < n)
+                {
+                    const std::size_t r = queue.try_push_n(items.begin() + pushed, n - pushed);
+                    if(r == 0) std::this_thread::yield();
+                    pushed += r;
+                }
+                i += n;
+            }
+        });
+    }
+
+    for(int c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&]
+        {
+            ready.fetch_add(1, std::memory_order_relaxed);
+            while(!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            std::array<std::uint64_t, batch_size> items;
+            std::uint64_t sum = 0;
+            while(consumed.load(std::memory_order_relaxed) < total)
+            {
+                const std::size_t n = queue.try_pop_n(items.begin(), batch_size);
+                if(n == 0) { std::this_thread::yield(); continue; }
+                for(std::size_t k = 0; k < n; ++k) sum += items[k];
+                consumed.fetch_add(n, std::memory_order_relaxed);
+            }
+            do_not_optimize(sum);
+        });
+    }
+
+    while(ready.load(std::memory_order_relaxed) < producers + consumers) std::this_thread::yield();
+    auto timed = s.timed();
+    go.store(true, std::memory_order_release);
+    for(auto& t : threads) t.join();
+}
+
+}
+
+OCU_BENCHMARK("concurrent_queue/mpmc_threads_1")(state& s)  { run_throughput<mpmc_queue<std::uint64_t>, 1>(s); }
+OCU_BENCHMARK("concurrent_queue/mpmc_threads_2")(state& s)  { run_throughput<mpmc_queue<std::uint64_t>, 2>(s); }
+OCU_BENCHMARK("concurrent_queue/mpmc_threads_4")(state& s)  { run_throughput<mpmc_queue<std::uint64_t>, 4>(s); }
+OCU_BENCHMARK("concurrent_queue/mpmc_threads_8")(state& s)  { run_throughput<mpmc_queue<std::uint64_t>, 8>(s); }
+OCU_BENCHMARK("concurrent_queue/mpmc_threads_16")(state& s) { run_throughput<mpmc_queue<std::uint64_t>, 16>(s); }
+OCU_BENCHMARK("concurrent_queue/mpmc_threads_32")(state& s) { run_throughput<mpmc_queue<std::uint64_t>, 32>(s); }
+OCU_BENCHMARK("concurrent_queue/mpmc_threads_64")(state& s) { run_throughput<mpmc_queue<std::uint64_t>, 64>(s); }
+
+OCU_BENCHMARK("concurrent_queue/mpmc_batch32_threads_2")(state& s)  { run_batched<2>(s); }
+OCU_BENCHMARK("concurrent_queue/mpmc_batch32_threads_8")(state& s)  { run_batched<8>(s); }
+OCU_BENCHMARK("concurrent_queue/mpmc_batch32_threads_64")(state& s) { run_batched<64>(s); }
+
+OCU_BENCHMARK("concurrent_queue/spsc_threads_1")(state& s) { run_throughput<spsc_queue<std::uint64_t>, 1>(s); }
+OCU_BENCHMARK("concurrent_queue/spsc_threads_2")(state& s) { run_throughput<spsc_queue<std::uint64_t>, 2>(s); }
+
+OCU_BENCHMARK("concurrent_queue/mutex_deque_threads_1")(state& s)  { run_throughput<locked_queue, 1>(s); }
+OCU_BENCHMARK("concurrent_queue/mutex_deque_threads_2")(state& s)  { run_throughput<locked_queue, 2>(s); }
+OCU_BENCHMARK("concurrent_queue/mutex_deque_threads_4")(state& s)  { run_throughput<locked_queue, 4>(s); }
+OCU_BENCHMARK("concurrent_queue/mutex_deque_threads_8")(state& s)  { run_throughput<locked_queue, 8>(s); }
+OCU_BENCHMARK("concurrent_queue/mutex_deque_threads_16")(state& s) { run_throughput<locked_queue, 16>(s); }
+OCU_BENCHMARK("concurrent_queue/mutex_deque_threads_32")(state& s) { run_throughput<locked_queue, 32>(s); }
+OCU_BENCHMARK("concurrent_queue/mutex_deque_threads_64")(state& s) { run_throughput<locked_queue, 64>(s); }
@@ -0,0 +1,163 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/coro.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::default_thread_pool;
+using open_cpp_utils::generator;
+using open_cpp_utils::monotonic_arena;
+using open_cpp_utils::schedule_on;
+using open_cpp_utils::sync_wait;
+using open_cpp_utils::task;
+using open_cpp_utils::thread_pool;
+using open_cpp_utils::when_all;
+
+namespace
+{
+
+constexpr std::size_t chain   = 1024;
+constexpr std::size_t fan_out = 64;
+
+task<std::uint64_t> leaf(std::uint64_t x)
+{
+    co_return x * 3 + 1;
+}
+
+task<std::uint64_t> leaf(std::allocator_arg_t, monotonic_arena&, std::uint64_t x)
+{
+    co_return x * 3 + 1;
+}
+
+task<std::uint64_t> sequence(std::size_t n)
+{
+    std::uint64_t sum = 0;
+    for(std::size_t i = 0; i < n; ++i) sum += co_await leaf(i);
+    co_return sum;
+}
+
+task<std::uint64_t> sequence(monotonic_arena& arena, std::size_t n)
+{
+    std::uint64_t sum = 0;
+    for(std::size_t i = 0; i < n; ++i) sum += co_await leaf(std::allocator_arg, arena, i);
+    co_return sum;
+}
+
+task<std::uint64_t> on_pool(thread_pool& pool, std::uint64_t x)
+{
+    co_await schedule_on(pool);
+    co_return x * 3 + 1;
+}
+
+generator<std::uint64_t> numbers(std::size_t n)
+{
+    for(std::uint64_t i = 0; i < n; ++i) co_yield i;
+}
+
+}
+
+OCU_BENCHMARK("coro/task_await_1024")(state& s)
+{
+    thread_pool&  pool = default_thread_pool();
+    std::uint64_t sum  = 0;
+    s.set_ops_per_iteration(chain);
+    for(auto _ : s) sum += sync_wait(sequence(chain), pool);
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("coro/task_await_arena_1024")(state& s)
+{
+    thread_pool&    pool = default_thread_pool();
+    monotonic_arena arena;
+    std::uint64_t   sum  = 0;
+    s.set_ops_per_iteration(chain);
+    for(auto _ : s)
+    {
+        sum += sync_wait(sequence(arena, chain), pool);
+        arena.reset();
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("coro/baseline_promise_future_1024")(state& s)
+{
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(chain);
+    for(auto _ : s)
+    {
+        for(std::uint64_t i = 0; i < chain; ++i)
+        {
+            std::promise<std::uint64_t> p;
+            std::future<std::uint64_t>  f = p.get_future();
+            p.set_value(i * 3 + 1);
+            sum += f.get();
+        }
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("coro/when_all_pool_64")(state& s)
+{
+    thread_pool&  pool = default_thread_pool();
+    std::uint64_t sum  = 0;
+    s.set_ops_per_iteration(fan_out);
+    for(auto _ : s)
+    {
+        std::vector<task<std::uint64_t>> tasks;
+        tasks.reserve(fan_out);
+        for(std::uint64_t i = 0; i < fan_out; ++i) tasks.push_back(on_pool(pool, i));
+        for(std::uint64_t v : sync_wait(when_all(std::move(tasks)), pool)) sum += v;
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("coro/baseline_pool_submit_64")(state& s)
+{
+    thread_pool&  pool = default_thread_pool();
+    std::uint64_t sum  = 0;
+    s.set_ops_per_iteration(fan_out);
+    for(auto _ : s)
+    {
+        std::vector<std::future<std::uint64_t>> futures;
+        futures.reserve(fan_out);
+        for(std::uint64_t i = 0; i < fan_out; ++i) futures.push_back(pool.submit([i] { return i * 3 + 1; }));
+        for(std::future<std::uint64_t>& f : futures) sum += f.get();
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("coro/generator_1024")(state& s)
+{
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(chain);
+    for(auto _ : s)
+    {
+        for(std::uint64_t v : numbers(chain)) sum += v;
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("coro/baseline_std_function_callback_1024")(state& s)
+{
+    std::uint64_t                      sum  = 0;
+    std::function<void(std::uint64_t)> sink = [&sum](std::uint64_t v) { sum += v; };
+    s.set_ops_per_iteration(chain);
+    for(auto _ : s)
+    {
+        for(std::uint64_t i = 0; i < chain; ++i) sink(i);
+        do_not_optimize(sink);
+    }
+    do_not_optimize(sum);
+}
@@ -0,0 +1,120 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/directed_tree.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::directed_tree;
+using open_cpp_utils::tree_node;
+
+namespace
+{
+
+constexpr std::size_t node_count = 1 << 16;
+
+struct transform
+{
+    float local[4];
+    float world[4];
+};
+
+/// The pointer-chasing hierarchy directed_tree replaces; every node is its own allocation
+struct pointer_node
+{
+    transform                                  value{ };
+    pointer_node*                              parent = nullptr;
+    std::vector<std::unique_ptr<pointer_node>> children;
+};
+
+/// Parent of node i in both hierarchies; attaching to random earlier nodes scatters siblings across storage
+const std::vector<std::uint32_t>& parents()
+{
+    static const std::vector<std::uint32_t> p = []
+    {
+        std::vector<std::uint32_t> v(node_count);
+        std::mt19937 rng(7);
+        for(std::size_t i = 1; i < node_count; ++i) v[i] = static_cast<std::uint32_t>(rng() % i);
+        return v;
+    }();
+    return p;
+}
+
+directed_tree<transform> build_tree()
+{
+    directed_tree<transform> tree;
+    std::vector<tree_node> nodes(node_count);
+    nodes[0] = tree.emplace_root();
+    for(std::size_t i = 1; i < node_count; ++i) nodes[i] = tree.emplace_child(nodes[parents()[i]]);
+    return tree;
+}
+
+float propagate(directed_tree<transform>& tree)
+{
+    float sum = 0;
+    for(tree_node n : tree.preorder())
+    {
+        transform&      t = tree[n];
+        const tree_node p = tree.parent(n);
+        t.world[0] = t.local[0] + (p ? tree[p].world[0] : 0.0f);
+        sum += t.world[0];
+    }
+    return sum;
+}
+
+float propagate(pointer_node& n, float parent_world)
+{
+    n.value.world[0] = n.value.local[0] + parent_world;
+    float sum = n.value.world[0];
+    for(auto& c : n.children) sum += propagate(*c, n.value.world[0]);
+    return sum;
+}
+
+}
+
+OCU_BENCHMARK("directed_tree/preorder_scattered_64k")(state& s)
+{
+    auto tree = build_tree();
+    s.set_ops_per_iteration(node_count);
+    for(auto _ : s) do_not_optimize(propagate(tree));
+}
+
+OCU_BENCHMARK("directed_tree/preorder_compacted_64k")(state& s)
+{
+    auto tree = build_tree();
+    tree.compact();
+    s.set_ops_per_iteration(node_count);
+    for(auto _ : s) do_not_optimize(propagate(tree));
+}
+
+OCU_BENCHMARK("directed_tree/baseline_pointer_tree_64k")(state& s)
+{
+    std::vector<pointer_node*> nodes(node_count);
+    auto root = std::make_unique<pointer_node>();
+    nodes[0] = root.get();
+    for(std::size_t i = 1; i < node_count; ++i)
+    {
+        pointer_node* p = nodes[parents()[i]];
+        p->children.push_back(std::make_unique<pointer_node>());
+        nodes[i] = p->children.back().get();
+        nodes[i]->parent = p;
+    }
+
+    s.set_ops_per_iteration(node_count);
+    for(auto _ : s) do_not_optimize(propagate(*root, 0.0f));
+}
+
+OCU_BENCHMARK("directed_tree/build_64k")(state& s)
+{
+    s.set_ops_per_iteration(node_count);
+    for(auto _ : s) do_not_optimize(build_tree().size());
+}
@@ -0,0 +1,211 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/filesystem.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using open_cpp_utils::access_pattern;
+using open_cpp_utils::async_file;
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::directory_snapshot;
+using open_cpp_utils::file_mode;
+using open_cpp_utils::io_backend;
+using open_cpp_utils::io_queue;
+using open_cpp_utils::mapped_file;
+using open_cpp_utils::scan_directory;
+
+namespace
+{
+
+constexpr std::size_t file_size = std::size_t(16) << 20;
+constexpr std::size_t stride    = 4096;
+constexpr std::size_t batch     = 1024;
+
+/// A 16 MiB scratch file in the temp directory, written once and reused by every benchmark
+const std::filesystem::path& scratch_file()
+{
+    static const std::filesystem::path path = []
+    {
+        auto p = std::filesystem::temp_directory_path() / "open_cpp_utils_bench_mapped.bin";
+        std::vector<char> data(file_size);
+        for(std::size_t i = 0; i < data.size(); ++i) data[i] = static_cast<char>(i * 31);
+        std::ofstream(p, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+        return p;
+    }();
+    return path;
+}
+
+/// Touches one byte per page, which is what faults a mapping in
+std::uint64_t touch_pages(const std::byte* data, std::size_t size)
+{
+    std::uint64_t sum = 0;
+    for(std::size_t i = 0; i < size; i += stride) sum += static_cast<std::uint64_t>(data[i]);
+    return sum;
+}
+
+/// Page-aligned offsets of the random 4 KiB reads every async benchmark issues
+const std::vector<std::uint64_t>& read_offsets()
+{
+    static const std::vector<std::uint64_t> offsets = []
+    {
+        std::vector<std::uint64_t> v(batch);
+        std::mt19937_64 rng(11);
+        for(auto& o : v) o = (rng() % (file_size / stride)) * stride;
+        return v;
+    }();
+    return offsets;
+}
+
+/// 64 directories of 32 subdirectories of 8 files each: 16k files, 18k entries
+const std::filesystem::path& scratch_tree()
+{
+    static const std::filesystem::path root = []
+    {
+        auto r = std::filesystem::temp_directory_path() / "open_cpp_utils_bench_tree";
+        std::filesystem::remove_all(r);
+        for(int a = 0; a < 64; ++a)
+        {
+            for(int b = 0; b < 32; ++b)
+            {
+                const auto dir = r / std::to_string(a) / std::to_string(b);
+                std::filesystem::create_directories(dir);
+                for(int f = 0; f < 8; ++f) std::ofstream(dir / ("asset" + std::to_string(f) + ".bin")) << f;
+            }
+        }
+        return r;
+    }();
+    return root;
+}
+
+void random_reads(state& s, io_backend backend)
+{
+    io_queue   queue({ .depth = 256, .backend = backend });
+    async_file file(queue, scratch_file(), file_mode::read);
+
+    std::vector<std::byte>     buffers(batch * stride);
+    std::atomic<std::uint64_t> sum{ 0 };
+
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            std::byte* buffer = buffers.data() + i * stride;
+            file.read(read_offsets()[i], { buffer, stride }, [&sum, buffer](std::error_code, std::size_t)
+            {
+                sum.fetch_add(static_cast<std::uint64_t>(buffer[0]), std::memory_order_relaxed);
+            });
+        }
+        queue.drain();
+    }
+    do_not_optimize(sum.load());
+}
+
+}
+
+OCU_BENCHMARK("filesystem/mapped_open_close_16MiB")(state& s)
+{
+    const auto& path = scratch_file();
+    for(auto _ : s)
+    {
+        mapped_file file(path);
+        do_not_optimize(file.data());
+    }
+}
+
+OCU_BENCHMARK("filesystem/mapped_open_touch_16MiB")(state& s)
+{
+    const auto& path = scratch_file();
+    for(auto _ : s)
+    {
+        mapped_file file(path, access_pattern::sequential);
+        do_not_optimize(touch_pages(file.data(), file.size()));
+    }
+}
+
+OCU_BENCHMARK("filesystem/baseline_ifstream_read_16MiB")(state& s)
+{
+    const auto& path = scratch_file();
+    for(auto _ : s)
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::vector<std::byte> data(file_size);
+        in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        do_not_optimize(touch_pages(data.data(), data.size()));
+    }
+}
+
+OCU_BENCHMARK("filesystem/async_read_4k_native")(state& s)
+{
+    random_reads(s, io_backend::automatic);
+}
+
+OCU_BENCHMARK("filesystem/async_read_4k_worker_threads")(state& s)
+{
+    random_reads(s, io_backend::worker_threads);
+}
+
+OCU_BENCHMARK("filesystem/baseline_sync_read_4k")(state& s)
+{
+    std::ifstream          in(scratch_file(), std::ios::binary);
+    std::vector<std::byte> buffer(stride);
+    std::uint64_t          sum = 0;
+
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::uint64_t offset : read_offsets())
+        {
+            in.seekg(static_cast<std::streamoff>(offset));
+            in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(stride));
+            sum += static_cast<std::uint64_t>(buffer[0]);
+        }
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("filesystem/scan_directory_18k")(state& s)
+{
+    const auto& root = scratch_tree();
+    for(auto _ : s) do_not_optimize(scan_directory(root).size());
+}
+
+OCU_BENCHMARK("filesystem/scan_directory_no_stat_18k")(state& s)
+{
+    const auto& root = scratch_tree();
+    for(auto _ : s) do_not_optimize(scan_directory(root, { .stat = false }).size());
+}
+
+OCU_BENCHMARK("filesystem/baseline_recursive_iterator_18k")(state& s)
+{
+    const auto& root = scratch_tree();
+    for(auto _ : s)
+    {
+        std::uint64_t total = 0;
+        for(const auto& e : std::filesystem::recursive_directory_iterator(root))
+        {
+            if(e.is_regular_file()) total += e.file_size() + static_cast<std::uint64_t>(
+                e.last_write_time().time_since_epoch().count());
+        }
+        do_not_optimize(total);
+    }
+}
+
+OCU_BENCHMARK("filesystem/snapshot_diff_18k")(state& s)
+{
+    const auto               entries = scan_directory(scratch_tree());
+    const directory_snapshot snapshot(entries);
+    for(auto _ : s) do_not_optimize(snapshot.diff(entries).empty());
+}
@@ -0,0 +1,113 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/flat_map.h>
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::flat_map;
+
+namespace
+{
+
+constexpr std::size_t table_size = std::size_t(1) << 22;
+constexpr std::size_t lookups    = 4096;
+
+const std::vector<std::pair<std::uint64_t, std::uint64_t>>& entries()
+{
+    static const std::vector<std::pair<std::uint64_t, std::uint64_t>> e = []
+    {
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> v(table_size);
+        std::mt19937_64 rng(3);
+        for(std::size_t i = 0; i < v.size(); ++i) v[i] = { rng(), i };
+        return v;
+    }();
+    return e;
+}
+
+/// Half hits, half misses, in random order
+const std::vector<std::uint64_t>& probes()
+{
+    static const std::vector<std::uint64_t> p = []
+    {
+        std::vector<std::uint64_t> v(lookups);
+        std::mt19937_64 rng(5);
+        for(std::size_t i = 0; i < v.size(); ++i) v[i] = i % 2 ? entries()[rng() % table_size].first : rng();
+        return v;
+    }();
+    return p;
+}
+
+const flat_map<std::uint64_t, std::uint64_t>& table()
+{
+    static const flat_map<std::uint64_t, std::uint64_t> t = []
+    {
+        flat_map<std::uint64_t, std::uint64_t> m;
+        m.insert_range(entries());
+        return m;
+    }();
+    return t;
+}
+
+template<typename Map>
+void lookup(state& s, const Map& m)
+{
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        std::uint64_t hits = 0;
+        for(std::uint64_t k : probes()) hits += m.contains(k);
+        do_not_optimize(hits);
+    }
+}
+
+}
+
+OCU_BENCHMARK("flat_map/lookup_4M")(state& s)
+{
+    lookup(s, table());
+}
+
+OCU_BENCHMARK("flat_map/lookup_eytzinger_4M")(state& s)
+{
+    auto t = table();
+    t.build_search_index();
+    lookup(s, t);
+}
+
+OCU_BENCHMARK("flat_map/lookup_std_map_4M")(state& s)
+{
+    const std::map<std::uint64_t, std::uint64_t> m(entries().begin(), entries().end());
+    lookup(s, m);
+}
+
+OCU_BENCHMARK("flat_map/insert_range_4M")(state& s)
+{
+    s.set_ops_per_iteration(table_size);
+    for(auto _ : s)
+    {
+        flat_map<std::uint64_t, std::uint64_t> m;
+        m.insert_range(entries());
+        do_not_optimize(m.size());
+    }
+}
+
+OCU_BENCHMARK("flat_map/insert_std_map_4M")(state& s)
+{
+    s.set_ops_per_iteration(table_size);
+    for(auto _ : s)
+    {
+        std::map<std::uint64_t, std::uint64_t> m(entries().begin(), entries().end());
+        do_not_optimize(m.size());
+    }
+}
@@ -0,0 +1,211 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/hash.h>
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::fnv1a_64;
+using open_cpp_utils::hash;
+using open_cpp_utils::hash_state;
+using open_cpp_utils::make_perfect_hash_map;
+using open_cpp_utils::xxh64;
+
+namespace
+{
+
+constexpr std::size_t lookups = 1024;
+
+constexpr auto commands = make_perfect_hash_map<int>({
+    { "open", 0 },            { "save", 1 },            { "save_as", 2 },
+    { "close", 3 },           { "quit", 4 },            { "undo", 5 },
+    { "redo", 6 },            { "cut", 7 },             { "copy", 8 },
+    { "paste", 9 },           { "select_all", 10 },     { "find", 11 },
+    { "replace", 12 },        { "goto_line", 13 },      { "zoom_in", 14 },
+    { "zoom_out", 15 },       { "toggle_grid", 16 },    { "toggle_snap", 17 },
+    { "play", 18 },           { "pause", 19 },          { "stop", 20 },
+    { "step", 21 },           { "reload_shaders", 22 }, { "screenshot", 23 },
+});
+
+/// Random command names, one in eight of them unknown, as owned strings like the ones a console would parse
+const std::vector<std::string>& queries()
+{
+    static const std::vector<std::string> q = []
+    {
+        std::vector<std::string> v;
+        std::mt19937 rng(3);
+        for(std::size_t i = 0; i < lookups; ++i)
+        {
+            if(rng() % 8 == 0) v.push_back("unknown_" + std::to_string(rng() % 100));
+            else v.emplace_back(commands.begin()[rng() % commands.size()].first);
+        }
+        return v;
+    }();
+    return q;
+}
+
+/// A composite key of the kind that tends to get hashed by formatting it into a string first
+struct asset_key
+{
+    std::string   name;
+    std::uint32_t lod;
+    std::uint32_t variant;
+
+    friend void hash_append(hash_state& h, const asset_key& k) { hash_append(h, k.name, k.lod, k.variant); }
+};
+
+const std::vector<asset_key>& asset_keys()
+{
+    static const std::vector<asset_key> k = []
+    {
+        std::vector<asset_key> v;
+        std::mt19937 rng(9);
+        for(std::size_t i = 0; i < lookups; ++i)
+        {
+            const auto lod     = static_cast<std::uint32_t>(rng() % 4);
+            const auto variant = static_cast<std::uint32_t>(rng() % 16);
+            v.push_back({ "textures/terrain_" + std::to_string(rng() % 1000), lod, variant });
+        }
+        return v;
+    }();
+    return k;
+}
+
+/// 4 KiB of pseudo-random bytes for the throughput runs
+const std::string& block()
+{
+    static const std::string b = []
+    {
+        std::string s(4096, '\0');
+        std::mt19937 rng(5);
+        for(char& c : s) c = static_cast<char>(rng());
+        return s;
+    }();
+    return b;
+}
+
+}
+
+OCU_BENCHMARK("hash/perfect_hash_map_lookup")(state& s)
+{
+    const auto& q = queries();
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        int sum = 0;
+        for(const std::string& name : q)
+        {
+            if(const int* id = commands.find(name)) sum += *id;
+        }
+        do_not_optimize(sum);
+    }
+}
+
+OCU_BENCHMARK("hash/baseline_std_unordered_map_lookup")(state& s)
+{
+    const std::unordered_map<std::string, int> map(commands.begin(), commands.end());
+    const auto& q = queries();
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        int sum = 0;
+        for(const std::string& name : q)
+        {
+            if(auto it = map.find(name); it != map.end()) sum += it->second;
+        }
+        do_not_optimize(sum);
+    }
+}
+
+OCU_BENCHMARK("hash/xxh64_4KiB")(state& s)
+{
+    const auto& b = block();
+    s.set_ops_per_iteration(b.size());
+    for(auto _ : s) do_not_optimize(xxh64(b));
+}
+
+OCU_BENCHMARK("hash/fnv1a_64_4KiB")(state& s)
+{
+    const auto& b = block();
+    s.set_ops_per_iteration(b.size());
+    for(auto _ : s) do_not_optimize(fnv1a_64(b));
+}
+
+OCU_BENCHMARK("hash/baseline_std_hash_4KiB")(state& s)
+{
+    const auto& b = block();
+    s.set_ops_per_iteration(b.size());
+    for(auto _ : s) do_not_optimize(std::hash<std::string_view>{ }(b));
+}
+
+OCU_BENCHMARK("hash/hash_4KiB")(state& s)
+{
+    const auto& b = block();
+    s.set_ops_per_iteration(b.size());
+    for(auto _ : s) do_not_optimize(hash<std::string>{ }(b));
+}
+
+OCU_BENCHMARK("hash/hash_string_keys")(state& s)
+{
+    const auto& q = queries();
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        std::size_t sum = 0;
+        for(const std::string& key : q) sum += hash<std::string>{ }(key);
+        do_not_optimize(sum);
+    }
+}
+
+OCU_BENCHMARK("hash/baseline_std_hash_string_keys")(state& s)
+{
+    const auto& q = queries();
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        std::size_t sum = 0;
+        for(const std::string& key : q) sum += std::hash<std::string>{ }(key);
+        do_not_optimize(sum);
+    }
+}
+
+OCU_BENCHMARK("hash/hash_append_struct")(state& s)
+{
+    const auto& keys = asset_keys();
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        std::size_t sum = 0;
+        for(const asset_key& key : keys) sum += hash<asset_key>{ }(key);
+        do_not_optimize(sum);
+    }
+}
+
+OCU_BENCHMARK("hash/baseline_to_string_struct")(state& s)
+{
+    const auto& keys = asset_keys();
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        std::size_t sum = 0;
+        for(const asset_key& key : keys)
+        {
+            const std::string flat = key.name + '#' + std::to_string(key.lod) + '#' + std::to_string(key.variant);
+            sum += std::hash<std::string>{ }(flat);
+        }
+        do_not_optimize(sum);
+    }
+}
@@ -0,0 +1,168 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/hash_table.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::hash_map;
+
+namespace
+{
+
+constexpr std::size_t table_size = 1 << 17;
+constexpr std::size_t batch      = 1024;
+
+const std::vector<std::uint64_t>& int_keys()
+{
+    static const std::vector<std::uint64_t> keys = []
+    {
+        std::vector<std::uint64_t> v(table_size);
+        std::mt19937_64 rng(7);
+        for(auto& k : v) k = rng();
+        return v;
+    }();
+    return keys;
+}
+
+const std::vector<std::string>& string_keys()
+{
+    static const std::vector<std::string> keys = []
+    {
+        std::vector<std::string> v;
+        v.reserve(table_size);
+        std::mt19937_64 rng(11);
+        for(std::size_t i = 0; i < table_size; ++i) v.push_back("asset/textures/" + std::to_string(rng()) + ".png");
+        return v;
+    }();
+    return keys;
+}
+
+/// Lookup order shared by every contender: random positions into the key set
+const std::vector<std::uint32_t>& probe_order()
+{
+    static const std::vector<std::uint32_t> order = []
+    {
+        std::vector<std::uint32_t> v(1 << 16);
+        std::mt19937 rng(3);
+        for(auto& i : v) i = rng() % table_size;
+        return v;
+    }();
+    return order;
+}
+
+template<typename Map, typename Keys>
+void find_hit(state& s, const Keys& keys)
+{
+    Map map;
+    for(std::size_t i = 0; i < keys.size(); ++i) map.emplace(keys[i], i);
+
+    const auto& order = probe_order();
+    std::size_t pos = 0;
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        std::size_t sum = 0;
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            sum += map.find(keys[order[pos++ & (order.size() - 1)]])->second;
+        }
+        do_not_optimize(sum);
+    }
+}
+
+template<typename Map>
+void find_miss_int(state& s)
+{
+    const auto& keys = int_keys();
+    Map map;
+    for(std::size_t i = 0; i < keys.size(); ++i) map.emplace(keys[i], i);
+
+    std::uint64_t probe = 0x9E3779B97F4A7C15ull;
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        std::size_t found = 0;
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            probe = probe * 6364136223846793005ull + 1442695040888963407ull;
+            found += map.find(probe) != map.end();
+        }
+        do_not_optimize(found);
+    }
+}
+
+template<typename Map, typename Keys>
+void insert_fresh(state& s, const Keys& keys)
+{
+    constexpr std::size_t n = 1 << 14;
+    s.set_ops_per_iteration(n);
+    for(auto _ : s)
+    {
+        Map map;
+        for(std::size_t i = 0; i < n; ++i) map.emplace(keys[i], i);
+        do_not_optimize(map.size());
+    }
+}
+
+template<typename Map, typename Keys>
+void insert_reserved(state& s, const Keys& keys)
+{
+    constexpr std::size_t n = 1 << 14;
+    s.set_ops_per_iteration(n);
+    for(auto _ : s)
+    {
+        Map map;
+        map.reserve(n);
+        for(std::size_t i = 0; i < n; ++i) map.emplace(keys[i], i);
+        do_not_optimize(map.size());
+    }
+}
+
+template<typename Map>
+void erase_insert_int(state& s)
+{
+    const auto& keys = int_keys();
+    constexpr std::size_t live = 1 << 14;
+    Map map;
+    for(std::size_t i = 0; i < live; ++i) map.emplace(keys[i], i);
+
+    std::size_t head = live, tail = 0;
+    for(auto _ : s)
+    {
+        map.erase(keys[tail++ & (table_size - 1)]);
+        map.emplace(keys[head++ & (table_size - 1)], head);
+    }
+}
+
+using ocu_int_map = hash_map<std::uint64_t, std::size_t>;
+using std_int_map = std::unordered_map<std::uint64_t, std::size_t>;
+using ocu_str_map = hash_map<std::string, std::size_t>;
+using std_str_map = std::unordered_map<std::string, std::size_t>;
+
+}
+
+OCU_BENCHMARK("hash_map/int/find_hit")(state& s)             { find_hit<ocu_int_map>(s, int_keys()); }
+OCU_BENCHMARK("hash_map/int/find_hit_std")(state& s)         { find_hit<std_int_map>(s, int_keys()); }
+OCU_BENCHMARK("hash_map/int/find_miss")(state& s)            { find_miss_int<ocu_int_map>(s); }
+OCU_BENCHMARK("hash_map/int/find_miss_std")(state& s)        { find_miss_int<std_int_map>(s); }
+OCU_BENCHMARK("hash_map/int/insert")(state& s)               { insert_fresh<ocu_int_map>(s, int_keys()); }
+OCU_BENCHMARK("hash_map/int/insert_std")(state& s)           { insert_fresh<std_int_map>(s, int_keys()); }
+OCU_BENCHMARK("hash_map/int/insert_reserved")(state& s)      { insert_reserved<ocu_int_map>(s, int_keys()); }
+OCU_BENCHMARK("hash_map/int/insert_reserved_std")(state& s)  { insert_reserved<std_int_map>(s, int_keys()); }
+OCU_BENCHMARK("hash_map/int/erase_insert")(state& s)         { erase_insert_int<ocu_int_map>(s); }
+OCU_BENCHMARK("hash_map/int/erase_insert_std")(state& s)     { erase_insert_int<std_int_map>(s); }
+OCU_BENCHMARK("hash_map/string/find_hit")(state& s)          { find_hit<ocu_str_map>(s, string_keys()); }
+OCU_BENCHMARK("hash_map/string/find_hit_std")(state& s)      { find_hit<std_str_map>(s, string_keys()); }
+OCU_BENCHMARK("hash_map/string/insert")(state& s)            { insert_fresh<ocu_str_map>(s, string_keys()); }
+OCU_BENCHMARK("hash_map/string/insert_std")(state& s)        { insert_fresh<std_str_map>(s, string_keys()); }
@@ -0,0 +1,149 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/hash_table.h>
+#include <open-cpp-utils/intern.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::hash_map;
+using open_cpp_utils::interner;
+using open_cpp_utils::symbol;
+
+namespace
+{
+
+constexpr std::size_t vocabulary = 4096;
+constexpr std::size_t lookups    = 4096;
+
+/// Names of the kind that key config and telemetry maps: a few thousand distinct, repeated endlessly
+const std::vector<std::string>& names()
+{
+    static const std::vector<std::string> n = []
+    {
+        std::vector<std::string> v;
+        for(std::size_t i = 0; i < vocabulary; ++i)
+        {
+            v.push_back("subsystem." + std::to_string(i % 61) + ".metric_" + std::to_string(i));
+        }
+        return v;
+    }();
+    return n;
+}
+
+/// Random picks from the vocabulary
+const std::vector<std::uint32_t>& picks()
+{
+    static const std::vector<std::uint32_t> p = []
+    {
+        std::vector<std::uint32_t> v(lookups);
+        std::mt19937 rng(3);
+        for(std::uint32_t& k : v) k = rng() % vocabulary;
+        return v;
+    }();
+    return p;
+}
+
+interner& populated()
+{
+    static interner in;
+    static const bool filled = []
+    {
+        for(const std::string& n : names()) (void)in.intern(n);
+        return true;
+    }();
+    (void)filled;
+    return in;
+}
+
+}
+
+OCU_BENCHMARK("intern/intern_existing")(state& s)
+{
+    interner&     in  = populated();
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        for(std::uint32_t k : picks()) sum += in.intern(names()[k]).value();
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("intern/baseline_string_map_find")(state& s)
+{
+    hash_map<std::string, std::uint32_t> ids;
+    for(std::uint32_t i = 0; i < vocabulary; ++i) ids.try_emplace(names()[i], i);
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        for(std::uint32_t k : picks()) sum += ids.find(names()[k])->second;
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("intern/intern_new_4096")(state& s)
+{
+    s.set_ops_per_iteration(vocabulary);
+    for(auto _ : s)
+    {
+        interner in;
+        for(const std::string& n : names()) do_not_optimize(in.intern(n));
+    }
+}
+
+OCU_BENCHMARK("intern/symbol_map_find")(state& s)
+{
+    interner&                       in = populated();
+    hash_map<symbol, std::uint64_t> m;
+    std::vector<symbol>             keys;
+    for(std::uint32_t i = 0; i < vocabulary; ++i) m.try_emplace(in.intern(names()[i]), i);
+    for(std::uint32_t k : picks()) keys.push_back(in.intern(names()[k]));
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        for(symbol k : keys) sum += m.find(k)->second;
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("intern/baseline_std_string_key_map_find")(state& s)
+{
+    hash_map<std::string, std::uint64_t> m;
+    std::vector<std::string>             keys;
+    for(std::uint32_t i = 0; i < vocabulary; ++i) m.try_emplace(names()[i], i);
+    for(std::uint32_t k : picks()) keys.push_back(names()[k]);
+    std::uint64_t sum = 0;
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        for(const std::string& k : keys) sum += m.find(k)->second;
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("intern/view")(state& s)
+{
+    interner&           in = populated();
+    std::vector<symbol> keys;
+    for(std::uint32_t k : picks()) keys.push_back(in.intern(names()[k]));
+    std::size_t len = 0;
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        for(symbol k : keys) len += in.view(k).size();
+    }
+    do_not_optimize(len);
+}
@@ -0,0 +1,123 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/object_pool.h>
+
+#include <array>
+#include <memory>
+#include <random>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::object_pool;
+
+namespace
+{
+
+struct node
+{
+    node*              parent = nullptr;
+    std::uint64_t      key    = 0;
+    std::array<int, 10> payload{ };
+};
+
+constexpr std::size_t live_set = 4096;
+
+/// Random slot indices shared by the churn benchmarks so every contender sees the same access pattern
+const std::vector<std::uint32_t>& churn_order()
+{
+    static const std::vector<std::uint32_t> order = []
+    {
+        std::vector<std::uint32_t> v(1 << 16);
+        std::mt19937 rng(42);
+        for(auto& i : v) i = rng() % live_set;
+        return v;
+    }();
+    return order;
+}
+
+}
+
+OCU_BENCHMARK("object_pool/acquire_release")(state& s)
+{
+    object_pool<node> pool(64);
+    for(auto _ : s)
+    {
+        auto h = pool.acquire();
+        do_not_optimize(h);
+        pool.release(h);
+    }
+}
+
+OCU_BENCHMARK("object_pool/baseline_new_delete")(state& s)
+{
+    for(auto _ : s)
+    {
+        auto* n = new node;
+        do_not_optimize(n);
+        delete n;
+    }
+}
+
+OCU_BENCHMARK("object_pool/baseline_make_shared")(state& s)
+{
+    for(auto _ : s)
+    {
+        auto n = std::make_shared<node>();
+        do_not_optimize(n);
+    }
+}
+
+OCU_BENCHMARK("object_pool/churn_4096_live")(state& s)
+{
+    object_pool<node> pool(live_set);
+    std::vector<object_pool<node>::handle> live(live_set);
+    for(auto& h : live) h = pool.acquire();
+
+    const auto& order = churn_order();
+    std::size_t i = 0;
+    for(auto _ : s)
+    {
+        auto& h = live[order[i++ & (order.size() - 1)]];
+        pool.release(h);
+        h = pool.acquire();
+        pool[h].key = i;
+    }
+}
+
+OCU_BENCHMARK("object_pool/churn_4096_live_baseline_new_delete")(state& s)
+{
+    std::vector<node*> live(live_set);
+    for(auto& p : live) p = new node;
+
+    const auto& order = churn_order();
+    std::size_t i = 0;
+    for(auto _ : s)
+    {
+        auto& p = live[order[i++ & (order.size() - 1)]];
+        delete p;
+        p = new node;
+        p->key = i;
+    }
+
+    for(auto* p : live) delete p;
+}
+
+OCU_BENCHMARK("object_pool/get_checked")(state& s)
+{
+    object_pool<node> pool(live_set);
+    std::vector<object_pool<node>::handle> live(live_set);
+    for(auto& h : live) h = pool.acquire();
+
+    const auto& order = churn_order();
+    std::size_t i = 0;
+    for(auto _ : s)
+    {
+        do_not_optimize(pool.get(live[order[i++ & (order.size() - 1)]]));
+    }
+}
@@ -0,0 +1,69 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/object_pool.h>
+#include <open-cpp-utils/optional.h>
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::optional;
+using open_cpp_utils::pool_handle;
+
+namespace
+{
+
+struct mesh;
+
+using handle = pool_handle<mesh>;
+
+/// 4M optional handles, a quarter of them empty: 16 MiB as optional, 32 MiB as std::optional
+constexpr std::size_t slot_count = std::size_t(1) << 22;
+
+template<typename Optional>
+std::vector<Optional> make_slots()
+{
+    std::vector<Optional> v(slot_count);
+    std::mt19937 rng(5);
+    for(std::size_t i = 0; i < slot_count; ++i)
+    {
+        if(rng() % 4 != 0) v[i] = handle(static_cast<std::uint32_t>(i) & handle::index_mask, 1);
+    }
+    return v;
+}
+
+template<typename Optional>
+void scan(state& s)
+{
+    const auto slots = make_slots<Optional>();
+    s.set_ops_per_iteration(slot_count);
+    for(auto _ : s)
+    {
+        std::uint64_t sum = 0;
+        for(const Optional& o : slots)
+        {
+            if(o) sum += o->index();
+        }
+        do_not_optimize(sum);
+    }
+}
+
+}
+
+OCU_BENCHMARK("optional/scan_handles_4M")(state& s)
+{
+    scan<optional<handle>>(s);
+}
+
+OCU_BENCHMARK("optional/baseline_std_scan_handles_4M")(state& s)
+{
+    scan<std::optional<handle>>(s);
+}
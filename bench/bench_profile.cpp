@@ -0,0 +1,99 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#define OCU_ENABLE_PROFILING
+
+#include "harness.h"
+
+#include <open-cpp-utils/profile.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::profile_session;
+
+namespace
+{
+
+/// Zones per iteration, well below the ring capacity so flushing between iterations keeps every zone recorded
+constexpr std::size_t batch = 4096;
+
+OCU_NOINLINE void work(std::uint64_t& x)
+{
+    x = x * 6364136223846793005ull + 1442695040888963407ull;
+}
+
+}
+
+OCU_BENCHMARK("profile/zone_recording")(state& s)
+{
+    std::uint64_t bytes = 0;
+    profile_session session([&](std::string_view v) { bytes += v.size(); }, std::chrono::hours(1));
+
+    std::uint64_t x = 1;
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            OCU_ZONE("work");
+            work(x);
+        }
+        s.pause_timing();
+        session.flush();
+        s.resume_timing();
+    }
+    do_not_optimize(x);
+    do_not_optimize(bytes);
+}
+
+OCU_BENCHMARK("profile/zone_no_session")(state& s)
+{
+    std::uint64_t x = 1;
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            OCU_ZONE("work");
+            work(x);
+        }
+    }
+    do_not_optimize(x);
+}
+
+OCU_BENCHMARK("profile/baseline_no_zone")(state& s)
+{
+    std::uint64_t x = 1;
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < batch; ++i) work(x);
+    }
+    do_not_optimize(x);
+}
+
+OCU_BENCHMARK("profile/baseline_steady_clock_pair")(state& s)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::uint64_t   x     = 1;
+    clock::duration total = clock::duration::zero();
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            const clock::time_point begin = clock::now();
+            work(x);
+            total += clock::now() - begin;
+        }
+    }
+    do_not_optimize(x);
+    do_not_optimize(total);
+}
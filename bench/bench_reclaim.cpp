@@ -0,0 +1,134 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/reclaim.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::epoch_domain;
+using open_cpp_utils::epoch_guard;
+using open_cpp_utils::hazard_domain;
+using open_cpp_utils::hazard_pointer;
+
+namespace
+{
+
+struct config
+{
+    std::uint64_t version;
+    std::uint64_t payload[7];
+};
+
+constexpr std::size_t batch = 1024;
+
+}
+
+OCU_BENCHMARK("reclaim/epoch_guard_read")(state& s)
+{
+    epoch_domain         domain;
+    std::atomic<config*> current{ new config{ 1, { } } };
+    std::uint64_t        sum = 0;
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            epoch_guard guard(domain);
+            sum += current.load(std::memory_order_acquire)->version;
+        }
+    }
+    do_not_optimize(sum);
+    delete current.load();
+}
+
+OCU_BENCHMARK("reclaim/hazard_pointer_read")(state& s)
+{
+    hazard_domain        domain;
+    std::atomic<config*> current{ new config{ 1, { } } };
+    std::uint64_t        sum = 0;
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            hazard_pointer hp(domain);
+            sum += hp.protect(current)->version;
+        }
+    }
+    do_not_optimize(sum);
+    delete current.load();
+}
+
+OCU_BENCHMARK("reclaim/baseline_std_atomic_shared_ptr_read")(state& s)
+{
+    std::atomic<std::shared_ptr<config>> current{ std::make_shared<config>(config{ 1, { } }) };
+    std::uint64_t                        sum = 0;
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < batch; ++i) sum += current.load(std::memory_order_acquire)->version;
+    }
+    do_not_optimize(sum);
+}
+
+/// Publishes a new config and retires the old one; the allocation is part of the cost in every variant
+OCU_BENCHMARK("reclaim/epoch_publish_retire")(state& s)
+{
+    epoch_domain         domain;
+    std::atomic<config*> current{ new config{ 0, { } } };
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            domain.retire(current.exchange(new config{ i, { } }, std::memory_order_acq_rel));
+        }
+    }
+    domain.synchronize();
+    delete current.load();
+}
+
+OCU_BENCHMARK("reclaim/hazard_publish_retire")(state& s)
+{
+    hazard_domain        domain;
+    std::atomic<config*> current{ new config{ 0, { } } };
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            domain.retire(current.exchange(new config{ i, { } }, std::memory_order_acq_rel));
+        }
+    }
+    domain.collect();
+    delete current.load();
+}
+
+OCU_BENCHMARK("reclaim/baseline_new_delete_publish")(state& s)
+{
+    std::atomic<config*> current{ new config{ 0, { } } };
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < batch; ++i) delete current.exchange(new config{ i, { } }, std::memory_order_acq_rel);
+    }
+    delete current.load();
+}
+
+OCU_BENCHMARK("reclaim/baseline_std_atomic_shared_ptr_publish")(state& s)
+{
+    std::atomic<std::shared_ptr<config>> current{ std::make_shared<config>(config{ 0, { } }) };
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < batch; ++i) current.store(std::make_shared<config>(config{ i, { } }));
+    }
+}
@@ -0,0 +1,150 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/serialize.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::deserialize;
+using open_cpp_utils::flat_map;
+using open_cpp_utils::hash_map;
+using open_cpp_utils::serialize;
+using open_cpp_utils::view_serialized;
+
+namespace
+{
+
+constexpr std::size_t table_size = std::size_t(1) << 20;
+constexpr std::size_t lookups    = 4096;
+
+struct lookup_index
+{
+    flat_map<std::uint64_t, std::uint64_t> by_key;
+    hash_map<std::string, std::uint32_t>   by_name;
+};
+
+const lookup_index& source()
+{
+    static const lookup_index ix = []
+    {
+        lookup_index i;
+        std::mt19937_64                                      rng(3);
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> entries(table_size);
+        for(std::size_t k = 0; k < table_size; ++k) entries[k] = { rng(), k };
+        i.by_key.insert_range(entries);
+        for(std::uint32_t k = 0; k < table_size / 4; ++k) i.by_name.try_emplace("name-" + std::to_string(k), k);
+        return i;
+    }();
+    return ix;
+}
+
+const std::vector<std::byte>& bytes()
+{
+    static const std::vector<std::byte> b = serialize(source());
+    return b;
+}
+
+/// Keys that are present, in random order
+const std::vector<std::uint64_t>& probes()
+{
+    static const std::vector<std::uint64_t> p = []
+    {
+        std::vector<std::uint64_t> v(lookups);
+        std::mt19937_64 rng(5);
+        for(std::uint64_t& k : v) k = source().by_key.keys()[rng() % source().by_key.size()];
+        return v;
+    }();
+    return p;
+}
+
+const std::vector<std::string>& name_probes()
+{
+    static const std::vector<std::string> p = []
+    {
+        std::vector<std::string> v(lookups);
+        std::mt19937_64 rng(7);
+        for(std::string& k : v) k = "name-" + std::to_string(rng() % (table_size / 4));
+        return v;
+    }();
+    return p;
+}
+
+}
+
+OCU_BENCHMARK("serialize/write_index")(state& s)
+{
+    const lookup_index& ix = source();
+    s.set_ops_per_iteration(table_size + table_size / 4);
+    for(auto _ : s) do_not_optimize(serialize(ix));
+}
+
+OCU_BENCHMARK("serialize/open_view")(state& s)
+{
+    const std::vector<std::byte>& b = bytes();
+    for(auto _ : s) do_not_optimize(view_serialized<lookup_index>(b));
+}
+
+OCU_BENCHMARK("serialize/baseline_deserialize")(state& s)
+{
+    const std::vector<std::byte>& b = bytes();
+    s.set_ops_per_iteration(table_size + table_size / 4);
+    for(auto _ : s) do_not_optimize(deserialize<lookup_index>(b));
+}
+
+OCU_BENCHMARK("serialize/view_flat_map_find")(state& s)
+{
+    const auto    by_key = view_serialized<lookup_index>(bytes()).get<0>();
+    std::uint64_t sum    = 0;
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        for(std::uint64_t k : probes()) sum += *by_key.find(k);
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("serialize/baseline_flat_map_find")(state& s)
+{
+    const auto&   by_key = source().by_key;
+    std::uint64_t sum    = 0;
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        for(std::uint64_t k : probes()) sum += by_key.find(k)->second;
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("serialize/view_hash_map_find")(state& s)
+{
+    const auto    by_name = view_serialized<lookup_index>(bytes()).get<1>();
+    std::uint64_t sum     = 0;
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        for(const std::string& k : name_probes()) sum += *by_name.find(k);
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("serialize/baseline_hash_map_find")(state& s)
+{
+    const auto&   by_name = source().by_name;
+    std::uint64_t sum     = 0;
+    s.set_ops_per_iteration(lookups);
+    for(auto _ : s)
+    {
+        for(const std::string& k : name_probes()) sum += by_name.find(k)->second;
+    }
+    do_not_optimize(sum);
+}
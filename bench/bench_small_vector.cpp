@@ -0,0 +1,110 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/small_vector.h>
+
+#include <memory>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::small_vector;
+
+namespace
+{
+
+template<typename Vector>
+void push_back_n(state& s, int n)
+{
+    s.set_ops_per_iteration(static_cast<std::uint64_t>(n));
+    for(auto _ : s)
+    {
+        Vector v;
+        for(int i = 0; i < n; ++i) v.push_back(i);
+        do_not_optimize(v.data());
+    }
+}
+
+/// Growth of a non-trivially-copyable but trivially relocatable element type
+template<typename Vector>
+void grow_unique_ptr(state& s)
+{
+    constexpr int n = 1024;
+    s.set_ops_per_iteration(n);
+    for(auto _ : s)
+    {
+        s.pause_timing();
+        std::vector<std::unique_ptr<int>> src;
+        src.reserve(n);
+        for(int i = 0; i < n; ++i) src.push_back(std::make_unique<int>(i));
+        s.resume_timing();
+
+        {
+            Vector v;
+            for(auto& p : src) v.push_back(std::move(p));
+            do_not_optimize(v.data());
+
+            s.pause_timing();
+        }
+        s.resume_timing();
+    }
+}
+
+template<typename Vector>
+void erase_front(state& s)
+{
+    constexpr int n = 256;
+    s.set_ops_per_iteration(n);
+    for(auto _ : s)
+    {
+        s.pause_timing();
+        Vector v;
+        for(int i = 0; i < n; ++i) v.push_back(std::make_unique<int>(i));
+        s.resume_timing();
+
+        while(!v.empty()) v.erase(v.begin());
+        do_not_optimize(v.data());
+    }
+}
+
+}
+
+OCU_BENCHMARK("small_vector/push_back_8")(state& s)              { push_back_n<small_vector<int, 8>>(s, 8); }
+OCU_BENCHMARK("small_vector/push_back_8_std_vector")(state& s)   { push_back_n<std::vector<int>>(s, 8); }
+OCU_BENCHMARK("small_vector/push_back_64")(state& s)             { push_back_n<small_vector<int, 8>>(s, 64); }
+OCU_BENCHMARK("small_vector/push_back_64_std_vector")(state& s)  { push_back_n<std::vector<int>>(s, 64); }
+
+OCU_BENCHMARK("small_vector/unchecked_push_back_64")(state& s)
+{
+    s.set_ops_per_iteration(64);
+    for(auto _ : s)
+    {
+        small_vector<int, 64> v;
+        for(int i = 0; i < 64; ++i) v.unchecked_push_back(i);
+        do_not_optimize(v.data());
+    }
+}
+
+OCU_BENCHMARK("small_vector/grow_unique_ptr_1024")(state& s)
+{
+    grow_unique_ptr<small_vector<std::unique_ptr<int>, 8>>(s);
+}
+
+OCU_BENCHMARK("small_vector/grow_unique_ptr_1024_std_vector")(state& s)
+{
+    grow_unique_ptr<std::vector<std::unique_ptr<int>>>(s);
+}
+
+OCU_BENCHMARK("small_vector/erase_front_unique_ptr_256")(state& s)
+{
+    erase_front<small_vector<std::unique_ptr<int>, 8>>(s);
+}
+
+OCU_BENCHMARK("small_vector/erase_front_unique_ptr_256_std_vector")(state& s)
+{
+    erase_front<std::vector<std::unique_ptr<int>>>(s);
+}
@@ -0,0 +1,157 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/sparse_set.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::component_storage;
+using open_cpp_utils::join;
+
+namespace
+{
+
+struct entity_tag;
+
+using entity = open_cpp_utils::unique_id<entity_tag>;
+
+struct position { float x, y, z; };
+struct velocity { float x, y, z; };
+
+/// 1M entities, all with a position and one in ten with a velocity
+constexpr std::size_t entity_count = std::size_t(1) << 20;
+
+const std::vector<entity>& entities()
+{
+    static const std::vector<entity> ids = []
+    {
+        std::vector<entity> v(entity_count);
+        for(entity& e : v) e = entity::next();
+        return v;
+    }();
+    return ids;
+}
+
+bool has_velocity(std::size_t i) { return (i * 2654435761u) % 10 == 0; }
+
+struct world
+{
+    world()
+    {
+        positions.reserve(entity_count);
+        for(std::size_t i = 0; i < entity_count; ++i)
+        {
+            positions.emplace(entities()[i], position{ float(i), 0, 0 });
+            if(has_velocity(i)) velocities.emplace(entities()[i], velocity{ 1, 2, 3 });
+        }
+    }
+
+    component_storage<position, entity> positions;
+    component_storage<velocity, entity> velocities;
+};
+
+struct std_world
+{
+    std_world()
+    {
+        positions.reserve(entity_count);
+        for(std::size_t i = 0; i < entity_count; ++i)
+        {
+            positions.emplace(entities()[i].value(), position{ float(i), 0, 0 });
+            if(has_velocity(i)) velocities.emplace(entities()[i].value(), velocity{ 1, 2, 3 });
+        }
+    }
+
+    std::unordered_map<std::uint64_t, position> positions;
+    std::unordered_map<std::uint64_t, velocity> velocities;
+};
+
+std::vector<entity> shuffled_entities()
+{
+    std::vector<entity> v = entities();
+    std::shuffle(v.begin(), v.end(), std::mt19937(3));
+    return v;
+}
+
+}
+
+OCU_BENCHMARK("sparse_set/update_all_1M")(state& s)
+{
+    world w;
+    s.set_ops_per_iteration(entity_count);
+    for(auto _ : s)
+    {
+        for(position& p : w.positions.components()) p.y += 1.0f;
+    }
+    do_not_optimize(w.positions.components()[0]);
+}
+
+OCU_BENCHMARK("sparse_set/join_position_velocity_1M")(state& s)
+{
+    world w;
+    s.set_ops_per_iteration(w.velocities.size());
+    for(auto _ : s)
+    {
+        join(w.positions, w.velocities).each([](entity, position& p, const velocity& v)
+        {
+            p.x += v.x;
+            p.y += v.y;
+            p.z += v.z;
+        });
+    }
+    do_not_optimize(w.positions.components()[0]);
+}
+
+OCU_BENCHMARK("sparse_set/baseline_std_unordered_map_join_1M")(state& s)
+{
+    std_world w;
+    s.set_ops_per_iteration(w.velocities.size());
+    for(auto _ : s)
+    {
+        for(const auto& [id, v] : w.velocities)
+        {
+            const auto it = w.positions.find(id);
+            if(it == w.positions.end()) continue;
+            it->second.x += v.x;
+            it->second.y += v.y;
+            it->second.z += v.z;
+        }
+    }
+    do_not_optimize(w.positions.begin()->second);
+}
+
+OCU_BENCHMARK("sparse_set/get_random_1M")(state& s)
+{
+    world                     w;
+    const std::vector<entity> order = shuffled_entities();
+    float                     sum   = 0;
+    s.set_ops_per_iteration(entity_count);
+    for(auto _ : s)
+    {
+        for(const entity e : order) sum += w.positions.get(e).x;
+    }
+    do_not_optimize(sum);
+}
+
+OCU_BENCHMARK("sparse_set/baseline_std_unordered_map_get_random_1M")(state& s)
+{
+    std_world                 w;
+    const std::vector<entity> order = shuffled_entities();
+    float                     sum   = 0;
+    s.set_ops_per_iteration(entity_count);
+    for(auto _ : s)
+    {
+        for(const entity e : order) sum += w.positions.find(e.value())->second.x;
+    }
+    do_not_optimize(sum);
+}
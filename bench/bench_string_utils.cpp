@@ -0,0 +1,240 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/string_utils.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::byte_set;
+using open_cpp_utils::find_first_of;
+using open_cpp_utils::iequals;
+using open_cpp_utils::ihash;
+using open_cpp_utils::is_valid_utf8;
+using open_cpp_utils::split;
+using open_cpp_utils::split_mode;
+
+namespace
+{
+
+constexpr std::size_t text_size = 64 * 1024;
+
+/// Log-like text: words, spaces and newlines, with a '|' or '#' once every 4 KiB or so
+const std::string& log_text()
+{
+    static const std::string t = []
+    {
+        std::string s;
+        std::mt19937 rng(3);
+        while(s.size() < text_size)
+        {
+            const std::uint32_t r = rng() % 4096;
+            if(r == 0)      s += '|';
+            else if(r == 1) s += '#';
+            else if(r < 400) s += ' ';
+            else if(r < 440) s += '\n';
+            else            s += static_cast<char>('a' + rng() % 26);
+        }
+        return s;
+    }();
+    return t;
+}
+
+/// A config file of short "key = value, value; key = value" lines
+const std::string& config_text()
+{
+    static const std::string t = []
+    {
+        std::string s;
+        std::mt19937 rng(5);
+        while(s.size() < text_size)
+        {
+            s += "key" + std::to_string(rng() % 1000) + " = ";
+            for(std::uint32_t v = 0, n = 1 + rng() % 4; v < n; ++v)
+            {
+                s += std::to_string(rng() % 100000);
+                s += v + 1 < n ? ", " : ";\n";
+            }
+        }
+        return s;
+    }();
+    return t;
+}
+
+/// Text that is mostly ASCII with two, three and four byte sequences mixed in, like a localised log
+const std::string& utf8_text()
+{
+    static const std::string t = []
+    {
+        std::string s;
+        std::mt19937 rng(7);
+        while(s.size() < text_size)
+        {
+            switch(rng() % 16)
+            {
+            case 0:  s += "\xC3\xA9"; break;
+            case 1:  s += "\xE2\x82\xAC"; break;
+            case 2:  s += "\xF0\x9F\x98\x80"; break;
+            default: s += static_cast<char>('a' + rng() % 26); break;
+            }
+        }
+        return s;
+    }();
+    return t;
+}
+
+const std::vector<std::string>& header_names()
+{
+    static const std::vector<std::string> h = {
+        "Content-Type", "content-length", "ACCEPT-ENCODING", "User-Agent", "x-request-id", "Cache-Control",
+        "Transfer-Encoding", "If-None-Match", "Authorization", "accept-language", "X-Forwarded-For", "Connection",
+    };
+    return h;
+}
+
+constexpr std::string_view log_delims    = "|#";
+constexpr std::string_view config_delims = ",;=\n";
+
+}
+
+OCU_BENCHMARK("string_utils/find_first_of_64k")(state& s)
+{
+    const std::string_view text = log_text();
+    const byte_set         set(log_delims);
+    std::size_t            hits = 0;
+    s.set_ops_per_iteration(text.size());
+    for(auto _ : s)
+    {
+        for(std::size_t i = find_first_of(text, set); i != std::string_view::npos; i = find_first_of(text, set, i + 1))
+        {
+            ++hits;
+        }
+    }
+    do_not_optimize(hits);
+}
+
+OCU_BENCHMARK("string_utils/baseline_std_find_first_of_64k")(state& s)
+{
+    const std::string_view text = log_text();
+    std::size_t            hits = 0;
+    s.set_ops_per_iteration(text.size());
+    for(auto _ : s)
+    {
+        for(std::size_t i = text.find_first_of(log_delims); i != std::string_view::npos;
+            i = text.find_first_of(log_delims, i + 1))
+        {
+            ++hits;
+        }
+    }
+    do_not_optimize(hits);
+}
+
+OCU_BENCHMARK("string_utils/split_config_64k")(state& s)
+{
+    const std::string_view text = config_text();
+    const byte_set         set(config_delims);
+    std::size_t            len  = 0;
+    s.set_ops_per_iteration(text.size());
+    for(auto _ : s)
+    {
+        for(std::string_view field : split(text, set, split_mode::skip_empty)) len += field.size();
+    }
+    do_not_optimize(len);
+}
+
+OCU_BENCHMARK("string_utils/baseline_std_tokenizer_64k")(state& s)
+{
+    const std::string_view text = config_text();
+    std::size_t            len  = 0;
+    s.set_ops_per_iteration(text.size());
+    for(auto _ : s)
+    {
+        std::size_t b = 0;
+        while(b < text.size())
+        {
+            std::size_t e = text.find_first_of(config_delims, b);
+            if(e == std::string_view::npos) e = text.size();
+            len += e - b;
+            b    = e + 1;
+        }
+    }
+    do_not_optimize(len);
+}
+
+OCU_BENCHMARK("string_utils/utf8_validate_64k")(state& s)
+{
+    const std::string_view text = utf8_text();
+    bool                   ok   = true;
+    s.set_ops_per_iteration(text.size());
+    for(auto _ : s) ok &= is_valid_utf8(text);
+    do_not_optimize(ok);
+}
+
+OCU_BENCHMARK("string_utils/baseline_scalar_utf8_validate_64k")(state& s)
+{
+    const std::string_view text = utf8_text();
+    bool                   ok   = true;
+    s.set_ops_per_iteration(text.size());
+    for(auto _ : s) ok &= open_cpp_utils::detail::scalar_string_kernels.utf8(text.data(), text.size());
+    do_not_optimize(ok);
+}
+
+OCU_BENCHMARK("string_utils/utf8_validate_ascii_64k")(state& s)
+{
+    const std::string_view text = log_text();
+    bool                   ok   = true;
+    s.set_ops_per_iteration(text.size());
+    for(auto _ : s) ok &= is_valid_utf8(text);
+    do_not_optimize(ok);
+}
+
+OCU_BENCHMARK("string_utils/iequals_headers")(state& s)
+{
+    const std::vector<std::string>& names = header_names();
+    std::size_t                     hits  = 0;
+    s.set_ops_per_iteration(names.size());
+    for(auto _ : s)
+    {
+        for(const std::string& n : names) hits += iequals(n, "transfer-encoding");
+    }
+    do_not_optimize(hits);
+}
+
+OCU_BENCHMARK("string_utils/baseline_lowercase_copy_equals_headers")(state& s)
+{
+    const std::vector<std::string>& names = header_names();
+    std::size_t                     hits  = 0;
+    s.set_ops_per_iteration(names.size());
+    for(auto _ : s)
+    {
+        for(const std::string& n : names)
+        {
+            std::string lower = n;
+            for(char& c : lower) c = open_cpp_utils::ascii_to_lower(c);
+            hits += lower == "transfer-encoding";
+        }
+    }
+    do_not_optimize(hits);
+}
+
+OCU_BENCHMARK("string_utils/ihash_headers")(state& s)
+{
+    const std::vector<std::string>& names = header_names();
+    std::uint64_t                   sum   = 0;
+    s.set_ops_per_iteration(names.size());
+    for(auto _ : s)
+    {
+        for(const std::string& n : names) sum += ihash(n);
+    }
+    do_not_optimize(sum);
+}
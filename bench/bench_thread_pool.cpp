@@ -0,0 +1,118 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/thread_pool.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::default_thread_pool;
+using open_cpp_utils::parallel_for;
+using open_cpp_utils::parallel_reduce;
+using open_cpp_utils::task_graph;
+using open_cpp_utils::thread_pool;
+
+namespace
+{
+
+constexpr std::size_t element_count = 1 << 16;
+
+/// Enough arithmetic per element that the loop is CPU bound rather than memory bound
+double work(std::size_t i)
+{
+    double x = static_cast<double>(i);
+    for(int k = 0; k < 8; ++k) x = std::sqrt(x * 1.0001 + 1.0);
+    return x;
+}
+
+}
+
+OCU_BENCHMARK("thread_pool/post_wait_1000")(state& s)
+{
+    thread_pool& pool = default_thread_pool();
+    s.set_ops_per_iteration(1000);
+    for(auto _ : s)
+    {
+        std::atomic<int> remaining{ 1000 };
+        for(int i = 0; i < 1000; ++i) pool.post([&remaining]() noexcept { remaining.fetch_sub(1); });
+        while(remaining.load() != 0) pool.try_run_one();
+    }
+}
+
+OCU_BENCHMARK("thread_pool/baseline_thread_per_task_8")(state& s)
+{
+    s.set_ops_per_iteration(8);
+    for(auto _ : s)
+    {
+        std::atomic<int> done{ 0 };
+        std::vector<std::thread> threads;
+        threads.reserve(8);
+        for(int i = 0; i < 8; ++i) threads.emplace_back([&done] { done.fetch_add(1); });
+        for(auto& t : threads) t.join();
+        do_not_optimize(done);
+    }
+}
+
+OCU_BENCHMARK("thread_pool/parallel_for_64k")(state& s)
+{
+    std::vector<double> out(element_count);
+    s.set_ops_per_iteration(element_count);
+    for(auto _ : s)
+    {
+        parallel_for(0, out.size(), 0, [&](std::size_t i) { out[i] = work(i); });
+        do_not_optimize(out.data());
+    }
+}
+
+OCU_BENCHMARK("thread_pool/serial_for_64k")(state& s)
+{
+    std::vector<double> out(element_count);
+    s.set_ops_per_iteration(element_count);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < out.size(); ++i) out[i] = work(i);
+        do_not_optimize(out.data());
+    }
+}
+
+OCU_BENCHMARK("thread_pool/parallel_reduce_64k")(state& s)
+{
+    s.set_ops_per_iteration(element_count);
+    for(auto _ : s)
+    {
+        double sum = parallel_reduce(0, element_count, 0, 0.0, [](std::size_t i) { return work(i); }, std::plus<>{ });
+        do_not_optimize(sum);
+    }
+}
+
+OCU_BENCHMARK("thread_pool/task_graph_diamond_64")(state& s)
+{
+    // source -> 64 independent nodes -> sink
+    task_graph graph;
+    std::atomic<int> counter{ 0 };
+    auto source = graph.emplace([] { });
+    auto sink   = graph.emplace([] { });
+    for(int i = 0; i < 64; ++i)
+    {
+        auto n = graph.emplace([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+        graph.precede(source, n);
+        graph.precede(n, sink);
+    }
+
+    s.set_ops_per_iteration(graph.size());
+    for(auto _ : s)
+    {
+        graph.run();
+    }
+    do_not_optimize(counter);
+}
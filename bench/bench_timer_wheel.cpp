@@ -0,0 +1,130 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/timer_wheel.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::timer_wheel;
+
+namespace
+{
+
+/// Two million connection timeouts spread over 30 s of 1 ms ticks
+constexpr std::size_t    timer_count = std::size_t(2) << 20;
+constexpr std::uint64_t  horizon     = 30'000;
+constexpr std::size_t    batch       = 4096;
+
+const std::vector<std::uint64_t>& delays()
+{
+    static const std::vector<std::uint64_t> d = []
+    {
+        std::vector<std::uint64_t> v(timer_count);
+        std::mt19937_64 rng(17);
+        for(auto& x : v) x = 1 + rng() % horizon;
+        return v;
+    }();
+    return d;
+}
+
+using wheel = timer_wheel<std::uint32_t>;
+
+/// A wheel holding every timer, with handles for the cancel benchmarks
+std::pair<std::unique_ptr<wheel>, std::vector<wheel::timer>> filled_wheel()
+{
+    auto w = std::make_unique<wheel>();
+    std::vector<wheel::timer> handles(timer_count);
+    for(std::size_t i = 0; i < timer_count; ++i) handles[i] = w->schedule(delays()[i], static_cast<std::uint32_t>(i));
+    return { std::move(w), std::move(handles) };
+}
+
+using deadline_entry = std::pair<std::uint64_t, std::uint32_t>;
+using deadline_queue = std::priority_queue<deadline_entry, std::vector<deadline_entry>, std::greater<>>;
+
+}
+
+OCU_BENCHMARK("timer_wheel/reschedule_2M")(state& s)
+{
+    auto [w, handles] = filled_wheel();
+    std::size_t i = 0;
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t b = 0; b < batch; ++b, i = (i + 7919) % timer_count)
+        {
+            w->reschedule(handles[i], delays()[(i + b) % timer_count]);
+        }
+    }
+    do_not_optimize(w->size());
+}
+
+OCU_BENCHMARK("timer_wheel/baseline_std_multimap_reschedule_2M")(state& s)
+{
+    using map_type = std::multimap<std::uint64_t, std::uint32_t>;
+    map_type                        timers;
+    std::vector<map_type::iterator> handles(timer_count);
+    for(std::size_t i = 0; i < timer_count; ++i)
+    {
+        handles[i] = timers.emplace(delays()[i], static_cast<std::uint32_t>(i));
+    }
+
+    std::size_t i = 0;
+    s.set_ops_per_iteration(batch);
+    for(auto _ : s)
+    {
+        for(std::size_t b = 0; b < batch; ++b, i = (i + 7919) % timer_count)
+        {
+            timers.erase(handles[i]);
+            handles[i] = timers.emplace(delays()[(i + b) % timer_count], static_cast<std::uint32_t>(i));
+        }
+    }
+    do_not_optimize(timers.size());
+}
+
+OCU_BENCHMARK("timer_wheel/schedule_expire_2M")(state& s)
+{
+    wheel w;
+    s.set_ops_per_iteration(timer_count);
+    for(auto _ : s)
+    {
+        for(std::size_t i = 0; i < timer_count; ++i) w.schedule(delays()[i], static_cast<std::uint32_t>(i));
+
+        std::uint64_t sum = 0;
+        w.advance(horizon, [&sum](std::uint32_t id) { sum += id; });
+        do_not_optimize(sum);
+    }
+}
+
+OCU_BENCHMARK("timer_wheel/baseline_std_priority_queue_schedule_expire_2M")(state& s)
+{
+    std::uint64_t now = 0;
+    s.set_ops_per_iteration(timer_count);
+    for(auto _ : s)
+    {
+        std::vector<deadline_entry> storage;
+        storage.reserve(timer_count);
+        deadline_queue queue(std::greater<>(), std::move(storage));
+        for(std::size_t i = 0; i < timer_count; ++i) queue.emplace(now + delays()[i], static_cast<std::uint32_t>(i));
+
+        now += horizon;
+        std::uint64_t sum = 0;
+        while(!queue.empty() && queue.top().first <= now)
+        {
+            sum += queue.top().second;
+            queue.pop();
+        }
+        do_not_optimize(sum);
+    }
+}
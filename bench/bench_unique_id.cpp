@@ -0,0 +1,88 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/unique_id.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using open_cpp_utils::bench::do_not_optimize;
+using open_cpp_utils::bench::state;
+using open_cpp_utils::snowflake_generator;
+using open_cpp_utils::unique_id;
+
+namespace
+{
+
+struct bench_tag;
+
+constexpr std::uint64_t ids_per_iteration = 4096;
+
+/// The global counter unique_id replaces
+std::atomic<std::uint64_t> global_counter{ 1 };
+
+struct block_ids
+{
+    static std::uint64_t next() { return unique_id<bench_tag>::next().value(); }
+};
+
+struct atomic_ids
+{
+    static std::uint64_t next() { return global_counter.fetch_add(1, std::memory_order_relaxed); }
+};
+
+template<typename Source, int Threads>
+void run_threads(state& s)
+{
+    s.set_ops_per_iteration(ids_per_iteration * Threads);
+    const std::uint64_t per_thread = s.iterations() * ids_per_iteration;
+
+    std::atomic<bool>        go{ false };
+    std::atomic<int>         ready{ 0 };
+    std::vector<std::thread> threads;
+    for(int t = 0; t < Threads; ++t)
+    {
+        threads.emplace_back([&]
+        {
+            ready.fetch_add(1, std::memory_order_relaxed);
+            while(!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            std::uint64_t sum = 0;
+            for(std::uint64_t i = 0; i < per_thread; ++i) sum += Source::next();
+            do_not_optimize(sum);
+        });
+    }
+
+    while(ready.load(std::memory_order_relaxed) < Threads) std::this_thread::yield();
+    auto timed = s.timed();
+    go.store(true, std::memory_order_release);
+    for(auto& t : threads) t.join();
+}
+
+}
+
+OCU_BENCHMARK("unique_id/next")(state& s)
+{
+    for(auto _ : s) do_not_optimize(unique_id<bench_tag>::next());
+}
+
+OCU_BENCHMARK("unique_id/baseline_atomic_fetch_add")(state& s)
+{
+    for(auto _ : s) do_not_optimize(global_counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+OCU_BENCHMARK("unique_id/next_threads_4")(state& s)                    { run_threads<block_ids, 4>(s); }
+OCU_BENCHMARK("unique_id/next_threads_16")(state& s)                   { run_threads<block_ids, 16>(s); }
+OCU_BENCHMARK("unique_id/baseline_atomic_fetch_add_threads_4")(state& s)  { run_threads<atomic_ids, 4>(s); }
+OCU_BENCHMARK("unique_id/baseline_atomic_fetch_add_threads_16")(state& s) { run_threads<atomic_ids, 16>(s); }
+
+OCU_BENCHMARK("unique_id/snowflake_next")(state& s)
+{
+    snowflake_generator generator(1);
+    for(auto _ : s) do_not_optimize(generator.next());
+}
@@ -0,0 +1,206 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace open_cpp_utils::bench
+{
+
+namespace
+{
+
+struct entry
+{
+    const char*  name;
+    benchmark_fn fn;
+};
+
+std::vector<entry>& registry()
+{
+    static std::vector<entry> entries;
+    return entries;
+}
+
+double ns_per_op(const state& s)
+{
+    const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(s.elapsed()).count());
+    return ns / static_cast<double>(s.ops());
+}
+
+/// Nearest-rank percentile over an already sorted sample.
+double percentile(const std::vector<double>& sorted, double p)
+{
+    const std::size_t rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+double median(const std::vector<double>& sorted)
+{
+    const std::size_t n = sorted.size();
+    return n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+bool matches(const options& opts, const char* name)
+{
+    if(opts.filters.empty()) return true;
+    return std::any_of(opts.filters.begin(), opts.filters.end(),
+                       [name](const std::string& f) { return std::strstr(name, f.c_str()) != nullptr; });
+}
+
+void usage(const char* argv0)
+{
+    std::printf("usage: %s [filter...] [--out FILE] [--reps N] [--warmup N] [--min-time-ms MS] [--quick] [--list]\n"
+                "  filter          run only benchmarks whose name contains one of the filters\n"
+                "  --out FILE      machine readable results (default bench_output.txt)\n"
+                "  --reps N        measured repetitions per benchmark (default 11)\n"
+                "  --warmup N      unmeasured repetitions before measuring (default 1)\n"
+                "  --min-time-ms   minimum duration of one repetition (default 5)\n"
+                "  --quick         shorthand for --reps 3 --warmup 1 --min-time-ms 1\n"
+                "  --list          print benchmark names and exit\n", argv0);
+}
+
+bool parse(int argc, char** argv, options& opts)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        auto next = [&]() -> const char*
+        {
+            if(i + 1 >= argc) { std::fprintf(stderr, "missing value for %s\n", arg.c_str()); std::exit(2); }
+            return argv[++i];
+        };
+
+        if(arg == "--out")              opts.output      = next();
+        else if(arg == "--reps")        opts.repetitions = std::max<std::size_t>(1, std::strtoull(next(), nullptr, 10));
+        else if(arg == "--warmup")      opts.warmup      = std::strtoull(next(), nullptr, 10);
+        else if(arg == "--min-time-ms") opts.min_time    = std::chrono::microseconds(
+                                                               static_cast<long long>(std::atof(next()) * 1000.0));
+        else if(arg == "--quick")       { opts.repetitions = 3; opts.warmup = 1; opts.min_time = std::chrono::milliseconds(1); }
+        else if(arg == "--list")        opts.list_only = true;
+        else if(arg == "--help" || arg == "-h") { usage(argv[0]); return false; }
+        else if(arg.rfind("--", 0) == 0) { std::fprintf(stderr, "unknown option %s\n", arg.c_str()); usage(argv[0]); std::exit(2); }
+        else                            opts.filters.push_back(arg);
+    }
+    return true;
+}
+
+}
+
+int register_benchmark(const char* name, benchmark_fn fn)
+{
+    registry().push_back({ name, fn });
+    return static_cast<int>(registry().size());
+}
+
+result run_benchmark(const char* name, benchmark_fn fn, const options& opts)
+{
+    using namespace std::chrono;
+
+    // Calibrate: grow the iteration count geometrically until one run covers min_time, then extrapolate
+    std::uint64_t iterations = 1;
+    for(;;)
+    {
+        state s(iterations);
+        fn(s);
+        const auto elapsed = s.elapsed();
+        if(elapsed >= opts.min_time || iterations >= (1ull << 40)) break;
+
+        const double ratio = elapsed.count() <= 0
+                           ? 100.0
+                           : static_cast<double>(duration_cast<nanoseconds>(opts.min_time).count())
+                           / static_cast<double>(duration_cast<nanoseconds>(elapsed).count());
+        const double grow  = std::clamp(ratio * 1.2, 2.0, 100.0);
+        iterations = static_cast<std::uint64_t>(static_cast<double>(iterations) * grow) + 1;
+    }
+
+    for(std::size_t i = 0; i < opts.warmup; ++i)
+    {
+        state s(iterations);
+        fn(s);
+    }
+
+    std::vector<double> samples;
+    samples.reserve(opts.repetitions);
+    std::uint64_t allocations = 0;
+    std::uint64_t ops         = 0;
+    for(std::size_t i = 0; i < opts.repetitions; ++i)
+    {
+        state s(iterations);
+        fn(s);
+        samples.push_back(ns_per_op(s));
+        allocations += s.allocations();
+        ops         += s.ops();
+    }
+    std::sort(samples.begin(), samples.end());
+
+    return {
+        name,
+        median(samples),
+        percentile(samples, 0.99),
+        samples.front(),
+        static_cast<double>(allocations) / static_cast<double>(ops),
+        iterations,
+        opts.repetitions
+    };
+}
+
+int run_main(int argc, char** argv)
+{
+    options opts;
+    if(!parse(argc, argv, opts)) return 0;
+
+    auto entries = registry();
+    std::sort(entries.begin(), entries.end(),
+              [](const entry& a, const entry& b) { return std::strcmp(a.name, b.name) < 0; });
+
+    if(opts.list_only)
+    {
+        for(const entry& e : entries) if(matches(opts, e.name)) std::printf("%s\n", e.name);
+        return 0;
+    }
+
+    std::ofstream out(opts.output, std::ios::trunc);
+    if(!out)
+    {
+        std::fprintf(stderr, "failed to open %s for writing\n", opts.output.c_str());
+        return 1;
+    }
+
+    out << "# open_cpp_utils_bench reps=" << opts.repetitions << " warmup=" << opts.warmup
+        << " min_time_us=" << opts.min_time.count() << '\n'
+        << "name\tmedian_ns_per_op\tp99_ns_per_op\tmin_ns_per_op\tops_per_sec\tallocs_per_op\titerations\trepetitions\n";
+
+    std::printf("%-56s %14s %14s %16s %12s\n", "benchmark", "median ns/op", "p99 ns/op", "ops/s", "allocs/op");
+
+    for(const entry& e : entries)
+    {
+        if(!matches(opts, e.name)) continue;
+
+        const result r   = run_benchmark(e.name, e.fn, opts);
+        const double ops = r.median_ns_per_op > 0.0 ? 1e9 / r.median_ns_per_op : 0.0;
+
+        std::printf("%-56s %14.3f %14.3f %16.0f %12.4f\n", r.name.c_str(), r.median_ns_per_op, r.p99_ns_per_op,
+                    ops, r.allocs_per_op);
+        std::fflush(stdout);
+
+        out << r.name << '\t' << std::fixed << std::setprecision(3)
+            << r.median_ns_per_op << '\t' << r.p99_ns_per_op << '\t' << r.min_ns_per_op << '\t'
+            << std::setprecision(0) << ops << '\t' << std::setprecision(4) << r.allocs_per_op << '\t'
+            << r.iterations << '\t' << r.repetitions << '\n';
+    }
+
+    return out ? 0 : 1;
+}
+
+}
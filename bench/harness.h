@@ -0,0 +1,198 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_BENCH_HARNESS_H
+#define OPEN_CPP_UTILS_BENCH_HARNESS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace open_cpp_utils::bench
+{
+
+/**
+ * \brief Number of global allocations made so far by any thread. Backed by the operator new replacement that is
+ *        linked into the benchmark executable.
+ */
+std::uint64_t allocation_count() noexcept;
+
+/**
+ * \brief Keeps the optimizer from discarding a value that is otherwise unused.
+ */
+template<typename T>
+inline void do_not_optimize(T const& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static_cast<void>(*static_cast<char const volatile*>(static_cast<void const volatile*>(&value)));
+#endif
+}
+
+/**
+ * \brief Forces pending writes to memory to be considered observable.
+ */
+inline void clobber_memory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+/**
+ * \brief Per-run state handed to a benchmark body.
+ *
+ * A body either iterates the state directly, which times exactly the loop:
+ * \code
+ * for(auto _ : state) { do_not_optimize(work()); }
+ * \endcode
+ * or, for bodies that have to orchestrate threads, reads iterations() and wraps the measured section in timed().
+ */
+class state
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    class iterator
+    {
+    public:
+        struct sentinel { };
+        struct [[maybe_unused]] value { };
+
+        explicit iterator(state* s) : state_(s), remaining_(s->iterations_) { }
+
+        value operator*() const { return { }; }
+        void  operator++()       { --remaining_; }
+
+        bool operator!=(sentinel) const
+        {
+            if(remaining_ != 0) return true;
+            state_->stop_timing();
+            return false;
+        }
+
+    private:
+        state*        state_;
+        std::uint64_t remaining_;
+    };
+
+    class scope
+    {
+    public:
+        explicit scope(state& s) : state_(s) { state_.start_timing(); }
+        ~scope() { state_.stop_timing(); }
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+    private:
+        state& state_;
+    };
+
+    explicit state(std::uint64_t iterations) : iterations_(iterations) { }
+
+    iterator           begin() { start_timing(); return iterator(this); }
+    iterator::sentinel end()   { return { }; }
+
+    /// Number of iterations the body must perform in this run.
+    std::uint64_t iterations() const { return iterations_; }
+
+    /// Declares how many logical operations one iteration performs; results are reported per operation.
+    void set_ops_per_iteration(std::uint64_t ops) { ops_per_iteration_ = ops == 0 ? 1 : ops; }
+
+    /// RAII helper timing an explicit region, for bodies that can't use the range-for form.
+    [[nodiscard]] scope timed() { return scope(*this); }
+
+    /// Excludes a section of the loop body (setup, verification) from the measurement.
+    void pause_timing()  { elapsed_ += clock::now() - start_; allocations_ += allocation_count() - alloc_start_; }
+    void resume_timing() { alloc_start_ = allocation_count(); start_ = clock::now(); }
+
+    void start_timing()
+    {
+        elapsed_     = clock::duration::zero();
+        allocations_ = 0;
+        resume_timing();
+    }
+
+    void stop_timing() { pause_timing(); }
+
+    std::uint64_t   ops()         const { return iterations_ * ops_per_iteration_; }
+    clock::duration elapsed()     const { return elapsed_; }
+    std::uint64_t   allocations() const { return allocations_; }
+
+private:
+    std::uint64_t     iterations_;
+    std::uint64_t     ops_per_iteration_ = 1;
+    clock::time_point start_;
+    clock::duration   elapsed_     = clock::duration::zero();
+    std::uint64_t     alloc_start_ = 0;
+    std::uint64_t     allocations_ = 0;
+};
+
+using benchmark_fn = void (*)(state&);
+
+/**
+ * \brief Aggregated measurement for one benchmark.
+ */
+struct result
+{
+    std::string   name;
+    double        median_ns_per_op;
+    double        p99_ns_per_op;
+    double        min_ns_per_op;
+    double        allocs_per_op;
+    std::uint64_t iterations;
+    std::size_t   repetitions;
+};
+
+/**
+ * \brief Runner configuration, populated from the command line.
+ */
+struct options
+{
+    std::vector<std::string>  filters;
+    std::string               output      = "bench_output.txt";
+    std::size_t               warmup      = 1;
+    std::size_t               repetitions = 11;
+    std::chrono::microseconds min_time    = std::chrono::microseconds(5000);
+    bool                      list_only   = false;
+};
+
+/**
+ * \brief Adds a benchmark to the global registry. Usually called through OCU_BENCHMARK.
+ */
+int register_benchmark(const char* name, benchmark_fn fn);
+
+/**
+ * \brief Runs a single benchmark: calibrates the iteration count so a repetition lasts at least min_time, runs the
+ *        warmup repetitions, then collects per-repetition ns/op and allocations/op.
+ */
+result run_benchmark(const char* name, benchmark_fn fn, const options& opts);
+
+/**
+ * \brief Parses the command line, runs every matching benchmark, prints a table and writes bench_output.txt.
+ */
+int run_main(int argc, char** argv);
+
+}
+
+#define OCU_BENCH_CONCAT_IMPL(a, b) a##b
+#define OCU_BENCH_CONCAT(a, b) OCU_BENCH_CONCAT_IMPL(a, b)
+
+/**
+ * \brief Registers a benchmark body with the given display name.
+ * \code
+ * OCU_BENCHMARK("object_pool/acquire_release")(open_cpp_utils::bench::state& state) { ... }
+ * \endcode
+ */
+#define OCU_BENCHMARK(name)                                                                                             \
+    static void OCU_BENCH_CONCAT(ocu_bench_fn_, __LINE__)(::open_cpp_utils::bench::state&);                           \
+    [[maybe_unused]] static const int OCU_BENCH_CONCAT(ocu_bench_reg_, __LINE__) =                                    \
+        ::open_cpp_utils::bench::register_benchmark(name, &OCU_BENCH_CONCAT(ocu_bench_fn_, __LINE__));                \
+    static void OCU_BENCH_CONCAT(ocu_bench_fn_, __LINE__)
+
+#endif // OPEN_CPP_UTILS_BENCH_HARNESS_H
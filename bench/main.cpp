@@ -0,0 +1,83 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Global allocation counting ==========================================================================================
+//
+// Every replaceable operator new funnels through counted_alloc so allocs/op covers the containers under test as well
+// as anything the standard library allocates on their behalf.
+
+namespace
+{
+
+std::atomic<std::uint64_t> g_allocations{ 0 };
+
+void* counted_alloc(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void* counted_alloc(std::size_t size, std::align_val_t align)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t a = static_cast<std::size_t>(align);
+#if defined(_WIN32)
+    if(void* p = _aligned_malloc(size == 0 ? 1 : size, a)) return p;
+#else
+    const std::size_t rounded = ((size == 0 ? 1 : size) + a - 1) / a * a;
+    if(void* p = std::aligned_alloc(a, rounded)) return p;
+#endif
+    throw std::bad_alloc();
+}
+
+void counted_free(void* p, std::align_val_t) noexcept
+{
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+}
+
+void* operator new(std::size_t size)                                                 { return counted_alloc(size); }
+void* operator new[](std::size_t size)                                               { return counted_alloc(size); }
+void* operator new(std::size_t size, std::align_val_t align)                         { return counted_alloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align)                       { return counted_alloc(size, align); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return counted_alloc(size); } catch(...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return counted_alloc(size); } catch(...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept                                               { std::free(p); }
+void operator delete[](void* p) noexcept                                             { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept                                  { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept                                { std::free(p); }
+void operator delete(void* p, std::align_val_t align) noexcept                       { counted_free(p, align); }
+void operator delete[](void* p, std::align_val_t align) noexcept                     { counted_free(p, align); }
+void operator delete(void* p, std::size_t, std::align_val_t align) noexcept          { counted_free(p, align); }
+void operator delete[](void* p, std::size_t, std::align_val_t align) noexcept        { counted_free(p, align); }
+
+std::uint64_t open_cpp_utils::bench::allocation_count() noexcept
+{
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+int main(int argc, char** argv)
+{
+    return open_cpp_utils::bench::run_main(argc, argv);
+}
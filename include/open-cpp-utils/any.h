@@ -0,0 +1,359 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_ANY_H
+#define OPEN_CPP_UTILS_ANY_H
+
+#include "config.h"
+#include "template_utils.h"
+
+#include <any>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace open_cpp_utils
+{
+
+template<std::size_t InlineSize>
+class any;
+
+namespace detail
+{
+
+template<typename T>
+struct is_any_specialization : std::false_type { };
+
+template<std::size_t N>
+struct is_any_specialization<any<N>> : std::true_type { };
+
+template<typename T>
+struct is_in_place_type : std::false_type { };
+
+template<typename T>
+struct is_in_place_type<std::in_place_type_t<T>> : std::true_type { };
+
+}
+
+// any =================================================================================================================
+
+/**
+ * \brief Type-erased value container like std::any, with a configurable inline buffer and no RTTI.
+ *
+ * Values of up to InlineSize bytes (with at most 8 byte alignment and a non-throwing move) live inside the any;
+ * everything else is heap allocated. The held type is identified by a pointer to a per-type, per-InlineSize table of
+ * operations, so any_cast<T> is one pointer comparison followed by a compile-time known address computation.
+ * type() exposes the held type as a type_id for comparisons that don't know T.
+ *
+ * Moving an any copies the buffer with memcpy when the payload is trivially relocatable (which includes every heap
+ * payload, since only the pointer moves) and otherwise calls the payload's move constructor.
+ *
+ * \tparam InlineSize Bytes of inline storage, at least sizeof(void*). sizeof(any<N>) is N rounded up to 8, plus one
+ *                    pointer.
+ */
+template<std::size_t InlineSize = 4 * sizeof(void*)>
+class any
+{
+    static_assert(InlineSize >= sizeof(void*), "any needs room for at least a pointer");
+
+// Typedefs ============================================================================================================
+
+private:
+    union storage
+    {
+        void*                  heap;
+        alignas(8) std::byte   buffer[InlineSize];
+    };
+
+    struct vtable
+    {
+        type_id type;
+        void  (*destroy)(storage&) noexcept;
+        void  (*copy)(storage& dst, const storage& src);
+        void  (*relocate)(storage& dst, storage& src) noexcept; ///< nullptr means memcpy
+    };
+
+public:
+    static constexpr std::size_t inline_size = InlineSize;
+
+    /**
+     * \brief True if a T is stored inside the any rather than on the heap
+     */
+    template<typename T>
+    static constexpr bool stores_inline = sizeof(T) <= InlineSize
+                                       && alignof(T) <= alignof(storage)
+                                       && std::is_nothrow_move_constructible_v<T>;
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    constexpr any() noexcept = default;
+
+    any(const any& other)
+        : vtable_(other.vtable_)
+    {
+        if(vtable_) vtable_->copy(storage_, other.storage_);
+    }
+
+    any(any&& other) noexcept
+        : vtable_(other.vtable_)
+    {
+        if(vtable_) relocate_from_(other);
+    }
+
+    template<typename T, typename D = std::decay_t<T>>
+        requires (!detail::is_any_specialization<D>::value && !detail::is_in_place_type<D>::value
+                  && std::is_copy_constructible_v<D>)
+    any(T&& value)
+    {
+        emplace_<D>(std::forward<T>(value));
+    }
+
+    template<typename T, typename...Args>
+        requires std::is_copy_constructible_v<std::decay_t<T>>
+    explicit any(std::in_place_type_t<T>, Args&&...args)
+    {
+        emplace_<std::decay_t<T>>(std::forward<Args>(args)...);
+    }
+
+    template<typename T, typename U, typename...Args>
+        requires std::is_copy_constructible_v<std::decay_t<T>>
+    explicit any(std::in_place_type_t<T>, std::initializer_list<U> il, Args&&...args)
+    {
+        emplace_<std::decay_t<T>>(il, std::forward<Args>(args)...);
+    }
+
+    ~any() { reset(); }
+
+// Assignment ----------------------------------------------------------------------------------------------------------
+
+    any& operator=(const any& other)
+    {
+        if(this != &other) any(other).swap(*this);
+        return *this;
+    }
+
+    any& operator=(any&& other) noexcept
+    {
+        if(this != &other)
+        {
+            reset();
+            vtable_ = other.vtable_;
+            if(vtable_) relocate_from_(other);
+        }
+        return *this;
+    }
+
+    template<typename T, typename D = std::decay_t<T>>
+        requires (!detail::is_any_specialization<D>::value && std::is_copy_constructible_v<D>)
+    any& operator=(T&& value)
+    {
+        any(std::forward<T>(value)).swap(*this);
+        return *this;
+    }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Destroys the current value and constructs a T in place. If the constructor throws, the any is empty.
+     */
+    template<typename T, typename...Args>
+        requires std::is_copy_constructible_v<std::decay_t<T>>
+    std::decay_t<T>& emplace(Args&&...args)
+    {
+        reset();
+        return emplace_<std::decay_t<T>>(std::forward<Args>(args)...);
+    }
+
+    void reset() noexcept
+    {
+        if(vtable_ == nullptr) return;
+        if(vtable_->destroy) vtable_->destroy(storage_);
+        vtable_ = nullptr;
+    }
+
+    void swap(any& other) noexcept
+    {
+        if(this == &other) return;
+        any tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend void swap(any& a, any& b) noexcept { a.swap(b); }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] bool has_value() const noexcept { return vtable_ != nullptr; }
+
+    /**
+     * \brief Identity of the held type, or a null type_id when empty
+     */
+    [[nodiscard]] type_id type() const noexcept { return vtable_ ? vtable_->type : type_id{ }; }
+
+    template<typename T>
+    [[nodiscard]] bool holds() const noexcept { return vtable_ == &vtable_for_<std::remove_cvref_t<T>>; }
+
+    /**
+     * \brief Pointer to the held T, or nullptr if the any holds something else
+     */
+    template<typename T>
+    [[nodiscard]] OCU_FORCEINLINE T* get_if() noexcept
+    {
+        using D = std::remove_cvref_t<T>;
+        if(vtable_ != &vtable_for_<D>) return nullptr;
+        return payload_<D>(storage_);
+    }
+
+    template<typename T>
+    [[nodiscard]] OCU_FORCEINLINE const T* get_if() const noexcept
+    {
+        return const_cast<any*>(this)->template get_if<T>();
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    template<typename T>
+    static T* payload_(storage& s) noexcept
+    {
+        if constexpr(stores_inline<T>) return std::launder(reinterpret_cast<T*>(s.buffer));
+        else                            return static_cast<T*>(s.heap);
+    }
+
+    template<typename T>
+    static const T* payload_(const storage& s) noexcept
+    {
+        return payload_<T>(const_cast<storage&>(s));
+    }
+
+    template<typename T, typename...Args>
+    T& emplace_(Args&&...args)
+    {
+        if constexpr(stores_inline<T>)
+        {
+            ::new(static_cast<void*>(storage_.buffer)) T(std::forward<Args>(args)...);
+        }
+        else
+        {
+            storage_.heap = new T(std::forward<Args>(args)...);
+        }
+        vtable_ = &vtable_for_<T>;
+        return *payload_<T>(storage_);
+    }
+
+    void relocate_from_(any& other) noexcept
+    {
+        if(vtable_->relocate) vtable_->relocate(storage_, other.storage_);
+        else                  std::memcpy(&storage_, &other.storage_, sizeof(storage));
+        other.vtable_ = nullptr;
+    }
+
+    template<typename T>
+    static void destroy_(storage& s) noexcept
+    {
+        if constexpr(stores_inline<T>) std::destroy_at(payload_<T>(s));
+        else                            delete payload_<T>(s);
+    }
+
+    template<typename T>
+    static void copy_(storage& dst, const storage& src)
+    {
+        if constexpr(stores_inline<T>) ::new(static_cast<void*>(dst.buffer)) T(*payload_<T>(src));
+        else                            dst.heap = new T(*payload_<T>(src));
+    }
+
+    template<typename T>
+    static void relocate_(storage& dst, storage& src) noexcept
+    {
+        T* from = payload_<T>(src);
+        ::new(static_cast<void*>(dst.buffer)) T(std::move(*from));
+        std::destroy_at(from);
+    }
+
+    template<typename T>
+    static constexpr bool memcpy_relocatable_ = !stores_inline<T> || is_trivially_relocatable_v<T>;
+
+    template<typename T>
+    static constexpr vtable vtable_for_ = {
+        type_id::of<T>(),
+        stores_inline<T> && std::is_trivially_destructible_v<T> ? nullptr : &destroy_<T>,
+        &copy_<T>,
+        memcpy_relocatable_<T> ? nullptr : &relocate_<T>
+    };
+
+// Variables ===========================================================================================================
+
+private:
+    const vtable* vtable_ = nullptr;
+    storage       storage_;
+};
+
+// Casts ===============================================================================================================
+
+using std::bad_any_cast;
+
+/**
+ * \brief Pointer to the held T, or nullptr if a is null or holds a different type
+ */
+template<typename T, std::size_t N>
+[[nodiscard]] OCU_FORCEINLINE T* any_cast(any<N>* a) noexcept
+{
+    return a ? a->template get_if<T>() : nullptr;
+}
+
+template<typename T, std::size_t N>
+[[nodiscard]] OCU_FORCEINLINE const T* any_cast(const any<N>* a) noexcept
+{
+    return a ? a->template get_if<T>() : nullptr;
+}
+
+/**
+ * \brief Reference access to the held value
+ * \throws std::bad_any_cast if a holds a different type
+ */
+template<typename T, std::size_t N>
+[[nodiscard]] T any_cast(any<N>& a)
+{
+    using D = std::remove_cvref_t<T>;
+    D* p = a.template get_if<D>();
+    if(OCU_UNLIKELY(p == nullptr)) throw bad_any_cast();
+    return static_cast<T>(*p);
+}
+
+template<typename T, std::size_t N>
+[[nodiscard]] T any_cast(const any<N>& a)
+{
+    using D = std::remove_cvref_t<T>;
+    const D* p = a.template get_if<D>();
+    if(OCU_UNLIKELY(p == nullptr)) throw bad_any_cast();
+    return static_cast<T>(*p);
+}
+
+template<typename T, std::size_t N>
+[[nodiscard]] T any_cast(any<N>&& a)
+{
+    using D = std::remove_cvref_t<T>;
+    D* p = a.template get_if<D>();
+    if(OCU_UNLIKELY(p == nullptr)) throw bad_any_cast();
+    return static_cast<T>(std::move(*p));
+}
+
+template<typename T, std::size_t N = 4 * sizeof(void*), typename...Args>
+[[nodiscard]] any<N> make_any(Args&&...args)
+{
+    return any<N>(std::in_place_type<T>, std::forward<Args>(args)...);
+}
+
+}
+
+#endif // OPEN_CPP_UTILS_ANY_H
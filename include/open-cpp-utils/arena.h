@@ -0,0 +1,366 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_ARENA_H
+#define OPEN_CPP_UTILS_ARENA_H
+
+#include "config.h"
+#include "memory_stats.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace open_cpp_utils
+{
+
+/**
+ * \brief Bump-pointer arena for allocations that all die together.
+ *
+ * Memory is carved out of blocks by advancing a pointer; individual allocations are never freed. reset() rewinds to
+ * the first block in O(1) and keeps every block that was allocated so far, so an arena reused per frame or per
+ * request reaches a steady state with no heap traffic at all. release() hands the heap blocks back.
+ *
+ * An arena can start from caller supplied storage (see inline_arena for the stack-allocated form); heap blocks are
+ * only added once that storage is exhausted.
+ *
+ * Destructors of objects created in the arena are not run. The arena is not thread safe.
+ */
+class monotonic_arena
+{
+// Typedefs ============================================================================================================
+
+public:
+    using size_type = std::size_t;
+
+    static constexpr size_type default_block_size = 64 * 1024;
+    static constexpr size_type max_block_size     = 16 * 1024 * 1024;
+
+private:
+    struct block
+    {
+        block*    next;
+        size_type size;   // Total size including this header
+        bool      owned;  // False for caller supplied storage
+
+        std::uintptr_t begin() const noexcept
+        {
+            return reinterpret_cast<std::uintptr_t>(this) + header_size;
+        }
+
+        std::uintptr_t end() const noexcept { return reinterpret_cast<std::uintptr_t>(this) + size; }
+    };
+
+    static constexpr size_type header_size = (sizeof(block) + alignof(std::max_align_t) - 1)
+                                           / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Creates an empty arena; the first allocation allocates a block of block_size bytes
+     */
+    explicit monotonic_arena(size_type block_size = default_block_size) noexcept
+        : next_block_size_(std::max(block_size, header_size * 2))
+    { }
+
+    /**
+     * \brief Creates an arena that serves allocations from buffer until it is exhausted
+     * \param buffer     Initial storage, must outlive the arena
+     * \param size       Size of buffer in bytes
+     * \param block_size Size of the first heap block once buffer is full
+     */
+    monotonic_arena(void* buffer, size_type size, size_type block_size = default_block_size) noexcept
+        : monotonic_arena(block_size)
+    {
+        const std::uintptr_t raw     = reinterpret_cast<std::uintptr_t>(buffer);
+        const std::uintptr_t aligned = align_up_(raw, alignof(block));
+        if(aligned + header_size >= raw + size) return;
+
+        block* b = ::new(reinterpret_cast<void*>(aligned)) block{ nullptr, raw + size - aligned, false };
+        first_ = current_ = b;
+        cursor_ = b->begin();
+        end_    = b->end();
+    }
+
+    monotonic_arena(const monotonic_arena&) = delete;
+    monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+    ~monotonic_arena() { release(); }
+
+// Allocation ----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Allocates bytes with the given alignment
+     * \throws std::bad_alloc if a new block is required and cannot be allocated
+     */
+    [[nodiscard]] void* allocate(size_type bytes, size_type alignment = alignof(std::max_align_t))
+    {
+        OCU_ASSERT(alignment && (alignment & (alignment - 1)) == 0, "arena alignment must be a power of two");
+
+        // p - 1 < end_ fails both for an arena without blocks (p == 0) and for a cursor aligned past the end
+        const std::uintptr_t p = align_up_(cursor_, alignment);
+        if(OCU_LIKELY(p - 1 < end_ && bytes <= end_ - p))
+        {
+            cursor_ = p + bytes;
+            return reinterpret_cast<void*>(p);
+        }
+        return allocate_slow_(bytes, alignment);
+    }
+
+    /**
+     * \brief Allocates uninitialized storage for count objects of type T
+     */
+    template<typename T>
+    [[nodiscard]] T* allocate_array(size_type count)
+    {
+        if(count > static_cast<size_type>(-1) / sizeof(T)) throw std::bad_array_new_length();
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * \brief Constructs a T in the arena. Its destructor will not be called by the arena.
+     */
+    template<typename T, typename...Args>
+    [[nodiscard]] T* create(Args&&...args)
+    {
+        return ::new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * \brief Invalidates every allocation and rewinds to the first block. Blocks are kept for reuse.
+     */
+    void reset() noexcept
+    {
+        current_ = first_;
+        cursor_  = first_ ? first_->begin() : 0;
+        end_     = first_ ? first_->end()   : 0;
+    }
+
+    /**
+     * \brief Invalidates every allocation and frees all heap blocks, keeping only caller supplied storage.
+     */
+    void release() noexcept
+    {
+        block* keep = nullptr;
+        for(block* b = first_; b;)
+        {
+            block* next = b->next;
+            if(b->owned) free_block_(b);
+            else         keep = b;
+            b = next;
+        }
+
+        if(keep) keep->next = nullptr;
+        first_ = keep;
+        reset();
+    }
+
+// Capacity ------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Bytes consumed since the last reset, including alignment padding and the unused tails of full blocks
+     */
+    [[nodiscard]] size_type used() const noexcept
+    {
+        if(current_ == nullptr) return 0;
+
+        size_type total = 0;
+        for(block* b = first_; b != current_; b = b->next) total += b->size - header_size;
+        return total + (cursor_ - current_->begin());
+    }
+
+    /**
+     * \brief Total bytes held in blocks, including caller supplied storage
+     */
+    [[nodiscard]] size_type capacity() const noexcept
+    {
+        size_type total = 0;
+        for(block* b = first_; b; b = b->next) total += b->size - header_size;
+        return total;
+    }
+
+    /**
+     * \brief Checks if p points into memory owned by this arena
+     */
+    [[nodiscard]] bool owns(const void* p) const noexcept
+    {
+        const std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(p);
+        for(block* b = first_; b; b = b->next)
+        {
+            if(addr >= b->begin() && addr < b->end()) return true;
+        }
+        return false;
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    static constexpr std::uintptr_t align_up_(std::uintptr_t p, size_type alignment) noexcept
+    {
+        return (p + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+    }
+
+    OCU_NOINLINE void* allocate_slow_(size_type bytes, size_type alignment)
+    {
+        const size_type slack  = alignment > alignof(std::max_align_t) ? alignment : 0;
+        const size_type needed = header_size + bytes + slack;
+        if(bytes > static_cast<size_type>(-1) - header_size - slack) throw std::bad_alloc();
+
+        // Walk blocks retained from before the last reset before allocating fresh ones
+        while(current_ && current_->next)
+        {
+            block* next = current_->next;
+            const std::uintptr_t p = align_up_(next->begin(), alignment);
+            if(p > next->end() || bytes > next->end() - p)
+            {
+                // Too small for this request, keep it for later but allocate in front of it
+                break;
+            }
+
+            current_ = next;
+            cursor_  = p + bytes;
+            end_     = next->end();
+            return reinterpret_cast<void*>(p);
+        }
+
+        const size_type size = std::max(needed, next_block_size_);
+        next_block_size_     = std::min(next_block_size_ * 2, max_block_size);
+
+        block* b = allocate_block_(size);
+        if(current_)
+        {
+            b->next        = current_->next;
+            current_->next = b;
+        }
+        else
+        {
+            b->next = first_;
+            first_  = b;
+        }
+
+        current_ = b;
+        const std::uintptr_t p = align_up_(b->begin(), alignment);
+        cursor_ = p + bytes;
+        end_    = b->end();
+        return reinterpret_cast<void*>(p);
+    }
+
+    static block* allocate_block_(size_type size)
+    {
+        void* mem = ::operator new(size);
+        detail::track_allocation(memory_tag::arena, size);
+        return ::new(mem) block{ nullptr, size, true };
+    }
+
+    static void free_block_(block* b) noexcept
+    {
+        detail::track_deallocation(memory_tag::arena, b->size);
+        ::operator delete(static_cast<void*>(b));
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    block*         first_   = nullptr;
+    block*         current_ = nullptr;
+    std::uintptr_t cursor_  = 0;
+    std::uintptr_t end_     = 0;
+    size_type      next_block_size_;
+};
+
+namespace detail
+{
+
+template<std::size_t N>
+struct inline_arena_storage
+{
+    alignas(std::max_align_t) std::byte buffer_[N];
+};
+
+}
+
+/**
+ * \brief monotonic_arena whose first N bytes live inside the object itself, e.g. on the stack of a request handler.
+ */
+template<std::size_t N>
+class inline_arena : private detail::inline_arena_storage<N>, public monotonic_arena
+{
+public:
+    explicit inline_arena(size_type block_size = default_block_size) noexcept
+        : monotonic_arena(this->buffer_, N, block_size)
+    { }
+};
+
+/**
+ * \brief std::pmr::memory_resource drawing from a monotonic_arena, so pmr containers can live in an arena.
+ *
+ * Deallocation is a no-op; memory comes back when the arena is reset. Resources compare equal only to themselves,
+ * as with std::pmr::monotonic_buffer_resource.
+ */
+class arena_resource : public std::pmr::memory_resource
+{
+public:
+    explicit arena_resource(monotonic_arena& arena) noexcept : arena_(&arena) { }
+
+    [[nodiscard]] monotonic_arena& arena() const noexcept { return *arena_; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        return arena_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override { }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        // Identity rather than a dynamic_cast keeps the header usable with -fno-rtti
+        return this == &other;
+    }
+
+    monotonic_arena* arena_;
+};
+
+/**
+ * \brief Stateful standard allocator over a monotonic_arena, for containers that should skip the virtual dispatch of
+ *        std::pmr::polymorphic_allocator.
+ */
+template<typename T>
+class arena_allocator
+{
+public:
+    using value_type = T;
+
+    explicit arena_allocator(monotonic_arena& arena) noexcept : arena_(&arena) { }
+
+    template<typename U>
+    arena_allocator(const arena_allocator<U>& other) noexcept : arena_(&other.arena()) { }
+
+    [[nodiscard]] T* allocate(std::size_t n) { return arena_->allocate_array<T>(n); }
+    void deallocate(T*, std::size_t) noexcept { }
+
+    [[nodiscard]] monotonic_arena& arena() const noexcept { return *arena_; }
+
+    template<typename U>
+    friend bool operator==(const arena_allocator& a, const arena_allocator<U>& b) noexcept
+    {
+        return &a.arena() == &b.arena();
+    }
+
+private:
+    monotonic_arena* arena_;
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_ARENA_H
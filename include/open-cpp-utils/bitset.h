@@ -0,0 +1,855 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_BITSET_H
+#define OPEN_CPP_UTILS_BITSET_H
+
+#include "config.h"
+#include "cpu_features.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// The NEON popcount reduces across the vector, which is AArch64-only
+#if defined(OCU_HAS_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#   define OCU_BITSET_NEON 1
+#endif
+
+#if defined(OCU_ARCH_X86)
+#   include <immintrin.h>
+#elif defined(OCU_BITSET_NEON)
+#   include <arm_neon.h>
+#endif
+
+namespace open_cpp_utils
+{
+
+// Kernels =============================================================================================================
+//
+// Whole-array operations on 64-bit words, implemented once per simd_level and reached through a bitset_kernels table
+// chosen on first use from host_cpu(), the same way as string_utils. The binary operations are plain loads, one
+// logic instruction and a store, so the SSE4.2 level keeps the scalar ones (which the compiler already vectorizes
+// with SSE2) and only adds the popcnt instruction.
+
+namespace detail
+{
+
+enum class bit_op : std::uint8_t
+{
+    and_,
+    or_,
+    xor_,
+    andnot,
+};
+
+struct bitset_kernels
+{
+    /// dst[i] = dst[i] & src[i] for i < n; dst may equal src
+    void        (*bit_and)(std::uint64_t* dst, const std::uint64_t* src, std::size_t n) noexcept;
+    void        (*bit_or)(std::uint64_t* dst, const std::uint64_t* src, std::size_t n) noexcept;
+    void        (*bit_xor)(std::uint64_t* dst, const std::uint64_t* src, std::size_t n) noexcept;
+    /// dst[i] = dst[i] & ~src[i]
+    void        (*bit_andnot)(std::uint64_t* dst, const std::uint64_t* src, std::size_t n) noexcept;
+    /// Set bits in p[0, n)
+    std::size_t (*popcount)(const std::uint64_t* p, std::size_t n) noexcept;
+    /// Set bits in a[i] & b[i] over i < n, without writing the intersection out
+    std::size_t (*popcount_and)(const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept;
+};
+
+template<bit_op Op>
+[[nodiscard]] constexpr std::uint64_t apply_(std::uint64_t a, std::uint64_t b) noexcept
+{
+    if constexpr(Op == bit_op::and_)      return a & b;
+    else if constexpr(Op == bit_op::or_)  return a | b;
+    else if constexpr(Op == bit_op::xor_) return a ^ b;
+    else                                  return a & ~b;
+}
+
+/**
+ * \brief Position of the k-th (from 0) set bit of w; k must be below popcount(w).
+ *
+ * With BMI2 this is one pdep, which deposits a single bit at the k-th set position. Otherwise the byte popcounts
+ * are summed into running totals with one multiply, the byte holding the bit is found by comparing all eight totals
+ * against k at once, and the bit within that byte by clearing its lowest set bits.
+ */
+[[nodiscard]] inline unsigned select_in_word(std::uint64_t w, unsigned k) noexcept
+{
+#if defined(__BMI2__)
+    return static_cast<unsigned>(std::countr_zero(_pdep_u64(std::uint64_t(1) << k, w)));
+#else
+    constexpr std::uint64_t ones = 0x0101010101010101;
+
+    std::uint64_t s = w - ((w >> 1) & 0x5555555555555555);
+    s = (s & 0x3333333333333333) + ((s >> 2) & 0x3333333333333333);
+    s = (s + (s >> 4)) & 0x0F0F0F0F0F0F0F0F;
+
+    // Byte i of prefix counts the set bits in bytes 0..i; none exceeds 64, so (k | 0x80) - prefix never borrows and
+    // keeps its top bit exactly when that total is at most k
+    const std::uint64_t prefix = s * ones;
+    const std::uint64_t le     = ((k * ones) | (0x80 * ones)) - prefix;
+    const unsigned      byte   = static_cast<unsigned>(std::popcount(le & (0x80 * ones)));
+    const unsigned      before = byte == 0 ? 0 : static_cast<unsigned>((prefix >> (8 * byte - 8)) & 0xFF);
+
+    unsigned bits = static_cast<unsigned>((w >> (8 * byte)) & 0xFF);
+    for(unsigned r = k - before; r != 0; --r) bits &= bits - 1;
+    return 8 * byte + static_cast<unsigned>(std::countr_zero(bits));
+#endif
+}
+
+// Scalar --------------------------------------------------------------------------------------------------------------
+
+namespace scalar_kernels
+{
+
+template<bit_op Op>
+inline void bitwise(std::uint64_t* dst, const std::uint64_t* src, std::size_t n) noexcept
+{
+    for(std::size_t i = 0; i < n; ++i) dst[i] = apply_<Op>(dst[i], src[i]);
+}
+
+inline std::size_t popcount(const std::uint64_t* p, std::size_t n) noexcept
+{
+    std::size_t c = 0;
+    for(std::size_t i = 0; i < n; ++i) c += static_cast<std::size_t>(std::popcount(p[i]));
+    return c;
+}
+
+inline std::size_t popcount_and(const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+{
+    std::size_t c = 0;
+    for(std::size_t i = 0; i < n; ++i) c += static_cast<std::size_t>(std::popcount(a[i] & b[i]));
+    return c;
+}
+
+}
+
+inline constexpr bitset_kernels scalar_bitset_kernels{
+    &scalar_kernels::bitwise<bit_op::and_>, &scalar_kernels::bitwise<bit_op::or_>,
+    &scalar_kernels::bitwise<bit_op::xor_>, &scalar_kernels::bitwise<bit_op::andnot>,
+    &scalar_kernels::popcount,              &scalar_kernels::popcount_and
+};
+
+#if defined(OCU_ARCH_X86)
+
+// SSE4.2 --------------------------------------------------------------------------------------------------------------
+
+namespace sse42_kernels
+{
+
+OCU_TARGET_SSE42 inline std::size_t popcount(const std::uint64_t* p, std::size_t n) noexcept
+{
+    std::size_t c = 0;
+    for(std::size_t i = 0; i < n; ++i) c += static_cast<std::size_t>(_mm_popcnt_u64(p[i]));
+    return c;
+}
+
+OCU_TARGET_SSE42 inline std::size_t popcount_and(const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+{
+    std::size_t c = 0;
+    for(std::size_t i = 0; i < n; ++i) c += static_cast<std::size_t>(_mm_popcnt_u64(a[i] & b[i]));
+    return c;
+}
+
+}
+
+inline constexpr bitset_kernels sse42_bitset_kernels{
+    &scalar_kernels::bitwise<bit_op::and_>, &scalar_kernels::bitwise<bit_op::or_>,
+    &scalar_kernels::bitwise<bit_op::xor_>, &scalar_kernels::bitwise<bit_op::andnot>,
+    &sse42_kernels::popcount,               &sse42_kernels::popcount_and
+};
+
+// AVX2 ----------------------------------------------------------------------------------------------------------------
+
+namespace avx2_kernels
+{
+
+template<bit_op Op>
+OCU_TARGET_AVX2 inline __m256i apply(__m256i a, __m256i b) noexcept
+{
+    if constexpr(Op == bit_op::and_)      return _mm256_and_si256(a, b);
+    else if constexpr(Op == bit_op::or_)  return _mm256_or_si256(a, b);
+    else if constexpr(Op == bit_op::xor_) return _mm256_xor_si256(a, b);
+    else                                  return _mm256_andnot_si256(b, a);
+}
+
+template<bit_op Op>
+OCU_TARGET_AVX2 inline void bitwise(std::uint64_t* dst, const std::uint64_t* src, std::size_t n) noexcept
+{
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        const __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i + 4));
+        const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),     apply<Op>(a0, b0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 4), apply<Op>(a1, b1));
+    }
+    for(; i < n; ++i) dst[i] = apply_<Op>(dst[i], src[i]);
+}
+
+/// Popcount of every byte of v, as two nibble lookups (Mula, Kurz & Lemire)
+OCU_TARGET_AVX2 inline __m256i popcount_bytes(__m256i v) noexcept
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low   = _mm256_set1_epi8(0x0F);
+    const __m256i lo    = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low));
+    const __m256i hi    = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+    return _mm256_add_epi8(lo, hi);
+}
+
+/**
+ * \brief Sums popcount_bytes(load(i)) over 4-word steps. Each byte lane gains at most 8 per step, so 31 steps are
+ *        accumulated in bytes before one sad folds them into the 64-bit totals.
+ */
+template<typename Load>
+OCU_TARGET_AVX2 inline std::size_t popcount_blocks(std::size_t n, Load load) noexcept
+{
+    __m256i     total = _mm256_setzero_si256();
+    std::size_t i     = 0;
+    while(i + 4 <= n)
+    {
+        const std::size_t end = std::min(n & ~std::size_t(3), i + 4 * 31);
+        __m256i           acc = _mm256_setzero_si256();
+        for(; i < end; i += 4) acc = _mm256_add_epi8(acc, popcount_bytes(load(i)));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(acc, _mm256_setzero_si256()));
+    }
+    const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+    return static_cast<std::size_t>(_mm_cvtsi128_si64(sum)) + static_cast<std::size_t>(_mm_extract_epi64(sum, 1));
+}
+
+struct load_words
+{
+    const std::uint64_t* p;
+
+    OCU_TARGET_AVX2 __m256i operator()(std::size_t i) const noexcept
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+    }
+};
+
+struct load_and
+{
+    const std::uint64_t* a;
+    const std::uint64_t* b;
+
+    OCU_TARGET_AVX2 __m256i operator()(std::size_t i) const noexcept
+    {
+        return _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+    }
+};
+
+OCU_TARGET_AVX2 inline std::size_t popcount(const std::uint64_t* p, std::size_t n) noexcept
+{
+    std::size_t c = popcount_blocks(n, load_words{ p });
+    for(std::size_t i = n & ~std::size_t(3); i < n; ++i) c += static_cast<std::size_t>(_mm_popcnt_u64(p[i]));
+    return c;
+}
+
+OCU_TARGET_AVX2 inline std::size_t popcount_and(const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+{
+    std::size_t c = popcount_blocks(n, load_and{ a, b });
+    for(std::size_t i = n & ~std::size_t(3); i < n; ++i) c += static_cast<std::size_t>(_mm_popcnt_u64(a[i] & b[i]));
+    return c;
+}
+
+}
+
+inline constexpr bitset_kernels avx2_bitset_kernels{
+    &avx2_kernels::bitwise<bit_op::and_>, &avx2_kernels::bitwise<bit_op::or_>,
+    &avx2_kernels::bitwise<bit_op::xor_>, &avx2_kernels::bitwise<bit_op::andnot>,
+    &avx2_kernels::popcount,              &avx2_kernels::popcount_and
+};
+
+#endif
+
+#if defined(OCU_BITSET_NEON)
+
+// NEON ----------------------------------------------------------------------------------------------------------------
+
+namespace neon_kernels
+{
+
+template<bit_op Op>
+OCU_FORCEINLINE uint64x2_t apply(uint64x2_t a, uint64x2_t b) noexcept
+{
+    if constexpr(Op == bit_op::and_)      return vandq_u64(a, b);
+    else if constexpr(Op == bit_op::or_)  return vorrq_u64(a, b);
+    else if constexpr(Op == bit_op::xor_) return veorq_u64(a, b);
+    else                                  return vbicq_u64(a, b);
+}
+
+template<bit_op Op>
+inline void bitwise(std::uint64_t* dst, const std::uint64_t* src, std::size_t n) noexcept
+{
+    std::size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        const uint64x2_t r0 = apply<Op>(vld1q_u64(dst + i),     vld1q_u64(src + i));
+        const uint64x2_t r1 = apply<Op>(vld1q_u64(dst + i + 2), vld1q_u64(src + i + 2));
+        vst1q_u64(dst + i,     r0);
+        vst1q_u64(dst + i + 2, r1);
+    }
+    for(; i < n; ++i) dst[i] = apply_<Op>(dst[i], src[i]);
+}
+
+/// Byte popcounts widened pairwise into the two 64-bit lanes of acc
+OCU_FORCEINLINE uint64x2_t accumulate(uint64x2_t acc, uint64x2_t v) noexcept
+{
+    return vpadalq_u32(acc, vpaddlq_u16(vpaddlq_u8(vcntq_u8(vreinterpretq_u8_u64(v)))));
+}
+
+inline std::size_t popcount(const std::uint64_t* p, std::size_t n) noexcept
+{
+    uint64x2_t  acc = vdupq_n_u64(0);
+    std::size_t i   = 0;
+    for(; i + 2 <= n; i += 2) acc = accumulate(acc, vld1q_u64(p + i));
+    std::size_t c = static_cast<std::size_t>(vaddvq_u64(acc));
+    if(i < n) c += static_cast<std::size_t>(std::popcount(p[i]));
+    return c;
+}
+
+inline std::size_t popcount_and(const std::uint64_t* a, const std::uint64_t* b, std::size_t n) noexcept
+{
+    uint64x2_t  acc = vdupq_n_u64(0);
+    std::size_t i   = 0;
+    for(; i + 2 <= n; i += 2) acc = accumulate(acc, vandq_u64(vld1q_u64(a + i), vld1q_u64(b + i)));
+    std::size_t c = static_cast<std::size_t>(vaddvq_u64(acc));
+    if(i < n) c += static_cast<std::size_t>(std::popcount(a[i] & b[i]));
+    return c;
+}
+
+}
+
+inline constexpr bitset_kernels neon_bitset_kernels{
+    &neon_kernels::bitwise<bit_op::and_>, &neon_kernels::bitwise<bit_op::or_>,
+    &neon_kernels::bitwise<bit_op::xor_>, &neon_kernels::bitwise<bit_op::andnot>,
+    &neon_kernels::popcount,              &neon_kernels::popcount_and
+};
+
+#endif
+
+/**
+ * \brief Kernel table for a level, or the scalar one when this build has no kernels for it. Calling the result on a
+ *        host without the level's instructions faults; use host_simd_level() unless comparing levels.
+ */
+[[nodiscard]] inline const bitset_kernels& bitset_kernels_for(simd_level level) noexcept
+{
+    switch(level)
+    {
+#if defined(OCU_ARCH_X86)
+    case simd_level::avx2:  return avx2_bitset_kernels;
+    case simd_level::sse42: return sse42_bitset_kernels;
+#endif
+#if defined(OCU_BITSET_NEON)
+    case simd_level::neon:  return neon_bitset_kernels;
+#endif
+    default:                return scalar_bitset_kernels;
+    }
+}
+
+/// The table for this host, resolved once unless the baseline instruction set already decides it
+[[nodiscard]] inline const bitset_kernels& active_bitset_kernels() noexcept
+{
+#if defined(OCU_HAS_AVX2)
+    return avx2_bitset_kernels;
+#elif defined(OCU_BITSET_NEON)
+    return neon_bitset_kernels;
+#else
+    static const bitset_kernels& kernels = bitset_kernels_for(host_simd_level());
+    return kernels;
+#endif
+}
+
+}
+
+// dynamic_bitset ======================================================================================================
+
+/**
+ * \brief Resizable sequence of bits packed into 64-bit words, for masks over many items.
+ *
+ * Unlike std::vector<bool>, the words are exposed and every whole-set operation works a word (or a vector of words)
+ * at a time: the logic operators and counts go through SIMD kernels, and for_each_set_bit visits only the set bits
+ * with one countr_zero each. Bits past size() in the last word are always zero, so counts and comparisons never
+ * need to mask them.
+ *
+ * The binary operators accept sets of different sizes: the other operand is treated as zero-extended or truncated
+ * to this set's size, so masks built over different ID ranges can be combined directly.
+ */
+class dynamic_bitset
+{
+// Typedefs ============================================================================================================
+
+public:
+    using size_type = std::size_t;
+    using word_type = std::uint64_t;
+
+    static constexpr size_type word_bits = 64;
+    static constexpr size_type npos      = static_cast<size_type>(-1);
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    dynamic_bitset() noexcept = default;
+
+    /// n bits, every one set to value
+    explicit dynamic_bitset(size_type n, bool value = false)
+        : words_(words_for_(n), value ? ~word_type(0) : 0), size_(n)
+    {
+        clear_tail_();
+    }
+
+// Element Access ------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] bool test(size_type i) const noexcept
+    {
+        OCU_ASSERT(i < size_, "dynamic_bitset::test out of range");
+        return (words_[i / word_bits] >> (i % word_bits)) & 1;
+    }
+
+    [[nodiscard]] bool operator[](size_type i) const noexcept { return test(i); }
+
+    /// The packed words, bit i of the set being bit (i % 64) of word i / 64
+    [[nodiscard]] std::span<const word_type> words() const noexcept { return words_; }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    void set(size_type i) noexcept
+    {
+        OCU_ASSERT(i < size_, "dynamic_bitset::set out of range");
+        words_[i / word_bits] |= word_type(1) << (i % word_bits);
+    }
+
+    void set(size_type i, bool value) noexcept
+    {
+        OCU_ASSERT(i < size_, "dynamic_bitset::set out of range");
+        const word_type bit = word_type(1) << (i % word_bits);
+        word_type&      w   = words_[i / word_bits];
+        w = value ? w | bit : w & ~bit;
+    }
+
+    void reset(size_type i) noexcept
+    {
+        OCU_ASSERT(i < size_, "dynamic_bitset::reset out of range");
+        words_[i / word_bits] &= ~(word_type(1) << (i % word_bits));
+    }
+
+    void flip(size_type i) noexcept
+    {
+        OCU_ASSERT(i < size_, "dynamic_bitset::flip out of range");
+        words_[i / word_bits] ^= word_type(1) << (i % word_bits);
+    }
+
+    /// Sets or clears bits [first, last), a word at a time
+    void set_range(size_type first, size_type last, bool value = true) noexcept
+    {
+        OCU_ASSERT(first <= last && last <= size_, "dynamic_bitset::set_range out of range");
+        if(first == last) return;
+
+        const size_type fw = first / word_bits;
+        const size_type lw = (last - 1) / word_bits;
+        const word_type fm = ~word_type(0) << (first % word_bits);
+        const word_type lm = ~word_type(0) >> (word_bits - 1 - (last - 1) % word_bits);
+        if(fw == lw)
+        {
+            apply_mask_(words_[fw], fm & lm, value);
+            return;
+        }
+        apply_mask_(words_[fw], fm, value);
+        std::fill(words_.data() + fw + 1, words_.data() + lw, value ? ~word_type(0) : 0);
+        apply_mask_(words_[lw], lm, value);
+    }
+
+    void set() noexcept
+    {
+        std::fill(words_.begin(), words_.end(), ~word_type(0));
+        clear_tail_();
+    }
+
+    void reset() noexcept { std::fill(words_.begin(), words_.end(), 0); }
+
+    void flip() noexcept
+    {
+        for(word_type& w : words_) w = ~w;
+        clear_tail_();
+    }
+
+    /// Grows or shrinks to n bits; new bits are set to value
+    void resize(size_type n, bool value = false)
+    {
+        const size_type old = size_;
+        words_.resize(words_for_(n), value ? ~word_type(0) : 0);
+        size_ = n;
+        if(value && n > old && old % word_bits != 0)
+        {
+            words_[old / word_bits] |= ~word_type(0) << (old % word_bits);
+        }
+        clear_tail_();
+    }
+
+    void push_back(bool value)
+    {
+        if(size_ % word_bits == 0) words_.push_back(0);
+        ++size_;
+        set(size_ - 1, value);
+    }
+
+    void clear() noexcept
+    {
+        words_.clear();
+        size_ = 0;
+    }
+
+    void reserve(size_type n) { words_.reserve(words_for_(n)); }
+
+    void shrink_to_fit() { words_.shrink_to_fit(); }
+
+// Bitwise Operations --------------------------------------------------------------------------------------------------
+
+    dynamic_bitset& operator&=(const dynamic_bitset& other) noexcept
+    {
+        const size_type n = std::min(words_.size(), other.words_.size());
+        detail::active_bitset_kernels().bit_and(words_.data(), other.words_.data(), n);
+        std::fill(words_.begin() + static_cast<std::ptrdiff_t>(n), words_.end(), 0);
+        return *this;
+    }
+
+    dynamic_bitset& operator|=(const dynamic_bitset& other) noexcept
+    {
+        detail::active_bitset_kernels().bit_or(words_.data(), other.words_.data(), common_words_(other));
+        clear_tail_();
+        return *this;
+    }
+
+    dynamic_bitset& operator^=(const dynamic_bitset& other) noexcept
+    {
+        detail::active_bitset_kernels().bit_xor(words_.data(), other.words_.data(), common_words_(other));
+        clear_tail_();
+        return *this;
+    }
+
+    /// Clears every bit that is set in other
+    dynamic_bitset& and_not(const dynamic_bitset& other) noexcept
+    {
+        detail::active_bitset_kernels().bit_andnot(words_.data(), other.words_.data(), common_words_(other));
+        return *this;
+    }
+
+    friend dynamic_bitset operator&(dynamic_bitset a, const dynamic_bitset& b) { return a &= b; }
+    friend dynamic_bitset operator|(dynamic_bitset a, const dynamic_bitset& b) { return a |= b; }
+    friend dynamic_bitset operator^(dynamic_bitset a, const dynamic_bitset& b) { return a ^= b; }
+
+    friend dynamic_bitset operator~(dynamic_bitset a)
+    {
+        a.flip();
+        return a;
+    }
+
+    friend bool operator==(const dynamic_bitset& a, const dynamic_bitset& b) noexcept
+    {
+        return a.size_ == b.size_ && a.words_ == b.words_;
+    }
+
+// Queries -------------------------------------------------------------------------------------------------------------
+
+    /// Number of set bits
+    [[nodiscard]] size_type count() const noexcept
+    {
+        return detail::active_bitset_kernels().popcount(words_.data(), words_.size());
+    }
+
+    /// Number of bits set in both, without building the intersection
+    [[nodiscard]] size_type count_and(const dynamic_bitset& other) const noexcept
+    {
+        return detail::active_bitset_kernels().popcount_and(words_.data(), other.words_.data(), common_words_(other));
+    }
+
+    [[nodiscard]] bool any() const noexcept
+    {
+        return std::any_of(words_.begin(), words_.end(), [](word_type w) { return w != 0; });
+    }
+
+    [[nodiscard]] bool none() const noexcept { return !any(); }
+    [[nodiscard]] bool all()  const noexcept { return count() == size_; }
+
+    /// True if some bit is set in both
+    [[nodiscard]] bool intersects(const dynamic_bitset& other) const noexcept
+    {
+        for(size_type i = 0, n = common_words_(other); i < n; ++i)
+        {
+            if(words_[i] & other.words_[i]) return true;
+        }
+        return false;
+    }
+
+    /// True if every bit set here is also set in other
+    [[nodiscard]] bool is_subset_of(const dynamic_bitset& other) const noexcept
+    {
+        const size_type n = common_words_(other);
+        for(size_type i = 0; i < n; ++i)
+        {
+            if(words_[i] & ~other.words_[i]) return false;
+        }
+        return std::all_of(words_.begin() + static_cast<std::ptrdiff_t>(n), words_.end(),
+                           [](word_type w) { return w == 0; });
+    }
+
+    /// Index of the first set bit at or after pos, or npos
+    [[nodiscard]] size_type find_first(size_type pos = 0) const noexcept
+    {
+        if(pos >= size_) return npos;
+        size_type w    = pos / word_bits;
+        word_type bits = words_[w] & (~word_type(0) << (pos % word_bits));
+        while(bits == 0)
+        {
+            if(++w == words_.size()) return npos;
+            bits = words_[w];
+        }
+        return w * word_bits + static_cast<size_type>(std::countr_zero(bits));
+    }
+
+    /**
+     * \brief Calls fn(index) for every set bit in increasing order. Each word costs one load and each set bit one
+     *        countr_zero (tzcnt with BMI) and one clear of the lowest bit, so sparse masks are nearly free to walk.
+     */
+    template<typename Fn>
+    void for_each_set_bit(Fn&& fn) const
+    {
+        for(size_type w = 0; w < words_.size(); ++w)
+        {
+            for(word_type bits = words_[w]; bits != 0; bits &= bits - 1)
+            {
+                fn(w * word_bits + static_cast<size_type>(std::countr_zero(bits)));
+            }
+        }
+    }
+
+// Capacity ------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] size_type size()       const noexcept { return size_; }
+    [[nodiscard]] bool      empty()      const noexcept { return size_ == 0; }
+    [[nodiscard]] size_type word_count() const noexcept { return words_.size(); }
+    [[nodiscard]] size_type capacity()   const noexcept { return words_.capacity() * word_bits; }
+
+    [[nodiscard]] size_type memory_usage() const noexcept { return words_.capacity() * sizeof(word_type); }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    static constexpr size_type words_for_(size_type n) noexcept { return (n + word_bits - 1) / word_bits; }
+
+    static void apply_mask_(word_type& w, word_type mask, bool value) noexcept { w = value ? w | mask : w & ~mask; }
+
+    size_type common_words_(const dynamic_bitset& other) const noexcept
+    {
+        return std::min(words_.size(), other.words_.size());
+    }
+
+    void clear_tail_() noexcept
+    {
+        if(size_ % word_bits != 0) words_.back() &= ~word_type(0) >> (word_bits - size_ % word_bits);
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::vector<word_type> words_;
+    size_type              size_ = 0;
+};
+
+// rank_select_index ===================================================================================================
+
+/**
+ * \brief Succinct rank and select over a dynamic_bitset, adding about 3% of the bitset's size.
+ *
+ * The layout follows Zhou, Andersen & Kaminsky's "poppy". Every 2048-bit block gets one 64-bit entry: the number of
+ * ones before the block (relative to its 2^32-bit upper block) in the high half, and the counts of its first three
+ * 512-bit sub-blocks in three 10-bit fields below. rank() is then one entry, at most three adds and at most seven
+ * word popcounts, all within one or two cache lines of the bitset. select() starts from a sample taken every 8192
+ * ones, binary searches the entries up to the next sample and finishes inside a word with pdep (BMI2) or a broadword
+ * search.
+ *
+ * The index reads the bitset it was built from, which must outlive it and must not change without a rebuild().
+ */
+class rank_select_index
+{
+// Typedefs ============================================================================================================
+
+public:
+    using size_type = std::size_t;
+
+    static constexpr size_type npos = dynamic_bitset::npos;
+
+    static constexpr size_type block_bits    = 2048;
+    static constexpr size_type subblock_bits = 512;
+    static constexpr size_type select_sample = 8192;
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    rank_select_index() noexcept = default;
+
+    explicit rank_select_index(const dynamic_bitset& bits) { rebuild(bits); }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Indexes bits, replacing any previous contents. One pass over the words.
+     */
+    void rebuild(const dynamic_bitset& bits)
+    {
+        const std::span<const std::uint64_t> w      = bits.words();
+        const size_type                      blocks = (w.size() + block_words - 1) / block_words;
+        if(blocks > std::numeric_limits<std::uint32_t>::max()) throw std::length_error("rank_select_index too large");
+
+        words_ = w.data();
+        size_  = bits.size();
+        blocks_.assign(blocks + 1, 0);
+        upper_.assign((blocks >> upper_shift) + 1, 0);
+        samples_.clear();
+
+        size_type total       = 0;
+        size_type next_sample = 0;
+        for(size_type b = 0; b <= blocks; ++b)
+        {
+            if((b & upper_mask) == 0) upper_[b >> upper_shift] = total;
+
+            size_type sub[4] = { };
+            for(size_type s = 0; s < 4; ++s)
+            {
+                const size_type first = std::min(w.size(), b * block_words + s * subblock_words);
+                const size_type last  = std::min(w.size(), first + subblock_words);
+                for(size_type i = first; i < last; ++i) sub[s] += static_cast<size_type>(std::popcount(w[i]));
+            }
+
+            blocks_[b] = static_cast<std::uint64_t>(total - upper_[b >> upper_shift]) << 32
+                       | sub[0] << 20 | sub[1] << 10 | sub[2];
+
+            const size_type after = total + sub[0] + sub[1] + sub[2] + sub[3];
+            for(; next_sample < after; next_sample += select_sample)
+            {
+                samples_.push_back(static_cast<std::uint32_t>(b));
+            }
+            total = after;
+        }
+        ones_ = total;
+    }
+
+// Queries -------------------------------------------------------------------------------------------------------------
+
+    /// Number of set bits in [0, i), for i <= size()
+    [[nodiscard]] size_type rank(size_type i) const noexcept
+    {
+        OCU_ASSERT(i <= size_, "rank_select_index::rank out of range");
+        const size_type     b   = i / block_bits;
+        const std::uint64_t e   = blocks_[b];
+        const size_type     sub = (i / subblock_bits) % 4;
+
+        size_type r = block_rank_(b);
+        if(sub > 0) r += (e >> 20) & field_mask;
+        if(sub > 1) r += (e >> 10) & field_mask;
+        if(sub > 2) r += e & field_mask;
+
+        const size_type last = i / 64;
+        for(size_type w = b * block_words + sub * subblock_words; w < last; ++w)
+        {
+            r += static_cast<size_type>(std::popcount(words_[w]));
+        }
+        if(i % 64 != 0) r += static_cast<size_type>(std::popcount(words_[last] & ~(~std::uint64_t(0) << (i % 64))));
+        return r;
+    }
+
+    /// Index of the k-th (from 0) set bit, or npos when fewer than k + 1 bits are set
+    [[nodiscard]] size_type select(size_type k) const noexcept
+    {
+        if(k >= ones_) return npos;
+
+        // The block holding bit k lies between this sample's block and the next one's
+        const size_type s  = k / select_sample;
+        size_type       lo = samples_[s];
+        size_type       hi = s + 1 < samples_.size() ? samples_[s + 1] : blocks_.size() - 2;
+        while(lo < hi)
+        {
+            const size_type mid = (lo + hi + 1) / 2;
+            if(block_rank_(mid) <= k) lo = mid;
+            else                      hi = mid - 1;
+        }
+
+        const std::uint64_t e   = blocks_[lo];
+        size_type           rem = k - block_rank_(lo);
+        size_type           w   = lo * block_words;
+        for(const unsigned shift : { 20u, 10u, 0u })
+        {
+            const size_type c = (e >> shift) & field_mask;
+            if(rem < c) break;
+            rem -= c;
+            w   += subblock_words;
+        }
+        for(;; ++w)
+        {
+            const size_type c = static_cast<size_type>(std::popcount(words_[w]));
+            if(rem < c) break;
+            rem -= c;
+        }
+        return w * 64 + detail::select_in_word(words_[w], static_cast<unsigned>(rem));
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    /// Bits in the indexed bitset
+    [[nodiscard]] size_type size()  const noexcept { return size_; }
+    /// Set bits in the indexed bitset
+    [[nodiscard]] size_type count() const noexcept { return ones_; }
+
+    /// Bytes used by the index itself, excluding the bitset
+    [[nodiscard]] size_type memory_usage() const noexcept
+    {
+        return blocks_.capacity() * sizeof(std::uint64_t) + upper_.capacity() * sizeof(size_type)
+             + samples_.capacity() * sizeof(std::uint32_t);
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    static constexpr size_type     block_words    = block_bits / 64;
+    static constexpr size_type     subblock_words = subblock_bits / 64;
+    static constexpr size_type     upper_shift    = 32 - 11;
+    static constexpr size_type     upper_mask     = (size_type(1) << upper_shift) - 1;
+    static constexpr std::uint64_t field_mask     = 0x3FF;
+
+    /// Ones before block b
+    size_type block_rank_(size_type b) const noexcept
+    {
+        return upper_[b >> upper_shift] + static_cast<size_type>(blocks_[b] >> 32);
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    const std::uint64_t*       words_ = nullptr;
+    size_type                  size_  = 0;
+    size_type                  ones_  = 0;
+    std::vector<std::uint64_t> blocks_;
+    std::vector<size_type>     upper_;
+    std::vector<std::uint32_t> samples_;
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_BITSET_H
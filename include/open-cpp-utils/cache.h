@@ -0,0 +1,867 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_CACHE_H
+#define OPEN_CPP_UTILS_CACHE_H
+
+#include "config.h"
+#include "hash.h"
+#include "hash_table.h"
+#include "object_pool.h"
+#include "optional.h"
+#include "profile.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace open_cpp_utils
+{
+
+// Typedefs ============================================================================================================
+
+/**
+ * \brief How a cache picks what to evict.
+ *
+ * lru evicts the least recently used entry. tiny_lfu is W-TinyLFU (Einziger, Friedman & Manes): new entries enter
+ * a small LRU window, and an entry leaving the window only displaces the main area's eviction victim if a
+ * frequency sketch has seen its key more often. The main area is a segmented LRU, so one scan or a burst of one-off
+ * keys cannot flush the entries that are used again and again.
+ */
+enum class cache_policy : std::uint8_t
+{
+    lru,
+    tiny_lfu,
+};
+
+/**
+ * \brief Counters a cache keeps since construction or the last reset_stats()
+ */
+struct cache_stats
+{
+    std::uint64_t hits       = 0;
+    std::uint64_t misses     = 0;
+    /// New entries stored
+    std::uint64_t insertions = 0;
+    /// Resident entries removed to stay within the budget
+    std::uint64_t evictions  = 0;
+    /// New entries dropped instead: costlier than the whole budget, or refused by the TinyLFU admission test
+    std::uint64_t rejections = 0;
+
+    /// hits / (hits + misses), or 0 before the first lookup
+    [[nodiscard]] double hit_rate() const noexcept
+    {
+        const std::uint64_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+    }
+
+    cache_stats& operator+=(const cache_stats& other) noexcept
+    {
+        hits       += other.hits;
+        misses     += other.misses;
+        insertions += other.insertions;
+        evictions  += other.evictions;
+        rejections += other.rejections;
+        return *this;
+    }
+};
+
+/**
+ * \brief Default cost function: every entry costs 1, so the budget counts entries. For a byte budget pass a
+ *        function of (key, value) returning the bytes the entry holds on to.
+ */
+struct unit_cost
+{
+    template<typename K, typename V>
+    constexpr std::size_t operator()(const K&, const V&) const noexcept { return 1; }
+};
+
+namespace detail
+{
+
+/**
+ * \brief Count-min sketch of 4-bit counters, the frequency filter of W-TinyLFU.
+ *
+ * Each key increments the smallest of four counters picked by its hash and its frequency is their minimum, so
+ * collisions only ever overestimate. After ten samples per word all counters are halved, which keeps the estimate
+ * about recent popularity and bounds it at 15.
+ */
+class frequency_sketch
+{
+public:
+    /// Makes room for about n distinct keys. Growing forgets everything counted so far.
+    void ensure_capacity(std::size_t n)
+    {
+        const std::size_t words = std::bit_ceil(std::max<std::size_t>(n, 16));
+        if(words <= table_.size()) return;
+        table_.assign(words, 0);
+        mask_    = words - 1;
+        limit_   = words * 10;
+        samples_ = 0;
+    }
+
+    [[nodiscard]] unsigned frequency(std::uint64_t h) const noexcept
+    {
+        unsigned f = 15;
+        for(unsigned i = 0; i < 4; ++i)
+        {
+            const auto [word, shift] = position_(h, i);
+            f = std::min(f, static_cast<unsigned>((table_[word] >> shift) & 15));
+        }
+        return f;
+    }
+
+    void increment(std::uint64_t h) noexcept
+    {
+        bool added = false;
+        for(unsigned i = 0; i < 4; ++i)
+        {
+            const auto [word, shift] = position_(h, i);
+            if(((table_[word] >> shift) & 15) != 15)
+            {
+                table_[word] += std::uint64_t(1) << shift;
+                added = true;
+            }
+        }
+        if(added && ++samples_ >= limit_) age_();
+    }
+
+    [[nodiscard]] std::size_t memory_usage() const noexcept { return table_.capacity() * sizeof(std::uint64_t); }
+
+private:
+    struct counter_position
+    {
+        std::size_t word;
+        unsigned    shift;
+    };
+
+    counter_position position_(std::uint64_t h, unsigned i) const noexcept
+    {
+        static constexpr std::uint64_t seeds[4] = {
+            0x9E3779B97F4A7C15, 0xC2B2AE3D27D4EB4F, 0x165667B19E3779F9, 0xD6E8FEB86659FD93,
+        };
+        const std::uint64_t x = (h ^ (h >> 32)) * seeds[i];
+        return { static_cast<std::size_t>(x >> 16) & mask_, static_cast<unsigned>(x >> 60) * 4 };
+    }
+
+    void age_() noexcept
+    {
+        for(std::uint64_t& w : table_) w = (w >> 1) & 0x7777777777777777;
+        samples_ /= 2;
+    }
+
+    std::vector<std::uint64_t> table_;
+    std::size_t                mask_    = 0;
+    std::size_t                samples_ = 0;
+    std::size_t                limit_   = 0;
+};
+
+template<typename Hash, typename K>
+[[nodiscard]] std::uint64_t cache_hash_(const Hash& hash, const K& key)
+{
+    if constexpr(is_avalanching<Hash>::value) return static_cast<std::uint64_t>(hash(key));
+    else return mix_hash(static_cast<std::uint64_t>(hash(key)));
+}
+
+}
+
+template<typename K, typename V, typename Cost, typename Hash, typename Eq, std::size_t Shards>
+class concurrent_cache;
+
+// cache ===============================================================================================================
+
+/**
+ * \brief Bounded key-value cache with O(1) lookup, insert and eviction and no allocation per entry.
+ *
+ * Entries live in an object_pool, so they never move and grow the cache a chunk at a time instead of one node each.
+ * The recency lists are threaded through the entries as 32-bit pool handles, and the index is a hash_set of those
+ * handles whose hasher and comparator look the entry up in the pool: each key is stored once, and an index slot is
+ * four bytes plus its control byte. The hash of every entry is kept with it, so rehashing never rehashes a key.
+ *
+ * Each entry has a cost given by Cost(key, value) and the cache keeps the sum within budget(), evicting by the
+ * chosen cache_policy. Under tiny_lfu 1% of the budget is the admission window and, of the rest, 80% the protected
+ * segment.
+ *
+ * Pointers returned by find() stay valid until that entry is erased or evicted, which any insertion may do. The cache
+ * is not thread safe and not movable, as the index refers back to it; concurrent_cache shards it behind locks.
+ *
+ * \tparam K    Key type
+ * \tparam V    Cached value type
+ * \tparam Cost Cost function of (const K&, const V&) returning std::size_t
+ * \tparam Hash Hasher; results of hashers that do not define is_avalanching are mixed first
+ * \tparam Eq   Key equality
+ */
+template<typename K, typename V, typename Cost = unit_cost, typename Hash = open_cpp_utils::hash<K>,
+         typename Eq = std::equal_to<K>>
+class cache
+{
+// Typedefs ============================================================================================================
+
+public:
+    using key_type      = K;
+    using mapped_type   = V;
+    using cost_function = Cost;
+    using hasher        = Hash;
+    using key_equal     = Eq;
+    using size_type     = std::size_t;
+
+private:
+    enum queue_id : std::uint8_t
+    {
+        window,
+        probation,
+        protected_,
+    };
+
+    struct entry
+    {
+        template<typename KK, typename VV>
+        entry(KK&& k, VV&& v, std::uint64_t h, size_type c)
+            : key(std::forward<KK>(k)), value(std::forward<VV>(v)), hash(h), cost(c)
+        { }
+
+        K             key;
+        V             value;
+        std::uint64_t hash;
+        size_type     cost;
+        std::uint32_t newer = 0; ///< Raw handle of the next entry towards the front of its queue, 0 at the front
+        std::uint32_t older = 0;
+        queue_id      queue = window;
+    };
+
+    using pool_type = object_pool<entry, 256>;
+    using handle    = typename pool_type::handle;
+    using raw_type  = typename handle::value_type;
+
+    struct lookup
+    {
+        const K*      key;
+        std::uint64_t hash;
+    };
+
+    struct index_hash
+    {
+        using is_transparent = void;
+        using is_avalanching = void;
+
+        std::size_t operator()(raw_type r) const noexcept
+        {
+            return static_cast<std::size_t>(owner->pool_[handle::from_raw(r)].hash);
+        }
+
+        std::size_t operator()(const lookup& l) const noexcept { return static_cast<std::size_t>(l.hash); }
+
+        const cache* owner;
+    };
+
+    struct index_eq
+    {
+        using is_transparent = void;
+
+        bool operator()(raw_type a, raw_type b) const noexcept { return a == b; }
+
+        bool operator()(raw_type r, const lookup& l) const
+        {
+            const entry& e = owner->pool_[handle::from_raw(r)];
+            return e.hash == l.hash && owner->eq_(e.key, *l.key);
+        }
+
+        bool operator()(const lookup& l, raw_type r) const { return (*this)(r, l); }
+
+        const cache* owner;
+    };
+
+    struct queue
+    {
+        raw_type  newest = 0;
+        raw_type  oldest = 0;
+        size_type cost   = 0;
+    };
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    /**
+     * \param budget Largest total cost of the entries kept
+     */
+    explicit cache(size_type budget, cache_policy policy = cache_policy::lru, const Cost& cost = Cost(),
+                   const Hash& hash = Hash(), const Eq& eq = Eq())
+        : index_(0, index_hash{ this }, index_eq{ this })
+        , policy_(policy)
+        , cost_(cost)
+        , hash_(hash)
+        , eq_(eq)
+    {
+        if(policy_ == cache_policy::tiny_lfu) sketch_.ensure_capacity(16);
+        set_budget(budget);
+    }
+
+    cache(const cache&) = delete;
+    cache& operator=(const cache&) = delete;
+
+// Lookup --------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Value cached for key, or nullptr. Counts a hit or a miss and marks the entry as used.
+     */
+    [[nodiscard]] V* find(const K& key) { return find_hashed_(key, detail::cache_hash_(hash_, key)); }
+
+    /**
+     * \brief Value cached for key, or nullptr, without counting the lookup or changing what is evicted next
+     */
+    [[nodiscard]] const V* peek(const K& key) const
+    {
+        const auto it = index_.find(lookup{ &key, detail::cache_hash_(hash_, key) });
+        return it == index_.end() ? nullptr : &pool_[handle::from_raw(*it)].value;
+    }
+
+    [[nodiscard]] bool contains(const K& key) const { return peek(key) != nullptr; }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Caches value under key, replacing any value it already had
+     * \return the stored value, or nullptr if the entry was rejected or evicted straight away
+     */
+    template<typename VV = V>
+    V* insert(K key, VV&& value)
+    {
+        const std::uint64_t h = detail::cache_hash_(hash_, key);
+        if(policy_ == cache_policy::tiny_lfu) sketch_.increment(h);
+        return insert_hashed_(std::move(key), std::forward<VV>(value), h);
+    }
+
+    /**
+     * \brief Value cached for key, first caching make() if there is none. Counts as one lookup.
+     * \return the value, or nullptr if make()'s result was rejected
+     */
+    template<typename Fn>
+    V* get_or_insert(const K& key, Fn&& make)
+    {
+        const std::uint64_t h = detail::cache_hash_(hash_, key);
+        if(V* v = find_hashed_(key, h)) return v;
+        return insert_new_(K(key), std::forward<Fn>(make)(), h);
+    }
+
+    /**
+     * \return whether key was cached
+     */
+    bool erase(const K& key)
+    {
+        const auto it = index_.find(lookup{ &key, detail::cache_hash_(hash_, key) });
+        if(it == index_.end()) return false;
+        remove_(*it);
+        return true;
+    }
+
+    /**
+     * \brief Drops every entry. The frequency sketch and the statistics are kept.
+     */
+    void clear() noexcept
+    {
+        index_.clear();
+        pool_.clear();
+        for(queue& q : queues_) q = queue{ };
+        total_cost_ = 0;
+    }
+
+    /**
+     * \brief Changes the budget, evicting at once if the entries now cost more
+     */
+    void set_budget(size_type budget)
+    {
+        budget_           = budget;
+        window_budget_    = std::max<size_type>(budget / 100, 1);
+        protected_budget_ = (budget - std::min(budget, window_budget_)) / 5 * 4;
+        if(policy_ == cache_policy::tiny_lfu) demote_protected_();
+        evict_();
+    }
+
+    void reset_stats() noexcept { stats_ = cache_stats{ }; }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] size_type    size()   const noexcept { return pool_.size(); }
+    [[nodiscard]] bool         empty()  const noexcept { return pool_.empty(); }
+    /// Total cost of the entries
+    [[nodiscard]] size_type    cost()   const noexcept { return total_cost_; }
+    [[nodiscard]] size_type    budget() const noexcept { return budget_; }
+    [[nodiscard]] cache_policy policy() const noexcept { return policy_; }
+
+    [[nodiscard]] const cache_stats& stats() const noexcept { return stats_; }
+
+    /**
+     * \brief Calls fn(key, value) for every entry, in no particular order
+     */
+    template<typename Fn>
+    void for_each(Fn&& fn) const
+    {
+        pool_.for_each([&](handle, const entry& e) { fn(e.key, e.value); });
+    }
+
+    [[nodiscard]] size_type memory_usage() const noexcept
+    {
+        return pool_.capacity() * sizeof(entry) + index_.capacity() * (sizeof(raw_type) + 1)
+             + sketch_.memory_usage();
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    template<typename, typename, typename, typename, typename, std::size_t>
+    friend class concurrent_cache;
+
+    entry&       entry_(raw_type r)       noexcept { return pool_[handle::from_raw(r)]; }
+    const entry& entry_(raw_type r) const noexcept { return pool_[handle::from_raw(r)]; }
+
+    V* find_hashed_(const K& key, std::uint64_t h)
+    {
+        if(policy_ == cache_policy::tiny_lfu) sketch_.increment(h);
+        const auto it = index_.find(lookup{ &key, h });
+        if(it == index_.end())
+        {
+            ++stats_.misses;
+            return nullptr;
+        }
+        ++stats_.hits;
+        touch_(*it);
+        return &entry_(*it).value;
+    }
+
+    template<typename VV>
+    V* insert_hashed_(K&& key, VV&& value, std::uint64_t h)
+    {
+        const auto it = index_.find(lookup{ &key, h });
+        if(it == index_.end()) return insert_new_(std::move(key), std::forward<VV>(value), h);
+
+        const raw_type r = *it;
+        entry&         e = entry_(r);
+        e.value = std::forward<VV>(value);
+
+        const size_type c = cost_(std::as_const(e.key), std::as_const(e.value));
+        if(c > budget_)
+        {
+            remove_(r);
+            ++stats_.rejections;
+            return nullptr;
+        }
+        queues_[e.queue].cost += c - e.cost;
+        total_cost_           += c - e.cost;
+        e.cost                 = c;
+        touch_(r);
+        evict_();
+        return pool_.valid(handle::from_raw(r)) ? &e.value : nullptr;
+    }
+
+    template<typename VV>
+    V* insert_new_(K&& key, VV&& value, std::uint64_t h)
+    {
+        const size_type c = cost_(std::as_const(key), std::as_const(value));
+        if(c > budget_)
+        {
+            ++stats_.rejections;
+            return nullptr;
+        }
+
+        const handle hd = pool_.acquire(std::move(key), std::forward<VV>(value), h, c);
+        try { index_.insert(hd.raw()); }
+        catch(...) { pool_.release(hd); throw; }
+
+        push_front_(window, hd.raw());
+        total_cost_ += c;
+        ++stats_.insertions;
+        if(policy_ == cache_policy::tiny_lfu) sketch_.ensure_capacity(pool_.size());
+
+        evict_();
+        return pool_.valid(hd) ? &pool_[hd].value : nullptr;
+    }
+
+    /// Records a use of r: under lru or in the window it moves to the front, in probation it is promoted
+    void touch_(raw_type r) noexcept
+    {
+        entry& e = entry_(r);
+        if(e.queue == probation)
+        {
+            unlink_(r);
+            push_front_(protected_, r);
+            demote_protected_();
+            return;
+        }
+        if(queues_[e.queue].newest == r) return;
+        const queue_id q = e.queue;
+        unlink_(r);
+        push_front_(q, r);
+    }
+
+    void demote_protected_() noexcept
+    {
+        while(queues_[protected_].cost > protected_budget_)
+        {
+            const raw_type r = queues_[protected_].oldest;
+            unlink_(r);
+            push_front_(probation, r);
+        }
+    }
+
+    /**
+     * \brief Restores total_cost_ <= budget_. Under tiny_lfu the window's overflow first moves to the front of
+     *        probation; those entries are the candidates, and each one either beats the frequency of the entry at the
+     *        back of probation, which is then evicted, or is rejected itself.
+     */
+    void evict_() noexcept
+    {
+        if(policy_ == cache_policy::lru)
+        {
+            while(total_cost_ > budget_)
+            {
+                remove_(queues_[window].oldest);
+                ++stats_.evictions;
+            }
+            return;
+        }
+
+        raw_type candidate = 0;
+        while(queues_[window].cost > window_budget_)
+        {
+            const raw_type r = queues_[window].oldest;
+            unlink_(r);
+            push_front_(probation, r);
+            if(candidate == 0) candidate = r;
+        }
+
+        while(total_cost_ > budget_)
+        {
+            raw_type victim = queues_[probation].oldest;
+            if(victim == 0) victim = queues_[protected_].oldest;
+            if(victim == 0) victim = queues_[window].oldest;
+
+            if(candidate == 0 || candidate == victim)
+            {
+                if(candidate == victim) candidate = entry_(candidate).newer;
+                remove_(victim);
+                ++stats_.evictions;
+                continue;
+            }
+
+            if(sketch_.frequency(entry_(candidate).hash) > sketch_.frequency(entry_(victim).hash))
+            {
+                remove_(victim);
+                ++stats_.evictions;
+            }
+            else
+            {
+                const raw_type next = entry_(candidate).newer;
+                remove_(candidate);
+                ++stats_.rejections;
+                candidate = next;
+            }
+        }
+    }
+
+    void push_front_(queue_id q, raw_type r) noexcept
+    {
+        entry& e = entry_(r);
+        queue& l = queues_[q];
+        e.queue  = q;
+        e.newer  = 0;
+        e.older  = l.newest;
+        if(l.newest != 0) entry_(l.newest).newer = r;
+        else              l.oldest = r;
+        l.newest  = r;
+        l.cost   += e.cost;
+    }
+
+    void unlink_(raw_type r) noexcept
+    {
+        entry& e = entry_(r);
+        queue& l = queues_[e.queue];
+        if(e.newer != 0) entry_(e.newer).older = e.older;
+        else             l.newest = e.older;
+        if(e.older != 0) entry_(e.older).newer = e.newer;
+        else             l.oldest = e.newer;
+        l.cost -= e.cost;
+    }
+
+    void remove_(raw_type r) noexcept
+    {
+        unlink_(r);
+        total_cost_ -= entry_(r).cost;
+        index_.erase(r);
+        pool_.release(handle::from_raw(r));
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    pool_type                                pool_;
+    hash_set<raw_type, index_hash, index_eq> index_;
+    queue                                    queues_[3];
+    detail::frequency_sketch                 sketch_;
+    size_type                                total_cost_       = 0;
+    size_type                                budget_           = 0;
+    size_type                                window_budget_    = 0;
+    size_type                                protected_budget_ = 0;
+    cache_stats                              stats_;
+    cache_policy                             policy_;
+
+    OCU_NO_UNIQUE_ADDRESS Cost cost_;
+    OCU_NO_UNIQUE_ADDRESS Hash hash_;
+    OCU_NO_UNIQUE_ADDRESS Eq   eq_;
+};
+
+// concurrent_cache ====================================================================================================
+
+/**
+ * \brief A cache split into Shards independently locked caches, selected by the top bits of the key's hash.
+ *
+ * Every operation locks one shard's mutex, so threads working on different keys rarely wait for each other and the
+ * eviction policy stays exact within each shard. Lookups return copies, since an entry can be evicted as soon as
+ * the lock is released. The budget is split evenly, so a shard evicts once its share is spent even if others have
+ * room; with enough entries per shard the difference disappears.
+ *
+ * \tparam Shards Number of shards, a power of two; several per core keeps threads from colliding
+ */
+template<typename K, typename V, typename Cost = unit_cost, typename Hash = open_cpp_utils::hash<K>,
+         typename Eq = std::equal_to<K>, std::size_t Shards = 16>
+class concurrent_cache
+{
+    static_assert(std::has_single_bit(Shards), "concurrent_cache shard count must be a power of two");
+
+// Typedefs ============================================================================================================
+
+public:
+    using key_type      = K;
+    using mapped_type   = V;
+    using cost_function = Cost;
+    using hasher        = Hash;
+    using key_equal     = Eq;
+    using size_type     = std::size_t;
+    using cache_type    = cache<K, V, Cost, Hash, Eq>;
+
+    static constexpr size_type shard_count = Shards;
+
+private:
+    struct alignas(cache_line_size) shard
+    {
+        shard(size_type budget, cache_policy policy, const Cost& cost, const Hash& hash, const Eq& eq)
+            : items(budget, policy, cost, hash, eq)
+        { }
+
+        mutable std::mutex mutex;
+        cache_type         items;
+    };
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    explicit concurrent_cache(size_type budget, cache_policy policy = cache_policy::lru, const Cost& cost = Cost(),
+                              const Hash& hash = Hash(), const Eq& eq = Eq())
+        : hash_(hash)
+    {
+        shards_.reserve(Shards);
+        for(size_type i = 0; i < Shards; ++i)
+        {
+            shards_.push_back(std::make_unique<shard>(share_(budget, i), policy, cost, hash, eq));
+        }
+    }
+
+    concurrent_cache(const concurrent_cache&) = delete;
+    concurrent_cache& operator=(const concurrent_cache&) = delete;
+
+// Lookup --------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \return a copy of the value cached for key, or an empty optional. Counts a hit or a miss.
+     */
+    [[nodiscard]] optional<V> find(const K& key)
+    {
+        const std::uint64_t h = detail::cache_hash_(hash_, key);
+        shard&              s = shard_of_(h);
+        std::lock_guard     lock(s.mutex);
+        if(const V* v = s.items.find_hashed_(key, h)) return *v;
+        return { };
+    }
+
+    [[nodiscard]] bool contains(const K& key) const
+    {
+        const shard&    s = shard_of_(detail::cache_hash_(hash_, key));
+        std::lock_guard lock(s.mutex);
+        return s.items.contains(key);
+    }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \return whether the value was kept
+     */
+    template<typename VV = V>
+    bool insert(K key, VV&& value)
+    {
+        const std::uint64_t h = detail::cache_hash_(hash_, key);
+        shard&              s = shard_of_(h);
+        std::lock_guard     lock(s.mutex);
+        if(s.items.policy() == cache_policy::tiny_lfu) s.items.sketch_.increment(h);
+        return s.items.insert_hashed_(std::move(key), std::forward<VV>(value), h) != nullptr;
+    }
+
+    /**
+     * \brief Copy of the value cached for key, first caching make() if there is none. make() runs without the lock
+     *        held, so threads missing on the same key at once may each call it; the first result stays cached.
+     */
+    template<typename Fn>
+    V get_or_insert(const K& key, Fn&& make)
+    {
+        const std::uint64_t h = detail::cache_hash_(hash_, key);
+        shard&              s = shard_of_(h);
+        {
+            std::lock_guard lock(s.mutex);
+            if(const V* v = s.items.find_hashed_(key, h)) return *v;
+        }
+
+        V               value = std::forward<Fn>(make)();
+        std::lock_guard lock(s.mutex);
+        if(const V* v = s.items.peek(key)) return *v;
+        s.items.insert_new_(K(key), std::as_const(value), h);
+        return value;
+    }
+
+    bool erase(const K& key)
+    {
+        shard&          s = shard_of_(detail::cache_hash_(hash_, key));
+        std::lock_guard lock(s.mutex);
+        return s.items.erase(key);
+    }
+
+    void clear()
+    {
+        for(auto& s : shards_)
+        {
+            std::lock_guard lock(s->mutex);
+            s->items.clear();
+        }
+    }
+
+    void set_budget(size_type budget)
+    {
+        for(size_type i = 0; i < Shards; ++i)
+        {
+            std::lock_guard lock(shards_[i]->mutex);
+            shards_[i]->items.set_budget(share_(budget, i));
+        }
+    }
+
+    void reset_stats()
+    {
+        for(auto& s : shards_)
+        {
+            std::lock_guard lock(s->mutex);
+            s->items.reset_stats();
+        }
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    /// Sum over the shards, each read at a slightly different moment while other threads are active
+    [[nodiscard]] cache_stats stats() const
+    {
+        cache_stats total;
+        for(const auto& s : shards_)
+        {
+            std::lock_guard lock(s->mutex);
+            total += s->items.stats();
+        }
+        return total;
+    }
+
+    [[nodiscard]] size_type size() const
+    {
+        return sum_([](const cache_type& c) { return c.size(); });
+    }
+
+    [[nodiscard]] size_type cost() const
+    {
+        return sum_([](const cache_type& c) { return c.cost(); });
+    }
+
+    [[nodiscard]] size_type budget() const
+    {
+        return sum_([](const cache_type& c) { return c.budget(); });
+    }
+
+    [[nodiscard]] size_type memory_usage() const
+    {
+        return sizeof(*this) + Shards * sizeof(shard) + sum_([](const cache_type& c) { return c.memory_usage(); });
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    static size_type share_(size_type budget, size_type i) noexcept
+    {
+        return budget / Shards + (i < budget % Shards ? 1 : 0);
+    }
+
+    /// Top hash bits pick the shard; a single shard is special-cased because h >> 64 is undefined
+    static constexpr size_type shard_index_(std::uint64_t h) noexcept
+    {
+        if constexpr(Shards == 1) return 0;
+        else                      return static_cast<size_type>(h >> (64 - std::countr_zero(Shards)));
+    }
+
+    shard&       shard_of_(std::uint64_t h)       noexcept { return *shards_[shard_index_(h)]; }
+    const shard& shard_of_(std::uint64_t h) const noexcept { return *shards_[shard_index_(h)]; }
+
+    template<typename Fn>
+    size_type sum_(Fn&& fn) const
+    {
+        size_type n = 0;
+        for(const auto& s : shards_)
+        {
+            std::lock_guard lock(s->mutex);
+            n += fn(s->items);
+        }
+        return n;
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::vector<std::unique_ptr<shard>> shards_;
+    OCU_NO_UNIQUE_ADDRESS Hash          hash_;
+};
+
+// Profiling ===========================================================================================================
+
+/**
+ * \brief Records stats as counter samples on the profile track name, one series each for the hit rate, hits,
+ *        misses, insertions, evictions and rejections. Call it periodically, say once a frame, while a
+ *        profile_session is open; it costs one relaxed load otherwise. name must outlive the session.
+ */
+inline void profile_cache_stats(const char* name, const cache_stats& stats) noexcept
+{
+    profile_counter(name, "hit_rate",   stats.hit_rate());
+    profile_counter(name, "hits",       static_cast<double>(stats.hits));
+    profile_counter(name, "misses",     static_cast<double>(stats.misses));
+    profile_counter(name, "insertions", static_cast<double>(stats.insertions));
+    profile_counter(name, "evictions",  static_cast<double>(stats.evictions));
+    profile_counter(name, "rejections", static_cast<double>(stats.rejections));
+}
+
+}
+
+#endif // OPEN_CPP_UTILS_CACHE_H
@@ -0,0 +1,540 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_CONCURRENT_HASH_MAP_H
+#define OPEN_CPP_UTILS_CONCURRENT_HASH_MAP_H
+
+#include "config.h"
+#include "hash.h"
+#include "hash_table.h"
+#include "optional.h"
+#include "reclaim.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER) && defined(OCU_ARCH_X86)
+#   include <intrin.h>
+#endif
+
+namespace open_cpp_utils
+{
+
+namespace detail
+{
+
+/// Spin-wait hint that lets the sibling hyperthread run while a reader waits out a writer
+OCU_FORCEINLINE void spin_pause() noexcept
+{
+#if defined(OCU_ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_ia32_pause();
+#elif defined(OCU_ARCH_X86) && defined(_MSC_VER)
+    _mm_pause();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    asm volatile("yield");
+#endif
+}
+
+}
+
+// concurrent_hash_map =================================================================================================
+
+/**
+ * \brief Hash map for read-mostly data shared by many threads. Reads take no lock and write no shared memory.
+ *
+ * The map is split into Shards independent open addressing tables, selected by the top bits of the hash. Writers
+ * lock their shard's mutex and bracket every change with a shard-wide sequence counter; readers copy the entry out
+ * optimistically and retry if the counter moved, so any number of readers scale with cores while a writer only
+ * holds up lookups in its own shard. Because readers copy entries without synchronizing with writers, keys and
+ * values must be trivially copyable: store an index or a pointer to immutable data for anything larger.
+ *
+ * Lookups pin default_epoch_domain, and a table that a shard outgrows is retired to it, so it is freed once no
+ * reader can still be probing it. A thread doing many lookups in a row can hold an epoch_guard around all of them,
+ * which turns each lookup's own pin into a counter increment. Erased entries leave tombstones; when they fill a
+ * table that is at most half live, it is swept in place instead of grown.
+ *
+ * \tparam K      Key type, trivially copyable
+ * \tparam V      Mapped type, trivially copyable
+ * \tparam Hash   Hasher; results of hashers that do not define is_avalanching are mixed first
+ * \tparam Eq     Key equality
+ * \tparam Shards Number of shards, a power of two; several per core keeps writers from colliding
+ */
+template<typename K, typename V, typename Hash = open_cpp_utils::hash<K>, typename Eq = std::equal_to<K>,
+         std::size_t Shards = 64>
+class concurrent_hash_map
+{
+    static_assert(std::is_trivially_copyable_v<K>, "concurrent_hash_map keys must be trivially copyable");
+    static_assert(std::is_trivially_copyable_v<V>, "concurrent_hash_map values must be trivially copyable");
+    static_assert(std::has_single_bit(Shards), "concurrent_hash_map shard count must be a power of two");
+
+// Typedefs ============================================================================================================
+
+public:
+    using key_type    = K;
+    using mapped_type = V;
+    using hasher      = Hash;
+    using key_equal   = Eq;
+    using size_type   = std::size_t;
+
+    static constexpr size_type shard_count = Shards;
+
+private:
+    static constexpr std::uint64_t empty_hash   = 0;
+    static constexpr std::uint64_t erased_hash  = 1;
+    static constexpr size_type     min_capacity = 16;
+
+    struct slot
+    {
+        std::atomic<std::uint64_t> hash{ empty_hash };
+        alignas(K) std::byte       key[sizeof(K)];
+        alignas(V) std::byte       value[sizeof(V)];
+    };
+
+    struct table
+    {
+        explicit table(size_type capacity) : mask(capacity - 1), slots(new slot[capacity]()) { }
+
+        size_type               mask;
+        size_type               used = 0; ///< Full and erased slots
+        std::unique_ptr<slot[]> slots;
+    };
+
+    struct alignas(cache_line_size) shard
+    {
+        std::atomic<std::uint64_t> seq{ 0 };
+        std::atomic<table*>        current{ nullptr };
+        std::atomic<size_type>     size{ 0 };
+        std::mutex                 mutex;
+
+        ~shard() { delete current.load(std::memory_order_relaxed); }
+    };
+
+    template<typename T>
+    static T load_(const std::byte* bytes) noexcept
+    {
+        alignas(T) std::byte copy[sizeof(T)];
+        std::memcpy(copy, bytes, sizeof(T));
+        return *std::launder(reinterpret_cast<T*>(copy));
+    }
+
+public:
+    /**
+     * \brief Exclusive access to one shard, handed out by for_each_shard
+     */
+    class locked_shard
+    {
+    public:
+        [[nodiscard]] size_type size() const noexcept { return shard_.size.load(std::memory_order_relaxed); }
+
+        /**
+         * \brief Calls fn(key, value) for every entry of the shard
+         */
+        template<typename Fn>
+        void for_each(Fn&& fn) const
+        {
+            const table* t = shard_.current.load(std::memory_order_relaxed);
+            if(t == nullptr) return;
+            for(size_type i = 0; i <= t->mask; ++i)
+            {
+                if(t->slots[i].hash.load(std::memory_order_relaxed) <= erased_hash) continue;
+                fn(load_<K>(t->slots[i].key), load_<V>(t->slots[i].value));
+            }
+        }
+
+        /**
+         * \brief Erases every entry for which pred(key, value) is true
+         * \return number of entries erased
+         */
+        template<typename Pred>
+        size_type erase_if(Pred&& pred)
+        {
+            table* t = shard_.current.load(std::memory_order_relaxed);
+            if(t == nullptr) return 0;
+
+            size_type erased = 0;
+            write_(shard_, [&]
+            {
+                for(size_type i = 0; i <= t->mask; ++i)
+                {
+                    slot& sl = t->slots[i];
+                    if(sl.hash.load(std::memory_order_relaxed) <= erased_hash) continue;
+                    if(!pred(load_<K>(sl.key), load_<V>(sl.value))) continue;
+                    sl.hash.store(erased_hash, std::memory_order_relaxed);
+                    ++erased;
+                }
+            });
+            shard_.size.fetch_sub(erased, std::memory_order_relaxed);
+            return erased;
+        }
+
+    private:
+        friend class concurrent_hash_map;
+
+        explicit locked_shard(shard& s) noexcept : shard_(s) { }
+
+        shard& shard_;
+    };
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    /**
+     * \param capacity Number of entries to make room for up front, spread over the shards
+     */
+    explicit concurrent_hash_map(size_type capacity = 0, const Hash& hash = Hash(), const Eq& eq = Eq())
+        : hash_(hash)
+        , eq_(eq)
+    {
+        if(capacity == 0) return;
+        const size_type per_shard = capacity / Shards + 1;
+        for(shard& s : *shards_) install_(s, capacity_for_(per_shard));
+    }
+
+    concurrent_hash_map(const concurrent_hash_map&) = delete;
+    concurrent_hash_map& operator=(const concurrent_hash_map&) = delete;
+
+// Lookup --------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \return a copy of the value mapped to key, or an empty optional
+     */
+    [[nodiscard]] optional<V> find(const K& key) const
+    {
+        const std::uint64_t h = hash_of_(key);
+        return find_hashed_(shard_of_(h), key, h);
+    }
+
+    [[nodiscard]] bool contains(const K& key) const { return find(key).has_value(); }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Returns the value mapped to key, first inserting V(args...) if there is none. A key that is already
+     *        present costs one lock-free lookup.
+     * \return the mapped value and whether it was inserted
+     */
+    template<typename... Args>
+    std::pair<V, bool> find_or_emplace(const K& key, Args&&... args)
+    {
+        const std::uint64_t h = hash_of_(key);
+        shard&              s = shard_of_(h);
+        if(optional<V> found = find_hashed_(s, key, h)) return { *found, false };
+
+        std::lock_guard lock(s.mutex);
+        if(const slot* sl = locate_(s, key, h)) return { load_<V>(sl->value), false };
+
+        const V value(std::forward<Args>(args)...);
+        insert_new_(s, key, value, h);
+        return { value, true };
+    }
+
+    /**
+     * \return true if key was inserted, false if its value was replaced
+     */
+    bool insert_or_assign(const K& key, const V& value)
+    {
+        const std::uint64_t h = hash_of_(key);
+        shard&              s = shard_of_(h);
+
+        std::lock_guard lock(s.mutex);
+        if(slot* sl = locate_(s, key, h))
+        {
+            write_(s, [&] { std::memcpy(sl->value, &value, sizeof(V)); });
+            return false;
+        }
+        insert_new_(s, key, value, h);
+        return true;
+    }
+
+    /**
+     * \brief Replaces the value of key with a copy that fn(V&) has modified, atomically with respect to other
+     *        writers of its shard
+     * \return whether key was present
+     */
+    template<typename Fn>
+    bool update(const K& key, Fn&& fn)
+    {
+        const std::uint64_t h = hash_of_(key);
+        shard&              s = shard_of_(h);
+
+        std::lock_guard lock(s.mutex);
+        slot* sl = locate_(s, key, h);
+        if(sl == nullptr) return false;
+
+        V value = load_<V>(sl->value);
+        fn(value);
+        write_(s, [&] { std::memcpy(sl->value, &value, sizeof(V)); });
+        return true;
+    }
+
+    /**
+     * \return whether key was present
+     */
+    bool erase(const K& key)
+    {
+        const std::uint64_t h = hash_of_(key);
+        shard&              s = shard_of_(h);
+
+        std::lock_guard lock(s.mutex);
+        slot* sl = locate_(s, key, h);
+        if(sl == nullptr) return false;
+
+        write_(s, [&] { sl->hash.store(erased_hash, std::memory_order_relaxed); });
+        s.size.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * \brief Erases every entry, keeping each shard's table for reuse
+     */
+    void clear()
+    {
+        for(shard& s : *shards_)
+        {
+            std::lock_guard lock(s.mutex);
+            table* t = s.current.load(std::memory_order_relaxed);
+            if(t == nullptr) continue;
+
+            write_(s, [&]
+            {
+                for(size_type i = 0; i <= t->mask; ++i) t->slots[i].hash.store(empty_hash, std::memory_order_relaxed);
+            });
+            t->used = 0;
+            s.size.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * \brief Calls fn(locked_shard&) for each shard in turn with that shard's writers locked out. Readers are only
+     *        held up while locked_shard::erase_if runs.
+     */
+    template<typename Fn>
+    void for_each_shard(Fn&& fn)
+    {
+        for(shard& s : *shards_)
+        {
+            std::lock_guard lock(s.mutex);
+            locked_shard view(s);
+            fn(view);
+        }
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Sum of the shard sizes, each read at a slightly different moment while writers are active
+     */
+    [[nodiscard]] size_type size() const noexcept
+    {
+        size_type n = 0;
+        for(const shard& s : *shards_) n += s.size.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+    [[nodiscard]] hasher    hash_function() const { return hash_; }
+    [[nodiscard]] key_equal key_eq()        const { return eq_; }
+
+    /**
+     * \brief Bytes held by the shards' current tables
+     */
+    [[nodiscard]] size_type memory_usage()
+    {
+        size_type bytes = sizeof(*this) + sizeof(*shards_);
+        for(shard& s : *shards_)
+        {
+            std::lock_guard lock(s.mutex);
+            const table* t = s.current.load(std::memory_order_relaxed);
+            if(t != nullptr) bytes += sizeof(table) + (t->mask + 1) * sizeof(slot);
+        }
+        return bytes;
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    std::uint64_t hash_of_(const K& key) const
+    {
+        std::uint64_t h;
+        if constexpr(detail::is_avalanching<Hash>::value) h = static_cast<std::uint64_t>(hash_(key));
+        else h = detail::mix_hash(static_cast<std::uint64_t>(hash_(key)));
+        return h > erased_hash ? h : h + 2;
+    }
+
+    /// Top hash bits pick the shard; a single shard is special-cased because h >> 64 is undefined
+    static constexpr size_type shard_index_(std::uint64_t h) noexcept
+    {
+        if constexpr(Shards == 1) return 0;
+        else                      return static_cast<size_type>(h >> (64 - std::countr_zero(Shards)));
+    }
+
+    shard&       shard_of_(std::uint64_t h)       noexcept { return (*shards_)[shard_index_(h)]; }
+    const shard& shard_of_(std::uint64_t h) const noexcept { return (*shards_)[shard_index_(h)]; }
+
+    static size_type capacity_for_(size_type entries) noexcept
+    {
+        return std::max(min_capacity, std::bit_ceil(entries + entries / 2 + 1));
+    }
+
+    optional<V> find_hashed_(const shard& s, const K& key, std::uint64_t h) const
+    {
+        const epoch_guard guard;
+        for(;;)
+        {
+            const std::uint64_t seq = s.seq.load(std::memory_order_acquire);
+            if(OCU_UNLIKELY(seq & 1))
+            {
+                detail::spin_pause();
+                continue;
+            }
+
+            optional<V>  result;
+            const table* t = s.current.load(std::memory_order_acquire);
+            if(t != nullptr)
+            {
+                size_type i = static_cast<size_type>(h) & t->mask;
+                for(size_type probed = 0; probed <= t->mask; ++probed, i = (i + 1) & t->mask)
+                {
+                    const std::uint64_t sh = t->slots[i].hash.load(std::memory_order_relaxed);
+                    if(sh == empty_hash) break;
+                    if(sh == h && eq_(load_<K>(t->slots[i].key), key))
+                    {
+                        result = load_<V>(t->slots[i].value);
+                        break;
+                    }
+                }
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(OCU_LIKELY(s.seq.load(std::memory_order_relaxed) == seq)) return result;
+        }
+    }
+
+    /// Caller holds the shard mutex
+    slot* locate_(shard& s, const K& key, std::uint64_t h) const
+    {
+        table* t = s.current.load(std::memory_order_relaxed);
+        if(t == nullptr) return nullptr;
+
+        size_type i = static_cast<size_type>(h) & t->mask;
+        for(size_type probed = 0; probed <= t->mask; ++probed, i = (i + 1) & t->mask)
+        {
+            const std::uint64_t sh = t->slots[i].hash.load(std::memory_order_relaxed);
+            if(sh == empty_hash) return nullptr;
+            if(sh == h && eq_(load_<K>(t->slots[i].key), key)) return &t->slots[i];
+        }
+        return nullptr;
+    }
+
+    /// Runs fn with the shard's sequence odd, so readers overlapping it retry. Caller holds the shard mutex.
+    template<typename Fn>
+    static void write_(shard& s, Fn&& fn)
+    {
+        const std::uint64_t seq = s.seq.load(std::memory_order_relaxed);
+        s.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        fn();
+        s.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    /// Places an entry into t, which the caller knows does not hold key and has a free slot
+    static slot& place_(table& t, const K& key, const V& value, std::uint64_t h) noexcept
+    {
+        size_type i = static_cast<size_type>(h) & t.mask;
+        while(t.slots[i].hash.load(std::memory_order_relaxed) > erased_hash) i = (i + 1) & t.mask;
+
+        slot& sl = t.slots[i];
+        if(sl.hash.load(std::memory_order_relaxed) == empty_hash) ++t.used;
+        std::memcpy(sl.key, &key, sizeof(K));
+        std::memcpy(sl.value, &value, sizeof(V));
+        sl.hash.store(h, std::memory_order_relaxed);
+        return sl;
+    }
+
+    /// Caller holds the shard mutex and has checked that key is absent
+    void insert_new_(shard& s, const K& key, const V& value, std::uint64_t h)
+    {
+        table* t = s.current.load(std::memory_order_relaxed);
+        const size_type live = s.size.load(std::memory_order_relaxed);
+        if(t == nullptr || (t->used + 1) * 8 > (t->mask + 1) * 7)
+        {
+            // Mostly tombstones: sweep them in place rather than growing
+            if(t != nullptr && (live + 1) * 2 <= t->mask + 1) sweep_(s, *t);
+            else t = install_(s, capacity_for_(live + 1));
+        }
+
+        write_(s, [&] { place_(*t, key, value, h); });
+        s.size.store(live + 1, std::memory_order_relaxed);
+    }
+
+    /// Rebuilds t without tombstones. Readers retry for the duration. Caller holds the shard mutex.
+    static void sweep_(shard& s, table& t)
+    {
+        table fresh(t.mask + 1);
+        copy_live_(t, fresh);
+        write_(s, [&]
+        {
+            for(size_type i = 0; i <= t.mask; ++i)
+            {
+                slot& dst = t.slots[i];
+                slot& src = fresh.slots[i];
+                std::memcpy(dst.key, src.key, sizeof(K));
+                std::memcpy(dst.value, src.value, sizeof(V));
+                dst.hash.store(src.hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+        });
+        t.used = fresh.used;
+    }
+
+    /// Publishes a new table of the given capacity holding the shard's entries. Caller holds the shard mutex.
+    static table* install_(shard& s, size_type capacity)
+    {
+        auto   fresh = std::make_unique<table>(capacity);
+        table* old   = s.current.load(std::memory_order_relaxed);
+        if(old != nullptr) copy_live_(*old, *fresh);
+
+        table* t = fresh.release();
+        s.current.store(t, std::memory_order_release);
+        if(old != nullptr) default_epoch_domain().retire(old);
+        return t;
+    }
+
+    static void copy_live_(const table& from, table& to) noexcept
+    {
+        for(size_type i = 0; i <= from.mask; ++i)
+        {
+            const slot&         sl = from.slots[i];
+            const std::uint64_t h  = sl.hash.load(std::memory_order_relaxed);
+            if(h <= erased_hash) continue;
+            place_(to, load_<K>(sl.key), load_<V>(sl.value), h);
+        }
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::unique_ptr<std::array<shard, Shards>> shards_{ std::make_unique<std::array<shard, Shards>>() };
+    OCU_NO_UNIQUE_ADDRESS Hash                 hash_;
+    OCU_NO_UNIQUE_ADDRESS Eq                   eq_;
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_CONCURRENT_HASH_MAP_H
@@ -0,0 +1,654 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_CONCURRENT_QUEUE_H
+#define OPEN_CPP_UTILS_CONCURRENT_QUEUE_H
+
+#include "config.h"
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace open_cpp_utils
+{
+
+namespace detail
+{
+
+inline std::size_t queue_capacity(std::size_t requested)
+{
+    if(requested < 2) requested = 2;
+    if(requested > (std::size_t(1) << (sizeof(std::size_t) * 8 - 2)))
+    {
+        throw std::length_error("queue capacity too large");
+    }
+    return std::bit_ceil(requested);
+}
+
+template<typename It, typename T>
+inline constexpr bool nothrow_move_from_v = noexcept(++std::declval<It&>()) && noexcept(*std::declval<It&>())
+                                         && std::is_nothrow_constructible_v<T, decltype(std::move(*std::declval<It&>()))>;
+
+template<typename It, typename T>
+inline constexpr bool nothrow_move_to_v = noexcept(++std::declval<It&>())
+                                       && noexcept(*std::declval<It&>() = std::declval<T&&>());
+
+}
+
+// mpmc_queue ==========================================================================================================
+
+/**
+ * \brief Bounded lock-free multi-producer multi-consumer queue (Dmitry Vyukov's design).
+ *
+ * Every cell carries a sequence number that tells producers and consumers of a given lap whether the cell is theirs,
+ * so a successful push or pop costs one CAS on the shared position plus one release store on the cell. The enqueue
+ * and dequeue positions live on separate cache lines. try_push_n / try_pop_n claim a run of consecutive cells with
+ * a single CAS, which amortizes the contended operation over the batch.
+ *
+ * Operations never block; they return false (or a short count) when the queue is full or empty.
+ *
+ * A claimed cell is always published, so an exception never wedges the queue. A value whose construction may throw
+ * is built before a cell is claimed and moved in afterwards; a destination whose assignment may throw receives the
+ * value only after its cell has been released, so the value is lost if that assignment throws. Batches through
+ * iterators that may throw fall back to one claim per element.
+ *
+ * \tparam T Element type, must be nothrow move constructible
+ */
+template<typename T>
+class mpmc_queue
+{
+    static_assert(std::is_nothrow_move_constructible_v<T>, "mpmc_queue elements must be nothrow move constructible");
+    static_assert(std::is_nothrow_destructible_v<T>,       "mpmc_queue elements must be nothrow destructible");
+
+// Typedefs ============================================================================================================
+
+public:
+    using value_type = T;
+    using size_type  = std::size_t;
+
+private:
+    struct cell
+    {
+        std::atomic<size_type> sequence;
+        alignas(T) std::byte   storage[sizeof(T)];
+
+        T* value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Creates a queue holding at least capacity elements (rounded up to a power of two)
+     */
+    explicit mpmc_queue(size_type capacity)
+        : mask_(detail::queue_capacity(capacity) - 1)
+        , cells_(std::make_unique<cell[]>(mask_ + 1))
+    {
+        for(size_type i = 0; i <= mask_; ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    ~mpmc_queue()
+    {
+        if constexpr(!std::is_trivially_destructible_v<T>)
+        {
+            const size_type tail = enqueue_pos_.value.load(std::memory_order_relaxed);
+            for(size_type i = dequeue_pos_.value.load(std::memory_order_relaxed); i != tail; ++i)
+            {
+                std::destroy_at(cells_[i & mask_].value());
+            }
+        }
+    }
+
+// Producers -----------------------------------------------------------------------------------------------------------
+
+    template<typename...Args>
+    [[nodiscard]] bool try_emplace(Args&&...args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>)
+    {
+        if constexpr(!std::is_nothrow_constructible_v<T, Args&&...>)
+        {
+            T value(std::forward<Args>(args)...);
+            return try_emplace(std::move(value));
+        }
+        else
+        {
+            size_type pos;
+            cell* c = claim_push_(pos);
+            if(c == nullptr) return false;
+
+            ::new(static_cast<void*>(c->storage)) T(std::forward<Args>(args)...);
+            c->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+    }
+
+    [[nodiscard]] bool try_push(const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>)
+    {
+        return try_emplace(value);
+    }
+
+    [[nodiscard]] bool try_push(T&& value) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        return try_emplace(std::move(value));
+    }
+
+    /**
+     * \brief Moves up to count elements from first into the queue with a single claim
+     * \return Number of elements pushed; the first that many elements of the range have been moved from
+     */
+    template<typename InputIt>
+    size_type try_push_n(InputIt first, size_type count) noexcept(detail::nothrow_move_from_v<InputIt, T>)
+    {
+        if constexpr(!detail::nothrow_move_from_v<InputIt, T>)
+        {
+            size_type pushed = 0;
+            for(; pushed < count; ++pushed, ++first)
+            {
+                if(!try_emplace(std::move(*first))) break;
+            }
+            return pushed;
+        }
+        else
+        {
+            return push_n_(first, count);
+        }
+    }
+
+// Consumers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] bool try_pop(T& out) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        if constexpr(!std::is_nothrow_move_assignable_v<T>)
+        {
+            std::optional<T> value = try_pop();
+            if(!value) return false;
+            out = std::move(*value);
+            return true;
+        }
+        else
+        {
+            size_type pos;
+            cell* c = claim_pop_(pos);
+            if(c == nullptr) return false;
+
+            out = std::move(*c->value());
+            std::destroy_at(c->value());
+            c->sequence.store(pos + mask_ + 1, std::memory_order_release);
+            return true;
+        }
+    }
+
+    [[nodiscard]] std::optional<T> try_pop() noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        std::optional<T> result;
+        size_type pos;
+        cell* c = claim_pop_(pos);
+        if(c == nullptr) return result;
+
+        result.emplace(std::move(*c->value()));
+        std::destroy_at(c->value());
+        c->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return result;
+    }
+
+    /**
+     * \brief Moves up to count elements into out with a single claim
+     * \return Number of elements written through out
+     */
+    template<typename OutputIt>
+    size_type try_pop_n(OutputIt out, size_type count) noexcept(detail::nothrow_move_to_v<OutputIt, T>)
+    {
+        if constexpr(!detail::nothrow_move_to_v<OutputIt, T>)
+        {
+            size_type popped = 0;
+            for(; popped < count; ++popped)
+            {
+                std::optional<T> value = try_pop();
+                if(!value) break;
+                *out = std::move(*value);
+                ++out;
+            }
+            return popped;
+        }
+        else
+        {
+            return pop_n_(out, count);
+        }
+    }
+
+// Capacity ------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] size_type capacity() const noexcept { return mask_ + 1; }
+
+    /**
+     * \brief Number of elements at some recent point in time; exact only when no other thread is operating
+     */
+    [[nodiscard]] size_type size_approx() const noexcept
+    {
+        const size_type head = dequeue_pos_.value.load(std::memory_order_relaxed);
+        const size_type tail = enqueue_pos_.value.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    [[nodiscard]] bool empty_approx() const noexcept { return size_approx() == 0; }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    cell* claim_push_(size_type& pos) noexcept
+    {
+        pos = enqueue_pos_.value.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            cell& c = cells_[pos & mask_];
+            const size_type seq  = c.sequence.load(std::memory_order_acquire);
+            const auto      diff = static_cast<std::ptrdiff_t>(seq - pos);
+
+            if(diff == 0)
+            {
+                if(enqueue_pos_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return &c;
+            }
+            else if(diff < 0)
+            {
+                return nullptr;
+            }
+            else
+            {
+                pos = enqueue_pos_.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<typename InputIt>
+    size_type push_n_(InputIt first, size_type count) noexcept
+    {
+        if(count == 0) return 0;
+
+        size_type pos = enqueue_pos_.value.load(std::memory_order_relaxed);
+        size_type claimed;
+        for(;;)
+        {
+            claimed = 0;
+            while(claimed < count && claimed <= mask_)
+            {
+                const size_type seq = cells_[(pos + claimed) & mask_].sequence.load(std::memory_order_acquire);
+                if(seq != pos + claimed) break;
+                ++claimed;
+            }
+
+            if(claimed == 0)
+            {
+                const size_type seq = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+                if(static_cast<std::ptrdiff_t>(seq - pos) < 0) return 0;
+                pos = enqueue_pos_.value.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if(enqueue_pos_.value.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) break;
+        }
+
+        for(size_type i = 0; i < claimed; ++i, ++first)
+        {
+            cell& c = cells_[(pos + i) & mask_];
+            ::new(static_cast<void*>(c.storage)) T(std::move(*first));
+            c.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return claimed;
+    }
+
+    template<typename OutputIt>
+    size_type pop_n_(OutputIt out, size_type count) noexcept
+    {
+        if(count == 0) return 0;
+
+        size_type pos = dequeue_pos_.value.load(std::memory_order_relaxed);
+        size_type claimed;
+        for(;;)
+        {
+            claimed = 0;
+            while(claimed < count && claimed <= mask_)
+            {
+                const size_type seq = cells_[(pos + claimed) & mask_].sequence.load(std::memory_order_acquire);
+                if(seq != pos + claimed + 1) break;
+                ++claimed;
+            }
+
+            if(claimed == 0)
+            {
+                const size_type seq = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+                if(static_cast<std::ptrdiff_t>(seq - (pos + 1)) < 0) return 0;
+                pos = dequeue_pos_.value.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if(dequeue_pos_.value.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) break;
+        }
+
+        for(size_type i = 0; i < claimed; ++i)
+        {
+            cell& c = cells_[(pos + i) & mask_];
+            *out = std::move(*c.value());
+            ++out;
+            std::destroy_at(c.value());
+            c.sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+        }
+        return claimed;
+    }
+
+    cell* claim_pop_(size_type& pos) noexcept
+    {
+        pos = dequeue_pos_.value.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            cell& c = cells_[pos & mask_];
+            const size_type seq  = c.sequence.load(std::memory_order_acquire);
+            const auto      diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+
+            if(diff == 0)
+            {
+                if(dequeue_pos_.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return &c;
+            }
+            else if(diff < 0)
+            {
+                return nullptr;
+            }
+            else
+            {
+                pos = dequeue_pos_.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    struct alignas(cache_line_size) padded_index
+    {
+        std::atomic<size_type> value{ 0 };
+    };
+
+// Variables ===========================================================================================================
+
+private:
+    const size_type         mask_;
+    std::unique_ptr<cell[]> cells_;
+    padded_index            enqueue_pos_;
+    padded_index            dequeue_pos_;
+};
+
+// spsc_queue ==========================================================================================================
+
+/**
+ * \brief Bounded wait-free single-producer single-consumer ring buffer.
+ *
+ * The producer owns head_ and the consumer owns tail_, each on its own cache line. Each side keeps a private copy of
+ * the other side's index and only reloads the shared one when the copy says the ring is full (or empty), so in the
+ * steady state a push or pop touches no cache line written by the other thread except the element itself.
+ *
+ * Exactly one thread may push and exactly one thread may pop at a time.
+ */
+template<typename T>
+class spsc_queue
+{
+    static_assert(std::is_nothrow_destructible_v<T>, "spsc_queue elements must be nothrow destructible");
+
+// Typedefs ============================================================================================================
+
+public:
+    using value_type = T;
+    using size_type  = std::size_t;
+
+private:
+    union slot
+    {
+        slot()  { }
+        ~slot() { }
+
+        T value;
+    };
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    explicit spsc_queue(size_type capacity)
+        : mask_(detail::queue_capacity(capacity) - 1)
+        , slots_(std::make_unique<slot[]>(mask_ + 1))
+    { }
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    ~spsc_queue()
+    {
+        if constexpr(!std::is_trivially_destructible_v<T>)
+        {
+            const size_type head = producer_.head.load(std::memory_order_relaxed);
+            for(size_type i = consumer_.tail.load(std::memory_order_relaxed); i != head; ++i)
+            {
+                std::destroy_at(&slots_[i & mask_].value);
+            }
+        }
+    }
+
+// Producer ------------------------------------------------------------------------------------------------------------
+
+    template<typename...Args>
+    [[nodiscard]] bool try_emplace(Args&&...args) noexcept(std::is_nothrow_constructible_v<T, Args&&...>)
+    {
+        const size_type head = producer_.head.load(std::memory_order_relaxed);
+        if(OCU_UNLIKELY(head - producer_.cached_tail > mask_))
+        {
+            producer_.cached_tail = consumer_.tail.load(std::memory_order_acquire);
+            if(head - producer_.cached_tail > mask_) return false;
+        }
+
+        ::new(static_cast<void*>(&slots_[head & mask_].value)) T(std::forward<Args>(args)...);
+        producer_.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] bool try_push(const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>)
+    {
+        return try_emplace(value);
+    }
+
+    [[nodiscard]] bool try_push(T&& value) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        return try_emplace(std::move(value));
+    }
+
+    /**
+     * \brief Moves up to count elements from first into the ring and publishes them with one store
+     * \return Number of elements pushed
+     */
+    template<typename InputIt>
+    size_type try_push_n(InputIt first, size_type count) noexcept(detail::nothrow_move_from_v<InputIt, T>)
+    {
+        const size_type head = producer_.head.load(std::memory_order_relaxed);
+        size_type room = mask_ + 1 - (head - producer_.cached_tail);
+        if(room < count)
+        {
+            producer_.cached_tail = consumer_.tail.load(std::memory_order_acquire);
+            room = mask_ + 1 - (head - producer_.cached_tail);
+        }
+
+        const size_type n = count < room ? count : room;
+        size_type i = 0;
+        const auto fill = [&]
+        {
+            for(; i < n; ++i, ++first)
+            {
+                ::new(static_cast<void*>(&slots_[(head + i) & mask_].value)) T(std::move(*first));
+            }
+        };
+
+        if constexpr(detail::nothrow_move_from_v<InputIt, T>)
+        {
+            fill();
+        }
+        else
+        {
+            try
+            {
+                fill();
+            }
+            catch(...)
+            {
+                // Publish the elements that were constructed so the ring stays consistent
+                if(i) producer_.head.store(head + i, std::memory_order_release);
+                throw;
+            }
+        }
+        if(n) producer_.head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+// Consumer ------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] bool try_pop(T& out) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        T* front = peek();
+        if(front == nullptr) return false;
+        out = std::move(*front);
+        pop();
+        return true;
+    }
+
+    [[nodiscard]] std::optional<T> try_pop() noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        std::optional<T> result;
+        if(T* front = peek())
+        {
+            result.emplace(std::move(*front));
+            pop();
+        }
+        return result;
+    }
+
+    /**
+     * \brief Returns the front element without removing it, or nullptr if the ring is empty. Consumer only.
+     */
+    [[nodiscard]] T* peek() noexcept
+    {
+        const size_type tail = consumer_.tail.load(std::memory_order_relaxed);
+        if(OCU_UNLIKELY(tail == consumer_.cached_head))
+        {
+            consumer_.cached_head = producer_.head.load(std::memory_order_acquire);
+            if(tail == consumer_.cached_head) return nullptr;
+        }
+        return &slots_[tail & mask_].value;
+    }
+
+    /**
+     * \brief Removes the front element. peek() must have returned non-null since the last pop. Consumer only.
+     */
+    void pop() noexcept
+    {
+        const size_type tail = consumer_.tail.load(std::memory_order_relaxed);
+        OCU_ASSERT(tail != consumer_.cached_head, "spsc_queue::pop on an empty queue");
+        std::destroy_at(&slots_[tail & mask_].value);
+        consumer_.tail.store(tail + 1, std::memory_order_release);
+    }
+
+    /**
+     * \brief Moves up to count elements into out and releases their slots with one store
+     * \return Number of elements written through out
+     */
+    template<typename OutputIt>
+    size_type try_pop_n(OutputIt out, size_type count) noexcept(detail::nothrow_move_to_v<OutputIt, T>)
+    {
+        const size_type tail = consumer_.tail.load(std::memory_order_relaxed);
+        size_type avail = consumer_.cached_head - tail;
+        if(avail < count)
+        {
+            consumer_.cached_head = producer_.head.load(std::memory_order_acquire);
+            avail = consumer_.cached_head - tail;
+        }
+
+        const size_type n = count < avail ? count : avail;
+        size_type i = 0;
+        const auto drain = [&]
+        {
+            for(; i < n; ++i, ++out)
+            {
+                T& v = slots_[(tail + i) & mask_].value;
+                *out = std::move(v);
+                std::destroy_at(&v);
+            }
+        };
+
+        if constexpr(detail::nothrow_move_to_v<OutputIt, T>)
+        {
+            drain();
+        }
+        else
+        {
+            try
+            {
+                drain();
+            }
+            catch(...)
+            {
+                // Slots before i have been written out and destroyed; release them and leave the rest queued
+                if(i) consumer_.tail.store(tail + i, std::memory_order_release);
+                throw;
+            }
+        }
+        if(n) consumer_.tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+// Capacity ------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] size_type capacity() const noexcept { return mask_ + 1; }
+
+    [[nodiscard]] size_type size_approx() const noexcept
+    {
+        // Tail first: head only moves forward, so a later head can never be behind it
+        const size_type tail = consumer_.tail.load(std::memory_order_acquire);
+        return producer_.head.load(std::memory_order_acquire) - tail;
+    }
+
+    [[nodiscard]] bool empty_approx() const noexcept { return size_approx() == 0; }
+
+// Variables ===========================================================================================================
+
+private:
+    struct alignas(cache_line_size) producer_side
+    {
+        std::atomic<size_type> head{ 0 };
+        size_type              cached_tail = 0;
+    };
+
+    struct alignas(cache_line_size) consumer_side
+    {
+        std::atomic<size_type> tail{ 0 };
+        size_type              cached_head = 0;
+    };
+
+    const size_type         mask_;
+    std::unique_ptr<slot[]> slots_;
+    producer_side           producer_;
+    consumer_side           consumer_;
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_CONCURRENT_QUEUE_H
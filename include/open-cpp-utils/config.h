@@ -0,0 +1,117 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_CONFIG_H
+#define OPEN_CPP_UTILS_CONFIG_H
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+// Version =============================================================================================================
+
+#define OCU_VERSION_MAJOR 0
+#define OCU_VERSION_MINOR 1
+#define OCU_VERSION_PATCH 0
+
+// Platform ============================================================================================================
+
+#if defined(_WIN32)
+#   define OCU_PLATFORM_WINDOWS 1
+#elif defined(__linux__)
+#   define OCU_PLATFORM_LINUX 1
+#   define OCU_PLATFORM_POSIX 1
+#elif defined(__APPLE__)
+#   define OCU_PLATFORM_APPLE 1
+#   define OCU_PLATFORM_POSIX 1
+#elif defined(__unix__)
+#   define OCU_PLATFORM_POSIX 1
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#   define OCU_ARCH_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#   define OCU_ARCH_ARM 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define OCU_HAS_SSE2 1
+#endif
+
+#if defined(__AVX2__)
+#   define OCU_HAS_AVX2 1
+#endif
+
+#if (defined(__ARM_NEON) || defined(_M_ARM64)) && !defined(__ARM_BIG_ENDIAN)
+#   define OCU_HAS_NEON 1
+#endif
+
+// Compiler Hints ======================================================================================================
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define OCU_LIKELY(x)     __builtin_expect(!!(x), 1)
+#   define OCU_UNLIKELY(x)   __builtin_expect(!!(x), 0)
+#   define OCU_FORCEINLINE   inline __attribute__((always_inline))
+#   define OCU_NOINLINE      __attribute__((noinline))
+#elif defined(_MSC_VER)
+#   define OCU_LIKELY(x)     (x)
+#   define OCU_UNLIKELY(x)   (x)
+#   define OCU_FORCEINLINE   __forceinline
+#   define OCU_NOINLINE      __declspec(noinline)
+#else
+#   define OCU_LIKELY(x)     (x)
+#   define OCU_UNLIKELY(x)   (x)
+#   define OCU_FORCEINLINE   inline
+#   define OCU_NOINLINE
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#   define OCU_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#   define OCU_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
+// Assertions ==========================================================================================================
+
+/**
+ * \brief Debug-only invariant check. Compiles to nothing when NDEBUG is defined unless OCU_ENABLE_ASSERTS is set.
+ */
+#if !defined(OCU_ASSERT)
+#   if !defined(NDEBUG) || defined(OCU_ENABLE_ASSERTS)
+#       define OCU_ASSERT(cond, msg) \
+            ((cond) ? static_cast<void>(0) : ::open_cpp_utils::detail::assert_fail(#cond, msg, __FILE__, __LINE__))
+#       define OCU_DEBUG 1
+#   else
+#       define OCU_ASSERT(cond, msg) static_cast<void>(0)
+#   endif
+#endif
+
+namespace open_cpp_utils
+{
+
+namespace detail
+{
+
+[[noreturn]] inline void assert_fail(const char* cond, const char* msg, const char* file, int line) noexcept
+{
+    std::fprintf(stderr, "%s:%d: assertion '%s' failed: %s\n", file, line, cond, msg);
+    std::abort();
+}
+
+}
+
+/**
+ * \brief Size used to pad shared atomics onto separate cache lines. 64 bytes covers every mainstream x86 and ARM
+ *        core; Apple silicon uses 128 byte lines and gets the larger value.
+ */
+#if defined(__APPLE__) && defined(__aarch64__)
+inline constexpr std::size_t cache_line_size = 128;
+#else
+inline constexpr std::size_t cache_line_size = 64;
+#endif
+
+}
+
+#endif // OPEN_CPP_UTILS_CONFIG_H
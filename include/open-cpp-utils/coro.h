@@ -0,0 +1,905 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_CORO_H
+#define OPEN_CPP_UTILS_CORO_H
+
+#include "config.h"
+#include "arena.h"
+#include "filesystem.h"
+#include "thread_pool.h"
+#include "timer_wheel.h"
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace open_cpp_utils
+{
+
+template<typename T = void>
+class task;
+
+namespace detail
+{
+
+// Frame Allocation ----------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Per-thread free lists of coroutine frames in 64 byte size classes up to 1 KiB.
+ *
+ * A pipeline creates and destroys frames of the same few sizes over and over; recycling them skips the global
+ * allocator on every call after the first few. Each frame carries a small header naming its size class, or marking it
+ * as a large heap frame or an arena frame, so operator delete needs no size and no knowledge of where it came from.
+ * A frame freed on another thread simply joins that thread's list.
+ */
+struct coro_frame_cache
+{
+    static constexpr std::size_t   granularity = 64;
+    static constexpr std::size_t   classes     = 16;
+    static constexpr std::uint32_t limit       = 64;  ///< Frames kept per class and thread
+    static constexpr std::uint32_t heap_frame  = 0xFFFFFFFE;
+    static constexpr std::uint32_t arena_frame = 0xFFFFFFFF;
+    static constexpr std::size_t   header      = alignof(std::max_align_t);
+
+    struct free_frame
+    {
+        free_frame* next;
+    };
+
+    coro_frame_cache() = default;
+    coro_frame_cache(const coro_frame_cache&) = delete;
+    coro_frame_cache& operator=(const coro_frame_cache&) = delete;
+
+    ~coro_frame_cache()
+    {
+        for(std::size_t c = 0; c < classes; ++c)
+        {
+            while(free_frame* f = heads[c])
+            {
+                heads[c] = f->next;
+                ::operator delete(f);
+            }
+
+            // Frames destroyed later during thread exit go straight back to the heap
+            counts[c] = limit;
+        }
+    }
+
+    std::array<free_frame*, classes>   heads{ };
+    std::array<std::uint32_t, classes> counts{ };
+};
+
+inline thread_local coro_frame_cache coro_frames;
+
+inline void* coro_tag_frame_(void* block, std::uint32_t tag) noexcept
+{
+    *static_cast<std::uint32_t*>(block) = tag;
+    return static_cast<std::byte*>(block) + coro_frame_cache::header;
+}
+
+inline void* coro_allocate(std::size_t size)
+{
+    using cache = coro_frame_cache;
+
+    const std::size_t c = (size + cache::header - 1) / cache::granularity;
+    if(c >= cache::classes) return coro_tag_frame_(::operator new(size + cache::header), cache::heap_frame);
+
+    cache& frames = coro_frames;
+    void*  block  = frames.heads[c];
+    if(block != nullptr)
+    {
+        frames.heads[c] = frames.heads[c]->next;
+        --frames.counts[c];
+    }
+    else
+    {
+        block = ::operator new((c + 1) * cache::granularity);
+    }
+    return coro_tag_frame_(block, static_cast<std::uint32_t>(c));
+}
+
+inline void* coro_allocate(std::size_t size, monotonic_arena& arena)
+{
+    return coro_tag_frame_(arena.allocate(size + coro_frame_cache::header), coro_frame_cache::arena_frame);
+}
+
+inline void coro_deallocate(void* frame) noexcept
+{
+    using cache = coro_frame_cache;
+
+    void* const         block = static_cast<std::byte*>(frame) - cache::header;
+    const std::uint32_t tag   = *static_cast<std::uint32_t*>(block);
+    if(tag == cache::arena_frame) return;
+    if(tag == cache::heap_frame)
+    {
+        ::operator delete(block);
+        return;
+    }
+
+    cache& frames = coro_frames;
+    if(frames.counts[tag] >= cache::limit)
+    {
+        ::operator delete(block);
+        return;
+    }
+    frames.heads[tag] = ::new(block) cache::free_frame{ frames.heads[tag] };
+    ++frames.counts[tag];
+}
+
+/**
+ * \brief Allocation for every promise in this header. A coroutine whose parameters start with
+ *        (std::allocator_arg, monotonic_arena&) - after the object parameter, for member functions - places its frame
+ *        in that arena; everything else uses the recycling per-thread frame cache.
+ */
+struct coro_promise_base
+{
+    static void* operator new(std::size_t size) { return coro_allocate(size); }
+
+    // A usual operator delete cannot be a template, so GCC's -Wmismatched-new-delete flags any frame that came from
+    // one of these templates. Forcing them inline makes coro_allocate the visible allocation instead.
+    template<typename... Args>
+    OCU_FORCEINLINE static void* operator new(std::size_t size, std::allocator_arg_t, monotonic_arena& arena, Args&&...)
+    {
+        return coro_allocate(size, arena);
+    }
+
+    template<typename Self, typename... Args>
+    OCU_FORCEINLINE static void* operator new(std::size_t size, Self&&, std::allocator_arg_t, monotonic_arena& arena,
+                                              Args&&...)
+    {
+        return coro_allocate(size, arena);
+    }
+
+    static void operator delete(void* frame) noexcept { coro_deallocate(frame); }
+};
+
+// Results -------------------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Value or exception produced by a coroutine, shared by task and when_all promises
+ */
+template<typename T>
+class coro_result
+{
+public:
+    template<typename U = T> requires std::constructible_from<T, U&&>
+    void return_value(U&& value) noexcept(std::is_nothrow_constructible_v<T, U&&>)
+    {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+    T& get() &
+    {
+        if(error_) std::rethrow_exception(error_);
+        return *value_;
+    }
+
+    T get() &&
+    {
+        if(error_) std::rethrow_exception(error_);
+        return std::move(*value_);
+    }
+
+private:
+    std::optional<T>   value_;
+    std::exception_ptr error_;
+};
+
+template<typename T>
+class coro_result<T&>
+{
+public:
+    void return_value(T& value) noexcept { value_ = std::addressof(value); }
+    void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+    T& get()
+    {
+        if(error_) std::rethrow_exception(error_);
+        return *value_;
+    }
+
+private:
+    T*                 value_ = nullptr;
+    std::exception_ptr error_;
+};
+
+template<>
+class coro_result<void>
+{
+public:
+    void return_void() noexcept { }
+    void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+    void get()
+    {
+        if(error_) std::rethrow_exception(error_);
+    }
+
+private:
+    std::exception_ptr error_;
+};
+
+// task Promise --------------------------------------------------------------------------------------------------------
+
+struct task_final_awaiter
+{
+    bool await_ready() const noexcept { return false; }
+
+    template<typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept
+    {
+        const std::coroutine_handle<> next = h.promise().continuation;
+        return next ? next : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept { }
+};
+
+template<typename T>
+struct task_promise final : coro_promise_base, coro_result<T>
+{
+    task<T> get_return_object() noexcept;
+
+    std::suspend_always initial_suspend() const noexcept { return { }; }
+    task_final_awaiter  final_suspend()   const noexcept { return { }; }
+
+    std::coroutine_handle<> continuation;
+};
+
+} // namespace detail
+
+// task ================================================================================================================
+
+/**
+ * \brief Lazily started coroutine producing a T (or an exception) for exactly one awaiter.
+ *
+ * Nothing runs until the task is awaited. co_await hands control straight to the task, and when the task finishes its
+ * final suspend transfers straight back to the awaiting coroutine (symmetric transfer), so a chain of any depth runs
+ * in constant stack. Where the work runs is decided inside the task, e.g. with co_await schedule_on(pool), and it
+ * resumes its awaiter on whatever thread it finished on.
+ *
+ * Frames come from a per-thread recycling cache, or from a monotonic_arena when the coroutine's first parameters are
+ * (std::allocator_arg, arena); the arena must then outlive the task.
+ *
+ * Top-level code waits with sync_wait. Destroying a task that was started but has not finished is undefined; one that
+ * was never awaited is simply discarded.
+ */
+template<typename T>
+class [[nodiscard]] task
+{
+// Typedefs ============================================================================================================
+
+public:
+    using promise_type = detail::task_promise<T>;
+    using value_type   = T;
+
+private:
+    using handle = std::coroutine_handle<promise_type>;
+
+    template<bool Move>
+    struct awaiter
+    {
+        bool await_ready() const noexcept { return !coroutine || coroutine.done(); }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+            coroutine.promise().continuation = awaiting;
+            return coroutine;
+        }
+
+        decltype(auto) await_resume()
+        {
+            OCU_ASSERT(coroutine, "task: awaiting an empty task");
+            if constexpr(Move) return std::move(coroutine.promise()).get();
+            else               return coroutine.promise().get();
+        }
+
+        handle coroutine;
+    };
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    task() noexcept = default;
+    explicit task(handle h) noexcept : coroutine_(h) { }
+
+    task(task&& other) noexcept : coroutine_(std::exchange(other.coroutine_, nullptr)) { }
+
+    task& operator=(task&& other) noexcept
+    {
+        if(this != &other)
+        {
+            if(coroutine_) coroutine_.destroy();
+            coroutine_ = std::exchange(other.coroutine_, nullptr);
+        }
+        return *this;
+    }
+
+    ~task() { if(coroutine_) coroutine_.destroy(); }
+
+// Awaiting ------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Starts the task; the awaiter resumes with a reference to its result once it finishes
+     */
+    awaiter<false> operator co_await() & noexcept { return { coroutine_ }; }
+
+    /**
+     * \brief Starts the task; the awaiter resumes with its result moved out once it finishes
+     */
+    awaiter<true> operator co_await() && noexcept { return { coroutine_ }; }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] bool valid() const noexcept { return static_cast<bool>(coroutine_); }
+    [[nodiscard]] bool done()  const noexcept { return coroutine_ && coroutine_.done(); }
+
+// Variables ===========================================================================================================
+
+private:
+    handle coroutine_;
+};
+
+template<typename T>
+task<T> detail::task_promise<T>::get_return_object() noexcept
+{
+    return task<T>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+
+// Scheduling ==========================================================================================================
+
+namespace detail
+{
+
+struct schedule_awaiter
+{
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) { pool.post([h] { h.resume(); }); }
+    void await_resume() const noexcept { }
+
+    thread_pool& pool;
+};
+
+} // namespace detail
+
+/**
+ * \brief co_await schedule_on(pool) suspends the coroutine and resumes it on one of pool's workers
+ */
+[[nodiscard]] inline detail::schedule_awaiter schedule_on(thread_pool& pool) noexcept { return { pool }; }
+
+// sync_wait ===========================================================================================================
+
+namespace detail
+{
+
+class sync_wait_driver
+{
+public:
+    struct promise_type : coro_promise_base
+    {
+        struct final_awaiter
+        {
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> h) noexcept { h.promise().signal->done(); }
+            void await_resume() const noexcept { }
+        };
+
+        sync_wait_driver get_return_object() noexcept
+        {
+            return sync_wait_driver(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() const noexcept { return { }; }
+        final_awaiter       final_suspend()   const noexcept { return { }; }
+
+        void return_void() const noexcept { }
+        void unhandled_exception() const noexcept { std::terminate(); }
+
+        completion* signal = nullptr;
+    };
+
+    explicit sync_wait_driver(std::coroutine_handle<promise_type> h) noexcept : coroutine_(h) { }
+    sync_wait_driver(const sync_wait_driver&) = delete;
+    sync_wait_driver& operator=(const sync_wait_driver&) = delete;
+    ~sync_wait_driver() { coroutine_.destroy(); }
+
+    void run(completion& signal)
+    {
+        coroutine_.promise().signal = &signal;
+        coroutine_.resume();
+    }
+
+private:
+    std::coroutine_handle<promise_type> coroutine_;
+};
+
+template<typename T>
+sync_wait_driver make_sync_wait_driver_(task<T>& t, coro_result<T>& result)
+{
+    try
+    {
+        if constexpr(std::is_void_v<T>)
+        {
+            co_await std::move(t);
+            result.return_void();
+        }
+        else
+        {
+            result.return_value(co_await std::move(t));
+        }
+    }
+    catch(...)
+    {
+        result.unhandled_exception();
+    }
+}
+
+} // namespace detail
+
+/**
+ * \brief Runs t to completion and returns its result or rethrows its exception. While t is suspended the calling
+ *        thread runs tasks from pool, so it is safe to call from one of pool's workers.
+ */
+template<typename T>
+T sync_wait(task<T> t, thread_pool& pool = default_thread_pool())
+{
+    detail::coro_result<T> result;
+    detail::completion     signal(1);
+
+    detail::sync_wait_driver driver = detail::make_sync_wait_driver_(t, result);
+    driver.run(signal);
+    pool.wait(signal);
+
+    if constexpr(std::is_reference_v<T>) return result.get();
+    else                                return std::move(result).get();
+}
+
+// when_all ============================================================================================================
+
+namespace detail
+{
+
+/// Counts the children still running plus one for the starting awaiter; whoever brings it to zero resumes awaiting
+struct when_all_latch
+{
+    explicit when_all_latch(std::size_t children) noexcept : count(children + 1) { }
+
+    std::atomic<std::size_t> count;
+    std::coroutine_handle<>  awaiting;
+};
+
+template<typename T>
+class when_all_child
+{
+public:
+    struct promise_type : coro_promise_base, coro_result<T>
+    {
+        struct final_awaiter
+        {
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+            {
+                when_all_latch& latch = *h.promise().latch;
+                if(latch.count.fetch_sub(1, std::memory_order_acq_rel) == 1) return latch.awaiting;
+                return std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept { }
+        };
+
+        when_all_child get_return_object() noexcept
+        {
+            return when_all_child(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() const noexcept { return { }; }
+        final_awaiter       final_suspend()   const noexcept { return { }; }
+
+        when_all_latch* latch = nullptr;
+    };
+
+    explicit when_all_child(std::coroutine_handle<promise_type> h) noexcept : coroutine_(h) { }
+    when_all_child(when_all_child&& other) noexcept : coroutine_(std::exchange(other.coroutine_, nullptr)) { }
+    when_all_child& operator=(when_all_child&&) = delete;
+    ~when_all_child() { if(coroutine_) coroutine_.destroy(); }
+
+    void start(when_all_latch& latch) noexcept
+    {
+        coroutine_.promise().latch = &latch;
+        coroutine_.resume();
+    }
+
+    decltype(auto) result()
+    {
+        if constexpr(std::is_void_v<T>)
+        {
+            coroutine_.promise().get();
+            return std::monostate{ };
+        }
+        else if constexpr(std::is_reference_v<T>)
+        {
+            return coroutine_.promise().get();
+        }
+        else
+        {
+            return std::move(coroutine_.promise()).get();
+        }
+    }
+
+private:
+    std::coroutine_handle<promise_type> coroutine_;
+};
+
+template<typename T>
+when_all_child<T> make_when_all_child_(task<T> t)
+{
+    co_return co_await std::move(t);
+}
+
+template<typename Start>
+struct when_all_awaiter
+{
+    bool await_ready() const noexcept { return latch.count.load(std::memory_order_relaxed) == 1; }
+
+    bool await_suspend(std::coroutine_handle<> h) noexcept
+    {
+        latch.awaiting = h;
+        start(latch);
+        return latch.count.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+
+    void await_resume() const noexcept { }
+
+    when_all_latch latch;
+    Start          start;
+};
+
+template<typename Start>
+when_all_awaiter<Start> when_all_start_(std::size_t children, Start start)
+{
+    return { when_all_latch(children), std::move(start) };
+}
+
+template<typename T>
+using when_all_value_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+} // namespace detail
+
+/**
+ * \brief Starts every task on the awaiting thread, one after the other, and completes once all of them have finished.
+ *
+ * Tasks that begin with co_await schedule_on(pool) therefore run concurrently. The awaiting coroutine resumes on the
+ * thread that finished last. Results come back in argument order, std::monostate standing in for void; if any task
+ * threw, the first such exception in argument order is rethrown after all have finished.
+ */
+template<typename... Ts>
+task<std::tuple<detail::when_all_value_t<Ts>...>> when_all(task<Ts>... tasks)
+{
+    std::tuple<detail::when_all_child<Ts>...> children(detail::make_when_all_child_(std::move(tasks))...);
+
+    co_await detail::when_all_start_(sizeof...(Ts), [&children](detail::when_all_latch& latch)
+    {
+        std::apply([&latch](auto&... child) { (child.start(latch), ...); }, children);
+    });
+
+    co_return std::apply([](auto&... child)
+    {
+        return std::tuple<detail::when_all_value_t<Ts>...>{ child.result()... };
+    }, children);
+}
+
+/**
+ * \brief when_all for a run-time number of tasks of one type, returning their results in order
+ */
+template<typename T>
+auto when_all(std::vector<task<T>> tasks)
+    -> task<std::conditional_t<std::is_void_v<T>, void, std::vector<detail::when_all_value_t<T>>>>
+{
+    std::vector<detail::when_all_child<T>> children;
+    children.reserve(tasks.size());
+    for(task<T>& t : tasks) children.push_back(detail::make_when_all_child_(std::move(t)));
+
+    co_await detail::when_all_start_(children.size(), [&children](detail::when_all_latch& latch)
+    {
+        for(detail::when_all_child<T>& child : children) child.start(latch);
+    });
+
+    if constexpr(std::is_void_v<T>)
+    {
+        for(detail::when_all_child<T>& child : children) child.result();
+    }
+    else
+    {
+        std::vector<T> results;
+        results.reserve(children.size());
+        for(detail::when_all_child<T>& child : children) results.push_back(child.result());
+        co_return results;
+    }
+}
+
+// generator ===========================================================================================================
+
+/**
+ * \brief Lazily evaluated input range of the values a coroutine co_yields, e.g. the tokens of a streaming parser.
+ *
+ * Each increment resumes the coroutine until its next co_yield, and dereferencing refers to the yielded object
+ * itself, which stays alive until the next increment, so nothing is copied. A generator runs entirely on the thread
+ * that iterates it and cannot co_await. An exception thrown by the coroutine is rethrown from begin() or ++.
+ *
+ * \tparam T Yielded type; a reference type yields references to the caller's objects
+ */
+template<typename T>
+class [[nodiscard]] generator
+{
+// Typedefs ============================================================================================================
+
+public:
+    using value_type = std::remove_cvref_t<T>;
+    using reference  = std::conditional_t<std::is_reference_v<T>, T, T&>;
+    using pointer    = std::add_pointer_t<reference>;
+
+    struct promise_type : detail::coro_promise_base
+    {
+        generator get_return_object() noexcept
+        {
+            return generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() const noexcept { return { }; }
+        std::suspend_always final_suspend()   const noexcept { return { }; }
+
+        std::suspend_always yield_value(std::remove_reference_t<reference>& value) noexcept
+        {
+            current = std::addressof(value);
+            return { };
+        }
+
+        std::suspend_always yield_value(std::remove_reference_t<reference>&& value) noexcept
+        {
+            current = std::addressof(value);
+            return { };
+        }
+
+        template<typename U>
+        std::suspend_never await_transform(U&&) = delete;
+
+        void return_void() const noexcept { }
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+
+        pointer            current = nullptr;
+        std::exception_ptr error;
+    };
+
+private:
+    using handle = std::coroutine_handle<promise_type>;
+
+public:
+    class iterator
+    {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type       = generator::value_type;
+        using difference_type  = std::ptrdiff_t;
+
+        iterator() noexcept = default;
+        explicit iterator(handle h) noexcept : coroutine_(h) { }
+
+        reference operator*() const noexcept { return static_cast<reference>(*coroutine_.promise().current); }
+        pointer operator->() const noexcept { return coroutine_.promise().current; }
+
+        iterator& operator++()
+        {
+            coroutine_.resume();
+            rethrow_(coroutine_);
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept
+        {
+            return !it.coroutine_ || it.coroutine_.done();
+        }
+
+    private:
+        handle coroutine_;
+    };
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    generator() noexcept = default;
+    explicit generator(handle h) noexcept : coroutine_(h) { }
+
+    generator(generator&& other) noexcept : coroutine_(std::exchange(other.coroutine_, nullptr)) { }
+
+    generator& operator=(generator&& other) noexcept
+    {
+        if(this != &other)
+        {
+            if(coroutine_) coroutine_.destroy();
+            coroutine_ = std::exchange(other.coroutine_, nullptr);
+        }
+        return *this;
+    }
+
+    ~generator() { if(coroutine_) coroutine_.destroy(); }
+
+// Iteration -----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Runs the coroutine to its first co_yield. Call once; a generator is a single-pass range.
+     */
+    iterator begin()
+    {
+        if(!coroutine_) return iterator();
+        coroutine_.resume();
+        rethrow_(coroutine_);
+        return iterator(coroutine_);
+    }
+
+    [[nodiscard]] std::default_sentinel_t end() const noexcept { return { }; }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    static void rethrow_(handle h)
+    {
+        if(h.done() && h.promise().error) std::rethrow_exception(std::exchange(h.promise().error, nullptr));
+    }
+
+// Variables ===========================================================================================================
+
+    handle coroutine_;
+};
+
+// File I/O ============================================================================================================
+
+namespace detail
+{
+
+class file_awaiter
+{
+public:
+    file_awaiter(async_file& file, std::uint64_t offset, std::byte* data, std::size_t size, bool write) noexcept
+        : file_(file), data_(data), offset_(offset), size_(size), write_(write) { }
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        // The operation may complete and resume h, which destroys this awaiter, before submit returns
+        io_queue* const queue = file_.queue();
+        auto on_complete = [this, h](std::error_code ec, std::size_t n)
+        {
+            error_       = ec;
+            transferred_ = n;
+            h.resume();
+        };
+
+        if(write_) file_.write(offset_, std::span<const std::byte>(data_, size_), std::move(on_complete));
+        else       file_.read(offset_, std::span<std::byte>(data_, size_), std::move(on_complete));
+
+        // Once queued the operation always completes through on_complete, which reports its outcome in error_. A
+        // failed submit leaves it queued for the next submit or drain, so throwing here would resume h twice.
+        try
+        {
+            queue->submit();
+        }
+        catch(...)
+        {
+        }
+    }
+
+    std::size_t await_resume() const
+    {
+        if(error_) throw std::system_error(error_, write_ ? "async_file: write failed" : "async_file: read failed");
+        return transferred_;
+    }
+
+private:
+    async_file&     file_;
+    std::byte*      data_;
+    std::uint64_t   offset_;
+    std::size_t     size_;
+    std::size_t     transferred_ = 0;
+    std::error_code error_;
+    bool            write_;
+};
+
+} // namespace detail
+
+/**
+ * \brief co_await async_read(file, offset, buffer) reads into buffer and resumes with the number of bytes read.
+ *
+ * The read is submitted to the file's io_queue right away, and the coroutine resumes on the queue's thread pool.
+ * \throws std::system_error from the co_await if the read fails
+ */
+[[nodiscard]] inline detail::file_awaiter async_read(async_file& file, std::uint64_t offset,
+                                                     std::span<std::byte> buffer) noexcept
+{
+    return { file, offset, buffer.data(), buffer.size(), false };
+}
+
+/**
+ * \brief co_await async_write(file, offset, buffer) writes buffer and resumes with the number of bytes written
+ * \throws std::system_error from the co_await if the write fails
+ */
+[[nodiscard]] inline detail::file_awaiter async_write(async_file& file, std::uint64_t offset,
+                                                      std::span<const std::byte> buffer) noexcept
+{
+    return { file, offset, const_cast<std::byte*>(buffer.data()), buffer.size(), true };
+}
+
+// Timers ==============================================================================================================
+
+namespace detail
+{
+
+template<typename T>
+struct sleep_awaiter
+{
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) { wheel.schedule_at(deadline, h); }
+    void await_resume() const noexcept { }
+
+    timer_wheel<T>&                    wheel;
+    typename timer_wheel<T>::tick_type deadline;
+};
+
+} // namespace detail
+
+/**
+ * \brief co_await sleep_until(wheel, deadline) resumes the coroutine when the wheel fires at deadline.
+ *
+ * The coroutine handle becomes the timer's payload, so the wheel's payload must be constructible from one, as
+ * std::function<void()> and std::coroutine_handle<> are. A wheel is owned by one thread: await only while running on
+ * that thread, and the coroutine resumes from inside advance_to, or on a worker when advance_to posts to a pool.
+ */
+template<typename T> requires std::constructible_from<T, std::coroutine_handle<>>
+[[nodiscard]] detail::sleep_awaiter<T> sleep_until(timer_wheel<T>& wheel,
+                                                   typename timer_wheel<T>::tick_type deadline) noexcept
+{
+    return { wheel, deadline };
+}
+
+/**
+ * \brief co_await sleep_for(wheel, delay) resumes the coroutine delay ticks from now
+ */
+template<typename T> requires std::constructible_from<T, std::coroutine_handle<>>
+[[nodiscard]] detail::sleep_awaiter<T> sleep_for(timer_wheel<T>& wheel,
+                                                 typename timer_wheel<T>::tick_type delay) noexcept
+{
+    return { wheel, wheel.now() + delay };
+}
+
+} // namespace open_cpp_utils
+
+#endif // OPEN_CPP_UTILS_CORO_H
@@ -0,0 +1,178 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_CPU_FEATURES_H
+#define OPEN_CPP_UTILS_CPU_FEATURES_H
+
+#include "config.h"
+
+#include <cstdint>
+
+#if defined(OCU_ARCH_X86)
+#   if defined(_MSC_VER) && !defined(__clang__)
+#       include <intrin.h>
+#   else
+#       include <cpuid.h>
+#   endif
+#endif
+
+// Macros ==============================================================================================================
+
+/**
+ * \brief Function attributes that let GCC and Clang emit SSE4.2 or AVX2 code for one function without the whole
+ *        translation unit being built with -msse4.2 / -mavx2. MSVC accepts every intrinsic without flags, so they
+ *        expand to nothing there. A function carrying one may only be called once host_cpu() reports the feature.
+ *
+ * Helpers called from such a function need the same attribute to be inlined into it; lambdas do not inherit it.
+ */
+#if defined(OCU_ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#   define OCU_TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#   define OCU_TARGET_AVX2  __attribute__((target("avx2,bmi,bmi2,popcnt")))
+#else
+#   define OCU_TARGET_SSE42
+#   define OCU_TARGET_AVX2
+#endif
+
+namespace open_cpp_utils
+{
+
+// Typedefs ============================================================================================================
+
+/**
+ * \brief Instruction set levels that runtime-dispatched kernels are built for, in increasing order on x86. Each x86
+ *        level implies the ones below it; neon is the only level above scalar on ARM.
+ */
+enum class simd_level : std::uint8_t
+{
+    scalar,
+    sse42,
+    avx2,
+    neon,
+};
+
+/**
+ * \brief What the processor running this program supports. Read once with cpuid/xgetbv on x86; on ARM everything
+ *        is known at compile time. AVX features are only reported when the OS also saves the YMM state.
+ */
+struct cpu_features
+{
+    bool sse2    = false;
+    bool ssse3   = false;
+    bool sse41   = false;
+    bool sse42   = false;
+    bool popcnt  = false;
+    bool avx     = false;
+    bool avx2    = false;
+    bool bmi1    = false;
+    bool bmi2    = false;
+    bool avx512f = false;
+    bool neon    = false;
+
+    /// Best simd_level whose kernels can run here
+    [[nodiscard]] constexpr simd_level best_level() const noexcept
+    {
+        if(neon)                     return simd_level::neon;
+        if(avx2 && bmi1 && bmi2)     return simd_level::avx2;
+        if(sse42 && ssse3 && popcnt) return simd_level::sse42;
+        return simd_level::scalar;
+    }
+};
+
+// Functions ===========================================================================================================
+
+namespace detail
+{
+
+#if defined(OCU_ARCH_X86)
+
+struct cpuid_regs
+{
+    std::uint32_t eax, ebx, ecx, edx;
+};
+
+inline cpuid_regs cpuid_(std::uint32_t leaf, std::uint32_t subleaf) noexcept
+{
+    cpuid_regs r{ };
+#if defined(_MSC_VER) && !defined(__clang__)
+    int v[4];
+    __cpuidex(v, static_cast<int>(leaf), static_cast<int>(subleaf));
+    r = { static_cast<std::uint32_t>(v[0]), static_cast<std::uint32_t>(v[1]),
+          static_cast<std::uint32_t>(v[2]), static_cast<std::uint32_t>(v[3]) };
+#else
+    __cpuid_count(leaf, subleaf, r.eax, r.ebx, r.ecx, r.edx);
+#endif
+    return r;
+}
+
+/// XCR0, the register state the OS saves on context switch. Only valid when cpuid reports OSXSAVE.
+inline std::uint64_t xgetbv_() noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _xgetbv(0);
+#else
+    std::uint32_t lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<std::uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+#endif
+
+inline cpu_features detect_cpu_features_() noexcept
+{
+    cpu_features f;
+#if defined(OCU_ARCH_X86)
+    const std::uint32_t max_leaf = cpuid_(0, 0).eax;
+    if(max_leaf < 1) return f;
+
+    const cpuid_regs l1 = cpuid_(1, 0);
+    f.sse2   = (l1.edx >> 26) & 1;
+    f.ssse3  = (l1.ecx >>  9) & 1;
+    f.sse41  = (l1.ecx >> 19) & 1;
+    f.sse42  = (l1.ecx >> 20) & 1;
+    f.popcnt = (l1.ecx >> 23) & 1;
+
+    const bool          osxsave = (l1.ecx >> 27) & 1;
+    const std::uint64_t xcr0    = osxsave ? xgetbv_() : 0;
+    const bool          ymm     = (xcr0 & 0x06) == 0x06;
+    const bool          zmm     = (xcr0 & 0xE6) == 0xE6;
+    f.avx = ymm && ((l1.ecx >> 28) & 1);
+
+    if(max_leaf >= 7)
+    {
+        const cpuid_regs l7 = cpuid_(7, 0);
+        f.avx2    = f.avx && ((l7.ebx >> 5) & 1);
+        f.bmi1    = (l7.ebx >>  3) & 1;
+        f.bmi2    = (l7.ebx >>  8) & 1;
+        f.avx512f = zmm && ((l7.ebx >> 16) & 1);
+    }
+#elif defined(OCU_HAS_NEON)
+    f.neon = true;
+#endif
+    return f;
+}
+
+}
+
+/**
+ * \brief Features of the host processor, detected on first call and cached. Thread-safe.
+ */
+[[nodiscard]] inline const cpu_features& host_cpu() noexcept
+{
+    static const cpu_features features = detail::detect_cpu_features_();
+    return features;
+}
+
+/**
+ * \brief simd_level that runtime-dispatched kernels use on this host.
+ */
+[[nodiscard]] inline simd_level host_simd_level() noexcept
+{
+    return host_cpu().best_level();
+}
+
+}
+
+#endif // OPEN_CPP_UTILS_CPU_FEATURES_H
@@ -0,0 +1,859 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_DIRECTED_TREE_H
+#define OPEN_CPP_UTILS_DIRECTED_TREE_H
+
+#include "config.h"
+#include "bitset.h"
+#include "template_utils.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace open_cpp_utils
+{
+
+/**
+ * \brief Index of a node in a directed_tree. The default value refers to no node.
+ */
+class tree_node
+{
+public:
+    using value_type = std::uint32_t;
+
+    static constexpr value_type npos = static_cast<value_type>(-1);
+
+    constexpr tree_node() noexcept = default;
+    constexpr explicit tree_node(value_type index) noexcept : index_(index) { }
+
+    [[nodiscard]] constexpr value_type index() const noexcept { return index_; }
+
+    constexpr explicit operator bool() const noexcept { return index_ != npos; }
+
+    friend constexpr bool operator==(tree_node, tree_node) noexcept = default;
+    friend constexpr auto operator<=>(tree_node, tree_node) noexcept = default;
+
+private:
+    value_type index_ = npos;
+};
+
+/**
+ * \brief Rooted ordered tree stored as parallel arrays indexed by node.
+ *
+ * Structure lives in separate arrays (parent, first/last child, next/previous sibling, depth) so a traversal only
+ * touches the links it follows, and values live in one contiguous buffer. Erased nodes go on an intrusive free list
+ * threaded through next_sibling and are reused by later inserts, the same way object_pool reuses slots. Traversals
+ * walk the links directly; pre- and post-order need no stack or queue.
+ *
+ * After many inserts and erases, siblings end up scattered across the arrays. compact() renumbers every node in
+ * pre-order so a depth-first walk visits indices 0, 1, 2, ... and becomes a linear scan over every array. It
+ * invalidates all tree_node values and returns the old-to-new mapping so external references can be fixed up.
+ *
+ * tree_node values are plain indices: a node handle stays valid until that node is erased or compact() runs, and
+ * using an erased handle is caught by OCU_ASSERT in debug builds only.
+ *
+ * \tparam T Value stored at each node
+ */
+template<typename T>
+class directed_tree
+{
+// Typedefs ============================================================================================================
+
+public:
+    using value_type      = T;
+    using size_type       = std::size_t;
+    using reference       = T&;
+    using const_reference = const T&;
+    using node            = tree_node;
+
+private:
+    using index_type = tree_node::value_type;
+
+    static constexpr index_type npos = tree_node::npos;
+
+    /// Marks a free slot in depth_
+    static constexpr index_type dead = npos;
+
+    static constexpr bool relocate_bitwise = is_trivially_relocatable_v<T>;
+
+public:
+    class preorder_iterator;
+    class postorder_iterator;
+    class breadth_first_iterator;
+    class child_iterator;
+
+    template<typename Iterator>
+    class range
+    {
+    public:
+        range(Iterator first, Iterator last) : first_(std::move(first)), last_(std::move(last)) { }
+
+        Iterator begin() const { return first_; }
+        Iterator end()   const { return last_; }
+
+    private:
+        Iterator first_, last_;
+    };
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    directed_tree() noexcept = default;
+
+    directed_tree(const directed_tree& other)
+        : parent_(other.parent_), first_child_(other.first_child_), last_child_(other.last_child_)
+        , next_sibling_(other.next_sibling_), prev_sibling_(other.prev_sibling_), depth_(other.depth_)
+        , root_(other.root_), free_(other.free_), size_(other.size_)
+    {
+        if(other.slots_() == 0) return;
+
+        storage_type values(other.slots_());
+        index_type built = 0;
+        try
+        {
+            for(; built < other.slots_(); ++built)
+            {
+                if(other.depth_[built] == dead) continue;
+                ::new(static_cast<void*>(values.at(built))) T(other.values_.ref(built));
+            }
+        }
+        catch(...)
+        {
+            for(index_type i = 0; i < built; ++i)
+            {
+                if(other.depth_[i] != dead) std::destroy_at(values.at(i));
+            }
+            throw;
+        }
+        values_ = std::move(values);
+    }
+
+    directed_tree(directed_tree&& other) noexcept
+    {
+        swap(other);
+    }
+
+    ~directed_tree()
+    {
+        destroy_values_();
+    }
+
+    directed_tree& operator=(const directed_tree& other)
+    {
+        if(this != &other) directed_tree(other).swap(*this);
+        return *this;
+    }
+
+    directed_tree& operator=(directed_tree&& other) noexcept
+    {
+        if(this != &other)
+        {
+            directed_tree tmp(std::move(other));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    void swap(directed_tree& other) noexcept
+    {
+        using std::swap;
+        swap(parent_, other.parent_);
+        swap(first_child_, other.first_child_);
+        swap(last_child_, other.last_child_);
+        swap(next_sibling_, other.next_sibling_);
+        swap(prev_sibling_, other.prev_sibling_);
+        swap(depth_, other.depth_);
+        swap(values_, other.values_);
+        swap(root_, other.root_);
+        swap(free_, other.free_);
+        swap(size_, other.size_);
+    }
+
+    friend void swap(directed_tree& a, directed_tree& b) noexcept { a.swap(b); }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Creates the root node. The tree must be empty.
+     */
+    template<typename...Args>
+    node emplace_root(Args&&...args)
+    {
+        OCU_ASSERT(empty(), "directed_tree::emplace_root on a non-empty tree");
+        const index_type n = allocate_(std::forward<Args>(args)...);
+        depth_[n] = 0;
+        root_     = n;
+        return node(n);
+    }
+
+    /**
+     * \brief Appends a new last child to parent
+     */
+    template<typename...Args>
+    node emplace_child(node parent, Args&&...args)
+    {
+        OCU_ASSERT(contains(parent), "directed_tree::emplace_child with an invalid parent");
+        const index_type n = allocate_(std::forward<Args>(args)...);
+        link_last_(n, parent.index());
+        depth_[n] = depth_[parent.index()] + 1;
+        return node(n);
+    }
+
+    /**
+     * \brief Inserts a new node as the immediately preceding sibling of sibling, which must not be the root
+     */
+    template<typename...Args>
+    node emplace_before(node sibling, Args&&...args)
+    {
+        OCU_ASSERT(contains(sibling) && sibling.index() != root_, "directed_tree::emplace_before on the root");
+        const index_type n = allocate_(std::forward<Args>(args)...);
+        link_before_(n, sibling.index());
+        depth_[n] = depth_[sibling.index()];
+        return node(n);
+    }
+
+    /**
+     * \brief Destroys n and every descendant of n
+     * \return Number of nodes erased
+     */
+    size_type erase(node n) noexcept
+    {
+        OCU_ASSERT(contains(n), "directed_tree::erase with an invalid node");
+        const index_type top = n.index();
+        unlink_(top);
+
+        size_type erased = 0;
+        index_type cur = leftmost_leaf_(top);
+        for(;;)
+        {
+            const index_type next = cur == top ? npos
+                                  : next_sibling_[cur] != npos ? leftmost_leaf_(next_sibling_[cur])
+                                  : parent_[cur];
+            release_(cur);
+            ++erased;
+            if(next == npos) break;
+            cur = next;
+        }
+
+        if(top == root_) root_ = npos;
+        return erased;
+    }
+
+    /**
+     * \brief Detaches n with its subtree and appends it as the last child of new_parent, which must not be inside the
+     *        subtree of n
+     */
+    void reparent(node n, node new_parent) noexcept
+    {
+        OCU_ASSERT(contains(n) && contains(new_parent), "directed_tree::reparent with an invalid node");
+        OCU_ASSERT(!is_ancestor_of(n, new_parent) && n != new_parent, "directed_tree::reparent would create a cycle");
+        OCU_ASSERT(n.index() != root_, "directed_tree::reparent cannot move the root");
+
+        unlink_(n.index());
+        link_last_(n.index(), new_parent.index());
+
+        const index_type base = depth_[new_parent.index()] + 1;
+        const index_type old  = depth_[n.index()];
+        if(base == old) return;
+        for(node d : preorder(n)) depth_[d.index()] = depth_[d.index()] - old + base;
+    }
+
+    void clear() noexcept
+    {
+        destroy_values_();
+        parent_.clear();
+        first_child_.clear();
+        last_child_.clear();
+        next_sibling_.clear();
+        prev_sibling_.clear();
+        depth_.clear();
+        root_ = npos;
+        free_ = npos;
+        size_ = 0;
+    }
+
+    void reserve(size_type n)
+    {
+        if(n <= values_.capacity()) return;
+        if(n > max_size()) throw std::length_error("directed_tree too large");
+
+        parent_.reserve(n);
+        first_child_.reserve(n);
+        last_child_.reserve(n);
+        next_sibling_.reserve(n);
+        prev_sibling_.reserve(n);
+        depth_.reserve(n);
+        rebuild_values_(static_cast<index_type>(n), [this](index_type i) { return depth_[i] == dead ? npos : i; },
+                        slots_());
+    }
+
+    /**
+     * \brief Renumbers every node in pre-order and drops the free list. Capacity is kept, so nodes added afterwards
+     *        fill the freed slots without reallocating.
+     * \return For every old index, the node's new handle (null for indices that were free)
+     */
+    std::vector<node> compact()
+    {
+        std::vector<node>       remap(slots_());
+        std::vector<index_type> order;
+        order.reserve(size_);
+        if(root_ != npos)
+        {
+            for(node n : preorder())
+            {
+                remap[n.index()] = node(static_cast<index_type>(order.size()));
+                order.push_back(n.index());
+            }
+        }
+
+        auto map = [&](index_type i) { return i == npos ? npos : remap[i].index(); };
+
+        // allocate_ relies on the link arrays having at least the capacity of values_
+        const size_type         capacity = std::max<size_type>(values_.capacity(), order.size());
+        std::vector<index_type> parent, first, last, next, prev, depth;
+        for(std::vector<index_type>* links : { &parent, &first, &last, &next, &prev, &depth })
+        {
+            links->reserve(capacity);
+            links->resize(order.size());
+        }
+        for(index_type k = 0; k < order.size(); ++k)
+        {
+            const index_type i = order[k];
+            parent[k] = map(parent_[i]);
+            first[k]  = map(first_child_[i]);
+            last[k]   = map(last_child_[i]);
+            next[k]   = map(next_sibling_[i]);
+            prev[k]   = map(prev_sibling_[i]);
+            depth[k]  = depth_[i];
+        }
+
+        rebuild_values_(static_cast<index_type>(capacity),
+                        [&](index_type k) { return k < order.size() ? order[k] : npos; },
+                        static_cast<index_type>(order.size()));
+
+        parent_       = std::move(parent);
+        first_child_  = std::move(first);
+        last_child_   = std::move(last);
+        next_sibling_ = std::move(next);
+        prev_sibling_ = std::move(prev);
+        depth_        = std::move(depth);
+        root_         = order.empty() ? npos : 0;
+        free_         = npos;
+        return remap;
+    }
+
+// Element Access ------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] reference operator[](node n) noexcept
+    {
+        OCU_ASSERT(contains(n), "directed_tree::operator[] with an invalid node");
+        return values_.ref(n.index());
+    }
+
+    [[nodiscard]] const_reference operator[](node n) const noexcept
+    {
+        OCU_ASSERT(contains(n), "directed_tree::operator[] with an invalid node");
+        return values_.ref(n.index());
+    }
+
+    [[nodiscard]] reference at(node n)
+    {
+        if(!contains(n)) throw std::out_of_range("directed_tree::at");
+        return values_.ref(n.index());
+    }
+
+    [[nodiscard]] const_reference at(node n) const
+    {
+        if(!contains(n)) throw std::out_of_range("directed_tree::at");
+        return values_.ref(n.index());
+    }
+
+// Structure -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] node root() const noexcept { return node(root_); }
+
+    [[nodiscard]] node parent(node n)       const noexcept { return link_(parent_, n); }
+    [[nodiscard]] node first_child(node n)  const noexcept { return link_(first_child_, n); }
+    [[nodiscard]] node last_child(node n)   const noexcept { return link_(last_child_, n); }
+    [[nodiscard]] node next_sibling(node n) const noexcept { return link_(next_sibling_, n); }
+    [[nodiscard]] node prev_sibling(node n) const noexcept { return link_(prev_sibling_, n); }
+
+    /// Distance from the root; the root has depth 0
+    [[nodiscard]] std::uint32_t depth(node n) const noexcept
+    {
+        OCU_ASSERT(contains(n), "directed_tree::depth with an invalid node");
+        return depth_[n.index()];
+    }
+
+    [[nodiscard]] bool is_leaf(node n) const noexcept { return !first_child(n); }
+
+    /// True if a is a proper ancestor of d
+    [[nodiscard]] bool is_ancestor_of(node a, node d) const noexcept
+    {
+        OCU_ASSERT(contains(a) && contains(d), "directed_tree::is_ancestor_of with an invalid node");
+        const index_type target = depth_[a.index()];
+        index_type cur = d.index();
+        while(depth_[cur] > target) cur = parent_[cur];
+        return cur == a.index() && d != a;
+    }
+
+    /// True if n refers to a live node of this tree
+    [[nodiscard]] bool contains(node n) const noexcept
+    {
+        return n.index() < slots_() && depth_[n.index()] != dead;
+    }
+
+// Capacity ------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] size_type size()     const noexcept { return size_; }
+    [[nodiscard]] bool      empty()    const noexcept { return size_ == 0; }
+    [[nodiscard]] size_type capacity() const noexcept { return values_.capacity(); }
+
+    [[nodiscard]] static constexpr size_type max_size() noexcept { return npos - 1; }
+
+// Traversal -----------------------------------------------------------------------------------------------------------
+
+    /// Visits from and its descendants, every node before its children and children in order
+    [[nodiscard]] range<preorder_iterator> preorder(node from) const noexcept
+    {
+        return { preorder_iterator(this, from.index(), from.index()), preorder_iterator(this, from.index(), npos) };
+    }
+
+    [[nodiscard]] range<preorder_iterator> preorder() const noexcept { return preorder(root()); }
+
+    /// Visits from and its descendants, every node after its children
+    [[nodiscard]] range<postorder_iterator> postorder(node from) const noexcept
+    {
+        const index_type first = from ? leftmost_leaf_(from.index()) : npos;
+        return { postorder_iterator(this, from.index(), first), postorder_iterator(this, from.index(), npos) };
+    }
+
+    [[nodiscard]] range<postorder_iterator> postorder() const noexcept { return postorder(root()); }
+
+    /// Visits from and its descendants level by level. The iterator owns its frontier, so copies are not free.
+    [[nodiscard]] range<breadth_first_iterator> breadth_first(node from) const
+    {
+        return { breadth_first_iterator(this, from.index()), breadth_first_iterator() };
+    }
+
+    [[nodiscard]] range<breadth_first_iterator> breadth_first() const { return breadth_first(root()); }
+
+    /// Visits the direct children of n in order
+    [[nodiscard]] range<child_iterator> children(node n) const noexcept
+    {
+        return { child_iterator(this, first_child(n).index()), child_iterator(this, npos) };
+    }
+
+// Masks ---------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief One bit per slot, set for live nodes. Bit i is node(i), so masks built from a tree combine with its
+     *        other masks and with per-node flags kept in a dynamic_bitset, and for_each_set_bit visits the result.
+     */
+    [[nodiscard]] dynamic_bitset node_mask() const
+    {
+        dynamic_bitset mask(slots_());
+        for(index_type i = 0; i < slots_(); ++i)
+        {
+            if(depth_[i] != dead) mask.set(i);
+        }
+        return mask;
+    }
+
+    /// One bit per slot, set for from and its descendants
+    [[nodiscard]] dynamic_bitset subtree_mask(node from) const
+    {
+        dynamic_bitset mask(slots_());
+        for(node n : preorder(from)) mask.set(n.index());
+        return mask;
+    }
+
+// Iterators ===========================================================================================================
+
+    class preorder_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = node;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const node*;
+        using reference         = node;
+
+        preorder_iterator() = default;
+
+        node operator*() const noexcept { return node(cur_); }
+
+        preorder_iterator& operator++() noexcept
+        {
+            const directed_tree& t = *tree_;
+            if(t.first_child_[cur_] != npos) { cur_ = t.first_child_[cur_]; return *this; }
+
+            while(cur_ != top_)
+            {
+                if(t.next_sibling_[cur_] != npos) { cur_ = t.next_sibling_[cur_]; return *this; }
+                cur_ = t.parent_[cur_];
+            }
+            cur_ = npos;
+            return *this;
+        }
+
+        preorder_iterator operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+
+        friend bool operator==(const preorder_iterator& a, const preorder_iterator& b) noexcept
+        {
+            return a.cur_ == b.cur_;
+        }
+
+    private:
+        friend class directed_tree;
+        preorder_iterator(const directed_tree* t, index_type top, index_type cur) : tree_(t), top_(top), cur_(cur) { }
+
+        const directed_tree* tree_ = nullptr;
+        index_type           top_  = npos;
+        index_type           cur_  = npos;
+    };
+
+    class postorder_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = node;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const node*;
+        using reference         = node;
+
+        postorder_iterator() = default;
+
+        node operator*() const noexcept { return node(cur_); }
+
+        postorder_iterator& operator++() noexcept
+        {
+            const directed_tree& t = *tree_;
+            if(cur_ == top_)                          cur_ = npos;
+            else if(t.next_sibling_[cur_] != npos)    cur_ = t.leftmost_leaf_(t.next_sibling_[cur_]);
+            else                                      cur_ = t.parent_[cur_];
+            return *this;
+        }
+
+        postorder_iterator operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+
+        friend bool operator==(const postorder_iterator& a, const postorder_iterator& b) noexcept
+        {
+            return a.cur_ == b.cur_;
+        }
+
+    private:
+        friend class directed_tree;
+        postorder_iterator(const directed_tree* t, index_type top, index_type cur) : tree_(t), top_(top), cur_(cur) { }
+
+        const directed_tree* tree_ = nullptr;
+        index_type           top_  = npos;
+        index_type           cur_  = npos;
+    };
+
+    class breadth_first_iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = node;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const node*;
+        using reference         = node;
+
+        breadth_first_iterator() = default;
+
+        node operator*() const noexcept { return node(queue_[head_]); }
+
+        breadth_first_iterator& operator++()
+        {
+            const directed_tree& t = *tree_;
+            for(index_type c = t.first_child_[queue_[head_]]; c != npos; c = t.next_sibling_[c]) queue_.push_back(c);
+            if(++head_ == queue_.size())
+            {
+                queue_.clear();
+                head_ = 0;
+            }
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const breadth_first_iterator& a, const breadth_first_iterator& b) noexcept
+        {
+            const bool a_end = a.queue_.empty(), b_end = b.queue_.empty();
+            if(a_end || b_end) return a_end == b_end;
+            return a.queue_[a.head_] == b.queue_[b.head_];
+        }
+
+    private:
+        friend class directed_tree;
+        breadth_first_iterator(const directed_tree* t, index_type from) : tree_(t)
+        {
+            if(from != npos) queue_.push_back(from);
+        }
+
+        const directed_tree*    tree_ = nullptr;
+        std::vector<index_type> queue_;
+        std::size_t             head_ = 0;
+    };
+
+    class child_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = node;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const node*;
+        using reference         = node;
+
+        child_iterator() = default;
+
+        node operator*() const noexcept { return node(cur_); }
+
+        child_iterator& operator++() noexcept { cur_ = tree_->next_sibling_[cur_]; return *this; }
+        child_iterator  operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+
+        friend bool operator==(const child_iterator& a, const child_iterator& b) noexcept { return a.cur_ == b.cur_; }
+
+    private:
+        friend class directed_tree;
+        child_iterator(const directed_tree* t, index_type cur) : tree_(t), cur_(cur) { }
+
+        const directed_tree* tree_ = nullptr;
+        index_type           cur_  = npos;
+    };
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    /**
+     * \brief Uninitialized buffer of T; which slots hold a live value is tracked by the owning tree
+     */
+    class storage_type
+    {
+    public:
+        storage_type() noexcept = default;
+        explicit storage_type(index_type capacity)
+            : data_(std::allocator<T>{ }.allocate(capacity)), capacity_(capacity)
+        { }
+
+        storage_type(storage_type&& other) noexcept
+            : data_(std::exchange(other.data_, nullptr)), capacity_(std::exchange(other.capacity_, 0))
+        { }
+
+        storage_type& operator=(storage_type&& other) noexcept
+        {
+            storage_type tmp(std::move(other));
+            std::swap(data_, tmp.data_);
+            std::swap(capacity_, tmp.capacity_);
+            return *this;
+        }
+
+        ~storage_type() { if(data_) std::allocator<T>{ }.deallocate(data_, capacity_); }
+
+        friend void swap(storage_type& a, storage_type& b) noexcept
+        {
+            std::swap(a.data_, b.data_);
+            std::swap(a.capacity_, b.capacity_);
+        }
+
+        T*       at(index_type i)        noexcept { return data_ + i; }
+        T&       ref(index_type i)       noexcept { return *std::launder(data_ + i); }
+        const T& ref(index_type i) const noexcept { return *std::launder(data_ + i); }
+
+        [[nodiscard]] index_type capacity() const noexcept { return capacity_; }
+
+    private:
+        T*         data_     = nullptr;
+        index_type capacity_ = 0;
+    };
+
+    index_type slots_() const noexcept { return static_cast<index_type>(depth_.size()); }
+
+    static node link_(const std::vector<index_type>& links, node n) noexcept
+    {
+        return n.index() < links.size() ? node(links[n.index()]) : node();
+    }
+
+    index_type leftmost_leaf_(index_type n) const noexcept
+    {
+        while(first_child_[n] != npos) n = first_child_[n];
+        return n;
+    }
+
+    /**
+     * \brief Moves values into a new buffer of the given capacity. old_of(k) names the slot whose value belongs at k
+     *        (npos for none), for k in [0, count). Gives the strong guarantee when T's move may throw by copying.
+     */
+    template<typename OldOf>
+    void rebuild_values_(index_type capacity, OldOf old_of, index_type count)
+    {
+        storage_type values(capacity);
+
+        if constexpr(relocate_bitwise)
+        {
+            for(index_type k = 0; k < count; ++k)
+            {
+                const index_type i = old_of(k);
+                if(i != npos) std::memcpy(static_cast<void*>(values.at(k)), values_.at(i), sizeof(T));
+            }
+        }
+        else
+        {
+            index_type built = 0;
+            try
+            {
+                for(; built < count; ++built)
+                {
+                    const index_type i = old_of(built);
+                    if(i != npos) ::new(static_cast<void*>(values.at(built))) T(std::move_if_noexcept(values_.ref(i)));
+                }
+            }
+            catch(...)
+            {
+                for(index_type k = 0; k < built; ++k)
+                {
+                    if(old_of(k) != npos) std::destroy_at(values.at(k));
+                }
+                throw;
+            }
+
+            for(index_type k = 0; k < count; ++k)
+            {
+                const index_type i = old_of(k);
+                if(i != npos) std::destroy_at(values_.at(i));
+            }
+        }
+
+        values_ = std::move(values);
+    }
+
+    template<typename...Args>
+    index_type allocate_(Args&&...args)
+    {
+        if(free_ != npos)
+        {
+            const index_type n = free_;
+            ::new(static_cast<void*>(values_.at(n))) T(std::forward<Args>(args)...);
+            free_ = next_sibling_[n];
+            reset_links_(n);
+            ++size_;
+            return n;
+        }
+
+        const index_type n = slots_();
+        if(n == values_.capacity())
+        {
+            if(n >= max_size()) throw std::length_error("directed_tree too large");
+            const index_type grown = static_cast<index_type>(std::min<size_type>(max_size(),
+                                                                                 std::max<size_type>(16, n * 2ull)));
+            reserve(grown);
+        }
+
+        ::new(static_cast<void*>(values_.at(n))) T(std::forward<Args>(args)...);
+
+        // The link arrays were reserved together with values_, so these cannot throw
+        parent_.push_back(npos);
+        first_child_.push_back(npos);
+        last_child_.push_back(npos);
+        next_sibling_.push_back(npos);
+        prev_sibling_.push_back(npos);
+        depth_.push_back(dead);
+        ++size_;
+        return n;
+    }
+
+    void release_(index_type n) noexcept
+    {
+        std::destroy_at(values_.at(n));
+        depth_[n]        = dead;
+        next_sibling_[n] = free_;
+        free_            = n;
+        --size_;
+    }
+
+    void reset_links_(index_type n) noexcept
+    {
+        parent_[n] = first_child_[n] = last_child_[n] = next_sibling_[n] = prev_sibling_[n] = npos;
+    }
+
+    void link_last_(index_type n, index_type parent) noexcept
+    {
+        parent_[n]       = parent;
+        prev_sibling_[n] = last_child_[parent];
+        next_sibling_[n] = npos;
+        if(last_child_[parent] != npos) next_sibling_[last_child_[parent]] = n;
+        else                            first_child_[parent] = n;
+        last_child_[parent] = n;
+    }
+
+    void link_before_(index_type n, index_type sibling) noexcept
+    {
+        const index_type parent = parent_[sibling];
+        parent_[n]       = parent;
+        next_sibling_[n] = sibling;
+        prev_sibling_[n] = prev_sibling_[sibling];
+        if(prev_sibling_[sibling] != npos) next_sibling_[prev_sibling_[sibling]] = n;
+        else                               first_child_[parent] = n;
+        prev_sibling_[sibling] = n;
+    }
+
+    void unlink_(index_type n) noexcept
+    {
+        const index_type parent = parent_[n];
+        if(parent == npos) return;
+
+        const index_type prev = prev_sibling_[n], next = next_sibling_[n];
+        if(prev != npos) next_sibling_[prev] = next;
+        else             first_child_[parent] = next;
+        if(next != npos) prev_sibling_[next] = prev;
+        else             last_child_[parent] = prev;
+
+        parent_[n] = prev_sibling_[n] = next_sibling_[n] = npos;
+    }
+
+    void destroy_values_() noexcept
+    {
+        if constexpr(!std::is_trivially_destructible_v<T>)
+        {
+            for(index_type i = 0; i < slots_(); ++i)
+            {
+                if(depth_[i] != dead) std::destroy_at(values_.at(i));
+            }
+        }
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::vector<index_type> parent_;
+    std::vector<index_type> first_child_;
+    std::vector<index_type> last_child_;
+    std::vector<index_type> next_sibling_;
+    std::vector<index_type> prev_sibling_;
+    std::vector<index_type> depth_;
+    storage_type            values_;
+    index_type              root_ = npos;
+    index_type              free_ = npos;
+    size_type               size_ = 0;
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_DIRECTED_TREE_H
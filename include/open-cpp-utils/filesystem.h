@@ -0,0 +1,1882 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_FILESYSTEM_H
+#define OPEN_CPP_UTILS_FILESYSTEM_H
+
+#include "config.h"
+#include "hash.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(OCU_PLATFORM_WINDOWS)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#elif defined(OCU_PLATFORM_POSIX)
+#   include <cerrno>
+#   include <dirent.h>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <sys/uio.h>
+#   include <unistd.h>
+#endif
+
+#if defined(OCU_PLATFORM_LINUX)
+#   include <sys/syscall.h>
+#   if __has_include(<linux/io_uring.h>)
+#       include <linux/io_uring.h>
+#       if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#           define OCU_HAS_IO_URING 1
+#       endif
+#   endif
+#endif
+
+namespace open_cpp_utils
+{
+
+namespace detail
+{
+
+inline std::size_t page_size() noexcept
+{
+    static const std::size_t size = []
+    {
+#if defined(OCU_PLATFORM_WINDOWS)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<std::size_t>(info.dwPageSize);
+#elif defined(OCU_PLATFORM_POSIX)
+        const long s = sysconf(_SC_PAGESIZE);
+        return s > 0 ? static_cast<std::size_t>(s) : std::size_t(4096);
+#else
+        return std::size_t(4096);
+#endif
+    }();
+    return size;
+}
+
+inline std::error_code last_system_error() noexcept
+{
+#if defined(OCU_PLATFORM_WINDOWS)
+    return { static_cast<int>(GetLastError()), std::system_category() };
+#else
+    return { errno, std::system_category() };
+#endif
+}
+
+}
+
+// mapped_file =========================================================================================================
+
+/**
+ * \brief How a mapped range is about to be read, forwarded to the kernel as a paging hint
+ */
+enum class access_pattern
+{
+    normal,     ///< Default read-ahead
+    sequential, ///< Aggressive read-ahead; pages behind the reader may be dropped early
+    random,     ///< No read-ahead
+    will_need,  ///< Start reading the range into the page cache now
+    dont_need   ///< The range will not be read again soon; its pages may be reclaimed
+};
+
+/**
+ * \brief Read-only memory mapping of a whole file.
+ *
+ * Opening maps the file without reading it: the cost is a few system calls regardless of size, and pages are faulted
+ * in from the OS page cache on first touch. Because the mapping is shared, every process mapping the same file reads
+ * the same physical pages, and nothing is copied into a private buffer. bytes() and view() hand out spans straight
+ * into the mapping; they stay valid until the mapped_file is closed, moved from or destroyed.
+ *
+ * The file is expected not to change while mapped. Truncating it underneath a mapping makes later reads of the lost
+ * range fault (SIGBUS on POSIX).
+ *
+ * Errors are reported like std::filesystem: the throwing overloads throw std::system_error naming the path, the
+ * std::error_code overloads never throw.
+ */
+class mapped_file
+{
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    mapped_file() noexcept = default;
+
+    explicit mapped_file(const std::filesystem::path& path, access_pattern hint = access_pattern::normal)
+    {
+        std::error_code ec;
+        open(path, hint, ec);
+        if(ec) throw std::system_error(ec, "mapped_file: cannot map " + path.string());
+    }
+
+    mapped_file(const std::filesystem::path& path, std::error_code& ec) noexcept
+    {
+        open(path, access_pattern::normal, ec);
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+    { }
+
+    mapped_file& operator=(mapped_file&& other) noexcept
+    {
+        if(this != &other)
+        {
+            close();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~mapped_file() { close(); }
+
+// Opening & Closing ---------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Replaces the current mapping with one of path. On failure ec is set and the mapped_file is closed.
+     *        An empty file opens successfully with a null data() and size() 0.
+     */
+    void open(const std::filesystem::path& path, access_pattern hint, std::error_code& ec) noexcept
+    {
+        close();
+        ec.clear();
+
+#if defined(OCU_PLATFORM_WINDOWS)
+        DWORD flags = FILE_ATTRIBUTE_NORMAL;
+        if(hint == access_pattern::sequential) flags = FILE_FLAG_SEQUENTIAL_SCAN;
+        if(hint == access_pattern::random)     flags = FILE_FLAG_RANDOM_ACCESS;
+
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, flags, nullptr);
+        if(file == INVALID_HANDLE_VALUE) { ec = detail::last_system_error(); return; }
+
+        LARGE_INTEGER size;
+        if(!GetFileSizeEx(file, &size)) { ec = detail::last_system_error(); CloseHandle(file); return; }
+
+        if(size.QuadPart > 0)
+        {
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if(mapping == nullptr) { ec = detail::last_system_error(); CloseHandle(file); return; }
+
+            void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if(view == nullptr) ec = detail::last_system_error();
+            CloseHandle(mapping);
+
+            if(view)
+            {
+                data_ = static_cast<const std::byte*>(view);
+                size_ = static_cast<std::size_t>(size.QuadPart);
+            }
+        }
+        CloseHandle(file);
+#elif defined(OCU_PLATFORM_POSIX)
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if(fd < 0) { ec = detail::last_system_error(); return; }
+
+        struct stat st;
+        if(::fstat(fd, &st) != 0) { ec = detail::last_system_error(); ::close(fd); return; }
+        if(!S_ISREG(st.st_mode)) { ec = std::make_error_code(std::errc::invalid_argument); ::close(fd); return; }
+
+        if(st.st_size > 0)
+        {
+            void* view = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if(view == MAP_FAILED)
+            {
+                ec = detail::last_system_error();
+            }
+            else
+            {
+                data_ = static_cast<const std::byte*>(view);
+                size_ = static_cast<std::size_t>(st.st_size);
+            }
+        }
+
+        // The mapping keeps its own reference to the file
+        ::close(fd);
+#else
+        static_cast<void>(path);
+        ec = std::make_error_code(std::errc::function_not_supported);
+#endif
+
+        if(!ec && hint != access_pattern::normal) advise(hint);
+    }
+
+    void open(const std::filesystem::path& path, access_pattern hint = access_pattern::normal)
+    {
+        std::error_code ec;
+        open(path, hint, ec);
+        if(ec) throw std::system_error(ec, "mapped_file: cannot map " + path.string());
+    }
+
+    void close() noexcept
+    {
+        if(data_ == nullptr) return;
+#if defined(OCU_PLATFORM_WINDOWS)
+        UnmapViewOfFile(data_);
+#elif defined(OCU_PLATFORM_POSIX)
+        ::munmap(const_cast<std::byte*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+// Access --------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] const std::byte* data()  const noexcept { return data_; }
+    [[nodiscard]] std::size_t      size()  const noexcept { return size_; }
+    [[nodiscard]] bool             empty() const noexcept { return size_ == 0; }
+
+    /// True if the object holds a mapping; false for a default constructed, closed or empty-file mapped_file
+    [[nodiscard]] bool is_mapped() const noexcept { return data_ != nullptr; }
+
+    [[nodiscard]] std::span<const std::byte> bytes() const noexcept { return { data_, size_ }; }
+
+    /**
+     * \brief The count bytes at offset, clamped to the end of the file
+     * \throws std::out_of_range if offset is past the end
+     */
+    [[nodiscard]] std::span<const std::byte> view(std::size_t offset, std::size_t count = std::size_t(-1)) const
+    {
+        if(offset > size_) throw std::out_of_range("mapped_file::view offset past the end");
+        return bytes().subspan(offset, std::min(count, size_ - offset));
+    }
+
+    /// The whole file as characters, for text formats
+    [[nodiscard]] std::string_view text() const noexcept
+    {
+        return { reinterpret_cast<const char*>(data_), size_ };
+    }
+
+// Paging Hints --------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Tells the kernel how [offset, offset + count) will be read. The range is widened to whole pages.
+     * \return false if the platform has no equivalent hint or the call failed; the mapping is unaffected either way
+     */
+    bool advise(access_pattern pattern, std::size_t offset = 0, std::size_t count = std::size_t(-1)) const noexcept
+    {
+        if(data_ == nullptr || offset >= size_) return false;
+
+        const std::size_t page  = detail::page_size();
+        const std::size_t first = offset & ~(page - 1);
+        const std::size_t last  = count >= size_ - offset ? size_ : offset + count;
+        void*             start = const_cast<std::byte*>(data_ + first);
+        const std::size_t len   = last - first;
+
+#if defined(OCU_PLATFORM_WINDOWS)
+        if(pattern != access_pattern::will_need) return false;
+#   if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+        WIN32_MEMORY_RANGE_ENTRY range{ start, len };
+        return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) != 0;
+#   else
+        static_cast<void>(start);
+        static_cast<void>(len);
+        return false;
+#   endif
+#elif defined(OCU_PLATFORM_POSIX)
+        // madvise rather than posix_madvise: glibc turns POSIX_MADV_DONTNEED into a no-op, while MADV_DONTNEED on a
+        // read-only shared mapping just drops the pages, which fault back in from the file if touched again
+        int advice = MADV_NORMAL;
+        switch(pattern)
+        {
+            case access_pattern::normal:     advice = MADV_NORMAL;     break;
+            case access_pattern::sequential: advice = MADV_SEQUENTIAL; break;
+            case access_pattern::random:     advice = MADV_RANDOM;     break;
+            case access_pattern::will_need:  advice = MADV_WILLNEED;   break;
+            case access_pattern::dont_need:  advice = MADV_DONTNEED;   break;
+        }
+        return ::madvise(start, len, advice) == 0;
+#else
+        static_cast<void>(pattern);
+        static_cast<void>(start);
+        static_cast<void>(len);
+        return false;
+#endif
+    }
+
+    /**
+     * \brief Starts reading [offset, offset + count) into the page cache without blocking
+     */
+    bool prefetch(std::size_t offset = 0, std::size_t count = std::size_t(-1)) const noexcept
+    {
+        return advise(access_pattern::will_need, offset, count);
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    const std::byte* data_ = nullptr;
+    std::size_t      size_ = 0;
+};
+
+// async_file ==========================================================================================================
+
+/**
+ * \brief Mechanism an io_queue uses to run reads and writes
+ */
+enum class io_backend
+{
+    automatic,     ///< io_uring on Linux, IOCP on Windows, worker_threads where neither is available
+    io_uring,      ///< Linux io_uring: one system call submits a whole batch, completions are reaped from a ring
+    iocp,          ///< Windows overlapped I/O completing to an I/O completion port
+    worker_threads ///< Blocking pread/pwrite run as thread pool tasks
+};
+
+/**
+ * \brief How an async_file is opened. Combine with |.
+ */
+enum class file_mode : unsigned
+{
+    read     = 1u << 0,
+    write    = 1u << 1,
+    create   = 1u << 2, ///< Create the file if it does not exist
+    truncate = 1u << 3  ///< Discard existing contents
+};
+
+[[nodiscard]] constexpr file_mode operator|(file_mode a, file_mode b) noexcept
+{
+    return static_cast<file_mode>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+}
+
+[[nodiscard]] constexpr bool has_mode(file_mode set, file_mode flag) noexcept
+{
+    return (static_cast<unsigned>(set) & static_cast<unsigned>(flag)) != 0;
+}
+
+struct io_queue_options
+{
+    /// Operations per submission batch, and the bound on operations in flight for IOCP and worker_threads. io_uring
+    /// rounds it up to a power of two and allows twice as many in flight, the size of its completion ring.
+    unsigned     depth   = 256;
+    io_backend   backend = io_backend::automatic;
+
+    /// Pool that runs completion callbacks, and the blocking calls of the worker_threads backend. nullptr means
+    /// default_thread_pool(). It must outlive the io_queue.
+    thread_pool* pool    = nullptr;
+};
+
+namespace detail
+{
+
+#if defined(OCU_PLATFORM_WINDOWS)
+using native_file = HANDLE;
+inline const native_file invalid_native_file = INVALID_HANDLE_VALUE;
+#else
+using native_file = int;
+inline constexpr native_file invalid_native_file = -1;
+#endif
+
+/**
+ * \brief One queued read or write. Allocated with its callback, which runs and deletes it through finish.
+ */
+struct io_op
+{
+    void (*finish)(io_op*) noexcept;
+
+    std::shared_ptr<completion> outstanding;
+    native_file                 file;
+    std::uint64_t               offset;
+    std::byte*                  data;
+    std::size_t                 size;
+    bool                        write;
+
+    std::error_code             error;
+    std::size_t                 bytes = 0;
+
+#if defined(OCU_HAS_IO_URING)
+    iovec                       iov;
+#endif
+#if defined(OCU_PLATFORM_WINDOWS)
+    OVERLAPPED                  overlapped;
+#endif
+};
+
+template<typename Fn>
+struct io_op_impl final : io_op
+{
+    template<typename F>
+    io_op_impl(native_file f, std::uint64_t off, std::byte* d, std::size_t n, bool w, F&& callback)
+        : io_op{ }
+        , fn(std::forward<F>(callback))
+    {
+        finish = &call;
+        file   = f;
+        offset = off;
+        data   = d;
+        size   = n;
+        write  = w;
+    }
+
+    static void call(io_op* op) noexcept
+    {
+        auto* self = static_cast<io_op_impl*>(op);
+        std::shared_ptr<completion> outstanding = std::move(self->outstanding);
+        self->fn(self->error, self->bytes);
+        delete self;
+        outstanding->done();
+    }
+
+    Fn fn;
+};
+
+/**
+ * \brief Runs op synchronously with pread/pwrite (or positioned ReadFile/WriteFile), retrying on EINTR
+ */
+inline void blocking_io(io_op& op) noexcept
+{
+#if defined(OCU_PLATFORM_WINDOWS)
+    OVERLAPPED ov{ };
+    ov.Offset     = static_cast<DWORD>(op.offset);
+    ov.OffsetHigh = static_cast<DWORD>(op.offset >> 32);
+
+    const DWORD size = static_cast<DWORD>(std::min<std::size_t>(op.size, MAXDWORD));
+    DWORD       done = 0;
+    const BOOL  ok   = op.write ? WriteFile(op.file, op.data, size, &done, &ov)
+                                : ReadFile(op.file, op.data, size, &done, &ov);
+    if(!ok && GetLastError() != ERROR_HANDLE_EOF) op.error = last_system_error();
+    op.bytes = done;
+#elif defined(OCU_PLATFORM_POSIX)
+    for(;;)
+    {
+        const off_t   offset = static_cast<off_t>(op.offset);
+        const ssize_t n      = op.write ? ::pwrite(op.file, op.data, op.size, offset)
+                                        : ::pread(op.file, op.data, op.size, offset);
+        if(n >= 0) { op.bytes = static_cast<std::size_t>(n); return; }
+        if(errno != EINTR) { op.error = last_system_error(); return; }
+    }
+#else
+    op.error = std::make_error_code(std::errc::function_not_supported);
+#endif
+}
+
+#if defined(OCU_HAS_IO_URING)
+
+/**
+ * \brief Minimal io_uring binding over the raw system calls: the submission and completion rings and their
+ *        mmap'd index words. Not thread safe on its own; io_queue serializes submission and owns the only reaper.
+ */
+class io_uring_ring
+{
+public:
+    io_uring_ring() noexcept = default;
+    io_uring_ring(const io_uring_ring&) = delete;
+    io_uring_ring& operator=(const io_uring_ring&) = delete;
+    ~io_uring_ring() { destroy(); }
+
+    bool init(unsigned entries, std::error_code& ec) noexcept
+    {
+        io_uring_params params{ };
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if(fd_ < 0) { ec = last_system_error(); fd_ = -1; return false; }
+
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if(single) sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+
+        sq_ring_ = map_(sq_size_, IORING_OFF_SQ_RING);
+        cq_ring_ = single ? sq_ring_ : map_(cq_size_, IORING_OFF_CQ_RING);
+        sqes_    = static_cast<io_uring_sqe*>(map_(params.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES));
+        if(sq_ring_ == nullptr || cq_ring_ == nullptr || sqes_ == nullptr)
+        {
+            ec = last_system_error();
+            destroy();
+            return false;
+        }
+
+        auto* sq = static_cast<std::byte*>(sq_ring_);
+        auto* cq = static_cast<std::byte*>(cq_ring_);
+        sq_head_    = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_    = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_array_   = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_mask_    = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        cq_head_    = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_    = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqes_       = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        cq_mask_    = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        cq_entries_ = params.cq_entries;
+        sq_local_   = *sq_tail_;
+        return true;
+    }
+
+    void destroy() noexcept
+    {
+        if(sqes_)                           ::munmap(sqes_, sq_entries_ * sizeof(io_uring_sqe));
+        if(cq_ring_ && cq_ring_ != sq_ring_) ::munmap(cq_ring_, cq_size_);
+        if(sq_ring_)                        ::munmap(sq_ring_, sq_size_);
+        if(fd_ >= 0)                        ::close(fd_);
+        sqes_ = nullptr; sq_ring_ = cq_ring_ = nullptr; fd_ = -1;
+    }
+
+    [[nodiscard]] unsigned sq_entries() const noexcept { return sq_entries_; }
+    [[nodiscard]] unsigned cq_entries() const noexcept { return cq_entries_; }
+
+    /// Entries written but not yet handed to the kernel
+    [[nodiscard]] unsigned unsubmitted() const noexcept
+    {
+        return sq_local_ - std::atomic_ref<unsigned>(*sq_head_).load(std::memory_order_acquire);
+    }
+
+    /**
+     * \brief Writes a read/write (or, for op == nullptr, a no-op that carries user_data 0) into the next free
+     *        submission slot. The caller guarantees a slot is free.
+     */
+    void prepare(io_op* op) noexcept
+    {
+        const unsigned index = sq_local_ & sq_mask_;
+        io_uring_sqe&  sqe   = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+
+        if(op == nullptr)
+        {
+            sqe.opcode = IORING_OP_NOP;
+        }
+        else
+        {
+            op->iov        = { op->data, op->size };
+            sqe.opcode     = op->write ? IORING_OP_WRITEV : IORING_OP_READV;
+            sqe.fd         = op->file;
+            sqe.off        = op->offset;
+            sqe.addr       = reinterpret_cast<std::uint64_t>(&op->iov);
+            sqe.len        = 1;
+            sqe.user_data  = reinterpret_cast<std::uint64_t>(op);
+        }
+
+        sq_array_[index] = index;
+        ++sq_local_;
+    }
+
+    /**
+     * \brief Publishes every prepared entry and submits them with as few io_uring_enter calls as the kernel allows.
+     *        Entries the kernel refuses for now (EAGAIN, EBUSY, or no progress) stay in the ring and go out with the
+     *        next submit once completions have been reaped.
+     * \return The error of a submission the kernel rejected for good; the unconsumed entries are still in the ring
+     *         and must be taken back with take_unsubmitted
+     */
+    std::error_code submit() noexcept
+    {
+        std::atomic_ref<unsigned>(*sq_tail_).store(sq_local_, std::memory_order_release);
+
+        unsigned pending = unsubmitted();
+        while(pending != 0)
+        {
+            const long n = ::syscall(__NR_io_uring_enter, fd_, pending, 0u, 0u, nullptr, 0);
+            if(n < 0)
+            {
+                if(errno == EINTR) continue;
+                if(errno == EAGAIN || errno == EBUSY) return { };
+                return last_system_error();
+            }
+            if(n == 0) return { };
+            pending -= std::min<unsigned>(pending, static_cast<unsigned>(n));
+        }
+        return { };
+    }
+
+    /**
+     * \brief Calls fn(user_data) for every entry the kernel has not consumed and removes them from the ring. Without
+     *        SQPOLL the kernel only reads the ring inside io_uring_enter, so rewinding the tail is safe while the
+     *        caller holds the submission lock.
+     */
+    template<typename Fn>
+    void take_unsubmitted(Fn&& fn) noexcept
+    {
+        const unsigned head = std::atomic_ref<unsigned>(*sq_head_).load(std::memory_order_acquire);
+        for(unsigned i = head; i != sq_local_; ++i) fn(sqes_[i & sq_mask_].user_data);
+        sq_local_ = head;
+        std::atomic_ref<unsigned>(*sq_tail_).store(head, std::memory_order_release);
+    }
+
+    /**
+     * \brief Calls fn(user_data, res) for every available completion, blocking in the kernel until there is at
+     *        least one
+     * \return Number of completions consumed, or 0 with ec set if waiting failed for a reason other than an
+     *         interruption or a transient EAGAIN/EBUSY
+     */
+    template<typename Fn>
+    unsigned reap(Fn&& fn, std::error_code& ec) noexcept
+    {
+        unsigned head = *cq_head_;
+        unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+        while(head == tail)
+        {
+            const long n = ::syscall(__NR_io_uring_enter, fd_, 0u, 1u, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if(n < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                ec = last_system_error();
+                return 0;
+            }
+            tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+        }
+
+        const unsigned count = tail - head;
+        for(; head != tail; ++head)
+        {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            fn(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+        return count;
+    }
+
+private:
+    void* map_(std::size_t size, long long offset) noexcept
+    {
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    int           fd_         = -1;
+    void*         sq_ring_    = nullptr;
+    void*         cq_ring_    = nullptr;
+    std::size_t   sq_size_    = 0;
+    std::size_t   cq_size_    = 0;
+    io_uring_sqe* sqes_       = nullptr;
+    io_uring_cqe* cqes_       = nullptr;
+    unsigned*     sq_head_    = nullptr;
+    unsigned*     sq_tail_    = nullptr;
+    unsigned*     sq_array_   = nullptr;
+    unsigned*     cq_head_    = nullptr;
+    unsigned*     cq_tail_    = nullptr;
+    unsigned      sq_mask_    = 0;
+    unsigned      cq_mask_    = 0;
+    unsigned      sq_entries_ = 0;
+    unsigned      cq_entries_ = 0;
+    unsigned      sq_local_   = 0;
+};
+
+#endif
+
+}
+
+class async_file;
+
+/**
+ * \brief Batching submission queue shared by any number of async_files.
+ *
+ * Reads and writes are queued, not started: they reach the kernel when submit() is called, when a full batch of
+ * depth operations has accumulated, or when drain() runs. With io_uring a whole batch costs one io_uring_enter;
+ * IOCP issues the batch's overlapped calls back to back. A dedicated completion thread reaps finished operations
+ * and posts each callback to the thread pool, so no pool worker ever blocks on the device. Where neither is
+ * available (or io_backend::worker_threads is asked for) each operation becomes a pool task running pread/pwrite.
+ *
+ * Queueing is thread safe. When depth operations are already in flight, queueing another submits what is pending
+ * and runs pool tasks until a slot frees up, which bounds memory and keeps the completion ring from overflowing.
+ *
+ * The destructor submits what is pending and waits for every callback, so buffers may be released after it returns.
+ */
+class io_queue
+{
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    io_queue() : io_queue(io_queue_options{ }) { }
+
+    /**
+     * \throws std::system_error if the requested backend cannot be set up
+     */
+    explicit io_queue(const io_queue_options& options)
+        : pool_(options.pool ? options.pool : &default_thread_pool())
+        , outstanding_(std::make_shared<detail::completion>(0))
+        , limit_(std::max(1u, options.depth))
+    {
+        std::error_code ec;
+        backend_ = options.backend;
+
+#if defined(OCU_HAS_IO_URING)
+        if(backend_ == io_backend::automatic || backend_ == io_backend::io_uring)
+        {
+            if(ring_.init(limit_, ec))
+            {
+                backend_ = io_backend::io_uring;
+                limit_   = ring_.cq_entries();
+            }
+            else if(backend_ == io_backend::io_uring)
+            {
+                throw std::system_error(ec, "io_queue: io_uring_setup failed");
+            }
+        }
+#elif defined(OCU_PLATFORM_WINDOWS)
+        if(backend_ == io_backend::automatic || backend_ == io_backend::iocp)
+        {
+            port_ = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+            if(port_ != nullptr)
+            {
+                backend_ = io_backend::iocp;
+            }
+            else if(backend_ == io_backend::iocp)
+            {
+                throw std::system_error(detail::last_system_error(), "io_queue: CreateIoCompletionPort failed");
+            }
+        }
+#endif
+
+        if(backend_ == io_backend::automatic) backend_ = io_backend::worker_threads;
+        if(backend_ == io_backend::io_uring || backend_ == io_backend::iocp)
+        {
+            if(!native_backend_()) throw std::system_error(std::make_error_code(std::errc::function_not_supported),
+                                                           "io_queue: backend not available on this platform");
+            reaper_ = std::thread([this] { reap_loop_(); });
+        }
+        else
+        {
+            pending_.reserve(limit_);
+            batch_.reserve(limit_);
+        }
+    }
+
+    io_queue(const io_queue&) = delete;
+    io_queue& operator=(const io_queue&) = delete;
+
+    ~io_queue()
+    {
+        drain();
+        if(reaper_.joinable())
+        {
+            stop_reaper_();
+            reaper_.join();
+        }
+#if defined(OCU_PLATFORM_WINDOWS)
+        if(port_ != nullptr) CloseHandle(port_);
+#endif
+    }
+
+// Submission ----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Starts every queued operation
+     */
+    void submit()
+    {
+        std::lock_guard lock(mutex_);
+        submit_locked_();
+    }
+
+    /**
+     * \brief Submits, then runs pool tasks on the calling thread until every operation queued so far has completed
+     *        and its callback has returned
+     */
+    void drain()
+    {
+        submit();
+        pool_->wait(*outstanding_);
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] io_backend   backend() const noexcept { return backend_; }
+    [[nodiscard]] thread_pool& pool()    const noexcept { return *pool_; }
+
+    /// Operations queued or running whose callbacks have not returned yet
+    [[nodiscard]] std::size_t outstanding() const noexcept
+    {
+        return outstanding_->pending.load(std::memory_order_relaxed);
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    friend class async_file;
+
+    bool native_backend_() const noexcept
+    {
+#if defined(OCU_HAS_IO_URING)
+        return backend_ == io_backend::io_uring;
+#elif defined(OCU_PLATFORM_WINDOWS)
+        return backend_ == io_backend::iocp;
+#else
+        return false;
+#endif
+    }
+
+#if defined(OCU_PLATFORM_WINDOWS)
+    HANDLE port() const noexcept { return port_; }
+#endif
+
+    /// Throws only before op is queued; once it is, its callback is guaranteed to run
+    void enqueue_(detail::io_op* op)
+    {
+        acquire_slot_();
+        op->outstanding = outstanding_;
+        outstanding_->pending.fetch_add(1, std::memory_order_relaxed);
+
+        std::unique_lock lock(mutex_);
+#if defined(OCU_HAS_IO_URING)
+        if(backend_ == io_backend::io_uring)
+        {
+            wait_for_sqe_(lock);
+            ring_.prepare(op);
+            if(ring_.unsubmitted() == ring_.sq_entries()) submit_locked_();
+            return;
+        }
+#endif
+        pending_.push_back(op);
+        if(pending_.size() < limit_) return;
+
+        // The batch stays queued if submitting it fails, so the next submit or drain retries it
+        try
+        {
+            submit_locked_();
+        }
+        catch(...)
+        {
+        }
+    }
+
+    /// Claims one of limit_ in-flight slots, submitting and helping the pool while none is free
+    void acquire_slot_()
+    {
+        std::uint32_t n = in_flight_.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            if(n < limit_)
+            {
+                if(in_flight_.compare_exchange_weak(n, n + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    return;
+                }
+                continue;
+            }
+
+            submit();
+            if(!pool_->try_run_one()) in_flight_.wait(n, std::memory_order_relaxed);
+            n = in_flight_.load(std::memory_order_relaxed);
+        }
+    }
+
+    void release_slots_(std::uint32_t count) noexcept
+    {
+        if(count == 0) return;
+        if(in_flight_.fetch_sub(count, std::memory_order_release) == limit_) in_flight_.notify_all();
+    }
+
+    /// \return The error io_uring rejected the batch with; its entries have been taken back out of the ring
+    std::error_code submit_locked_()
+    {
+#if defined(OCU_HAS_IO_URING)
+        if(backend_ == io_backend::io_uring)
+        {
+            const std::error_code ec = ring_.submit();
+            if(!ec) return { };
+
+            // The kernel will never consume these, so complete them with the error rather than leave drain() waiting
+            std::uint32_t failed = 0;
+            ring_.take_unsubmitted([&](std::uint64_t user_data)
+            {
+                if(user_data == 0) return;
+                auto* op  = reinterpret_cast<detail::io_op*>(user_data);
+                op->error = ec;
+                pool_->post([op]() noexcept { op->finish(op); });
+                ++failed;
+            });
+            release_slots_(failed);
+            return ec;
+        }
+#endif
+
+        // Swapping with a second buffer reserved to limit_ keeps submission allocation free
+        batch_.swap(pending_);
+        std::size_t started = 0;
+        try
+        {
+            for(; started < batch_.size(); ++started)
+            {
+                detail::io_op* const op = batch_[started];
+#if defined(OCU_PLATFORM_WINDOWS)
+                if(backend_ == io_backend::iocp)
+                {
+                    start_overlapped_(op);
+                    continue;
+                }
+#endif
+                pool_->post([this, op]() noexcept
+                {
+                    detail::blocking_io(*op);
+                    release_slots_(1);
+                    op->finish(op);
+                });
+            }
+        }
+        catch(...)
+        {
+            // pending_ is empty and still has batch_'s old capacity, so the operations not started yet go back
+            // without allocating and the next submit retries them
+            pending_.assign(batch_.begin() + static_cast<std::ptrdiff_t>(started), batch_.end());
+            batch_.clear();
+            throw;
+        }
+        batch_.clear();
+        return { };
+    }
+
+#if defined(OCU_PLATFORM_WINDOWS)
+    void start_overlapped_(detail::io_op* op)
+    {
+        std::memset(&op->overlapped, 0, sizeof(OVERLAPPED));
+        op->overlapped.Offset     = static_cast<DWORD>(op->offset);
+        op->overlapped.OffsetHigh = static_cast<DWORD>(op->offset >> 32);
+
+        const DWORD size = static_cast<DWORD>(std::min<std::size_t>(op->size, MAXDWORD));
+        const BOOL  ok   = op->write ? WriteFile(op->file, op->data, size, nullptr, &op->overlapped)
+                                     : ReadFile(op->file, op->data, size, nullptr, &op->overlapped);
+        if(ok) return;
+
+        const DWORD error = GetLastError();
+        if(error == ERROR_IO_PENDING) return;
+
+        // Failed synchronously, so no completion packet will arrive
+        if(error != ERROR_HANDLE_EOF) op->error = { static_cast<int>(error), std::system_category() };
+        release_slots_(1);
+        pool_->post([op]() noexcept { op->finish(op); });
+    }
+#endif
+
+#if defined(OCU_HAS_IO_URING)
+    /**
+     * \brief Returns once the submission ring has a free entry. A full ring the kernel refuses for now drains as the
+     *        reaper consumes completions, so the lock is dropped while waiting for that.
+     */
+    void wait_for_sqe_(std::unique_lock<std::mutex>& lock)
+    {
+        while(ring_.unsubmitted() == ring_.sq_entries())
+        {
+            submit_locked_();
+            if(ring_.unsubmitted() < ring_.sq_entries()) return;
+
+            lock.unlock();
+            if(!pool_->try_run_one()) std::this_thread::yield();
+            lock.lock();
+        }
+    }
+#endif
+
+    void stop_reaper_()
+    {
+#if defined(OCU_HAS_IO_URING)
+        std::unique_lock lock(mutex_);
+        wait_for_sqe_(lock);
+        ring_.prepare(nullptr);
+
+        // The sentinel is the reaper's only way out: a rejected submission takes it back and a refused one leaves it
+        // in the ring, so keep submitting until the kernel has consumed it or join() would wait forever. A reaper
+        // that already gave up on the ring needs no sentinel.
+        for(;;)
+        {
+            if(reaper_failed_.load(std::memory_order_acquire)) return;
+
+            const std::error_code ec = submit_locked_();
+            if(!ec && ring_.unsubmitted() == 0) return;
+
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+            if(ec)
+            {
+                wait_for_sqe_(lock);
+                ring_.prepare(nullptr);
+            }
+        }
+#elif defined(OCU_PLATFORM_WINDOWS)
+        PostQueuedCompletionStatus(port_, 0, 0, nullptr);
+#endif
+    }
+
+    void reap_loop_()
+    {
+#if defined(OCU_HAS_IO_URING)
+        bool stop = false;
+        while(!stop)
+        {
+            std::error_code ec;
+            std::uint32_t   done = 0;
+            ring_.reap([&](std::uint64_t user_data, int res)
+            {
+                if(user_data == 0) { stop = true; return; }
+
+                auto* op = reinterpret_cast<detail::io_op*>(user_data);
+                if(res < 0) op->error = { -res, std::system_category() };
+                else        op->bytes = static_cast<std::size_t>(res);
+                pool_->post([op]() noexcept { op->finish(op); });
+                ++done;
+            }, ec);
+            release_slots_(done);
+
+            // Waiting on the ring keeps failing (EBADF, ENXIO, EFAULT), so retrying would only spin this thread
+            if(ec)
+            {
+                reaper_failed_.store(true, std::memory_order_release);
+                stop = true;
+            }
+        }
+#elif defined(OCU_PLATFORM_WINDOWS)
+        OVERLAPPED_ENTRY entries[64];
+        for(;;)
+        {
+            ULONG count = 0;
+            if(!GetQueuedCompletionStatusEx(port_, entries, 64, &count, INFINITE, FALSE)) continue;
+
+            bool          stop = false;
+            std::uint32_t done = 0;
+            for(ULONG i = 0; i < count; ++i)
+            {
+                if(entries[i].lpOverlapped == nullptr) { stop = true; continue; }
+
+                auto* op = CONTAINING_RECORD(entries[i].lpOverlapped, detail::io_op, overlapped);
+                DWORD bytes = 0;
+                if(!GetOverlappedResult(op->file, &op->overlapped, &bytes, FALSE)
+                   && GetLastError() != ERROR_HANDLE_EOF)
+                {
+                    op->error = detail::last_system_error();
+                }
+                op->bytes = bytes;
+                pool_->post([op]() noexcept { op->finish(op); });
+                ++done;
+            }
+            release_slots_(done);
+            if(stop) return;
+        }
+#endif
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    thread_pool*                        pool_;
+    std::shared_ptr<detail::completion> outstanding_;
+    std::uint32_t                       limit_;
+    io_backend                          backend_ = io_backend::automatic;
+
+    alignas(cache_line_size) std::atomic<std::uint32_t> in_flight_{ 0 };
+
+    std::mutex                  mutex_;
+    std::vector<detail::io_op*> pending_;
+    std::vector<detail::io_op*> batch_;
+    std::thread                 reaper_;
+
+#if defined(OCU_HAS_IO_URING)
+    detail::io_uring_ring       ring_;
+    std::atomic<bool>           reaper_failed_{ false };
+#elif defined(OCU_PLATFORM_WINDOWS)
+    HANDLE                      port_ = nullptr;
+#endif
+};
+
+/**
+ * \brief File opened for positioned asynchronous reads and writes through an io_queue.
+ *
+ * read and write take a completion handler called as fn(std::error_code, std::size_t bytes) on the queue's thread
+ * pool. Like pread, a read may return fewer bytes than asked for, and returns 0 at end of file; this is not an error.
+ * The buffer must stay alive and untouched until the handler runs. Handlers must not throw. The overloads without a
+ * handler return a std::future<std::size_t> that carries a std::system_error on failure.
+ *
+ * The file must stay open, and the queue alive, until every operation on it has completed (io_queue::drain).
+ */
+class async_file
+{
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    async_file() noexcept = default;
+
+    async_file(io_queue& queue, const std::filesystem::path& path, file_mode mode = file_mode::read)
+    {
+        std::error_code ec;
+        open(queue, path, mode, ec);
+        if(ec) throw std::system_error(ec, "async_file: cannot open " + path.string());
+    }
+
+    async_file(io_queue& queue, const std::filesystem::path& path, file_mode mode, std::error_code& ec) noexcept
+    {
+        open(queue, path, mode, ec);
+    }
+
+    async_file(const async_file&) = delete;
+    async_file& operator=(const async_file&) = delete;
+
+    async_file(async_file&& other) noexcept
+        : queue_(std::exchange(other.queue_, nullptr))
+        , file_(std::exchange(other.file_, detail::invalid_native_file))
+    { }
+
+    async_file& operator=(async_file&& other) noexcept
+    {
+        if(this != &other)
+        {
+            close();
+            queue_ = std::exchange(other.queue_, nullptr);
+            file_  = std::exchange(other.file_, detail::invalid_native_file);
+        }
+        return *this;
+    }
+
+    ~async_file() { close(); }
+
+// Opening & Closing ---------------------------------------------------------------------------------------------------
+
+    void open(io_queue& queue, const std::filesystem::path& path, file_mode mode, std::error_code& ec) noexcept
+    {
+        close();
+        ec.clear();
+
+        const bool reading = has_mode(mode, file_mode::read);
+        const bool writing = has_mode(mode, file_mode::write);
+
+#if defined(OCU_PLATFORM_WINDOWS)
+        const DWORD access = (reading ? GENERIC_READ : 0) | (writing ? GENERIC_WRITE : 0);
+
+        DWORD disposition = OPEN_EXISTING;
+        if(has_mode(mode, file_mode::create))   disposition = OPEN_ALWAYS;
+        if(has_mode(mode, file_mode::truncate)) disposition = has_mode(mode, file_mode::create) ? CREATE_ALWAYS
+                                                                                                : TRUNCATE_EXISTING;
+
+        const DWORD flags = FILE_ATTRIBUTE_NORMAL | (queue.native_backend_() ? FILE_FLAG_OVERLAPPED : 0);
+        HANDLE file = CreateFileW(path.c_str(), access, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                  nullptr, disposition, flags, nullptr);
+        if(file == INVALID_HANDLE_VALUE) { ec = detail::last_system_error(); return; }
+
+        if(queue.native_backend_() && CreateIoCompletionPort(file, queue.port(), 1, 0) == nullptr)
+        {
+            ec = detail::last_system_error();
+            CloseHandle(file);
+            return;
+        }
+#elif defined(OCU_PLATFORM_POSIX)
+        int flags = O_CLOEXEC;
+        flags |= reading && writing ? O_RDWR : writing ? O_WRONLY : O_RDONLY;
+        if(has_mode(mode, file_mode::create))   flags |= O_CREAT;
+        if(has_mode(mode, file_mode::truncate)) flags |= O_TRUNC;
+
+        const int file = ::open(path.c_str(), flags, 0666);
+        if(file < 0) { ec = detail::last_system_error(); return; }
+#else
+        static_cast<void>(path);
+        static_cast<void>(reading);
+        static_cast<void>(writing);
+        ec = std::make_error_code(std::errc::function_not_supported);
+        return;
+#endif
+
+#if defined(OCU_PLATFORM_WINDOWS) || defined(OCU_PLATFORM_POSIX)
+        queue_ = &queue;
+        file_  = file;
+#endif
+    }
+
+    void open(io_queue& queue, const std::filesystem::path& path, file_mode mode = file_mode::read)
+    {
+        std::error_code ec;
+        open(queue, path, mode, ec);
+        if(ec) throw std::system_error(ec, "async_file: cannot open " + path.string());
+    }
+
+    void close() noexcept
+    {
+        if(file_ == detail::invalid_native_file) return;
+#if defined(OCU_PLATFORM_WINDOWS)
+        CloseHandle(file_);
+#elif defined(OCU_PLATFORM_POSIX)
+        ::close(file_);
+#endif
+        file_  = detail::invalid_native_file;
+        queue_ = nullptr;
+    }
+
+// Operations ----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Queues a read of buffer.size() bytes at offset
+     */
+    template<typename Fn>
+    void read(std::uint64_t offset, std::span<std::byte> buffer, Fn&& on_complete)
+    {
+        enqueue_(offset, buffer.data(), buffer.size(), false, std::forward<Fn>(on_complete));
+    }
+
+    /**
+     * \brief Queues a write of buffer at offset
+     */
+    template<typename Fn>
+    void write(std::uint64_t offset, std::span<const std::byte> buffer, Fn&& on_complete)
+    {
+        enqueue_(offset, const_cast<std::byte*>(buffer.data()), buffer.size(), true, std::forward<Fn>(on_complete));
+    }
+
+    [[nodiscard]] std::future<std::size_t> read(std::uint64_t offset, std::span<std::byte> buffer)
+    {
+        return enqueue_future_(offset, buffer.data(), buffer.size(), false);
+    }
+
+    [[nodiscard]] std::future<std::size_t> write(std::uint64_t offset, std::span<const std::byte> buffer)
+    {
+        return enqueue_future_(offset, const_cast<std::byte*>(buffer.data()), buffer.size(), true);
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] bool      is_open() const noexcept { return file_ != detail::invalid_native_file; }
+    [[nodiscard]] io_queue* queue()   const noexcept { return queue_; }
+
+    /**
+     * \throws std::system_error if the size cannot be queried
+     */
+    [[nodiscard]] std::uint64_t size() const
+    {
+#if defined(OCU_PLATFORM_WINDOWS)
+        LARGE_INTEGER size;
+        if(!GetFileSizeEx(file_, &size)) throw std::system_error(detail::last_system_error(), "async_file::size");
+        return static_cast<std::uint64_t>(size.QuadPart);
+#elif defined(OCU_PLATFORM_POSIX)
+        struct stat st;
+        if(::fstat(file_, &st) != 0) throw std::system_error(detail::last_system_error(), "async_file::size");
+        return static_cast<std::uint64_t>(st.st_size);
+#else
+        throw std::system_error(std::make_error_code(std::errc::function_not_supported), "async_file::size");
+#endif
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    template<typename Fn>
+    void enqueue_(std::uint64_t offset, std::byte* data, std::size_t size, bool write, Fn&& fn)
+    {
+        OCU_ASSERT(is_open(), "async_file: operation on a closed file");
+
+        using impl = detail::io_op_impl<std::decay_t<Fn>>;
+        auto op = std::make_unique<impl>(file_, offset, data, size, write, std::forward<Fn>(fn));
+        queue_->enqueue_(op.get());
+        op.release();
+    }
+
+    std::future<std::size_t> enqueue_future_(std::uint64_t offset, std::byte* data, std::size_t size, bool write)
+    {
+        std::promise<std::size_t> promise;
+        auto future = promise.get_future();
+        enqueue_(offset, data, size, write, [p = std::move(promise), write](std::error_code ec, std::size_t n) mutable
+        {
+            if(!ec) { p.set_value(n); return; }
+            p.set_exception(std::make_exception_ptr(
+                std::system_error(ec, write ? "async_file: write failed" : "async_file: read failed")));
+        });
+        return future;
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    io_queue*           queue_ = nullptr;
+    detail::native_file file_  = detail::invalid_native_file;
+};
+
+// scan_directory ======================================================================================================
+
+enum class entry_type : std::uint8_t
+{
+    file,
+    directory,
+    symlink,
+    other
+};
+
+/**
+ * \brief One entry found by scan_directory
+ */
+struct scan_entry
+{
+    std::string   path;      ///< Relative to the scanned root, '/' separated, UTF-8
+    std::uint64_t size  = 0; ///< Bytes, for files; 0 when not stat'ed
+    std::int64_t  mtime = 0; ///< Last modification in nanoseconds since the Unix epoch; 0 when not stat'ed
+    entry_type    type  = entry_type::other;
+};
+
+struct scan_options
+{
+    bool         recursive         = true;
+    bool         stat              = true;    ///< Fill in size and mtime. On Windows they come with the listing.
+    bool         skip_inaccessible = true;    ///< Silently skip subdirectories that cannot be opened
+    thread_pool* pool              = nullptr; ///< nullptr means default_thread_pool()
+};
+
+namespace detail
+{
+
+/**
+ * \brief Stable 64-bit FNV-1a, used for the path hashes written to snapshots
+ */
+[[nodiscard]] constexpr std::uint64_t path_hash(std::string_view path) noexcept { return fnv1a_64(path); }
+
+/**
+ * \brief Runs fn when the scope ends, however it ends; closes the directory handles scan_ holds while visitors that
+ *        may throw are running
+ */
+template<typename Fn>
+class scope_exit
+{
+public:
+    explicit scope_exit(Fn fn) noexcept : fn_(std::move(fn)) { }
+
+    scope_exit(const scope_exit&) = delete;
+    scope_exit& operator=(const scope_exit&) = delete;
+
+    ~scope_exit() { fn_(); }
+
+private:
+    Fn fn_;
+};
+
+#if defined(OCU_PLATFORM_WINDOWS)
+
+inline std::wstring utf8_to_wide(std::string_view s)
+{
+    if(s.empty()) return { };
+    const int n = MultiByteToWideChar(CP_UTF8, 0, s.data(), static_cast<int>(s.size()), nullptr, 0);
+    std::wstring out(static_cast<std::size_t>(n), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, s.data(), static_cast<int>(s.size()), out.data(), n);
+    return out;
+}
+
+inline void append_utf8(std::string& out, const wchar_t* s)
+{
+    const int n = WideCharToMultiByte(CP_UTF8, 0, s, -1, nullptr, 0, nullptr, nullptr);
+    if(n <= 1) return;
+    const std::size_t at = out.size();
+    out.resize(at + static_cast<std::size_t>(n));
+    WideCharToMultiByte(CP_UTF8, 0, s, -1, out.data() + at, n, nullptr, nullptr);
+    out.pop_back();
+}
+
+#elif defined(OCU_PLATFORM_LINUX)
+
+/// Record layout returned by getdents64, which glibc only declares from 2.30 on
+struct linux_dirent64
+{
+    std::uint64_t  d_ino;
+    std::int64_t   d_off;
+    unsigned short d_reclen;
+    unsigned char  d_type;
+    char           d_name[1];
+};
+
+#endif
+
+/**
+ * \brief Shared state of one scan_directory call. Each directory is one pool task, which posts a task per
+ *        subdirectory before listing its own files, then appends its entries to the result in a single locked step.
+ */
+class directory_scanner
+{
+public:
+    directory_scanner(const std::filesystem::path& root, const scan_options& options)
+        : options_(options)
+        , pool_(options.pool ? options.pool : &default_thread_pool())
+        , pending_(std::make_shared<completion>(0))
+    {
+#if defined(OCU_PLATFORM_WINDOWS)
+        root_ = root.wstring();
+        while(!root_.empty() && (root_.back() == L'\\' || root_.back() == L'/')) root_.pop_back();
+#elif defined(OCU_PLATFORM_POSIX)
+        root_fd_ = ::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(root_fd_ < 0) error_ = last_system_error();
+#else
+        static_cast<void>(root);
+        error_ = std::make_error_code(std::errc::function_not_supported);
+#endif
+    }
+
+    directory_scanner(const directory_scanner&) = delete;
+    directory_scanner& operator=(const directory_scanner&) = delete;
+
+    ~directory_scanner()
+    {
+#if defined(OCU_PLATFORM_POSIX)
+        if(root_fd_ >= 0) ::close(root_fd_);
+#endif
+    }
+
+    std::vector<scan_entry> run(std::error_code& ec)
+    {
+        if(!error_)
+        {
+            bool root_ok = true;
+            try
+            {
+                scan_(std::string(), &root_ok);
+            }
+            catch(...)
+            {
+                // Subdirectory tasks the root already posted still reference this scanner
+                pool_->wait(*pending_);
+                throw;
+            }
+            if(!root_ok) error_ = root_error_;
+        }
+        pool_->wait(*pending_);
+        pending_->rethrow_if_failed();
+
+        ec = error_;
+        return std::move(entries_);
+    }
+
+private:
+    void spawn_(std::string relative)
+    {
+        pending_->pending.fetch_add(1, std::memory_order_relaxed);
+        try
+        {
+            pool_->post([this, pending = pending_, relative = std::move(relative)]() noexcept
+            {
+                try
+                {
+                    scan_(relative, nullptr);
+                }
+                catch(...)
+                {
+                    pending->fail(std::current_exception());
+                }
+                pending->done();
+            });
+        }
+        catch(...)
+        {
+            pending_->done();
+            throw;
+        }
+    }
+
+    /// Lists one directory. root_ok is non-null only for the root, whose failure is the caller's error.
+    void scan_(const std::string& relative, bool* root_ok)
+    {
+        std::vector<scan_entry> local;
+        const std::string       prefix = relative.empty() ? std::string() : relative + '/';
+
+        auto emit = [&](std::string_view name, entry_type type) -> scan_entry&
+        {
+            scan_entry& e = local.emplace_back();
+            e.path.reserve(prefix.size() + name.size());
+            e.path.append(prefix).append(name);
+            e.type = type;
+            if(type == entry_type::directory && options_.recursive) spawn_(e.path);
+            return e;
+        };
+
+#if defined(OCU_PLATFORM_WINDOWS)
+        std::wstring pattern = root_;
+        if(!relative.empty()) pattern.append(L"\\").append(utf8_to_wide(relative));
+        pattern.append(L"\\*");
+
+        WIN32_FIND_DATAW data;
+        HANDLE find = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data, FindExSearchNameMatch, nullptr,
+                                       FIND_FIRST_EX_LARGE_FETCH);
+        if(find == INVALID_HANDLE_VALUE)
+        {
+            const DWORD error = GetLastError();
+            if(error != ERROR_FILE_NOT_FOUND) fail_({ static_cast<int>(error), std::system_category() }, root_ok);
+            return;
+        }
+        const scope_exit close_find([find] { FindClose(find); });
+
+        std::string name;
+        do
+        {
+            const wchar_t* n = data.cFileName;
+            if(n[0] == L'.' && (n[1] == L'\0' || (n[1] == L'.' && n[2] == L'\0'))) continue;
+
+            entry_type type = entry_type::file;
+            if(data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) type = entry_type::symlink;
+            else if(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) type = entry_type::directory;
+
+            name.clear();
+            append_utf8(name, n);
+            scan_entry& e = emit(name, type);
+
+            if(options_.stat)
+            {
+                const auto write = (std::uint64_t(data.ftLastWriteTime.dwHighDateTime) << 32)
+                                 | data.ftLastWriteTime.dwLowDateTime;
+                e.mtime = (static_cast<std::int64_t>(write) - 116444736000000000ll) * 100;
+                if(type == entry_type::file)
+                {
+                    e.size = (std::uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+                }
+            }
+        } while(FindNextFileW(find, &data));
+#elif defined(OCU_PLATFORM_POSIX)
+        const int fd = relative.empty()
+            ? ::dup(root_fd_)
+            : ::openat(root_fd_, relative.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW);
+        if(fd < 0) { fail_(last_system_error(), root_ok); return; }
+#   if defined(OCU_PLATFORM_LINUX)
+        const scope_exit close_fd([fd] { ::close(fd); });
+#   endif
+
+        auto visit = [&](const char* n, unsigned char d_type)
+        {
+            if(n[0] == '.' && (n[1] == '\0' || (n[1] == '.' && n[2] == '\0'))) return;
+
+            struct stat st;
+            const bool need_stat = options_.stat || d_type == DT_UNKNOWN;
+            const bool have_stat = need_stat && ::fstatat(fd, n, &st, AT_SYMLINK_NOFOLLOW) == 0;
+
+            entry_type type = entry_type::other;
+            if(have_stat)
+            {
+                if(S_ISREG(st.st_mode))      type = entry_type::file;
+                else if(S_ISDIR(st.st_mode)) type = entry_type::directory;
+                else if(S_ISLNK(st.st_mode)) type = entry_type::symlink;
+            }
+            else
+            {
+                if(d_type == DT_REG)      type = entry_type::file;
+                else if(d_type == DT_DIR) type = entry_type::directory;
+                else if(d_type == DT_LNK) type = entry_type::symlink;
+            }
+
+            scan_entry& e = emit(n, type);
+            if(have_stat && options_.stat)
+            {
+#   if defined(OCU_PLATFORM_APPLE)
+                e.mtime = std::int64_t(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#   else
+                e.mtime = std::int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#   endif
+                if(type == entry_type::file) e.size = static_cast<std::uint64_t>(st.st_size);
+            }
+        };
+
+#   if defined(OCU_PLATFORM_LINUX)
+        // One getdents64 call returns as many entries as fit in the buffer; 64 KiB covers a thousand typical names
+        constexpr std::size_t buffer_size = std::size_t(64) << 10;
+        thread_local std::unique_ptr<std::byte[]> buffer(new std::byte[buffer_size]);
+
+        for(;;)
+        {
+            const long n = ::syscall(SYS_getdents64, fd, buffer.get(), buffer_size);
+            if(n == 0) break;
+            if(n < 0)
+            {
+                if(errno == EINTR) continue;
+                fail_(last_system_error(), root_ok);
+                break;
+            }
+
+            for(long at = 0; at < n;)
+            {
+                const auto* d = reinterpret_cast<const linux_dirent64*>(buffer.get() + at);
+                visit(d->d_name, d->d_type);
+                at += d->d_reclen;
+            }
+        }
+#   else
+        DIR* dir = ::fdopendir(fd);
+        if(dir == nullptr) { fail_(last_system_error(), root_ok); ::close(fd); return; }
+        const scope_exit close_dir([dir] { ::closedir(dir); });
+        while(const dirent* d = ::readdir(dir)) visit(d->d_name, d->d_type);
+#   endif
+#else
+        static_cast<void>(emit);
+        static_cast<void>(root_ok);
+#endif
+
+        if(local.empty()) return;
+        std::lock_guard lock(mutex_);
+        if(entries_.empty())
+        {
+            entries_ = std::move(local);
+        }
+        else
+        {
+            entries_.insert(entries_.end(), std::make_move_iterator(local.begin()),
+                            std::make_move_iterator(local.end()));
+        }
+    }
+
+    void fail_(std::error_code ec, bool* root_ok)
+    {
+        if(root_ok)
+        {
+            *root_ok    = false;
+            root_error_ = ec;
+            return;
+        }
+
+        const bool inaccessible = ec == std::errc::permission_denied || ec == std::errc::no_such_file_or_directory
+                               || ec == std::errc::not_a_directory  || ec == std::errc::too_many_symbolic_link_levels;
+        if(options_.skip_inaccessible && inaccessible) return;
+
+        std::lock_guard lock(mutex_);
+        if(!error_) error_ = ec;
+    }
+
+    scan_options                options_;
+    thread_pool*                pool_;
+    std::shared_ptr<completion> pending_;
+
+#if defined(OCU_PLATFORM_WINDOWS)
+    std::wstring                root_;
+#elif defined(OCU_PLATFORM_POSIX)
+    int                         root_fd_ = -1;
+#endif
+
+    std::mutex                  mutex_;
+    std::vector<scan_entry>     entries_;
+    std::error_code             error_;
+    std::error_code             root_error_;
+};
+
+}
+
+/**
+ * \brief Lists everything below root, in no particular order, with one pool task per directory.
+ *
+ * Linux reads each directory with getdents64 into a 64 KiB buffer and stats entries with fstatat relative to the
+ * open directory, so no path is resolved twice; Windows uses FindFirstFileEx with FIND_FIRST_EX_LARGE_FETCH, which
+ * returns sizes and times with the listing. Symbolic links are reported, never followed. With options.stat off,
+ * entries carry only their path and type and no stat call is made unless the file system does not report types.
+ *
+ * ec is set if root cannot be listed, or, with skip_inaccessible off, to the first error below it; the entries
+ * found are returned either way.
+ */
+[[nodiscard]] inline std::vector<scan_entry> scan_directory(const std::filesystem::path& root,
+                                                            const scan_options& options, std::error_code& ec)
+{
+    ec.clear();
+    detail::directory_scanner scanner(root, options);
+    return scanner.run(ec);
+}
+
+/**
+ * \throws std::system_error if the scan reports an error
+ */
+[[nodiscard]] inline std::vector<scan_entry> scan_directory(const std::filesystem::path& root,
+                                                            const scan_options& options = { })
+{
+    std::error_code ec;
+    auto entries = scan_directory(root, options, ec);
+    if(ec) throw std::system_error(ec, "scan_directory: cannot scan " + root.string());
+    return entries;
+}
+
+// directory_snapshot ==================================================================================================
+
+/**
+ * \brief What changed between a directory_snapshot and a newer scan
+ */
+struct directory_changes
+{
+    std::vector<std::size_t>   added;    ///< Indices into the scan of entries the snapshot does not know
+    std::vector<std::size_t>   modified; ///< Indices into the scan of entries whose size or mtime differ
+    std::vector<std::uint64_t> removed;  ///< Path hashes of snapshot entries missing from the scan
+
+    [[nodiscard]] bool empty() const noexcept { return added.empty() && modified.empty() && removed.empty(); }
+};
+
+/**
+ * \brief Compact record of a scan: the hash of every path with its size and mtime, sorted by hash.
+ *
+ * Saved at the end of one run and loaded at the start of the next, it lets the next scan skip re-examining every
+ * entry that changed() reports as unchanged. The file is a small header followed by the raw records in native byte
+ * order; load rejects files with a different header or a truncated body.
+ */
+class directory_snapshot
+{
+// Typedefs ============================================================================================================
+
+public:
+    struct record
+    {
+        std::uint64_t path_hash;
+        std::int64_t  mtime;
+        std::uint64_t size;
+    };
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors --------------------------------------------------------------------------------------------------------
+
+    directory_snapshot() = default;
+
+    explicit directory_snapshot(std::span<const scan_entry> entries)
+    {
+        records_.reserve(entries.size());
+        for(const scan_entry& e : entries) records_.push_back({ detail::path_hash(e.path), e.mtime, e.size });
+        std::sort(records_.begin(), records_.end(), [](const record& a, const record& b)
+        {
+            return a.path_hash < b.path_hash;
+        });
+    }
+
+// Persistence ---------------------------------------------------------------------------------------------------------
+
+    /**
+     * \throws std::system_error if the file cannot be written
+     */
+    void save(const std::filesystem::path& path) const
+    {
+        header h{ };
+        std::memcpy(h.magic, magic_, sizeof(h.magic));
+        h.count = records_.size();
+
+        std::FILE* f = nullptr;
+#if defined(OCU_PLATFORM_WINDOWS)
+        if(_wfopen_s(&f, path.c_str(), L"wb") != 0) f = nullptr;
+#else
+        f = std::fopen(path.c_str(), "wb");
+#endif
+        if(f == nullptr) throw std::system_error(detail::last_system_error(), "directory_snapshot: cannot write "
+                                                                              + path.string());
+
+        const bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1
+                     && std::fwrite(records_.data(), sizeof(record), records_.size(), f) == records_.size();
+        const bool closed = std::fclose(f) == 0;
+        if(!ok || !closed) throw std::system_error(std::make_error_code(std::errc::io_error),
+                                                   "directory_snapshot: cannot write " + path.string());
+    }
+
+    /**
+     * \brief Reads a snapshot written by save. On failure ec is set and the snapshot is left empty.
+     */
+    void load(const std::filesystem::path& path, std::error_code& ec)
+    {
+        records_.clear();
+
+        mapped_file file(path, ec);
+        if(ec) return;
+
+        header h;
+        if(file.size() < sizeof(h)) { ec = std::make_error_code(std::errc::illegal_byte_sequence); return; }
+        std::memcpy(&h, file.data(), sizeof(h));
+
+        if(std::memcmp(h.magic, magic_, sizeof(h.magic)) != 0 || (file.size() - sizeof(h)) / sizeof(record) != h.count
+           || (file.size() - sizeof(h)) % sizeof(record) != 0)
+        {
+            ec = std::make_error_code(std::errc::illegal_byte_sequence);
+            return;
+        }
+
+        records_.resize(h.count);
+        if(h.count != 0) std::memcpy(records_.data(), file.data() + sizeof(h), h.count * sizeof(record));
+    }
+
+    /**
+     * \throws std::system_error if the file is missing, unreadable or not a snapshot
+     */
+    void load(const std::filesystem::path& path)
+    {
+        std::error_code ec;
+        load(path, ec);
+        if(ec) throw std::system_error(ec, "directory_snapshot: cannot load " + path.string());
+    }
+
+// Queries -------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] std::span<const record> records() const noexcept { return records_; }
+    [[nodiscard]] std::size_t             size()    const noexcept { return records_.size(); }
+    [[nodiscard]] bool                    empty()   const noexcept { return records_.empty(); }
+
+    [[nodiscard]] const record* find(std::string_view path) const noexcept
+    {
+        const std::uint64_t h = detail::path_hash(path);
+        auto it = std::lower_bound(records_.begin(), records_.end(), h, [](const record& r, std::uint64_t v)
+        {
+            return r.path_hash < v;
+        });
+        return it != records_.end() && it->path_hash == h ? &*it : nullptr;
+    }
+
+    /**
+     * \brief True if e is new or its size or mtime differ from the snapshot
+     */
+    [[nodiscard]] bool changed(const scan_entry& e) const noexcept
+    {
+        const record* r = find(e.path);
+        return r == nullptr || r->mtime != e.mtime || r->size != e.size;
+    }
+
+    /**
+     * \brief Classifies every entry of a newer scan against this snapshot
+     */
+    [[nodiscard]] directory_changes diff(std::span<const scan_entry> current) const
+    {
+        directory_changes changes;
+        std::vector<bool> seen(records_.size(), false);
+
+        for(std::size_t i = 0; i < current.size(); ++i)
+        {
+            const record* r = find(current[i].path);
+            if(r == nullptr)
+            {
+                changes.added.push_back(i);
+                continue;
+            }
+
+            seen[static_cast<std::size_t>(r - records_.data())] = true;
+            if(r->mtime != current[i].mtime || r->size != current[i].size) changes.modified.push_back(i);
+        }
+
+        for(std::size_t i = 0; i < records_.size(); ++i)
+        {
+            if(!seen[i]) changes.removed.push_back(records_[i].path_hash);
+        }
+        return changes;
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    struct header
+    {
+        char          magic[8];
+        std::uint64_t count;
+    };
+
+    static constexpr char magic_[8] = { 'O', 'C', 'U', 'S', 'N', 'A', 'P', '1' };
+
+    std::vector<record> records_;
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_FILESYSTEM_H
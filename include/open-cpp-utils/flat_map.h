@@ -0,0 +1,1179 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_FLAT_MAP_H
+#define OPEN_CPP_UTILS_FLAT_MAP_H
+
+#include "config.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__) && defined(OCU_ARCH_X86)
+#   include <intrin.h>
+#endif
+
+namespace open_cpp_utils
+{
+
+/**
+ * \brief Tag asserting that a range is sorted by the container's comparator and free of duplicate keys
+ */
+struct sorted_unique_t { explicit sorted_unique_t() = default; };
+inline constexpr sorted_unique_t sorted_unique{ };
+
+namespace detail
+{
+
+template<typename C>
+inline constexpr bool transparent_compare_v = requires { typename C::is_transparent; };
+
+OCU_FORCEINLINE void prefetch_read(const void* p) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p, 0, 3);
+#elif defined(_MSC_VER) && defined(OCU_ARCH_X86)
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+    static_cast<void>(p);
+#endif
+}
+
+/**
+ * \brief lower_bound over a sorted array whose loop body is a conditional move rather than a branch.
+ *
+ * Every lookup runs exactly ceil(log2(n)) iterations, so the loop is never mispredicted. Each iteration prefetches
+ * both possible next midpoints, which overlaps the cache misses of consecutive levels on arrays that do not fit in
+ * cache and costs little more than two hits on those that do.
+ */
+template<typename T, typename Q, typename Compare>
+[[nodiscard]] OCU_FORCEINLINE std::size_t branchless_lower_bound(const T* data, std::size_t n, const Q& key,
+                                                                 const Compare& comp)
+{
+    if(n == 0) return 0;
+
+    const T* base = data;
+    while(n > 1)
+    {
+        const std::size_t half = n / 2;
+        prefetch_read(base + half / 2);
+        prefetch_read(base + half + half / 2);
+        base = comp(base[half], key) ? base + half : base;
+        n -= half;
+    }
+    return static_cast<std::size_t>(base - data) + static_cast<std::size_t>(comp(*base, key));
+}
+
+template<typename T, typename Q, typename Compare>
+[[nodiscard]] OCU_FORCEINLINE std::size_t branchless_upper_bound(const T* data, std::size_t n, const Q& key,
+                                                                 const Compare& comp)
+{
+    if(n == 0) return 0;
+
+    const T* base = data;
+    while(n > 1)
+    {
+        const std::size_t half = n / 2;
+        base = comp(key, base[half]) ? base : base + half;
+        n -= half;
+    }
+    return static_cast<std::size_t>(base - data) + static_cast<std::size_t>(!comp(key, *base));
+}
+
+/**
+ * \brief Copy of a sorted key array in Eytzinger (breadth-first) order.
+ *
+ * The top levels of the implicit tree share a handful of cache lines, and the children of node k sit at 2k and
+ * 2k + 1, so a search can prefetch the whole block of descendants several levels down in one cache line. For tables
+ * much larger than the cache this beats binary search on the sorted array, whose probes are each a separate miss.
+ * The sorted position of a node follows from its index, so the copy holds nothing but keys.
+ */
+template<typename K>
+class eytzinger_index
+{
+public:
+    eytzinger_index() = default;
+
+    eytzinger_index(const eytzinger_index& other) { *this = other; }
+
+    eytzinger_index& operator=(const eytzinger_index& other)
+    {
+        if(this != &other)
+        {
+            storage_ = other.storage_;
+            n_       = other.n_;
+            keys_    = other.keys_ ? storage_.data() + (other.keys_ - other.storage_.data()) : nullptr;
+        }
+        return *this;
+    }
+
+    eytzinger_index(eytzinger_index&& other) noexcept { swap(other); }
+
+    eytzinger_index& operator=(eytzinger_index&& other) noexcept
+    {
+        eytzinger_index(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(eytzinger_index& other) noexcept
+    {
+        storage_.swap(other.storage_);
+        std::swap(keys_, other.keys_);
+        std::swap(n_, other.n_);
+    }
+
+    friend void swap(eytzinger_index& a, eytzinger_index& b) noexcept { a.swap(b); }
+
+    [[nodiscard]] bool empty() const noexcept { return keys_ == nullptr; }
+
+    void clear() noexcept
+    {
+        storage_.clear();
+        keys_ = nullptr;
+        n_    = 0;
+    }
+
+    void build(const K* sorted, std::size_t n)
+    {
+        clear();
+        if(n == 0) return;
+
+        // Node 0 is unused; padding lets keys_[0] start a cache line so each block of per_line_ siblings is one line
+        storage_.assign(n + 1 + per_line_, sorted[0]);
+        keys_ = storage_.data();
+        if constexpr(64 % sizeof(K) == 0)
+        {
+            const std::size_t misalign = reinterpret_cast<std::uintptr_t>(keys_) % 64;
+            if(misalign % sizeof(K) == 0 && misalign != 0) keys_ += (64 - misalign) / sizeof(K);
+        }
+        n_ = n;
+
+        std::size_t next = 0;
+        build_(sorted, 1, next);
+    }
+
+    /**
+     * \return Sorted position of the first key not less than key, or n if there is none
+     */
+    template<typename Q, typename Compare>
+    [[nodiscard]] OCU_FORCEINLINE std::size_t lower_bound(const Q& key, const Compare& comp) const
+    {
+        const std::size_t k = node_(key, comp);
+        return k == 0 ? n_ : rank_(k);
+    }
+
+    /**
+     * \return Sorted position of key, or n if it is absent. Compares against the node the search ended on, which is
+     *         already in cache, rather than the sorted array.
+     */
+    template<typename Q, typename Compare>
+    [[nodiscard]] OCU_FORCEINLINE std::size_t find(const Q& key, const Compare& comp) const
+    {
+        const std::size_t k = node_(key, comp);
+        return k == 0 || comp(key, keys_[k]) ? n_ : rank_(k);
+    }
+
+    [[nodiscard]] std::size_t memory_usage() const noexcept { return storage_.capacity() * sizeof(K); }
+
+private:
+    static constexpr std::size_t per_line_ = sizeof(K) >= 64 ? 1 : 64 / sizeof(K);
+
+    /// Node holding the first key not less than key, or 0 if there is none
+    template<typename Q, typename Compare>
+    OCU_FORCEINLINE std::size_t node_(const Q& key, const Compare& comp) const
+    {
+        const K* keys = keys_;
+
+        std::size_t k = 1;
+        while(k <= n_)
+        {
+            // The descendants of k log2(per_line_) levels down are the per_line_ keys from k * per_line_. The
+            // address is only a hint, so it is formed without the bounds an actual access would need.
+            prefetch_read(reinterpret_cast<const void*>(reinterpret_cast<std::uintptr_t>(keys)
+                                                        + k * per_line_ * sizeof(K)));
+            k = 2 * k + static_cast<std::size_t>(comp(keys[k], key));
+        }
+
+        // The right turns since the last left turn are trailing ones; shifting them and that left turn out leaves
+        // the node where the search last went left, which holds the answer. All right turns leave 0: not found.
+        return k >> (std::countr_one(k) + 1);
+    }
+
+    void build_(const K* sorted, std::size_t k, std::size_t& next)
+    {
+        if(k > n_) return;
+        build_(sorted, 2 * k, next);
+        keys_[k] = sorted[next++];
+        build_(sorted, 2 * k + 1, next);
+    }
+
+    /**
+     * \brief In-order position of node k. In the perfect tree one level deeper than the last full level, node k at
+     *        depth d has position (2 (k - 2^d) + 1) 2^(h - d) - 1; the bottom level occupies the even positions, so
+     *        subtracting the absent bottom nodes that precede it gives its rank among the n real nodes.
+     */
+    [[nodiscard]] OCU_FORCEINLINE std::size_t rank_(std::size_t k) const noexcept
+    {
+        const int         h       = std::bit_width(n_) - 1;
+        const int         d       = std::bit_width(k) - 1;
+        const std::size_t present = n_ - ((std::size_t(1) << h) - 1);
+        const std::size_t p       = ((2 * (k - (std::size_t(1) << d)) + 1) << (h - d)) - 1;
+        const std::size_t before  = (p + 1) / 2;
+        return p - (before > present ? before - present : 0);
+    }
+
+    std::vector<K> storage_;
+    K*             keys_ = nullptr;
+    std::size_t    n_    = 0;
+};
+
+}
+
+// flat_map ============================================================================================================
+
+/**
+ * \brief Sorted associative container with keys and values in two separate contiguous arrays.
+ *
+ * Lookups binary search the key array alone, so a probe touches only keys and the values of misses are never pulled
+ * into cache. Memory is the two arrays and nothing else: no per-node allocation, pointers or colour bits, which is
+ * roughly a third of std::map for small keys and values.
+ *
+ * Single inserts and erases shift the tail of both arrays and cost O(n); build tables with insert_range, which sorts
+ * the incoming batch and merges it with the existing contents in one linear pass. For large read-mostly tables,
+ * build_search_index() adds an Eytzinger-ordered copy of the keys that lookups use until the next modification.
+ *
+ * Iterators are random access and dereference to std::pair<const K&, V&> proxies, as with std::flat_map. Any
+ * modification invalidates all iterators. KeyContainer must be contiguous; building the search index copies keys.
+ */
+template<typename K, typename V,
+         typename Compare         = std::less<K>,
+         typename KeyContainer    = std::vector<K>,
+         typename MappedContainer = std::vector<V>>
+class flat_map
+{
+    static_assert(std::ranges::contiguous_range<KeyContainer>, "flat_map searches the key array through a pointer");
+
+// Typedefs ============================================================================================================
+
+public:
+    using key_type               = K;
+    using mapped_type            = V;
+    using value_type             = std::pair<K, V>;
+    using key_compare            = Compare;
+    using reference              = std::pair<const K&, V&>;
+    using const_reference        = std::pair<const K&, const V&>;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using key_container_type     = KeyContainer;
+    using mapped_container_type  = MappedContainer;
+
+    struct containers
+    {
+        KeyContainer    keys;
+        MappedContainer values;
+    };
+
+private:
+    template<bool Const>
+    class iterator_impl
+    {
+        using mapped_ptr = std::conditional_t<Const, const V*, V*>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using iterator_concept  = std::random_access_iterator_tag;
+        using value_type        = flat_map::value_type;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = std::conditional_t<Const, flat_map::const_reference, flat_map::reference>;
+
+        struct pointer
+        {
+            reference  ref;
+            reference* operator->() noexcept { return &ref; }
+        };
+
+        iterator_impl() noexcept = default;
+        iterator_impl(const K* key, mapped_ptr value) noexcept : key_(key), value_(value) { }
+
+        // iterator -> const_iterator
+        template<bool C = Const, typename = std::enable_if_t<C>>
+        iterator_impl(const iterator_impl<false>& other) noexcept : key_(other.key_), value_(other.value_) { }
+
+        reference operator*()  const noexcept { return { *key_, *value_ }; }
+        pointer   operator->() const noexcept { return { **this }; }
+        reference operator[](difference_type n) const noexcept { return { key_[n], value_[n] }; }
+
+        iterator_impl& operator++() noexcept { ++key_; ++value_; return *this; }
+        iterator_impl& operator--() noexcept { --key_; --value_; return *this; }
+        iterator_impl  operator++(int) noexcept { iterator_impl t = *this; ++*this; return t; }
+        iterator_impl  operator--(int) noexcept { iterator_impl t = *this; --*this; return t; }
+
+        iterator_impl& operator+=(difference_type n) noexcept { key_ += n; value_ += n; return *this; }
+        iterator_impl& operator-=(difference_type n) noexcept { key_ -= n; value_ -= n; return *this; }
+
+        friend iterator_impl operator+(iterator_impl it, difference_type n) noexcept { return it += n; }
+        friend iterator_impl operator+(difference_type n, iterator_impl it) noexcept { return it += n; }
+        friend iterator_impl operator-(iterator_impl it, difference_type n) noexcept { return it -= n; }
+
+        friend difference_type operator-(const iterator_impl& a, const iterator_impl& b) noexcept
+        {
+            return a.key_ - b.key_;
+        }
+
+        friend bool operator==(const iterator_impl& a, const iterator_impl& b) noexcept { return a.key_ == b.key_; }
+        friend auto operator<=>(const iterator_impl& a, const iterator_impl& b) noexcept { return a.key_ <=> b.key_; }
+
+    private:
+        friend class flat_map;
+        template<bool> friend class iterator_impl;
+
+        const K*   key_   = nullptr;
+        mapped_ptr value_ = nullptr;
+    };
+
+    static constexpr bool transparent_ = detail::transparent_compare_v<Compare>;
+
+public:
+    using iterator               = iterator_impl<false>;
+    using const_iterator         = iterator_impl<true>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors --------------------------------------------------------------------------------------------------------
+
+    flat_map() = default;
+
+    explicit flat_map(const Compare& comp) : comp_(comp) { }
+
+    /**
+     * \brief Adopts two parallel arrays, sorting them by key and keeping the first of any duplicate keys
+     */
+    flat_map(KeyContainer keys, MappedContainer values, const Compare& comp = Compare())
+        : comp_(comp)
+    {
+        if(keys.size() != values.size()) throw std::invalid_argument("flat_map: key and value counts differ");
+
+        std::vector<value_type> pairs;
+        pairs.reserve(keys.size());
+        for(size_type i = 0; i < keys.size(); ++i) pairs.emplace_back(std::move(keys[i]), std::move(values[i]));
+        sort_unique_(pairs);
+        merge_(pairs);
+    }
+
+    /**
+     * \brief Adopts two parallel arrays already sorted by key without duplicates, without copying them
+     */
+    flat_map(sorted_unique_t, KeyContainer keys, MappedContainer values, const Compare& comp = Compare())
+        : keys_(std::move(keys))
+        , values_(std::move(values))
+        , comp_(comp)
+    {
+        if(keys_.size() != values_.size()) throw std::invalid_argument("flat_map: key and value counts differ");
+        OCU_ASSERT(is_sorted_unique_(), "flat_map: sorted_unique keys are not sorted and unique");
+    }
+
+    template<typename InputIt>
+    flat_map(InputIt first, InputIt last, const Compare& comp = Compare())
+        : comp_(comp)
+    {
+        insert(first, last);
+    }
+
+    flat_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
+        : comp_(comp)
+    {
+        insert(ilist.begin(), ilist.end());
+    }
+
+// Iterators -----------------------------------------------------------------------------------------------------------
+
+    iterator begin() noexcept { return { keys_.data(), values_.data() }; }
+    iterator end()   noexcept { return begin() + static_cast<difference_type>(size()); }
+
+    const_iterator begin()  const noexcept { return { keys_.data(), values_.data() }; }
+    const_iterator end()    const noexcept { return begin() + static_cast<difference_type>(size()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend()   const noexcept { return end(); }
+
+    reverse_iterator       rbegin()       noexcept { return reverse_iterator(end()); }
+    reverse_iterator       rend()         noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend()   const noexcept { return const_reverse_iterator(begin()); }
+
+// Capacity ------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] bool      empty()    const noexcept { return keys_.empty(); }
+    [[nodiscard]] size_type size()     const noexcept { return keys_.size(); }
+    [[nodiscard]] size_type max_size() const noexcept { return std::min(keys_.max_size(), values_.max_size()); }
+
+    void reserve(size_type count)
+    {
+        keys_.reserve(count);
+        values_.reserve(count);
+    }
+
+    void shrink_to_fit()
+    {
+        keys_.shrink_to_fit();
+        values_.shrink_to_fit();
+    }
+
+    /**
+     * \brief Bytes held by the key array, the value array and the search index
+     */
+    [[nodiscard]] size_type memory_usage() const noexcept
+    {
+        return keys_.capacity() * sizeof(K) + values_.capacity() * sizeof(V) + index_.memory_usage();
+    }
+
+// Element Access ------------------------------------------------------------------------------------------------------
+
+    V& operator[](const key_type& key) { return try_emplace(key).first->second; }
+    V& operator[](key_type&& key)      { return try_emplace(std::move(key)).first->second; }
+
+    /**
+     * \throws std::out_of_range if key is not present
+     */
+    V& at(const key_type& key)
+    {
+        const size_type i = find_index_(key);
+        if(i == size()) throw std::out_of_range("flat_map::at key not found");
+        return values_[i];
+    }
+
+    const V& at(const key_type& key) const { return const_cast<flat_map*>(this)->at(key); }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    template<typename...Args>
+    std::pair<iterator, bool> emplace(Args&&...args)
+    {
+        value_type v(std::forward<Args>(args)...);
+        return try_emplace(std::move(v.first), std::move(v.second));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) { return try_emplace(value.first, value.second); }
+    std::pair<iterator, bool> insert(value_type&& value)
+    {
+        return try_emplace(std::move(value.first), std::move(value.second));
+    }
+
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        insert_range(std::ranges::subrange(first, last));
+    }
+
+    void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+    /**
+     * \brief Inserts every element of range whose key is not present yet (the first wins among duplicates).
+     *
+     * The batch is sorted on its own and then merged with the existing arrays in a single linear pass, so
+     * inserting m elements into n costs O(m log m + n + m) instead of the O(m * n) of m single inserts.
+     */
+    template<std::ranges::input_range R>
+    void insert_range(R&& range)
+    {
+        std::vector<value_type> pairs;
+        if constexpr(std::ranges::sized_range<R>) pairs.reserve(std::ranges::size(range));
+        for(auto&& e : range) pairs.emplace_back(std::forward<decltype(e)>(e));
+        sort_unique_(pairs);
+        merge_(pairs);
+    }
+
+    /**
+     * \brief As insert_range, for a range already sorted by key without duplicates, which skips the sort
+     */
+    template<std::ranges::input_range R>
+    void insert_range(sorted_unique_t, R&& range)
+    {
+        std::vector<value_type> pairs;
+        if constexpr(std::ranges::sized_range<R>) pairs.reserve(std::ranges::size(range));
+        for(auto&& e : range) pairs.emplace_back(std::forward<decltype(e)>(e));
+        OCU_ASSERT(std::adjacent_find(pairs.begin(), pairs.end(), [this](const value_type& a, const value_type& b)
+        {
+            return !comp_(a.first, b.first);
+        }) == pairs.end(), "flat_map: sorted_unique range is not sorted and unique");
+        merge_(pairs);
+    }
+
+    template<typename...Args>
+    std::pair<iterator, bool> try_emplace(const key_type& key, Args&&...args)
+    {
+        return try_emplace_(key, std::forward<Args>(args)...);
+    }
+
+    template<typename...Args>
+    std::pair<iterator, bool> try_emplace(key_type&& key, Args&&...args)
+    {
+        return try_emplace_(std::move(key), std::forward<Args>(args)...);
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj)
+    {
+        auto result = try_emplace(key, std::forward<M>(obj));
+        if(!result.second) result.first->second = std::forward<M>(obj);
+        return result;
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(key_type&& key, M&& obj)
+    {
+        auto result = try_emplace(std::move(key), std::forward<M>(obj));
+        if(!result.second) result.first->second = std::forward<M>(obj);
+        return result;
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return erase(pos, std::next(pos));
+    }
+
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        index_.clear();
+        const auto from = first.key_ - keys_.data();
+        const auto to   = last.key_ - keys_.data();
+        keys_.erase(keys_.begin() + from, keys_.begin() + to);
+        values_.erase(values_.begin() + from, values_.begin() + to);
+        return begin() + from;
+    }
+
+    size_type erase(const key_type& key)
+    {
+        const size_type i = find_index_(key);
+        if(i == size()) return 0;
+        erase(begin() + static_cast<difference_type>(i));
+        return 1;
+    }
+
+    template<typename Q>
+        requires transparent_ && (!std::is_convertible_v<Q&&, const_iterator>)
+    size_type erase(const Q& key)
+    {
+        const size_type i = find_index_(key);
+        if(i == size()) return 0;
+        erase(begin() + static_cast<difference_type>(i));
+        return 1;
+    }
+
+    void clear() noexcept
+    {
+        keys_.clear();
+        values_.clear();
+        index_.clear();
+    }
+
+    void swap(flat_map& other) noexcept
+    {
+        using std::swap;
+        swap(keys_, other.keys_);
+        swap(values_, other.values_);
+        swap(comp_, other.comp_);
+        swap(index_, other.index_);
+    }
+
+    friend void swap(flat_map& a, flat_map& b) noexcept { a.swap(b); }
+
+    /**
+     * \brief Moves both arrays out, leaving the map empty
+     */
+    containers extract() &&
+    {
+        containers c{ std::move(keys_), std::move(values_) };
+        clear();
+        return c;
+    }
+
+    /**
+     * \brief Adopts arrays already sorted by key without duplicates
+     */
+    void replace(KeyContainer keys, MappedContainer values)
+    {
+        if(keys.size() != values.size()) throw std::invalid_argument("flat_map: key and value counts differ");
+        index_.clear();
+        keys_   = std::move(keys);
+        values_ = std::move(values);
+        OCU_ASSERT(is_sorted_unique_(), "flat_map: replaced keys are not sorted and unique");
+    }
+
+// Search Index --------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Builds the Eytzinger-ordered key copy that find, contains, count, at and lower_bound use from now on.
+     *        Any modification discards it; rebuild after the next batch of inserts. Costs one extra key array.
+     */
+    void build_search_index() { index_.build(keys_.data(), keys_.size()); }
+
+    [[nodiscard]] bool has_search_index() const noexcept { return !index_.empty(); }
+
+    void clear_search_index() noexcept { index_.clear(); }
+
+// Lookup --------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] iterator       find(const key_type& key)       { return begin() + diff_(find_index_(key)); }
+    [[nodiscard]] const_iterator find(const key_type& key) const { return begin() + diff_(find_index_(key)); }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] iterator find(const Q& key) { return begin() + diff_(find_index_(key)); }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] const_iterator find(const Q& key) const { return begin() + diff_(find_index_(key)); }
+
+    [[nodiscard]] bool contains(const key_type& key) const { return find_index_(key) != size(); }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] bool contains(const Q& key) const { return find_index_(key) != size(); }
+
+    [[nodiscard]] size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] size_type count(const Q& key) const { return contains(key) ? 1 : 0; }
+
+    [[nodiscard]] iterator       lower_bound(const key_type& key)       { return begin() + diff_(lower_(key)); }
+    [[nodiscard]] const_iterator lower_bound(const key_type& key) const { return begin() + diff_(lower_(key)); }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] iterator lower_bound(const Q& key) { return begin() + diff_(lower_(key)); }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] const_iterator lower_bound(const Q& key) const { return begin() + diff_(lower_(key)); }
+
+    [[nodiscard]] iterator       upper_bound(const key_type& key)       { return begin() + diff_(upper_(key)); }
+    [[nodiscard]] const_iterator upper_bound(const key_type& key) const { return begin() + diff_(upper_(key)); }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] iterator upper_bound(const Q& key) { return begin() + diff_(upper_(key)); }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] const_iterator upper_bound(const Q& key) const { return begin() + diff_(upper_(key)); }
+
+    [[nodiscard]] std::pair<iterator, iterator> equal_range(const key_type& key)
+    {
+        const size_type i = find_index_(key);
+        if(i == size()) { auto it = lower_bound(key); return { it, it }; }
+        return { begin() + diff_(i), begin() + diff_(i + 1) };
+    }
+
+    [[nodiscard]] std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+    {
+        auto r = const_cast<flat_map*>(this)->equal_range(key);
+        return { r.first, r.second };
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] key_compare            key_comp() const { return comp_; }
+    [[nodiscard]] const KeyContainer&    keys()     const noexcept { return keys_; }
+    [[nodiscard]] const MappedContainer& values()   const noexcept { return values_; }
+
+    friend bool operator==(const flat_map& a, const flat_map& b)
+    {
+        return a.keys_ == b.keys_ && a.values_ == b.values_;
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    static difference_type diff_(size_type i) noexcept { return static_cast<difference_type>(i); }
+
+    template<typename Q>
+    size_type lower_(const Q& key) const
+    {
+        if(!index_.empty()) return index_.lower_bound(key, comp_);
+        return detail::branchless_lower_bound(keys_.data(), keys_.size(), key, comp_);
+    }
+
+    template<typename Q>
+    size_type upper_(const Q& key) const
+    {
+        return detail::branchless_upper_bound(keys_.data(), keys_.size(), key, comp_);
+    }
+
+    /// Index of key, or size() if absent
+    template<typename Q>
+    size_type find_index_(const Q& key) const
+    {
+        if(!index_.empty()) return index_.find(key, comp_);
+        const size_type i = lower_(key);
+        return i != size() && !comp_(key, keys_[i]) ? i : size();
+    }
+
+    template<typename KeyArg, typename...Args>
+    std::pair<iterator, bool> try_emplace_(KeyArg&& key, Args&&...args)
+    {
+        const size_type i = lower_(key);
+        if(i != size() && !comp_(key, keys_[i])) return { begin() + diff_(i), false };
+
+        index_.clear();
+        keys_.insert(keys_.begin() + diff_(i), std::forward<KeyArg>(key));
+        try
+        {
+            values_.emplace(values_.begin() + diff_(i), std::forward<Args>(args)...);
+        }
+        catch(...)
+        {
+            keys_.erase(keys_.begin() + diff_(i));
+            throw;
+        }
+        return { begin() + diff_(i), true };
+    }
+
+    void sort_unique_(std::vector<value_type>& pairs) const
+    {
+        auto by_key = [this](const value_type& a, const value_type& b) { return comp_(a.first, b.first); };
+        std::stable_sort(pairs.begin(), pairs.end(), by_key);
+        auto last = std::unique(pairs.begin(), pairs.end(), [this](const value_type& a, const value_type& b)
+        {
+            return !comp_(a.first, b.first);
+        });
+        pairs.erase(last, pairs.end());
+    }
+
+    /**
+     * \brief Merges sorted, unique pairs into the arrays; pairs whose key is already present are dropped.
+     *
+     * The arrays are rebuilt on the side and swapped in at the end. Every comparison happens in a first pass that
+     * only records where each new pair goes, so the existing elements are moved out only when nothing after that can
+     * throw and copied otherwise; if anything throws, the map is left as it was.
+     */
+    void merge_(std::vector<value_type>& pairs)
+    {
+        if(pairs.empty()) return;
+
+        KeyContainer    keys;
+        MappedContainer values;
+        keys.reserve(keys_.size() + pairs.size());
+        values.reserve(values_.size() + pairs.size());
+
+        if(keys_.empty())
+        {
+            for(auto& p : pairs)
+            {
+                keys.push_back(std::move(p.first));
+                values.push_back(std::move(p.second));
+            }
+        }
+        else
+        {
+            constexpr size_type dropped = static_cast<size_type>(-1);
+
+            std::vector<size_type> at;
+            at.reserve(pairs.size());
+            size_type i = 0;
+            for(const auto& p : pairs)
+            {
+                while(i < keys_.size() && comp_(keys_[i], p.first)) ++i;
+                at.push_back(i < keys_.size() && !comp_(p.first, keys_[i]) ? dropped : i);
+            }
+
+            auto take = [&](size_type from)
+            {
+                if constexpr(std::is_nothrow_move_constructible_v<K> && std::is_nothrow_move_constructible_v<V>)
+                {
+                    keys.push_back(std::move(keys_[from]));
+                    values.push_back(std::move(values_[from]));
+                }
+                else
+                {
+                    keys.push_back(keys_[from]);
+                    values.push_back(values_[from]);
+                }
+            };
+
+            i = 0;
+            for(size_type j = 0; j < pairs.size(); ++j)
+            {
+                if(at[j] == dropped) continue;
+                for(; i < at[j]; ++i) take(i);
+                keys.push_back(std::move(pairs[j].first));
+                values.push_back(std::move(pairs[j].second));
+            }
+            for(; i < keys_.size(); ++i) take(i);
+        }
+
+        index_.clear();
+        keys_.swap(keys);
+        values_.swap(values);
+    }
+
+    bool is_sorted_unique_() const
+    {
+        return std::adjacent_find(keys_.begin(), keys_.end(), [this](const K& a, const K& b)
+        {
+            return !comp_(a, b);
+        }) == keys_.end();
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    KeyContainer                       keys_;
+    MappedContainer                    values_;
+    OCU_NO_UNIQUE_ADDRESS Compare      comp_;
+    detail::eytzinger_index<K>         index_;
+};
+
+// flat_set ============================================================================================================
+
+/**
+ * \brief Sorted set over one contiguous array. See flat_map for the costs of the operations and the search index.
+ */
+template<typename K, typename Compare = std::less<K>, typename KeyContainer = std::vector<K>>
+class flat_set
+{
+    static_assert(std::ranges::contiguous_range<KeyContainer>, "flat_set searches the key array through a pointer");
+
+// Typedefs ============================================================================================================
+
+public:
+    using key_type               = K;
+    using value_type             = K;
+    using key_compare            = Compare;
+    using value_compare          = Compare;
+    using reference              = const K&;
+    using const_reference        = const K&;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using container_type         = KeyContainer;
+    using iterator               = typename KeyContainer::const_iterator;
+    using const_iterator         = typename KeyContainer::const_iterator;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+    static constexpr bool transparent_ = detail::transparent_compare_v<Compare>;
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors --------------------------------------------------------------------------------------------------------
+
+    flat_set() = default;
+
+    explicit flat_set(const Compare& comp) : comp_(comp) { }
+
+    explicit flat_set(KeyContainer keys, const Compare& comp = Compare())
+        : comp_(comp)
+    {
+        sort_unique_(keys);
+        merge_(keys);
+    }
+
+    flat_set(sorted_unique_t, KeyContainer keys, const Compare& comp = Compare())
+        : keys_(std::move(keys))
+        , comp_(comp)
+    {
+        OCU_ASSERT(is_sorted_unique_(keys_), "flat_set: sorted_unique keys are not sorted and unique");
+    }
+
+    template<typename InputIt>
+    flat_set(InputIt first, InputIt last, const Compare& comp = Compare())
+        : comp_(comp)
+    {
+        insert(first, last);
+    }
+
+    flat_set(std::initializer_list<K> ilist, const Compare& comp = Compare())
+        : comp_(comp)
+    {
+        insert(ilist.begin(), ilist.end());
+    }
+
+// Iterators -----------------------------------------------------------------------------------------------------------
+
+    const_iterator begin()  const noexcept { return keys_.begin(); }
+    const_iterator end()    const noexcept { return keys_.end(); }
+    const_iterator cbegin() const noexcept { return keys_.begin(); }
+    const_iterator cend()   const noexcept { return keys_.end(); }
+
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend()   const noexcept { return const_reverse_iterator(begin()); }
+
+// Capacity ------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] bool      empty()    const noexcept { return keys_.empty(); }
+    [[nodiscard]] size_type size()     const noexcept { return keys_.size(); }
+    [[nodiscard]] size_type max_size() const noexcept { return keys_.max_size(); }
+
+    void reserve(size_type count) { keys_.reserve(count); }
+    void shrink_to_fit()          { keys_.shrink_to_fit(); }
+
+    [[nodiscard]] size_type memory_usage() const noexcept
+    {
+        return keys_.capacity() * sizeof(K) + index_.memory_usage();
+    }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    template<typename...Args>
+    std::pair<iterator, bool> emplace(Args&&...args)
+    {
+        return insert(K(std::forward<Args>(args)...));
+    }
+
+    std::pair<iterator, bool> insert(const K& key) { return insert_(key); }
+    std::pair<iterator, bool> insert(K&& key)      { return insert_(std::move(key)); }
+
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        insert_range(std::ranges::subrange(first, last));
+    }
+
+    void insert(std::initializer_list<K> ilist) { insert(ilist.begin(), ilist.end()); }
+
+    /**
+     * \brief Sorts the batch and merges it with the existing keys in one pass; see flat_map::insert_range
+     */
+    template<std::ranges::input_range R>
+    void insert_range(R&& range)
+    {
+        KeyContainer keys;
+        if constexpr(std::ranges::sized_range<R>) keys.reserve(std::ranges::size(range));
+        for(auto&& e : range) keys.emplace_back(std::forward<decltype(e)>(e));
+        sort_unique_(keys);
+        merge_(keys);
+    }
+
+    template<std::ranges::input_range R>
+    void insert_range(sorted_unique_t, R&& range)
+    {
+        KeyContainer keys;
+        if constexpr(std::ranges::sized_range<R>) keys.reserve(std::ranges::size(range));
+        for(auto&& e : range) keys.emplace_back(std::forward<decltype(e)>(e));
+        OCU_ASSERT(is_sorted_unique_(keys), "flat_set: sorted_unique range is not sorted and unique");
+        merge_(keys);
+    }
+
+    iterator erase(const_iterator pos) { index_.clear(); return keys_.erase(pos); }
+
+    iterator erase(const_iterator first, const_iterator last) { index_.clear(); return keys_.erase(first, last); }
+
+    size_type erase(const K& key)
+    {
+        const size_type i = find_index_(key);
+        if(i == size()) return 0;
+        erase(begin() + static_cast<difference_type>(i));
+        return 1;
+    }
+
+    template<typename Q>
+        requires transparent_ && (!std::is_convertible_v<Q&&, const_iterator>)
+    size_type erase(const Q& key)
+    {
+        const size_type i = find_index_(key);
+        if(i == size()) return 0;
+        erase(begin() + static_cast<difference_type>(i));
+        return 1;
+    }
+
+    void clear() noexcept
+    {
+        keys_.clear();
+        index_.clear();
+    }
+
+    void swap(flat_set& other) noexcept
+    {
+        using std::swap;
+        swap(keys_, other.keys_);
+        swap(comp_, other.comp_);
+        swap(index_, other.index_);
+    }
+
+    friend void swap(flat_set& a, flat_set& b) noexcept { a.swap(b); }
+
+    KeyContainer extract() &&
+    {
+        KeyContainer keys = std::move(keys_);
+        clear();
+        return keys;
+    }
+
+    void replace(KeyContainer keys)
+    {
+        index_.clear();
+        keys_ = std::move(keys);
+        OCU_ASSERT(is_sorted_unique_(keys_), "flat_set: replaced keys are not sorted and unique");
+    }
+
+// Search Index --------------------------------------------------------------------------------------------------------
+
+    /// See flat_map::build_search_index
+    void build_search_index() { index_.build(keys_.data(), keys_.size()); }
+
+    [[nodiscard]] bool has_search_index() const noexcept { return !index_.empty(); }
+
+    void clear_search_index() noexcept { index_.clear(); }
+
+// Lookup --------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] const_iterator find(const K& key) const { return begin() + diff_(find_index_(key)); }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] const_iterator find(const Q& key) const { return begin() + diff_(find_index_(key)); }
+
+    [[nodiscard]] bool contains(const K& key) const { return find_index_(key) != size(); }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] bool contains(const Q& key) const { return find_index_(key) != size(); }
+
+    [[nodiscard]] size_type count(const K& key) const { return contains(key) ? 1 : 0; }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] size_type count(const Q& key) const { return contains(key) ? 1 : 0; }
+
+    [[nodiscard]] const_iterator lower_bound(const K& key) const { return begin() + diff_(lower_(key)); }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] const_iterator lower_bound(const Q& key) const { return begin() + diff_(lower_(key)); }
+
+    [[nodiscard]] const_iterator upper_bound(const K& key) const
+    {
+        return begin() + diff_(detail::branchless_upper_bound(keys_.data(), keys_.size(), key, comp_));
+    }
+
+    template<typename Q> requires transparent_
+    [[nodiscard]] const_iterator upper_bound(const Q& key) const
+    {
+        return begin() + diff_(detail::branchless_upper_bound(keys_.data(), keys_.size(), key, comp_));
+    }
+
+    [[nodiscard]] std::pair<const_iterator, const_iterator> equal_range(const K& key) const
+    {
+        const const_iterator it = lower_bound(key);
+        if(it == end() || comp_(key, *it)) return { it, it };
+        return { it, std::next(it) };
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] key_compare         key_comp()   const { return comp_; }
+    [[nodiscard]] value_compare       value_comp() const { return comp_; }
+    [[nodiscard]] const KeyContainer& keys()       const noexcept { return keys_; }
+
+    friend bool operator==(const flat_set& a, const flat_set& b) { return a.keys_ == b.keys_; }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    static difference_type diff_(size_type i) noexcept { return static_cast<difference_type>(i); }
+
+    template<typename Q>
+    size_type lower_(const Q& key) const
+    {
+        if(!index_.empty()) return index_.lower_bound(key, comp_);
+        return detail::branchless_lower_bound(keys_.data(), keys_.size(), key, comp_);
+    }
+
+    template<typename Q>
+    size_type find_index_(const Q& key) const
+    {
+        if(!index_.empty()) return index_.find(key, comp_);
+        const size_type i = lower_(key);
+        return i != size() && !comp_(key, keys_[i]) ? i : size();
+    }
+
+    template<typename KeyArg>
+    std::pair<iterator, bool> insert_(KeyArg&& key)
+    {
+        const size_type i = lower_(key);
+        if(i != size() && !comp_(key, keys_[i])) return { begin() + diff_(i), false };
+
+        index_.clear();
+        return { keys_.insert(keys_.begin() + diff_(i), std::forward<KeyArg>(key)), true };
+    }
+
+    void sort_unique_(KeyContainer& keys) const
+    {
+        std::stable_sort(keys.begin(), keys.end(), comp_);
+        keys.erase(std::unique(keys.begin(), keys.end(), [this](const K& a, const K& b) { return !comp_(a, b); }),
+                   keys.end());
+    }
+
+    /// See flat_map::merge_
+    void merge_(KeyContainer& incoming)
+    {
+        if(incoming.empty()) return;
+
+        if(keys_.empty())
+        {
+            index_.clear();
+            keys_ = std::move(incoming);
+            return;
+        }
+
+        constexpr size_type dropped = static_cast<size_type>(-1);
+
+        std::vector<size_type> at;
+        at.reserve(incoming.size());
+        size_type i = 0;
+        for(const K& k : incoming)
+        {
+            while(i < keys_.size() && comp_(keys_[i], k)) ++i;
+            at.push_back(i < keys_.size() && !comp_(k, keys_[i]) ? dropped : i);
+        }
+
+        KeyContainer merged;
+        merged.reserve(keys_.size() + incoming.size());
+
+        auto take = [&](size_type from)
+        {
+            if constexpr(std::is_nothrow_move_constructible_v<K>) merged.push_back(std::move(keys_[from]));
+            else                                                  merged.push_back(keys_[from]);
+        };
+
+        i = 0;
+        for(size_type j = 0; j < incoming.size(); ++j)
+        {
+            if(at[j] == dropped) continue;
+            for(; i < at[j]; ++i) take(i);
+            merged.push_back(std::move(incoming[j]));
+        }
+        for(; i < keys_.size(); ++i) take(i);
+
+        index_.clear();
+        keys_.swap(merged);
+    }
+
+    bool is_sorted_unique_(const KeyContainer& keys) const
+    {
+        return std::adjacent_find(keys.begin(), keys.end(), [this](const K& a, const K& b)
+        {
+            return !comp_(a, b);
+        }) == keys.end();
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    KeyContainer                  keys_;
+    OCU_NO_UNIQUE_ADDRESS Compare comp_;
+    detail::eytzinger_index<K>    index_;
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_FLAT_MAP_H
@@ -0,0 +1,801 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_HASH_H
+#define OPEN_CPP_UTILS_HASH_H
+
+#include "config.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(OCU_HAS_AVX2)
+#   include <immintrin.h>
+#elif defined(OCU_HAS_SSE2)
+#   include <emmintrin.h>
+#elif defined(OCU_HAS_NEON)
+#   include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace open_cpp_utils
+{
+
+namespace detail
+{
+
+/// Little-endian load that is a plain memcpy at run time and a byte loop during constant evaluation
+template<typename T>
+[[nodiscard]] constexpr T read_le(const char* p) noexcept
+{
+    if(!std::is_constant_evaluated() && std::endian::native == std::endian::little)
+    {
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        return v;
+    }
+
+    T v = 0;
+    for(std::size_t i = 0; i < sizeof(T); ++i) v |= static_cast<T>(static_cast<unsigned char>(p[i])) << (8 * i);
+    return v;
+}
+
+inline constexpr std::uint64_t xxh64_p1 = 0x9E3779B185EBCA87ull;
+inline constexpr std::uint64_t xxh64_p2 = 0xC2B2AE3D27D4EB4Full;
+inline constexpr std::uint64_t xxh64_p3 = 0x165667B19E3779F9ull;
+inline constexpr std::uint64_t xxh64_p4 = 0x85EBCA77C2B2AE63ull;
+inline constexpr std::uint64_t xxh64_p5 = 0x27D4EB2F165667C5ull;
+
+[[nodiscard]] constexpr std::uint64_t xxh64_round(std::uint64_t acc, std::uint64_t input) noexcept
+{
+    acc += input * xxh64_p2;
+    acc  = std::rotl(acc, 31);
+    return acc * xxh64_p1;
+}
+
+[[nodiscard]] constexpr std::uint64_t xxh64_merge(std::uint64_t acc, std::uint64_t v) noexcept
+{
+    acc ^= xxh64_round(0, v);
+    return acc * xxh64_p1 + xxh64_p4;
+}
+
+}
+
+// String Hashes =======================================================================================================
+
+/**
+ * \brief 32-bit FNV-1a. Tiny and fine for short identifiers; its output is stable across platforms and releases.
+ */
+[[nodiscard]] constexpr std::uint32_t fnv1a_32(std::string_view s) noexcept
+{
+    std::uint32_t h = 0x811C9DC5u;
+    for(char c : s)
+    {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x01000193u;
+    }
+    return h;
+}
+
+/**
+ * \brief 64-bit FNV-1a. Stable across platforms and releases, so it is safe to persist.
+ */
+[[nodiscard]] constexpr std::uint64_t fnv1a_64(std::string_view s) noexcept
+{
+    std::uint64_t h = 0xCBF29CE484222325ull;
+    for(char c : s)
+    {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x00000100000001B3ull;
+    }
+    return h;
+}
+
+/**
+ * \brief XXH64, bit-identical to the reference implementation, usable in constant expressions. Processes 32 bytes
+ *        per step, so it is much faster than FNV-1a on anything longer than a few words.
+ */
+[[nodiscard]] constexpr std::uint64_t xxh64(std::string_view s, std::uint64_t seed = 0) noexcept
+{
+    using namespace detail;
+
+    const char*       p   = s.data();
+    const std::size_t len = s.size();
+    const char* const end = p + len;
+
+    std::uint64_t h;
+    if(len >= 32)
+    {
+        std::uint64_t v1 = seed + xxh64_p1 + xxh64_p2;
+        std::uint64_t v2 = seed + xxh64_p2;
+        std::uint64_t v3 = seed;
+        std::uint64_t v4 = seed - xxh64_p1;
+
+        const char* const limit = end - 32;
+        do
+        {
+            v1 = xxh64_round(v1, read_le<std::uint64_t>(p));
+            v2 = xxh64_round(v2, read_le<std::uint64_t>(p + 8));
+            v3 = xxh64_round(v3, read_le<std::uint64_t>(p + 16));
+            v4 = xxh64_round(v4, read_le<std::uint64_t>(p + 24));
+            p += 32;
+        } while(p <= limit);
+
+        h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        h = xxh64_merge(h, v1);
+        h = xxh64_merge(h, v2);
+        h = xxh64_merge(h, v3);
+        h = xxh64_merge(h, v4);
+    }
+    else
+    {
+        h = seed + xxh64_p5;
+    }
+
+    h += static_cast<std::uint64_t>(len);
+
+    for(; end - p >= 8; p += 8)
+    {
+        h ^= xxh64_round(0, read_le<std::uint64_t>(p));
+        h  = std::rotl(h, 27) * xxh64_p1 + xxh64_p4;
+    }
+    if(end - p >= 4)
+    {
+        h ^= static_cast<std::uint64_t>(read_le<std::uint32_t>(p)) * xxh64_p1;
+        h  = std::rotl(h, 23) * xxh64_p2 + xxh64_p3;
+        p += 4;
+    }
+    for(; p < end; ++p)
+    {
+        h ^= static_cast<std::uint64_t>(static_cast<unsigned char>(*p)) * xxh64_p5;
+        h  = std::rotl(h, 11) * xxh64_p1;
+    }
+
+    h ^= h >> 33;
+    h *= xxh64_p2;
+    h ^= h >> 29;
+    h *= xxh64_p3;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ * \brief Hash used by the _hash literal and perfect_hash_map. Switching on string_hash(s) against "name"_hash
+ *        labels compares one integer per case; the compiler rejects colliding labels as duplicate cases.
+ */
+[[nodiscard]] constexpr std::uint64_t string_hash(std::string_view s) noexcept { return xxh64(s); }
+
+/**
+ * \brief Finalizer of MurmurHash3: a bijection on 64-bit values in which every input bit affects every output bit
+ */
+[[nodiscard]] constexpr std::uint64_t fmix64(std::uint64_t h) noexcept
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+namespace detail
+{
+
+/**
+ * \brief Key hash of perfect_hash_map: keys of up to 16 bytes are read as two overlapping words and mixed once,
+ *        which is cheaper than xxh64's serial tail loop on the identifier-sized strings these tables hold
+ */
+[[nodiscard]] constexpr std::uint64_t short_key_hash(std::string_view s) noexcept
+{
+    const char*       p   = s.data();
+    const std::size_t len = s.size();
+
+    std::uint64_t a, b;
+    if(len > 16) return xxh64(s);
+    if(len >= 8)
+    {
+        a = read_le<std::uint64_t>(p);
+        b = read_le<std::uint64_t>(p + len - 8);
+    }
+    else if(len >= 4)
+    {
+        a = read_le<std::uint32_t>(p);
+        b = read_le<std::uint32_t>(p + len - 4);
+    }
+    else if(len > 0)
+    {
+        a = (static_cast<std::uint64_t>(static_cast<unsigned char>(p[0])) << 16)
+          | (static_cast<std::uint64_t>(static_cast<unsigned char>(p[len / 2])) << 8)
+          |  static_cast<std::uint64_t>(static_cast<unsigned char>(p[len - 1]));
+        b = 0;
+    }
+    else
+    {
+        a = b = 0;
+    }
+    return fmix64(a * xxh64_p1 ^ std::rotl(b * xxh64_p2, 31) ^ len);
+}
+
+}
+
+inline namespace literals
+{
+
+/**
+ * \brief "name"_hash is string_hash("name"), evaluated at compile time
+ */
+[[nodiscard]] consteval std::uint64_t operator""_hash(const char* s, std::size_t n) noexcept
+{
+    return string_hash(std::string_view(s, n));
+}
+
+}
+
+// perfect_hash_map ====================================================================================================
+
+/**
+ * \brief Immutable string-keyed table whose layout is computed at compile time, with no collisions.
+ *
+ * Built with hash and displace: keys are grouped into buckets by their hash, and each bucket, largest
+ * first, gets the first seed that sends all its keys to free slots of a power-of-two table about 1.25 times the key
+ * count. A lookup hashes the string once, mixes the hash with its bucket's seed to pick the slot, and compares the
+ * one candidate key, so it never probes and never allocates. A duplicate key, or a key set no seed separates, is a
+ * compile error when the table is built in a constant expression.
+ *
+ * Build one with make_perfect_hash_map, normally into a constexpr variable:
+ *
+ *     constexpr auto commands = make_perfect_hash_map<int>({ { "open", 0 }, { "save", 1 }, { "quit", 2 } });
+ *     if(const int* id = commands.find(name)) ...
+ */
+template<typename V, std::size_t N>
+class perfect_hash_map
+{
+// Typedefs ============================================================================================================
+
+public:
+    using key_type    = std::string_view;
+    using mapped_type = V;
+    using value_type  = std::pair<std::string_view, V>;
+    using size_type   = std::size_t;
+
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+private:
+    static constexpr size_type table_size_  = std::bit_ceil(N + N / 4 + 1);
+    static constexpr size_type bucket_count_ = std::bit_ceil(N / 4 + 1);
+    static constexpr size_type max_seed_    = 1u << 16;
+
+    using slot_type = std::conditional_t<(N < 0xFF), std::uint8_t,
+                      std::conditional_t<(N < 0xFFFF), std::uint16_t, std::uint32_t>>;
+    static constexpr slot_type empty_slot_ = static_cast<slot_type>(N);
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors --------------------------------------------------------------------------------------------------------
+
+    /**
+     * \throws std::invalid_argument on a duplicate key or if no seed separates a bucket; at compile time either is
+     *         a compile error
+     */
+    constexpr explicit perfect_hash_map(const value_type (&items)[N])
+    {
+        for(size_type i = 0; i < N; ++i) items_[i] = items[i];
+        build_();
+    }
+
+// Lookup --------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Position of key in the list the table was built from, or npos
+     */
+    [[nodiscard]] constexpr size_type index_of(std::string_view key) const noexcept
+    {
+        if constexpr(N == 0)
+        {
+            static_cast<void>(key);
+            return npos;
+        }
+        else
+        {
+            const std::uint64_t h = detail::short_key_hash(key);
+            const slot_type     i = slots_[slot_of_(h, seeds_[h & (bucket_count_ - 1)])];
+            return i != empty_slot_ && items_[i].first == key ? i : npos;
+        }
+    }
+
+    [[nodiscard]] constexpr const V* find(std::string_view key) const noexcept
+    {
+        const size_type i = index_of(key);
+        return i == npos ? nullptr : &items_[i].second;
+    }
+
+    [[nodiscard]] constexpr bool contains(std::string_view key) const noexcept { return index_of(key) != npos; }
+
+    /**
+     * \throws std::out_of_range if key is not in the table
+     */
+    [[nodiscard]] constexpr const V& at(std::string_view key) const
+    {
+        const size_type i = index_of(key);
+        if(i == npos) throw std::out_of_range("perfect_hash_map::at key not found");
+        return items_[i].second;
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] static constexpr size_type size()  noexcept { return N; }
+    [[nodiscard]] static constexpr bool      empty() noexcept { return N == 0; }
+
+    /// Entries in the order they were given
+    [[nodiscard]] constexpr auto begin() const noexcept { return items_.begin(); }
+    [[nodiscard]] constexpr auto end()   const noexcept { return items_.end(); }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    [[nodiscard]] static constexpr size_type slot_of_(std::uint64_t h, std::uint32_t seed) noexcept
+    {
+        return static_cast<size_type>(fmix64(h ^ (seed * 0x9E3779B97F4A7C15ull)) & (table_size_ - 1));
+    }
+
+    constexpr void build_()
+    {
+        std::array<std::uint64_t, N ? N : 1> hashes{ };
+        for(size_type i = 0; i < N; ++i) hashes[i] = detail::short_key_hash(items_[i].first);
+
+        for(size_type i = 0; i < N; ++i)
+        {
+            for(size_type j = i + 1; j < N; ++j)
+            {
+                if(hashes[i] == hashes[j] && items_[i].first == items_[j].first)
+                {
+                    throw std::invalid_argument("perfect_hash_map: duplicate key");
+                }
+            }
+        }
+
+        // Counting sort of the keys by bucket, and of the buckets by size, largest first
+        std::array<size_type, bucket_count_ + 1>    start{ };
+        std::array<size_type, N ? N : 1>            members{ };
+        std::array<size_type, bucket_count_>        order{ };
+        for(size_type i = 0; i < N; ++i) ++start[(hashes[i] & (bucket_count_ - 1)) + 1];
+        for(size_type b = 0; b < bucket_count_; ++b) start[b + 1] += start[b];
+
+        std::array<size_type, bucket_count_> fill{ };
+        for(size_type i = 0; i < N; ++i)
+        {
+            const size_type b = hashes[i] & (bucket_count_ - 1);
+            members[start[b] + fill[b]++] = i;
+        }
+
+        for(size_type b = 0; b < bucket_count_; ++b) order[b] = b;
+        for(size_type a = 1; a < bucket_count_; ++a)
+        {
+            for(size_type b = a; b > 0 && fill[order[b]] > fill[order[b - 1]]; --b)
+            {
+                const size_type t = order[b]; order[b] = order[b - 1]; order[b - 1] = t;
+            }
+        }
+
+        for(auto& s : slots_) s = empty_slot_;
+
+        std::array<size_type, table_size_> picked{ };
+        for(size_type ob = 0; ob < bucket_count_; ++ob)
+        {
+            const size_type b     = order[ob];
+            const size_type count = fill[b];
+            if(count == 0) break;
+
+            std::uint32_t seed = 0;
+            for(;; ++seed)
+            {
+                if(seed == max_seed_) throw std::invalid_argument("perfect_hash_map: no seed separates a bucket");
+
+                bool ok = true;
+                for(size_type m = 0; m < count && ok; ++m)
+                {
+                    picked[m] = slot_of_(hashes[members[start[b] + m]], seed);
+                    ok = slots_[picked[m]] == empty_slot_;
+                    for(size_type o = 0; o < m && ok; ++o) ok = picked[o] != picked[m];
+                }
+                if(ok) break;
+            }
+
+            seeds_[b] = seed;
+            for(size_type m = 0; m < count; ++m) slots_[picked[m]] = static_cast<slot_type>(members[start[b] + m]);
+        }
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::array<value_type, N>                  items_{ };
+    std::array<std::uint32_t, bucket_count_>   seeds_{ };
+    std::array<slot_type, table_size_>         slots_{ };
+};
+
+/**
+ * \brief Builds a perfect_hash_map from a braced list of { "key", value } pairs
+ */
+template<typename V, std::size_t N>
+[[nodiscard]] constexpr perfect_hash_map<V, N> make_perfect_hash_map(const std::pair<std::string_view, V> (&items)[N])
+{
+    return perfect_hash_map<V, N>(items);
+}
+
+
+// Runtime Hashing =====================================================================================================
+
+namespace detail
+{
+
+inline constexpr std::uint64_t wy_p0 = 0x2D358DCCAA6C78A5ull;
+inline constexpr std::uint64_t wy_p1 = 0x8BB84B93962EACC9ull;
+inline constexpr std::uint64_t wy_p2 = 0x4B33A62ED433D4A3ull;
+inline constexpr std::uint64_t wy_p3 = 0x4D5A2DA51DE1AA47ull;
+
+/// Full 64x64 -> 128-bit multiply; a receives the low half and b the high half
+OCU_FORCEINLINE void mum(std::uint64_t& a, std::uint64_t& b) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ using u128 = unsigned __int128;
+    const u128 r = static_cast<u128>(a) * b;
+    a = static_cast<std::uint64_t>(r);
+    b = static_cast<std::uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#else
+    const std::uint64_t ha = a >> 32, la = static_cast<std::uint32_t>(a);
+    const std::uint64_t hb = b >> 32, lb = static_cast<std::uint32_t>(b);
+    const std::uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+    const std::uint64_t t  = ll + (hl << 32);
+    const std::uint64_t lo = t + (lh << 32);
+    b = hh + (hl >> 32) + (lh >> 32) + (t < ll) + (lo < t);
+    a = lo;
+#endif
+}
+
+/// Multiplies and folds the halves together, wyhash's mixing primitive
+OCU_FORCEINLINE std::uint64_t wymix(std::uint64_t a, std::uint64_t b) noexcept
+{
+    mum(a, b);
+    return a ^ b;
+}
+
+// Long keys -----------------------------------------------------------------------------------------------------------
+//
+// Keys longer than long_key_threshold bytes are accumulated 64 bytes at a time into eight independent 64-bit lanes,
+// XXH3 style: each lane adds the product of the two 32-bit halves of data ^ key, plus the neighbouring lane's raw
+// data. A stripe is two AVX2, four SSE2 or four NEON multiplies and has no dependency on the previous stripe beyond
+// the additions, so the loop runs at memory bandwidth. Every path computes the same values.
+
+inline constexpr std::size_t long_key_threshold = 256;
+inline constexpr std::size_t stripe_size        = 64;
+inline constexpr std::size_t stripes_per_block  = 16;
+
+/// Per-stripe keys: stripe s of a block uses words [s, s + 8), the block scramble uses words [16, 24)
+alignas(32) inline constexpr std::array<std::uint64_t, 24> stripe_keys = []
+{
+    std::array<std::uint64_t, 24> k{ };
+    std::uint64_t x = 0x9E3779B97F4A7C15ull;
+    for(auto& w : k)
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        w  = fmix64(x);
+    }
+    return k;
+}();
+
+OCU_FORCEINLINE void accumulate_stripe(std::uint64_t* acc, const char* p, const std::uint64_t* key) noexcept
+{
+#if defined(OCU_HAS_AVX2)
+    for(int i = 0; i < 2; ++i)
+    {
+        const __m256i d    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p) + i);
+        const __m256i dk   = _mm256_xor_si256(d, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key) + i));
+        const __m256i prod = _mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32));
+        const __m256i swap = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+        __m256i*      a    = reinterpret_cast<__m256i*>(acc) + i;
+        _mm256_store_si256(a, _mm256_add_epi64(_mm256_load_si256(a), _mm256_add_epi64(prod, swap)));
+    }
+#elif defined(OCU_HAS_SSE2)
+    for(int i = 0; i < 4; ++i)
+    {
+        const __m128i d    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + i);
+        const __m128i dk   = _mm_xor_si128(d, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key) + i));
+        const __m128i prod = _mm_mul_epu32(dk, _mm_srli_epi64(dk, 32));
+        const __m128i swap = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128i*      a    = reinterpret_cast<__m128i*>(acc) + i;
+        _mm_store_si128(a, _mm_add_epi64(_mm_load_si128(a), _mm_add_epi64(prod, swap)));
+    }
+#elif defined(OCU_HAS_NEON)
+    for(int i = 0; i < 4; ++i)
+    {
+        const uint64x2_t d  = vreinterpretq_u64_u8(vld1q_u8(reinterpret_cast<const std::uint8_t*>(p) + 16 * i));
+        const uint64x2_t dk = veorq_u64(d, vld1q_u64(key + 2 * i));
+        uint64x2_t       a  = vld1q_u64(acc + 2 * i);
+        a = vmlal_u32(a, vmovn_u64(dk), vshrn_n_u64(dk, 32));
+        vst1q_u64(acc + 2 * i, vaddq_u64(a, vextq_u64(d, d, 1)));
+    }
+#else
+    for(int i = 0; i < 8; ++i)
+    {
+        const std::uint64_t d  = read_le<std::uint64_t>(p + 8 * i);
+        const std::uint64_t dk = d ^ key[i];
+        acc[i ^ 1] += d;
+        acc[i]     += (dk & 0xFFFFFFFFull) * (dk >> 32);
+    }
+#endif
+}
+
+/// Runs once per kilobyte so that reordering stripes across blocks changes the result
+OCU_FORCEINLINE void scramble_lanes(std::uint64_t* acc, const std::uint64_t* key) noexcept
+{
+    for(int i = 0; i < 8; ++i) acc[i] = ((acc[i] ^ (acc[i] >> 47)) ^ key[i]) * 0x9E3779B1ull;
+}
+
+inline std::uint64_t hash_long(const char* p, std::size_t len, std::uint64_t seed) noexcept
+{
+    constexpr std::size_t block_size = stripe_size * stripes_per_block;
+    const std::uint64_t*  key        = stripe_keys.data();
+
+    alignas(32) std::uint64_t acc[8] = {
+        0x00000000C2B2AE3Dull, xxh64_p1, xxh64_p2, xxh64_p3, xxh64_p4, 0x0000000085EBCA77ull, xxh64_p5, seed
+    };
+
+    const std::size_t blocks = (len - 1) / block_size;
+    for(std::size_t b = 0; b < blocks; ++b)
+    {
+        const char* block = p + b * block_size;
+        for(std::size_t s = 0; s < stripes_per_block; ++s) accumulate_stripe(acc, block + s * stripe_size, key + s);
+        scramble_lanes(acc, key + stripes_per_block);
+    }
+
+    // The final 1 to 1024 bytes: whole stripes, then the last 64 bytes, which may overlap them
+    const char*       tail    = p + blocks * block_size;
+    const std::size_t stripes = (len - blocks * block_size - 1) / stripe_size;
+    for(std::size_t s = 0; s < stripes; ++s) accumulate_stripe(acc, tail + s * stripe_size, key + s);
+    accumulate_stripe(acc, p + len - stripe_size, key + 9);
+
+    std::uint64_t h = static_cast<std::uint64_t>(len) * xxh64_p1 ^ seed;
+    for(int i = 0; i < 4; ++i) h += wymix(acc[2 * i] ^ key[2 * i + 3], acc[2 * i + 1] ^ key[2 * i + 4]);
+    return fmix64(h);
+}
+
+// Short keys ----------------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Hashes a byte range. Up to 16 bytes cost two overlapping reads and two multiplies, up to
+ *        long_key_threshold bytes one multiply per 16 bytes (wyhash), and beyond that the SIMD striped loop.
+ */
+inline std::uint64_t hash_bytes(const void* data, std::size_t len, std::uint64_t seed = 0) noexcept
+{
+    const char* p = static_cast<const char*>(data);
+    if(OCU_UNLIKELY(len > long_key_threshold)) return hash_long(p, len, seed);
+
+    seed ^= wymix(seed ^ wy_p0, wy_p1);
+
+    std::uint64_t a, b;
+    if(OCU_LIKELY(len <= 16))
+    {
+        if(OCU_LIKELY(len >= 4))
+        {
+            const std::size_t mid = (len >> 3) << 2;
+            a = (static_cast<std::uint64_t>(read_le<std::uint32_t>(p)) << 32) | read_le<std::uint32_t>(p + mid);
+            b = (static_cast<std::uint64_t>(read_le<std::uint32_t>(p + len - 4)) << 32)
+              | read_le<std::uint32_t>(p + len - 4 - mid);
+        }
+        else if(OCU_LIKELY(len > 0))
+        {
+            a = (static_cast<std::uint64_t>(static_cast<unsigned char>(p[0])) << 16)
+              | (static_cast<std::uint64_t>(static_cast<unsigned char>(p[len >> 1])) << 8)
+              |  static_cast<std::uint64_t>(static_cast<unsigned char>(p[len - 1]));
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        std::size_t i = len;
+        if(OCU_UNLIKELY(i >= 48))
+        {
+            std::uint64_t seed1 = seed, seed2 = seed;
+            do
+            {
+                seed  = wymix(read_le<std::uint64_t>(p)      ^ wy_p1, read_le<std::uint64_t>(p + 8)  ^ seed);
+                seed1 = wymix(read_le<std::uint64_t>(p + 16) ^ wy_p2, read_le<std::uint64_t>(p + 24) ^ seed1);
+                seed2 = wymix(read_le<std::uint64_t>(p + 32) ^ wy_p3, read_le<std::uint64_t>(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while(OCU_LIKELY(i >= 48));
+            seed ^= seed1 ^ seed2;
+        }
+        while(OCU_UNLIKELY(i > 16))
+        {
+            seed = wymix(read_le<std::uint64_t>(p) ^ wy_p1, read_le<std::uint64_t>(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = read_le<std::uint64_t>(p + i - 16);
+        b = read_le<std::uint64_t>(p + i - 8);
+    }
+
+    a ^= wy_p1;
+    b ^= seed;
+    mum(a, b);
+    return wymix(a ^ wy_p0 ^ static_cast<std::uint64_t>(len), b ^ wy_p1);
+}
+
+template<typename T>
+inline constexpr bool always_false_v = false;
+
+/// Types whose object representation is their value, so equal values have equal bytes and can be hashed as bytes
+template<typename T>
+inline constexpr bool uniquely_represented_v = std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>;
+
+/// Contiguous ranges of uniquely represented elements, such as strings, are hashed as a single byte range
+template<typename T>
+concept byte_hashable_range = std::ranges::contiguous_range<const T> && std::ranges::sized_range<const T>
+                           && uniquely_represented_v<std::ranges::range_value_t<const T>>;
+
+}
+
+/**
+ * \brief Accumulator of the hash_append protocol: values are fed in with hash_append and hash<T> returns finish().
+ *        Nothing is buffered; each word costs one multiply and each byte range one hash_bytes call.
+ */
+class hash_state
+{
+public:
+    explicit hash_state(std::uint64_t seed = 0) noexcept : state_(seed ^ detail::wy_p0) { }
+
+    /// Mixes in one word
+    OCU_FORCEINLINE void write(std::uint64_t word) noexcept { state_ = detail::wymix(state_ ^ word, detail::wy_p1); }
+
+    /// Mixes in a byte range; the caller appends the length when it is not implied by the type
+    void write(const void* data, std::size_t size) noexcept { state_ = detail::hash_bytes(data, size, state_); }
+
+    [[nodiscard]] std::uint64_t finish() const noexcept { return state_; }
+
+private:
+    std::uint64_t state_;
+};
+
+/**
+ * \brief Feeds a value into a hash_state without building any temporary.
+ *
+ * Handles integers, enums, pointers, floating point (with -0.0 == 0.0), strings and other ranges, and
+ * anything tuple-like (std::pair, std::tuple, std::array, ...), recursing with unqualified hash_append calls.
+ * Ranges of uniquely represented elements are hashed as one byte range followed by their length. Other types fall
+ * back to std::hash. A user type opts in with a non-template overload found by ADL:
+ *
+ *     friend void hash_append(hash_state& h, const my_key& k) { hash_append(h, k.name, k.lod, k.flags); }
+ */
+template<typename T>
+void hash_append(hash_state& h, const T& value) noexcept
+{
+    if constexpr(detail::uniquely_represented_v<T> && sizeof(T) <= sizeof(std::uint64_t))
+    {
+        if constexpr(std::is_pointer_v<T>) h.write(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value)));
+        else                               h.write(static_cast<std::uint64_t>(value));
+    }
+    else if constexpr(detail::uniquely_represented_v<T>)
+    {
+        h.write(&value, sizeof(T));
+    }
+    else if constexpr(std::is_same_v<T, std::nullptr_t>)
+    {
+        h.write(0);
+    }
+    else if constexpr(std::is_floating_point_v<T>)
+    {
+        const double d = value == T(0) ? 0.0 : static_cast<double>(value);
+        h.write(std::bit_cast<std::uint64_t>(d));
+    }
+    else if constexpr(detail::byte_hashable_range<T>)
+    {
+        h.write(std::ranges::data(value), std::ranges::size(value) * sizeof(std::ranges::range_value_t<const T>));
+        h.write(static_cast<std::uint64_t>(std::ranges::size(value)));
+    }
+    else if constexpr(requires { std::tuple_size<T>::value; })
+    {
+        std::apply([&h](const auto&... elements) { (hash_append(h, elements), ...); }, value);
+    }
+    else if constexpr(std::ranges::input_range<const T>)
+    {
+        std::uint64_t count = 0;
+        for(const auto& element : value)
+        {
+            hash_append(h, element);
+            ++count;
+        }
+        h.write(count);
+    }
+    else if constexpr(requires { std::hash<T>{ }(value); })
+    {
+        h.write(static_cast<std::uint64_t>(std::hash<T>{ }(value)));
+    }
+    else
+    {
+        static_assert(detail::always_false_v<T>, "no hash_append overload or std::hash specialization for this type");
+    }
+}
+
+/**
+ * \brief Appends several values in order, e.g. the members of a struct
+ */
+template<typename T, typename... Ts>
+    requires (sizeof...(Ts) > 0)
+void hash_append(hash_state& h, const T& first, const Ts&... rest) noexcept
+{
+    hash_append(h, first);
+    (hash_append(h, rest), ...);
+}
+
+/**
+ * \brief Default hasher of hash_map and hash_set.
+ *
+ * Unlike std::hash its output is fully mixed (libstdc++'s std::hash<int> is the identity), so it marks itself
+ * is_avalanching and the tables use it as is. Strings go straight to the byte hash; every other type goes through
+ * hash_append. Values are not stable across releases or platforms; use xxh64 for anything persisted.
+ */
+template<typename T>
+struct hash
+{
+    using is_avalanching = void;
+
+    [[nodiscard]] std::size_t operator()(const T& value) const noexcept
+    {
+        hash_state h;
+        hash_append(h, value);
+        return static_cast<std::size_t>(h.finish());
+    }
+};
+
+namespace detail
+{
+
+struct string_hasher
+{
+    using is_avalanching = void;
+    using is_transparent = void;
+
+    [[nodiscard]] std::size_t operator()(std::string_view s) const noexcept
+    {
+        return static_cast<std::size_t>(hash_bytes(s.data(), s.size()));
+    }
+};
+
+}
+
+template<typename Alloc>
+struct hash<std::basic_string<char, std::char_traits<char>, Alloc>> : detail::string_hasher { };
+
+template<>
+struct hash<std::string_view> : detail::string_hasher { };
+
+}
+
+#endif // OPEN_CPP_UTILS_HASH_H
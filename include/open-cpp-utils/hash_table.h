@@ -0,0 +1,1307 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_HASH_TABLE_H
+#define OPEN_CPP_UTILS_HASH_TABLE_H
+
+#include "config.h"
+#include "hash.h"
+#include "memory_stats.h"
+#include "template_utils.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(OCU_HAS_SSE2)
+#   include <emmintrin.h>
+#elif defined(OCU_HAS_NEON)
+#   include <arm_neon.h>
+#endif
+
+namespace open_cpp_utils
+{
+
+namespace detail
+{
+
+// Control Bytes =======================================================================================================
+//
+// Every slot has one control byte. Full slots store the low 7 bits of the hash (h2), so the sign bit tells full and
+// special bytes apart, and a group of 16 bytes can be matched against h2 with a single SIMD compare.
+
+using ctrl_t = std::int8_t;
+
+inline constexpr ctrl_t ctrl_empty    = -128; // 0b10000000
+inline constexpr ctrl_t ctrl_deleted  = -2;   // 0b11111110
+inline constexpr ctrl_t ctrl_sentinel = -1;   // 0b11111111
+
+constexpr bool is_full(ctrl_t c)             noexcept { return c >= 0; }
+constexpr bool is_empty_or_deleted(ctrl_t c) noexcept { return c < ctrl_sentinel; }
+
+/**
+ * \brief Shared control bytes of every empty table so lookups in a default constructed table need no branch.
+ */
+alignas(16) inline constexpr ctrl_t empty_group[16] = {
+    ctrl_sentinel, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty,
+    ctrl_empty,    ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty, ctrl_empty
+};
+
+/**
+ * \brief Folds a 64-bit hash onto itself with a 128-bit multiply so every input bit affects h1 and h2. Without it
+ *        identity hashes such as std::hash<int> collapse onto a handful of groups.
+ */
+OCU_FORCEINLINE std::uint64_t mix_hash(std::uint64_t h) noexcept
+{
+    constexpr std::uint64_t k = 0x9E3779B97F4A7C15ull;
+#if defined(__SIZEOF_INT128__)
+    __extension__ using u128 = unsigned __int128;
+    const u128 m = static_cast<u128>(h) * k;
+    return static_cast<std::uint64_t>(m) ^ static_cast<std::uint64_t>(m >> 64);
+#else
+    h ^= h >> 32;
+    h *= k;
+    return h ^ (h >> 29);
+#endif
+}
+
+// Bit Masks ===========================================================================================================
+
+/**
+ * \brief Set of matching positions within a group. Each position occupies 2^Shift bits of T.
+ */
+template<typename T, int Width, int Shift>
+class group_mask
+{
+public:
+    explicit group_mask(T mask) noexcept : mask_(mask) { }
+
+    explicit operator bool() const noexcept { return mask_ != 0; }
+
+    int  operator*() const noexcept { return lowest(); }
+    group_mask& operator++() noexcept { mask_ &= (mask_ - 1); return *this; }
+
+    group_mask begin() const noexcept { return *this; }
+    group_mask end()   const noexcept { return group_mask(0); }
+
+    friend bool operator!=(const group_mask& a, const group_mask& b) noexcept { return a.mask_ != b.mask_; }
+
+    int lowest() const noexcept { return std::countr_zero(mask_) >> Shift; }
+
+    /// Number of positions below the first match
+    int trailing_zeros() const noexcept { return std::countr_zero(mask_) >> Shift; }
+
+    /// Number of positions above the last match
+    int leading_zeros() const noexcept
+    {
+        constexpr int extra = static_cast<int>(sizeof(T) * 8) - Width * (1 << Shift);
+        return std::countl_zero(static_cast<T>(mask_ << extra)) >> Shift;
+    }
+
+private:
+    T mask_;
+};
+
+// Groups ==============================================================================================================
+
+#if defined(OCU_HAS_SSE2)
+
+struct group
+{
+    static constexpr std::size_t width = 16;
+    using mask = group_mask<std::uint32_t, 16, 0>;
+
+    explicit group(const ctrl_t* pos) noexcept
+        : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos)))
+    { }
+
+    mask match(std::uint8_t h2) const noexcept
+    {
+        return mask(bits_(_mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(h2)), ctrl_)));
+    }
+
+    mask match_empty() const noexcept
+    {
+        return mask(bits_(_mm_cmpeq_epi8(_mm_set1_epi8(ctrl_empty), ctrl_)));
+    }
+
+    mask match_empty_or_deleted() const noexcept
+    {
+        return mask(bits_(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), ctrl_)));
+    }
+
+    std::uint32_t count_leading_empty_or_deleted() const noexcept
+    {
+        const std::uint32_t m = bits_(_mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), ctrl_));
+        return static_cast<std::uint32_t>(std::countr_zero(m + 1));
+    }
+
+private:
+    static std::uint32_t bits_(__m128i v) noexcept { return static_cast<std::uint32_t>(_mm_movemask_epi8(v)); }
+
+    __m128i ctrl_;
+};
+
+#elif defined(OCU_HAS_NEON)
+
+struct group
+{
+    static constexpr std::size_t width = 16;
+
+    // NEON has no movemask; narrowing shifts each 16-bit lane right by 4 leaving one nibble per byte. Only the top
+    // bit of every nibble is kept so clearing the lowest set bit advances by exactly one position.
+    using mask = group_mask<std::uint64_t, 16, 2>;
+
+    explicit group(const ctrl_t* pos) noexcept : ctrl_(vld1q_s8(pos)) { }
+
+    mask match(std::uint8_t h2) const noexcept
+    {
+        return mask(bits_(vceqq_s8(vdupq_n_s8(static_cast<std::int8_t>(h2)), ctrl_)));
+    }
+
+    mask match_empty() const noexcept
+    {
+        return mask(bits_(vceqq_s8(vdupq_n_s8(ctrl_empty), ctrl_)));
+    }
+
+    mask match_empty_or_deleted() const noexcept
+    {
+        return mask(bits_(vcltq_s8(ctrl_, vdupq_n_s8(ctrl_sentinel))));
+    }
+
+    std::uint32_t count_leading_empty_or_deleted() const noexcept
+    {
+        const std::uint64_t m = bits_(vcltq_s8(ctrl_, vdupq_n_s8(ctrl_sentinel)));
+        return static_cast<std::uint32_t>(std::countr_zero(~m & 0x8888888888888888ull) >> 2);
+    }
+
+private:
+    static std::uint64_t bits_(uint8x16_t v) noexcept
+    {
+        const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(v), 4);
+        return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x8888888888888888ull;
+    }
+
+    int8x16_t ctrl_;
+};
+
+#else
+
+struct group
+{
+    static constexpr std::size_t width = 8;
+    using mask = group_mask<std::uint64_t, 8, 3>;
+
+    explicit group(const ctrl_t* pos) noexcept
+    {
+        std::memcpy(&ctrl_, pos, sizeof(ctrl_));
+        if constexpr(std::endian::native == std::endian::big) ctrl_ = byteswap_(ctrl_);
+    }
+
+    // May report a false positive in the byte above a real match, which the key comparison filters out
+    mask match(std::uint8_t h2) const noexcept
+    {
+        const std::uint64_t x = ctrl_ ^ (lsbs * h2);
+        return mask((x - lsbs) & ~x & msbs);
+    }
+
+    mask match_empty() const noexcept            { return mask((ctrl_ & (~ctrl_ << 6)) & msbs); }
+    mask match_empty_or_deleted() const noexcept { return mask((ctrl_ & (~ctrl_ << 7)) & msbs); }
+
+    std::uint32_t count_leading_empty_or_deleted() const noexcept
+    {
+        constexpr std::uint64_t gaps = 0x00FEFEFEFEFEFEFEull;
+        return static_cast<std::uint32_t>((std::countr_zero(((~ctrl_ & (ctrl_ >> 7)) | gaps) + 1) + 7) >> 3);
+    }
+
+private:
+    static constexpr std::uint64_t lsbs = 0x0101010101010101ull;
+    static constexpr std::uint64_t msbs = 0x8080808080808080ull;
+
+    static constexpr std::uint64_t byteswap_(std::uint64_t v) noexcept
+    {
+        v = ((v & 0x00FF00FF00FF00FFull) << 8)  | ((v >> 8)  & 0x00FF00FF00FF00FFull);
+        v = ((v & 0x0000FFFF0000FFFFull) << 16) | ((v >> 16) & 0x0000FFFF0000FFFFull);
+        return (v << 32) | (v >> 32);
+    }
+
+    std::uint64_t ctrl_;
+};
+
+#endif
+
+// Capacity Math =======================================================================================================
+
+/// Capacities are always 2^k - 1 so the capacity doubles as the probe mask
+constexpr std::size_t normalize_capacity(std::size_t n) noexcept
+{
+    return n ? ~std::size_t(0) >> std::countl_zero(n) : 1;
+}
+
+/// Number of elements a table of the given capacity holds before it must grow (max load factor 7/8)
+constexpr std::size_t capacity_to_growth(std::size_t capacity) noexcept
+{
+    if(group::width == 8 && capacity == 7) return 6;
+    return capacity - capacity / 8;
+}
+
+/// Smallest capacity, before normalization, whose growth is at least the given number of elements
+constexpr std::size_t growth_to_capacity(std::size_t growth) noexcept
+{
+    if(group::width == 8 && growth == 7) return 8;
+    return growth + (growth - 1) / 7;
+}
+
+/**
+ * \brief Triangular probe over groups; visits every group exactly once for power of two table sizes.
+ */
+class probe_seq
+{
+public:
+    probe_seq(std::size_t hash, std::size_t mask) noexcept : mask_(mask), offset_(hash & mask) { }
+
+    std::size_t offset()              const noexcept { return offset_; }
+    std::size_t offset(std::size_t i) const noexcept { return (offset_ + i) & mask_; }
+
+    void next() noexcept
+    {
+        index_  += group::width;
+        offset_  = (offset_ + index_) & mask_;
+    }
+
+    std::size_t index() const noexcept { return index_; }
+
+private:
+    std::size_t mask_;
+    std::size_t offset_;
+    std::size_t index_ = 0;
+};
+
+template<typename T, typename = void>
+struct is_transparent : std::false_type { };
+
+template<typename T>
+struct is_transparent<T, std::void_t<typename T::is_transparent>> : std::true_type { };
+
+/// Hashers that mark themselves is_avalanching already mix every input bit, so the table skips mix_hash
+template<typename T, typename = void>
+struct is_avalanching : std::false_type { };
+
+template<typename T>
+struct is_avalanching<T, std::void_t<typename T::is_avalanching>> : std::true_type { };
+
+template<bool Transparent>
+struct key_arg_select { template<typename K, typename Key> using type = Key; };
+
+template<>
+struct key_arg_select<true> { template<typename K, typename Key> using type = K; };
+
+// Policies ============================================================================================================
+
+template<typename K>
+struct set_policy
+{
+    using key_type   = K;
+    using value_type = K;
+    using slot_type  = K;
+
+    static const K& key(const slot_type& s) noexcept     { return s; }
+    static value_type& element(slot_type& s) noexcept    { return s; }
+
+    template<typename Alloc, typename...Args>
+    static void construct(Alloc& a, slot_type* s, Args&&...args)
+    {
+        std::allocator_traits<Alloc>::construct(a, s, std::forward<Args>(args)...);
+    }
+
+    template<typename Alloc>
+    static void destroy(Alloc& a, slot_type* s) noexcept { std::allocator_traits<Alloc>::destroy(a, s); }
+
+    template<typename Alloc>
+    static void transfer(Alloc& a, slot_type* dst, slot_type* src)
+    {
+        if constexpr(is_trivially_relocatable_v<K>)
+        {
+            std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), sizeof(slot_type));
+        }
+        else
+        {
+            construct(a, dst, std::move(*src));
+            destroy(a, src);
+        }
+    }
+};
+
+template<typename K, typename V>
+struct map_policy
+{
+    using key_type   = K;
+    using value_type = std::pair<const K, V>;
+
+    // Mirrors std::pair<const K, V> with a mutable key so rehashing can move keys instead of copying them
+    union slot_type
+    {
+        slot_type()  { }
+        ~slot_type() { }
+
+        value_type        value;
+        std::pair<K, V>   mutable_value;
+    };
+
+    static const K& key(const slot_type& s) noexcept  { return s.value.first; }
+    static value_type& element(slot_type& s) noexcept { return s.value; }
+
+    template<typename Alloc, typename...Args>
+    static void construct(Alloc& a, slot_type* s, Args&&...args)
+    {
+        std::allocator_traits<Alloc>::construct(a, std::addressof(s->value), std::forward<Args>(args)...);
+    }
+
+    template<typename Alloc>
+    static void destroy(Alloc& a, slot_type* s) noexcept
+    {
+        std::allocator_traits<Alloc>::destroy(a, std::addressof(s->value));
+    }
+
+    template<typename Alloc>
+    static void transfer(Alloc& a, slot_type* dst, slot_type* src)
+    {
+        if constexpr(is_trivially_relocatable_v<K> && is_trivially_relocatable_v<V>)
+        {
+            std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), sizeof(slot_type));
+        }
+        else
+        {
+            construct(a, dst, std::move(std::launder(&src->mutable_value)->first),
+                              std::move(std::launder(&src->mutable_value)->second));
+            destroy(a, src);
+        }
+    }
+};
+
+// Raw Table ===========================================================================================================
+
+/**
+ * \brief Open addressing table shared by hash_map and hash_set.
+ *
+ * Control bytes and slots live in one allocation: capacity control bytes, a sentinel, then group::width - 1 clones
+ * of the first control bytes so a group can be loaded at any offset without wrapping, followed by the slots.
+ */
+template<typename Policy, typename Hash, typename Eq, typename Alloc>
+class raw_hash_table
+{
+// Typedefs ============================================================================================================
+
+public:
+    using key_type        = typename Policy::key_type;
+    using value_type      = typename Policy::value_type;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher          = Hash;
+    using key_equal       = Eq;
+    using allocator_type  = Alloc;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+    using pointer         = typename std::allocator_traits<Alloc>::pointer;
+    using const_pointer   = typename std::allocator_traits<Alloc>::const_pointer;
+
+protected:
+    using slot_type = typename Policy::slot_type;
+
+    static constexpr bool transparent = is_transparent<Hash>::value && is_transparent<Eq>::value;
+
+    /// Lookup argument type: any type when both the hasher and the comparator are transparent, otherwise key_type.
+    /// Spelled through a member alias template so K stays deducible.
+    template<typename K>
+    using key_arg = typename key_arg_select<transparent>::template type<K, key_type>;
+
+    struct alignas(slot_type) slot_unit { unsigned char bytes[alignof(slot_type)]; };
+
+    using value_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<value_type>;
+    using unit_alloc  = typename std::allocator_traits<Alloc>::template rebind_alloc<slot_unit>;
+
+// Iterators ===========================================================================================================
+
+public:
+    template<bool Const>
+    class basic_iterator
+    {
+        friend class raw_hash_table;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = typename Policy::value_type;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = std::conditional_t<Const, const value_type&, value_type&>;
+        using pointer           = std::conditional_t<Const, const value_type*, value_type*>;
+
+        basic_iterator() noexcept = default;
+
+        template<bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& other) noexcept : ctrl_(other.ctrl_), slot_(other.slot_) { }
+
+        reference operator*()  const noexcept { return Policy::element(*slot_); }
+        pointer   operator->() const noexcept { return std::addressof(Policy::element(*slot_)); }
+
+        basic_iterator& operator++() noexcept
+        {
+            ++ctrl_;
+            ++slot_;
+            skip_empty_or_deleted_();
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept { basic_iterator tmp = *this; ++*this; return tmp; }
+
+        friend bool operator==(const basic_iterator& a, const basic_iterator& b) noexcept { return a.ctrl_ == b.ctrl_; }
+
+    private:
+        basic_iterator(const ctrl_t* ctrl, slot_type* slot) noexcept : ctrl_(ctrl), slot_(slot) { }
+
+        void skip_empty_or_deleted_() noexcept
+        {
+            while(is_empty_or_deleted(*ctrl_))
+            {
+                const std::uint32_t shift = group(ctrl_).count_leading_empty_or_deleted();
+                ctrl_ += shift;
+                slot_ += shift;
+            }
+        }
+
+        const ctrl_t* ctrl_ = nullptr;
+        slot_type*    slot_ = nullptr;
+
+        template<bool> friend class basic_iterator;
+    };
+
+    using iterator       = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    raw_hash_table() noexcept(std::is_nothrow_default_constructible_v<Hash> &&
+                              std::is_nothrow_default_constructible_v<Eq> &&
+                              std::is_nothrow_default_constructible_v<Alloc>) = default;
+
+    explicit raw_hash_table(size_type bucket_count, const Hash& hash = Hash(), const Eq& eq = Eq(),
+                            const Alloc& alloc = Alloc())
+        : hash_(hash), eq_(eq), alloc_(alloc)
+    {
+        if(bucket_count) resize_(normalize_capacity(bucket_count));
+    }
+
+    explicit raw_hash_table(const Alloc& alloc) : alloc_(alloc) { }
+
+    raw_hash_table(const raw_hash_table& other)
+        : raw_hash_table(other, std::allocator_traits<Alloc>::select_on_container_copy_construction(other.alloc_))
+    { }
+
+    raw_hash_table(const raw_hash_table& other, const Alloc& alloc)
+        : hash_(other.hash_), eq_(other.eq_), alloc_(alloc)
+    {
+        reserve(other.size());
+        try
+        {
+            for(const auto& v : other)
+            {
+                const size_type h = hash_of_(key_of_value_(v));
+                const size_type i = find_first_non_full_(h);
+                Policy::construct(alloc_, slots_ + i, v);
+                set_ctrl_(i, h2_(h));
+                --growth_left_;
+                ++size_;
+            }
+        }
+        catch(...)
+        {
+            // No destructor runs for a constructor that throws, so free the elements copied so far here
+            destroy_and_deallocate_();
+            throw;
+        }
+    }
+
+    raw_hash_table(raw_hash_table&& other) noexcept
+        : ctrl_(std::exchange(other.ctrl_, const_cast<ctrl_t*>(empty_group)))
+        , slots_(std::exchange(other.slots_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , capacity_(std::exchange(other.capacity_, 0))
+        , growth_left_(std::exchange(other.growth_left_, 0))
+        , hash_(std::move(other.hash_))
+        , eq_(std::move(other.eq_))
+        , alloc_(std::move(other.alloc_))
+    { }
+
+    raw_hash_table& operator=(const raw_hash_table& other)
+    {
+        if(this != &other)
+        {
+            constexpr bool propagate = std::allocator_traits<Alloc>::propagate_on_container_copy_assignment::value;
+            raw_hash_table tmp(other, propagate ? other.alloc_ : alloc_);
+            swap_contents_(tmp);
+            if constexpr(propagate) alloc_ = other.alloc_;
+        }
+        return *this;
+    }
+
+    raw_hash_table& operator=(raw_hash_table&& other)
+        noexcept(std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value ||
+                 std::allocator_traits<Alloc>::is_always_equal::value)
+    {
+        if(this == &other) return *this;
+
+        constexpr bool propagate = std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value;
+        if(propagate || alloc_ == other.alloc_)
+        {
+            destroy_and_deallocate_();
+            ctrl_        = std::exchange(other.ctrl_, const_cast<ctrl_t*>(empty_group));
+            slots_       = std::exchange(other.slots_, nullptr);
+            size_        = std::exchange(other.size_, 0);
+            capacity_    = std::exchange(other.capacity_, 0);
+            growth_left_ = std::exchange(other.growth_left_, 0);
+            hash_        = std::move(other.hash_);
+            eq_          = std::move(other.eq_);
+            if constexpr(propagate) alloc_ = std::move(other.alloc_);
+        }
+        else
+        {
+            clear();
+            hash_ = other.hash_;
+            eq_   = other.eq_;
+            reserve(other.size());
+            for(auto& v : other) emplace_unique_(std::move(v));
+            other.clear();
+        }
+        return *this;
+    }
+
+    ~raw_hash_table() { destroy_and_deallocate_(); }
+
+// Iterators -----------------------------------------------------------------------------------------------------------
+
+    iterator begin() noexcept
+    {
+        iterator it(ctrl_, slots_);
+        it.skip_empty_or_deleted_();
+        return it;
+    }
+
+    iterator end() noexcept { return iterator(ctrl_ + capacity_, nullptr); }
+
+    const_iterator begin()  const noexcept { return const_cast<raw_hash_table*>(this)->begin(); }
+    const_iterator end()    const noexcept { return const_cast<raw_hash_table*>(this)->end(); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend()   const noexcept { return end(); }
+
+// Capacity ------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] bool      empty()    const noexcept { return size_ == 0; }
+    [[nodiscard]] size_type size()     const noexcept { return size_; }
+    [[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+
+    [[nodiscard]] size_type max_size() const noexcept
+    {
+        return std::numeric_limits<size_type>::max() / (sizeof(slot_type) + 1) / 2;
+    }
+
+    [[nodiscard]] size_type bucket_count()    const noexcept { return capacity_; }
+    [[nodiscard]] float     load_factor()     const noexcept { return capacity_ ? float(size_) / float(capacity_) : 0.0f; }
+    [[nodiscard]] float     max_load_factor() const noexcept { return 7.0f / 8.0f; }
+
+    /// Present for std::unordered_map compatibility; the max load factor is fixed
+    void max_load_factor(float) noexcept { }
+
+    /**
+     * \brief Makes room for count elements.
+     *
+     * Afterwards the table holds count elements without rehashing, so iterators and references survive inserts up
+     * to that size, provided no element is erased in between (erasure may leave tombstones that consume capacity).
+     */
+    void reserve(size_type count)
+    {
+        if(count > size_ + growth_left_) resize_(normalize_capacity(growth_to_capacity(count)));
+    }
+
+    /**
+     * \brief Rehashes into at least count buckets, or into the smallest table that fits size() when count is 0.
+     *        Also purges tombstones.
+     */
+    void rehash(size_type count)
+    {
+        if(count == 0 && capacity_ == 0) return;
+        if(count == 0 && size_ == 0) { destroy_and_deallocate_(); reset_empty_(); return; }
+
+        const size_type needed = std::max(count, size_ ? growth_to_capacity(size_) : 0);
+        resize_(normalize_capacity(needed));
+    }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    void clear() noexcept
+    {
+        if(capacity_ == 0) return;
+
+        destroy_slots_();
+        reset_ctrl_();
+        size_        = 0;
+        growth_left_ = capacity_to_growth(capacity_);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) { return emplace_unique_(value); }
+    std::pair<iterator, bool> insert(value_type&& value)      { return emplace_unique_(std::move(value)); }
+
+    iterator insert(const_iterator, const value_type& value)  { return insert(value).first; }
+    iterator insert(const_iterator, value_type&& value)       { return insert(std::move(value)).first; }
+
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        if constexpr(std::is_base_of_v<std::forward_iterator_tag,
+                                       typename std::iterator_traits<InputIt>::iterator_category>)
+        {
+            reserve(size_ + static_cast<size_type>(std::distance(first, last)));
+        }
+        for(; first != last; ++first) emplace_unique_(*first);
+    }
+
+    void insert(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+    iterator erase(const_iterator pos) noexcept
+    {
+        iterator it(pos.ctrl_, pos.slot_);
+        erase_meta_(it);
+        ++it;
+        return it;
+    }
+
+    iterator erase(iterator pos) noexcept { return erase(const_iterator(pos)); }
+
+    iterator erase(const_iterator first, const_iterator last) noexcept
+    {
+        while(first != last) first = erase(first);
+        return iterator(last.ctrl_, last.slot_);
+    }
+
+    template<typename K = key_type>
+    size_type erase(const key_arg<K>& key)
+    {
+        auto it = find(key);
+        if(it == end()) return 0;
+        erase_meta_(it);
+        return 1;
+    }
+
+    void swap(raw_hash_table& other) noexcept
+    {
+        swap_contents_(other);
+        if constexpr(std::allocator_traits<Alloc>::propagate_on_container_swap::value)
+        {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        }
+    }
+
+    friend void swap(raw_hash_table& a, raw_hash_table& b) noexcept { a.swap(b); }
+
+// Lookup --------------------------------------------------------------------------------------------------------------
+
+    template<typename K = key_type>
+    [[nodiscard]] iterator find(const key_arg<K>& key)
+    {
+        return find_hashed_(key, hash_of_(key));
+    }
+
+    template<typename K = key_type>
+    [[nodiscard]] const_iterator find(const key_arg<K>& key) const
+    {
+        return const_cast<raw_hash_table*>(this)->find_hashed_(key, hash_of_(key));
+    }
+
+    template<typename K = key_type>
+    [[nodiscard]] bool contains(const key_arg<K>& key) const { return find(key) != end(); }
+
+    template<typename K = key_type>
+    [[nodiscard]] size_type count(const key_arg<K>& key) const { return contains(key) ? 1 : 0; }
+
+    template<typename K = key_type>
+    [[nodiscard]] std::pair<iterator, iterator> equal_range(const key_arg<K>& key)
+    {
+        auto it = find(key);
+        if(it == end()) return { it, it };
+        return { it, std::next(it) };
+    }
+
+    template<typename K = key_type>
+    [[nodiscard]] std::pair<const_iterator, const_iterator> equal_range(const key_arg<K>& key) const
+    {
+        auto it = find(key);
+        if(it == end()) return { it, it };
+        return { it, std::next(it) };
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] hasher         hash_function() const { return hash_; }
+    [[nodiscard]] key_equal      key_eq()        const { return eq_; }
+    [[nodiscard]] allocator_type get_allocator() const { return allocator_type(alloc_); }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+protected:
+    template<typename K>
+    size_type hash_of_(const K& key) const
+    {
+        if constexpr(is_avalanching<Hash>::value) return static_cast<size_type>(hash_(key));
+        else return static_cast<size_type>(mix_hash(static_cast<std::uint64_t>(hash_(key))));
+    }
+
+    static size_type    h1_(size_type hash) noexcept { return hash >> 7; }
+    static std::uint8_t h2_(size_type hash) noexcept { return static_cast<std::uint8_t>(hash & 0x7F); }
+
+    template<typename K>
+    iterator find_hashed_(const K& key, size_type hash)
+    {
+        probe_seq seq(h1_(hash), capacity_);
+        for(;;)
+        {
+            const group g(ctrl_ + seq.offset());
+            for(int i : g.match(h2_(hash)))
+            {
+                const size_type idx = seq.offset(static_cast<size_type>(i));
+                if(OCU_LIKELY(eq_(Policy::key(slots_[idx]), key))) return iterator(ctrl_ + idx, slots_ + idx);
+            }
+            if(OCU_LIKELY(g.match_empty())) return end();
+            seq.next();
+            OCU_ASSERT(seq.index() <= capacity_, "hash table probed every group without finding an empty slot");
+        }
+    }
+
+    size_type find_first_non_full_(size_type hash) const noexcept
+    {
+        probe_seq seq(h1_(hash), capacity_);
+        for(;;)
+        {
+            const group g(ctrl_ + seq.offset());
+            if(auto m = g.match_empty_or_deleted()) return seq.offset(static_cast<size_type>(m.lowest()));
+            seq.next();
+        }
+    }
+
+    /**
+     * \brief Finds key or claims a slot for it. The bool is true if the slot is new and must be constructed.
+     */
+    template<typename K>
+    std::pair<size_type, bool> find_or_prepare_insert_(const K& key)
+    {
+        const size_type hash = hash_of_(key);
+        probe_seq seq(h1_(hash), capacity_);
+        for(;;)
+        {
+            const group g(ctrl_ + seq.offset());
+            for(int i : g.match(h2_(hash)))
+            {
+                const size_type idx = seq.offset(static_cast<size_type>(i));
+                if(OCU_LIKELY(eq_(Policy::key(slots_[idx]), key))) return { idx, false };
+            }
+            if(OCU_LIKELY(g.match_empty())) break;
+            seq.next();
+        }
+        return { prepare_insert_(hash), true };
+    }
+
+    size_type prepare_insert_(size_type hash)
+    {
+        size_type target = find_first_non_full_(hash);
+        if(OCU_UNLIKELY(growth_left_ == 0 && ctrl_[target] != ctrl_deleted))
+        {
+            rehash_and_grow_();
+            target = find_first_non_full_(hash);
+        }
+        ++size_;
+        growth_left_ -= (ctrl_[target] == ctrl_empty);
+        set_ctrl_(target, h2_(hash));
+        return target;
+    }
+
+    iterator iterator_at_(size_type idx) noexcept { return iterator(ctrl_ + idx, slots_ + idx); }
+
+    template<typename...Args>
+    std::pair<iterator, bool> emplace_at_(const key_type& key, Args&&...args)
+    {
+        auto [idx, inserted] = find_or_prepare_insert_(key);
+        if(inserted) construct_at_(idx, std::forward<Args>(args)...);
+        return { iterator_at_(idx), inserted };
+    }
+
+    /// Inserts value if its key is not present yet
+    template<typename V>
+    std::pair<iterator, bool> emplace_unique_(V&& value)
+    {
+        auto [idx, inserted] = find_or_prepare_insert_(key_of_value_(value));
+        if(inserted) construct_at_(idx, std::forward<V>(value));
+        return { iterator_at_(idx), inserted };
+    }
+
+    template<typename V>
+    static const key_type& key_of_value_(const V& value) noexcept
+    {
+        if constexpr(std::is_same_v<key_type, value_type>) return value;
+        else                                                return value.first;
+    }
+
+    template<typename...Args>
+    void construct_at_(size_type idx, Args&&...args)
+    {
+        try
+        {
+            Policy::construct(alloc_, slots_ + idx, std::forward<Args>(args)...);
+        }
+        catch(...)
+        {
+            // Roll back the claimed slot so the table stays consistent
+            --size_;
+            erase_ctrl_(idx);
+            throw;
+        }
+    }
+
+    void erase_meta_(iterator it) noexcept
+    {
+        Policy::destroy(alloc_, it.slot_);
+        --size_;
+        erase_ctrl_(static_cast<size_type>(it.ctrl_ - ctrl_));
+    }
+
+    /**
+     * \brief Marks a slot free. If no probe ever saw a full group around the slot it can become empty again,
+     *        otherwise it becomes a tombstone so probe sequences that passed through it keep working.
+     */
+    void erase_ctrl_(size_type idx) noexcept
+    {
+        const size_type before = (idx - group::width) & capacity_;
+        const auto empty_after  = group(ctrl_ + idx).match_empty();
+        const auto empty_before = group(ctrl_ + before).match_empty();
+
+        const bool was_never_full = empty_before && empty_after &&
+            static_cast<size_type>(empty_after.trailing_zeros() + empty_before.leading_zeros()) < group::width;
+
+        set_ctrl_(idx, was_never_full ? ctrl_empty : ctrl_deleted);
+        growth_left_ += was_never_full;
+    }
+
+    void set_ctrl_(size_type idx, ctrl_t h) noexcept
+    {
+        constexpr size_type cloned = group::width - 1;
+        ctrl_[idx] = h;
+        ctrl_[((idx - cloned) & capacity_) + (cloned & capacity_)] = h;
+    }
+
+    void set_ctrl_(size_type idx, std::uint8_t h2) noexcept { set_ctrl_(idx, static_cast<ctrl_t>(h2)); }
+
+    void rehash_and_grow_()
+    {
+        // Mostly tombstones: rebuild at the same size instead of doubling
+        if(capacity_ > group::width && size_ * 32 <= capacity_ * 25) resize_(capacity_);
+        else                                                        resize_(capacity_ * 2 + 1);
+    }
+
+    static size_type ctrl_bytes_(size_type capacity) noexcept { return capacity + group::width; }
+
+    static size_type slot_offset_(size_type capacity) noexcept
+    {
+        return (ctrl_bytes_(capacity) + alignof(slot_type) - 1) / alignof(slot_type) * alignof(slot_type);
+    }
+
+    static size_type alloc_units_(size_type capacity) noexcept
+    {
+        return (slot_offset_(capacity) + capacity * sizeof(slot_type) + sizeof(slot_unit) - 1) / sizeof(slot_unit);
+    }
+
+    void resize_(size_type new_capacity)
+    {
+        OCU_ASSERT(new_capacity && ((new_capacity + 1) & new_capacity) == 0, "capacity must be 2^k - 1");
+        if(new_capacity > max_size()) throw std::length_error("hash table exceeds max_size()");
+
+        ctrl_t*         old_ctrl     = ctrl_;
+        slot_type*      old_slots    = slots_;
+        const size_type old_capacity = capacity_;
+
+        unit_alloc ua(alloc_);
+        slot_unit* mem = std::allocator_traits<unit_alloc>::allocate(ua, alloc_units_(new_capacity));
+        detail::track_allocation(memory_tag::hash_table, alloc_units_(new_capacity) * sizeof(slot_unit));
+
+        ctrl_     = reinterpret_cast<ctrl_t*>(mem);
+        slots_    = reinterpret_cast<slot_type*>(reinterpret_cast<unsigned char*>(mem) + slot_offset_(new_capacity));
+        capacity_ = new_capacity;
+        reset_ctrl_();
+        growth_left_ = capacity_to_growth(capacity_) - size_;
+
+        for(size_type i = 0; i < old_capacity; ++i)
+        {
+            if(!is_full(old_ctrl[i])) continue;
+
+            const size_type hash = hash_of_(Policy::key(old_slots[i]));
+            const size_type idx  = find_first_non_full_(hash);
+            set_ctrl_(idx, h2_(hash));
+            Policy::transfer(alloc_, slots_ + idx, old_slots + i);
+        }
+
+        if(old_capacity) deallocate_(old_ctrl, old_capacity);
+        if(size_)        detail::track_rehash(memory_tag::hash_table);
+    }
+
+    void reset_ctrl_() noexcept
+    {
+        std::memset(ctrl_, static_cast<unsigned char>(ctrl_empty), ctrl_bytes_(capacity_));
+        ctrl_[capacity_] = ctrl_sentinel;
+    }
+
+    void reset_empty_() noexcept
+    {
+        ctrl_        = const_cast<ctrl_t*>(empty_group);
+        slots_       = nullptr;
+        size_        = 0;
+        capacity_    = 0;
+        growth_left_ = 0;
+    }
+
+    void destroy_slots_() noexcept
+    {
+        if constexpr(!std::is_trivially_destructible_v<slot_type> || !std::is_trivially_destructible_v<value_type>)
+        {
+            for(size_type i = 0; i < capacity_; ++i)
+            {
+                if(is_full(ctrl_[i])) Policy::destroy(alloc_, slots_ + i);
+            }
+        }
+    }
+
+    void deallocate_() noexcept { deallocate_(ctrl_, capacity_); }
+
+    void deallocate_(ctrl_t* ctrl, size_type capacity) noexcept
+    {
+        detail::track_deallocation(memory_tag::hash_table, alloc_units_(capacity) * sizeof(slot_unit));
+        unit_alloc ua(alloc_);
+        std::allocator_traits<unit_alloc>::deallocate(ua, reinterpret_cast<slot_unit*>(ctrl), alloc_units_(capacity));
+    }
+
+    void destroy_and_deallocate_() noexcept
+    {
+        if(capacity_ == 0) return;
+        destroy_slots_();
+        deallocate_();
+        reset_empty_();
+    }
+
+    void swap_contents_(raw_hash_table& other) noexcept
+    {
+        using std::swap;
+        swap(ctrl_,        other.ctrl_);
+        swap(slots_,       other.slots_);
+        swap(size_,        other.size_);
+        swap(capacity_,    other.capacity_);
+        swap(growth_left_, other.growth_left_);
+        swap(hash_,        other.hash_);
+        swap(eq_,          other.eq_);
+    }
+
+// Variables ===========================================================================================================
+
+protected:
+    ctrl_t*      ctrl_        = const_cast<ctrl_t*>(empty_group);
+    slot_type*   slots_       = nullptr;
+    size_type    size_        = 0;
+    size_type    capacity_    = 0;
+    size_type    growth_left_ = 0;
+
+    OCU_NO_UNIQUE_ADDRESS Hash        hash_;
+    OCU_NO_UNIQUE_ADDRESS Eq          eq_;
+    OCU_NO_UNIQUE_ADDRESS value_alloc alloc_;
+};
+
+}
+
+// hash_set ============================================================================================================
+
+/**
+ * \brief Flat open addressing set in the style of Swiss tables.
+ *
+ * Elements are stored inline in one array with a parallel array of 7-bit hash fragments that is probed 16 slots at a
+ * time with SSE2 or NEON. Lookups touch one control group and, on a fragment match, one slot, so there is no node
+ * chasing. Erase never shifts elements; a slot only becomes a tombstone when a probe sequence may have passed it.
+ *
+ * Hash defaults to open_cpp_utils::hash. The results of hashers that do not define is_avalanching, std::hash for
+ * one, are remixed before use. When both Hash and Eq define is_transparent, find/contains/count/erase accept any
+ * key-like type without constructing a key_type.
+ *
+ * Rehashing moves elements, so iterators, pointers and references are invalidated by any insert that grows the
+ * table; use reserve() to prevent that.
+ */
+template<typename K,
+         typename Hash  = open_cpp_utils::hash<K>,
+         typename Eq    = std::equal_to<K>,
+         typename Alloc = std::allocator<K>>
+class hash_set : public detail::raw_hash_table<detail::set_policy<K>, Hash, Eq, Alloc>
+{
+    using base = detail::raw_hash_table<detail::set_policy<K>, Hash, Eq, Alloc>;
+
+public:
+    using typename base::key_type;
+    using typename base::value_type;
+    using typename base::size_type;
+    using typename base::iterator;
+    using typename base::const_iterator;
+
+    using base::base;
+    using base::insert;
+
+    hash_set() = default;
+
+    template<typename InputIt>
+    hash_set(InputIt first, InputIt last, size_type bucket_count = 0, const Hash& hash = Hash(),
+             const Eq& eq = Eq(), const Alloc& alloc = Alloc())
+        : base(bucket_count, hash, eq, alloc)
+    { this->insert(first, last); }
+
+    hash_set(std::initializer_list<K> ilist, size_type bucket_count = 0, const Hash& hash = Hash(),
+             const Eq& eq = Eq(), const Alloc& alloc = Alloc())
+        : base(bucket_count, hash, eq, alloc)
+    { this->insert(ilist); }
+
+    template<typename...Args>
+    std::pair<iterator, bool> emplace(Args&&...args)
+    {
+        if constexpr(sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, K> && ...))
+        {
+            return this->emplace_unique_(std::forward<Args>(args)...);
+        }
+        else
+        {
+            return this->emplace_unique_(K(std::forward<Args>(args)...));
+        }
+    }
+
+    template<typename...Args>
+    iterator emplace_hint(const_iterator, Args&&...args) { return emplace(std::forward<Args>(args)...).first; }
+
+    friend bool operator==(const hash_set& a, const hash_set& b)
+    {
+        if(a.size() != b.size()) return false;
+        for(const auto& k : a)
+        {
+            if(!b.contains(k)) return false;
+        }
+        return true;
+    }
+};
+
+// hash_map ============================================================================================================
+
+/**
+ * \brief Flat open addressing map in the style of Swiss tables. See hash_set for the layout and guarantees.
+ *
+ * value_type is std::pair<const K, V> as in std::unordered_map; keys are moved rather than copied on rehash.
+ */
+template<typename K, typename V,
+         typename Hash  = open_cpp_utils::hash<K>,
+         typename Eq    = std::equal_to<K>,
+         typename Alloc = std::allocator<std::pair<const K, V>>>
+class hash_map : public detail::raw_hash_table<detail::map_policy<K, V>, Hash, Eq, Alloc>
+{
+    using base = detail::raw_hash_table<detail::map_policy<K, V>, Hash, Eq, Alloc>;
+
+    template<typename Q>
+    using key_arg = typename base::template key_arg<Q>;
+
+public:
+    using typename base::key_type;
+    using typename base::value_type;
+    using typename base::size_type;
+    using typename base::iterator;
+    using typename base::const_iterator;
+    using mapped_type = V;
+
+    using base::base;
+    using base::insert;
+
+    hash_map() = default;
+
+    template<typename InputIt>
+    hash_map(InputIt first, InputIt last, size_type bucket_count = 0, const Hash& hash = Hash(),
+             const Eq& eq = Eq(), const Alloc& alloc = Alloc())
+        : base(bucket_count, hash, eq, alloc)
+    { this->insert(first, last); }
+
+    hash_map(std::initializer_list<value_type> ilist, size_type bucket_count = 0, const Hash& hash = Hash(),
+             const Eq& eq = Eq(), const Alloc& alloc = Alloc())
+        : base(bucket_count, hash, eq, alloc)
+    { this->insert(ilist); }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    template<typename P, typename = std::enable_if_t<std::is_constructible_v<value_type, P&&>>>
+    std::pair<iterator, bool> insert(P&& value) { return emplace(std::forward<P>(value)); }
+
+    template<typename...Args>
+    std::pair<iterator, bool> try_emplace(const key_type& key, Args&&...args)
+    {
+        return this->emplace_at_(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template<typename...Args>
+    std::pair<iterator, bool> try_emplace(key_type&& key, Args&&...args)
+    {
+        auto [idx, inserted] = this->find_or_prepare_insert_(key);
+        if(inserted)
+        {
+            this->construct_at_(idx, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+        return { this->iterator_at_(idx), inserted };
+    }
+
+    template<typename...Args>
+    iterator try_emplace(const_iterator, const key_type& key, Args&&...args)
+    {
+        return try_emplace(key, std::forward<Args>(args)...).first;
+    }
+
+    template<typename...Args>
+    iterator try_emplace(const_iterator, key_type&& key, Args&&...args)
+    {
+        return try_emplace(std::move(key), std::forward<Args>(args)...).first;
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj)
+    {
+        auto result = try_emplace(key, std::forward<M>(obj));
+        if(!result.second) result.first->second = std::forward<M>(obj);
+        return result;
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(key_type&& key, M&& obj)
+    {
+        auto result = try_emplace(std::move(key), std::forward<M>(obj));
+        if(!result.second) result.first->second = std::forward<M>(obj);
+        return result;
+    }
+
+    /**
+     * \brief Inserts a value constructed from args if its key is absent. The common (key, mapped) form is looked up
+     *        before anything is constructed; other forms build a temporary pair first.
+     */
+    template<typename...Args>
+    std::pair<iterator, bool> emplace(Args&&...args)
+    {
+        if constexpr(sizeof...(Args) == 2)
+        {
+            return emplace_pair_(std::forward<Args>(args)...);
+        }
+        else if constexpr(sizeof...(Args) == 1 && (is_pair_<std::remove_cvref_t<Args>>::value && ...))
+        {
+            return emplace_from_pair_(std::forward<Args>(args)...);
+        }
+        else
+        {
+            return this->emplace_unique_(value_type(std::forward<Args>(args)...));
+        }
+    }
+
+    template<typename...Args>
+    iterator emplace_hint(const_iterator, Args&&...args) { return emplace(std::forward<Args>(args)...).first; }
+
+// Lookup --------------------------------------------------------------------------------------------------------------
+
+    V& operator[](const key_type& key) { return try_emplace(key).first->second; }
+    V& operator[](key_type&& key)      { return try_emplace(std::move(key)).first->second; }
+
+    template<typename Q = key_type>
+    V& at(const key_arg<Q>& key)
+    {
+        auto it = this->find(key);
+        if(it == this->end()) throw std::out_of_range("hash_map::at: key not found");
+        return it->second;
+    }
+
+    template<typename Q = key_type>
+    const V& at(const key_arg<Q>& key) const
+    {
+        auto it = this->find(key);
+        if(it == this->end()) throw std::out_of_range("hash_map::at: key not found");
+        return it->second;
+    }
+
+    friend bool operator==(const hash_map& a, const hash_map& b)
+    {
+        if(a.size() != b.size()) return false;
+        for(const auto& [k, v] : a)
+        {
+            auto it = b.find(k);
+            if(it == b.end() || !(it->second == v)) return false;
+        }
+        return true;
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    template<typename T>
+    struct is_pair_ : std::false_type { };
+
+    template<typename A, typename B>
+    struct is_pair_<std::pair<A, B>> : std::true_type { };
+
+    template<typename A, typename B>
+    std::pair<iterator, bool> emplace_pair_(A&& a, B&& b)
+    {
+        if constexpr(std::is_same_v<std::remove_cvref_t<A>, K>)
+        {
+            return try_emplace(std::forward<A>(a), std::forward<B>(b));
+        }
+        else if constexpr(std::is_same_v<std::remove_cvref_t<A>, std::piecewise_construct_t>)
+        {
+            return this->emplace_unique_(value_type(std::forward<A>(a), std::forward<B>(b)));
+        }
+        else
+        {
+            return try_emplace(K(std::forward<A>(a)), std::forward<B>(b));
+        }
+    }
+
+    template<typename P>
+    std::pair<iterator, bool> emplace_from_pair_(P&& p)
+    {
+        if constexpr(std::is_same_v<std::remove_cvref_t<decltype(p.first)>, K>)
+        {
+            if constexpr(std::is_rvalue_reference_v<P&&>) return try_emplace(std::move(p.first), std::move(p.second));
+            else                                          return try_emplace(p.first, p.second);
+        }
+        else
+        {
+            return this->emplace_unique_(value_type(std::forward<P>(p)));
+        }
+    }
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_HASH_TABLE_H
@@ -0,0 +1,360 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_INTERN_H
+#define OPEN_CPP_UTILS_INTERN_H
+
+#include "config.h"
+#include "arena.h"
+#include "hash.h"
+#include "optional.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace open_cpp_utils
+{
+
+// symbol ==============================================================================================================
+
+/**
+ * \brief Handle of a string interned in an interner: 32 bits that compare, order and hash as the integer they are.
+ *
+ * Equal strings interned in the same interner get equal symbols, so a hash_map<symbol, V> costs what a map keyed by
+ * an integer does. Ordering is by interning order, not by the strings. A default constructed symbol is the empty
+ * string of every interner.
+ */
+class symbol
+{
+// Typedefs ============================================================================================================
+
+public:
+    using value_type = std::uint32_t;
+
+// Functions ===========================================================================================================
+
+public:
+    constexpr symbol() noexcept = default;
+
+    /**
+     * \brief Wraps a value previously obtained from value(); it is only meaningful to the interner that issued it
+     */
+    static constexpr symbol from_value(value_type v) noexcept { return symbol(v); }
+
+    [[nodiscard]] constexpr value_type value() const noexcept { return value_; }
+
+    /// Whether this is the empty string
+    [[nodiscard]] constexpr bool empty() const noexcept { return value_ == 0; }
+
+    friend constexpr bool operator==(symbol, symbol) noexcept = default;
+    friend constexpr auto operator<=>(symbol, symbol) noexcept = default;
+
+private:
+    constexpr explicit symbol(value_type v) noexcept : value_(v) { }
+
+// Variables ===========================================================================================================
+
+private:
+    value_type value_ = 0;
+};
+
+// interner ============================================================================================================
+
+/**
+ * \brief Concurrent string interner. Each distinct string is stored once and named by a dense 32-bit symbol.
+ *
+ * Strings are copied, NUL terminated, into per-shard monotonic arenas, so they sit contiguously and never move; a
+ * string_view returned by view() stays valid for the interner's lifetime. The shard is chosen by the top bits of the
+ * string's hash and has its own open addressing table whose slots hold a 32-bit hash tag, the symbol and a pointer
+ * to the stored string, which is prefixed with its size. Slots are written once and tables only ever grow, so
+ * lookups of strings that are already interned take no lock and write no shared memory: they load a slot, compare
+ * the tag, then the bytes. Only inserting a new string locks its shard.
+ *
+ * A table that a shard outgrows is kept rather than freed, since a concurrent lookup may still be probing it; a
+ * lookup that started on it and misses simply retries under the lock. The kept tables add up to less than the
+ * current ones. Symbols index a segmented table of (pointer, size) records that never relocates, so view() is two
+ * dependent loads.
+ */
+class interner
+{
+// Typedefs ============================================================================================================
+
+public:
+    using size_type = std::size_t;
+
+    static constexpr size_type shard_count = 16;
+
+private:
+    static constexpr int       shard_shift   = 64 - std::countr_zero(shard_count);
+    static constexpr int       segment_shift = 10;
+    static constexpr size_type segment_count = 32 - segment_shift + 1;
+    static constexpr size_type min_capacity  = 64;
+
+    struct entry
+    {
+        const char*   data;
+        std::uint32_t size;
+        std::uint32_t hash;   ///< Low half of the string's hash, to rehash without rereading the string
+    };
+
+    /// Tag and symbol in one word, written last, plus the string so a lookup can compare it without a detour
+    struct slot
+    {
+        std::atomic<std::uint64_t> word{ 0 };
+        std::atomic<const char*>   str{ nullptr };
+    };
+
+    struct table
+    {
+        explicit table(size_type capacity) : mask(capacity - 1), slots(new slot[capacity]()) { }
+
+        size_type               mask;
+        std::unique_ptr<slot[]> slots;
+    };
+
+    struct alignas(cache_line_size) shard
+    {
+        std::atomic<table*>                 current{ nullptr };
+        std::mutex                          mutex;
+        size_type                           size = 0;
+        monotonic_arena                     strings;
+        std::vector<std::unique_ptr<table>> tables;   ///< The current table and every one it replaced
+    };
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    interner()
+    {
+        segments_[0].store(new entry[size_type(1) << segment_shift](), std::memory_order_relaxed);
+        segments_[0].load(std::memory_order_relaxed)[0] = { "", 0, 0 };
+    }
+
+    interner(const interner&) = delete;
+    interner& operator=(const interner&) = delete;
+
+    ~interner()
+    {
+        for(std::atomic<entry*>& s : segments_) delete[] s.load(std::memory_order_relaxed);
+    }
+
+// Interning -----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Symbol of str, interning a copy of it first if it is new. Lock-free when str is already interned.
+     * \throws std::overflow_error when all 2^32 symbols are taken
+     */
+    [[nodiscard]] symbol intern(std::string_view str)
+    {
+        if(str.empty()) return symbol();
+
+        const std::uint64_t h = detail::hash_bytes(str.data(), str.size());
+        shard&              s = shards_[h >> shard_shift];
+        if(optional<symbol> found = find_in_(s.current.load(std::memory_order_acquire), str, h)) return *found;
+
+        std::lock_guard lock(s.mutex);
+        table* t = s.current.load(std::memory_order_relaxed);
+        if(optional<symbol> found = find_in_(t, str, h)) return *found;
+        return insert_(s, t, str, h);
+    }
+
+    /**
+     * \brief Symbol of str if it has been interned. Never locks or allocates.
+     */
+    [[nodiscard]] optional<symbol> find(std::string_view str) const noexcept
+    {
+        if(str.empty()) return symbol();
+
+        const std::uint64_t h = detail::hash_bytes(str.data(), str.size());
+        return find_in_(shards_[h >> shard_shift].current.load(std::memory_order_acquire), str, h);
+    }
+
+// Access --------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief The string sym names, valid until the interner is destroyed. sym must come from this interner.
+     */
+    [[nodiscard]] std::string_view view(symbol sym) const noexcept
+    {
+        const entry& e = entry_(sym.value());
+        return { e.data, e.size };
+    }
+
+    /**
+     * \brief The string sym names as a NUL terminated C string
+     */
+    [[nodiscard]] const char* c_str(symbol sym) const noexcept { return entry_(sym.value()).data; }
+
+    /**
+     * \brief Number of symbols handed out, counting the empty string
+     */
+    [[nodiscard]] size_type size() const noexcept { return next_.load(std::memory_order_relaxed); }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    [[nodiscard]] static std::uint32_t tag_of_(std::uint64_t h) noexcept
+    {
+        // Clear of both the shard bits at the top and the low bits that pick the slot
+        return static_cast<std::uint32_t>(h >> 27);
+    }
+
+    [[nodiscard]] static size_type segment_of_(std::uint32_t id) noexcept
+    {
+        return static_cast<size_type>(std::bit_width(id >> segment_shift));
+    }
+
+    [[nodiscard]] static size_type segment_base_(size_type segment) noexcept
+    {
+        return segment == 0 ? 0 : size_type(1) << (segment_shift + segment - 1);
+    }
+
+    [[nodiscard]] static size_type segment_size_(size_type segment) noexcept
+    {
+        return size_type(1) << (segment == 0 ? segment_shift : segment_shift + segment - 1);
+    }
+
+    [[nodiscard]] const entry& entry_(std::uint32_t id) const noexcept
+    {
+        const size_type seg = segment_of_(id);
+        OCU_ASSERT(id < size(), "symbol was not issued by this interner");
+        return segments_[seg].load(std::memory_order_acquire)[id - segment_base_(seg)];
+    }
+
+    /// Record for a freshly reserved id, allocating its segment if no other thread has yet
+    entry& new_entry_(std::uint32_t id)
+    {
+        const size_type seg = segment_of_(id);
+        entry*          e   = segments_[seg].load(std::memory_order_acquire);
+        if(OCU_UNLIKELY(e == nullptr))
+        {
+            auto fresh = std::make_unique<entry[]>(segment_size_(seg));
+            if(segments_[seg].compare_exchange_strong(e, fresh.get(), std::memory_order_acq_rel)) e = fresh.release();
+        }
+        return e[id - segment_base_(seg)];
+    }
+
+    [[nodiscard]] optional<symbol> find_in_(const table* t, std::string_view str, std::uint64_t h) const noexcept
+    {
+        if(t == nullptr) return { };
+
+        const std::uint32_t tag = tag_of_(h);
+        for(size_type i = static_cast<size_type>(h) & t->mask;; i = (i + 1) & t->mask)
+        {
+            const std::uint64_t w = t->slots[i].word.load(std::memory_order_acquire);
+            if(w == 0) return { };
+            if(static_cast<std::uint32_t>(w >> 32) != tag) continue;
+
+            const char*   p = t->slots[i].str.load(std::memory_order_relaxed);
+            std::uint32_t size;
+            std::memcpy(&size, p - sizeof(size), sizeof(size));
+            if(size == str.size() && std::memcmp(p, str.data(), str.size()) == 0)
+            {
+                return symbol::from_value(static_cast<std::uint32_t>(w));
+            }
+        }
+    }
+
+    static void place_(table& t, std::uint64_t word, const char* str, std::uint32_t hash) noexcept
+    {
+        size_type i = hash & t.mask;
+        while(t.slots[i].word.load(std::memory_order_relaxed) != 0) i = (i + 1) & t.mask;
+        t.slots[i].str.store(str, std::memory_order_relaxed);
+        t.slots[i].word.store(word, std::memory_order_release);
+    }
+
+    /// Caller holds the shard mutex and has checked that str is absent from t, the current table
+    symbol insert_(shard& s, table* t, std::string_view str, std::uint64_t h)
+    {
+        if(OCU_UNLIKELY(str.size() > std::numeric_limits<std::uint32_t>::max()))
+        {
+            throw std::length_error("interner strings are limited to 4 GiB");
+        }
+        if(t == nullptr || (s.size + 1) * 4 > (t->mask + 1) * 3) t = grow_(s, t);
+
+        const std::uint32_t id = next_.fetch_add(1, std::memory_order_relaxed);
+        if(OCU_UNLIKELY(id == std::numeric_limits<std::uint32_t>::max()))
+        {
+            next_.store(id, std::memory_order_relaxed);
+            throw std::overflow_error("interner symbol space exhausted");
+        }
+
+        // Stored as [u32 size][bytes][NUL] so a lookup finds the size right before the bytes it compares
+        const auto size = static_cast<std::uint32_t>(str.size());
+        char*      copy = static_cast<char*>(s.strings.allocate(sizeof(size) + str.size() + 1, alignof(std::uint32_t)));
+        std::memcpy(copy, &size, sizeof(size));
+        copy += sizeof(size);
+        std::memcpy(copy, str.data(), str.size());
+        copy[str.size()] = '\0';
+        new_entry_(id) = { copy, size, static_cast<std::uint32_t>(h) };
+
+        // The release store of the slot publishes the entry and the string along with it
+        place_(*t, (static_cast<std::uint64_t>(tag_of_(h)) << 32) | id, copy, static_cast<std::uint32_t>(h));
+        ++s.size;
+        return symbol::from_value(id);
+    }
+
+    /// Publishes a table twice the size holding the shard's symbols. Caller holds the shard mutex.
+    table* grow_(shard& s, const table* old)
+    {
+        auto fresh = std::make_unique<table>(old == nullptr ? min_capacity : (old->mask + 1) * 2);
+        if(old != nullptr)
+        {
+            for(size_type i = 0; i <= old->mask; ++i)
+            {
+                const std::uint64_t w = old->slots[i].word.load(std::memory_order_relaxed);
+                if(w == 0) continue;
+                const entry& e = entry_(static_cast<std::uint32_t>(w));
+                place_(*fresh, w, e.data, e.hash);
+            }
+        }
+
+        table* t = fresh.get();
+        s.tables.push_back(std::move(fresh));
+        s.current.store(t, std::memory_order_release);
+        return t;
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::array<shard, shard_count>                      shards_;
+    std::array<std::atomic<entry*>, segment_count>      segments_{ };
+    alignas(cache_line_size) std::atomic<std::uint32_t> next_{ 1 };
+};
+
+/**
+ * \brief Process-wide interner, for symbols shared across subsystems
+ */
+[[nodiscard]] inline interner& default_interner()
+{
+    static interner i;
+    return i;
+}
+
+}
+
+template<>
+struct std::hash<open_cpp_utils::symbol>
+{
+    std::size_t operator()(open_cpp_utils::symbol s) const noexcept { return std::hash<std::uint32_t>{ }(s.value()); }
+};
+
+#endif // OPEN_CPP_UTILS_INTERN_H
@@ -0,0 +1,183 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_MEMORY_STATS_H
+#define OPEN_CPP_UTILS_MEMORY_STATS_H
+
+#include "config.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \file
+ * \brief Opt-in accounting of the memory the library's containers take from their allocators.
+ *
+ * With OCU_TRACK_ALLOCATIONS defined, object_pool chunks, arena blocks, small_vector heap buffers and hash_table
+ * slot arrays report every allocation and release to one set of global counters per memory_tag, and memory_stats()
+ * returns a snapshot of them. Counters cost one or two relaxed atomic operations per allocation, not per element.
+ *
+ * Without it the hooks are empty inline functions, containers are exactly as they were and memory_stats() returns
+ * zeros. The setting changes inline function bodies, so it must be the same in every translation unit of a program;
+ * the OPEN_CPP_UTILS_TRACK_ALLOCATIONS CMake option defines it for everything linking the library.
+ */
+
+namespace open_cpp_utils
+{
+
+// Typedefs ============================================================================================================
+
+/// Which kind of container an allocation belongs to
+enum class memory_tag : std::uint8_t
+{
+    object_pool,
+    arena,
+    small_vector,
+    hash_table,
+};
+
+inline constexpr std::size_t memory_tag_count = 4;
+
+/// True when the library was built with OCU_TRACK_ALLOCATIONS, i.e. when memory_stats() reports anything
+#if defined(OCU_TRACK_ALLOCATIONS)
+inline constexpr bool memory_tracking_enabled = true;
+#else
+inline constexpr bool memory_tracking_enabled = false;
+#endif
+
+[[nodiscard]] constexpr const char* memory_tag_name(memory_tag tag) noexcept
+{
+    switch(tag)
+    {
+    case memory_tag::object_pool:  return "object_pool";
+    case memory_tag::arena:        return "arena";
+    case memory_tag::small_vector: return "small_vector";
+    case memory_tag::hash_table:   return "hash_table";
+    }
+    return "unknown";
+}
+
+/// Counters of one memory_tag, summed over every container and thread
+struct memory_tag_stats
+{
+    std::size_t bytes_live  = 0; ///< Bytes currently held
+    std::size_t bytes_peak  = 0; ///< Highest bytes_live since start or the last reset_memory_peaks()
+    std::size_t allocations = 0; ///< Allocations made so far
+    std::size_t rehashes    = 0; ///< Times a populated table moved its elements into a new slot array
+};
+
+/**
+ * \brief memory_stats() result. Each tag's counters are read one after another without a lock, so they may be a few
+ *        allocations apart from each other while other threads allocate.
+ */
+struct memory_snapshot
+{
+    memory_tag_stats tags[memory_tag_count];
+
+    [[nodiscard]] const memory_tag_stats& operator[](memory_tag tag) const noexcept
+    {
+        return tags[static_cast<std::size_t>(tag)];
+    }
+
+    /// bytes_live over every tag
+    [[nodiscard]] std::size_t bytes_live() const noexcept
+    {
+        std::size_t sum = 0;
+        for(const memory_tag_stats& t : tags) sum += t.bytes_live;
+        return sum;
+    }
+};
+
+// Counters ============================================================================================================
+
+namespace detail
+{
+
+#if defined(OCU_TRACK_ALLOCATIONS)
+
+struct alignas(cache_line_size) memory_counters
+{
+    std::atomic<std::size_t> live{ 0 };
+    std::atomic<std::size_t> peak{ 0 };
+    std::atomic<std::size_t> allocations{ 0 };
+    std::atomic<std::size_t> rehashes{ 0 };
+};
+
+inline memory_counters memory_counters_table[memory_tag_count];
+
+inline memory_counters& memory_counters_of(memory_tag tag) noexcept
+{
+    return memory_counters_table[static_cast<std::size_t>(tag)];
+}
+
+#endif
+
+/// Records bytes taken from an allocator on behalf of a tag container
+OCU_FORCEINLINE void track_allocation([[maybe_unused]] memory_tag tag, [[maybe_unused]] std::size_t bytes) noexcept
+{
+#if defined(OCU_TRACK_ALLOCATIONS)
+    memory_counters& c    = memory_counters_of(tag);
+    const std::size_t now = c.live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+
+    std::size_t peak = c.peak.load(std::memory_order_relaxed);
+    while(now > peak && !c.peak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) { }
+#endif
+}
+
+/// Records bytes given back to the allocator; must match an earlier track_allocation of the same tag
+OCU_FORCEINLINE void track_deallocation([[maybe_unused]] memory_tag tag, [[maybe_unused]] std::size_t bytes) noexcept
+{
+#if defined(OCU_TRACK_ALLOCATIONS)
+    memory_counters_of(tag).live.fetch_sub(bytes, std::memory_order_relaxed);
+#endif
+}
+
+OCU_FORCEINLINE void track_rehash([[maybe_unused]] memory_tag tag) noexcept
+{
+#if defined(OCU_TRACK_ALLOCATIONS)
+    memory_counters_of(tag).rehashes.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+}
+
+// Functions ===========================================================================================================
+
+/**
+ * \brief Current counters of every memory_tag; all zero unless memory_tracking_enabled. See profile_memory_stats()
+ *        in profile.h to record them next to the profiling zones.
+ */
+[[nodiscard]] inline memory_snapshot memory_stats() noexcept
+{
+    memory_snapshot s;
+#if defined(OCU_TRACK_ALLOCATIONS)
+    for(std::size_t i = 0; i < memory_tag_count; ++i)
+    {
+        const detail::memory_counters& c = detail::memory_counters_table[i];
+        s.tags[i].bytes_live  = c.live.load(std::memory_order_relaxed);
+        s.tags[i].bytes_peak  = c.peak.load(std::memory_order_relaxed);
+        s.tags[i].allocations = c.allocations.load(std::memory_order_relaxed);
+        s.tags[i].rehashes    = c.rehashes.load(std::memory_order_relaxed);
+    }
+#endif
+    return s;
+}
+
+/// Lowers every bytes_peak to the current bytes_live, e.g. to measure the peak of one phase of a program
+inline void reset_memory_peaks() noexcept
+{
+#if defined(OCU_TRACK_ALLOCATIONS)
+    for(detail::memory_counters& c : detail::memory_counters_table)
+    {
+        c.peak.store(c.live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+#endif
+}
+
+}
+
+#endif // OPEN_CPP_UTILS_MEMORY_STATS_H
@@ -0,0 +1,408 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_OBJECT_POOL_H
+#define OPEN_CPP_UTILS_OBJECT_POOL_H
+
+#include "config.h"
+#include "memory_stats.h"
+#include "optional.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace open_cpp_utils
+{
+
+/**
+ * \brief 32-bit generational reference to an object owned by an object_pool<T>.
+ *
+ * The low 24 bits address the slot and the high 8 bits hold the slot's generation at the time it was acquired.
+ * Live generations are always odd, so the all zero value (the default) never refers to an object.
+ *
+ * \tparam T Pooled type, only used to keep handles of different pools apart
+ */
+template<typename T>
+class pool_handle
+{
+public:
+    using value_type = std::uint32_t;
+
+    static constexpr value_type index_bits      = 24;
+    static constexpr value_type generation_bits = 32 - index_bits;
+    static constexpr value_type index_mask      = (value_type(1) << index_bits) - 1;
+    static constexpr value_type max_slots       = index_mask + 1;
+
+    constexpr pool_handle() noexcept : value_(0) { }
+
+    constexpr pool_handle(value_type index, value_type generation) noexcept
+        : value_((generation << index_bits) | (index & index_mask))
+    { }
+
+    /// Reconstructs a handle from raw()
+    static constexpr pool_handle from_raw(value_type raw) noexcept { pool_handle h; h.value_ = raw; return h; }
+
+    [[nodiscard]] constexpr value_type raw()        const noexcept { return value_; }
+    [[nodiscard]] constexpr value_type index()      const noexcept { return value_ & index_mask; }
+    [[nodiscard]] constexpr value_type generation() const noexcept { return value_ >> index_bits; }
+
+    /// True for any handle produced by a pool, even if the object has since been released
+    constexpr explicit operator bool() const noexcept { return value_ != 0; }
+
+    friend constexpr bool operator==(pool_handle, pool_handle) noexcept = default;
+    friend constexpr auto operator<=>(pool_handle, pool_handle) noexcept = default;
+
+private:
+    value_type value_;
+};
+
+static_assert(sizeof(pool_handle<int>) == 4);
+
+/// optional<pool_handle<T>> uses the null handle as its empty state and stays four bytes
+template<typename T>
+struct niche_traits<pool_handle<T>>
+{
+    static constexpr pool_handle<T> empty() noexcept { return pool_handle<T>(); }
+    static constexpr bool is_empty(pool_handle<T> h) noexcept { return h.raw() == 0; }
+};
+
+static_assert(sizeof(optional<pool_handle<int>>) == sizeof(pool_handle<int>));
+
+/**
+ * \brief Fixed-slot object pool with chunked slab storage, an intrusive free list and generational handles.
+ *
+ * Objects live in chunks of ChunkSize slots that are never moved or freed while the pool is alive, so pointers and
+ * references obtained through a handle stay valid until that object is released, no matter how much the pool grows.
+ * Free slots store the index of the next free slot in place of the object, which makes acquire() and release() a
+ * couple of loads and stores with no heap traffic once the pool has enough chunks.
+ *
+ * Every slot carries an 8-bit generation that is bumped on acquire and on release. get() returns nullptr for a
+ * handle whose generation no longer matches, and operator[] / release() assert on it in debug builds, which catches
+ * use-after-free and double release. After 128 reuses of the same slot a stale handle can alias a new object again,
+ * so handles are a debugging aid rather than a security boundary.
+ *
+ * The pool is not thread safe.
+ *
+ * \tparam T         Pooled type
+ * \tparam ChunkSize Number of slots allocated at once when the pool runs out of free slots
+ */
+template<typename T, std::size_t ChunkSize = 1024>
+class object_pool
+{
+    static_assert(ChunkSize > 0, "object_pool chunks must hold at least one slot");
+    static_assert(ChunkSize <= pool_handle<T>::max_slots, "object_pool chunk exceeds the handle index range");
+
+// Typedefs ============================================================================================================
+
+public:
+    using value_type      = T;
+    using size_type       = std::size_t;
+    using reference       = T&;
+    using const_reference = const T&;
+    using pointer         = T*;
+    using const_pointer   = const T*;
+    using handle          = pool_handle<T>;
+
+    static constexpr size_type chunk_size = ChunkSize;
+
+private:
+    using index_type = std::uint32_t;
+    using gen_type   = std::uint8_t;
+
+    static constexpr index_type npos = ~index_type(0);
+
+    union slot
+    {
+        index_type next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    struct chunk
+    {
+        slot     slots[ChunkSize];
+        gen_type generations[ChunkSize];
+    };
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    object_pool() = default;
+
+    /**
+     * \brief Creates a pool with room for at least capacity objects before it has to allocate again
+     */
+    explicit object_pool(size_type capacity) { reserve(capacity); }
+
+    object_pool(const object_pool&) = delete;
+    object_pool& operator=(const object_pool&) = delete;
+
+    object_pool(object_pool&& other) noexcept
+        : chunks_(std::move(other.chunks_))
+        , free_(std::exchange(other.free_, npos))
+        , size_(std::exchange(other.size_, 0))
+    { other.chunks_.clear(); }
+
+    object_pool& operator=(object_pool&& other) noexcept
+    {
+        if(this == &other) return *this;
+
+        destroy_all_();
+        release_chunks_();
+
+        chunks_ = std::move(other.chunks_);
+        free_   = std::exchange(other.free_, npos);
+        size_   = std::exchange(other.size_, 0);
+        other.chunks_.clear();
+        return *this;
+    }
+
+    ~object_pool()
+    {
+        destroy_all_();
+        release_chunks_();
+    }
+
+// Allocation ----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Constructs an object in a free slot, allocating a new chunk if there are none left
+     * \param args Constructor arguments for T
+     * \return Handle to the new object
+     */
+    template<typename...Args>
+    [[nodiscard]] handle acquire(Args&&...args)
+    {
+        if(OCU_UNLIKELY(free_ == npos)) grow_();
+
+        const index_type index = free_;
+        chunk&           c     = chunk_of_(index);
+        slot&            s     = c.slots[index % ChunkSize];
+        const index_type next  = s.next;
+
+        try
+        {
+            ::new(static_cast<void*>(s.storage)) T(std::forward<Args>(args)...);
+        }
+        catch(...)
+        {
+            // The link shares storage with T, which may have written over it before throwing
+            s.next = next;
+            throw;
+        }
+
+        free_ = next;
+        ++size_;
+        const gen_type gen = ++c.generations[index % ChunkSize];
+        return handle(index, gen);
+    }
+
+    /**
+     * \brief Destroys the object referenced by h and returns its slot to the free list
+     */
+    void release(handle h) noexcept
+    {
+        OCU_ASSERT(valid(h), "object_pool::release called with a stale or foreign handle");
+
+        const index_type index = h.index();
+        chunk&           c     = chunk_of_(index);
+        slot&            s     = c.slots[index % ChunkSize];
+
+        std::launder(reinterpret_cast<T*>(s.storage))->~T();
+        s.next = free_;
+        free_  = index;
+        --size_;
+        ++c.generations[index % ChunkSize];
+    }
+
+    /**
+     * \brief Destroys every live object. Chunks are kept for reuse and outstanding handles become stale.
+     */
+    void clear() noexcept
+    {
+        destroy_all_();
+        rebuild_free_list_();
+    }
+
+    /**
+     * \brief Allocates chunks until at least capacity slots exist
+     */
+    void reserve(size_type capacity)
+    {
+        while(this->capacity() < capacity) grow_();
+    }
+
+// Access --------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Checks whether h refers to a live object of this pool
+     */
+    [[nodiscard]] bool valid(handle h) const noexcept
+    {
+        const index_type index = h.index();
+        if(index >= capacity()) return false;
+        const gen_type gen = chunk_of_(index).generations[index % ChunkSize];
+        return (gen & 1) && gen == h.generation();
+    }
+
+    /**
+     * \brief Resolves a handle, returning nullptr if it is stale
+     */
+    [[nodiscard]] pointer get(handle h) noexcept
+    {
+        return valid(h) ? object_at_(h.index()) : nullptr;
+    }
+
+    [[nodiscard]] const_pointer get(handle h) const noexcept
+    {
+        return valid(h) ? object_at_(h.index()) : nullptr;
+    }
+
+    /**
+     * \brief Resolves a handle without a generation check in release builds
+     */
+    [[nodiscard]] reference operator[](handle h) noexcept
+    {
+        OCU_ASSERT(valid(h), "object_pool accessed with a stale or foreign handle");
+        return *object_at_(h.index());
+    }
+
+    [[nodiscard]] const_reference operator[](handle h) const noexcept
+    {
+        OCU_ASSERT(valid(h), "object_pool accessed with a stale or foreign handle");
+        return *object_at_(h.index());
+    }
+
+    /**
+     * \brief Calls fn(handle, T&) for every live object, in slot order
+     */
+    template<typename Fn>
+    void for_each(Fn&& fn)
+    {
+        for_each_live_([&](index_type index, gen_type gen) { std::invoke(fn, handle(index, gen), *object_at_(index)); });
+    }
+
+    template<typename Fn>
+    void for_each(Fn&& fn) const
+    {
+        for_each_live_([&](index_type index, gen_type gen)
+        {
+            std::invoke(fn, handle(index, gen), static_cast<const T&>(*object_at_(index)));
+        });
+    }
+
+// Capacity ------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] size_type size()     const noexcept { return size_; }
+    [[nodiscard]] bool      empty()    const noexcept { return size_ == 0; }
+    [[nodiscard]] size_type capacity() const noexcept { return chunks_.size() * ChunkSize; }
+
+    /**
+     * \brief Largest number of objects a pool can hold, bounded by the handle's index bits
+     */
+    [[nodiscard]] static constexpr size_type max_size() noexcept
+    {
+        return handle::max_slots / ChunkSize * ChunkSize;
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    chunk&       chunk_of_(index_type index)       noexcept { return *chunks_[index / ChunkSize]; }
+    const chunk& chunk_of_(index_type index) const noexcept { return *chunks_[index / ChunkSize]; }
+
+    T* object_at_(index_type index) const noexcept
+    {
+        slot& s = chunks_[index / ChunkSize]->slots[index % ChunkSize];
+        return std::launder(reinterpret_cast<T*>(s.storage));
+    }
+
+    template<typename Fn>
+    void for_each_live_(Fn&& fn) const
+    {
+        for(size_type c = 0; c < chunks_.size(); ++c)
+        {
+            const chunk& ch = *chunks_[c];
+            for(size_type i = 0; i < ChunkSize; ++i)
+            {
+                const gen_type gen = ch.generations[i];
+                if(gen & 1) fn(static_cast<index_type>(c * ChunkSize + i), gen);
+            }
+        }
+    }
+
+    void grow_()
+    {
+        if(capacity() + ChunkSize > max_size()) throw std::length_error("object_pool exceeds its handle index range");
+
+        chunks_.reserve(chunks_.size() + 1);
+        chunk* c = new chunk;
+        chunks_.emplace_back(c);
+        detail::track_allocation(memory_tag::object_pool, sizeof(chunk));
+
+        // Thread the new slots in ascending order in front of whatever is left of the free list
+        const index_type base = static_cast<index_type>((chunks_.size() - 1) * ChunkSize);
+        for(size_type i = 0; i < ChunkSize; ++i)
+        {
+            c->generations[i] = 0;
+            c->slots[i].next  = i + 1 < ChunkSize ? static_cast<index_type>(base + i + 1) : free_;
+        }
+        free_ = base;
+    }
+
+    void destroy_all_() noexcept
+    {
+        if constexpr(!std::is_trivially_destructible_v<T>)
+        {
+            for_each_live_([this](index_type index, gen_type) { object_at_(index)->~T(); });
+        }
+
+        for(auto& c : chunks_)
+        {
+            for(gen_type& gen : c->generations) gen += (gen & 1);
+        }
+        size_ = 0;
+    }
+
+    void rebuild_free_list_() noexcept
+    {
+        free_ = npos;
+        for(size_type c = chunks_.size(); c-- > 0;)
+        {
+            for(size_type i = ChunkSize; i-- > 0;)
+            {
+                chunks_[c]->slots[i].next = free_;
+                free_ = static_cast<index_type>(c * ChunkSize + i);
+            }
+        }
+    }
+
+    void release_chunks_() noexcept
+    {
+        detail::track_deallocation(memory_tag::object_pool, chunks_.size() * sizeof(chunk));
+        chunks_.clear();
+        free_ = npos;
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::vector<std::unique_ptr<chunk>> chunks_;
+    index_type                          free_ = npos;
+    size_type                           size_ = 0;
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_OBJECT_POOL_H
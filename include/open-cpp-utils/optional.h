@@ -0,0 +1,478 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_OPTIONAL_H
+#define OPEN_CPP_UTILS_OPTIONAL_H
+
+#include "config.h"
+
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace open_cpp_utils
+{
+
+// Niche Traits ========================================================================================================
+
+/**
+ * \brief Describes a value of T that is never a meaningful T, so optional<T> can use it as its empty state instead of
+ *        a separate flag. Specialize it with two constexpr noexcept functions:
+ *
+ *     template<> struct niche_traits<texture_index>
+ *     {
+ *         static constexpr texture_index empty() noexcept { return texture_index(~0u); }
+ *         static constexpr bool is_empty(texture_index i) noexcept { return i.value() == ~0u; }
+ *     };
+ *
+ * T must be trivially copyable. The primary template has no niche, which makes optional<T> fall back to a flag.
+ */
+template<typename T>
+struct niche_traits { };
+
+/**
+ * \brief niche_traits for integral and enum types that use one reserved value, e.g. sentinel_niche<std::uint32_t, ~0u>
+ */
+template<typename T, T Value>
+struct sentinel_niche
+{
+    static constexpr T    empty()           noexcept { return Value; }
+    static constexpr bool is_empty(T value) noexcept { return value == Value; }
+};
+
+/// ~0 for index types, the usual reserved value
+template<typename T>
+using max_value_niche = sentinel_niche<T, static_cast<T>(~std::make_unsigned_t<T>(0))>;
+
+/// optional<T*> is empty when it holds nullptr
+template<typename T>
+struct niche_traits<T*>
+{
+    static constexpr T*   empty()       noexcept { return nullptr; }
+    static constexpr bool is_empty(T* p) noexcept { return p == nullptr; }
+};
+
+/// Floating point optionals reserve a single NaN payload, so every other NaN is still a value
+template<>
+struct niche_traits<float>
+{
+    static constexpr std::uint32_t bits = 0x7FC0DEADu;
+
+    static constexpr float empty()           noexcept { return std::bit_cast<float>(bits); }
+    static constexpr bool  is_empty(float v) noexcept { return std::bit_cast<std::uint32_t>(v) == bits; }
+};
+
+template<>
+struct niche_traits<double>
+{
+    static constexpr std::uint64_t bits = 0x7FF8DEADBEEF0000ull;
+
+    static constexpr double empty()            noexcept { return std::bit_cast<double>(bits); }
+    static constexpr bool   is_empty(double v) noexcept { return std::bit_cast<std::uint64_t>(v) == bits; }
+};
+
+namespace detail
+{
+
+template<typename T, typename Niche>
+concept has_niche = requires(const T& v)
+{
+    { Niche::empty() } -> std::convertible_to<T>;
+    { Niche::is_empty(v) } -> std::convertible_to<bool>;
+};
+
+// Storage -------------------------------------------------------------------------------------------------------------
+
+template<typename T, typename Niche, bool UseNiche = has_niche<T, Niche>>
+struct optional_storage;
+
+/// The empty state is a live T holding Niche::empty(), so every special member stays trivial
+template<typename T, typename Niche>
+struct optional_storage<T, Niche, true>
+{
+    static_assert(std::is_trivially_copyable_v<T>, "niche_traits requires a trivially copyable type");
+
+    constexpr optional_storage() noexcept : value_(Niche::empty()) { }
+
+    [[nodiscard]] constexpr bool has_value_() const noexcept { return !Niche::is_empty(value_); }
+
+    template<typename... Args>
+    constexpr void construct_(Args&&... args)
+    {
+        value_ = T(std::forward<Args>(args)...);
+    }
+
+    constexpr void reset_() noexcept { value_ = Niche::empty(); }
+
+    T value_;
+};
+
+/// Fallback storage: a union and a flag, with special members trivial whenever T's are
+template<typename T, typename Niche>
+struct optional_storage<T, Niche, false>
+{
+    constexpr optional_storage() noexcept : empty_{ } { }
+
+    constexpr optional_storage(const optional_storage&)
+        requires std::is_trivially_copy_constructible_v<T> = default;
+    constexpr optional_storage(const optional_storage& other) noexcept(std::is_nothrow_copy_constructible_v<T>)
+        requires std::is_copy_constructible_v<T> && (!std::is_trivially_copy_constructible_v<T>)
+        : empty_{ }
+    {
+        if(other.engaged_) construct_(other.value_);
+    }
+
+    constexpr optional_storage(optional_storage&&)
+        requires std::is_trivially_move_constructible_v<T> = default;
+    constexpr optional_storage(optional_storage&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        requires std::is_move_constructible_v<T> && (!std::is_trivially_move_constructible_v<T>)
+        : empty_{ }
+    {
+        if(other.engaged_) construct_(std::move(other.value_));
+    }
+
+    constexpr optional_storage& operator=(const optional_storage&)
+        requires std::is_trivially_copy_assignable_v<T> && std::is_trivially_copy_constructible_v<T>
+              && std::is_trivially_destructible_v<T> = default;
+    constexpr optional_storage& operator=(const optional_storage& other)
+        noexcept(std::is_nothrow_copy_constructible_v<T> && std::is_nothrow_copy_assignable_v<T>)
+        requires std::is_copy_constructible_v<T> && std::is_copy_assignable_v<T>
+              && (!std::is_trivially_copy_assignable_v<T> || !std::is_trivially_copy_constructible_v<T>
+                  || !std::is_trivially_destructible_v<T>)
+    {
+        assign_(other.engaged_, other.value_);
+        return *this;
+    }
+
+    constexpr optional_storage& operator=(optional_storage&&)
+        requires std::is_trivially_move_assignable_v<T> && std::is_trivially_move_constructible_v<T>
+              && std::is_trivially_destructible_v<T> = default;
+    constexpr optional_storage& operator=(optional_storage&& other)
+        noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>)
+        requires std::is_move_constructible_v<T> && std::is_move_assignable_v<T>
+              && (!std::is_trivially_move_assignable_v<T> || !std::is_trivially_move_constructible_v<T>
+                  || !std::is_trivially_destructible_v<T>)
+    {
+        assign_(other.engaged_, std::move(other.value_));
+        return *this;
+    }
+
+    constexpr ~optional_storage() requires std::is_trivially_destructible_v<T> = default;
+    constexpr ~optional_storage() { reset_(); }
+
+    [[nodiscard]] constexpr bool has_value_() const noexcept { return engaged_; }
+
+    template<typename... Args>
+    constexpr void construct_(Args&&... args)
+    {
+        std::construct_at(std::addressof(value_), std::forward<Args>(args)...);
+        engaged_ = true;
+    }
+
+    constexpr void reset_() noexcept
+    {
+        if(!engaged_) return;
+        std::destroy_at(std::addressof(value_));
+        engaged_ = false;
+    }
+
+    template<typename U>
+    constexpr void assign_(bool engaged, U&& value)
+    {
+        if(engaged_ && engaged) value_ = std::forward<U>(value);
+        else if(engaged)        construct_(std::forward<U>(value));
+        else                    reset_();
+    }
+
+    struct empty_byte { };
+
+    union
+    {
+        empty_byte empty_;
+        T          value_;
+    };
+    bool engaged_ = false;
+};
+
+}
+
+// optional ============================================================================================================
+
+/**
+ * \brief std::optional that stores its empty state in a niche of T when niche_traits<T> (or Niche) provides one.
+ *
+ * With a niche, sizeof(optional<T>) == sizeof(T): optional<T*> is one pointer, optional<pool_handle<T>> four bytes,
+ * and arrays of them stay as dense as arrays of T. The reserved value itself cannot be stored: assigning it, such as
+ * nullptr to an optional<T*>, leaves the optional empty. Without a niche the layout is the usual value plus flag.
+ * Interoperates with std::nullopt and std::in_place, and supports and_then, transform and or_else.
+ */
+template<typename T, typename Niche = niche_traits<T>>
+class optional : private detail::optional_storage<T, Niche>
+{
+    static_assert(!std::is_reference_v<T> && !std::is_array_v<T>, "optional requires an object type");
+    static_assert(!std::is_same_v<std::remove_cv_t<T>, std::nullopt_t>, "optional<std::nullopt_t> is ill-formed");
+
+    using storage = detail::optional_storage<T, Niche>;
+
+// Typedefs ============================================================================================================
+
+public:
+    using value_type = T;
+    using niche_type = Niche;
+
+    /// True when the empty state lives in a niche of T and the optional is exactly as large as T
+    static constexpr bool uses_niche = detail::has_niche<T, Niche>;
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors --------------------------------------------------------------------------------------------------------
+
+    constexpr optional() noexcept = default;
+    constexpr optional(std::nullopt_t) noexcept { }
+
+    template<typename... Args>
+        requires std::is_constructible_v<T, Args...>
+    constexpr explicit optional(std::in_place_t, Args&&... args)
+    {
+        this->construct_(std::forward<Args>(args)...);
+    }
+
+    template<typename U = T>
+        requires std::is_constructible_v<T, U&&>
+              && (!std::is_same_v<std::remove_cvref_t<U>, optional>)
+              && (!std::is_same_v<std::remove_cvref_t<U>, std::in_place_t>)
+              && (!std::is_same_v<std::remove_cvref_t<U>, std::nullopt_t>)
+    constexpr explicit(!std::is_convertible_v<U&&, T>) optional(U&& value)
+    {
+        this->construct_(std::forward<U>(value));
+    }
+
+    /// Adopts a std::optional
+    template<typename U>
+        requires std::is_constructible_v<T, const U&>
+    constexpr explicit(!std::is_convertible_v<const U&, T>) optional(const std::optional<U>& other)
+    {
+        if(other) this->construct_(*other);
+    }
+
+// Assignment ----------------------------------------------------------------------------------------------------------
+
+    constexpr optional& operator=(std::nullopt_t) noexcept
+    {
+        reset();
+        return *this;
+    }
+
+    template<typename U = T>
+        requires std::is_constructible_v<T, U&&> && std::is_assignable_v<T&, U&&>
+              && (!std::is_same_v<std::remove_cvref_t<U>, optional>)
+              && (!std::is_same_v<std::remove_cvref_t<U>, std::nullopt_t>)
+    constexpr optional& operator=(U&& value)
+    {
+        if(has_value()) this->value_ = std::forward<U>(value);
+        else            this->construct_(std::forward<U>(value));
+        return *this;
+    }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    template<typename... Args>
+    constexpr T& emplace(Args&&... args)
+    {
+        reset();
+        this->construct_(std::forward<Args>(args)...);
+        return this->value_;
+    }
+
+    template<typename U, typename... Args>
+    constexpr T& emplace(std::initializer_list<U> ilist, Args&&... args)
+    {
+        reset();
+        this->construct_(ilist, std::forward<Args>(args)...);
+        return this->value_;
+    }
+
+    constexpr void reset() noexcept { this->reset_(); }
+
+    constexpr void swap(optional& other) noexcept(std::is_nothrow_move_constructible_v<T> &&
+                                                  std::is_nothrow_swappable_v<T>)
+    {
+        using std::swap;
+        if(has_value() && other.has_value())
+        {
+            swap(this->value_, other.value_);
+        }
+        else if(has_value())
+        {
+            other.construct_(std::move(this->value_));
+            reset();
+        }
+        else if(other.has_value())
+        {
+            this->construct_(std::move(other.value_));
+            other.reset();
+        }
+    }
+
+    friend constexpr void swap(optional& a, optional& b) noexcept(noexcept(a.swap(b))) { a.swap(b); }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] constexpr bool has_value() const noexcept { return this->has_value_(); }
+    constexpr explicit operator bool() const noexcept { return has_value(); }
+
+    [[nodiscard]] constexpr T&        operator*() &        noexcept { return checked_(); }
+    [[nodiscard]] constexpr const T&  operator*() const &  noexcept { return checked_(); }
+    [[nodiscard]] constexpr T&&       operator*() &&       noexcept { return std::move(checked_()); }
+    [[nodiscard]] constexpr const T&& operator*() const && noexcept { return std::move(checked_()); }
+
+    [[nodiscard]] constexpr T*       operator->()       noexcept { return std::addressof(checked_()); }
+    [[nodiscard]] constexpr const T* operator->() const noexcept { return std::addressof(checked_()); }
+
+    /**
+     * \throws std::bad_optional_access if empty
+     */
+    [[nodiscard]] constexpr T&        value() &        { return throwing_(); }
+    [[nodiscard]] constexpr const T&  value() const &  { return throwing_(); }
+    [[nodiscard]] constexpr T&&       value() &&       { return std::move(throwing_()); }
+    [[nodiscard]] constexpr const T&& value() const && { return std::move(throwing_()); }
+
+    template<typename U>
+    [[nodiscard]] constexpr T value_or(U&& fallback) const &
+    {
+        return has_value() ? this->value_ : static_cast<T>(std::forward<U>(fallback));
+    }
+
+    template<typename U>
+    [[nodiscard]] constexpr T value_or(U&& fallback) &&
+    {
+        return has_value() ? std::move(this->value_) : static_cast<T>(std::forward<U>(fallback));
+    }
+
+    /// Copies into a std::optional, e.g. to hand the value to an API that takes one
+    [[nodiscard]] constexpr std::optional<T> to_std() const
+    {
+        return has_value() ? std::optional<T>(this->value_) : std::nullopt;
+    }
+
+// Monadic Operations --------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief f(value) if engaged, otherwise an empty result; f must return an optional (this one or std::optional)
+     */
+    template<typename F> constexpr auto and_then(F&& f) &       { return and_then_(*this, std::forward<F>(f)); }
+    template<typename F> constexpr auto and_then(F&& f) const & { return and_then_(*this, std::forward<F>(f)); }
+    template<typename F> constexpr auto and_then(F&& f) &&
+    {
+        return and_then_(std::move(*this), std::forward<F>(f));
+    }
+
+    /**
+     * \brief optional<U>(f(value)) if engaged, otherwise an empty optional<U>; U gets its own niche_traits
+     */
+    template<typename F> constexpr auto transform(F&& f) &       { return transform_(*this, std::forward<F>(f)); }
+    template<typename F> constexpr auto transform(F&& f) const & { return transform_(*this, std::forward<F>(f)); }
+    template<typename F> constexpr auto transform(F&& f) &&
+    {
+        return transform_(std::move(*this), std::forward<F>(f));
+    }
+
+    /**
+     * \brief *this if engaged, otherwise f(), which must return an optional<T, Niche>
+     */
+    template<typename F>
+    constexpr optional or_else(F&& f) const &
+    {
+        return has_value() ? *this : static_cast<optional>(std::invoke(std::forward<F>(f)));
+    }
+
+    template<typename F>
+    constexpr optional or_else(F&& f) &&
+    {
+        return has_value() ? std::move(*this) : static_cast<optional>(std::invoke(std::forward<F>(f)));
+    }
+
+// Comparison ----------------------------------------------------------------------------------------------------------
+
+    friend constexpr bool operator==(const optional& a, const optional& b)
+    {
+        if(a.has_value() != b.has_value()) return false;
+        return !a.has_value() || a.value_ == b.value_;
+    }
+
+    friend constexpr bool operator==(const optional& a, std::nullopt_t) noexcept { return !a.has_value(); }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    constexpr T& checked_() noexcept
+    {
+        OCU_ASSERT(has_value(), "optional accessed while empty");
+        return this->value_;
+    }
+
+    constexpr const T& checked_() const noexcept
+    {
+        OCU_ASSERT(has_value(), "optional accessed while empty");
+        return this->value_;
+    }
+
+    constexpr T& throwing_()
+    {
+        if(!has_value()) throw std::bad_optional_access();
+        return this->value_;
+    }
+
+    constexpr const T& throwing_() const
+    {
+        if(!has_value()) throw std::bad_optional_access();
+        return this->value_;
+    }
+
+    template<typename Self, typename F>
+    static constexpr auto and_then_(Self&& self, F&& f)
+    {
+        using result = std::remove_cvref_t<std::invoke_result_t<F, decltype((std::forward<Self>(self).value_))>>;
+        if(!self.has_value()) return result();
+        return std::invoke(std::forward<F>(f), std::forward<Self>(self).value_);
+    }
+
+    template<typename Self, typename F>
+    static constexpr auto transform_(Self&& self, F&& f)
+    {
+        using U = std::remove_cv_t<std::invoke_result_t<F, decltype((std::forward<Self>(self).value_))>>;
+        if(!self.has_value()) return open_cpp_utils::optional<U>();
+        return open_cpp_utils::optional<U>(std::in_place, std::invoke(std::forward<F>(f),
+                                                                       std::forward<Self>(self).value_));
+    }
+};
+
+template<typename T>
+optional(T) -> optional<T>;
+
+/// Compares against a plain value. Not a hidden friend: as one it would be found through every type templated on an
+/// optional, such as vector iterators, and its constraint would recurse
+template<typename T, typename Niche, typename U>
+    requires (!std::is_same_v<std::remove_cvref_t<U>, optional<T, Niche>>)
+          && requires(const T& t, const U& u) { { t == u } -> std::convertible_to<bool>; }
+constexpr bool operator==(const optional<T, Niche>& a, const U& b)
+{
+    return a.has_value() && *a == b;
+}
+
+static_assert(sizeof(optional<int*>) == sizeof(int*));
+static_assert(sizeof(optional<double>) == sizeof(double));
+static_assert(sizeof(optional<std::uint32_t, max_value_niche<std::uint32_t>>) == sizeof(std::uint32_t));
+
+}
+
+#endif // OPEN_CPP_UTILS_OPTIONAL_H
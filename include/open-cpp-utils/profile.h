@@ -0,0 +1,618 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_PROFILE_H
+#define OPEN_CPP_UTILS_PROFILE_H
+
+#include "config.h"
+#include "memory_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(OCU_ARCH_X86) && !defined(OCU_PROFILE_STEADY_CLOCK)
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   else
+#       include <x86intrin.h>
+#   endif
+#   define OCU_PROFILE_RDTSC 1
+#endif
+
+namespace open_cpp_utils
+{
+
+// Typedefs ============================================================================================================
+
+/**
+ * \brief One finished zone or one counter sample. Timestamps are raw profile_clock ticks.
+ */
+struct profile_event
+{
+    const char*   name;
+    std::uint64_t begin;
+    /// End of a zone, or the bits of a counter sample's double value
+    std::uint64_t end;
+    /// Series of a counter sample; nullptr for zones
+    const char*   series = nullptr;
+};
+
+namespace detail
+{
+
+/**
+ * \brief Per-thread single producer, single consumer ring of finished zones and counter samples. The owning thread
+ *        pushes without any read-modify-write; the session thread drains. A full ring drops the event and counts it.
+ */
+struct profile_ring
+{
+    static constexpr std::size_t capacity = 1u << 14;
+    static constexpr std::size_t mask     = capacity - 1;
+
+    OCU_FORCEINLINE void push(const char* name, std::uint64_t begin, std::uint64_t end,
+                              const char* series = nullptr) noexcept
+    {
+        const std::uint64_t h = head.load(std::memory_order_relaxed);
+        if(OCU_UNLIKELY(h - cached_tail >= capacity))
+        {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if(h - cached_tail >= capacity)
+            {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        events[h & mask] = { name, begin, end, series };
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    std::unique_ptr<profile_event[]> events{ new profile_event[capacity] };
+
+    alignas(cache_line_size) std::atomic<std::uint64_t> head{ 0 };
+    std::uint64_t                                       cached_tail = 0;
+    std::atomic<std::uint64_t>                          dropped{ 0 };
+
+    alignas(cache_line_size) std::atomic<std::uint64_t> tail{ 0 };
+    std::atomic<bool>                                   retired{ false };
+    std::uint32_t                                       thread_id = 0;
+    /// Guarded by profile_registry::mutex
+    std::string                                         thread_name;
+};
+
+struct profile_registry
+{
+    std::mutex                                 mutex;
+    std::vector<std::shared_ptr<profile_ring>> rings;
+    std::uint32_t                              next_thread_id = 1;
+    bool                                       session_open   = false;
+};
+
+inline profile_registry& profile_registry_()
+{
+    static profile_registry r;
+    return r;
+}
+
+/// Set while a profile_session is open; zones constructed while it is clear record nothing
+inline constinit std::atomic<bool> profile_active{ false };
+
+inline constinit thread_local profile_ring* profile_current_ring = nullptr;
+inline constinit thread_local bool          profile_thread_exited = false;
+
+struct profile_ring_owner
+{
+    std::shared_ptr<profile_ring> ring;
+
+    ~profile_ring_owner()
+    {
+        if(ring) ring->retired.store(true, std::memory_order_release);
+        profile_current_ring  = nullptr;
+        profile_thread_exited = true;
+    }
+};
+
+/// Creates and registers the calling thread's ring. Returns nullptr once the thread is shutting down.
+OCU_NOINLINE inline profile_ring* profile_register_thread_()
+{
+    if(profile_thread_exited) return nullptr;
+
+    thread_local profile_ring_owner owner;
+    if(!owner.ring)
+    {
+        auto ring = std::make_shared<profile_ring>();
+        profile_registry& r = profile_registry_();
+        std::lock_guard lock(r.mutex);
+        ring->thread_id = r.next_thread_id++;
+        r.rings.push_back(ring);
+        owner.ring = std::move(ring);
+    }
+    profile_current_ring = owner.ring.get();
+    return profile_current_ring;
+}
+
+OCU_FORCEINLINE profile_ring* profile_thread_ring_() noexcept
+{
+    profile_ring* ring = profile_current_ring;
+    if(OCU_LIKELY(ring != nullptr)) return ring;
+    try { return profile_register_thread_(); }
+    catch(...) { return nullptr; }
+}
+
+}
+
+// Functions ===========================================================================================================
+
+/**
+ * \brief Timestamp source of profiling zones: the time stamp counter on x86, which costs a few nanoseconds and is
+ *        invariant on every x86 core of the last decade, steady_clock nanoseconds elsewhere. Define
+ *        OCU_PROFILE_STEADY_CLOCK to use steady_clock everywhere. Sessions convert ticks by calibrating against
+ *        steady_clock while they run.
+ */
+OCU_FORCEINLINE std::uint64_t profile_clock() noexcept
+{
+#if defined(OCU_PROFILE_RDTSC)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * \brief Names the calling thread in traces written by profile_session
+ */
+inline void profile_thread_name(std::string name)
+{
+    detail::profile_ring* ring = detail::profile_current_ring;
+    if(ring == nullptr) ring = detail::profile_register_thread_();
+    if(ring == nullptr) return;
+
+    std::lock_guard lock(detail::profile_registry_().mutex);
+    ring->thread_name = std::move(name);
+}
+
+/**
+ * \brief Records value as a sample of the counter series of track name, drawn as a counter graph in trace viewers
+ *        (Perfetto shows one track per "name series"). Costs one relaxed load when no session is open and a store
+ *        into the thread's ring otherwise. Both strings must outlive the session, which string literals do.
+ */
+inline void profile_counter(const char* name, const char* series, double value) noexcept
+{
+    if(!detail::profile_active.load(std::memory_order_relaxed)) return;
+    if(detail::profile_ring* ring = detail::profile_thread_ring_())
+    {
+        const std::uint64_t now = profile_clock();
+        ring->push(name, now, std::bit_cast<std::uint64_t>(value), series);
+    }
+}
+
+/**
+ * \brief Records memory_stats() as counter samples, one "memory/<tag>" track per memory_tag with series bytes_live,
+ *        bytes_peak, allocations and rehashes. Call it periodically while a session is open to see which containers
+ *        grow over the trace; it records zeros unless the library is built with OCU_TRACK_ALLOCATIONS.
+ */
+inline void profile_memory_stats(const memory_snapshot& stats = memory_stats()) noexcept
+{
+    static constexpr const char* tracks[memory_tag_count] = {
+        "memory/object_pool", "memory/arena", "memory/small_vector", "memory/hash_table"
+    };
+    if(!detail::profile_active.load(std::memory_order_relaxed)) return;
+    for(std::size_t i = 0; i < memory_tag_count; ++i)
+    {
+        const memory_tag_stats& t = stats.tags[i];
+        profile_counter(tracks[i], "bytes_live",  static_cast<double>(t.bytes_live));
+        profile_counter(tracks[i], "bytes_peak",  static_cast<double>(t.bytes_peak));
+        profile_counter(tracks[i], "allocations", static_cast<double>(t.allocations));
+        profile_counter(tracks[i], "rehashes",    static_cast<double>(t.rehashes));
+    }
+}
+
+// profile_zone ========================================================================================================
+
+/**
+ * \brief Scope recorded as one complete event from construction to destruction. Use through OCU_ZONE.
+ *
+ * Costs one relaxed load when no session is open. While one is, it costs two clock reads and a store into the
+ * thread's ring, with no atomic read-modify-write and no lock. The first zone of a thread allocates its ring, so
+ * that one call is slow. name must outlive the session, which a string literal does.
+ */
+class profile_zone
+{
+public:
+    OCU_FORCEINLINE explicit profile_zone(const char* name) noexcept
+    {
+        if(!detail::profile_active.load(std::memory_order_relaxed)) return;
+        ring_  = detail::profile_thread_ring_();
+        name_  = name;
+        begin_ = profile_clock();
+    }
+
+    profile_zone(const profile_zone&) = delete;
+    profile_zone& operator=(const profile_zone&) = delete;
+
+    OCU_FORCEINLINE ~profile_zone()
+    {
+        if(ring_ != nullptr) ring_->push(name_, begin_, profile_clock());
+    }
+
+private:
+    detail::profile_ring* ring_  = nullptr;
+    const char*           name_  = nullptr;
+    std::uint64_t         begin_ = 0;
+};
+
+// profile_session =====================================================================================================
+
+/**
+ * \brief Records zones from every thread while alive and writes them as Chrome trace event JSON. chrome://tracing,
+ *        Perfetto UI and Speedscope all load the file.
+ *
+ * A background thread drains the per-thread rings every interval, so memory stays bounded however long the session
+ * runs. A thread that records more than profile_ring::capacity zones within one interval drops the excess, which
+ * dropped() reports. Only one session may be open at a time.
+ *
+ * \code
+ * open_cpp_utils::profile_session session("trace.json");
+ * run_frame();   // OCU_ZONE("update"), OCU_ZONE("render"), ...
+ * \endcode
+ */
+class profile_session
+{
+// Typedefs ============================================================================================================
+
+public:
+    /// Receives consecutive pieces of the JSON document, on the session thread
+    using sink_type = std::function<void(std::string_view)>;
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    /**
+     * \throws std::system_error if path cannot be opened for writing
+     * \throws std::logic_error if another session is open
+     */
+    explicit profile_session(const std::filesystem::path& path,
+                             std::chrono::milliseconds interval = std::chrono::milliseconds(10))
+        : profile_session(file_sink_(path), interval)
+    { }
+
+    /**
+     * \throws std::logic_error if another session is open
+     */
+    explicit profile_session(sink_type sink, std::chrono::milliseconds interval = std::chrono::milliseconds(10))
+        : sink_(std::move(sink))
+        , interval_(interval)
+    {
+        detail::profile_registry& r = detail::profile_registry_();
+        {
+            std::lock_guard lock(r.mutex);
+            if(r.session_open) throw std::logic_error("profile_session: another session is open");
+            r.session_open = true;
+
+            // Events left over from zones that straddled the end of an earlier session
+            for(auto& ring : r.rings)
+            {
+                ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+                dropped_base_ += ring->dropped.load(std::memory_order_relaxed);
+            }
+        }
+
+        start_ticks_  = profile_clock();
+        start_steady_ = std::chrono::steady_clock::now();
+        sink_("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+        detail::profile_active.store(true, std::memory_order_release);
+
+        thread_ = std::thread([this] { drain_loop_(); });
+    }
+
+    profile_session(const profile_session&) = delete;
+    profile_session& operator=(const profile_session&) = delete;
+
+    ~profile_session() { stop(); }
+
+// Control -------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Stops recording, writes what is left and closes the document. Zones still open on other threads are
+     *        not recorded. Called by the destructor.
+     */
+    void stop()
+    {
+        if(!thread_.joinable()) return;
+
+        detail::profile_active.store(false, std::memory_order_release);
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+
+        drain_();
+        write_thread_names_();
+        sink_("]}\n");
+        sink_ = nullptr;
+
+        detail::profile_registry& r = detail::profile_registry_();
+        std::lock_guard lock(r.mutex);
+        r.session_open = false;
+    }
+
+    /**
+     * \brief Writes every zone recorded so far without waiting for the next interval
+     */
+    void flush()
+    {
+        if(thread_.joinable()) drain_();
+    }
+
+    /**
+     * \brief Number of zones lost to full rings so far
+     */
+    [[nodiscard]] std::uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    static sink_type file_sink_(const std::filesystem::path& path)
+    {
+        std::FILE* f = nullptr;
+#if defined(OCU_PLATFORM_WINDOWS)
+        if(_wfopen_s(&f, path.c_str(), L"wb") != 0) f = nullptr;
+#else
+        f = std::fopen(path.c_str(), "wb");
+#endif
+        if(f == nullptr) throw std::system_error(errno, std::generic_category(),
+                                                 "profile_session: cannot write " + path.string());
+
+        std::shared_ptr<std::FILE> file(f, [](std::FILE* p) { std::fclose(p); });
+        return [file](std::string_view s) { std::fwrite(s.data(), 1, s.size(), file.get()); };
+    }
+
+    void drain_loop_()
+    {
+        std::unique_lock lock(mutex_);
+        while(!stopping_)
+        {
+            wake_.wait_for(lock, interval_, [this] { return stopping_; });
+            lock.unlock();
+            drain_();
+            lock.lock();
+        }
+    }
+
+    /// Converts ticks to microseconds since the session started, calibrating against steady_clock so far
+    void calibrate_()
+    {
+        const std::uint64_t ticks   = profile_clock();
+        const double        elapsed = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start_steady_).count();
+#if defined(OCU_PROFILE_RDTSC)
+        if(ticks > start_ticks_ && elapsed > 0)
+        {
+            us_per_tick_ = elapsed / static_cast<double>(ticks - start_ticks_) * 1e-3;
+        }
+#else
+        static_cast<void>(ticks);
+        static_cast<void>(elapsed);
+        us_per_tick_ = 1e-3;
+#endif
+    }
+
+    void drain_()
+    {
+        std::lock_guard drain_lock(drain_mutex_);
+        std::vector<std::shared_ptr<detail::profile_ring>> rings;
+        detail::profile_registry& r = detail::profile_registry_();
+        {
+            std::lock_guard lock(r.mutex);
+            rings = r.rings;
+        }
+
+        calibrate_();
+        buffer_.clear();
+        std::uint64_t live_dropped = 0;
+        for(const auto& ring : rings)
+        {
+            const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+            std::uint64_t       tail = ring->tail.load(std::memory_order_relaxed);
+            for(; tail != head; ++tail)
+            {
+                write_event_(ring->events[tail & detail::profile_ring::mask], ring->thread_id);
+                if(buffer_.size() >= flush_size_) { sink_(buffer_); buffer_.clear(); }
+            }
+            ring->tail.store(tail, std::memory_order_release);
+        }
+
+        // Rings of exited threads are done once drained; their names and losses go into the session now
+        {
+            std::lock_guard lock(r.mutex);
+            std::erase_if(r.rings, [&](const std::shared_ptr<detail::profile_ring>& ring)
+            {
+                const bool done = ring->retired.load(std::memory_order_acquire)
+                               && ring->tail.load(std::memory_order_relaxed)
+                               == ring->head.load(std::memory_order_acquire);
+                if(done)
+                {
+                    write_thread_name_(*ring);
+                    erased_dropped_ += ring->dropped.load(std::memory_order_relaxed);
+                }
+                else
+                {
+                    live_dropped += ring->dropped.load(std::memory_order_relaxed);
+                }
+                return done;
+            });
+        }
+        if(!buffer_.empty()) sink_(buffer_);
+        dropped_.store(erased_dropped_ + live_dropped - dropped_base_, std::memory_order_relaxed);
+    }
+
+    void write_event_(const profile_event& e, std::uint32_t tid)
+    {
+        const auto since = [this](std::uint64_t t)
+        {
+            return static_cast<double>(static_cast<std::int64_t>(t - start_ticks_)) * us_per_tick_;
+        };
+        const double ts = since(e.begin);
+
+        if(!first_) buffer_ += ',';
+        first_ = false;
+        if(e.series != nullptr)
+        {
+            buffer_ += "\n{\"ph\":\"C\",\"pid\":1,\"tid\":";
+            append_number_(tid);
+            buffer_ += ",\"ts\":";
+            append_number_(ts);
+            buffer_ += ",\"name\":";
+            append_string_(e.name);
+            buffer_ += ",\"args\":{";
+            append_string_(e.series);
+            buffer_ += ':';
+            append_number_(std::bit_cast<double>(e.end));
+            buffer_ += "}}";
+            return;
+        }
+
+        const double dur = std::max(0.0, since(e.end) - ts);
+        buffer_ += "\n{\"ph\":\"X\",\"pid\":1,\"tid\":";
+        append_number_(tid);
+        buffer_ += ",\"ts\":";
+        append_number_(ts);
+        buffer_ += ",\"dur\":";
+        append_number_(dur);
+        buffer_ += ",\"name\":";
+        append_string_(e.name);
+        buffer_ += '}';
+    }
+
+    void write_thread_names_()
+    {
+        detail::profile_registry& r = detail::profile_registry_();
+        std::lock_guard lock(r.mutex);
+
+        buffer_.clear();
+        for(const auto& ring : r.rings) write_thread_name_(*ring);
+        if(!buffer_.empty()) sink_(buffer_);
+    }
+
+    /// Caller holds the registry mutex
+    void write_thread_name_(const detail::profile_ring& ring)
+    {
+        if(ring.thread_name.empty()) return;
+        if(!first_) buffer_ += ',';
+        first_ = false;
+        buffer_ += "\n{\"ph\":\"M\",\"pid\":1,\"tid\":";
+        append_number_(ring.thread_id);
+        buffer_ += ",\"name\":\"thread_name\",\"args\":{\"name\":";
+        append_string_(ring.thread_name);
+        buffer_ += "}}";
+    }
+
+    void append_number_(std::uint32_t v)
+    {
+        char text[16];
+        buffer_.append(text, std::to_chars(text, text + sizeof(text), v).ptr);
+    }
+
+    void append_number_(double v)
+    {
+        char text[32];
+        buffer_.append(text, std::to_chars(text, text + sizeof(text), v, std::chars_format::fixed, 3).ptr);
+    }
+
+    void append_string_(std::string_view s)
+    {
+        static constexpr char hex[] = "0123456789abcdef";
+        buffer_ += '"';
+        for(const char c : s)
+        {
+            const auto u = static_cast<unsigned char>(c);
+            if(c == '"' || c == '\\') { buffer_ += '\\'; buffer_ += c; }
+            else if(u < 0x20) { buffer_ += "\\u00"; buffer_ += hex[u >> 4]; buffer_ += hex[u & 15]; }
+            else buffer_ += c;
+        }
+        buffer_ += '"';
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    static constexpr std::size_t flush_size_ = 1u << 16;
+
+    sink_type                             sink_;
+    std::chrono::milliseconds             interval_;
+    std::uint64_t                         start_ticks_ = 0;
+    std::chrono::steady_clock::time_point start_steady_;
+    double                                us_per_tick_ = 1e-3;
+
+    std::string                           buffer_;
+    bool                                  first_ = true;
+    std::uint64_t                         dropped_base_   = 0;
+    std::uint64_t                         erased_dropped_ = 0;
+    std::atomic<std::uint64_t>            dropped_{ 0 };
+
+    std::mutex                            drain_mutex_;
+    std::mutex                            mutex_;
+    std::condition_variable               wake_;
+    bool                                  stopping_ = false;
+    std::thread                           thread_;
+};
+
+}
+
+#define OCU_PROFILE_CONCAT_(a, b) a##b
+#define OCU_PROFILE_CONCAT(a, b)  OCU_PROFILE_CONCAT_(a, b)
+
+/**
+ * \brief Records the rest of the enclosing scope as a zone named by the string literal name:
+ *
+ *     void update()
+ *     {
+ *         OCU_ZONE("update");
+ *         ...
+ *     }
+ *
+ * Compiles to nothing unless OCU_ENABLE_PROFILING is defined. Everything else in this header is always available, so
+ * translation units may differ in the setting.
+ */
+#if defined(OCU_ENABLE_PROFILING)
+#   define OCU_ZONE(name) ::open_cpp_utils::profile_zone OCU_PROFILE_CONCAT(ocu_zone_, __LINE__)(name)
+#else
+#   define OCU_ZONE(name) static_cast<void>(0)
+#endif
+
+/**
+ * \brief Records value as a sample of counter series on track name, both string literals. Compiles to nothing
+ *        unless OCU_ENABLE_PROFILING is defined, like OCU_ZONE; value is not evaluated then.
+ */
+#if defined(OCU_ENABLE_PROFILING)
+#   define OCU_COUNTER(name, series, value) ::open_cpp_utils::profile_counter(name, series, value)
+#else
+#   define OCU_COUNTER(name, series, value) static_cast<void>(0)
+#endif
+
+#endif // OPEN_CPP_UTILS_PROFILE_H
@@ -0,0 +1,706 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_RECLAIM_H
+#define OPEN_CPP_UTILS_RECLAIM_H
+
+#include "config.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace open_cpp_utils
+{
+
+// Typedefs ============================================================================================================
+
+/**
+ * \brief Object handed to a reclamation domain, freed by calling deleter(ptr) once no reader can still hold it
+ */
+struct retired_object
+{
+    void*         ptr;
+    void        (*deleter)(void*);
+    std::uint64_t epoch;
+};
+
+namespace detail
+{
+
+template<typename T>
+void delete_retired(void* p) { delete static_cast<T*>(p); }
+
+/// IDs of live domains. Threads check it on exit so they never touch a domain destroyed before them.
+struct reclaim_registry
+{
+    std::mutex                 mutex;
+    std::vector<std::uint64_t> live;
+    std::uint64_t              next_id = 1;
+};
+
+inline reclaim_registry& reclaim_registry_()
+{
+    static reclaim_registry r;
+    return r;
+}
+
+inline std::uint64_t register_domain_()
+{
+    reclaim_registry& r = reclaim_registry_();
+    std::lock_guard lock(r.mutex);
+    r.live.push_back(r.next_id);
+    return r.next_id++;
+}
+
+inline void unregister_domain_(std::uint64_t id)
+{
+    reclaim_registry& r = reclaim_registry_();
+    std::lock_guard lock(r.mutex);
+    std::erase(r.live, id);
+}
+
+/**
+ * \brief The calling thread's state in every Domain it has used, handed back to live domains when the thread exits
+ */
+template<typename Domain>
+struct reclaim_thread_cache
+{
+    using state_type = typename Domain::thread_state;
+
+    struct entry
+    {
+        Domain*       domain;
+        std::uint64_t id;
+        state_type*   state;
+    };
+
+    ~reclaim_thread_cache()
+    {
+        reclaim_registry& r = reclaim_registry_();
+        std::lock_guard lock(r.mutex);
+        for(const entry& e : entries)
+        {
+            if(std::find(r.live.begin(), r.live.end(), e.id) != r.live.end()) e.domain->detach_(*e.state);
+        }
+    }
+
+    std::vector<entry> entries;
+};
+
+template<typename Domain>
+inline constinit thread_local std::uint64_t reclaim_last_id = 0;
+
+/// Points at a Domain::thread_state, which is private to the domain
+template<typename Domain>
+inline constinit thread_local void* reclaim_last_state = nullptr;
+
+template<typename Domain>
+OCU_NOINLINE typename Domain::thread_state& reclaim_attach_(Domain& d)
+{
+    thread_local reclaim_thread_cache<Domain> cache;
+
+    typename Domain::thread_state* state = nullptr;
+    for(const auto& e : cache.entries)
+    {
+        if(e.id == d.id_) state = e.state;
+    }
+    if(state == nullptr)
+    {
+        // Forget domains destroyed since this thread last looked
+        {
+            reclaim_registry& r = reclaim_registry_();
+            std::lock_guard lock(r.mutex);
+            std::erase_if(cache.entries, [&](const auto& e)
+            {
+                return std::find(r.live.begin(), r.live.end(), e.id) == r.live.end();
+            });
+        }
+        state = d.attach_();
+        cache.entries.push_back({ &d, d.id_, state });
+    }
+
+    reclaim_last_id<Domain>    = d.id_;
+    reclaim_last_state<Domain> = state;
+    return *state;
+}
+
+/// The calling thread's state in d; one thread-local compare once the thread has used d
+template<typename Domain>
+OCU_FORCEINLINE typename Domain::thread_state& reclaim_local_(Domain& d)
+{
+    using state_type = typename Domain::thread_state;
+    if(OCU_LIKELY(reclaim_last_id<Domain> == d.id_)) return *static_cast<state_type*>(reclaim_last_state<Domain>);
+    return reclaim_attach_(d);
+}
+
+/// Usable state records of a domain, allocated on demand and never freed before the domain
+template<typename State>
+class reclaim_state_list
+{
+public:
+    reclaim_state_list() = default;
+    reclaim_state_list(const reclaim_state_list&) = delete;
+    reclaim_state_list& operator=(const reclaim_state_list&) = delete;
+
+    ~reclaim_state_list()
+    {
+        State* s = head_.load(std::memory_order_relaxed);
+        while(s != nullptr)
+        {
+            State* next = s->next;
+            delete s;
+            s = next;
+        }
+    }
+
+    /// Claims a released record or adds a new one
+    State* acquire()
+    {
+        for(State* s = head(); s != nullptr; s = s->next)
+        {
+            bool expected = false;
+            if(!s->in_use.load(std::memory_order_relaxed)
+            && s->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                return s;
+            }
+        }
+
+        State* s = new State();
+        s->in_use.store(true, std::memory_order_relaxed);
+        size_.fetch_add(1, std::memory_order_relaxed);
+        s->next = head_.load(std::memory_order_relaxed);
+        while(!head_.compare_exchange_weak(s->next, s, std::memory_order_release, std::memory_order_relaxed)) { }
+        return s;
+    }
+
+    State* head() const noexcept { return head_.load(std::memory_order_acquire); }
+
+    /// Records allocated so far, in use or not
+    std::size_t size() const noexcept { return size_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<State*>      head_{ nullptr };
+    std::atomic<std::size_t> size_{ 0 };
+};
+
+}
+
+// epoch_domain ========================================================================================================
+
+/**
+ * \brief Epoch-based reclamation: readers pin the domain for the length of an operation, and retired objects are
+ *        freed once every thread that was pinned when they were retired has unpinned.
+ *
+ * A global epoch advances only when every pinned thread has observed its current value, so an object retired in
+ * epoch e can no longer be referenced once the epoch reaches e + 2. Pinning costs one store and a full fence on the
+ * thread's own cache line; retiring appends to a thread-local batch, and every collect_interval retires the thread
+ * tries to advance the epoch and frees the part of its batch that has become safe. Readers never wait for anything.
+ *
+ * The price is that memory is bounded only by how long threads stay pinned: a thread that stalls inside a guard
+ * holds back every object retired after it pinned. Use hazard_domain where that is not acceptable.
+ *
+ * Threads that used a domain may exit before or after it. The destructor frees every object still pending, so by
+ * then no thread may be pinned on the domain.
+ */
+class epoch_domain
+{
+// Typedefs ============================================================================================================
+
+public:
+    /// Retires per thread between attempts to advance the epoch and free its batch
+    static constexpr std::uint32_t collect_interval = 64;
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    epoch_domain() : id_(detail::register_domain_()) { }
+
+    epoch_domain(const epoch_domain&) = delete;
+    epoch_domain& operator=(const epoch_domain&) = delete;
+
+    ~epoch_domain()
+    {
+        detail::unregister_domain_(id_);
+        for(thread_state* s = states_.head(); s != nullptr; s = s->next) free_all_(s->retired);
+        free_all_(orphans_);
+    }
+
+// Pinning -------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Keeps every object reachable now from being freed until the matching unpin. Nests.
+     */
+    OCU_FORCEINLINE void pin() { pin_(); }
+
+    OCU_FORCEINLINE void unpin() { unpin_(detail::reclaim_local_(*this)); }
+
+// Retiring ------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Frees p with delete once no pinned thread can still hold it. p must already be unreachable for
+     *        threads that pin from now on.
+     */
+    template<typename T>
+    void retire(T* p) { retire(p, &detail::delete_retired<T>); }
+
+    void retire(void* p, void (*deleter)(void*))
+    {
+        thread_state& s = detail::reclaim_local_(*this);
+
+        // Orders the caller's unlinking store before the epoch read that tags the object
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        s.retired.push_back({ p, deleter, epoch_.load(std::memory_order_relaxed) });
+        s.pending.store(s.retired.size(), std::memory_order_relaxed);
+        if(OCU_UNLIKELY(++s.since_collect >= collect_interval)) collect_(s);
+    }
+
+    /**
+     * \brief Waits until everything the calling thread and exited threads retired so far can be freed, and frees
+     *        it. Must not be called while pinned.
+     */
+    void synchronize()
+    {
+        thread_state& s = detail::reclaim_local_(*this);
+        OCU_ASSERT(s.nesting == 0, "epoch_domain::synchronize while pinned");
+
+        const std::uint64_t target = epoch_.load(std::memory_order_acquire) + 2;
+        while(try_advance_() < target) std::this_thread::yield();
+        collect_(s);
+    }
+
+    /**
+     * \brief Number of objects retired but not freed yet, exact once retiring threads are quiet
+     */
+    [[nodiscard]] std::size_t pending() const noexcept
+    {
+        std::size_t n = orphan_count_.load(std::memory_order_relaxed);
+        for(const thread_state* s = states_.head(); s != nullptr; s = s->next)
+        {
+            n += s->pending.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    friend class epoch_guard;
+
+    template<typename Domain>
+    friend struct detail::reclaim_thread_cache;
+
+    template<typename Domain>
+    friend typename Domain::thread_state& detail::reclaim_attach_(Domain&);
+
+    template<typename Domain>
+    friend typename Domain::thread_state& detail::reclaim_local_(Domain&);
+
+    struct alignas(cache_line_size) thread_state
+    {
+        /// (epoch << 1) | 1 while pinned, 0 while not
+        std::atomic<std::uint64_t>  epoch{ 0 };
+        std::uint32_t               nesting       = 0;
+        std::uint32_t               since_collect = 0;
+        std::vector<retired_object> retired;
+        /// retired.size(), readable by other threads
+        std::atomic<std::size_t>    pending{ 0 };
+        std::atomic<bool>           in_use{ false };
+        thread_state*               next = nullptr;
+    };
+
+    OCU_FORCEINLINE thread_state& pin_()
+    {
+        thread_state& s = detail::reclaim_local_(*this);
+        if(s.nesting++ == 0)
+        {
+            const std::uint64_t e = epoch_.load(std::memory_order_relaxed);
+            s.epoch.store(e << 1 | 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+        return s;
+    }
+
+    OCU_FORCEINLINE static void unpin_(thread_state& s) noexcept
+    {
+        OCU_ASSERT(s.nesting > 0, "epoch_domain::unpin without pin");
+        if(--s.nesting == 0) s.epoch.store(0, std::memory_order_release);
+    }
+
+    thread_state* attach_() { return states_.acquire(); }
+
+    /// Hands the thread's unfreed objects to the domain and releases its record. Runs on thread exit.
+    void detach_(thread_state& s)
+    {
+        if(!s.retired.empty())
+        {
+            std::lock_guard lock(orphan_mutex_);
+            orphans_.insert(orphans_.end(), s.retired.begin(), s.retired.end());
+            orphan_count_.store(orphans_.size(), std::memory_order_relaxed);
+            s.retired.clear();
+            s.pending.store(0, std::memory_order_relaxed);
+            has_orphans_.store(true, std::memory_order_relaxed);
+        }
+        s.epoch.store(0, std::memory_order_relaxed);
+        s.nesting       = 0;
+        s.since_collect = 0;
+        s.in_use.store(false, std::memory_order_release);
+    }
+
+    /// Advances the epoch if every pinned thread has seen the current one, and returns the epoch afterwards
+    std::uint64_t try_advance_()
+    {
+        std::uint64_t e = epoch_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for(const thread_state* s = states_.head(); s != nullptr; s = s->next)
+        {
+            const std::uint64_t pinned = s->epoch.load(std::memory_order_acquire);
+            if((pinned & 1) != 0 && pinned >> 1 != e) return e;
+        }
+        if(epoch_.compare_exchange_strong(e, e + 1, std::memory_order_acq_rel)) return e + 1;
+        return e;
+    }
+
+    /// Frees the leading objects of batch retired at least two epochs before e
+    static void free_safe_(std::vector<retired_object>& batch, std::uint64_t e)
+    {
+        // Tags within one batch never decrease, so the safe objects form a prefix
+        const auto safe = std::find_if(batch.begin(), batch.end(), [e](const retired_object& r)
+        {
+            return r.epoch + 2 > e;
+        });
+        for(auto it = batch.begin(); it != safe; ++it) it->deleter(it->ptr);
+        batch.erase(batch.begin(), safe);
+    }
+
+    void collect_(thread_state& s)
+    {
+        const std::uint64_t e = try_advance_();
+        s.since_collect = 0;
+        free_safe_(s.retired, e);
+        s.pending.store(s.retired.size(), std::memory_order_relaxed);
+
+        if(has_orphans_.load(std::memory_order_relaxed))
+        {
+            std::lock_guard lock(orphan_mutex_);
+            // Orphans come from several threads, so their tags are not ordered
+            std::stable_partition(orphans_.begin(), orphans_.end(), [e](const retired_object& r)
+            {
+                return r.epoch + 2 <= e;
+            });
+            free_safe_(orphans_, e);
+            orphan_count_.store(orphans_.size(), std::memory_order_relaxed);
+            has_orphans_.store(!orphans_.empty(), std::memory_order_relaxed);
+        }
+    }
+
+    static void free_all_(std::vector<retired_object>& batch)
+    {
+        for(const retired_object& r : batch) r.deleter(r.ptr);
+        batch.clear();
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::uint64_t                                       id_;
+    alignas(cache_line_size) std::atomic<std::uint64_t> epoch_{ 1 };
+    detail::reclaim_state_list<thread_state>            states_;
+
+    std::mutex                                          orphan_mutex_;
+    std::vector<retired_object>                         orphans_;
+    std::atomic<std::size_t>                            orphan_count_{ 0 };
+    std::atomic<bool>                                   has_orphans_{ false };
+};
+
+/**
+ * \brief Domain shared by every structure in the library that does not take one explicitly
+ */
+inline epoch_domain& default_epoch_domain()
+{
+    static epoch_domain d;
+    return d;
+}
+
+/**
+ * \brief Pins an epoch_domain for the guard's lifetime
+ */
+class epoch_guard
+{
+public:
+    OCU_FORCEINLINE explicit epoch_guard(epoch_domain& domain = default_epoch_domain()) : state_(domain.pin_()) { }
+
+    epoch_guard(const epoch_guard&) = delete;
+    epoch_guard& operator=(const epoch_guard&) = delete;
+
+    OCU_FORCEINLINE ~epoch_guard() { epoch_domain::unpin_(state_); }
+
+private:
+    epoch_domain::thread_state& state_;
+};
+
+// hazard_domain =======================================================================================================
+
+/**
+ * \brief Hazard pointer reclamation: a reader publishes each pointer it is about to dereference, and retired
+ *        objects are freed once no published pointer refers to them.
+ *
+ * Unlike epochs, a stalled reader only holds back the objects it has published, so the number of retired but
+ * unfreed objects stays below twice the number of hazard pointers plus scan_threshold per thread. The price is a
+ * full fence for every protected load, against one per operation for epoch_domain.
+ *
+ * Threads that used a domain may exit before or after it, but every hazard_pointer must be destroyed first. The
+ * destructor frees every object still pending.
+ */
+class hazard_domain
+{
+// Typedefs ============================================================================================================
+
+public:
+    /// Minimum retires per thread between scans; scans also wait for twice the number of hazard pointers
+    static constexpr std::size_t scan_threshold = 64;
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    hazard_domain() : id_(detail::register_domain_()) { }
+
+    hazard_domain(const hazard_domain&) = delete;
+    hazard_domain& operator=(const hazard_domain&) = delete;
+
+    ~hazard_domain()
+    {
+        detail::unregister_domain_(id_);
+        for(thread_state* s = states_.head(); s != nullptr; s = s->next)
+        {
+            for(const retired_object& r : s->retired) r.deleter(r.ptr);
+        }
+        for(const retired_object& r : orphans_) r.deleter(r.ptr);
+    }
+
+// Retiring ------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Frees p with delete once no hazard pointer protects it. p must already be unreachable for readers
+     *        that start protecting from now on.
+     */
+    template<typename T>
+    void retire(T* p) { retire(p, &detail::delete_retired<T>); }
+
+    void retire(void* p, void (*deleter)(void*))
+    {
+        thread_state& s = detail::reclaim_local_(*this);
+        s.retired.push_back({ p, deleter, 0 });
+        s.pending.store(s.retired.size(), std::memory_order_relaxed);
+        if(OCU_UNLIKELY(s.retired.size() >= std::max(scan_threshold, 2 * slots_.size()))) scan_(s);
+    }
+
+    /**
+     * \brief Frees every object the calling thread and exited threads retired that is not protected right now
+     */
+    void collect() { scan_(detail::reclaim_local_(*this)); }
+
+    /**
+     * \brief Number of objects retired but not freed yet, exact once retiring threads are quiet
+     */
+    [[nodiscard]] std::size_t pending() const noexcept
+    {
+        std::size_t n = orphan_count_.load(std::memory_order_relaxed);
+        for(const thread_state* s = states_.head(); s != nullptr; s = s->next)
+        {
+            n += s->pending.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    friend class hazard_pointer;
+
+    template<typename Domain>
+    friend struct detail::reclaim_thread_cache;
+
+    template<typename Domain>
+    friend typename Domain::thread_state& detail::reclaim_attach_(Domain&);
+
+    template<typename Domain>
+    friend typename Domain::thread_state& detail::reclaim_local_(Domain&);
+
+    struct alignas(cache_line_size) slot
+    {
+        std::atomic<const void*> ptr{ nullptr };
+        std::atomic<bool>        in_use{ false };
+        slot*                    next = nullptr;
+    };
+
+    struct thread_state
+    {
+        std::vector<retired_object> retired;
+        std::atomic<std::size_t>    pending{ 0 };
+        std::vector<slot*>          free_slots;
+        std::atomic<bool>           in_use{ false };
+        thread_state*               next = nullptr;
+    };
+
+    thread_state* attach_() { return states_.acquire(); }
+
+    void detach_(thread_state& s)
+    {
+        for(slot* h : s.free_slots) h->in_use.store(false, std::memory_order_release);
+        s.free_slots.clear();
+        if(!s.retired.empty())
+        {
+            std::lock_guard lock(orphan_mutex_);
+            orphans_.insert(orphans_.end(), s.retired.begin(), s.retired.end());
+            orphan_count_.store(orphans_.size(), std::memory_order_relaxed);
+            s.retired.clear();
+            s.pending.store(0, std::memory_order_relaxed);
+            has_orphans_.store(true, std::memory_order_relaxed);
+        }
+        s.in_use.store(false, std::memory_order_release);
+    }
+
+    slot* acquire_slot_()
+    {
+        thread_state& s = detail::reclaim_local_(*this);
+        if(!s.free_slots.empty())
+        {
+            slot* h = s.free_slots.back();
+            s.free_slots.pop_back();
+            return h;
+        }
+        return slots_.acquire();
+    }
+
+    void release_slot_(slot* h)
+    {
+        h->ptr.store(nullptr, std::memory_order_release);
+        detail::reclaim_local_(*this).free_slots.push_back(h);
+    }
+
+    void scan_(thread_state& s)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::vector<const void*> hazards;
+        for(const slot* h = slots_.head(); h != nullptr; h = h->next)
+        {
+            if(const void* p = h->ptr.load(std::memory_order_acquire)) hazards.push_back(p);
+        }
+        std::sort(hazards.begin(), hazards.end());
+
+        const auto unprotected = [&](const retired_object& r)
+        {
+            return !std::binary_search(hazards.begin(), hazards.end(), static_cast<const void*>(r.ptr));
+        };
+        free_if_(s.retired, unprotected);
+        s.pending.store(s.retired.size(), std::memory_order_relaxed);
+        if(has_orphans_.load(std::memory_order_relaxed))
+        {
+            std::lock_guard lock(orphan_mutex_);
+            free_if_(orphans_, unprotected);
+            orphan_count_.store(orphans_.size(), std::memory_order_relaxed);
+            has_orphans_.store(!orphans_.empty(), std::memory_order_relaxed);
+        }
+    }
+
+    template<typename Pred>
+    static void free_if_(std::vector<retired_object>& batch, Pred pred)
+    {
+        const auto freed = std::partition(batch.begin(), batch.end(), [&](const retired_object& r)
+        {
+            return !pred(r);
+        });
+        for(auto it = freed; it != batch.end(); ++it) it->deleter(it->ptr);
+        batch.erase(freed, batch.end());
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::uint64_t                            id_;
+    detail::reclaim_state_list<slot>         slots_;
+    detail::reclaim_state_list<thread_state> states_;
+
+    std::mutex                               orphan_mutex_;
+    std::vector<retired_object>              orphans_;
+    std::atomic<std::size_t>                 orphan_count_{ 0 };
+    std::atomic<bool>                        has_orphans_{ false };
+};
+
+inline hazard_domain& default_hazard_domain()
+{
+    static hazard_domain d;
+    return d;
+}
+
+/**
+ * \brief One published pointer of a hazard_domain. Cheap to construct once a thread has used a few: slots are
+ *        recycled through a thread-local free list.
+ *
+ * \code
+ * hazard_pointer hp;
+ * node* n = hp.protect(head);   // safe to dereference until hp is reset or destroyed
+ * \endcode
+ */
+class hazard_pointer
+{
+public:
+    explicit hazard_pointer(hazard_domain& domain = default_hazard_domain())
+        : domain_(domain)
+        , slot_(domain.acquire_slot_())
+    { }
+
+    hazard_pointer(const hazard_pointer&) = delete;
+    hazard_pointer& operator=(const hazard_pointer&) = delete;
+
+    ~hazard_pointer() { domain_.release_slot_(slot_); }
+
+    /**
+     * \brief Loads src and publishes the result, retrying until the published value is still current, so it cannot
+     *        be freed before reset
+     */
+    template<typename T>
+    T* protect(const std::atomic<T*>& src) noexcept
+    {
+        T* p = src.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            slot_->ptr.store(p, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            T* q = src.load(std::memory_order_acquire);
+            if(OCU_LIKELY(q == p)) return p;
+            p = q;
+        }
+    }
+
+    /**
+     * \brief Publishes p, which the caller has already validated some other way
+     */
+    void reset(const void* p = nullptr) noexcept
+    {
+        slot_->ptr.store(p, std::memory_order_release);
+        if(p != nullptr) std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+private:
+    hazard_domain&       domain_;
+    hazard_domain::slot* slot_;
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_RECLAIM_H
@@ -0,0 +1,1210 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_SERIALIZE_H
+#define OPEN_CPP_UTILS_SERIALIZE_H
+
+#include "config.h"
+#include "directed_tree.h"
+#include "filesystem.h"
+#include "flat_map.h"
+#include "hash.h"
+#include "hash_table.h"
+#include "optional.h"
+#include "small_vector.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace open_cpp_utils
+{
+
+/**
+ * \file
+ * Binary serialization into a layout that is read in place.
+ *
+ * A serialized buffer is a 64 byte header followed by the root value. Every value has a fixed-size inline part:
+ * scalars are stored little-endian at their natural alignment, aggregates lay their fields out one after another
+ * with C-like padding, and anything of variable length (strings, vectors, maps, trees) stores a 16 byte
+ * (offset, count) record pointing at an out-of-line array elsewhere in the buffer, aligned for its element type.
+ *
+ * Reading requires no parse. view_serialized checks the header and returns a view of the root: scalars read as
+ * values, strings as std::string_view, sequences as serial_array_view, and maps and trees as views that search and
+ * walk the stored arrays directly. Each (offset, count) record is bounds checked when a view of it is formed, the
+ * arrays of a map or tree are checked against each other, and every index read from the buffer is range checked
+ * before it is followed, so a corrupt or truncated file throws instead of reading out of range. Opening a
+ * serialized_file costs one mmap whatever its size. deserialize rebuilds the owning containers when a mutable copy
+ * is needed.
+ *
+ * Types serialize through serial_traits. Arithmetic types, enums, std::string, std::vector, small_vector,
+ * std::pair, std::tuple, flat_map, hash_map and directed_tree are built in, and aggregates (structs with public
+ * fields, no base classes and no C array members) are reflected automatically, up to 12 fields. Other types
+ * specialize serial_traits with the same members.
+ *
+ * The header records the layout version of this library, a fingerprint of the root type's layout and the root
+ * type's serial_version (a static constexpr member, 0 if absent). Opening a buffer whose fingerprint or version
+ * differs from the requested type throws, so a schema change cannot be misread silently: bump serial_version when
+ * a field changes meaning without changing type.
+ */
+
+template<typename T>
+struct serial_traits;
+
+/// Layout version written to every header; a buffer with another version is rejected
+inline constexpr std::uint16_t serial_format_version = 1;
+
+// serial_writer =======================================================================================================
+
+/**
+ * \brief Output buffer of serialize. Inline parts and out-of-line arrays are allocated as zero-filled ranges and
+ *        addressed by offset, since the buffer moves as it grows.
+ */
+class serial_writer
+{
+// Functions ===========================================================================================================
+
+public:
+    /**
+     * \return Offset of size zero bytes aligned to align
+     */
+    std::size_t allocate(std::size_t size, std::size_t align)
+    {
+        const std::size_t at = (bytes_.size() + align - 1) & ~(align - 1);
+        bytes_.resize(at + size);
+        return at;
+    }
+
+    /**
+     * \brief Stores a scalar little-endian at offset at
+     */
+    template<typename T>
+    void store(std::size_t at, T value) noexcept
+    {
+        using bits = std::conditional_t<sizeof(T) == 1, std::uint8_t,
+                     std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                     std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+
+        bits v;
+        if constexpr(std::is_enum_v<T>) v = static_cast<bits>(value);
+        else                            v = std::bit_cast<bits>(value);
+
+        std::byte* p = bytes_.data() + at;
+        if constexpr(std::endian::native == std::endian::little)
+        {
+            std::memcpy(p, &v, sizeof(v));
+        }
+        else
+        {
+            for(std::size_t i = 0; i < sizeof(v); ++i) p[i] = static_cast<std::byte>(v >> (8 * i));
+        }
+    }
+
+    [[nodiscard]] std::byte*  data()       noexcept { return bytes_.data(); }
+    [[nodiscard]] std::size_t size() const noexcept { return bytes_.size(); }
+
+    void reserve(std::size_t bytes) { bytes_.reserve(bytes); }
+
+    [[nodiscard]] std::vector<std::byte> release() && noexcept { return std::move(bytes_); }
+
+// Variables ===========================================================================================================
+
+private:
+    std::vector<std::byte> bytes_;
+};
+
+// serial_source =======================================================================================================
+
+namespace detail
+{
+
+/// Throws the error every view and read reports for malformed input
+[[noreturn]] inline void serial_corrupt(const char* what)
+{
+    throw std::system_error(std::make_error_code(std::errc::illegal_byte_sequence), what);
+}
+
+}
+
+/**
+ * \brief Serialized bytes being read: the base of every offset, and the bound every out-of-line record is checked
+ *        against
+ */
+class serial_source
+{
+// Functions ===========================================================================================================
+
+public:
+    constexpr serial_source() noexcept = default;
+    constexpr serial_source(const std::byte* data, std::size_t size) noexcept : data_(data), size_(size) { }
+
+    /**
+     * \brief Loads the little-endian scalar at offset at, which a view has already bounds checked
+     */
+    template<typename T>
+    [[nodiscard]] T load(std::size_t at) const noexcept
+    {
+        using bits = std::conditional_t<sizeof(T) == 1, std::uint8_t,
+                     std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                     std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+
+        bits v = 0;
+        const std::byte* p = data_ + at;
+        if constexpr(std::endian::native == std::endian::little)
+        {
+            std::memcpy(&v, p, sizeof(v));
+        }
+        else
+        {
+            for(std::size_t i = 0; i < sizeof(v); ++i) v |= static_cast<bits>(static_cast<bits>(p[i]) << (8 * i));
+        }
+
+        if constexpr(std::is_enum_v<T>) return static_cast<T>(v);
+        else                            return std::bit_cast<T>(v);
+    }
+
+    /**
+     * \brief Decodes the (offset, count) record at offset at into the offset of an array of count elements of
+     *        stride bytes
+     * \throws std::system_error illegal_byte_sequence if the array is misaligned or does not fit in the buffer
+     */
+    [[nodiscard]] std::pair<std::size_t, std::size_t> array(std::size_t at, std::size_t stride,
+                                                            std::size_t align) const
+    {
+        const std::uint64_t offset = load<std::uint64_t>(at);
+        const std::uint64_t count  = load<std::uint64_t>(at + 8);
+        if(count == 0) return { 0, 0 };
+
+        if(offset > size_ || offset % align != 0 || (stride != 0 && count > (size_ - offset) / stride))
+        {
+            detail::serial_corrupt("serialize: array out of bounds");
+        }
+        return { static_cast<std::size_t>(offset), static_cast<std::size_t>(count) };
+    }
+
+    [[nodiscard]] const std::byte* data() const noexcept { return data_; }
+    [[nodiscard]] std::size_t      size() const noexcept { return size_; }
+
+// Variables ===========================================================================================================
+
+private:
+    const std::byte* data_ = nullptr;
+    std::size_t      size_ = 0;
+};
+
+// Typedefs ============================================================================================================
+
+/// What view_serialized and the views return for a stored T
+template<typename T>
+using serial_view_t = decltype(serial_traits<T>::view(std::declval<serial_source>(), std::size_t{ }));
+
+/// Scalars stored with their own representation: arrays of them can be handed out as spans on little-endian hosts
+template<typename T>
+concept serial_scalar = (std::is_arithmetic_v<T> || std::is_enum_v<T>) && sizeof(T) <= 8;
+
+/// T::serial_version if T declares one, otherwise 0
+template<typename T>
+inline constexpr std::uint32_t serial_version_v = [] {
+    if constexpr(requires { { T::serial_version } -> std::convertible_to<std::uint32_t>; }) return T::serial_version;
+    else                                                                                     return std::uint32_t{ };
+}();
+
+namespace detail
+{
+
+[[nodiscard]] constexpr std::size_t serial_align_up(std::size_t n, std::size_t align) noexcept
+{
+    return (n + align - 1) & ~(align - 1);
+}
+
+[[nodiscard]] constexpr std::uint64_t serial_mix(std::uint64_t h, std::uint64_t v) noexcept
+{
+    return (h ^ v) * 0x100000001B3ull + (h >> 29);
+}
+
+/// Size, in bytes, of the (offset, count) record an out-of-line array is referenced by
+inline constexpr std::size_t serial_record_size = 16;
+
+inline void serial_store_record(serial_writer& w, std::size_t at, std::size_t base, std::size_t count) noexcept
+{
+    w.store<std::uint64_t>(at, base);
+    w.store<std::uint64_t>(at + 8, count);
+}
+
+/**
+ * \brief Writes count elements from range r as an out-of-line array and stores its record at offset at
+ */
+template<typename T, typename Range>
+void serial_write_array(serial_writer& w, std::size_t at, const Range& r, std::size_t count)
+{
+    using traits = serial_traits<T>;
+
+    if(count == 0) return;
+
+    const std::size_t base = w.allocate(count * traits::size, traits::align);
+    if constexpr(serial_scalar<T> && std::ranges::contiguous_range<Range> && std::endian::native == std::endian::little
+                 && std::is_same_v<std::remove_cv_t<std::ranges::range_value_t<Range>>, T>)
+    {
+        std::memcpy(w.data() + base, std::ranges::data(r), count * sizeof(T));
+    }
+    else
+    {
+        std::size_t element = base;
+        for(const auto& value : r)
+        {
+            traits::write(w, element, value);
+            element += traits::size;
+        }
+    }
+
+    serial_store_record(w, at, base, count);
+}
+
+/**
+ * \brief Builds a container of T from the out-of-line array referenced at offset at
+ */
+template<typename Container, typename T>
+Container serial_read_array(serial_source src, std::size_t at)
+{
+    using traits = serial_traits<T>;
+
+    const auto [base, count] = src.array(at, traits::size, traits::align);
+
+    Container out;
+    if constexpr(serial_scalar<T> && std::endian::native == std::endian::little
+                 && requires(Container& c) { c.resize(std::size_t{ }); c.data(); })
+    {
+        out.resize(count);
+        if(count != 0) std::memcpy(std::data(out), src.data() + base, count * sizeof(T));
+    }
+    else
+    {
+        out.reserve(count);
+        for(std::size_t i = 0; i < count; ++i) out.push_back(traits::read(src, base + i * traits::size));
+    }
+    return out;
+}
+
+/// Key bytes hashed by the persisted hash_map index. Unlike hash<K>, xxh64 is stable across builds and platforms.
+template<serial_scalar K>
+[[nodiscard]] std::uint64_t serial_key_hash(K key) noexcept
+{
+    std::array<char, sizeof(K)> bytes;
+    std::memcpy(bytes.data(), &key, sizeof(K));
+    if constexpr(std::endian::native == std::endian::big) std::reverse(bytes.begin(), bytes.end());
+    return xxh64(std::string_view(bytes.data(), bytes.size()));
+}
+
+[[nodiscard]] inline std::uint64_t serial_key_hash(std::string_view key) noexcept { return xxh64(key); }
+
+} // namespace detail
+
+// Scalars and Strings -------------------------------------------------------------------------------------------------
+
+template<serial_scalar T>
+struct serial_traits<T>
+{
+    static constexpr std::size_t   size        = sizeof(T);
+    static constexpr std::size_t   align       = sizeof(T);
+    static constexpr std::uint64_t fingerprint = detail::serial_mix(detail::serial_mix(1, sizeof(T)),
+        std::is_floating_point_v<T> ? 2 : std::is_signed_v<std::conditional_t<std::is_enum_v<T>, int, T>> ? 1 : 0);
+
+    static void write(serial_writer& w, std::size_t at, T value) noexcept { w.store(at, value); }
+    static T    view(serial_source src, std::size_t at) noexcept { return src.load<T>(at); }
+    static T    read(serial_source src, std::size_t at) noexcept { return src.load<T>(at); }
+};
+
+template<>
+struct serial_traits<std::string>
+{
+    static constexpr std::size_t   size        = detail::serial_record_size;
+    static constexpr std::size_t   align       = 8;
+    static constexpr std::uint64_t fingerprint = 2;
+
+    static void write(serial_writer& w, std::size_t at, std::string_view s)
+    {
+        detail::serial_write_array<char>(w, at, s, s.size());
+    }
+
+    static std::string_view view(serial_source src, std::size_t at)
+    {
+        const auto [base, count] = src.array(at, 1, 1);
+        return { reinterpret_cast<const char*>(src.data()) + base, count };
+    }
+
+    static std::string read(serial_source src, std::size_t at) { return std::string(view(src, at)); }
+};
+
+// serial_array_view ===================================================================================================
+
+/**
+ * \brief In-place view of a stored sequence of T. Elements are read on access and returned as serial_view_t<T>.
+ */
+template<typename T>
+class serial_array_view
+{
+// Typedefs ============================================================================================================
+
+public:
+    using value_type = serial_view_t<T>;
+    using size_type  = std::size_t;
+
+    class iterator
+    {
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using value_type       = serial_array_view::value_type;
+        using difference_type  = std::ptrdiff_t;
+
+        iterator() noexcept = default;
+        iterator(serial_source src, std::size_t base, size_type i) noexcept : src_(src), base_(base), i_(i) { }
+
+        value_type operator*() const { return serial_traits<T>::view(src_, base_ + i_ * serial_traits<T>::size); }
+        value_type operator[](difference_type n) const { return *(*this + n); }
+
+        iterator& operator++() noexcept { ++i_; return *this; }
+        iterator& operator--() noexcept { --i_; return *this; }
+        iterator  operator++(int) noexcept { iterator t = *this; ++i_; return t; }
+        iterator  operator--(int) noexcept { iterator t = *this; --i_; return t; }
+
+        iterator& operator+=(difference_type n) noexcept { i_ += static_cast<size_type>(n); return *this; }
+        iterator& operator-=(difference_type n) noexcept { i_ -= static_cast<size_type>(n); return *this; }
+
+        friend iterator operator+(iterator it, difference_type n) noexcept { return it += n; }
+        friend iterator operator+(difference_type n, iterator it) noexcept { return it += n; }
+        friend iterator operator-(iterator it, difference_type n) noexcept { return it -= n; }
+
+        friend difference_type operator-(const iterator& a, const iterator& b) noexcept
+        {
+            return static_cast<difference_type>(a.i_) - static_cast<difference_type>(b.i_);
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) noexcept { return a.i_ == b.i_; }
+        friend auto operator<=>(const iterator& a, const iterator& b) noexcept { return a.i_ <=> b.i_; }
+
+    private:
+        serial_source src_;
+        std::size_t   base_ = 0;
+        size_type     i_    = 0;
+    };
+
+// Functions ===========================================================================================================
+
+public:
+    serial_array_view() noexcept = default;
+    serial_array_view(serial_source src, std::size_t base, size_type count) noexcept
+        : src_(src), base_(base), count_(count) { }
+
+    /**
+     * \brief View of the array whose (offset, count) record is at offset at
+     */
+    static serial_array_view at(serial_source src, std::size_t at)
+    {
+        const auto [base, count] = src.array(at, serial_traits<T>::size, serial_traits<T>::align);
+        return { src, base, count };
+    }
+
+    /**
+     * \throws std::out_of_range if i >= size()
+     */
+    [[nodiscard]] value_type operator[](size_type i) const
+    {
+        if(OCU_UNLIKELY(i >= count_)) throw std::out_of_range("serial_array_view: index out of range");
+        return serial_traits<T>::view(src_, base_ + i * serial_traits<T>::size);
+    }
+
+    [[nodiscard]] value_type front() const { return (*this)[0]; }
+    [[nodiscard]] value_type back()  const { return (*this)[count_ - 1]; }
+
+    [[nodiscard]] iterator begin() const noexcept { return { src_, base_, 0 }; }
+    [[nodiscard]] iterator end()   const noexcept { return { src_, base_, count_ }; }
+
+    [[nodiscard]] size_type size()  const noexcept { return count_; }
+    [[nodiscard]] bool      empty() const noexcept { return count_ == 0; }
+
+    /**
+     * \brief The elements themselves, without copying. Scalars are stored in the host's representation only on
+     *        little-endian hosts.
+     */
+    [[nodiscard]] std::span<const T> span() const noexcept
+        requires (serial_scalar<T> && std::endian::native == std::endian::little)
+    {
+        if(count_ == 0) return { };
+        return { reinterpret_cast<const T*>(src_.data() + base_), count_ };
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    serial_source src_;
+    std::size_t   base_  = 0;
+    size_type     count_ = 0;
+};
+
+// serial_record_view ==================================================================================================
+
+/**
+ * \brief In-place view of a stored aggregate, pair or tuple. get<I>() views field I, and structured bindings work
+ *        as they do on the type itself.
+ */
+template<typename T>
+class serial_record_view
+{
+    using traits = serial_traits<T>;
+
+public:
+    serial_record_view() noexcept = default;
+    serial_record_view(serial_source src, std::size_t at) noexcept : src_(src), at_(at) { }
+
+    template<std::size_t I>
+    [[nodiscard]] auto get() const
+    {
+        using field = typename traits::template field_type<I>;
+        return serial_traits<field>::view(src_, at_ + traits::offsets[I]);
+    }
+
+private:
+    serial_source src_;
+    std::size_t   at_ = 0;
+};
+
+// serial_flat_map_view ================================================================================================
+
+/**
+ * \brief In-place view of a stored flat_map: binary search over the stored key array
+ */
+template<typename K, typename V, typename Compare = std::less<>>
+class serial_flat_map_view
+{
+public:
+    using size_type = std::size_t;
+
+    serial_flat_map_view() noexcept = default;
+    serial_flat_map_view(serial_array_view<K> keys, serial_array_view<V> values) noexcept
+        : keys_(keys), values_(values) { }
+
+    /**
+     * \return Index of the first key not ordered before key, or size()
+     */
+    template<typename Q>
+    [[nodiscard]] size_type lower_bound(const Q& key) const
+    {
+        const Compare comp{ };
+        if constexpr(requires { keys_.span(); })
+        {
+            return detail::branchless_lower_bound(keys_.span().data(), keys_.size(), key, comp);
+        }
+
+        size_type len = keys_.size();
+        if(len == 0) return 0;
+
+        // The halving sequence depends only on the size, so the compare only selects and never branches
+        size_type first = 0;
+        while(len > 1)
+        {
+            const size_type half = len / 2;
+            first = comp(keys_[first + half], key) ? first + half : first;
+            len  -= half;
+        }
+        return first + (comp(keys_[first], key) ? 1 : 0);
+    }
+
+    template<typename Q>
+    [[nodiscard]] optional<serial_view_t<V>> find(const Q& key) const
+    {
+        const size_type i = lower_bound(key);
+        if(i == keys_.size() || Compare{ }(key, keys_[i])) return { };
+        return values_[i];
+    }
+
+    template<typename Q>
+    [[nodiscard]] bool contains(const Q& key) const { return find(key).has_value(); }
+
+    [[nodiscard]] const serial_array_view<K>& keys()   const noexcept { return keys_; }
+    [[nodiscard]] const serial_array_view<V>& values() const noexcept { return values_; }
+
+    [[nodiscard]] size_type size()  const noexcept { return keys_.size(); }
+    [[nodiscard]] bool      empty() const noexcept { return keys_.empty(); }
+
+private:
+    serial_array_view<K> keys_;
+    serial_array_view<V> values_;
+};
+
+// serial_hash_map_view ================================================================================================
+
+/**
+ * \brief In-place view of a stored hash_map. The writer stores a power-of-two index, at most half full, keyed by
+ *        xxh64 of the key. Each slot holds an entry number and the top 32 bits of its hash, so find probes
+ *        linearly and reads a stored key only when the tags match.
+ */
+template<typename K, typename V>
+class serial_hash_map_view
+{
+public:
+    using size_type = std::size_t;
+
+    serial_hash_map_view() noexcept = default;
+    serial_hash_map_view(serial_array_view<K> keys, serial_array_view<V> values,
+                         serial_array_view<std::uint64_t> slots) noexcept
+        : keys_(keys), values_(values), slots_(slots) { }
+
+    template<typename Q>
+    [[nodiscard]] optional<serial_view_t<V>> find(const Q& key) const
+    {
+        if(slots_.empty()) return { };
+
+        const auto          probe = static_cast<serial_view_t<K>>(key);
+        const std::uint64_t hash  = detail::serial_key_hash(probe);
+        const std::uint64_t tag   = hash & 0xFFFFFFFF00000000ull;
+        const std::size_t   mask  = slots_.size() - 1;
+
+        // A well-formed index always has an empty slot; the step limit only matters for a corrupt one
+        std::size_t i = hash & mask;
+        for(std::size_t step = 0; step < slots_.size(); ++step, i = (i + 1) & mask)
+        {
+            const std::uint64_t slot  = slots_[i];
+            const std::size_t   entry = static_cast<std::uint32_t>(slot);
+            if(entry == 0) return { };
+            if((slot & 0xFFFFFFFF00000000ull) == tag && entry <= keys_.size() && keys_[entry - 1] == probe)
+            {
+                return values_[entry - 1];
+            }
+        }
+        return { };
+    }
+
+    template<typename Q>
+    [[nodiscard]] bool contains(const Q& key) const { return find(key).has_value(); }
+
+    [[nodiscard]] const serial_array_view<K>& keys()   const noexcept { return keys_; }
+    [[nodiscard]] const serial_array_view<V>& values() const noexcept { return values_; }
+
+    [[nodiscard]] size_type size()  const noexcept { return keys_.size(); }
+    [[nodiscard]] bool      empty() const noexcept { return keys_.empty(); }
+
+private:
+    serial_array_view<K>             keys_;
+    serial_array_view<V>             values_;
+    serial_array_view<std::uint64_t> slots_;
+};
+
+// serial_tree_view ====================================================================================================
+
+/**
+ * \brief In-place view of a stored directed_tree. Nodes are numbered in pre-order, so the root is node 0 and a
+ *        depth-first walk is a scan of indices 0 to size() - 1.
+ */
+template<typename T>
+class serial_tree_view
+{
+public:
+    using size_type = std::size_t;
+    using node      = tree_node;
+
+    serial_tree_view() noexcept = default;
+    serial_tree_view(serial_array_view<std::uint32_t> parent, serial_array_view<std::uint32_t> first_child,
+                     serial_array_view<std::uint32_t> next_sibling, serial_array_view<T> values) noexcept
+        : parent_(parent), first_child_(first_child), next_sibling_(next_sibling), values_(values) { }
+
+    [[nodiscard]] serial_view_t<T> operator[](node n) const { return values_[n.index()]; }
+
+    [[nodiscard]] node root()               const noexcept { return values_.empty() ? node() : node(0); }
+    [[nodiscard]] node parent(node n)       const          { return link_(parent_, n); }
+    [[nodiscard]] node first_child(node n)  const          { return link_(first_child_, n); }
+    [[nodiscard]] node next_sibling(node n) const          { return link_(next_sibling_, n); }
+
+    [[nodiscard]] const serial_array_view<T>& values() const noexcept { return values_; }
+
+    [[nodiscard]] size_type size()  const noexcept { return values_.size(); }
+    [[nodiscard]] bool      empty() const noexcept { return values_.empty(); }
+
+private:
+    node link_(const serial_array_view<std::uint32_t>& links, node n) const
+    {
+        const std::uint32_t i = links[n.index()];
+        if(i != node::npos && i >= values_.size()) detail::serial_corrupt("serialize: directed_tree link out of range");
+        return node(i);
+    }
+
+    serial_array_view<std::uint32_t> parent_;
+    serial_array_view<std::uint32_t> first_child_;
+    serial_array_view<std::uint32_t> next_sibling_;
+    serial_array_view<T>             values_;
+};
+
+// serial_traits =======================================================================================================
+
+namespace detail
+{
+
+struct serial_any_field
+{
+    template<typename U>
+    operator U() const;
+};
+
+template<typename T, typename... Fields>
+constexpr std::size_t serial_arity_() noexcept
+{
+    if constexpr(requires { T{ std::declval<Fields>()..., std::declval<serial_any_field>() }; })
+    {
+        return serial_arity_<T, Fields..., serial_any_field>();
+    }
+    else
+    {
+        return sizeof...(Fields);
+    }
+}
+
+template<typename T>
+auto serial_tie_(const T& x) noexcept
+{
+    constexpr std::size_t n = serial_arity_<T>();
+    static_assert(n <= 12, "serialize: aggregates with more than 12 fields need a serial_traits specialization");
+
+    if constexpr(n == 0)       { return std::tie(); }
+    else if constexpr(n == 1)  { const auto& [a] = x; return std::tie(a); }
+    else if constexpr(n == 2)  { const auto& [a, b] = x; return std::tie(a, b); }
+    else if constexpr(n == 3)  { const auto& [a, b, c] = x; return std::tie(a, b, c); }
+    else if constexpr(n == 4)  { const auto& [a, b, c, d] = x; return std::tie(a, b, c, d); }
+    else if constexpr(n == 5)  { const auto& [a, b, c, d, e] = x; return std::tie(a, b, c, d, e); }
+    else if constexpr(n == 6)  { const auto& [a, b, c, d, e, f] = x; return std::tie(a, b, c, d, e, f); }
+    else if constexpr(n == 7)  { const auto& [a, b, c, d, e, f, g] = x; return std::tie(a, b, c, d, e, f, g); }
+    else if constexpr(n == 8)
+    {
+        const auto& [a, b, c, d, e, f, g, h] = x;
+        return std::tie(a, b, c, d, e, f, g, h);
+    }
+    else if constexpr(n == 9)
+    {
+        const auto& [a, b, c, d, e, f, g, h, i] = x;
+        return std::tie(a, b, c, d, e, f, g, h, i);
+    }
+    else if constexpr(n == 10)
+    {
+        const auto& [a, b, c, d, e, f, g, h, i, j] = x;
+        return std::tie(a, b, c, d, e, f, g, h, i, j);
+    }
+    else if constexpr(n == 11)
+    {
+        const auto& [a, b, c, d, e, f, g, h, i, j, k] = x;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k);
+    }
+    else
+    {
+        const auto& [a, b, c, d, e, f, g, h, i, j, k, l] = x;
+        return std::tie(a, b, c, d, e, f, g, h, i, j, k, l);
+    }
+}
+
+/// Field access for reflected aggregates
+template<typename T>
+struct serial_aggregate_access
+{
+    static auto tie(const T& x) noexcept { return serial_tie_(x); }
+
+    template<typename... Fields>
+    static T make(Fields&&... fields) { return T{ std::forward<Fields>(fields)... }; }
+};
+
+/// Field access for std::pair and std::tuple
+template<typename T>
+struct serial_tuple_access
+{
+    static auto tie(const T& x) noexcept { return std::apply([](const auto&... f) { return std::tie(f...); }, x); }
+
+    template<typename... Fields>
+    static T make(Fields&&... fields) { return T(std::forward<Fields>(fields)...); }
+};
+
+template<typename Tied, typename Indices = std::make_index_sequence<std::tuple_size_v<Tied>>>
+struct serial_layout;
+
+template<typename Tied, std::size_t... I>
+struct serial_layout<Tied, std::index_sequence<I...>>
+{
+    template<std::size_t J>
+    using field_type = std::remove_cvref_t<std::tuple_element_t<J, Tied>>;
+
+    static constexpr std::size_t count = sizeof...(I);
+    static constexpr std::size_t align = std::max({ std::size_t{ 1 }, serial_traits<field_type<I>>::align... });
+
+    static constexpr std::array<std::size_t, count> offsets = [] {
+        std::array<std::size_t, count> o{ };
+        std::size_t at = 0;
+        ((o[I] = at = serial_align_up(at, serial_traits<field_type<I>>::align),
+          at += serial_traits<field_type<I>>::size), ...);
+        return o;
+    }();
+
+    static constexpr std::size_t size = [] {
+        std::size_t end = 0;
+        ((end = offsets[I] + serial_traits<field_type<I>>::size), ...);
+        return serial_align_up(end, align);
+    }();
+
+    static constexpr std::uint64_t fingerprint = [] {
+        std::uint64_t h = serial_mix(4, count);
+        ((h = serial_mix(h, serial_traits<field_type<I>>::fingerprint)), ...);
+        return h;
+    }();
+};
+
+/**
+ * \brief serial_traits of a type stored field by field
+ */
+template<typename T, typename Access>
+struct serial_record_traits : serial_layout<decltype(Access::tie(std::declval<const T&>()))>
+{
+    using layout = serial_layout<decltype(Access::tie(std::declval<const T&>()))>;
+
+    static void write(serial_writer& w, std::size_t at, const T& value)
+    {
+        write_(w, at, Access::tie(value), std::make_index_sequence<layout::count>{ });
+    }
+
+    static serial_record_view<T> view(serial_source src, std::size_t at) noexcept { return { src, at }; }
+
+    static T read(serial_source src, std::size_t at)
+    {
+        return read_(src, at, std::make_index_sequence<layout::count>{ });
+    }
+
+private:
+    template<typename Tied, std::size_t... I>
+    static void write_(serial_writer& w, std::size_t at, const Tied& fields, std::index_sequence<I...>)
+    {
+        (serial_traits<typename layout::template field_type<I>>::write(w, at + layout::offsets[I],
+                                                                       std::get<I>(fields)), ...);
+    }
+
+    template<std::size_t... I>
+    static T read_(serial_source src, std::size_t at, std::index_sequence<I...>)
+    {
+        return Access::make(serial_traits<typename layout::template field_type<I>>::read(src,
+                                                                                        at + layout::offsets[I])...);
+    }
+};
+
+/**
+ * \brief serial_traits of a sequence container of T stored as one out-of-line array
+ */
+template<typename Container, typename T>
+struct serial_sequence_traits
+{
+    static constexpr std::size_t   size        = serial_record_size;
+    static constexpr std::size_t   align       = 8;
+    static constexpr std::uint64_t fingerprint = serial_mix(3, serial_traits<T>::fingerprint);
+
+    static void write(serial_writer& w, std::size_t at, const Container& c)
+    {
+        serial_write_array<T>(w, at, c, std::size(c));
+    }
+
+    static serial_array_view<T> view(serial_source src, std::size_t at) { return serial_array_view<T>::at(src, at); }
+
+    static Container read(serial_source src, std::size_t at) { return serial_read_array<Container, T>(src, at); }
+};
+
+} // namespace detail
+
+/**
+ * \brief Aggregates not covered by a specialization are reflected field by field
+ */
+template<typename T>
+struct serial_traits : detail::serial_record_traits<T, detail::serial_aggregate_access<T>>
+{
+    static_assert(std::is_aggregate_v<T> && !std::is_array_v<T>,
+                  "serialize: T is neither a built-in serializable type nor an aggregate; specialize serial_traits");
+};
+
+template<typename T, typename Alloc>
+struct serial_traits<std::vector<T, Alloc>> : detail::serial_sequence_traits<std::vector<T, Alloc>, T> { };
+
+template<typename T, std::size_t N, typename Alloc>
+struct serial_traits<small_vector<T, N, Alloc>> : detail::serial_sequence_traits<small_vector<T, N, Alloc>, T> { };
+
+template<typename A, typename B>
+struct serial_traits<std::pair<A, B>> : detail::serial_record_traits<std::pair<A, B>,
+                                                                     detail::serial_tuple_access<std::pair<A, B>>> { };
+
+template<typename... Ts>
+struct serial_traits<std::tuple<Ts...>> : detail::serial_record_traits<std::tuple<Ts...>,
+                                                                       detail::serial_tuple_access<std::tuple<Ts...>>>
+{ };
+
+/**
+ * \brief flat_map stores its key and value arrays as they are; the view binary searches the keys in place
+ */
+template<typename K, typename V, typename Compare, typename KeyContainer, typename MappedContainer>
+struct serial_traits<flat_map<K, V, Compare, KeyContainer, MappedContainer>>
+{
+    using map_type     = flat_map<K, V, Compare, KeyContainer, MappedContainer>;
+    using view_compare = std::conditional_t<std::is_same_v<Compare, std::less<K>>, std::less<>, Compare>;
+
+    static constexpr std::size_t   size        = 2 * detail::serial_record_size;
+    static constexpr std::size_t   align       = 8;
+    static constexpr std::uint64_t fingerprint = detail::serial_mix(detail::serial_mix(5,
+        serial_traits<K>::fingerprint), serial_traits<V>::fingerprint);
+
+    static void write(serial_writer& w, std::size_t at, const map_type& map)
+    {
+        detail::serial_write_array<K>(w, at, map.keys(), map.size());
+        detail::serial_write_array<V>(w, at + detail::serial_record_size, map.values(), map.size());
+    }
+
+    static serial_flat_map_view<K, V, view_compare> view(serial_source src, std::size_t at)
+    {
+        const serial_array_view<K> keys   = serial_array_view<K>::at(src, at);
+        const serial_array_view<V> values = serial_array_view<V>::at(src, at + detail::serial_record_size);
+        if(keys.size() != values.size()) detail::serial_corrupt("serialize: flat_map key and value counts differ");
+        return { keys, values };
+    }
+
+    static map_type read(serial_source src, std::size_t at)
+    {
+        KeyContainer    keys   = detail::serial_read_array<KeyContainer, K>(src, at);
+        MappedContainer values = detail::serial_read_array<MappedContainer, V>(src, at + detail::serial_record_size);
+        if(keys.size() != values.size()) detail::serial_corrupt("serialize: flat_map key and value counts differ");
+        return map_type(sorted_unique, std::move(keys), std::move(values));
+    }
+};
+
+/**
+ * \brief hash_map stores its entries in iteration order plus an open addressing index over them, so the view looks
+ *        keys up in place. Keys must be scalars or std::string.
+ */
+template<typename K, typename V, typename Hash, typename Eq, typename Alloc>
+struct serial_traits<hash_map<K, V, Hash, Eq, Alloc>>
+{
+    static_assert(serial_scalar<K> || std::is_same_v<K, std::string>,
+                  "serialize: hash_map keys must be scalars or std::string");
+
+    using map_type = hash_map<K, V, Hash, Eq, Alloc>;
+
+    static constexpr std::size_t   size        = 3 * detail::serial_record_size;
+    static constexpr std::size_t   align       = 8;
+    static constexpr std::uint64_t fingerprint = detail::serial_mix(detail::serial_mix(6,
+        serial_traits<K>::fingerprint), serial_traits<V>::fingerprint);
+
+    static void write(serial_writer& w, std::size_t at, const map_type& map)
+    {
+        const std::size_t n = map.size();
+        if(n == 0) return;
+        if(n >= std::numeric_limits<std::uint32_t>::max() / 2) throw std::length_error("serialize: hash_map too large");
+
+        const std::size_t keys   = w.allocate(n * serial_traits<K>::size, serial_traits<K>::align);
+        const std::size_t values = w.allocate(n * serial_traits<V>::size, serial_traits<V>::align);
+        std::size_t       i      = 0;
+        for(const auto& [key, value] : map)
+        {
+            serial_traits<K>::write(w, keys + i * serial_traits<K>::size, key);
+            serial_traits<V>::write(w, values + i * serial_traits<V>::size, value);
+            ++i;
+        }
+        detail::serial_store_record(w, at, keys, n);
+        detail::serial_store_record(w, at + detail::serial_record_size, values, n);
+
+        std::vector<std::uint64_t> slots(std::bit_ceil(2 * n));
+        const std::size_t          mask  = slots.size() - 1;
+        std::uint64_t              entry = 0;
+        for(const auto& entry_value : map)
+        {
+            const std::uint64_t hash = detail::serial_key_hash(serial_view_t<K>(entry_value.first));
+            std::size_t         slot = hash & mask;
+            while(slots[slot] != 0) slot = (slot + 1) & mask;
+            slots[slot] = (hash & 0xFFFFFFFF00000000ull) | ++entry;
+        }
+        detail::serial_write_array<std::uint64_t>(w, at + 2 * detail::serial_record_size, slots, slots.size());
+    }
+
+    static serial_hash_map_view<K, V> view(serial_source src, std::size_t at)
+    {
+        const serial_array_view<K> keys   = serial_array_view<K>::at(src, at);
+        const serial_array_view<V> values = serial_array_view<V>::at(src, at + detail::serial_record_size);
+        const auto slots = serial_array_view<std::uint64_t>::at(src, at + 2 * detail::serial_record_size);
+        if(keys.size() != values.size()) detail::serial_corrupt("serialize: hash_map key and value counts differ");
+        if(slots.empty() ? !keys.empty() : !std::has_single_bit(slots.size()))
+        {
+            detail::serial_corrupt("serialize: hash_map index size is not a power of two");
+        }
+        return { keys, values, slots };
+    }
+
+    static map_type read(serial_source src, std::size_t at)
+    {
+        const serial_array_view<K> keys   = serial_array_view<K>::at(src, at);
+        const serial_array_view<V> values = serial_array_view<V>::at(src, at + detail::serial_record_size);
+        if(keys.size() != values.size()) detail::serial_corrupt("serialize: hash_map key and value counts differ");
+
+        const auto [key_base, count] = src.array(at, serial_traits<K>::size, serial_traits<K>::align);
+        const auto value_base        = src.array(at + detail::serial_record_size, serial_traits<V>::size,
+                                                 serial_traits<V>::align).first;
+
+        map_type map;
+        map.reserve(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            map.try_emplace(serial_traits<K>::read(src, key_base + i * serial_traits<K>::size),
+                            serial_traits<V>::read(src, value_base + i * serial_traits<V>::size));
+        }
+        return map;
+    }
+};
+
+/**
+ * \brief directed_tree is stored compacted in pre-order: parent, first child and next sibling arrays, then values
+ */
+template<typename T>
+struct serial_traits<directed_tree<T>>
+{
+    using tree_type = directed_tree<T>;
+
+    static constexpr std::size_t   size        = 4 * detail::serial_record_size;
+    static constexpr std::size_t   align       = 8;
+    static constexpr std::uint64_t fingerprint = detail::serial_mix(7, serial_traits<T>::fingerprint);
+
+    static void write(serial_writer& w, std::size_t at, const tree_type& tree)
+    {
+        constexpr std::uint32_t none = tree_node::npos;
+
+        std::vector<tree_node> order;
+        order.reserve(tree.size());
+        for(tree_node n : tree.preorder()) order.push_back(n);
+        if(order.empty()) return;
+
+        std::uint32_t slots = 0;
+        for(tree_node n : order) slots = std::max(slots, n.index() + 1);
+
+        std::vector<std::uint32_t> renumber(slots, none);
+        for(std::size_t i = 0; i < order.size(); ++i) renumber[order[i].index()] = static_cast<std::uint32_t>(i);
+
+        const auto map = [&renumber](tree_node n) { return n ? renumber[n.index()] : none; };
+
+        std::vector<std::uint32_t> parent(order.size()), first_child(order.size()), next_sibling(order.size());
+        for(std::size_t i = 0; i < order.size(); ++i)
+        {
+            parent[i]       = map(tree.parent(order[i]));
+            first_child[i]  = map(tree.first_child(order[i]));
+            next_sibling[i] = map(tree.next_sibling(order[i]));
+        }
+
+        const auto values = order | std::views::transform([&tree](tree_node n) -> const T& { return tree[n]; });
+
+        detail::serial_write_array<std::uint32_t>(w, at, parent, parent.size());
+        detail::serial_write_array<std::uint32_t>(w, at + detail::serial_record_size, first_child, order.size());
+        detail::serial_write_array<std::uint32_t>(w, at + 2 * detail::serial_record_size, next_sibling, order.size());
+        detail::serial_write_array<T>(w, at + 3 * detail::serial_record_size, values, order.size());
+    }
+
+    static serial_tree_view<T> view(serial_source src, std::size_t at)
+    {
+        using links = serial_array_view<std::uint32_t>;
+
+        const links                parent       = links::at(src, at);
+        const links                first_child  = links::at(src, at + detail::serial_record_size);
+        const links                next_sibling = links::at(src, at + 2 * detail::serial_record_size);
+        const serial_array_view<T> values       = serial_array_view<T>::at(src, at + 3 * detail::serial_record_size);
+
+        const std::size_t n = values.size();
+        if(parent.size() != n || first_child.size() != n || next_sibling.size() != n)
+        {
+            detail::serial_corrupt("serialize: directed_tree array lengths differ");
+        }
+        return { parent, first_child, next_sibling, values };
+    }
+
+    static tree_type read(serial_source src, std::size_t at)
+    {
+        const serial_tree_view<T> stored = view(src, at);
+        const auto [base, count]         = src.array(at + 3 * detail::serial_record_size, serial_traits<T>::size,
+                                                     serial_traits<T>::align);
+
+        tree_type tree;
+        if(count == 0) return tree;
+        tree.reserve(count);
+
+        std::vector<tree_node> nodes;
+        nodes.reserve(count);
+        nodes.push_back(tree.emplace_root(serial_traits<T>::read(src, base)));
+        for(std::size_t i = 1; i < count; ++i)
+        {
+            const std::uint32_t p = stored.parent(tree_node(static_cast<std::uint32_t>(i))).index();
+            if(p >= i) detail::serial_corrupt("serialize: directed_tree is not in pre-order");
+            nodes.push_back(tree.emplace_child(nodes[p],
+                                               serial_traits<T>::read(src, base + i * serial_traits<T>::size)));
+        }
+        return tree;
+    }
+};
+
+// Functions ===========================================================================================================
+
+namespace detail
+{
+
+inline constexpr std::size_t serial_header_size = 64;
+inline constexpr char        serial_magic[4]    = { 'O', 'C', 'U', 'S' };
+
+/**
+ * \brief Checks the header against T and returns the offset of the root
+ */
+template<typename T>
+std::size_t serial_check_header_(serial_source src)
+{
+    const auto fail = [](const char* what)
+    {
+        throw std::system_error(std::make_error_code(std::errc::illegal_byte_sequence), what);
+    };
+
+    if(src.size() < serial_header_size || std::memcmp(src.data(), serial_magic, sizeof(serial_magic)) != 0)
+    {
+        fail("serialize: not a serialized buffer");
+    }
+    if(reinterpret_cast<std::uintptr_t>(src.data()) % 8 != 0) fail("serialize: buffer is not 8 byte aligned");
+    if(src.load<std::uint16_t>(4) != serial_format_version) fail("serialize: unsupported format version");
+    if(src.load<std::uint32_t>(8) != serial_version_v<T>) fail("serialize: serial_version mismatch");
+    if(src.load<std::uint64_t>(16) != serial_traits<T>::fingerprint) fail("serialize: layout does not match type");
+    if(src.load<std::uint64_t>(32) != src.size()) fail("serialize: buffer is truncated");
+
+    const std::uint64_t root = src.load<std::uint64_t>(24);
+    if(root > src.size() || serial_traits<T>::size > src.size() - root || root % serial_traits<T>::align != 0)
+    {
+        fail("serialize: root out of bounds");
+    }
+    return static_cast<std::size_t>(root);
+}
+
+} // namespace detail
+
+/**
+ * \brief Serializes value into a new buffer
+ */
+template<typename T>
+[[nodiscard]] std::vector<std::byte> serialize(const T& value)
+{
+    using traits = serial_traits<T>;
+
+    serial_writer w;
+    w.allocate(detail::serial_header_size, 8);
+    std::memcpy(w.data(), detail::serial_magic, sizeof(detail::serial_magic));
+    w.store<std::uint16_t>(4, serial_format_version);
+    w.store<std::uint32_t>(8, serial_version_v<T>);
+    w.store<std::uint64_t>(16, traits::fingerprint);
+
+    const std::size_t root = w.allocate(traits::size, traits::align);
+    w.store<std::uint64_t>(24, root);
+    traits::write(w, root, value);
+
+    w.allocate(0, 8);
+    w.store<std::uint64_t>(32, w.size());
+    return std::move(w).release();
+}
+
+/**
+ * \brief Serializes value into a file, replacing its contents
+ * \throws std::system_error if the file cannot be written
+ */
+template<typename T>
+void save_serialized(const std::filesystem::path& path, const T& value)
+{
+    const std::vector<std::byte> bytes = serialize(value);
+
+    std::FILE* f = nullptr;
+#if defined(OCU_PLATFORM_WINDOWS)
+    if(_wfopen_s(&f, path.c_str(), L"wb") != 0) f = nullptr;
+#else
+    f = std::fopen(path.c_str(), "wb");
+#endif
+    if(f == nullptr) throw std::system_error(detail::last_system_error(), "serialize: cannot write " + path.string());
+
+    const bool ok     = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    const bool closed = std::fclose(f) == 0;
+    if(!ok || !closed) throw std::system_error(std::make_error_code(std::errc::io_error),
+                                               "serialize: cannot write " + path.string());
+}
+
+/**
+ * \brief View of the T serialized in bytes, read in place. bytes must stay alive and unchanged while it is used.
+ * \throws std::system_error illegal_byte_sequence if bytes does not hold a T written by this format version
+ */
+template<typename T>
+[[nodiscard]] serial_view_t<T> view_serialized(std::span<const std::byte> bytes)
+{
+    const serial_source src(bytes.data(), bytes.size());
+    return serial_traits<T>::view(src, detail::serial_check_header_<T>(src));
+}
+
+/**
+ * \brief Rebuilds the T serialized in bytes
+ * \throws std::system_error illegal_byte_sequence if bytes does not hold a T written by this format version
+ */
+template<typename T>
+[[nodiscard]] T deserialize(std::span<const std::byte> bytes)
+{
+    const serial_source src(bytes.data(), bytes.size());
+    return serial_traits<T>::read(src, detail::serial_check_header_<T>(src));
+}
+
+// serialized_file =====================================================================================================
+
+/**
+ * \brief A serialized T mapped from disk. Opening maps the file and checks its header; nothing else is read until
+ *        root() is used, so a multi-gigabyte index is ready as soon as the mapping is.
+ */
+template<typename T>
+class serialized_file
+{
+public:
+    /**
+     * \param hint Paging hint for the mapping; random suits lookups, sequential suits full scans
+     * \throws std::system_error if the file cannot be mapped or does not hold a T
+     */
+    explicit serialized_file(const std::filesystem::path& path, access_pattern hint = access_pattern::random)
+        : file_(path, hint)
+        , root_(view_serialized<T>(file_.bytes()))
+    { }
+
+    [[nodiscard]] const serial_view_t<T>& root() const noexcept { return root_; }
+    [[nodiscard]] const mapped_file&      file() const noexcept { return file_; }
+
+private:
+    mapped_file      file_;
+    serial_view_t<T> root_;
+};
+
+} // namespace open_cpp_utils
+
+template<typename T>
+struct std::tuple_size<open_cpp_utils::serial_record_view<T>>
+    : std::integral_constant<std::size_t, open_cpp_utils::serial_traits<T>::count> { };
+
+template<std::size_t I, typename T>
+struct std::tuple_element<I, open_cpp_utils::serial_record_view<T>>
+{
+    using type = decltype(std::declval<const open_cpp_utils::serial_record_view<T>&>().template get<I>());
+};
+
+#endif // OPEN_CPP_UTILS_SERIALIZE_H
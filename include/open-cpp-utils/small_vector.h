@@ -0,0 +1,784 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_SMALL_VECTOR_H
+#define OPEN_CPP_UTILS_SMALL_VECTOR_H
+
+#include "config.h"
+#include "memory_stats.h"
+#include "template_utils.h"
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace open_cpp_utils
+{
+
+namespace detail
+{
+
+template<typename T, std::size_t N>
+struct small_vector_storage
+{
+    T*       data() noexcept       { return std::launder(reinterpret_cast<T*>(bytes_)); }
+    const T* data() const noexcept { return std::launder(reinterpret_cast<const T*>(bytes_)); }
+
+    alignas(T) std::byte bytes_[N * sizeof(T)];
+};
+
+template<typename T>
+struct small_vector_storage<T, 0>
+{
+    T*       data() noexcept       { return nullptr; }
+    const T* data() const noexcept { return nullptr; }
+};
+
+}
+
+/**
+ * \brief Inline capacity that keeps a small_vector<T> around 64 bytes, with room for at least one element.
+ */
+template<typename T>
+inline constexpr std::size_t default_small_vector_capacity =
+    sizeof(T) * 4 <= 64 - 3 * sizeof(void*) ? (64 - 3 * sizeof(void*)) / sizeof(T) : 1;
+
+/**
+ * \brief Vector that stores up to N elements inside the object and only allocates once it outgrows them.
+ *
+ * The interface follows std::vector. Growth, insertion and erasure relocate elements with memcpy/memmove when
+ * is_trivially_relocatable<T> holds, and fall back to move construction otherwise. unchecked_push_back and
+ * unchecked_emplace_back skip the capacity check for hot loops that reserved beforehand.
+ *
+ * Unlike std::vector, moving a small_vector whose elements are inline moves the elements themselves, so iterators
+ * into the source are not carried over.
+ *
+ * \tparam T     Element type
+ * \tparam N     Number of inline elements; 0 makes this a plain heap vector (see dyn_array)
+ * \tparam Alloc Allocator for the heap buffer
+ */
+template<typename T, std::size_t N = default_small_vector_capacity<T>, typename Alloc = std::allocator<T>>
+class small_vector
+{
+// Typedefs ============================================================================================================
+
+public:
+    using value_type             = T;
+    using allocator_type         = Alloc;
+    using size_type              = std::size_t;
+    using difference_type        = std::ptrdiff_t;
+    using reference              = T&;
+    using const_reference        = const T&;
+    using pointer                = T*;
+    using const_pointer          = const T*;
+    using iterator               = T*;
+    using const_iterator         = const T*;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_type inline_capacity = N;
+
+private:
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    static constexpr bool relocate_bitwise = is_trivially_relocatable_v<T>;
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    small_vector() noexcept(std::is_nothrow_default_constructible_v<Alloc>) : small_vector(Alloc()) { }
+
+    explicit small_vector(const Alloc& alloc) noexcept : data_(inline_data_()), alloc_(alloc) { }
+
+    explicit small_vector(size_type count, const Alloc& alloc = Alloc()) : small_vector(alloc)
+    {
+        resize(count);
+    }
+
+    small_vector(size_type count, const T& value, const Alloc& alloc = Alloc()) : small_vector(alloc)
+    {
+        assign(count, value);
+    }
+
+    template<typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    small_vector(InputIt first, InputIt last, const Alloc& alloc = Alloc()) : small_vector(alloc)
+    {
+        assign(first, last);
+    }
+
+    small_vector(std::initializer_list<T> ilist, const Alloc& alloc = Alloc()) : small_vector(alloc)
+    {
+        assign(ilist.begin(), ilist.end());
+    }
+
+    small_vector(const small_vector& other)
+        : small_vector(alloc_traits::select_on_container_copy_construction(other.alloc_))
+    {
+        assign(other.begin(), other.end());
+    }
+
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T> || relocate_bitwise)
+        : small_vector(std::move(other.alloc_))
+    {
+        steal_(other);
+    }
+
+    ~small_vector()
+    {
+        destroy_range_(data_, data_ + size_);
+        release_heap_();
+    }
+
+    small_vector& operator=(const small_vector& other)
+    {
+        if(this == &other) return *this;
+
+        if constexpr(alloc_traits::propagate_on_container_copy_assignment::value)
+        {
+            if(alloc_ != other.alloc_)
+            {
+                clear();
+                release_heap_();
+                alloc_ = other.alloc_;
+            }
+        }
+        assign(other.begin(), other.end());
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& other)
+        noexcept((std::is_nothrow_move_constructible_v<T> || relocate_bitwise) &&
+                 (alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value))
+    {
+        if(this == &other) return *this;
+
+        clear();
+        if(alloc_traits::propagate_on_container_move_assignment::value || alloc_ == other.alloc_)
+        {
+            release_heap_();
+            if constexpr(alloc_traits::propagate_on_container_move_assignment::value) alloc_ = std::move(other.alloc_);
+            steal_(other);
+        }
+        else
+        {
+            assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            other.clear();
+        }
+        return *this;
+    }
+
+    small_vector& operator=(std::initializer_list<T> ilist)
+    {
+        assign(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    void assign(size_type count, const T& value)
+    {
+        if(count > capacity_)
+        {
+            small_vector tmp(alloc_);
+            tmp.reserve(count);
+            std::uninitialized_fill_n(tmp.data_, count, value);
+            tmp.size_ = count;
+            *this = std::move(tmp);
+            return;
+        }
+
+        const size_type common = std::min(count, size_);
+        std::fill_n(data_, common, value);
+        if(count > size_) std::uninitialized_fill_n(data_ + size_, count - size_, value);
+        else              destroy_range_(data_ + count, data_ + size_);
+        size_ = count;
+    }
+
+    template<typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    void assign(InputIt first, InputIt last)
+    {
+        if constexpr(std::is_base_of_v<std::forward_iterator_tag,
+                                       typename std::iterator_traits<InputIt>::iterator_category>)
+        {
+            const size_type count = static_cast<size_type>(std::distance(first, last));
+            if(count > capacity_)
+            {
+                clear();
+                reallocate_(recommend_(count));
+            }
+
+            const size_type common = std::min(count, size_);
+            InputIt mid = std::next(first, static_cast<difference_type>(common));
+            std::copy(first, mid, data_);
+            if(count > size_) std::uninitialized_copy(mid, last, data_ + size_);
+            else              destroy_range_(data_ + count, data_ + size_);
+            size_ = count;
+        }
+        else
+        {
+            clear();
+            for(; first != last; ++first) emplace_back(*first);
+        }
+    }
+
+    void assign(std::initializer_list<T> ilist) { assign(ilist.begin(), ilist.end()); }
+
+    [[nodiscard]] allocator_type get_allocator() const noexcept { return alloc_; }
+
+// Element Access ------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] reference at(size_type pos)
+    {
+        if(pos >= size_) throw std::out_of_range("small_vector::at: index out of range");
+        return data_[pos];
+    }
+
+    [[nodiscard]] const_reference at(size_type pos) const
+    {
+        if(pos >= size_) throw std::out_of_range("small_vector::at: index out of range");
+        return data_[pos];
+    }
+
+    [[nodiscard]] reference operator[](size_type pos) noexcept
+    {
+        OCU_ASSERT(pos < size_, "small_vector index out of range");
+        return data_[pos];
+    }
+
+    [[nodiscard]] const_reference operator[](size_type pos) const noexcept
+    {
+        OCU_ASSERT(pos < size_, "small_vector index out of range");
+        return data_[pos];
+    }
+
+    [[nodiscard]] reference       front()       noexcept { return (*this)[0]; }
+    [[nodiscard]] const_reference front() const noexcept { return (*this)[0]; }
+    [[nodiscard]] reference       back()        noexcept { return (*this)[size_ - 1]; }
+    [[nodiscard]] const_reference back()  const noexcept { return (*this)[size_ - 1]; }
+
+    [[nodiscard]] T*       data()       noexcept { return data_; }
+    [[nodiscard]] const T* data() const noexcept { return data_; }
+
+// Iterators -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] iterator       begin()        noexcept { return data_; }
+    [[nodiscard]] const_iterator begin()  const noexcept { return data_; }
+    [[nodiscard]] const_iterator cbegin() const noexcept { return data_; }
+    [[nodiscard]] iterator       end()          noexcept { return data_ + size_; }
+    [[nodiscard]] const_iterator end()    const noexcept { return data_ + size_; }
+    [[nodiscard]] const_iterator cend()   const noexcept { return data_ + size_; }
+
+    [[nodiscard]] reverse_iterator       rbegin()        noexcept { return reverse_iterator(end()); }
+    [[nodiscard]] const_reverse_iterator rbegin()  const noexcept { return const_reverse_iterator(end()); }
+    [[nodiscard]] const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+    [[nodiscard]] reverse_iterator       rend()          noexcept { return reverse_iterator(begin()); }
+    [[nodiscard]] const_reverse_iterator rend()    const noexcept { return const_reverse_iterator(begin()); }
+    [[nodiscard]] const_reverse_iterator crend()   const noexcept { return const_reverse_iterator(begin()); }
+
+// Capacity ------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] bool      empty()    const noexcept { return size_ == 0; }
+    [[nodiscard]] size_type size()     const noexcept { return size_; }
+    [[nodiscard]] size_type capacity() const noexcept { return capacity_; }
+
+    [[nodiscard]] size_type max_size() const noexcept
+    {
+        return std::min<size_type>(alloc_traits::max_size(alloc_), std::numeric_limits<difference_type>::max());
+    }
+
+    /// True while the elements live in the inline buffer
+    [[nodiscard]] bool is_inline() const noexcept { return data_ == inline_data_(); }
+
+    void reserve(size_type count)
+    {
+        if(count > capacity_) reallocate_(count);
+    }
+
+    void shrink_to_fit()
+    {
+        if(is_inline() || size_ == capacity_) return;
+        if(size_ <= N)
+        {
+            T* heap = data_;
+            const size_type heap_capacity = capacity_;
+            data_     = inline_data_();
+            capacity_ = N;
+            relocate_(heap, heap + size_, data_);
+            deallocate_(heap, heap_capacity);
+        }
+        else
+        {
+            reallocate_(size_);
+        }
+    }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    void clear() noexcept
+    {
+        destroy_range_(data_, data_ + size_);
+        size_ = 0;
+    }
+
+    template<typename...Args>
+    reference emplace_back(Args&&...args)
+    {
+        if(OCU_UNLIKELY(size_ == capacity_)) return grow_emplace_back_(std::forward<Args>(args)...);
+        return unchecked_emplace_back(std::forward<Args>(args)...);
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value)      { emplace_back(std::move(value)); }
+
+    /**
+     * \brief Constructs an element at the end without checking capacity. The caller guarantees size() < capacity().
+     */
+    template<typename...Args>
+    reference unchecked_emplace_back(Args&&...args)
+    {
+        OCU_ASSERT(size_ < capacity_, "small_vector::unchecked_emplace_back past capacity");
+        T* p = ::new(static_cast<void*>(data_ + size_)) T(std::forward<Args>(args)...);
+        ++size_;
+        return *p;
+    }
+
+    void unchecked_push_back(const T& value) { unchecked_emplace_back(value); }
+    void unchecked_push_back(T&& value)      { unchecked_emplace_back(std::move(value)); }
+
+    void pop_back() noexcept
+    {
+        OCU_ASSERT(size_ > 0, "small_vector::pop_back on empty vector");
+        --size_;
+        std::destroy_at(data_ + size_);
+    }
+
+    template<typename...Args>
+    iterator emplace(const_iterator pos, Args&&...args)
+    {
+        const size_type index = static_cast<size_type>(pos - data_);
+        OCU_ASSERT(index <= size_, "small_vector::emplace position out of range");
+
+        if(index == size_)
+        {
+            emplace_back(std::forward<Args>(args)...);
+            return data_ + index;
+        }
+
+        if(size_ == capacity_) return grow_emplace_(index, std::forward<Args>(args)...);
+
+        if constexpr(relocate_bitwise)
+        {
+            // Build the element first (args may alias an element), then open the gap and drop its bytes in
+            alignas(T) std::byte tmp[sizeof(T)];
+            ::new(static_cast<void*>(tmp)) T(std::forward<Args>(args)...);
+            T* p = data_ + index;
+            std::memmove(static_cast<void*>(p + 1), static_cast<const void*>(p), (size_ - index) * sizeof(T));
+            std::memcpy(static_cast<void*>(p), static_cast<const void*>(tmp), sizeof(T));
+        }
+        else
+        {
+            T tmp(std::forward<Args>(args)...);
+            T* p = data_ + index;
+            ::new(static_cast<void*>(data_ + size_)) T(std::move(data_[size_ - 1]));
+            std::move_backward(p, data_ + size_ - 1, data_ + size_);
+            *p = std::move(tmp);
+        }
+        ++size_;
+        return data_ + index;
+    }
+
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T&& value)      { return emplace(pos, std::move(value)); }
+
+    iterator insert(const_iterator pos, size_type count, const T& value)
+    {
+        const size_type index = static_cast<size_type>(pos - data_);
+        if(count == 0) return data_ + index;
+
+        const T copy(value);
+        if(size_ + count > capacity_) reserve(recommend_(size_ + count));
+        if constexpr(relocate_bitwise)
+        {
+            T* p = open_gap_(index, count);
+            try
+            {
+                std::uninitialized_fill_n(p, count, copy);
+            }
+            catch(...)
+            {
+                close_gap_(index, count);
+                throw;
+            }
+            size_ += count;
+        }
+        else
+        {
+            const size_type old_size = size_;
+            for(size_type i = 0; i < count; ++i) unchecked_emplace_back(copy);
+            std::rotate(data_ + index, data_ + old_size, data_ + size_);
+        }
+        return data_ + index;
+    }
+
+    template<typename InputIt, typename = std::enable_if_t<!std::is_integral_v<InputIt>>>
+    iterator insert(const_iterator pos, InputIt first, InputIt last)
+    {
+        const size_type index = static_cast<size_type>(pos - data_);
+
+        if constexpr(relocate_bitwise && std::is_base_of_v<std::forward_iterator_tag,
+                                                          typename std::iterator_traits<InputIt>::iterator_category>)
+        {
+            const size_type count = static_cast<size_type>(std::distance(first, last));
+            if(count == 0) return data_ + index;
+
+            if(size_ + count > capacity_) reserve(recommend_(size_ + count));
+            T* p = open_gap_(index, count);
+            try
+            {
+                std::uninitialized_copy(first, last, p);
+            }
+            catch(...)
+            {
+                close_gap_(index, count);
+                throw;
+            }
+            size_ += count;
+        }
+        else
+        {
+            const size_type old_size = size_;
+            for(; first != last; ++first) emplace_back(*first);
+            std::rotate(data_ + index, data_ + old_size, data_ + size_);
+        }
+        return data_ + index;
+    }
+
+    iterator insert(const_iterator pos, std::initializer_list<T> ilist)
+    {
+        return insert(pos, ilist.begin(), ilist.end());
+    }
+
+    iterator erase(const_iterator pos) noexcept(relocate_bitwise || std::is_nothrow_move_assignable_v<T>)
+    {
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+        noexcept(relocate_bitwise || std::is_nothrow_move_assignable_v<T>)
+    {
+        T* f = data_ + (first - data_);
+        T* l = data_ + (last - data_);
+        if(f == l) return f;
+
+        if constexpr(relocate_bitwise)
+        {
+            destroy_range_(f, l);
+            std::memmove(static_cast<void*>(f), static_cast<const void*>(l),
+                         static_cast<size_type>(data_ + size_ - l) * sizeof(T));
+        }
+        else
+        {
+            T* new_end = std::move(l, data_ + size_, f);
+            destroy_range_(new_end, data_ + size_);
+        }
+        size_ -= static_cast<size_type>(l - f);
+        return f;
+    }
+
+    void resize(size_type count)
+    {
+        if(count < size_)
+        {
+            destroy_range_(data_ + count, data_ + size_);
+            size_ = count;
+            return;
+        }
+
+        reserve(count);
+        std::uninitialized_value_construct(data_ + size_, data_ + count);
+        size_ = count;
+    }
+
+    void resize(size_type count, const T& value)
+    {
+        if(count < size_)
+        {
+            destroy_range_(data_ + count, data_ + size_);
+            size_ = count;
+            return;
+        }
+
+        if(count > capacity_)
+        {
+            const T copy(value);
+            reserve(count);
+            std::uninitialized_fill(data_ + size_, data_ + count, copy);
+        }
+        else
+        {
+            std::uninitialized_fill(data_ + size_, data_ + count, value);
+        }
+        size_ = count;
+    }
+
+    void swap(small_vector& other)
+        noexcept((std::is_nothrow_move_constructible_v<T> || relocate_bitwise) &&
+                 (alloc_traits::propagate_on_container_swap::value || alloc_traits::is_always_equal::value))
+    {
+        if(this == &other) return;
+
+        if(!is_inline() && !other.is_inline())
+        {
+            std::swap(data_,     other.data_);
+            std::swap(size_,     other.size_);
+            std::swap(capacity_, other.capacity_);
+            if constexpr(alloc_traits::propagate_on_container_swap::value) std::swap(alloc_, other.alloc_);
+            return;
+        }
+
+        small_vector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend void swap(small_vector& a, small_vector& b) noexcept(noexcept(a.swap(b))) { a.swap(b); }
+
+// Comparison ----------------------------------------------------------------------------------------------------------
+
+    friend bool operator==(const small_vector& a, const small_vector& b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+    friend auto operator<=>(const small_vector& a, const small_vector& b)
+    {
+        return std::lexicographical_compare_three_way(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    T*       inline_data_()       noexcept { return storage_.data(); }
+    const T* inline_data_() const noexcept { return storage_.data(); }
+
+    size_type recommend_(size_type needed) const
+    {
+        if(needed > max_size()) throw std::length_error("small_vector exceeds max_size()");
+        const size_type doubled = capacity_ >= max_size() / 2 ? max_size() : capacity_ * 2;
+        return std::max<size_type>({ needed, doubled, 4 });
+    }
+
+    T* allocate_(size_type count)
+    {
+        T* p = std::to_address(alloc_traits::allocate(alloc_, count));
+        detail::track_allocation(memory_tag::small_vector, count * sizeof(T));
+        return p;
+    }
+
+    void deallocate_(T* p, size_type count) noexcept
+    {
+        detail::track_deallocation(memory_tag::small_vector, count * sizeof(T));
+        alloc_traits::deallocate(alloc_, p, count);
+    }
+
+    void release_heap_() noexcept
+    {
+        if(!is_inline()) deallocate_(data_, capacity_);
+        data_     = inline_data_();
+        capacity_ = N;
+    }
+
+    static void destroy_range_(T* first, T* last) noexcept
+    {
+        if constexpr(!std::is_trivially_destructible_v<T>) std::destroy(first, last);
+    }
+
+    /// Moves (or, for throwing moves, copies) [first, last) into uninitialized dst without ending the sources.
+    /// On exception nothing is left constructed in dst.
+    static void transfer_(T* first, T* last, T* dst)
+        noexcept(relocate_bitwise || std::is_nothrow_move_constructible_v<T>)
+    {
+        if constexpr(relocate_bitwise)
+        {
+            if(first != last)
+            {
+                std::memcpy(static_cast<void*>(dst), static_cast<const void*>(first),
+                            static_cast<size_type>(last - first) * sizeof(T));
+            }
+        }
+        else if constexpr(std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+        {
+            std::uninitialized_move(first, last, dst);
+        }
+        else
+        {
+            std::uninitialized_copy(first, last, dst);
+        }
+    }
+
+    /// Moves [first, last) into uninitialized dst and ends the lifetime of the sources
+    static void relocate_(T* first, T* last, T* dst)
+        noexcept(relocate_bitwise || std::is_nothrow_move_constructible_v<T>)
+    {
+        transfer_(first, last, dst);
+        if constexpr(!relocate_bitwise) destroy_range_(first, last);
+    }
+
+    void reallocate_(size_type new_capacity)
+    {
+        T* buffer = allocate_(new_capacity);
+        try
+        {
+            relocate_(data_, data_ + size_, buffer);
+        }
+        catch(...)
+        {
+            deallocate_(buffer, new_capacity);
+            throw;
+        }
+        adopt_(buffer, new_capacity);
+    }
+
+    void adopt_(T* buffer, size_type new_capacity) noexcept
+    {
+        if(!is_inline()) deallocate_(data_, capacity_);
+        data_     = buffer;
+        capacity_ = new_capacity;
+    }
+
+    template<typename...Args>
+    OCU_NOINLINE reference grow_emplace_back_(Args&&...args)
+    {
+        return *grow_emplace_(size_, std::forward<Args>(args)...);
+    }
+
+    /**
+     * \brief Reallocating insert. The new element is built in the new buffer before anything moves, so args may
+     *        refer to elements of this vector.
+     */
+    template<typename...Args>
+    T* grow_emplace_(size_type index, Args&&...args)
+    {
+        const size_type new_capacity = recommend_(size_ + 1);
+        T* buffer = allocate_(new_capacity);
+        T* slot   = buffer + index;
+        try
+        {
+            ::new(static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+        }
+        catch(...)
+        {
+            deallocate_(buffer, new_capacity);
+            throw;
+        }
+
+        try
+        {
+            transfer_(data_, data_ + index, buffer);
+            try
+            {
+                transfer_(data_ + index, data_ + size_, slot + 1);
+            }
+            catch(...)
+            {
+                destroy_range_(buffer, buffer + index);
+                throw;
+            }
+        }
+        catch(...)
+        {
+            std::destroy_at(slot);
+            deallocate_(buffer, new_capacity);
+            throw;
+        }
+
+        if constexpr(!relocate_bitwise) destroy_range_(data_, data_ + size_);
+        adopt_(buffer, new_capacity);
+        ++size_;
+        return slot;
+    }
+
+    /// Shifts [index, size) up by count with memmove; elements in the gap are uninitialized. Capacity must suffice.
+    T* open_gap_(size_type index, size_type count) noexcept
+    {
+        T* p = data_ + index;
+        std::memmove(static_cast<void*>(p + count), static_cast<const void*>(p), (size_ - index) * sizeof(T));
+        return p;
+    }
+
+    void close_gap_(size_type index, size_type count) noexcept
+    {
+        T* p = data_ + index;
+        std::memmove(static_cast<void*>(p), static_cast<const void*>(p + count), (size_ - index) * sizeof(T));
+    }
+
+    /// Takes other's elements: adopts its heap buffer, or relocates its inline elements into ours
+    void steal_(small_vector& other) noexcept(std::is_nothrow_move_constructible_v<T> || relocate_bitwise)
+    {
+        if(other.is_inline())
+        {
+            if(other.size_ > capacity_) reallocate_(other.size_);
+            relocate_(other.data_, other.data_ + other.size_, data_);
+            size_ = std::exchange(other.size_, 0);
+        }
+        else
+        {
+            data_     = std::exchange(other.data_, other.inline_data_());
+            size_     = std::exchange(other.size_, 0);
+            capacity_ = std::exchange(other.capacity_, N);
+        }
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    T*                                        data_;
+    size_type                                 size_     = 0;
+    size_type                                 capacity_ = N;
+    OCU_NO_UNIQUE_ADDRESS Alloc               alloc_;
+    detail::small_vector_storage<T, N>        storage_;
+};
+
+template<typename T, std::size_t N, typename Alloc>
+struct is_trivially_relocatable<small_vector<T, N, Alloc>>
+    : std::bool_constant<N == 0 && is_trivially_relocatable<Alloc>::value> { };
+
+/**
+ * \brief Heap-only vector sharing small_vector's relocation fast paths.
+ */
+template<typename T, typename Alloc = std::allocator<T>>
+using dyn_array = small_vector<T, 0, Alloc>;
+
+template<typename T, std::size_t N, typename Alloc, typename U>
+typename small_vector<T, N, Alloc>::size_type erase(small_vector<T, N, Alloc>& v, const U& value)
+{
+    auto it = std::remove(v.begin(), v.end(), value);
+    const auto removed = static_cast<typename small_vector<T, N, Alloc>::size_type>(v.end() - it);
+    v.erase(it, v.end());
+    return removed;
+}
+
+template<typename T, std::size_t N, typename Alloc, typename Pred>
+typename small_vector<T, N, Alloc>::size_type erase_if(small_vector<T, N, Alloc>& v, Pred pred)
+{
+    auto it = std::remove_if(v.begin(), v.end(), pred);
+    const auto removed = static_cast<typename small_vector<T, N, Alloc>::size_type>(v.end() - it);
+    v.erase(it, v.end());
+    return removed;
+}
+
+}
+
+#endif // OPEN_CPP_UTILS_SMALL_VECTOR_H
@@ -0,0 +1,587 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_SPARSE_SET_H
+#define OPEN_CPP_UTILS_SPARSE_SET_H
+
+#include "config.h"
+#include "bitset.h"
+#include "object_pool.h"
+#include "unique_id.h"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace open_cpp_utils
+{
+
+// Typedefs ============================================================================================================
+
+/**
+ * \brief Maps an ID onto the integer that indexes the sparse array. IDs that map to the same key replace each other
+ *        in a sparse_set: inserting one erases the other, so a key must be unique among live IDs. The full ID is
+ *        still compared on lookup, which makes a stale pool handle miss instead of aliasing the slot's new owner.
+ *
+ * Specialize with a static key(Id) for other ID types.
+ */
+template<typename Id>
+struct sparse_key_traits;
+
+template<std::unsigned_integral I>
+struct sparse_key_traits<I>
+{
+    static constexpr std::size_t key(I id) noexcept { return static_cast<std::size_t>(id); }
+};
+
+template<typename Tag, typename T>
+struct sparse_key_traits<unique_id<Tag, T>>
+{
+    static constexpr std::size_t key(unique_id<Tag, T> id) noexcept { return static_cast<std::size_t>(id.value()); }
+};
+
+template<typename T>
+struct sparse_key_traits<pool_handle<T>>
+{
+    static constexpr std::size_t key(pool_handle<T> h) noexcept { return h.index(); }
+};
+
+// sparse_set ==========================================================================================================
+
+/**
+ * \brief Set of IDs with O(1) insert, erase and lookup and a densely packed array of its members.
+ *
+ * A paged sparse array maps each ID's key to its position in the dense array, and the dense array maps back to the
+ * ID. Pages of page_size entries are allocated on first use, so memory follows the ranges of keys actually present
+ * rather than the largest one, apart from one pointer per page. Erasing moves the last member into the freed
+ * position, so dense order is insertion order only until the first erase.
+ *
+ * \tparam Id Member type with a sparse_key_traits specialization
+ */
+template<typename Id = unique_id<>>
+class sparse_set
+{
+// Typedefs ============================================================================================================
+
+public:
+    using id_type    = Id;
+    using size_type  = std::size_t;
+    using index_type = std::uint32_t;
+    using iterator   = typename std::vector<Id>::const_iterator;
+
+    /// Dense index returned for absent IDs
+    static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+    /// Sparse entries per page: 16 KiB of indices
+    static constexpr size_type page_size = 4096;
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    sparse_set() = default;
+
+    sparse_set(const sparse_set& other)
+        : dense_(other.dense_)
+    {
+        pages_.resize(other.pages_.size());
+        for(size_type p = 0; p < pages_.size(); ++p)
+        {
+            if(other.pages_[p] == nullptr) continue;
+            pages_[p] = std::make_unique_for_overwrite<index_type[]>(page_size);
+            std::copy_n(other.pages_[p].get(), page_size, pages_[p].get());
+        }
+    }
+
+    sparse_set(sparse_set&&) noexcept = default;
+
+    sparse_set& operator=(const sparse_set& other)
+    {
+        if(this != &other) *this = sparse_set(other);
+        return *this;
+    }
+
+    sparse_set& operator=(sparse_set&&) noexcept = default;
+
+// Lookup --------------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] OCU_FORCEINLINE index_type index_of(Id id) const noexcept
+    {
+        const size_type key  = sparse_key_traits<Id>::key(id);
+        const size_type page = key / page_size;
+        if(page >= pages_.size() || pages_[page] == nullptr) return npos;
+
+        const index_type i = pages_[page][key % page_size];
+        return i != npos && dense_[i] == id ? i : npos;
+    }
+
+    [[nodiscard]] bool contains(Id id) const noexcept { return index_of(id) != npos; }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Adds id unless it is already a member. A member with the same key, such as a stale handle to the pool
+     *        slot id now occupies, is erased first.
+     * \return dense index of id and whether it was inserted
+     * \throws std::length_error if the set already holds npos members
+     */
+    std::pair<index_type, bool> insert(Id id)
+    {
+        index_type& slot = slot_(sparse_key_traits<Id>::key(id));
+        if(slot != npos)
+        {
+            if(dense_[slot] == id) return { slot, false };
+            erase_at_(slot);
+        }
+
+        if(dense_.size() >= npos) throw std::length_error("sparse_set too large");
+        dense_.push_back(id);
+        slot = static_cast<index_type>(dense_.size() - 1);
+        return { slot, true };
+    }
+
+    /**
+     * \return whether id was a member
+     */
+    bool erase(Id id) noexcept
+    {
+        const index_type i = index_of(id);
+        if(i == npos) return false;
+        erase_at_(i);
+        return true;
+    }
+
+    void clear() noexcept
+    {
+        for(const Id id : dense_) entry_(sparse_key_traits<Id>::key(id)) = npos;
+        dense_.clear();
+    }
+
+    void reserve(size_type n) { dense_.reserve(n); }
+
+    /**
+     * \brief Frees the dense array's spare capacity and every page that no member uses
+     */
+    void shrink_to_fit()
+    {
+        dense_.shrink_to_fit();
+        dynamic_bitset used(pages_.size());
+        for(const Id id : dense_) used.set(sparse_key_traits<Id>::key(id) / page_size);
+        for(size_type p = 0; p < pages_.size(); ++p)
+        {
+            if(!used.test(p)) pages_[p].reset();
+        }
+        while(!pages_.empty() && pages_.back() == nullptr) pages_.pop_back();
+        pages_.shrink_to_fit();
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] bool      empty() const noexcept { return dense_.empty(); }
+    [[nodiscard]] size_type size()  const noexcept { return dense_.size(); }
+
+    /// Members in dense order
+    [[nodiscard]] std::span<const Id> ids() const noexcept { return dense_; }
+
+    [[nodiscard]] iterator begin() const noexcept { return dense_.begin(); }
+    [[nodiscard]] iterator end()   const noexcept { return dense_.end(); }
+
+    /**
+     * \brief One bit per key, set for members, covering every allocated page. Combine it with other masks over the
+     *        same keys and walk the result with for_each_set_bit, or pass it to component_storage::each.
+     */
+    [[nodiscard]] dynamic_bitset key_mask() const
+    {
+        dynamic_bitset mask(pages_.size() * page_size);
+        for(const Id id : dense_) mask.set(sparse_key_traits<Id>::key(id));
+        return mask;
+    }
+
+    [[nodiscard]] size_type memory_usage() const noexcept
+    {
+        size_type pages = 0;
+        for(const auto& p : pages_) pages += p != nullptr;
+        return dense_.capacity() * sizeof(Id) + pages_.capacity() * sizeof(pages_[0])
+             + pages * page_size * sizeof(index_type);
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+protected:
+    /// Dense index of the member whose key is id's, which need not be id itself, or npos
+    [[nodiscard]] index_type key_owner_(Id id) const noexcept
+    {
+        const size_type key  = sparse_key_traits<Id>::key(id);
+        const size_type page = key / page_size;
+        if(page >= pages_.size() || pages_[page] == nullptr) return npos;
+        return pages_[page][key % page_size];
+    }
+
+    /// Swap-removes the member at dense index i
+    void erase_at_(index_type i) noexcept
+    {
+        const Id id   = dense_[i];
+        const Id last = dense_.back();
+        dense_[i] = last;
+        entry_(sparse_key_traits<Id>::key(last)) = i;
+        entry_(sparse_key_traits<Id>::key(id))   = npos;
+        dense_.pop_back();
+    }
+
+private:
+    index_type& entry_(size_type key) noexcept { return pages_[key / page_size][key % page_size]; }
+
+    index_type& slot_(size_type key)
+    {
+        const size_type page = key / page_size;
+        if(page >= pages_.size()) pages_.resize(page + 1);
+        if(pages_[page] == nullptr)
+        {
+            pages_[page] = std::make_unique_for_overwrite<index_type[]>(page_size);
+            std::fill_n(pages_[page].get(), page_size, npos);
+        }
+        return pages_[page][key % page_size];
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::vector<std::unique_ptr<index_type[]>> pages_;
+    std::vector<Id>                            dense_;
+};
+
+// component_storage ===================================================================================================
+
+/**
+ * \brief Components of type T attached to IDs, packed in one contiguous array parallel to a sparse_set's members.
+ *
+ * Adding, removing and looking up a component are O(1). components() is a plain array of every component, so
+ * systems that only touch T run at memory bandwidth and can be vectorized; ids() gives the owner of each element.
+ * Erasing moves the last component into the hole, so references and spans are invalidated by any insert or erase.
+ *
+ * \code
+ * component_storage<position> positions;
+ * component_storage<velocity> velocities;
+ * join(positions, velocities).each([](entity id, position& p, velocity& v) { p += v * dt; });
+ * \endcode
+ *
+ * \tparam T  Component type
+ * \tparam Id Owner type with a sparse_key_traits specialization
+ */
+template<typename T, typename Id = unique_id<>>
+class component_storage : private sparse_set<Id>
+{
+    using base = sparse_set<Id>;
+
+// Typedefs ============================================================================================================
+
+public:
+    using value_type = T;
+    using id_type    = Id;
+    using size_type  = std::size_t;
+    using index_type = typename base::index_type;
+
+    using base::npos;
+
+// Functions ===========================================================================================================
+
+public:
+
+// Lookup --------------------------------------------------------------------------------------------------------------
+
+    using base::index_of;
+    using base::contains;
+
+    /**
+     * \return the component of id, or nullptr if it has none
+     */
+    [[nodiscard]] T* find(Id id) noexcept
+    {
+        const index_type i = index_of(id);
+        return i == npos ? nullptr : &components_[i];
+    }
+
+    [[nodiscard]] const T* find(Id id) const noexcept
+    {
+        const index_type i = index_of(id);
+        return i == npos ? nullptr : &components_[i];
+    }
+
+    /**
+     * \brief Component of id, which must have one
+     */
+    [[nodiscard]] T& get(Id id) noexcept
+    {
+        const index_type i = index_of(id);
+        OCU_ASSERT(i != npos, "component_storage::get on an ID without the component");
+        return components_[i];
+    }
+
+    [[nodiscard]] const T& get(Id id) const noexcept
+    {
+        const index_type i = index_of(id);
+        OCU_ASSERT(i != npos, "component_storage::get on an ID without the component");
+        return components_[i];
+    }
+
+// Modifiers -----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Gives id a component constructed from args, replacing the one it already has. A member with the same
+     *        key, such as a stale handle to the pool slot id now occupies, is erased with its component first.
+     */
+    template<typename... Args>
+    T& emplace(Id id, Args&&... args)
+    {
+        const index_type existing = base::key_owner_(id);
+        if(existing != npos)
+        {
+            if(base::ids()[existing] == id) return components_[existing] = T(std::forward<Args>(args)...);
+            erase_at_(existing);
+        }
+
+        T& c = components_.emplace_back(std::forward<Args>(args)...);
+        try
+        {
+            base::insert(id);
+        }
+        catch(...)
+        {
+            components_.pop_back();
+            throw;
+        }
+        return c;
+    }
+
+    /**
+     * \return whether id had the component
+     */
+    bool erase(Id id) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        const index_type i = index_of(id);
+        if(i == npos) return false;
+        erase_at_(i);
+        return true;
+    }
+
+    void clear() noexcept
+    {
+        components_.clear();
+        base::clear();
+    }
+
+    void reserve(size_type n)
+    {
+        components_.reserve(n);
+        base::reserve(n);
+    }
+
+    void shrink_to_fit()
+    {
+        components_.shrink_to_fit();
+        base::shrink_to_fit();
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    using base::empty;
+    using base::size;
+    using base::ids;
+    using base::key_mask;
+
+    /// Components in dense order, parallel to ids()
+    [[nodiscard]] std::span<T>       components()       noexcept { return components_; }
+    [[nodiscard]] std::span<const T> components() const noexcept { return components_; }
+
+    /// The owners as a sparse_set, for joining against plain sets
+    [[nodiscard]] const sparse_set<Id>& keys() const noexcept { return *this; }
+
+    /**
+     * \brief Calls fn(id, component) for every component, in dense order
+     */
+    template<typename Fn>
+    void each(Fn&& fn)
+    {
+        const std::span<const Id> owners = ids();
+        for(size_type i = 0; i < owners.size(); ++i) fn(owners[i], components_[i]);
+    }
+
+    template<typename Fn>
+    void each(Fn&& fn) const
+    {
+        const std::span<const Id> owners = ids();
+        for(size_type i = 0; i < owners.size(); ++i) fn(owners[i], components_[i]);
+    }
+
+    /**
+     * \brief Calls fn(id, component) for every component whose key is set in mask, in dense order. Keys past the end
+     *        of mask count as clear.
+     */
+    template<typename Fn>
+    void each(const dynamic_bitset& mask, Fn&& fn)
+    {
+        const std::span<const Id> owners = ids();
+        for(size_type i = 0; i < owners.size(); ++i)
+        {
+            if(in_mask_(mask, owners[i])) fn(owners[i], components_[i]);
+        }
+    }
+
+    template<typename Fn>
+    void each(const dynamic_bitset& mask, Fn&& fn) const
+    {
+        const std::span<const Id> owners = ids();
+        for(size_type i = 0; i < owners.size(); ++i)
+        {
+            if(in_mask_(mask, owners[i])) fn(owners[i], components_[i]);
+        }
+    }
+
+    [[nodiscard]] size_type memory_usage() const noexcept
+    {
+        return base::memory_usage() + components_.capacity() * sizeof(T);
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    /// Swap-removes the member at dense index i together with its component
+    void erase_at_(index_type i) noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        if(i + size_type(1) != components_.size()) components_[i] = std::move(components_.back());
+        components_.pop_back();
+        base::erase_at_(i);
+    }
+
+    static bool in_mask_(const dynamic_bitset& mask, Id id) noexcept
+    {
+        const size_type key = sparse_key_traits<Id>::key(id);
+        return key < mask.size() && mask.test(key);
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::vector<T> components_;
+};
+
+// join ================================================================================================================
+
+/**
+ * \brief IDs present in every one of several component storages, visited together with their components.
+ *
+ * each() walks the dense array of whichever storage is smallest when it is called and probes the others, so the
+ * cost is the size of the rarest component times one sparse lookup per other storage. Components may be modified
+ * during the walk, but no storage in the join may gain or lose members until it returns.
+ */
+template<typename... Storages>
+class join_view
+{
+    static_assert(sizeof...(Storages) >= 2, "join needs at least two storages");
+
+    using first_type = std::remove_const_t<std::tuple_element_t<0, std::tuple<Storages...>>>;
+
+// Typedefs ============================================================================================================
+
+public:
+    using id_type    = typename first_type::id_type;
+    using size_type  = std::size_t;
+    using index_type = typename first_type::index_type;
+
+    static_assert((std::is_same_v<typename Storages::id_type, id_type> && ...),
+                  "joined storages must share an ID type");
+
+// Functions ===========================================================================================================
+
+public:
+    explicit join_view(Storages&... storages) noexcept : storages_(storages...) { }
+
+    /**
+     * \brief Calls fn(id, components...) for every ID present in all storages, in the dense order of the smallest
+     */
+    template<typename Fn>
+    void each(Fn&& fn) const
+    {
+        const size_type driver = smallest_();
+        [&]<size_type... I>(std::index_sequence<I...>)
+        {
+            static_cast<void>(((driver == I ? (each_driven_by_<I>(fn), true) : false) || ...));
+        }(std::index_sequence_for<Storages...>{ });
+    }
+
+    /**
+     * \brief Upper bound on the number of IDs each() visits
+     */
+    [[nodiscard]] size_type size_hint() const noexcept
+    {
+        return std::apply([](const auto&... s) { return std::min({ s.size()... }); }, storages_);
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    [[nodiscard]] size_type smallest_() const noexcept
+    {
+        size_type best = 0, best_size = std::get<0>(storages_).size();
+        [&]<size_type... I>(std::index_sequence<I...>)
+        {
+            static_cast<void>(((std::get<I>(storages_).size() < best_size
+                                ? (best = I, best_size = std::get<I>(storages_).size(), 0) : 0), ...));
+        }(std::index_sequence_for<Storages...>{ });
+        return best;
+    }
+
+    template<size_type D, typename Fn>
+    void each_driven_by_(Fn& fn) const
+    {
+        const std::span<const id_type>              owners = std::get<D>(storages_).ids();
+        std::array<index_type, sizeof...(Storages)> found;
+
+        for(size_type i = 0; i < owners.size(); ++i)
+        {
+            const id_type id = owners[i];
+            const bool all = [&]<size_type... J>(std::index_sequence<J...>)
+            {
+                return ((found[J] = J == D ? static_cast<index_type>(i) : std::get<J>(storages_).index_of(id),
+                         found[J] != first_type::npos) && ...);
+            }(std::index_sequence_for<Storages...>{ });
+            if(!all) continue;
+
+            [&]<size_type... J>(std::index_sequence<J...>)
+            {
+                fn(id, std::get<J>(storages_).components()[found[J]]...);
+            }(std::index_sequence_for<Storages...>{ });
+        }
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::tuple<Storages&...> storages_;
+};
+
+/**
+ * \brief Joins component storages on their IDs; see join_view
+ */
+template<typename... Storages>
+[[nodiscard]] join_view<Storages...> join(Storages&... storages) noexcept
+{
+    return join_view<Storages...>(storages...);
+}
+
+}
+
+#endif // OPEN_CPP_UTILS_SPARSE_SET_H
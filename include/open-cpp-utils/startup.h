@@ -0,0 +1,167 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_STARTUP_H
+#define OPEN_CPP_UTILS_STARTUP_H
+
+#include "config.h"
+#include "hash_table.h"
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace open_cpp_utils
+{
+
+// Typedefs ============================================================================================================
+
+/**
+ * \brief Registration record of one OCU_STARTUP function. Constant initialized, so registering costs one pointer
+ *        store during static initialization and nothing runs before run_startup.
+ */
+struct startup_entry
+{
+    constexpr startup_entry(const char* n, void (*f)(), const char* deps) noexcept
+        : name(n), fn(f), dependencies(deps)
+    { }
+
+    startup_entry(const startup_entry&) = delete;
+    startup_entry& operator=(const startup_entry&) = delete;
+
+    const char*    name;
+    void         (*fn)();
+    /// Names of the functions this one runs after, comma separated exactly as written in OCU_STARTUP
+    const char*    dependencies;
+    startup_entry* next = nullptr;
+    bool           done = false;
+};
+
+namespace detail
+{
+
+inline constinit startup_entry* startup_head = nullptr;
+
+inline std::mutex& startup_mutex()
+{
+    static std::mutex m;
+    return m;
+}
+
+struct startup_registrar
+{
+    explicit startup_registrar(startup_entry& e) noexcept
+    {
+        e.next       = startup_head;
+        startup_head = &e;
+    }
+};
+
+/// Calls fn with every name of a comma separated dependency list, trimmed of whitespace
+template<typename Fn>
+void for_each_dependency(std::string_view list, Fn&& fn)
+{
+    constexpr std::string_view space = " \t\r\n";
+    while(!list.empty())
+    {
+        const std::size_t comma = list.find(',');
+        std::string_view  name  = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+
+        const std::size_t first = name.find_first_not_of(space);
+        if(first == std::string_view::npos) continue;
+        name = name.substr(first, name.find_last_not_of(space) - first + 1);
+        fn(name);
+    }
+}
+
+}
+
+// Functions ===========================================================================================================
+
+/**
+ * \brief Runs every registered startup function that has not run yet, each after the functions it depends on, with
+ *        independent ones in parallel on pool. Blocks until all of them have finished.
+ *
+ * Functions registered later, for example by a plugin loaded after startup, run on the next call; dependencies on
+ * functions that already ran count as satisfied. A function that throws is not marked as run.
+ *
+ * \return number of functions executed
+ * \throws std::logic_error on a duplicate name, an unknown dependency or a dependency cycle, before anything runs;
+ *         otherwise the first exception thrown by a startup function
+ */
+inline std::size_t run_startup(thread_pool& pool)
+{
+    std::lock_guard lock(detail::startup_mutex());
+
+    std::vector<startup_entry*> entries;
+    for(startup_entry* e = detail::startup_head; e != nullptr; e = e->next) entries.push_back(e);
+
+    hash_map<std::string_view, std::uint32_t> by_name;
+    by_name.reserve(entries.size());
+    for(std::uint32_t i = 0; i < entries.size(); ++i)
+    {
+        if(!by_name.emplace(entries[i]->name, i).second)
+        {
+            throw std::logic_error(std::string("duplicate startup function '") + entries[i]->name + "'");
+        }
+    }
+
+    task_graph                    graph;
+    std::vector<task_graph::node> nodes(entries.size());
+    for(std::uint32_t i = 0; i < entries.size(); ++i)
+    {
+        startup_entry* e = entries[i];
+        if(!e->done) nodes[i] = graph.emplace([e] { e->fn(); e->done = true; });
+    }
+
+    for(std::uint32_t i = 0; i < entries.size(); ++i)
+    {
+        if(entries[i]->done) continue;
+        detail::for_each_dependency(entries[i]->dependencies, [&](std::string_view dep)
+        {
+            const auto it = by_name.find(dep);
+            if(it == by_name.end())
+            {
+                throw std::logic_error(std::string("startup function '") + entries[i]->name +
+                                       "' depends on unknown '" + std::string(dep) + "'");
+            }
+            if(!entries[it->second]->done) graph.precede(nodes[it->second], nodes[i]);
+        });
+    }
+
+    graph.run(pool);
+    return graph.size();
+}
+
+inline std::size_t run_startup() { return run_startup(default_thread_pool()); }
+
+}
+
+/**
+ * \brief Defines a startup function that run_startup calls after the named dependencies:
+ *
+ *     OCU_STARTUP(renderer, window, config)
+ *     {
+ *         ...
+ *     }
+ *
+ * Names are identifiers and must be unique across the program. Only the registration record is touched during static
+ * initialization. A translation unit in a static library whose only contents are startup functions may be dropped by
+ * the linker, as with any self-registration scheme; link such libraries whole.
+ */
+#define OCU_STARTUP(name, ...)                                                                                         \
+    static void ocu_startup_fn_##name();                                                                               \
+    static constinit ::open_cpp_utils::startup_entry ocu_startup_entry_##name(                                         \
+        #name, &ocu_startup_fn_##name, #__VA_ARGS__);                                                                  \
+    static const ::open_cpp_utils::detail::startup_registrar ocu_startup_registrar_##name(ocu_startup_entry_##name);   \
+    static void ocu_startup_fn_##name()
+
+#endif // OPEN_CPP_UTILS_STARTUP_H
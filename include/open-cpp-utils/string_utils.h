@@ -0,0 +1,1108 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_STRING_UTILS_H
+#define OPEN_CPP_UTILS_STRING_UTILS_H
+
+#include "config.h"
+#include "cpu_features.h"
+#include "hash.h"
+
+#include <array>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ranges>
+#include <string_view>
+
+// The NEON kernels rely on AArch64-only table lookups and across-vector reductions
+#if defined(OCU_HAS_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#   define OCU_STRING_UTILS_NEON 1
+#endif
+
+#if defined(OCU_ARCH_X86)
+#   include <immintrin.h>
+#elif defined(OCU_STRING_UTILS_NEON)
+#   include <arm_neon.h>
+#endif
+
+namespace open_cpp_utils
+{
+
+namespace detail
+{
+
+struct byte_set_tables;
+
+}
+
+// byte_set ============================================================================================================
+
+/**
+ * \brief A set of byte values, searched for with find_first_of and used as the delimiters of split.
+ *
+ * Alongside a 256-bit bitmap for the scalar path it keeps the two 16-entry nibble tables of the SIMD kernels: entry
+ * lo of the first has bit h set when byte (h << 4 | lo) is in the set for h < 8, the second covers h >= 8. A vector
+ * of bytes is then classified with three table shuffles whatever the size of the set. Constexpr, so sets of
+ * constant delimiters cost nothing to build.
+ */
+class byte_set
+{
+public:
+    constexpr byte_set() noexcept = default;
+
+    /// Set of every byte in chars
+    constexpr explicit byte_set(std::string_view chars) noexcept
+    {
+        for(char c : chars) insert(c);
+    }
+
+    constexpr void insert(char c) noexcept
+    {
+        const auto b = static_cast<unsigned char>(c);
+        bits_[b >> 6] |= std::uint64_t(1) << (b & 63);
+        (b < 0x80 ? low_ : high_)[b & 0x0F] |= static_cast<std::uint8_t>(1u << ((b >> 4) & 7));
+    }
+
+    [[nodiscard]] constexpr bool contains(char c) const noexcept
+    {
+        const auto b = static_cast<unsigned char>(c);
+        return (bits_[b >> 6] >> (b & 63)) & 1;
+    }
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept
+    {
+        std::size_t n = 0;
+        for(std::uint64_t w : bits_) n += static_cast<std::size_t>(std::popcount(w));
+        return n;
+    }
+
+    [[nodiscard]] constexpr bool empty() const noexcept { return size() == 0; }
+
+    constexpr byte_set& operator|=(const byte_set& other) noexcept
+    {
+        for(std::size_t i = 0; i < 16; ++i)
+        {
+            low_[i]  |= other.low_[i];
+            high_[i] |= other.high_[i];
+        }
+        for(std::size_t i = 0; i < 4; ++i) bits_[i] |= other.bits_[i];
+        return *this;
+    }
+
+    friend constexpr bool operator==(const byte_set& a, const byte_set& b) noexcept { return a.bits_ == b.bits_; }
+
+private:
+    friend struct detail::byte_set_tables;
+
+    alignas(16) std::array<std::uint8_t, 16> low_{ };
+    alignas(16) std::array<std::uint8_t, 16> high_{ };
+    std::array<std::uint64_t, 4>             bits_{ };
+};
+
+// Kernels =============================================================================================================
+//
+// Every operation below is implemented once per simd_level and reached through a string_kernels table, chosen on
+// first use from host_cpu(). Builds whose baseline already includes AVX2 or NEON use those tables directly and the
+// calls inline. Kernels work on (pointer, length) and return a length when nothing is found, so the public wrappers
+// only translate to npos. Tails shorter than a vector are copied into a zeroed stack buffer rather than read past the
+// end, and bits past the length are masked off.
+
+namespace detail
+{
+
+struct byte_set_tables
+{
+    static const std::uint8_t* low(const byte_set& s) noexcept  { return s.low_.data(); }
+    static const std::uint8_t* high(const byte_set& s) noexcept { return s.high_.data(); }
+    static bool contains(const byte_set& s, unsigned char b) noexcept { return (s.bits_[b >> 6] >> (b & 63)) & 1; }
+};
+
+struct string_kernels
+{
+    /// Index of the first byte in (or with negate, not in) the set, or n
+    std::size_t   (*find)(const char* p, std::size_t n, const byte_set& set, bool negate) noexcept;
+    /// Bit i set when p[i] is in the set, for n <= 64
+    std::uint64_t (*mask64)(const char* p, std::size_t n, const byte_set& set) noexcept;
+    /// Index of the first byte where a and b differ ignoring ASCII case, or n
+    std::size_t   (*imismatch)(const char* a, const char* b, std::size_t n) noexcept;
+    /// Whether p[0, n) is well-formed UTF-8: no overlong forms, surrogates or code points past U+10FFFF
+    bool          (*utf8)(const char* p, std::size_t n) noexcept;
+};
+
+[[nodiscard]] constexpr std::uint64_t low_bits_(std::size_t n) noexcept
+{
+    return n >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << n) - 1;
+}
+
+// UTF-8 lookup tables -------------------------------------------------------------------------------------------------
+//
+// Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte". Each error class is one bit; the high
+// nibble of the previous byte, its low nibble and the high nibble of the current byte each look up the classes they
+// allow, and a class survives the AND of all three only when the pair is that error. 3 and 4 byte sequences are then
+// checked by requiring a continuation exactly where the bytes two and three back are 3 and 4 byte leads.
+
+inline constexpr std::uint8_t utf8_too_short      = 1 << 0;
+inline constexpr std::uint8_t utf8_too_long       = 1 << 1;
+inline constexpr std::uint8_t utf8_overlong_3     = 1 << 2;
+inline constexpr std::uint8_t utf8_too_large      = 1 << 3;
+inline constexpr std::uint8_t utf8_surrogate      = 1 << 4;
+inline constexpr std::uint8_t utf8_overlong_2     = 1 << 5;
+inline constexpr std::uint8_t utf8_too_large_1000 = 1 << 6;
+inline constexpr std::uint8_t utf8_overlong_4     = 1 << 6;
+inline constexpr std::uint8_t utf8_two_conts      = 1 << 7;
+inline constexpr std::uint8_t utf8_carry          = utf8_too_short | utf8_too_long | utf8_two_conts;
+
+alignas(16) inline constexpr std::uint8_t utf8_byte_1_high[16] = {
+    utf8_too_long, utf8_too_long, utf8_too_long, utf8_too_long,
+    utf8_too_long, utf8_too_long, utf8_too_long, utf8_too_long,
+    utf8_two_conts, utf8_two_conts, utf8_two_conts, utf8_two_conts,
+    utf8_too_short | utf8_overlong_2,
+    utf8_too_short,
+    utf8_too_short | utf8_overlong_3 | utf8_surrogate,
+    utf8_too_short | utf8_too_large | utf8_too_large_1000 | utf8_overlong_4,
+};
+
+alignas(16) inline constexpr std::uint8_t utf8_byte_1_low[16] = {
+    utf8_carry | utf8_overlong_3 | utf8_overlong_2 | utf8_overlong_4,
+    utf8_carry | utf8_overlong_2,
+    utf8_carry,
+    utf8_carry,
+    utf8_carry | utf8_too_large,
+    utf8_carry | utf8_too_large | utf8_too_large_1000,
+    utf8_carry | utf8_too_large | utf8_too_large_1000,
+    utf8_carry | utf8_too_large | utf8_too_large_1000,
+    utf8_carry | utf8_too_large | utf8_too_large_1000,
+    utf8_carry | utf8_too_large | utf8_too_large_1000,
+    utf8_carry | utf8_too_large | utf8_too_large_1000,
+    utf8_carry | utf8_too_large | utf8_too_large_1000,
+    utf8_carry | utf8_too_large | utf8_too_large_1000,
+    utf8_carry | utf8_too_large | utf8_too_large_1000 | utf8_surrogate,
+    utf8_carry | utf8_too_large | utf8_too_large_1000,
+    utf8_carry | utf8_too_large | utf8_too_large_1000,
+};
+
+alignas(16) inline constexpr std::uint8_t utf8_byte_2_high[16] = {
+    utf8_too_short, utf8_too_short, utf8_too_short, utf8_too_short,
+    utf8_too_short, utf8_too_short, utf8_too_short, utf8_too_short,
+    utf8_too_long | utf8_overlong_2 | utf8_two_conts | utf8_overlong_3 | utf8_too_large_1000 | utf8_overlong_4,
+    utf8_too_long | utf8_overlong_2 | utf8_two_conts | utf8_overlong_3 | utf8_too_large,
+    utf8_too_long | utf8_overlong_2 | utf8_two_conts | utf8_surrogate  | utf8_too_large,
+    utf8_too_long | utf8_overlong_2 | utf8_two_conts | utf8_surrogate  | utf8_too_large,
+    utf8_too_short, utf8_too_short, utf8_too_short, utf8_too_short,
+};
+
+/// Largest value each of the last three bytes of input may have without starting a sequence that runs past the end;
+/// 32-byte aligned for the AVX2 kernel's aligned load
+alignas(32) inline constexpr std::uint8_t utf8_max_complete[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF,
+};
+
+/// Bit (h & 7) at entry h, turning a high nibble into the bit the byte_set nibble tables use for it
+alignas(16) inline constexpr std::uint8_t nibble_bits[16] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+};
+
+// Scalar --------------------------------------------------------------------------------------------------------------
+
+namespace scalar_kernels
+{
+
+/// Lowercases the ASCII letters of eight bytes at once; other bytes, including non-ASCII ones, are unchanged
+[[nodiscard]] constexpr std::uint64_t fold_word(std::uint64_t w) noexcept
+{
+    constexpr std::uint64_t ones = 0x0101010101010101ull;
+    const std::uint64_t heptets = w & (0x7F * ones);
+    const std::uint64_t ge_a    = heptets + (0x80 - 'A') * ones;
+    const std::uint64_t gt_z    = heptets + (0x80 - 'Z' - 1) * ones;
+    return w | (((ge_a & ~gt_z & ~w) & (0x80 * ones)) >> 2);
+}
+
+[[nodiscard]] constexpr unsigned char fold_byte(unsigned char c) noexcept
+{
+    return static_cast<unsigned char>(c | (static_cast<unsigned char>(c - 'A') < 26 ? 0x20 : 0));
+}
+
+inline std::size_t find(const char* p, std::size_t n, const byte_set& set, bool negate) noexcept
+{
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        if(byte_set_tables::contains(set, static_cast<unsigned char>(p[i])) != negate) return i;
+    }
+    return n;
+}
+
+inline std::uint64_t mask64(const char* p, std::size_t n, const byte_set& set) noexcept
+{
+    std::uint64_t m = 0;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        m |= static_cast<std::uint64_t>(byte_set_tables::contains(set, static_cast<unsigned char>(p[i]))) << i;
+    }
+    return m;
+}
+
+inline std::size_t imismatch(const char* a, const char* b, std::size_t n) noexcept
+{
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        const std::uint64_t x = fold_word(read_le<std::uint64_t>(a + i)) ^ fold_word(read_le<std::uint64_t>(b + i));
+        if(x) return i + static_cast<std::size_t>(std::countr_zero(x) >> 3);
+    }
+    for(; i < n; ++i)
+    {
+        if(fold_byte(static_cast<unsigned char>(a[i])) != fold_byte(static_cast<unsigned char>(b[i]))) return i;
+    }
+    return n;
+}
+
+inline bool utf8(const char* s, std::size_t n) noexcept
+{
+    const auto* p = reinterpret_cast<const unsigned char*>(s);
+    std::size_t i = 0;
+    while(i < n)
+    {
+        if(i + 8 <= n && (read_le<std::uint64_t>(s + i) & 0x8080808080808080ull) == 0)
+        {
+            i += 8;
+            continue;
+        }
+
+        const unsigned char c = p[i];
+        if(c < 0x80) { ++i; continue; }
+
+        // Length of the sequence, and the range its second byte must fall in
+        std::size_t   len;
+        unsigned char lo = 0x80, hi = 0xBF;
+        if     (c >= 0xC2 && c <= 0xDF) len = 2;
+        else if(c == 0xE0)              { len = 3; lo = 0xA0; }
+        else if(c == 0xED)              { len = 3; hi = 0x9F; }
+        else if(c >= 0xE1 && c <= 0xEF) len = 3;
+        else if(c == 0xF0)              { len = 4; lo = 0x90; }
+        else if(c == 0xF4)              { len = 4; hi = 0x8F; }
+        else if(c >= 0xF1 && c <= 0xF3) len = 4;
+        else                            return false;
+
+        if(n - i < len)                    return false;
+        if(p[i + 1] < lo || p[i + 1] > hi) return false;
+        for(std::size_t k = 2; k < len; ++k)
+        {
+            if((p[i + k] & 0xC0) != 0x80) return false;
+        }
+        i += len;
+    }
+    return true;
+}
+
+}
+
+inline constexpr string_kernels scalar_string_kernels{
+    &scalar_kernels::find, &scalar_kernels::mask64, &scalar_kernels::imismatch, &scalar_kernels::utf8
+};
+
+#if defined(OCU_ARCH_X86)
+
+// SSE4.2 --------------------------------------------------------------------------------------------------------------
+
+namespace sse42_kernels
+{
+
+/// 0xFF in every byte of v that is in the set
+OCU_TARGET_SSE42 inline __m128i classify(__m128i v, __m128i low, __m128i high, __m128i bits) noexcept
+{
+    const __m128i m8f = _mm_set1_epi8(static_cast<char>(0x8F));
+    const __m128i a   = _mm_shuffle_epi8(low, _mm_and_si128(v, m8f));
+    const __m128i top = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m128i b   = _mm_shuffle_epi8(high, _mm_and_si128(_mm_xor_si128(v, top), m8f));
+    const __m128i bit = _mm_shuffle_epi8(bits, _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F)));
+    const __m128i hit = _mm_and_si128(_mm_or_si128(a, b), bit);
+    return _mm_xor_si128(_mm_cmpeq_epi8(hit, _mm_setzero_si128()), _mm_set1_epi8(-1));
+}
+
+OCU_TARGET_SSE42 inline std::uint64_t block64(const char* p, __m128i low, __m128i high, __m128i bits) noexcept
+{
+    std::uint64_t m = 0;
+    for(int k = 0; k < 4; ++k)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + k);
+        m |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm_movemask_epi8(classify(v, low, high, bits))))
+          << (16 * k);
+    }
+    return m;
+}
+
+OCU_TARGET_SSE42 inline std::size_t find(const char* p, std::size_t n, const byte_set& set, bool negate) noexcept
+{
+    const __m128i       low  = _mm_load_si128(reinterpret_cast<const __m128i*>(byte_set_tables::low(set)));
+    const __m128i       high = _mm_load_si128(reinterpret_cast<const __m128i*>(byte_set_tables::high(set)));
+    const __m128i       bits = _mm_load_si128(reinterpret_cast<const __m128i*>(nibble_bits));
+    const std::uint64_t flip = negate ? ~std::uint64_t(0) : 0;
+
+    std::size_t i = 0;
+    for(; i + 64 <= n; i += 64)
+    {
+        if(const std::uint64_t m = block64(p + i, low, high, bits) ^ flip) return i + std::countr_zero(m);
+    }
+    for(; i + 16 <= n; i += 16)
+    {
+        const __m128i       v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const std::uint32_t m = static_cast<std::uint32_t>(_mm_movemask_epi8(classify(v, low, high, bits)))
+                              ^ static_cast<std::uint32_t>(flip & 0xFFFF);
+        if(m) return i + std::countr_zero(m);
+    }
+    if(i < n)
+    {
+        alignas(16) char buf[16] = { };
+        std::memcpy(buf, p + i, n - i);
+        const __m128i       v = _mm_load_si128(reinterpret_cast<const __m128i*>(buf));
+        const std::uint32_t m = (static_cast<std::uint32_t>(_mm_movemask_epi8(classify(v, low, high, bits)))
+                              ^ static_cast<std::uint32_t>(flip & 0xFFFF)) & ((1u << (n - i)) - 1);
+        if(m) return i + std::countr_zero(m);
+    }
+    return n;
+}
+
+OCU_TARGET_SSE42 inline std::uint64_t mask64(const char* p, std::size_t n, const byte_set& set) noexcept
+{
+    const __m128i low  = _mm_load_si128(reinterpret_cast<const __m128i*>(byte_set_tables::low(set)));
+    const __m128i high = _mm_load_si128(reinterpret_cast<const __m128i*>(byte_set_tables::high(set)));
+    const __m128i bits = _mm_load_si128(reinterpret_cast<const __m128i*>(nibble_bits));
+    if(n >= 64) return block64(p, low, high, bits);
+
+    alignas(16) char buf[64] = { };
+    std::memcpy(buf, p, n);
+    return block64(buf, low, high, bits) & low_bits_(n);
+}
+
+OCU_TARGET_SSE42 inline __m128i fold(__m128i v) noexcept
+{
+    const __m128i t     = _mm_sub_epi8(v, _mm_set1_epi8('A'));
+    const __m128i upper = _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(25)), t);
+    return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+OCU_TARGET_SSE42 inline std::size_t imismatch(const char* a, const char* b, std::size_t n) noexcept
+{
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16)
+    {
+        const __m128i va = fold(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        const __m128i vb = fold(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        const auto    m  = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) ^ 0xFFFFu;
+        if(m) return i + std::countr_zero(m);
+    }
+    return i + scalar_kernels::imismatch(a + i, b + i, n - i);
+}
+
+struct utf8_state
+{
+    __m128i prev;
+    __m128i error;
+    __m128i incomplete;
+};
+
+OCU_TARGET_SSE42 inline void utf8_step(utf8_state& s, __m128i in) noexcept
+{
+    const __m128i nib   = _mm_set1_epi8(0x0F);
+    const __m128i prev1 = _mm_alignr_epi8(in, s.prev, 15);
+    const __m128i b1h   = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(utf8_byte_1_high)),
+                                           _mm_and_si128(_mm_srli_epi16(prev1, 4), nib));
+    const __m128i b1l   = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(utf8_byte_1_low)),
+                                           _mm_and_si128(prev1, nib));
+    const __m128i b2h   = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(utf8_byte_2_high)),
+                                           _mm_and_si128(_mm_srli_epi16(in, 4), nib));
+    const __m128i sc    = _mm_and_si128(_mm_and_si128(b1h, b1l), b2h);
+
+    const __m128i third  = _mm_subs_epu8(_mm_alignr_epi8(in, s.prev, 14), _mm_set1_epi8(0xE0 - 0x80));
+    const __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(in, s.prev, 13), _mm_set1_epi8(0xF0 - 0x80));
+    const __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+
+    s.error      = _mm_or_si128(s.error, _mm_xor_si128(must23, sc));
+    s.incomplete = _mm_subs_epu8(in, _mm_load_si128(reinterpret_cast<const __m128i*>(utf8_max_complete + 16)));
+    s.prev       = in;
+}
+
+OCU_TARGET_SSE42 inline void utf8_block(utf8_state& s, const char* p) noexcept
+{
+    const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + 1);
+    const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + 2);
+    const __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + 3);
+    if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(v0, v1), _mm_or_si128(v2, v3))) == 0)
+    {
+        s.error      = _mm_or_si128(s.error, s.incomplete);
+        s.incomplete = _mm_setzero_si128();
+        s.prev       = v3;
+        return;
+    }
+    utf8_step(s, v0);
+    utf8_step(s, v1);
+    utf8_step(s, v2);
+    utf8_step(s, v3);
+}
+
+OCU_TARGET_SSE42 inline bool utf8(const char* p, std::size_t n) noexcept
+{
+    utf8_state  s{ _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+    std::size_t i = 0;
+    for(; i + 64 <= n; i += 64) utf8_block(s, p + i);
+    if(i < n)
+    {
+        alignas(16) char buf[64] = { };
+        std::memcpy(buf, p + i, n - i);
+        utf8_block(s, buf);
+    }
+    return _mm_testz_si128(_mm_or_si128(s.error, s.incomplete), _mm_set1_epi8(-1));
+}
+
+}
+
+inline constexpr string_kernels sse42_string_kernels{
+    &sse42_kernels::find, &sse42_kernels::mask64, &sse42_kernels::imismatch, &sse42_kernels::utf8
+};
+
+// AVX2 ----------------------------------------------------------------------------------------------------------------
+
+namespace avx2_kernels
+{
+
+OCU_TARGET_AVX2 inline __m256i broadcast(const std::uint8_t* table) noexcept
+{
+    return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+OCU_TARGET_AVX2 inline __m256i classify(__m256i v, __m256i low, __m256i high, __m256i bits) noexcept
+{
+    const __m256i m8f = _mm256_set1_epi8(static_cast<char>(0x8F));
+    const __m256i a   = _mm256_shuffle_epi8(low, _mm256_and_si256(v, m8f));
+    const __m256i top = _mm256_set1_epi8(static_cast<char>(0x80));
+    const __m256i b   = _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_xor_si256(v, top), m8f));
+    const __m256i bit = _mm256_shuffle_epi8(bits, _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F)));
+    const __m256i hit = _mm256_and_si256(_mm256_or_si256(a, b), bit);
+    return _mm256_xor_si256(_mm256_cmpeq_epi8(hit, _mm256_setzero_si256()), _mm256_set1_epi8(-1));
+}
+
+OCU_TARGET_AVX2 inline std::uint64_t block64(const char* p, __m256i low, __m256i high, __m256i bits) noexcept
+{
+    const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p) + 1);
+    const auto    m0 = static_cast<std::uint32_t>(_mm256_movemask_epi8(classify(v0, low, high, bits)));
+    const auto    m1 = static_cast<std::uint32_t>(_mm256_movemask_epi8(classify(v1, low, high, bits)));
+    return (static_cast<std::uint64_t>(m1) << 32) | m0;
+}
+
+OCU_TARGET_AVX2 inline std::size_t find(const char* p, std::size_t n, const byte_set& set, bool negate) noexcept
+{
+    const __m256i       low  = broadcast(byte_set_tables::low(set));
+    const __m256i       high = broadcast(byte_set_tables::high(set));
+    const __m256i       bits = broadcast(nibble_bits);
+    const std::uint64_t flip = negate ? ~std::uint64_t(0) : 0;
+
+    std::size_t i = 0;
+    for(; i + 64 <= n; i += 64)
+    {
+        if(const std::uint64_t m = block64(p + i, low, high, bits) ^ flip) return i + std::countr_zero(m);
+    }
+    if(i < n)
+    {
+        alignas(32) char buf[64] = { };
+        std::memcpy(buf, p + i, n - i);
+        if(const std::uint64_t m = (block64(buf, low, high, bits) ^ flip) & low_bits_(n - i))
+        {
+            return i + std::countr_zero(m);
+        }
+    }
+    return n;
+}
+
+OCU_TARGET_AVX2 inline std::uint64_t mask64(const char* p, std::size_t n, const byte_set& set) noexcept
+{
+    const __m256i low  = broadcast(byte_set_tables::low(set));
+    const __m256i high = broadcast(byte_set_tables::high(set));
+    const __m256i bits = broadcast(nibble_bits);
+    if(n >= 64) return block64(p, low, high, bits);
+
+    alignas(32) char buf[64] = { };
+    std::memcpy(buf, p, n);
+    return block64(buf, low, high, bits) & low_bits_(n);
+}
+
+OCU_TARGET_AVX2 inline __m256i fold(__m256i v) noexcept
+{
+    const __m256i t     = _mm256_sub_epi8(v, _mm256_set1_epi8('A'));
+    const __m256i upper = _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(25)), t);
+    return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+OCU_TARGET_AVX2 inline std::size_t imismatch(const char* a, const char* b, std::size_t n) noexcept
+{
+    std::size_t i = 0;
+    for(; i + 32 <= n; i += 32)
+    {
+        const __m256i va = fold(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+        const __m256i vb = fold(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        const auto    m  = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+        if(m) return i + std::countr_zero(m);
+    }
+    return i + scalar_kernels::imismatch(a + i, b + i, n - i);
+}
+
+struct utf8_state
+{
+    __m256i prev;
+    __m256i error;
+    __m256i incomplete;
+};
+
+OCU_TARGET_AVX2 inline void utf8_step(utf8_state& s, __m256i in) noexcept
+{
+    // alignr works within 128-bit lanes, so the bytes before each lane come from a lane-crossing permute first
+    const __m256i nib    = _mm256_set1_epi8(0x0F);
+    const __m256i before = _mm256_permute2x128_si256(s.prev, in, 0x21);
+    const __m256i prev1  = _mm256_alignr_epi8(in, before, 15);
+    const __m256i b1h    = _mm256_shuffle_epi8(broadcast(utf8_byte_1_high),
+                                               _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nib));
+    const __m256i b1l    = _mm256_shuffle_epi8(broadcast(utf8_byte_1_low), _mm256_and_si256(prev1, nib));
+    const __m256i b2h    = _mm256_shuffle_epi8(broadcast(utf8_byte_2_high),
+                                               _mm256_and_si256(_mm256_srli_epi16(in, 4), nib));
+    const __m256i sc     = _mm256_and_si256(_mm256_and_si256(b1h, b1l), b2h);
+
+    const __m256i third  = _mm256_subs_epu8(_mm256_alignr_epi8(in, before, 14), _mm256_set1_epi8(0xE0 - 0x80));
+    const __m256i fourth = _mm256_subs_epu8(_mm256_alignr_epi8(in, before, 13), _mm256_set1_epi8(0xF0 - 0x80));
+    const __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                            _mm256_set1_epi8(static_cast<char>(0x80)));
+
+    s.error      = _mm256_or_si256(s.error, _mm256_xor_si256(must23, sc));
+    s.incomplete = _mm256_subs_epu8(in, _mm256_load_si256(reinterpret_cast<const __m256i*>(utf8_max_complete)));
+    s.prev       = in;
+}
+
+OCU_TARGET_AVX2 inline void utf8_block(utf8_state& s, const char* p) noexcept
+{
+    const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p) + 1);
+    if(_mm256_movemask_epi8(_mm256_or_si256(v0, v1)) == 0)
+    {
+        s.error      = _mm256_or_si256(s.error, s.incomplete);
+        s.incomplete = _mm256_setzero_si256();
+        s.prev       = v1;
+        return;
+    }
+    utf8_step(s, v0);
+    utf8_step(s, v1);
+}
+
+OCU_TARGET_AVX2 inline bool utf8(const char* p, std::size_t n) noexcept
+{
+    utf8_state  s{ _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256() };
+    std::size_t i = 0;
+    for(; i + 64 <= n; i += 64) utf8_block(s, p + i);
+    if(i < n)
+    {
+        alignas(32) char buf[64] = { };
+        std::memcpy(buf, p + i, n - i);
+        utf8_block(s, buf);
+    }
+    const __m256i e = _mm256_or_si256(s.error, s.incomplete);
+    return _mm256_testz_si256(e, e);
+}
+
+}
+
+inline constexpr string_kernels avx2_string_kernels{
+    &avx2_kernels::find, &avx2_kernels::mask64, &avx2_kernels::imismatch, &avx2_kernels::utf8
+};
+
+#endif
+
+#if defined(OCU_STRING_UTILS_NEON)
+
+// NEON ----------------------------------------------------------------------------------------------------------------
+
+namespace neon_kernels
+{
+
+/// 0xFF in every byte of v that is in the set
+OCU_FORCEINLINE uint8x16_t classify(uint8x16_t v, uint8x16_t low, uint8x16_t high, uint8x16_t bits) noexcept
+{
+    // vqtbl1q yields 0 for indices of 16 and up, so masking with 0x8F selects the table by the top bit of the byte
+    const uint8x16_t m8f = vdupq_n_u8(0x8F);
+    const uint8x16_t a   = vqtbl1q_u8(low, vandq_u8(v, m8f));
+    const uint8x16_t b   = vqtbl1q_u8(high, vandq_u8(veorq_u8(v, vdupq_n_u8(0x80)), m8f));
+    const uint8x16_t bit = vqtbl1q_u8(bits, vshrq_n_u8(v, 4));
+    return vtstq_u8(vorrq_u8(a, b), bit);
+}
+
+/// One bit per byte of 64 bytes of 0x00/0xFF lanes
+OCU_FORCEINLINE std::uint64_t to_bits(uint8x16_t m0, uint8x16_t m1, uint8x16_t m2, uint8x16_t m3) noexcept
+{
+    const uint8x16_t weights = vld1q_u8(nibble_bits);
+    uint8x16_t       sum0    = vpaddq_u8(vandq_u8(m0, weights), vandq_u8(m1, weights));
+    uint8x16_t       sum1    = vpaddq_u8(vandq_u8(m2, weights), vandq_u8(m3, weights));
+    sum0 = vpaddq_u8(sum0, sum1);
+    sum0 = vpaddq_u8(sum0, sum0);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+OCU_FORCEINLINE std::uint64_t block64(const char* p, uint8x16_t low, uint8x16_t high, uint8x16_t bits) noexcept
+{
+    const auto* u = reinterpret_cast<const std::uint8_t*>(p);
+    return to_bits(classify(vld1q_u8(u), low, high, bits),      classify(vld1q_u8(u + 16), low, high, bits),
+                   classify(vld1q_u8(u + 32), low, high, bits), classify(vld1q_u8(u + 48), low, high, bits));
+}
+
+inline std::size_t find(const char* p, std::size_t n, const byte_set& set, bool negate) noexcept
+{
+    const uint8x16_t    low  = vld1q_u8(byte_set_tables::low(set));
+    const uint8x16_t    high = vld1q_u8(byte_set_tables::high(set));
+    const uint8x16_t    bits = vld1q_u8(nibble_bits);
+    const std::uint64_t flip = negate ? ~std::uint64_t(0) : 0;
+
+    std::size_t i = 0;
+    for(; i + 64 <= n; i += 64)
+    {
+        if(const std::uint64_t m = block64(p + i, low, high, bits) ^ flip) return i + std::countr_zero(m);
+    }
+    if(i < n)
+    {
+        alignas(16) char buf[64] = { };
+        std::memcpy(buf, p + i, n - i);
+        if(const std::uint64_t m = (block64(buf, low, high, bits) ^ flip) & low_bits_(n - i))
+        {
+            return i + std::countr_zero(m);
+        }
+    }
+    return n;
+}
+
+inline std::uint64_t mask64(const char* p, std::size_t n, const byte_set& set) noexcept
+{
+    const uint8x16_t low  = vld1q_u8(byte_set_tables::low(set));
+    const uint8x16_t high = vld1q_u8(byte_set_tables::high(set));
+    const uint8x16_t bits = vld1q_u8(nibble_bits);
+    if(n >= 64) return block64(p, low, high, bits);
+
+    alignas(16) char buf[64] = { };
+    std::memcpy(buf, p, n);
+    return block64(buf, low, high, bits) & low_bits_(n);
+}
+
+OCU_FORCEINLINE uint8x16_t fold(uint8x16_t v) noexcept
+{
+    const uint8x16_t upper = vcltq_u8(vsubq_u8(v, vdupq_n_u8('A')), vdupq_n_u8(26));
+    return vorrq_u8(v, vandq_u8(upper, vdupq_n_u8(0x20)));
+}
+
+inline std::size_t imismatch(const char* a, const char* b, std::size_t n) noexcept
+{
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16)
+    {
+        const uint8x16_t eq = vceqq_u8(fold(vld1q_u8(reinterpret_cast<const std::uint8_t*>(a + i))),
+                                       fold(vld1q_u8(reinterpret_cast<const std::uint8_t*>(b + i))));
+        if(vminvq_u8(eq) != 0xFF)
+        {
+            // Narrowing shift leaves one nibble per byte, the same trick as hash_table's group
+            const uint8x8_t     nibbles = vshrn_n_u16(vreinterpretq_u16_u8(vmvnq_u8(eq)), 4);
+            const std::uint64_t m       = vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+            return i + static_cast<std::size_t>(std::countr_zero(m) >> 2);
+        }
+    }
+    return i + scalar_kernels::imismatch(a + i, b + i, n - i);
+}
+
+struct utf8_state
+{
+    uint8x16_t prev;
+    uint8x16_t error;
+    uint8x16_t incomplete;
+};
+
+OCU_FORCEINLINE void utf8_step(utf8_state& s, uint8x16_t in) noexcept
+{
+    const uint8x16_t prev1 = vextq_u8(s.prev, in, 15);
+    const uint8x16_t b1h   = vqtbl1q_u8(vld1q_u8(utf8_byte_1_high), vshrq_n_u8(prev1, 4));
+    const uint8x16_t b1l   = vqtbl1q_u8(vld1q_u8(utf8_byte_1_low), vandq_u8(prev1, vdupq_n_u8(0x0F)));
+    const uint8x16_t b2h   = vqtbl1q_u8(vld1q_u8(utf8_byte_2_high), vshrq_n_u8(in, 4));
+    const uint8x16_t sc    = vandq_u8(vandq_u8(b1h, b1l), b2h);
+
+    const uint8x16_t third  = vqsubq_u8(vextq_u8(s.prev, in, 14), vdupq_n_u8(0xE0 - 0x80));
+    const uint8x16_t fourth = vqsubq_u8(vextq_u8(s.prev, in, 13), vdupq_n_u8(0xF0 - 0x80));
+    const uint8x16_t must23 = vandq_u8(vorrq_u8(third, fourth), vdupq_n_u8(0x80));
+
+    s.error      = vorrq_u8(s.error, veorq_u8(must23, sc));
+    s.incomplete = vqsubq_u8(in, vld1q_u8(utf8_max_complete + 16));
+    s.prev       = in;
+}
+
+inline void utf8_block(utf8_state& s, const char* p) noexcept
+{
+    const auto*      u  = reinterpret_cast<const std::uint8_t*>(p);
+    const uint8x16_t v0 = vld1q_u8(u), v1 = vld1q_u8(u + 16), v2 = vld1q_u8(u + 32), v3 = vld1q_u8(u + 48);
+    if(vmaxvq_u8(vorrq_u8(vorrq_u8(v0, v1), vorrq_u8(v2, v3))) < 0x80)
+    {
+        s.error      = vorrq_u8(s.error, s.incomplete);
+        s.incomplete = vdupq_n_u8(0);
+        s.prev       = v3;
+        return;
+    }
+    utf8_step(s, v0);
+    utf8_step(s, v1);
+    utf8_step(s, v2);
+    utf8_step(s, v3);
+}
+
+inline bool utf8(const char* p, std::size_t n) noexcept
+{
+    utf8_state  s{ vdupq_n_u8(0), vdupq_n_u8(0), vdupq_n_u8(0) };
+    std::size_t i = 0;
+    for(; i + 64 <= n; i += 64) utf8_block(s, p + i);
+    if(i < n)
+    {
+        alignas(16) char buf[64] = { };
+        std::memcpy(buf, p + i, n - i);
+        utf8_block(s, buf);
+    }
+    return vmaxvq_u8(vorrq_u8(s.error, s.incomplete)) == 0;
+}
+
+}
+
+inline constexpr string_kernels neon_string_kernels{
+    &neon_kernels::find, &neon_kernels::mask64, &neon_kernels::imismatch, &neon_kernels::utf8
+};
+
+#endif
+
+/**
+ * \brief Kernel table for a level, or the scalar one when this build has no kernels for it. Calling the result on a
+ *        host without the level's instructions faults; use host_simd_level() unless comparing levels.
+ */
+[[nodiscard]] inline const string_kernels& string_kernels_for(simd_level level) noexcept
+{
+    switch(level)
+    {
+#if defined(OCU_ARCH_X86)
+    case simd_level::avx2:  return avx2_string_kernels;
+    case simd_level::sse42: return sse42_string_kernels;
+#endif
+#if defined(OCU_STRING_UTILS_NEON)
+    case simd_level::neon:  return neon_string_kernels;
+#endif
+    default:                return scalar_string_kernels;
+    }
+}
+
+/// The table for this host, resolved once unless the baseline instruction set already decides it
+[[nodiscard]] inline const string_kernels& active_string_kernels() noexcept
+{
+#if defined(OCU_HAS_AVX2)
+    return avx2_string_kernels;
+#elif defined(OCU_STRING_UTILS_NEON)
+    return neon_string_kernels;
+#else
+    static const string_kernels& kernels = string_kernels_for(host_simd_level());
+    return kernels;
+#endif
+}
+
+}
+
+// Searching ===========================================================================================================
+
+/**
+ * \brief Position of the first byte of s at or after pos that is in set, or npos. A drop-in for
+ *        std::string_view::find_first_of, which tests every byte against every delimiter.
+ */
+[[nodiscard]] inline std::size_t find_first_of(std::string_view s, const byte_set& set, std::size_t pos = 0) noexcept
+{
+    if(pos >= s.size()) return std::string_view::npos;
+    const std::size_t i = pos + detail::active_string_kernels().find(s.data() + pos, s.size() - pos, set, false);
+    return i == s.size() ? std::string_view::npos : i;
+}
+
+/**
+ * \brief Position of the first byte of s at or after pos that is not in set, or npos
+ */
+[[nodiscard]] inline std::size_t find_first_not_of(std::string_view s, const byte_set& set,
+                                                   std::size_t pos = 0) noexcept
+{
+    if(pos >= s.size()) return std::string_view::npos;
+    const std::size_t i = pos + detail::active_string_kernels().find(s.data() + pos, s.size() - pos, set, true);
+    return i == s.size() ? std::string_view::npos : i;
+}
+
+// Case-insensitive Comparison =========================================================================================
+
+/**
+ * \brief Lowercase of an ASCII letter; every other byte is returned unchanged
+ */
+[[nodiscard]] constexpr char ascii_to_lower(char c) noexcept
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+/**
+ * \brief Uppercase of an ASCII letter; every other byte is returned unchanged
+ */
+[[nodiscard]] constexpr char ascii_to_upper(char c) noexcept
+{
+    return c >= 'a' && c <= 'z' ? static_cast<char>(c - ('a' - 'A')) : c;
+}
+
+/**
+ * \brief Whether a and b are equal ignoring ASCII case. Bytes outside A-Z and a-z must match exactly.
+ */
+[[nodiscard]] inline bool iequals(std::string_view a, std::string_view b) noexcept
+{
+    if(a.size() != b.size()) return false;
+    if(a.size() < 16)        return detail::scalar_kernels::imismatch(a.data(), b.data(), a.size()) == a.size();
+    return detail::active_string_kernels().imismatch(a.data(), b.data(), a.size()) == a.size();
+}
+
+/**
+ * \brief Three-way comparison ignoring ASCII case, ordering as if both sides were lowercased. Equivalent strings
+ *        need not be equal, hence weak_ordering.
+ */
+[[nodiscard]] inline std::weak_ordering icompare(std::string_view a, std::string_view b) noexcept
+{
+    const std::size_t n = a.size() < b.size() ? a.size() : b.size();
+    const std::size_t i = n < 16 ? detail::scalar_kernels::imismatch(a.data(), b.data(), n)
+                                 : detail::active_string_kernels().imismatch(a.data(), b.data(), n);
+    if(i == n) return a.size() <=> b.size();
+    return static_cast<unsigned char>(ascii_to_lower(a[i])) <=> static_cast<unsigned char>(ascii_to_lower(b[i]));
+}
+
+/**
+ * \brief Hash that agrees with iequals: the bytes are lowercased eight at a time into a stack buffer and fed to the
+ *        same byte hash as hash<std::string_view>. Not stable across releases, like hash<T>.
+ */
+[[nodiscard]] inline std::uint64_t ihash(std::string_view s, std::uint64_t seed = 0) noexcept
+{
+    constexpr std::size_t chunk = 256;
+    alignas(8) char       buf[chunk];
+
+    const char* p = s.data();
+    std::size_t n = s.size();
+    do
+    {
+        const std::size_t len = n < chunk ? n : chunk;
+        std::size_t       i   = 0;
+        for(; i + 8 <= len; i += 8)
+        {
+            std::uint64_t w;
+            std::memcpy(&w, p + i, 8);
+            w = detail::scalar_kernels::fold_word(w);
+            std::memcpy(buf + i, &w, 8);
+        }
+        for(; i < len; ++i) buf[i] = ascii_to_lower(p[i]);
+
+        seed = detail::hash_bytes(buf, len, seed);
+        p   += len;
+        n   -= len;
+    } while(n > 0);
+    return seed;
+}
+
+/**
+ * \brief Transparent case-insensitive equality, for hash_map<std::string, V, ihasher, iequal_to>
+ */
+struct iequal_to
+{
+    using is_transparent = void;
+
+    [[nodiscard]] bool operator()(std::string_view a, std::string_view b) const noexcept { return iequals(a, b); }
+};
+
+/**
+ * \brief Transparent case-insensitive ordering, for flat_map<std::string, V, iless>
+ */
+struct iless
+{
+    using is_transparent = void;
+
+    [[nodiscard]] bool operator()(std::string_view a, std::string_view b) const noexcept { return icompare(a, b) < 0; }
+};
+
+/**
+ * \brief Transparent hasher paired with iequal_to
+ */
+struct ihasher
+{
+    using is_avalanching = void;
+    using is_transparent = void;
+
+    [[nodiscard]] std::size_t operator()(std::string_view s) const noexcept
+    {
+        return static_cast<std::size_t>(ihash(s));
+    }
+};
+
+// UTF-8 Validation ====================================================================================================
+
+/**
+ * \brief Whether s is well-formed UTF-8, rejecting overlong encodings, surrogates, code points past U+10FFFF and
+ *        truncated sequences. Runs of ASCII are skipped 64 bytes at a time.
+ */
+[[nodiscard]] inline bool is_valid_utf8(std::string_view s) noexcept
+{
+    return detail::active_string_kernels().utf8(s.data(), s.size());
+}
+
+// split_view ==========================================================================================================
+
+/**
+ * \brief Whether split reports the empty fields between adjacent delimiters
+ */
+enum class split_mode : std::uint8_t
+{
+    keep_empty,     ///< "a,,b" gives "a", "", "b" and "" gives one empty field, like a CSV reader
+    skip_empty,     ///< "  a  b " split on spaces gives "a", "b", like a whitespace tokenizer
+};
+
+/**
+ * \brief Forward range of the fields of a string separated by any byte of a byte_set. Fields are string_views into
+ *        the original string; nothing is allocated.
+ *
+ * Delimiters are located 64 bytes at a time: the iterator keeps a bitmask of the delimiter positions in the current
+ * block and takes the next field boundary from its lowest set bit, so short fields cost a count-trailing-zeros rather
+ * than a new search each. Iterators point into the view, which must outlive them.
+ */
+class split_view : public std::ranges::view_interface<split_view>
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_concept  = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::string_view;
+        using difference_type   = std::ptrdiff_t;
+
+        iterator() noexcept = default;
+
+        [[nodiscard]] std::string_view operator*() const noexcept
+        {
+            return view_->str_.substr(begin_, end_ - begin_);
+        }
+
+        iterator& operator++() noexcept
+        {
+            do advance_(); while(!done_ && end_ == begin_ && view_->mode_ == split_mode::skip_empty);
+            return *this;
+        }
+
+        iterator operator++(int) noexcept
+        {
+            iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        friend bool operator==(const iterator& a, const iterator& b) noexcept
+        {
+            return a.done_ == b.done_ && (a.done_ || a.begin_ == b.begin_);
+        }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept { return it.done_; }
+
+    private:
+        friend class split_view;
+
+        explicit iterator(const split_view* view) noexcept
+            : view_(view)
+            , mask_(view->kernels_->mask64(view->str_.data(), view->str_.size() < 64 ? view->str_.size() : 64,
+                                           view->delims_))
+        {
+            next_delimiter_();
+            while(end_ == begin_ && view_->mode_ == split_mode::skip_empty && !done_) advance_();
+        }
+
+        void next_delimiter_() noexcept
+        {
+            const std::size_t size = view_->str_.size();
+            while(mask_ == 0)
+            {
+                block_ += 64;
+                if(block_ >= size)
+                {
+                    end_ = size;
+                    return;
+                }
+                const std::size_t len = size - block_ < 64 ? size - block_ : 64;
+                mask_ = view_->kernels_->mask64(view_->str_.data() + block_, len, view_->delims_);
+            }
+            end_   = block_ + static_cast<std::size_t>(std::countr_zero(mask_));
+            mask_ &= mask_ - 1;
+        }
+
+        void advance_() noexcept
+        {
+            if(end_ == view_->str_.size())
+            {
+                done_ = true;
+                return;
+            }
+            begin_ = end_ + 1;
+            next_delimiter_();
+        }
+
+        const split_view* view_  = nullptr;
+        std::size_t       begin_ = 0;
+        std::size_t       end_   = 0;
+        std::size_t       block_ = 0;
+        std::uint64_t     mask_  = 0;
+        bool              done_  = false;
+    };
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    split_view() noexcept = default;
+
+    split_view(std::string_view str, const byte_set& delims, split_mode mode = split_mode::keep_empty) noexcept
+        : str_(str)
+        , delims_(delims)
+        , mode_(mode)
+        , kernels_(&detail::active_string_kernels())
+    { }
+
+    [[nodiscard]] iterator               begin() const noexcept { return iterator(this); }
+    [[nodiscard]] std::default_sentinel_t end() const noexcept   { return std::default_sentinel; }
+
+    [[nodiscard]] std::string_view base() const noexcept { return str_; }
+
+private:
+    std::string_view              str_;
+    byte_set                      delims_;
+    split_mode                    mode_    = split_mode::keep_empty;
+    const detail::string_kernels* kernels_ = &detail::scalar_string_kernels;
+};
+
+/**
+ * \brief Fields of str separated by any byte of delims, e.g. split(line, byte_set(",;\t"))
+ */
+[[nodiscard]] inline split_view split(std::string_view str, const byte_set& delims,
+                                      split_mode mode = split_mode::keep_empty) noexcept
+{
+    return split_view(str, delims, mode);
+}
+
+/**
+ * \brief Fields of str separated by any character of delims
+ */
+[[nodiscard]] inline split_view split(std::string_view str, std::string_view delims,
+                                      split_mode mode = split_mode::keep_empty) noexcept
+{
+    return split_view(str, byte_set(delims), mode);
+}
+
+}
+
+#endif // OPEN_CPP_UTILS_STRING_UTILS_H
@@ -0,0 +1,156 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_TEMPLATE_UTILS_H
+#define OPEN_CPP_UTILS_TEMPLATE_UTILS_H
+
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace open_cpp_utils
+{
+
+// Relocation ==========================================================================================================
+
+/**
+ * \brief True if moving a T to a new address and ending the old object's lifetime is equivalent to copying its bytes.
+ *
+ * Containers use this to grow and erase with memcpy/memmove instead of a move constructor plus destructor per
+ * element. Every trivially copyable type qualifies. Types such as std::unique_ptr that own resources but never point
+ * into themselves can opt in with a specialization:
+ * \code
+ * template<> struct open_cpp_utils::is_trivially_relocatable<my_handle> : std::true_type { };
+ * \endcode
+ * Types that store pointers into themselves (for example libstdc++'s std::string) must not.
+ */
+template<typename T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> { };
+
+template<typename T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type { };
+
+template<typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type { };
+
+template<typename T>
+struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type { };
+
+template<typename T>
+struct is_trivially_relocatable<std::allocator<T>> : std::true_type { };
+
+template<typename T>
+struct is_trivially_relocatable<const T> : is_trivially_relocatable<T> { };
+
+template<typename A, typename B>
+struct is_trivially_relocatable<std::pair<A, B>>
+    : std::bool_constant<is_trivially_relocatable<A>::value && is_trivially_relocatable<B>::value> { };
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Type Identity =======================================================================================================
+
+namespace detail
+{
+
+template<typename T>
+constexpr std::string_view raw_type_name() noexcept
+{
+#if defined(__clang__) || defined(__GNUC__)
+    return __PRETTY_FUNCTION__;
+#elif defined(_MSC_VER)
+    return __FUNCSIG__;
+#else
+    return { };
+#endif
+}
+
+/// Length of the text around T in raw_type_name<T>(), measured on a known type
+struct type_name_format
+{
+    static constexpr std::string_view probe  = raw_type_name<int>();
+    static constexpr std::size_t      prefix = probe.find("int");
+    static constexpr std::size_t      suffix = probe.size() - prefix - 3;
+};
+
+template<typename T>
+struct type_id_record
+{
+    static constexpr std::string_view name = []
+    {
+        constexpr std::string_view raw    = raw_type_name<T>();
+        constexpr std::size_t      prefix = type_name_format::prefix;
+        if constexpr(prefix == std::string_view::npos) return std::string_view{ };
+        else return raw.substr(prefix, raw.size() - prefix - type_name_format::suffix);
+    }();
+};
+
+}
+
+/**
+ * \brief Human-readable name of T as spelled by the compiler, available at compile time and without RTTI. Meant
+ *        for diagnostics; the exact spelling differs between compilers.
+ */
+template<typename T>
+constexpr std::string_view type_name() noexcept
+{
+    return detail::type_id_record<T>::name;
+}
+
+/**
+ * \brief Compile-time type identity that works with RTTI disabled.
+ *
+ * A type_id is the address of a static object instantiated once per type, so comparing two of them is a single
+ * pointer compare and of<T>() is a constant expression. cv and reference qualifiers are ignored. The addresses are
+ * unique within one program image; on Windows, types crossing a DLL boundary get a different id on each side.
+ */
+class type_id
+{
+public:
+    constexpr type_id() noexcept = default;
+
+    template<typename T>
+    static constexpr type_id of() noexcept
+    {
+        return type_id(&detail::type_id_record<std::remove_cvref_t<T>>::name);
+    }
+
+    /// Spelling of the type; empty for a default constructed type_id
+    [[nodiscard]] constexpr std::string_view name() const noexcept { return record_ ? *record_ : std::string_view{ }; }
+
+    [[nodiscard]] const void* address() const noexcept { return record_; }
+
+    constexpr explicit operator bool() const noexcept { return record_ != nullptr; }
+
+    friend constexpr bool operator==(type_id, type_id) noexcept = default;
+
+    friend auto operator<=>(type_id a, type_id b) noexcept
+    {
+        return std::compare_three_way{ }(a.record_, b.record_);
+    }
+
+private:
+    constexpr explicit type_id(const std::string_view* record) noexcept : record_(record) { }
+
+    const std::string_view* record_ = nullptr;
+};
+
+}
+
+template<>
+struct std::hash<open_cpp_utils::type_id>
+{
+    std::size_t operator()(open_cpp_utils::type_id id) const noexcept
+    {
+        return std::hash<const void*>{ }(id.address());
+    }
+};
+
+#endif // OPEN_CPP_UTILS_TEMPLATE_UTILS_H
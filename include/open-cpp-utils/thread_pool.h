@@ -0,0 +1,893 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_THREAD_POOL_H
+#define OPEN_CPP_UTILS_THREAD_POOL_H
+
+#include "config.h"
+#include "concurrent_queue.h"
+#include "small_vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(OCU_PLATFORM_WINDOWS)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#elif defined(OCU_PLATFORM_LINUX)
+#   include <pthread.h>
+#   include <sched.h>
+#endif
+
+namespace open_cpp_utils
+{
+
+class thread_pool;
+
+namespace detail
+{
+
+// Tasks ---------------------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Heap allocated unit of work. invoke runs the callable and frees the task.
+ */
+struct pool_task
+{
+    void (*invoke)(pool_task*) noexcept;
+};
+
+template<typename Fn>
+struct pool_task_impl final : pool_task
+{
+    explicit pool_task_impl(Fn&& f) : pool_task{ &call }, fn(std::move(f)) { }
+
+    static void call(pool_task* t) noexcept
+    {
+        std::unique_ptr<pool_task_impl> self(static_cast<pool_task_impl*>(t));
+        self->fn();
+    }
+
+    Fn fn;
+};
+
+template<typename Fn>
+pool_task* make_pool_task(Fn&& fn)
+{
+    return new pool_task_impl<std::decay_t<Fn>>(std::decay_t<Fn>(std::forward<Fn>(fn)));
+}
+
+// Work Stealing Deque -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Chase-Lev deque (with the memory orderings of Le et al., "Correct and Efficient Work-Stealing for Weak
+ *        Memory Models"). The owning worker pushes and pops at the bottom without contention; thieves take from the
+ *        top with a CAS. Only the owner grows the ring, and replaced rings stay alive until the deque is destroyed
+ *        because a thief may still be reading from one.
+ */
+class work_stealing_deque
+{
+    struct ring
+    {
+        explicit ring(std::int64_t cap) : capacity(cap), slots(std::make_unique<std::atomic<pool_task*>[]>(cap)) { }
+
+        pool_task* get(std::int64_t i) const noexcept
+        {
+            return slots[i & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, pool_task* t) noexcept
+        {
+            slots[i & (capacity - 1)].store(t, std::memory_order_relaxed);
+        }
+
+        const std::int64_t                         capacity;
+        std::unique_ptr<std::atomic<pool_task*>[]> slots;
+    };
+
+public:
+    explicit work_stealing_deque(std::int64_t capacity = 256)
+        : ring_(new ring(static_cast<std::int64_t>(std::bit_ceil(static_cast<std::uint64_t>(capacity)))))
+    {
+        rings_.emplace_back(ring_.load(std::memory_order_relaxed));
+    }
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+    /// Owner only
+    void push(pool_task* t)
+    {
+        const std::int64_t b = bottom_.value.load(std::memory_order_relaxed);
+        const std::int64_t f = top_.value.load(std::memory_order_acquire);
+        ring* r = ring_.load(std::memory_order_relaxed);
+
+        if(OCU_UNLIKELY(b - f > r->capacity - 1))
+        {
+            auto bigger = std::make_unique<ring>(r->capacity * 2);
+            for(std::int64_t i = f; i < b; ++i) bigger->put(i, r->get(i));
+            r = bigger.get();
+            rings_.push_back(std::move(bigger));
+            ring_.store(r, std::memory_order_release);
+        }
+
+        r->put(b, t);
+        bottom_.value.store(b + 1, std::memory_order_release);
+    }
+
+    /// Owner only; takes the most recently pushed task
+    pool_task* pop() noexcept
+    {
+        const std::int64_t b = bottom_.value.load(std::memory_order_relaxed) - 1;
+        ring* r = ring_.load(std::memory_order_relaxed);
+        bottom_.value.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t f = top_.value.load(std::memory_order_relaxed);
+
+        if(f > b)
+        {
+            bottom_.value.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        pool_task* t = r->get(b);
+        if(f == b)
+        {
+            if(!top_.value.compare_exchange_strong(f, f + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                t = nullptr;
+            }
+            bottom_.value.store(b + 1, std::memory_order_relaxed);
+        }
+        return t;
+    }
+
+    /// Any thread; takes the oldest task. Returns nullptr when empty or when it lost a race.
+    pool_task* steal() noexcept
+    {
+        std::int64_t f = top_.value.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = bottom_.value.load(std::memory_order_acquire);
+
+        if(f >= b) return nullptr;
+
+        pool_task* t = ring_.load(std::memory_order_acquire)->get(f);
+        if(!top_.value.compare_exchange_strong(f, f + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+        return t;
+    }
+
+    bool empty_approx() const noexcept
+    {
+        return bottom_.value.load(std::memory_order_relaxed) <= top_.value.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct alignas(cache_line_size) padded_index
+    {
+        std::atomic<std::int64_t> value{ 0 };
+    };
+
+    padded_index                     top_;
+    padded_index                     bottom_;
+    std::atomic<ring*>               ring_;
+    std::vector<std::unique_ptr<ring>> rings_;
+};
+
+// Completion ----------------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Countdown shared by the tasks of one parallel operation and the thread waiting on it. Held through a
+ *        shared_ptr so the last task can still notify after the waiter has observed zero and returned.
+ */
+struct completion
+{
+    explicit completion(std::size_t n) : pending(n) { }
+
+    void done() noexcept
+    {
+        if(pending.fetch_sub(1, std::memory_order_acq_rel) == 1) pending.notify_all();
+    }
+
+    void fail(std::exception_ptr e) noexcept
+    {
+        std::lock_guard lock(error_mutex);
+        if(!error) error = std::move(e);
+        failed.store(true, std::memory_order_release);
+    }
+
+    void rethrow_if_failed()
+    {
+        if(failed.load(std::memory_order_acquire)) std::rethrow_exception(error);
+    }
+
+    std::atomic<std::size_t> pending;
+    std::atomic<bool>        failed{ false };
+    std::mutex               error_mutex;
+    std::exception_ptr       error;
+};
+
+// Affinity ------------------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Binds the calling thread to the n-th CPU the process may run on (wrapping around). Returns false where
+ *        the platform has no affinity API (macOS) or the call fails.
+ */
+inline bool pin_current_thread(unsigned n) noexcept
+{
+#if defined(OCU_PLATFORM_LINUX)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return false;
+
+    const int count = CPU_COUNT(&allowed);
+    if(count == 0) return false;
+
+    int target = static_cast<int>(n % static_cast<unsigned>(count));
+    for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if(!CPU_ISSET(cpu, &allowed)) continue;
+        if(target-- == 0)
+        {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(cpu, &one);
+            return pthread_setaffinity_np(pthread_self(), sizeof(one), &one) == 0;
+        }
+    }
+    return false;
+#elif defined(OCU_PLATFORM_WINDOWS)
+    DWORD_PTR process_mask = 0, system_mask = 0;
+    if(!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask) || process_mask == 0) return false;
+
+    const unsigned count = static_cast<unsigned>(std::popcount(static_cast<std::uint64_t>(process_mask)));
+    unsigned target = n % count;
+    for(unsigned cpu = 0; cpu < sizeof(DWORD_PTR) * 8; ++cpu)
+    {
+        const DWORD_PTR bit = DWORD_PTR(1) << cpu;
+        if(!(process_mask & bit)) continue;
+        if(target-- == 0) return SetThreadAffinityMask(GetCurrentThread(), bit) != 0;
+    }
+    return false;
+#else
+    static_cast<void>(n);
+    return false;
+#endif
+}
+
+}
+
+// thread_pool =========================================================================================================
+
+struct thread_pool_options
+{
+    /// Worker count; 0 uses std::thread::hardware_concurrency()
+    unsigned    threads = 0;
+
+    /// Pin worker i to the i-th CPU of the process affinity mask
+    bool        pin_workers = false;
+
+    /// Capacity of the queue taking tasks posted from threads outside the pool
+    std::size_t injection_capacity = 4096;
+};
+
+/**
+ * \brief Work-stealing executor.
+ *
+ * Each worker owns a Chase-Lev deque. Tasks posted from a worker go to the bottom of its own deque (LIFO, so nested
+ * work stays cache-hot); tasks posted from any other thread go through a bounded MPMC injection queue, and when that
+ * is full the posting thread runs the task itself. Idle workers steal from the top of other deques, and once there
+ * is nothing to steal they park on an atomic epoch (std::atomic::wait) instead of spinning. Posting only pays for a
+ * wake-up when a worker is actually parked.
+ *
+ * Threads that wait on pool work (parallel_for, task_graph::run, wait) run pending tasks while they wait, so nested
+ * parallelism from inside a task cannot starve the pool.
+ *
+ * Tasks passed to post must not throw; an escaping exception calls std::terminate, as it would for std::thread.
+ * submit captures exceptions in the returned future. The destructor runs every task already posted, then joins.
+ */
+class thread_pool
+{
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors & Destructor -------------------------------------------------------------------------------------------
+
+    thread_pool() : thread_pool(thread_pool_options{ }) { }
+
+    explicit thread_pool(unsigned threads) : thread_pool(thread_pool_options{ .threads = threads }) { }
+
+    explicit thread_pool(const thread_pool_options& options)
+        : injection_(options.injection_capacity)
+    {
+        unsigned n = options.threads;
+        if(n == 0) n = std::max(1u, std::thread::hardware_concurrency());
+
+        workers_.reserve(n);
+        for(unsigned i = 0; i < n; ++i) workers_.push_back(std::make_unique<worker>());
+
+        for(unsigned i = 0; i < n; ++i)
+        {
+            workers_[i]->thread = std::thread([this, i, pin = options.pin_workers]
+            {
+                if(pin) detail::pin_current_thread(i);
+                worker_loop_(i);
+            });
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool()
+    {
+        stopping_.store(true, std::memory_order_seq_cst);
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_all();
+        for(auto& w : workers_) w->thread.join();
+    }
+
+// Submission ----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Schedules fn() to run on the pool without a way to observe its completion
+     */
+    template<typename Fn>
+    void post(Fn&& fn)
+    {
+        schedule_(detail::make_pool_task(std::forward<Fn>(fn)));
+    }
+
+    /**
+     * \brief Schedules fn() and returns a future for its result or exception
+     */
+    template<typename Fn>
+    auto submit(Fn&& fn) -> std::future<std::invoke_result_t<std::decay_t<Fn>&>>
+    {
+        using result = std::invoke_result_t<std::decay_t<Fn>&>;
+
+        std::packaged_task<result()> task(std::forward<Fn>(fn));
+        auto future = task.get_future();
+        post(std::move(task));
+        return future;
+    }
+
+// Waiting -------------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Runs pending tasks on the calling thread until c counts down to zero, sleeping on the counter when
+     *        there is nothing to run
+     */
+    void wait(detail::completion& c)
+    {
+        for(;;)
+        {
+            const std::size_t pending = c.pending.load(std::memory_order_acquire);
+            if(pending == 0) return;
+            if(!try_run_one()) c.pending.wait(pending, std::memory_order_acquire);
+        }
+    }
+
+    /**
+     * \brief Runs at most one pending task on the calling thread: its own deque first if it is a worker of this pool,
+     *        then the injection queue, then a steal
+     * \return true if a task ran
+     */
+    bool try_run_one()
+    {
+        detail::pool_task* t = find_task_(current_index_());
+        if(t == nullptr) return false;
+        t->invoke(t);
+        return true;
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] std::size_t size() const noexcept { return workers_.size(); }
+
+    /**
+     * \brief Index of the calling thread's worker in this pool, or -1 if the caller is not one of its workers
+     */
+    [[nodiscard]] int current_worker() const noexcept
+    {
+        const std::size_t i = current_index_();
+        return i == npos_ ? -1 : static_cast<int>(i);
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    static constexpr std::size_t npos_ = static_cast<std::size_t>(-1);
+
+    struct context
+    {
+        const thread_pool* pool  = nullptr;
+        std::size_t        index = npos_;
+        std::uint32_t      rng   = 0x9E3779B9u;
+    };
+
+    static context& context_() noexcept
+    {
+        thread_local context ctx;
+        return ctx;
+    }
+
+    std::size_t current_index_() const noexcept
+    {
+        const context& ctx = context_();
+        return ctx.pool == this ? ctx.index : npos_;
+    }
+
+    void schedule_(detail::pool_task* t)
+    {
+        const std::size_t self = current_index_();
+        if(self != npos_)
+        {
+            workers_[self]->deque.push(t);
+        }
+        else if(!injection_.try_push(t))
+        {
+            t->invoke(t);
+            return;
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(sleepers_.load(std::memory_order_relaxed) != 0)
+        {
+            epoch_.fetch_add(1, std::memory_order_release);
+            epoch_.notify_one();
+        }
+    }
+
+    detail::pool_task* find_task_(std::size_t self) noexcept
+    {
+        if(self != npos_)
+        {
+            if(detail::pool_task* t = workers_[self]->deque.pop()) return t;
+        }
+
+        detail::pool_task* t = nullptr;
+        if(injection_.try_pop(t)) return t;
+
+        const std::size_t n = workers_.size();
+        std::uint32_t& rng = context_().rng;
+        rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+
+        const std::size_t start = rng % n;
+        for(std::size_t k = 0; k < n; ++k)
+        {
+            const std::size_t victim = (start + k) % n;
+            if(victim == self) continue;
+            if((t = workers_[victim]->deque.steal())) return t;
+        }
+        return nullptr;
+    }
+
+    bool has_work_() const noexcept
+    {
+        if(!injection_.empty_approx()) return true;
+        for(const auto& w : workers_)
+        {
+            if(!w->deque.empty_approx()) return true;
+        }
+        return false;
+    }
+
+    void worker_loop_(std::size_t self)
+    {
+        context& ctx = context_();
+        ctx.pool  = this;
+        ctx.index = self;
+        ctx.rng   = static_cast<std::uint32_t>(self * 0x9E3779B9u + 1);
+
+        constexpr int spin_rounds = 64;
+        int idle = 0;
+
+        for(;;)
+        {
+            if(detail::pool_task* t = find_task_(self))
+            {
+                t->invoke(t);
+                idle = 0;
+                continue;
+            }
+
+            if(++idle < spin_rounds)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Announce the sleep before the final check; schedule_ fences between publishing a task and reading
+            // sleepers_, so either it sees us and bumps the epoch or we see its task here.
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::uint32_t epoch = epoch_.load(std::memory_order_seq_cst);
+
+            if(has_work_())
+            {
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                idle = 0;
+                continue;
+            }
+
+            if(stopping_.load(std::memory_order_seq_cst))
+            {
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+
+            epoch_.wait(epoch, std::memory_order_acquire);
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            idle = 0;
+        }
+    }
+
+    struct worker
+    {
+        detail::work_stealing_deque deque;
+        std::thread                 thread;
+    };
+
+// Variables ===========================================================================================================
+
+private:
+    std::vector<std::unique_ptr<worker>>  workers_;
+    mpmc_queue<detail::pool_task*>        injection_;
+
+    alignas(cache_line_size) std::atomic<std::uint32_t> epoch_{ 0 };
+    std::atomic<std::uint32_t>                          sleepers_{ 0 };
+    std::atomic<bool>                                   stopping_{ false };
+};
+
+/**
+ * \brief Process-wide pool sized to the hardware, created on first use
+ */
+inline thread_pool& default_thread_pool()
+{
+    static thread_pool pool;
+    return pool;
+}
+
+// parallel_for ========================================================================================================
+
+namespace detail
+{
+
+inline std::size_t resolve_grain(const thread_pool& pool, std::size_t count, std::size_t grain) noexcept
+{
+    if(grain != 0) return grain;
+    return std::max<std::size_t>(1, count / (pool.size() * 8));
+}
+
+/**
+ * \brief Runs chunk(c) for every c in [0, chunks) on the pool and the calling thread. Chunks are handed out through
+ *        an atomic counter, so threads that finish early keep taking work. After the first exception the remaining
+ *        chunks are skipped and the exception is rethrown here.
+ */
+template<typename Chunk>
+void run_chunks(thread_pool& pool, std::size_t chunks, Chunk& chunk)
+{
+    if(chunks == 0) return;
+    if(chunks == 1) { chunk(std::size_t(0)); return; }
+
+    struct shared_state : completion
+    {
+        using completion::completion;
+        std::atomic<std::size_t> next{ 0 };
+    };
+
+    const std::size_t helpers = std::min(pool.size(), chunks - 1);
+    auto state = std::make_shared<shared_state>(helpers);
+
+    auto drain = [&chunk, chunks](shared_state& s) noexcept
+    {
+        for(std::size_t c; (c = s.next.fetch_add(1, std::memory_order_relaxed)) < chunks; )
+        {
+            if(s.failed.load(std::memory_order_relaxed)) continue;
+            try { chunk(c); }
+            catch(...) { s.fail(std::current_exception()); }
+        }
+    };
+
+    for(std::size_t i = 0; i < helpers; ++i)
+    {
+        pool.post([state, &drain]() noexcept { drain(*state); state->done(); });
+    }
+
+    drain(*state);
+    pool.wait(*state);
+    state->rethrow_if_failed();
+}
+
+}
+
+/**
+ * \brief Calls fn over [first, last) on the pool and the calling thread, grain indices per chunk (0 picks a grain
+ *        giving roughly eight chunks per worker).
+ *
+ * fn is called either as fn(i) for every index or, if it accepts two indices, as fn(begin, end) once per chunk.
+ */
+template<typename Fn>
+void parallel_for(thread_pool& pool, std::size_t first, std::size_t last, std::size_t grain, Fn&& fn)
+{
+    if(last <= first) return;
+
+    const std::size_t count  = last - first;
+    grain = detail::resolve_grain(pool, count, grain);
+    const std::size_t chunks = (count + grain - 1) / grain;
+
+    auto chunk = [&](std::size_t c)
+    {
+        const std::size_t begin = first + c * grain;
+        const std::size_t end   = std::min(begin + grain, last);
+        if constexpr(std::is_invocable_v<Fn&, std::size_t, std::size_t>)
+        {
+            fn(begin, end);
+        }
+        else
+        {
+            for(std::size_t i = begin; i < end; ++i) fn(i);
+        }
+    };
+    detail::run_chunks(pool, chunks, chunk);
+}
+
+template<typename Fn>
+void parallel_for(std::size_t first, std::size_t last, std::size_t grain, Fn&& fn)
+{
+    parallel_for(default_thread_pool(), first, last, grain, std::forward<Fn>(fn));
+}
+
+/**
+ * \brief Reduces [first, last) in parallel.
+ *
+ * body is called either as body(i) returning a T for every index, or, if it accepts two indices, as
+ * body(begin, end) returning the partial result of a whole chunk. Partial results are combined with reduce in chunk
+ * order starting from identity, so the result is deterministic for a given grain even when reduce is not
+ * commutative.
+ */
+template<typename T, typename Body, typename Reduce>
+T parallel_reduce(thread_pool& pool, std::size_t first, std::size_t last, std::size_t grain, T identity,
+                  Body&& body, Reduce&& reduce)
+{
+    if(last <= first) return identity;
+
+    const std::size_t count  = last - first;
+    grain = detail::resolve_grain(pool, count, grain);
+    const std::size_t chunks = (count + grain - 1) / grain;
+
+    // One cache line per chunk: no false sharing between workers, and no packed std::vector<bool> words to race on
+    struct alignas(cache_line_size) partial
+    {
+        T value;
+    };
+    std::vector<partial> partials(chunks, partial{ identity });
+    auto chunk = [&](std::size_t c)
+    {
+        const std::size_t begin = first + c * grain;
+        const std::size_t end   = std::min(begin + grain, last);
+        if constexpr(std::is_invocable_v<Body&, std::size_t, std::size_t>)
+        {
+            partials[c].value = body(begin, end);
+        }
+        else
+        {
+            T acc = identity;
+            for(std::size_t i = begin; i < end; ++i) acc = reduce(std::move(acc), body(i));
+            partials[c].value = std::move(acc);
+        }
+    };
+    detail::run_chunks(pool, chunks, chunk);
+
+    T result = std::move(identity);
+    for(partial& p : partials) result = reduce(std::move(result), std::move(p.value));
+    return result;
+}
+
+template<typename T, typename Body, typename Reduce>
+T parallel_reduce(std::size_t first, std::size_t last, std::size_t grain, T identity, Body&& body, Reduce&& reduce)
+{
+    return parallel_reduce(default_thread_pool(), first, last, grain, std::move(identity),
+                           std::forward<Body>(body), std::forward<Reduce>(reduce));
+}
+
+// task_graph ==========================================================================================================
+
+/**
+ * \brief Dependency-counted DAG of tasks.
+ *
+ * Build the graph with emplace and precede, then run it on a pool as often as needed. Every node starts with a count
+ * of its unfinished predecessors; roots are posted immediately and a finishing node posts each successor whose count
+ * drops to zero, running the last one inline to skip a queue round-trip. run blocks (helping the pool) until every
+ * node has finished and rethrows the first exception a node threw; nodes that become ready after a failure are
+ * skipped. The graph must not be modified while it runs.
+ */
+class task_graph
+{
+// Typedefs ============================================================================================================
+
+public:
+    /// Handle to a node of this graph
+    class node
+    {
+    public:
+        node() = default;
+
+        [[nodiscard]] std::uint32_t index() const noexcept { return index_; }
+
+        friend bool operator==(node, node) = default;
+
+    private:
+        friend class task_graph;
+        explicit node(std::uint32_t i) : index_(i) { }
+
+        std::uint32_t index_ = static_cast<std::uint32_t>(-1);
+    };
+
+// Functions ===========================================================================================================
+
+public:
+    task_graph() = default;
+
+    task_graph(const task_graph&) = delete;
+    task_graph& operator=(const task_graph&) = delete;
+
+    task_graph(task_graph&&) noexcept = default;
+    task_graph& operator=(task_graph&&) noexcept = default;
+
+    template<typename Fn>
+    node emplace(Fn&& fn)
+    {
+        nodes_.push_back(std::make_unique<node_data>(std::function<void()>(std::forward<Fn>(fn))));
+        return node(static_cast<std::uint32_t>(nodes_.size() - 1));
+    }
+
+    /**
+     * \brief Makes after wait for before
+     */
+    void precede(node before, node after)
+    {
+        OCU_ASSERT(before.index_ < nodes_.size() && after.index_ < nodes_.size(), "task_graph node out of range");
+        OCU_ASSERT(before != after, "task_graph node cannot depend on itself");
+        nodes_[before.index_]->successors.push_back(after.index_);
+        ++nodes_[after.index_]->predecessors;
+    }
+
+    /**
+     * \brief Shorthand for precede(before, n) for every n in after
+     */
+    void precede(node before, std::initializer_list<node> after)
+    {
+        for(node n : after) precede(before, n);
+    }
+
+    [[nodiscard]] std::size_t size()  const noexcept { return nodes_.size(); }
+    [[nodiscard]] bool        empty() const noexcept { return nodes_.empty(); }
+
+    void clear() noexcept { nodes_.clear(); }
+
+    /**
+     * \brief Executes the graph on pool and blocks until it completes
+     * \throws std::logic_error if the graph has a cycle, or the first exception thrown by a node
+     */
+    void run(thread_pool& pool)
+    {
+        if(nodes_.empty()) return;
+        check_acyclic_();
+
+        for(auto& n : nodes_) n->pending.store(n->predecessors, std::memory_order_relaxed);
+
+        auto state = std::make_shared<detail::completion>(nodes_.size());
+        for(std::uint32_t i = 0; i < nodes_.size(); ++i)
+        {
+            if(nodes_[i]->predecessors != 0) continue;
+            pool.post([this, &pool, state, i]() noexcept { execute_(pool, state, i); });
+        }
+
+        pool.wait(*state);
+        state->rethrow_if_failed();
+    }
+
+    void run() { run(default_thread_pool()); }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    struct node_data
+    {
+        explicit node_data(std::function<void()> f) : fn(std::move(f)) { }
+
+        std::function<void()>       fn;
+        small_vector<std::uint32_t> successors;
+        std::uint32_t               predecessors = 0;
+        std::atomic<std::uint32_t>  pending{ 0 };
+    };
+
+    void execute_(thread_pool& pool, const std::shared_ptr<detail::completion>& state, std::uint32_t i) noexcept
+    {
+        for(;;)
+        {
+            node_data& n = *nodes_[i];
+            if(!state->failed.load(std::memory_order_relaxed))
+            {
+                try { n.fn(); }
+                catch(...) { state->fail(std::current_exception()); }
+            }
+
+            std::uint32_t inline_next = static_cast<std::uint32_t>(-1);
+            for(std::uint32_t s : n.successors)
+            {
+                if(nodes_[s]->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+                if(inline_next != static_cast<std::uint32_t>(-1))
+                {
+                    pool.post([this, &pool, state, next = inline_next]() noexcept { execute_(pool, state, next); });
+                }
+                inline_next = s;
+            }
+
+            // Successors are released before this node counts as done, so the graph outlives every access to it
+            state->done();
+            if(inline_next == static_cast<std::uint32_t>(-1)) return;
+            i = inline_next;
+        }
+    }
+
+    void check_acyclic_() const
+    {
+        std::vector<std::uint32_t> indegree(nodes_.size());
+        std::vector<std::uint32_t> ready;
+        for(std::uint32_t i = 0; i < nodes_.size(); ++i)
+        {
+            indegree[i] = nodes_[i]->predecessors;
+            if(indegree[i] == 0) ready.push_back(i);
+        }
+
+        std::size_t visited = 0;
+        while(!ready.empty())
+        {
+            const std::uint32_t i = ready.back();
+            ready.pop_back();
+            ++visited;
+            for(std::uint32_t s : nodes_[i]->successors)
+            {
+                if(--indegree[s] == 0) ready.push_back(s);
+            }
+        }
+
+        if(visited != nodes_.size()) throw std::logic_error("task_graph contains a cycle");
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    std::vector<std::unique_ptr<node_data>> nodes_;
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_THREAD_POOL_H
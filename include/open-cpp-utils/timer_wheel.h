@@ -0,0 +1,451 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_TIMER_WHEEL_H
+#define OPEN_CPP_UTILS_TIMER_WHEEL_H
+
+#include "config.h"
+#include "object_pool.h"
+#include "optional.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace open_cpp_utils
+{
+
+/**
+ * \brief Hierarchical timing wheel: O(1) schedule, cancel and reschedule for millions of timers.
+ *
+ * Time is measured in ticks of whatever resolution the owner chooses. Four levels of 256 slots cover deadlines up to
+ * 2^32 ticks ahead, and a timer is placed on the level of the highest byte in which its deadline differs from the
+ * current tick. Longer deadlines wait in an overflow list. Whenever the current tick crosses a slot boundary of a
+ * higher level, that slot's timers cascade one or more levels down, so a timer moves at most once per level.
+ *
+ * Timers are nodes in an object_pool that record their own slot and position, and each slot is a packed array of pool
+ * handles. Scheduling appends a handle, cancelling swap-removes it, and cascading or firing a slot walks an array
+ * instead of chasing links, so the node loads are independent and overlap. Nothing allocates once the pool and the
+ * slot arrays have grown. The timer handle returned by schedule pairs the node's pool handle with a per-wheel 32-bit
+ * serial number, so cancelling or rescheduling a timer that already fired or was cancelled is a safe no-op: a stale
+ * handle could only match again after 2^32 further timers, one of which reused its pool slot and generation.
+ *
+ * advance_to jumps straight to the next tick that has work, found from per-level occupancy bitmaps, and fires every
+ * timer of that tick in one pass. A wheel that is idle or only holds distant timers costs a few bitmap scans per call,
+ * not one step per elapsed tick. Use next_event to decide how long an event loop may sleep.
+ *
+ * A wheel is owned by one thread. Callbacks may schedule and cancel timers, including ones due in the same advance.
+ *
+ * \tparam T Payload stored per timer and handed to the expiry callback, e.g. a connection ID, or a callable for the
+ *           advance_to overloads that invoke it directly or post it to a thread_pool
+ */
+template<typename T = std::function<void()>>
+class timer_wheel
+{
+// Typedefs ============================================================================================================
+
+    struct node;
+
+    using handle = pool_handle<node>;
+
+public:
+    using value_type = T;
+    using size_type  = std::size_t;
+    using tick_type  = std::uint64_t;
+
+    /**
+     * \brief Reference to a scheduled timer. The pool handle's 8-bit generation repeats after 128 reuses of a slot,
+     *        so the serial number the timer was scheduled under is checked as well.
+     */
+    class timer
+    {
+    public:
+        constexpr timer() noexcept = default;
+
+        /// True for any handle returned by schedule, even if the timer has since fired or been cancelled
+        constexpr explicit operator bool() const noexcept { return static_cast<bool>(node_); }
+
+        friend constexpr bool operator==(timer, timer) noexcept = default;
+
+    private:
+        friend class timer_wheel;
+
+        constexpr timer(handle n, std::uint32_t serial) noexcept : node_(n), serial_(serial) { }
+
+        handle        node_;
+        std::uint32_t serial_ = 0;
+    };
+
+    static constexpr unsigned slot_bits = 8;
+    static constexpr unsigned slots     = 1u << slot_bits;
+    static constexpr unsigned levels    = 4;
+
+private:
+    static constexpr tick_type     slot_mask         = slots - 1;
+    static constexpr std::uint16_t overflow_slot     = levels * slots;
+    static constexpr unsigned      bitmap_words      = slots / 64;
+    static constexpr std::size_t   prefetch_distance = 8;
+
+    struct node
+    {
+        template<typename... Args>
+        explicit node(tick_type d, Args&&... args) : value(std::forward<Args>(args)...), deadline(d) { }
+
+        T             value;
+        tick_type     deadline;
+        std::uint32_t position = 0;
+        std::uint32_t serial   = 0;
+        std::uint16_t slot     = 0;
+    };
+
+// Functions ===========================================================================================================
+
+public:
+
+// Constructors --------------------------------------------------------------------------------------------------------
+
+    /**
+     * \param start Tick the wheel is at before the first advance
+     */
+    explicit timer_wheel(tick_type start = 0) noexcept : now_(start) { }
+
+    timer_wheel(const timer_wheel&) = delete;
+    timer_wheel& operator=(const timer_wheel&) = delete;
+
+// Scheduling ----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Schedules a timer that fires when the wheel reaches deadline; deadlines that are not in the future fire
+     *        on the next tick
+     * \param args Constructor arguments for the payload
+     */
+    template<typename... Args>
+    timer schedule_at(tick_type deadline, Args&&... args)
+    {
+        deadline = std::max(deadline, now_ + 1);
+        const std::uint16_t slot = slot_for_(deadline);
+        reserve_one_(slot);
+
+        const handle h = pool_.acquire(deadline, std::forward<Args>(args)...);
+        node&        n = pool_[h];
+        n.serial = ++serial_;
+        link_(h, n, slot);
+        return timer(h, n.serial);
+    }
+
+    /**
+     * \brief Schedules a timer delay ticks from now
+     */
+    template<typename... Args>
+    timer schedule(tick_type delay, Args&&... args)
+    {
+        return schedule_at(now_ + delay, std::forward<Args>(args)...);
+    }
+
+    /**
+     * \brief Removes a pending timer without firing it
+     * \return false if t has already fired or been cancelled
+     */
+    bool cancel(timer t) noexcept
+    {
+        node* n = find_(t);
+        if(n == nullptr) return false;
+        unlink_(*n);
+        pool_.release(t.node_);
+        return true;
+    }
+
+    /**
+     * \brief Moves a pending timer to a new deadline, keeping its payload; cheaper than cancel plus schedule
+     * \return false if t has already fired or been cancelled
+     */
+    bool reschedule_at(timer t, tick_type deadline)
+    {
+        node* n = find_(t);
+        if(n == nullptr) return false;
+
+        // Once unlinked the timer has to land in its new slot, so make room there first
+        deadline = std::max(deadline, now_ + 1);
+        const std::uint16_t slot = slot_for_(deadline);
+        reserve_one_(slot);
+
+        unlink_(*n);
+        n->deadline = deadline;
+        link_(t.node_, *n, slot);
+        return true;
+    }
+
+    bool reschedule(timer t, tick_type delay) { return reschedule_at(t, now_ + delay); }
+
+    /**
+     * \brief Cancels every pending timer
+     */
+    void clear() noexcept
+    {
+        for(auto& slot : slots_)
+        {
+            for(handle h : slot) pool_.release(h);
+            slot.clear();
+        }
+        occupied_.fill(0);
+    }
+
+// Advancing -----------------------------------------------------------------------------------------------------------
+
+    /**
+     * \brief Moves the wheel to target, calling on_expire(T&&) for every timer whose deadline is at or before it, in
+     *        deadline order; timers sharing a tick fire in no particular order. The timer is already released when
+     *        its callback runs. If a callback throws, the rest of its tick fires on the next call.
+     * \return number of timers fired
+     */
+    template<typename Fn>
+    size_type advance_to(tick_type target, Fn&& on_expire)
+    {
+        size_type fired = 0;
+        for(;;)
+        {
+            const auto next = next_event();
+            if(!next || *next > target)
+            {
+                now_ = std::max(now_, target);
+                return fired;
+            }
+
+            now_ = *next;
+            cascade_();
+            fired += expire_slot_(static_cast<std::uint16_t>(now_ & slot_mask), on_expire);
+        }
+    }
+
+    template<typename Fn>
+    size_type advance(tick_type ticks, Fn&& on_expire)
+    {
+        return advance_to(now_ + ticks, std::forward<Fn>(on_expire));
+    }
+
+    /**
+     * \brief Moves the wheel to target and invokes every expired payload on the calling thread
+     */
+    size_type advance_to(tick_type target) requires std::invocable<T&>
+    {
+        return advance_to(target, [](T&& fn) { std::invoke(fn); });
+    }
+
+    /**
+     * \brief Moves the wheel to target and posts every expired payload to pool, so the thread driving the wheel only
+     *        does the bookkeeping
+     */
+    size_type advance_to(tick_type target, thread_pool& pool) requires std::invocable<T&>
+    {
+        return advance_to(target, [&pool](T&& fn) { pool.post([fn = std::move(fn)]() mutable { std::invoke(fn); }); });
+    }
+
+// Observers -----------------------------------------------------------------------------------------------------------
+
+    [[nodiscard]] tick_type now()   const noexcept { return now_; }
+    [[nodiscard]] size_type size()  const noexcept { return pool_.size(); }
+    [[nodiscard]] bool      empty() const noexcept { return pool_.empty(); }
+
+    [[nodiscard]] bool pending(timer t) const noexcept { return find_(t) != nullptr; }
+
+    /**
+     * \brief Deadline of a pending timer
+     */
+    [[nodiscard]] tick_type deadline(timer t) const noexcept
+    {
+        OCU_ASSERT(pending(t), "timer_wheel::deadline of a timer that is not pending");
+        return pool_[t.node_].deadline;
+    }
+
+    /**
+     * \brief Earliest tick at which advance_to has work, either firing timers or cascading a non-empty slot, or empty
+     *        if no timer is pending. A lower bound on the next expiry that an event loop can sleep until.
+     */
+    [[nodiscard]] optional<tick_type, max_value_niche<tick_type>> next_event() const noexcept
+    {
+        if(empty()) return std::nullopt;
+
+        const tick_type pos = now_ & slot_mask;
+        if(occupied_bit_(static_cast<std::uint16_t>(pos))) return now_;
+
+        tick_type best = ~tick_type(0);
+        for(unsigned level = 0; level < levels; ++level)
+        {
+            const unsigned shift = level * slot_bits;
+            const unsigned digit = static_cast<unsigned>((now_ >> shift) & slot_mask);
+            const int      next  = next_occupied_(level, digit + 1);
+            if(next < 0) continue;
+
+            const tick_type rotation = now_ >> (shift + slot_bits) << (shift + slot_bits);
+            best = std::min(best, rotation + (static_cast<tick_type>(next) << shift));
+        }
+
+        if(!slots_[overflow_slot].empty())
+        {
+            constexpr unsigned span = levels * slot_bits;
+            best = std::min(best, ((now_ >> span) + 1) << span);
+        }
+        return best;
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    /// Node of t if it is still pending
+    [[nodiscard]] node* find_(timer t) noexcept
+    {
+        node* n = pool_.get(t.node_);
+        return n != nullptr && n->serial == t.serial_ ? n : nullptr;
+    }
+
+    [[nodiscard]] const node* find_(timer t) const noexcept
+    {
+        const node* n = pool_.get(t.node_);
+        return n != nullptr && n->serial == t.serial_ ? n : nullptr;
+    }
+
+    [[nodiscard]] bool occupied_bit_(std::uint16_t slot) const noexcept
+    {
+        return (occupied_[slot / 64] >> (slot % 64)) & 1;
+    }
+
+    /// First occupied slot index >= from on level, or -1
+    [[nodiscard]] int next_occupied_(unsigned level, unsigned from) const noexcept
+    {
+        for(unsigned w = from / 64; w < bitmap_words; ++w)
+        {
+            std::uint64_t bits = occupied_[level * bitmap_words + w];
+            if(w == from / 64) bits &= ~std::uint64_t(0) << (from % 64);
+            if(bits) return static_cast<int>(w * 64 + static_cast<unsigned>(std::countr_zero(bits)));
+        }
+        return -1;
+    }
+
+    /// Slot a timer due at deadline belongs in at the current tick
+    [[nodiscard]] std::uint16_t slot_for_(tick_type deadline) const noexcept
+    {
+        const tick_type diff  = deadline ^ now_;
+        const unsigned  level = diff <= slot_mask ? 0 : (static_cast<unsigned>(std::bit_width(diff)) - 1) / slot_bits;
+        if(level >= levels) return overflow_slot;
+        return static_cast<std::uint16_t>(level * slots + ((deadline >> (level * slot_bits)) & slot_mask));
+    }
+
+    /// Grows slot geometrically if it is full, so the next link_ into it cannot throw
+    void reserve_one_(std::uint16_t slot)
+    {
+        auto& list = slots_[slot];
+        if(list.size() == list.capacity()) list.reserve(std::max<std::size_t>(8, list.size() * 2));
+    }
+
+    void link_(handle h, node& n) { link_(h, n, slot_for_(n.deadline)); }
+
+    void link_(handle h, node& n, std::uint16_t slot)
+    {
+        n.slot     = slot;
+        n.position = static_cast<std::uint32_t>(slots_[slot].size());
+        slots_[slot].push_back(h);
+        if(slot != overflow_slot) occupied_[slot / 64] |= std::uint64_t(1) << (slot % 64);
+    }
+
+    /// Swap-removes n from its slot, which touches the slot's last timer and nothing else
+    void unlink_(node& n) noexcept
+    {
+        auto&       list = slots_[n.slot];
+        const handle last = list.back();
+        list[n.position]     = last;
+        pool_[last].position = n.position;
+        list.pop_back();
+
+        if(list.empty() && n.slot != overflow_slot) clear_bit_(n.slot);
+    }
+
+    void clear_bit_(std::uint16_t slot) noexcept { occupied_[slot / 64] &= ~(std::uint64_t(1) << (slot % 64)); }
+
+    /// Re-links every timer of slot against the current tick, which moves it to a lower level. The slot takes over
+    /// the scratch list's capacity, so cascading does not allocate in steady state.
+    void relink_slot_(std::uint16_t slot)
+    {
+        if(slots_[slot].empty()) return;
+
+        std::swap(scratch_, slots_[slot]);
+        if(slot != overflow_slot) clear_bit_(slot);
+        for(std::size_t i = 0; i < scratch_.size(); ++i)
+        {
+            if(i + prefetch_distance < scratch_.size()) prefetch_(scratch_[i + prefetch_distance]);
+            link_(scratch_[i], pool_[scratch_[i]]);
+        }
+        scratch_.clear();
+    }
+
+    void prefetch_(handle h) const noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&pool_[h], 1, 3);
+#else
+        static_cast<void>(h);
+#endif
+    }
+
+    /// Cascades every level whose slot boundary the current tick sits on, highest first
+    void cascade_()
+    {
+        if((now_ & slot_mask) != 0) return;
+
+        constexpr unsigned span = levels * slot_bits;
+        if((now_ & ((tick_type(1) << span) - 1)) == 0) relink_slot_(overflow_slot);
+
+        for(unsigned level = levels - 1; level >= 1; --level)
+        {
+            const unsigned shift = level * slot_bits;
+            if((now_ & ((tick_type(1) << shift) - 1)) != 0) continue;
+            relink_slot_(static_cast<std::uint16_t>(level * slots + ((now_ >> shift) & slot_mask)));
+        }
+    }
+
+    template<typename Fn>
+    size_type expire_slot_(std::uint16_t slot, Fn& on_expire)
+    {
+        // Popping from the back keeps this correct when a callback cancels other timers of the same slot
+        auto&     list  = slots_[slot];
+        size_type fired = 0;
+        while(!list.empty())
+        {
+            if(list.size() > prefetch_distance) prefetch_(list[list.size() - 1 - prefetch_distance]);
+
+            const handle h = list.back();
+            node&       n = pool_[h];
+            list.pop_back();
+            if(list.empty()) clear_bit_(slot);
+
+            T value(std::move(n.value));
+            pool_.release(h);
+            ++fired;
+            std::invoke(on_expire, std::move(value));
+        }
+        return fired;
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    object_pool<node, 4096>                             pool_;
+    std::array<std::vector<handle>, levels * slots + 1> slots_;
+    std::vector<handle>                                 scratch_;
+    std::array<std::uint64_t, levels * bitmap_words>    occupied_{ };
+    tick_type                                           now_;
+    std::uint32_t                                       serial_ = 0;
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_TIMER_WHEEL_H
@@ -0,0 +1,262 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_UNIQUE_ID_H
+#define OPEN_CPP_UTILS_UNIQUE_ID_H
+
+#include "config.h"
+#include "optional.h"
+
+#include <atomic>
+#include <chrono>
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace open_cpp_utils
+{
+
+// unique_id ===========================================================================================================
+
+/**
+ * \brief Process-unique identifier drawn from an ID space owned by Tag.
+ *
+ * Every thread reserves block_size consecutive values from the space's shared counter and hands them out locally, so
+ * only one in block_size calls to next() touches the shared cache line. IDs are therefore unique but only roughly
+ * ordered across threads, and a thread that exits abandons the rest of its block. Each Tag gets an independent space
+ * starting at 1, which keeps IDs of rarely created types small; a 32-bit T halves the storage when the space is
+ * known to be small. The value 0 is never handed out and marks a null ID.
+ *
+ * \code
+ * struct entity_tag;
+ * using entity_id = unique_id<entity_tag>;
+ * entity_id id = entity_id::next();
+ * \endcode
+ *
+ * \tparam Tag Type naming the ID space (void for the shared default space)
+ * \tparam T   Unsigned integer type of the value
+ */
+template<typename Tag = void, typename T = std::uint64_t>
+class unique_id
+{
+    static_assert(std::is_unsigned_v<T>, "unique_id values must be unsigned");
+
+// Typedefs ============================================================================================================
+
+public:
+    using tag_type   = Tag;
+    using value_type = T;
+
+    /// Values reserved per thread at a time. Smaller for narrow types so threads waste less of the space.
+    static constexpr value_type block_size = sizeof(T) >= 8 ? 4096 : sizeof(T) >= 4 ? 256 : 16;
+
+// Functions ===========================================================================================================
+
+public:
+    constexpr unique_id() noexcept = default;
+
+    /**
+     * \brief Wraps a value previously obtained from value(), e.g. when loading saved data
+     */
+    static constexpr unique_id from_value(value_type v) noexcept { return unique_id(v); }
+
+    /**
+     * \brief Hands out a new ID
+     * \throws std::overflow_error when the ID space is exhausted
+     */
+    [[nodiscard]] static unique_id next()
+    {
+        block& b = local_block_();
+        if(OCU_UNLIKELY(b.next == b.end)) refill_(b);
+        return unique_id(b.next++);
+    }
+
+    [[nodiscard]] constexpr value_type value() const noexcept { return value_; }
+
+    constexpr explicit operator bool() const noexcept { return value_ != 0; }
+
+    friend constexpr bool operator==(unique_id, unique_id) noexcept = default;
+    friend constexpr auto operator<=>(unique_id, unique_id) noexcept = default;
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    constexpr explicit unique_id(value_type v) noexcept : value_(v) { }
+
+    struct block
+    {
+        value_type next = 0;
+        value_type end  = 0;
+    };
+
+    static block& local_block_() noexcept
+    {
+        thread_local block b;
+        return b;
+    }
+
+    static std::atomic<value_type>& counter_() noexcept
+    {
+        alignas(cache_line_size) static std::atomic<value_type> counter{ 1 };
+        return counter;
+    }
+
+    OCU_NOINLINE static void refill_(block& b)
+    {
+        constexpr value_type max = std::numeric_limits<value_type>::max();
+
+        value_type first = counter_().load(std::memory_order_relaxed);
+        do
+        {
+            if(first == 0 || max - first < block_size) throw std::overflow_error("unique_id space exhausted");
+        }
+        while(!counter_().compare_exchange_weak(first, first + block_size, std::memory_order_relaxed));
+
+        b.next = first;
+        b.end  = first + block_size;
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    value_type value_ = 0;
+};
+
+/// optional<unique_id> uses the null ID as its empty state
+template<typename Tag, typename T>
+struct niche_traits<unique_id<Tag, T>>
+{
+    static constexpr unique_id<Tag, T> empty() noexcept { return unique_id<Tag, T>(); }
+    static constexpr bool is_empty(unique_id<Tag, T> id) noexcept { return id.value() == 0; }
+};
+
+// snowflake_generator =================================================================================================
+
+/**
+ * \brief 64-bit IDs that are unique across processes and machines without coordination, as long as every generator
+ *        is given a distinct node number.
+ *
+ * Layout, from the most significant bit: 1 zero bit, 41 bits of milliseconds since the epoch (about 69 years), 10
+ * bits of node, 12 bits of sequence. IDs from one generator strictly increase. When more than 4096 IDs are requested
+ * in one millisecond, or the system clock steps backwards, the generator keeps counting on a logical clock slightly
+ * ahead of the wall clock instead of blocking.
+ *
+ * next() is a single CAS on the generator's state; give each hot thread its own generator (and node) if that becomes
+ * contended.
+ */
+class snowflake_generator
+{
+// Typedefs ============================================================================================================
+
+public:
+    static constexpr int timestamp_bits = 41;
+    static constexpr int node_bits      = 10;
+    static constexpr int sequence_bits  = 12;
+
+    static constexpr std::uint64_t max_node = (std::uint64_t(1) << node_bits) - 1;
+
+    /// 2024-01-01T00:00:00Z
+    static constexpr std::chrono::milliseconds default_epoch{ 1704067200000 };
+
+    struct parts
+    {
+        std::uint64_t timestamp_ms; ///< Milliseconds since the generator's epoch
+        std::uint64_t node;
+        std::uint64_t sequence;
+    };
+
+// Functions ===========================================================================================================
+
+public:
+    /**
+     * \param node  Number of this generator, unique among everything producing IDs in the same space
+     * \param epoch Time since the Unix epoch that timestamp 0 stands for
+     * \throws std::invalid_argument if node exceeds max_node
+     */
+    explicit snowflake_generator(std::uint64_t node, std::chrono::milliseconds epoch = default_epoch)
+        : node_(node)
+        , epoch_(epoch)
+    {
+        if(node > max_node) throw std::invalid_argument("snowflake node out of range");
+    }
+
+    snowflake_generator(const snowflake_generator&) = delete;
+    snowflake_generator& operator=(const snowflake_generator&) = delete;
+
+    [[nodiscard]] std::uint64_t next() noexcept
+    {
+        const std::uint64_t now = now_() << sequence_bits;
+
+        // state_ holds (timestamp << sequence_bits) | sequence of the last ID; a carry out of the sequence simply
+        // advances the logical timestamp
+        std::uint64_t last = state_.load(std::memory_order_relaxed);
+        std::uint64_t stamp;
+        do
+        {
+            stamp = now > last ? now : last + 1;
+        }
+        while(!state_.compare_exchange_weak(last, stamp, std::memory_order_relaxed));
+
+        const std::uint64_t timestamp = (stamp >> sequence_bits) & ((std::uint64_t(1) << timestamp_bits) - 1);
+        const std::uint64_t sequence  = stamp & ((std::uint64_t(1) << sequence_bits) - 1);
+        return (timestamp << (node_bits + sequence_bits)) | (node_ << sequence_bits) | sequence;
+    }
+
+    [[nodiscard]] std::uint64_t node() const noexcept { return node_; }
+
+    [[nodiscard]] std::chrono::milliseconds epoch() const noexcept { return epoch_; }
+
+    static constexpr parts decompose(std::uint64_t id) noexcept
+    {
+        return {
+            id >> (node_bits + sequence_bits),
+            (id >> sequence_bits) & max_node,
+            id & ((std::uint64_t(1) << sequence_bits) - 1)
+        };
+    }
+
+    /**
+     * \brief Wall-clock time at which id was generated, to millisecond precision
+     */
+    [[nodiscard]] std::chrono::system_clock::time_point time_of(std::uint64_t id) const noexcept
+    {
+        const auto ms = std::chrono::milliseconds(decompose(id).timestamp_ms) + epoch_;
+        return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(ms));
+    }
+
+// Helpers -------------------------------------------------------------------------------------------------------------
+
+private:
+    std::uint64_t now_() const noexcept
+    {
+        const auto since_unix = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch());
+        const auto since_epoch = since_unix - epoch_;
+        return since_epoch.count() > 0 ? static_cast<std::uint64_t>(since_epoch.count()) : 0;
+    }
+
+// Variables ===========================================================================================================
+
+private:
+    alignas(cache_line_size) std::atomic<std::uint64_t> state_{ 0 };
+    const std::uint64_t                                 node_;
+    const std::chrono::milliseconds                     epoch_;
+};
+
+}
+
+template<typename Tag, typename T>
+struct std::hash<open_cpp_utils::unique_id<Tag, T>>
+{
+    std::size_t operator()(open_cpp_utils::unique_id<Tag, T> id) const noexcept
+    {
+        return std::hash<T>{ }(id.value());
+    }
+};
+
+#endif // OPEN_CPP_UTILS_UNIQUE_ID_H
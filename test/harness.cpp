@@ -0,0 +1,96 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+namespace open_cpp_utils::test
+{
+
+namespace
+{
+
+struct entry
+{
+    const char* name;
+    test_fn     fn;
+};
+
+std::vector<entry>& registry()
+{
+    static std::vector<entry> entries;
+    return entries;
+}
+
+std::size_t g_failures = 0;
+
+bool matches(int argc, char** argv, const char* name)
+{
+    if(argc < 2) return true;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strstr(name, argv[i]) != nullptr) return true;
+    }
+    return false;
+}
+
+}
+
+int register_test(const char* name, test_fn fn)
+{
+    registry().push_back({ name, fn });
+    return 0;
+}
+
+void report_failure(const char* file, int line, const char* expr)
+{
+    ++g_failures;
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+}
+
+int run_main(int argc, char** argv)
+{
+    std::size_t ran = 0, failed = 0;
+    for(const entry& e : registry())
+    {
+        if(!matches(argc, argv, e.name)) continue;
+
+        const std::size_t before = g_failures;
+        try
+        {
+            e.fn();
+        }
+        catch(const require_failure&)
+        {
+        }
+        catch(const std::exception& ex)
+        {
+            report_failure(e.name, 0, ex.what());
+        }
+        catch(...)
+        {
+            report_failure(e.name, 0, "unknown exception");
+        }
+
+        ++ran;
+        const bool ok = g_failures == before;
+        if(!ok) ++failed;
+        std::printf("[%s] %s\n", ok ? "  OK  " : " FAIL ", e.name);
+    }
+
+    std::printf("%zu test(s), %zu failed\n", ran, failed);
+    return failed == 0 && ran != 0 ? 0 : 1;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    return open_cpp_utils::test::run_main(argc, argv);
+}
@@ -0,0 +1,75 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_TEST_HARNESS_H
+#define OPEN_CPP_UTILS_TEST_HARNESS_H
+
+namespace open_cpp_utils::test
+{
+
+using test_fn = void (*)();
+
+/**
+ * \brief Thrown by OCU_REQUIRE to abandon the current test case after a failed check.
+ */
+struct require_failure { };
+
+/**
+ * \brief Adds a test case to the global registry. Usually called through OCU_TEST.
+ */
+int register_test(const char* name, test_fn fn);
+
+/**
+ * \brief Records a failed check against the running test case and prints its location.
+ */
+void report_failure(const char* file, int line, const char* expr);
+
+/**
+ * \brief Runs every test case whose name contains one of the command line filters. Returns non-zero on failure.
+ */
+int run_main(int argc, char** argv);
+
+}
+
+#define OCU_TEST_CONCAT_IMPL(a, b) a##b
+#define OCU_TEST_CONCAT(a, b) OCU_TEST_CONCAT_IMPL(a, b)
+
+/**
+ * \brief Registers a test case with the given display name.
+ * \code
+ * OCU_TEST("object_pool/acquire_release") { OCU_CHECK(pool.size() == 1); }
+ * \endcode
+ */
+#define OCU_TEST(name)                                                                                                  \
+    static void OCU_TEST_CONCAT(ocu_test_fn_, __LINE__)();                                                            \
+    [[maybe_unused]] static const int OCU_TEST_CONCAT(ocu_test_reg_, __LINE__) =                                      \
+        ::open_cpp_utils::test::register_test(name, &OCU_TEST_CONCAT(ocu_test_fn_, __LINE__));                        \
+    static void OCU_TEST_CONCAT(ocu_test_fn_, __LINE__)()
+
+/// Records a failure and keeps running the test case.
+#define OCU_CHECK(expr)                                                                                                 \
+    do { if(!(expr)) ::open_cpp_utils::test::report_failure(__FILE__, __LINE__, #expr); } while(false)
+
+/// Records a failure and abandons the test case; for checks that later statements depend on.
+#define OCU_REQUIRE(expr)                                                                                               \
+    do                                                                                                                  \
+    {                                                                                                                   \
+        if(!(expr))                                                                                                     \
+        {                                                                                                               \
+            ::open_cpp_utils::test::report_failure(__FILE__, __LINE__, #expr);                                        \
+            throw ::open_cpp_utils::test::require_failure{ };                                                           \
+        }                                                                                                               \
+    } while(false)
+
+/// Checks that evaluating expr throws an exception of type (or derived from) ex.
+#define OCU_CHECK_THROWS(expr, ex)                                                                                      \
+    do                                                                                                                  \
+    {                                                                                                                   \
+        bool ocu_thrown_ = false;                                                                                       \
+        try { static_cast<void>(expr); } catch(const ex&) { ocu_thrown_ = true; }                                       \
+        if(!ocu_thrown_) ::open_cpp_utils::test::report_failure(__FILE__, __LINE__, #expr " throws " #ex);             \
+    } while(false)
+
+#endif // OPEN_CPP_UTILS_TEST_HARNESS_H
@@ -0,0 +1,32 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_TEST_SIMD_LEVELS_H
+#define OPEN_CPP_UTILS_TEST_SIMD_LEVELS_H
+
+#include <open-cpp-utils/cpu_features.h>
+
+#include <vector>
+
+namespace open_cpp_utils::test
+{
+
+/**
+ * \brief Every simd_level above scalar that this host can run, for differential tests of the kernel tables
+ */
+inline std::vector<simd_level> vector_levels()
+{
+    const simd_level host = host_simd_level();
+    if(host == simd_level::neon) return { simd_level::neon };
+
+    std::vector<simd_level> levels;
+    if(host >= simd_level::sse42) levels.push_back(simd_level::sse42);
+    if(host >= simd_level::avx2)  levels.push_back(simd_level::avx2);
+    return levels;
+}
+
+}
+
+#endif // OPEN_CPP_UTILS_TEST_SIMD_LEVELS_H
@@ -0,0 +1,50 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#ifndef OPEN_CPP_UTILS_TEST_TEMP_DIR_H
+#define OPEN_CPP_UTILS_TEST_TEMP_DIR_H
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <system_error>
+
+namespace open_cpp_utils::test
+{
+
+/// Fresh directory under the system temp path, removed with everything in it on destruction
+class temp_dir
+{
+public:
+    temp_dir()
+    {
+        std::random_device rd;
+        path_ = std::filesystem::temp_directory_path() / ("ocu_test_" + std::to_string(rd()) + std::to_string(rd()));
+        std::filesystem::create_directories(path_);
+    }
+
+    ~temp_dir()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    const std::filesystem::path& path() const noexcept { return path_; }
+
+    void write(const std::string& relative, const std::string& contents) const
+    {
+        const std::filesystem::path p = path_ / relative;
+        std::filesystem::create_directories(p.parent_path());
+        std::ofstream(p, std::ios::binary) << contents;
+    }
+
+private:
+    std::filesystem::path path_;
+};
+
+}
+
+#endif // OPEN_CPP_UTILS_TEST_TEMP_DIR_H
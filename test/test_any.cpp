@@ -0,0 +1,82 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/any.h>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+using open_cpp_utils::any;
+using open_cpp_utils::any_cast;
+using open_cpp_utils::bad_any_cast;
+using open_cpp_utils::type_id;
+
+OCU_TEST("any/holds_and_casts")
+{
+    any<> a = 42;
+    OCU_CHECK(a.has_value());
+    OCU_CHECK(a.holds<int>());
+    OCU_CHECK(!a.holds<long>());
+    OCU_CHECK(a.type() == type_id::of<int>());
+    OCU_CHECK(any_cast<int>(a) == 42);
+    OCU_CHECK(any_cast<long>(&a) == nullptr);
+    OCU_CHECK_THROWS(any_cast<double>(a), bad_any_cast);
+
+    a = std::string("text");
+    OCU_CHECK(any_cast<const std::string&>(a) == "text");
+    a.reset();
+    OCU_CHECK(!a.has_value());
+    OCU_CHECK(!a.type());
+}
+
+OCU_TEST("any/inline_and_heap_payloads")
+{
+    using big = std::array<char, 256>;
+    static_assert(any<32>::stores_inline<std::string>);
+    static_assert(!any<32>::stores_inline<big>);
+
+    big payload{ };
+    payload[200] = 'x';
+    any<32> heap = payload;
+    any<32> copy = heap;
+    any<32> moved = std::move(heap);
+    OCU_CHECK(any_cast<big&>(copy)[200] == 'x');
+    OCU_CHECK(any_cast<big&>(moved)[200] == 'x');
+
+    any<32> s = std::string(100, 's');
+    s.swap(moved);
+    OCU_CHECK(any_cast<std::string&>(moved).size() == 100);
+    OCU_CHECK(any_cast<big&>(s)[200] == 'x');
+}
+
+OCU_TEST("any/destroys_payloads")
+{
+    auto tracker = std::make_shared<int>(0);
+    {
+        any<> a = tracker;
+        any<> b = a;
+        any<> c = std::move(a);
+        OCU_CHECK(tracker.use_count() == 3);
+        b = 5;
+        OCU_CHECK(tracker.use_count() == 2);
+    }
+    OCU_CHECK(tracker.use_count() == 1);
+}
+
+OCU_TEST("any/emplace_and_make_any")
+{
+    any<> a;
+    auto& v = a.emplace<std::vector<int>>(3, 7);
+    OCU_CHECK(v.size() == 3);
+    OCU_CHECK(any_cast<std::vector<int>&>(a)[2] == 7);
+
+    auto b = open_cpp_utils::make_any<std::string>(4, 'q');
+    OCU_CHECK(any_cast<std::string>(b) == "qqqq");
+    OCU_CHECK(type_id::of<const std::string&>() == b.type());
+}
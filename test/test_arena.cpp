@@ -0,0 +1,92 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/arena.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+using open_cpp_utils::arena_allocator;
+using open_cpp_utils::arena_resource;
+using open_cpp_utils::inline_arena;
+using open_cpp_utils::monotonic_arena;
+
+OCU_TEST("arena/allocations_are_aligned_and_owned")
+{
+    monotonic_arena arena(256);
+    for(std::size_t align : { 1, 2, 8, 16, 64, 256 })
+    {
+        void* p = arena.allocate(align * 3 + 1, align);
+        OCU_CHECK(reinterpret_cast<std::uintptr_t>(p) % align == 0);
+        OCU_CHECK(arena.owns(p));
+    }
+
+    int local = 0;
+    OCU_CHECK(!arena.owns(&local));
+}
+
+OCU_TEST("arena/grows_past_block_size")
+{
+    monotonic_arena arena(128);
+    std::vector<int*> values;
+    for(int i = 0; i < 1000; ++i) values.push_back(arena.create<int>(i));
+    for(int i = 0; i < 1000; ++i) OCU_CHECK(*values[static_cast<std::size_t>(i)] == i);
+
+    void* big = arena.allocate(4096);
+    OCU_CHECK(arena.owns(big));
+    OCU_CHECK(arena.used() >= 1000 * sizeof(int) + 4096);
+}
+
+OCU_TEST("arena/reset_reuses_blocks")
+{
+    monotonic_arena arena(1024);
+    void* first = arena.allocate(100);
+    for(int i = 0; i < 100; ++i) static_cast<void>(arena.allocate(100));
+    const std::size_t capacity = arena.capacity();
+
+    arena.reset();
+    OCU_CHECK(arena.used() == 0);
+    OCU_CHECK(arena.allocate(100) == first);
+    for(int i = 0; i < 100; ++i) static_cast<void>(arena.allocate(100));
+    OCU_CHECK(arena.capacity() == capacity);
+
+    arena.release();
+    OCU_CHECK(arena.capacity() == 0);
+}
+
+OCU_TEST("arena/inline_storage_first")
+{
+    inline_arena<512> arena;
+    void* p = arena.allocate(64);
+    OCU_CHECK(reinterpret_cast<std::byte*>(p) >= reinterpret_cast<std::byte*>(&arena));
+    OCU_CHECK(reinterpret_cast<std::byte*>(p) <  reinterpret_cast<std::byte*>(&arena) + sizeof(arena));
+
+    for(int i = 0; i < 64; ++i) static_cast<void>(arena.allocate(64));
+    arena.release();
+    OCU_CHECK(arena.capacity() > 0);
+    OCU_CHECK(arena.allocate(64) == p);
+}
+
+OCU_TEST("arena/pmr_resource_and_allocator")
+{
+    monotonic_arena arena;
+    arena_resource  resource(arena);
+    arena_resource  same_arena(arena);
+
+    OCU_CHECK(resource.is_equal(resource));
+    OCU_CHECK(!resource.is_equal(same_arena));
+
+    std::pmr::vector<int> pv(&resource);
+    for(int i = 0; i < 100; ++i) pv.push_back(i);
+    OCU_CHECK(arena.owns(pv.data()));
+
+    std::vector<int, arena_allocator<int>> v{ arena_allocator<int>(arena) };
+    v.assign(50, 3);
+    OCU_CHECK(arena.owns(v.data()));
+    OCU_CHECK(v.get_allocator() == arena_allocator<long>(arena));
+}
@@ -0,0 +1,144 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+#include "simd_levels.h"
+
+#include <open-cpp-utils/bitset.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace open_cpp_utils;
+
+namespace
+{
+
+std::vector<std::uint64_t> random_words(std::mt19937_64& rng, std::size_t n)
+{
+    std::vector<std::uint64_t> w(n);
+    for(std::uint64_t& x : w) x = rng() & rng();
+    return w;
+}
+
+/// Bits set with probability density, to cover sparse, dense and empty select samples
+dynamic_bitset random_bits(std::mt19937_64& rng, std::size_t n, double density)
+{
+    std::bernoulli_distribution bit(density);
+    dynamic_bitset              b(n);
+    for(std::size_t i = 0; i < n; ++i) b.set(i, bit(rng));
+    return b;
+}
+
+}
+
+OCU_TEST("bitset/kernels_match_scalar")
+{
+    const detail::bitset_kernels& scalar = detail::bitset_kernels_for(simd_level::scalar);
+    std::mt19937_64               rng(5);
+
+    for(const simd_level level : test::vector_levels())
+    {
+        const detail::bitset_kernels& k = detail::bitset_kernels_for(level);
+        for(std::size_t n = 0; n < 70; ++n)
+        {
+            const std::vector<std::uint64_t> a = random_words(rng, n);
+            const std::vector<std::uint64_t> b = random_words(rng, n);
+
+            OCU_CHECK(k.popcount(a.data(), n) == scalar.popcount(a.data(), n));
+            OCU_CHECK(k.popcount_and(a.data(), b.data(), n) == scalar.popcount_and(a.data(), b.data(), n));
+
+            using op = void (*)(std::uint64_t*, const std::uint64_t*, std::size_t) noexcept;
+            const std::pair<op, op> ops[] = {
+                { k.bit_and, scalar.bit_and }, { k.bit_or, scalar.bit_or },
+                { k.bit_xor, scalar.bit_xor }, { k.bit_andnot, scalar.bit_andnot },
+            };
+            for(const auto& [vec, ref] : ops)
+            {
+                std::vector<std::uint64_t> x = a;
+                std::vector<std::uint64_t> y = a;
+                vec(x.data(), b.data(), n);
+                ref(y.data(), b.data(), n);
+                OCU_CHECK(x == y);
+            }
+        }
+    }
+}
+
+OCU_TEST("bitset/operations_match_vector_bool")
+{
+    std::mt19937_64      rng(9);
+    const dynamic_bitset a = random_bits(rng, 1000, 0.3);
+    const dynamic_bitset b = random_bits(rng, 700, 0.6);
+
+    const auto bit = [](const dynamic_bitset& s, std::size_t i) { return i < s.size() && s.test(i); };
+
+    const dynamic_bitset x = a & b;
+    const dynamic_bitset y = a | b;
+    const dynamic_bitset z = a ^ b;
+    dynamic_bitset       w = a;
+    w.and_not(b);
+
+    std::size_t both = 0;
+    for(std::size_t i = 0; i < a.size(); ++i)
+    {
+        OCU_CHECK(x.test(i) == (bit(a, i) && bit(b, i)));
+        OCU_CHECK(y.test(i) == (bit(a, i) || bit(b, i)));
+        OCU_CHECK(z.test(i) == (bit(a, i) != bit(b, i)));
+        OCU_CHECK(w.test(i) == (bit(a, i) && !bit(b, i)));
+        both += bit(a, i) && bit(b, i);
+    }
+    OCU_CHECK(a.count_and(b) == both);
+    OCU_CHECK(x.count() == both);
+    OCU_CHECK(x.is_subset_of(a));
+    OCU_CHECK(a.intersects(b) == (both != 0));
+
+    std::vector<std::size_t> visited;
+    x.for_each_set_bit([&](std::size_t i) { visited.push_back(i); });
+    OCU_REQUIRE(visited.size() == both);
+    for(std::size_t i = 0, pos = x.find_first(); i < visited.size(); ++i, pos = x.find_first(pos + 1))
+    {
+        OCU_CHECK(visited[i] == pos);
+    }
+
+    dynamic_bitset r(130);
+    r.set_range(3, 129);
+    OCU_CHECK(r.count() == 126 && !r.test(2) && r.test(128) && !r.test(129));
+    r.flip();
+    OCU_CHECK(r.count() == 4);
+}
+
+OCU_TEST("bitset/rank_select_match_naive")
+{
+    std::mt19937_64 rng(21);
+    for(const double density : { 0.0, 0.001, 0.05, 0.5, 0.97, 1.0 })
+    {
+        for(const std::size_t n : { std::size_t(0), std::size_t(1), std::size_t(2047), std::size_t(70001) })
+        {
+            const dynamic_bitset    bits = random_bits(rng, n, density);
+            const rank_select_index index(bits);
+
+            std::vector<std::size_t> ones;
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                if(bits.test(i)) ones.push_back(i);
+            }
+            OCU_REQUIRE(index.count() == ones.size());
+
+            std::size_t rank = 0;
+            for(std::size_t i = 0; i <= n; ++i)
+            {
+                if(index.rank(i) != rank) OCU_REQUIRE(index.rank(i) == rank);
+                if(i < n) rank += bits.test(i);
+            }
+            for(std::size_t k = 0; k < ones.size(); ++k)
+            {
+                if(index.select(k) != ones[k]) OCU_REQUIRE(index.select(k) == ones[k]);
+            }
+            OCU_CHECK(index.select(ones.size()) == rank_select_index::npos);
+        }
+    }
+}
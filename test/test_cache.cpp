@@ -0,0 +1,139 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/cache.h>
+
+#include <list>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+using open_cpp_utils::cache;
+using open_cpp_utils::cache_policy;
+using open_cpp_utils::concurrent_cache;
+
+namespace
+{
+
+/// Textbook LRU to compare against
+class reference_lru
+{
+public:
+    explicit reference_lru(std::size_t budget) : budget_(budget) { }
+
+    const int* find(int key)
+    {
+        auto it = index_.find(key);
+        if(it == index_.end()) return nullptr;
+        order_.splice(order_.begin(), order_, it->second);
+        return &it->second->second;
+    }
+
+    void insert(int key, int value)
+    {
+        if(auto it = index_.find(key); it != index_.end())
+        {
+            it->second->second = value;
+            order_.splice(order_.begin(), order_, it->second);
+            return;
+        }
+        order_.emplace_front(key, value);
+        index_[key] = order_.begin();
+        if(order_.size() > budget_)
+        {
+            index_.erase(order_.back().first);
+            order_.pop_back();
+        }
+    }
+
+private:
+    std::size_t                                                     budget_;
+    std::list<std::pair<int, int>>                                  order_;
+    std::unordered_map<int, std::list<std::pair<int, int>>::iterator> index_;
+};
+
+struct length_cost
+{
+    std::size_t operator()(int, const std::string& v) const noexcept { return v.size(); }
+};
+
+}
+
+OCU_TEST("cache/lru_matches_reference")
+{
+    cache<int, int> lru(64);
+    reference_lru   ref(64);
+    std::mt19937    rng(2);
+
+    for(int i = 0; i < 50000; ++i)
+    {
+        const int key = static_cast<int>(rng() % 200);
+        if(rng() % 2)
+        {
+            const int* a = lru.find(key);
+            const int* b = ref.find(key);
+            OCU_REQUIRE((a == nullptr) == (b == nullptr));
+            if(a != nullptr) OCU_CHECK(*a == *b);
+        }
+        else
+        {
+            lru.insert(key, i);
+            ref.insert(key, i);
+        }
+    }
+    OCU_CHECK(lru.size() == 64);
+    OCU_CHECK(lru.stats().hits + lru.stats().misses > 0);
+}
+
+OCU_TEST("cache/cost_budget_is_respected")
+{
+    cache<int, std::string, length_cost> c(100);
+    for(int i = 0; i < 100; ++i) c.insert(i, std::string(static_cast<std::size_t>(i % 30), 'x'));
+    OCU_CHECK(c.cost() <= 100);
+
+    // An entry costlier than the whole budget is rejected rather than evicting everything
+    OCU_CHECK(c.insert(1000, std::string(101, 'x')) == nullptr);
+    OCU_CHECK(c.stats().rejections >= 1);
+
+    c.set_budget(10);
+    OCU_CHECK(c.cost() <= 10);
+    c.clear();
+    OCU_CHECK(c.size() == 0 && c.cost() == 0);
+}
+
+OCU_TEST("cache/tiny_lfu_keeps_frequent_keys_through_a_scan")
+{
+    cache<int, int> c(100, cache_policy::tiny_lfu);
+
+    for(int round = 0; round < 20; ++round)
+    {
+        for(int k = 0; k < 50; ++k)
+        {
+            if(c.find(k) == nullptr) c.insert(k, k);
+        }
+    }
+    for(int k = 1000; k < 11000; ++k)
+    {
+        if(c.find(k) == nullptr) c.insert(k, k);
+    }
+
+    int kept = 0;
+    for(int k = 0; k < 50; ++k) kept += c.contains(k);
+    OCU_CHECK(kept >= 45);
+    OCU_CHECK(c.size() <= 100);
+}
+
+OCU_TEST("cache/concurrent_cache_get_or_insert")
+{
+    concurrent_cache<int, int> c(1000);
+    int                        made = 0;
+    OCU_CHECK(c.get_or_insert(5, [&] { ++made; return 50; }) == 50);
+    OCU_CHECK(c.get_or_insert(5, [&] { ++made; return 51; }) == 50);
+    OCU_CHECK(made == 1);
+    OCU_CHECK(c.find(5) == 50);
+    OCU_CHECK(c.erase(5) && !c.contains(5));
+}
@@ -0,0 +1,104 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/concurrent_hash_map.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using open_cpp_utils::concurrent_hash_map;
+
+OCU_TEST("concurrent_hash_map/single_thread_matches_unordered_map")
+{
+    concurrent_hash_map<std::uint64_t, std::uint64_t, open_cpp_utils::hash<std::uint64_t>,
+                        std::equal_to<std::uint64_t>, 4> map;
+    std::unordered_map<std::uint64_t, std::uint64_t> ref;
+
+    for(std::uint64_t i = 0; i < 20000; ++i)
+    {
+        const std::uint64_t key = (i * 2654435761u) % 4096;
+        switch(i % 4)
+        {
+        case 0:
+        case 1:
+            OCU_CHECK(map.insert_or_assign(key, i) == (ref.insert_or_assign(key, i).second));
+            break;
+        case 2:
+            OCU_CHECK(map.erase(key) == (ref.erase(key) == 1));
+            break;
+        default:
+            OCU_CHECK(map.update(key, [](std::uint64_t& v) { ++v; }) == ref.contains(key));
+            if(auto it = ref.find(key); it != ref.end()) ++it->second;
+            break;
+        }
+    }
+
+    OCU_REQUIRE(map.size() == ref.size());
+    for(const auto& [key, value] : ref)
+    {
+        const auto found = map.find(key);
+        OCU_REQUIRE(found.has_value());
+        OCU_CHECK(*found == value);
+    }
+
+    std::size_t seen = 0;
+    map.for_each_shard([&](auto& shard)
+    {
+        shard.for_each([&](std::uint64_t key, std::uint64_t value)
+        {
+            ++seen;
+            OCU_CHECK(ref.at(key) == value);
+        });
+    });
+    OCU_CHECK(seen == ref.size());
+
+    map.clear();
+    OCU_CHECK(map.empty() && !map.contains(ref.begin()->first));
+}
+
+OCU_TEST("concurrent_hash_map/find_or_emplace_inserts_once")
+{
+    concurrent_hash_map<int, int> map;
+    OCU_CHECK(map.find_or_emplace(7, 1) == std::pair(1, true));
+    OCU_CHECK(map.find_or_emplace(7, 2) == std::pair(1, false));
+
+    std::size_t erased = 0;
+    map.for_each_shard([&](auto& shard) { erased += shard.erase_if([](int, int v) { return v == 1; }); });
+    OCU_CHECK(erased == 1 && map.empty());
+}
+
+OCU_TEST("concurrent_hash_map/readers_see_consistent_values_during_growth")
+{
+    constexpr std::uint32_t count = 20000;
+
+    concurrent_hash_map<std::uint32_t, std::uint64_t> map;
+    std::atomic<bool>                                 done{ false };
+    std::atomic<std::size_t>                          torn{ 0 };
+
+    // Every value encodes its key in both halves, so a reader racing a resize would see a mismatch
+    std::thread reader([&]
+    {
+        while(!done.load(std::memory_order_acquire))
+        {
+            for(std::uint32_t k = 0; k < count; k += 97)
+            {
+                if(const auto v = map.find(k); v && (*v >> 32) != (*v & 0xffffffffu)) torn.fetch_add(1);
+            }
+        }
+    });
+
+    for(std::uint32_t k = 0; k < count; ++k) map.insert_or_assign(k, (std::uint64_t(k) << 32) | k);
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    OCU_CHECK(torn.load() == 0);
+    OCU_CHECK(map.size() == count);
+    for(std::uint32_t k = 0; k < count; k += 13) OCU_CHECK(map.find(k) == (std::uint64_t(k) << 32 | k));
+}
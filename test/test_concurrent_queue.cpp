@@ -0,0 +1,275 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/concurrent_queue.h>
+
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using open_cpp_utils::mpmc_queue;
+using open_cpp_utils::spsc_queue;
+
+namespace
+{
+
+/// Throws from construction with a negative value and from move assignment while fail_assign is set
+struct fragile
+{
+    static inline bool fail_assign = false;
+
+    explicit fragile(int v) : value(v) { if(v < 0) throw std::runtime_error("fragile: negative"); }
+    fragile(fragile&& other) noexcept : value(other.value) { }
+
+    fragile& operator=(fragile&& other)
+    {
+        if(fail_assign) throw std::runtime_error("fragile: assignment");
+        value = other.value;
+        return *this;
+    }
+
+    int value;
+};
+
+/// Output iterator that throws on the assignment numbered fail_at
+struct throwing_output
+{
+    using difference_type = std::ptrdiff_t;
+
+    throwing_output& operator*() { return *this; }
+    throwing_output& operator++() { return *this; }
+    throwing_output  operator++(int) { return *this; }
+
+    throwing_output& operator=(int v)
+    {
+        if((*written)++ == fail_at) throw std::runtime_error("throwing_output");
+        sink->push_back(v);
+        return *this;
+    }
+
+    std::vector<int>* sink;
+    int*              written;
+    int               fail_at;
+};
+
+/// Input iterator over 0, 1, 2, ... that throws when dereferenced at fail_at
+struct throwing_input
+{
+    using difference_type = std::ptrdiff_t;
+    using value_type      = int;
+
+    int operator*() const
+    {
+        if(i == fail_at) throw std::runtime_error("throwing_input");
+        return i;
+    }
+    throwing_input& operator++() { ++i; return *this; }
+
+    int i;
+    int fail_at;
+};
+
+static_assert(noexcept(std::declval<mpmc_queue<int>&>().try_pop()));
+static_assert(noexcept(std::declval<mpmc_queue<int>&>().try_push_n(std::declval<int*>(), 1)));
+static_assert(!noexcept(std::declval<mpmc_queue<int>&>().try_pop_n(std::declval<throwing_output>(), 1)));
+static_assert(!noexcept(std::declval<mpmc_queue<int>&>().try_push_n(std::declval<throwing_input>(), 1)));
+static_assert(!noexcept(std::declval<mpmc_queue<fragile>&>().try_emplace(1)));
+static_assert(!noexcept(std::declval<mpmc_queue<fragile>&>().try_pop(std::declval<fragile&>())));
+static_assert(!noexcept(std::declval<spsc_queue<int>&>().try_pop_n(std::declval<throwing_output>(), 1)));
+
+}
+
+OCU_TEST("concurrent_queue/mpmc_fifo_and_bounds")
+{
+    mpmc_queue<int> q(3);
+    OCU_CHECK(q.capacity() == 4);
+    for(int i = 0; i < 4; ++i) OCU_CHECK(q.try_push(i));
+    OCU_CHECK(!q.try_push(99));
+    OCU_CHECK(q.size_approx() == 4);
+
+    int v = -1;
+    for(int i = 0; i < 4; ++i)
+    {
+        OCU_CHECK(q.try_pop(v));
+        OCU_CHECK(v == i);
+    }
+    OCU_CHECK(!q.try_pop(v));
+    OCU_CHECK(!q.try_pop().has_value());
+    OCU_CHECK(q.empty_approx());
+}
+
+OCU_TEST("concurrent_queue/mpmc_batches")
+{
+    mpmc_queue<int> q(8);
+    const int in[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    OCU_CHECK(q.try_push_n(in, 10) == 8);
+
+    std::vector<int> out;
+    OCU_CHECK(q.try_pop_n(std::back_inserter(out), 5) == 5);
+    OCU_CHECK(q.try_push_n(in + 8, 2) == 2);
+    OCU_CHECK(q.try_pop_n(std::back_inserter(out), 100) == 5);
+    OCU_CHECK(out == (std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+}
+
+OCU_TEST("concurrent_queue/mpmc_destroys_remaining_elements")
+{
+    auto tracker = std::make_shared<int>(0);
+    {
+        mpmc_queue<std::shared_ptr<int>> q(8);
+        for(int i = 0; i < 5; ++i) OCU_CHECK(q.try_push(tracker));
+        OCU_CHECK(tracker.use_count() == 6);
+        static_cast<void>(q.try_pop());
+        OCU_CHECK(tracker.use_count() == 5);
+    }
+    OCU_CHECK(tracker.use_count() == 1);
+}
+
+OCU_TEST("concurrent_queue/mpmc_many_threads_deliver_everything_once")
+{
+    constexpr int producers = 4, consumers = 4, per_producer = 5000;
+    mpmc_queue<std::uint32_t> q(256);
+    std::vector<std::atomic<int>> seen(producers * per_producer);
+    std::atomic<int> consumed{ 0 };
+    std::vector<std::thread> threads;
+
+    for(int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&, p]
+        {
+            for(int i = 0; i < per_producer; ++i)
+            {
+                const auto v = static_cast<std::uint32_t>(p * per_producer + i);
+                while(!q.try_push(v)) std::this_thread::yield();
+            }
+        });
+    }
+    for(int c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&]
+        {
+            std::uint32_t batch[16];
+            while(consumed.load(std::memory_order_relaxed) < producers * per_producer)
+            {
+                const std::size_t n = q.try_pop_n(batch, 16);
+                for(std::size_t i = 0; i < n; ++i) seen[batch[i]].fetch_add(1, std::memory_order_relaxed);
+                consumed.fetch_add(static_cast<int>(n), std::memory_order_relaxed);
+                if(n == 0) std::this_thread::yield();
+            }
+        });
+    }
+    for(auto& t : threads) t.join();
+
+    for(const auto& s : seen) OCU_REQUIRE(s.load() == 1);
+}
+
+OCU_TEST("concurrent_queue/spsc_fifo_and_batches")
+{
+    spsc_queue<int> q(4);
+    for(int i = 0; i < 4; ++i) OCU_CHECK(q.try_push(i));
+    OCU_CHECK(!q.try_push(4));
+    OCU_REQUIRE(q.peek() != nullptr);
+    OCU_CHECK(*q.peek() == 0);
+    q.pop();
+
+    int out[4] = { };
+    OCU_CHECK(q.try_pop_n(out, 4) == 3);
+    OCU_CHECK(out[0] == 1 && out[2] == 3);
+
+    const int in[6] = { 10, 11, 12, 13, 14, 15 };
+    OCU_CHECK(q.try_push_n(in, 6) == 4);
+    OCU_CHECK(q.size_approx() == 4);
+    OCU_CHECK(q.try_pop() == 10);
+}
+
+OCU_TEST("concurrent_queue/spsc_producer_consumer_threads")
+{
+    constexpr std::uint64_t count = 20000;
+    spsc_queue<std::uint64_t> q(64);
+
+    std::thread producer([&]
+    {
+        for(std::uint64_t i = 0; i < count; ++i)
+        {
+            while(!q.try_push(i)) std::this_thread::yield();
+        }
+    });
+
+    std::uint64_t expected = 0;
+    while(expected < count)
+    {
+        if(auto v = q.try_pop())
+        {
+            OCU_REQUIRE(*v == expected);
+            ++expected;
+        }
+    }
+    producer.join();
+    OCU_CHECK(q.empty_approx());
+}
+
+OCU_TEST("concurrent_queue/mpmc_throwing_constructor_leaves_queue_usable")
+{
+    mpmc_queue<fragile> q(2);
+    OCU_CHECK_THROWS(q.try_emplace(-1), std::runtime_error);
+    OCU_CHECK(q.empty_approx());
+
+    OCU_CHECK(q.try_emplace(1));
+    OCU_CHECK(q.try_emplace(2));
+    OCU_CHECK(!q.try_emplace(3));
+    OCU_CHECK(q.try_pop()->value == 1);
+    OCU_CHECK(q.try_pop()->value == 2);
+}
+
+OCU_TEST("concurrent_queue/mpmc_throwing_assignment_releases_the_cell")
+{
+    mpmc_queue<fragile> q(2);
+    OCU_CHECK(q.try_emplace(1));
+    OCU_CHECK(q.try_emplace(2));
+
+    fragile out(0);
+    fragile::fail_assign = true;
+    OCU_CHECK_THROWS(q.try_pop(out), std::runtime_error);
+    fragile::fail_assign = false;
+
+    // The value being assigned is lost, but its cell is free again
+    OCU_CHECK(q.try_pop(out) && out.value == 2);
+    OCU_CHECK(q.try_emplace(3));
+    OCU_CHECK(q.try_emplace(4));
+    OCU_CHECK(q.try_pop()->value == 3);
+    OCU_CHECK(q.try_pop()->value == 4);
+}
+
+OCU_TEST("concurrent_queue/throwing_iterators_leave_queues_usable")
+{
+    mpmc_queue<int> mpmc(8);
+    OCU_CHECK_THROWS(mpmc.try_push_n(throwing_input{ 0, 3 }, 5), std::runtime_error);
+    OCU_CHECK(mpmc.size_approx() == 3);
+
+    std::vector<int> got;
+    int              written = 0;
+    OCU_CHECK_THROWS(mpmc.try_pop_n(throwing_output{ &got, &written, 1 }, 3), std::runtime_error);
+    OCU_CHECK(got == std::vector<int>{ 0 });
+    OCU_CHECK(mpmc.try_pop() == 2);
+    for(int i = 0; i < 8; ++i) OCU_CHECK(mpmc.try_push(i));
+    OCU_CHECK(!mpmc.try_push(8));
+
+    spsc_queue<int> spsc(8);
+    OCU_CHECK_THROWS(spsc.try_push_n(throwing_input{ 0, 3 }, 5), std::runtime_error);
+    OCU_CHECK(spsc.size_approx() == 3);
+
+    got.clear();
+    written = 0;
+    OCU_CHECK_THROWS(spsc.try_pop_n(throwing_output{ &got, &written, 1 }, 3), std::runtime_error);
+    OCU_CHECK(got == std::vector<int>{ 0 });
+    OCU_CHECK(spsc.size_approx() == 2);
+    OCU_CHECK(spsc.try_pop() == 1);
+    OCU_CHECK(spsc.try_pop() == 2);
+}
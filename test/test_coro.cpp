@@ -0,0 +1,168 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+#include "temp_dir.h"
+
+#include <open-cpp-utils/coro.h>
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace open_cpp_utils;
+
+namespace
+{
+
+task<int> leaf(int x)
+{
+    co_return x * 3 + 1;
+}
+
+task<int> chain(int n)
+{
+    int sum = 0;
+    for(int i = 0; i < n; ++i) sum += co_await leaf(i);
+    co_return sum;
+}
+
+task<int> chain(std::allocator_arg_t, monotonic_arena&, int n)
+{
+    int sum = 0;
+    for(int i = 0; i < n; ++i) sum += co_await leaf(i);
+    co_return sum;
+}
+
+task<int> throws_after(int n)
+{
+    co_await leaf(n);
+    throw std::runtime_error("task failed");
+}
+
+task<std::thread::id> on_pool(thread_pool& pool)
+{
+    co_await schedule_on(pool);
+    co_return std::this_thread::get_id();
+}
+
+using sleep_wheel = timer_wheel<std::function<void()>>;
+
+task<void> sleeper(sleep_wheel& wheel, std::vector<int>& order, int delay)
+{
+    co_await sleep_for(wheel, static_cast<std::uint64_t>(delay));
+    order.push_back(delay);
+}
+
+/// Fires every timer due by target, resuming the sleepers on this thread
+task<void> clock(sleep_wheel& wheel, std::uint64_t target)
+{
+    wheel.advance_to(target);
+    co_return;
+}
+
+generator<int> squares(int n)
+{
+    for(int i = 0; i < n; ++i) co_yield i * i;
+}
+
+generator<int> broken()
+{
+    co_yield 1;
+    throw std::logic_error("generator failed");
+}
+
+int sum(generator<int> values)
+{
+    int total = 0;
+    for(const int v : values) total += v;
+    return total;
+}
+
+}
+
+OCU_TEST("coro/tasks_nest_and_return_values")
+{
+    thread_pool pool(2);
+    OCU_CHECK(sync_wait(chain(1000), pool) == 1000 * 999 / 2 * 3 + 1000);
+
+    monotonic_arena arena;
+    OCU_CHECK(sync_wait(chain(std::allocator_arg, arena, 10), pool) == 145);
+}
+
+OCU_TEST("coro/exceptions_reach_the_awaiter")
+{
+    thread_pool pool(2);
+    OCU_CHECK_THROWS(sync_wait(throws_after(3), pool), std::runtime_error);
+
+    std::vector<task<int>> tasks;
+    tasks.push_back(leaf(1));
+    tasks.push_back(throws_after(2));
+    OCU_CHECK_THROWS(sync_wait(when_all(std::move(tasks)), pool), std::runtime_error);
+}
+
+OCU_TEST("coro/when_all_keeps_argument_order")
+{
+    thread_pool pool(2);
+
+    std::vector<task<int>> tasks;
+    for(int i = 0; i < 64; ++i) tasks.push_back(leaf(i));
+    const std::vector<int> results = sync_wait(when_all(std::move(tasks)), pool);
+    OCU_REQUIRE(results.size() == 64);
+    for(int i = 0; i < 64; ++i) OCU_CHECK(results[static_cast<std::size_t>(i)] == i * 3 + 1);
+
+    const auto [a, b] = sync_wait(when_all(leaf(1), on_pool(pool)), pool);
+    OCU_CHECK(a == 4);
+    OCU_CHECK(b != std::thread::id());
+}
+
+OCU_TEST("coro/generator_yields_lazily")
+{
+    std::vector<int> values;
+    for(const int v : squares(5)) values.push_back(v);
+    OCU_CHECK(values == (std::vector<int>{ 0, 1, 4, 9, 16 }));
+    OCU_CHECK(sum(squares(100)) == 328350);
+
+    OCU_CHECK_THROWS(sum(broken()), std::logic_error);
+}
+
+OCU_TEST("coro/sleep_resumes_from_the_wheel")
+{
+    thread_pool      pool(1);
+    sleep_wheel      wheel;
+    std::vector<int> order;
+
+    // when_all starts its tasks in order on this thread, so the sleepers are all waiting when the clock runs
+    sync_wait(when_all(sleeper(wheel, order, 30), sleeper(wheel, order, 10), sleeper(wheel, order, 20),
+                       clock(wheel, 100)), pool);
+
+    OCU_CHECK(order == (std::vector<int>{ 10, 20, 30 }));
+    OCU_CHECK(wheel.empty());
+}
+
+OCU_TEST("coro/async_file_round_trip")
+{
+    test::temp_dir dir;
+    thread_pool    pool(2);
+    io_queue_options options;
+    options.pool = &pool;
+    io_queue queue(options);
+
+    const std::string text(10000, 'x');
+    const auto        body = [&]() -> task<std::size_t>
+    {
+        async_file out(queue, dir.path() / "f.bin", file_mode::write | file_mode::create);
+        co_await async_write(out, 0, std::as_bytes(std::span(text)));
+
+        std::vector<std::byte> buffer(text.size());
+        async_file             in(queue, dir.path() / "f.bin");
+        co_return co_await async_read(in, 0, buffer);
+    };
+    OCU_CHECK(sync_wait(body(), pool) == text.size());
+}
@@ -0,0 +1,153 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/directed_tree.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+using open_cpp_utils::directed_tree;
+using open_cpp_utils::tree_node;
+
+namespace
+{
+
+/// a has children b, c, d; b has children e, f; d has child g. c is inserted before d to cover emplace_before.
+struct sample
+{
+    directed_tree<char> tree;
+    tree_node a, b, c, d, e, f, g;
+
+    sample()
+    {
+        a = tree.emplace_root('a');
+        b = tree.emplace_child(a, 'b');
+        d = tree.emplace_child(a, 'd');
+        c = tree.emplace_before(d, 'c');
+        e = tree.emplace_child(b, 'e');
+        f = tree.emplace_child(b, 'f');
+        g = tree.emplace_child(d, 'g');
+    }
+
+    template<typename Range>
+    std::string walk(const Range& range) const
+    {
+        std::string s;
+        for(tree_node n : range) s += tree[n];
+        return s;
+    }
+};
+
+}
+
+OCU_TEST("directed_tree/traversal_orders")
+{
+    sample s;
+    OCU_CHECK(s.tree.size() == 7);
+    OCU_CHECK(s.walk(s.tree.preorder())      == "abefcdg");
+    OCU_CHECK(s.walk(s.tree.postorder())     == "efbcgda");
+    OCU_CHECK(s.walk(s.tree.breadth_first()) == "abcdefg");
+    OCU_CHECK(s.walk(s.tree.children(s.a))   == "bcd");
+    OCU_CHECK(s.walk(s.tree.preorder(s.b))   == "bef");
+    OCU_CHECK(s.walk(s.tree.postorder(s.d))  == "gd");
+}
+
+OCU_TEST("directed_tree/links_and_depth")
+{
+    sample s;
+    OCU_CHECK(s.tree.root() == s.a);
+    OCU_CHECK(s.tree.parent(s.e) == s.b);
+    OCU_CHECK(!s.tree.parent(s.a));
+    OCU_CHECK(s.tree.next_sibling(s.b) == s.c);
+    OCU_CHECK(s.tree.prev_sibling(s.d) == s.c);
+    OCU_CHECK(s.tree.last_child(s.a) == s.d);
+    OCU_CHECK(s.tree.depth(s.g) == 2);
+    OCU_CHECK(s.tree.is_leaf(s.c));
+    OCU_CHECK(s.tree.is_ancestor_of(s.a, s.f));
+    OCU_CHECK(!s.tree.is_ancestor_of(s.c, s.f));
+}
+
+OCU_TEST("directed_tree/erase_subtree_and_reuse")
+{
+    sample s;
+    OCU_CHECK(s.tree.erase(s.b) == 3);
+    OCU_CHECK(s.tree.size() == 4);
+    OCU_CHECK(!s.tree.contains(s.e));
+    OCU_CHECK(s.walk(s.tree.preorder()) == "acdg");
+
+    const std::size_t capacity = s.tree.capacity();
+    auto h = s.tree.emplace_child(s.c, 'h');
+    auto i = s.tree.emplace_child(s.c, 'i');
+    OCU_CHECK(s.tree.capacity() == capacity);
+    OCU_CHECK(s.tree.depth(i) == 2);
+    OCU_CHECK(s.walk(s.tree.preorder()) == "achidg");
+    static_cast<void>(h);
+}
+
+OCU_TEST("directed_tree/reparent_updates_depths")
+{
+    sample s;
+    s.tree.reparent(s.b, s.g);
+    OCU_CHECK(s.walk(s.tree.preorder()) == "acdgbef");
+    OCU_CHECK(s.tree.depth(s.b) == 3);
+    OCU_CHECK(s.tree.depth(s.f) == 4);
+}
+
+OCU_TEST("directed_tree/compact_renumbers_in_preorder")
+{
+    sample s;
+    s.tree.erase(s.c);
+    const std::string before = s.walk(s.tree.preorder());
+    const auto remap = s.tree.compact();
+
+    OCU_CHECK(s.walk(s.tree.preorder()) == before);
+    OCU_CHECK(!remap[s.c.index()]);
+    OCU_CHECK(s.tree[remap[s.g.index()]] == 'g');
+
+    tree_node::value_type expected = 0;
+    for(tree_node n : s.tree.preorder()) OCU_CHECK(n.index() == expected++);
+
+    // Filling the freed capacity after compact() must not outgrow the link arrays
+    for(int k = 0; k < 100; ++k) s.tree.emplace_child(s.tree.root(), 'z');
+    OCU_CHECK(s.tree.size() == 106);
+}
+
+OCU_TEST("directed_tree/random_edits_keep_structure_consistent")
+{
+    directed_tree<int> tree;
+    std::vector<tree_node> live{ tree.emplace_root(0) };
+    std::mt19937 rng(3);
+
+    for(int step = 1; step < 3000; ++step)
+    {
+        const tree_node pick = live[rng() % live.size()];
+        if(rng() % 4 != 0 || pick == tree.root())
+        {
+            live.push_back(tree.emplace_child(pick, step));
+        }
+        else
+        {
+            tree.erase(pick);
+            std::erase_if(live, [&](tree_node n) { return !tree.contains(n); });
+        }
+        if(step % 500 == 0)
+        {
+            const auto remap = tree.compact();
+            for(auto& n : live) n = remap[n.index()];
+        }
+    }
+
+    std::size_t visited = 0;
+    for(tree_node n : tree.preorder())
+    {
+        ++visited;
+        if(n != tree.root()) OCU_CHECK(tree.depth(n) == tree.depth(tree.parent(n)) + 1);
+    }
+    OCU_CHECK(visited == tree.size());
+    OCU_CHECK(visited == live.size());
+}
@@ -0,0 +1,188 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+#include "temp_dir.h"
+
+#include <open-cpp-utils/filesystem.h>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using open_cpp_utils::async_file;
+using open_cpp_utils::directory_snapshot;
+using open_cpp_utils::file_mode;
+using open_cpp_utils::io_backend;
+using open_cpp_utils::io_queue;
+using open_cpp_utils::io_queue_options;
+using open_cpp_utils::mapped_file;
+using open_cpp_utils::scan_directory;
+using open_cpp_utils::scan_entry;
+using open_cpp_utils::thread_pool;
+using open_cpp_utils::test::temp_dir;
+
+namespace
+{
+
+std::vector<std::string> sorted_paths(const std::vector<scan_entry>& entries)
+{
+    std::vector<std::string> paths;
+    for(const auto& e : entries) paths.push_back(e.path);
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+void check_round_trip(io_backend backend)
+{
+    temp_dir dir;
+    thread_pool pool(2);
+    io_queue_options options;
+    options.depth   = 8;
+    options.backend = backend;
+    options.pool    = &pool;
+
+    std::vector<std::byte> data(64 * 1024);
+    for(std::size_t i = 0; i < data.size(); ++i) data[i] = static_cast<std::byte>(i * 31);
+
+    {
+        io_queue queue(options);
+        async_file out(queue, dir.path() / "data.bin", file_mode::write | file_mode::create | file_mode::truncate);
+
+        // More writes than the queue depth, so the queue has to recycle slots
+        for(std::size_t off = 0; off < data.size(); off += 1024)
+        {
+            out.write(off, std::span<const std::byte>(data).subspan(off, 1024), [](std::error_code ec, std::size_t n)
+            {
+                OCU_CHECK(!ec);
+                OCU_CHECK(n == 1024);
+            });
+        }
+        queue.drain();
+    }
+
+    io_queue queue(options);
+    async_file in(queue, dir.path() / "data.bin");
+    OCU_CHECK(in.size() == data.size());
+
+    std::vector<std::byte> back(data.size());
+    std::vector<std::future<std::size_t>> reads;
+    for(std::size_t off = 0; off < back.size(); off += 4096)
+    {
+        reads.push_back(in.read(off, std::span<std::byte>(back).subspan(off, 4096)));
+    }
+    queue.submit();
+    for(auto& r : reads)
+    {
+        queue.drain();
+        OCU_CHECK(r.get() == 4096);
+    }
+    OCU_CHECK(back == data);
+}
+
+}
+
+OCU_TEST("filesystem/mapped_file_reads_contents")
+{
+    temp_dir dir;
+    dir.write("text.txt", "hello mapped world");
+
+    mapped_file file(dir.path() / "text.txt");
+    OCU_CHECK(file.is_mapped());
+    OCU_CHECK(file.text() == "hello mapped world");
+    OCU_CHECK(file.view(6, 6).size() == 6);
+    OCU_CHECK(file.advise(open_cpp_utils::access_pattern::sequential));
+
+    file.close();
+    OCU_CHECK(!file.is_mapped());
+
+    std::error_code ec;
+    file.open(dir.path() / "missing.txt", open_cpp_utils::access_pattern::normal, ec);
+    OCU_CHECK(ec);
+    OCU_CHECK_THROWS(mapped_file(dir.path() / "missing.txt"), std::system_error);
+}
+
+OCU_TEST("filesystem/async_file_round_trip_worker_threads")
+{
+    check_round_trip(io_backend::worker_threads);
+}
+
+OCU_TEST("filesystem/async_file_round_trip_automatic")
+{
+    check_round_trip(io_backend::automatic);
+}
+
+OCU_TEST("filesystem/async_file_reports_errors")
+{
+    temp_dir dir;
+    io_queue queue;
+    std::error_code ec;
+    async_file missing(queue, dir.path() / "missing.bin", file_mode::read, ec);
+    OCU_CHECK(ec);
+    OCU_CHECK(!missing.is_open());
+}
+
+OCU_TEST("filesystem/scan_directory_lists_tree")
+{
+    temp_dir dir;
+    dir.write("a.txt", "1");
+    dir.write("sub/b.txt", "22");
+    dir.write("sub/deeper/c.txt", "333");
+
+    thread_pool pool(2);
+    open_cpp_utils::scan_options options;
+    options.pool = &pool;
+    const auto entries = scan_directory(dir.path(), options);
+    OCU_CHECK(sorted_paths(entries) == (std::vector<std::string>{
+        "a.txt", "sub", "sub/b.txt", "sub/deeper", "sub/deeper/c.txt" }));
+
+    for(const auto& e : entries)
+    {
+        if(e.path == "sub/deeper/c.txt") OCU_CHECK(e.size == 3 && e.type == open_cpp_utils::entry_type::file);
+        if(e.path == "sub")              OCU_CHECK(e.type == open_cpp_utils::entry_type::directory);
+    }
+
+    options.recursive = false;
+    OCU_CHECK(sorted_paths(scan_directory(dir.path(), options)) == (std::vector<std::string>{ "a.txt", "sub" }));
+
+    std::error_code ec;
+    static_cast<void>(scan_directory(dir.path() / "missing", options, ec));
+    OCU_CHECK(ec);
+}
+
+OCU_TEST("filesystem/snapshot_diff_and_persistence")
+{
+    temp_dir dir;
+    dir.write("keep.txt", "same");
+    dir.write("edit.txt", "before");
+    dir.write("drop.txt", "gone soon");
+
+    const directory_snapshot before(scan_directory(dir.path()));
+    OCU_CHECK(before.size() == 3);
+
+    const fs::path saved = dir.path() / "snapshot.bin";
+    before.save(saved);
+    directory_snapshot loaded;
+    loaded.load(saved);
+    OCU_CHECK(loaded.size() == before.size());
+
+    dir.write("edit.txt", "after, and longer");
+    dir.write("new.txt", "fresh");
+    fs::remove(dir.path() / "drop.txt");
+    fs::remove(saved);
+
+    const auto now     = scan_directory(dir.path());
+    const auto changes = loaded.diff(now);
+    OCU_REQUIRE(changes.added.size() == 1 && changes.modified.size() == 1);
+    OCU_CHECK(now[changes.added[0]].path == "new.txt");
+    OCU_CHECK(now[changes.modified[0]].path == "edit.txt");
+    OCU_CHECK(changes.removed.size() == 1);
+    OCU_CHECK(directory_snapshot(now).diff(now).empty());
+}
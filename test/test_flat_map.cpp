@@ -0,0 +1,225 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/flat_map.h>
+
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using open_cpp_utils::flat_map;
+using open_cpp_utils::flat_set;
+
+namespace
+{
+
+/// Key whose copies and moves throw once budget reaches zero; a negative budget never throws
+struct brittle
+{
+    static inline int budget = -1;
+
+    int v;
+
+    brittle(int value) : v(value) { }
+    brittle(const brittle& o) : v(o.v) { spend(); }
+    brittle(brittle&& o) : v(o.v) { spend(); o.v = -1; }
+    brittle& operator=(const brittle& o) { spend(); v = o.v; return *this; }
+    brittle& operator=(brittle&& o) { spend(); v = o.v; o.v = -1; return *this; }
+
+    static void spend()
+    {
+        if(budget == 0) throw std::runtime_error("brittle copy");
+        if(budget > 0) --budget;
+    }
+
+    friend bool operator<(const brittle& a, const brittle& b) noexcept { return a.v < b.v; }
+};
+
+}
+
+OCU_TEST("flat_map/branchless_bounds_match_std")
+{
+    std::mt19937 rng(5);
+    for(std::size_t n : { 0, 1, 2, 3, 7, 8, 9, 100, 1000 })
+    {
+        std::vector<int> data(n);
+        for(auto& v : data) v = static_cast<int>(rng() % 200);
+        std::sort(data.begin(), data.end());
+
+        for(int key = -1; key <= 201; ++key)
+        {
+            const auto lower = static_cast<std::size_t>(std::lower_bound(data.begin(), data.end(), key) - data.begin());
+            const auto upper = static_cast<std::size_t>(std::upper_bound(data.begin(), data.end(), key) - data.begin());
+            OCU_REQUIRE(open_cpp_utils::detail::branchless_lower_bound(data.data(), n, key, std::less<>{ }) == lower);
+            OCU_REQUIRE(open_cpp_utils::detail::branchless_upper_bound(data.data(), n, key, std::less<>{ }) == upper);
+        }
+    }
+}
+
+OCU_TEST("flat_map/matches_std_map")
+{
+    flat_map<int, int> map;
+    std::map<int, int> ref;
+    std::mt19937 rng(6);
+
+    for(int step = 0; step < 20000; ++step)
+    {
+        const int key = static_cast<int>(rng() % 700);
+        switch(rng() % 4)
+        {
+        case 0: OCU_CHECK(map.try_emplace(key, step).second == ref.try_emplace(key, step).second); break;
+        case 1: map.insert_or_assign(key, step); ref.insert_or_assign(key, step); break;
+        case 2: OCU_CHECK(map.erase(key) == ref.erase(key)); break;
+        case 3:
+        {
+            auto it = map.find(key);
+            OCU_REQUIRE((it == map.end()) == (ref.count(key) == 0));
+            if(it != map.end()) OCU_CHECK(it->second == ref[key]);
+            break;
+        }
+        }
+    }
+
+    OCU_REQUIRE(map.size() == ref.size());
+    auto rt = ref.begin();
+    for(const auto& [k, v] : map)
+    {
+        OCU_CHECK(k == rt->first && v == rt->second);
+        ++rt;
+    }
+}
+
+OCU_TEST("flat_map/insert_range_keeps_first_duplicate")
+{
+    flat_map<int, std::string> map{ { 5, "five" }, { 1, "one" } };
+    std::vector<std::pair<int, std::string>> batch{ { 3, "three" }, { 5, "FIVE" }, { 3, "THREE" }, { 0, "zero" } };
+    map.insert_range(batch);
+
+    OCU_REQUIRE(map.size() == 4);
+    OCU_CHECK(map.at(0) == "zero");
+    OCU_CHECK(map.at(3) == "three");
+    OCU_CHECK(map.at(5) == "five");
+    OCU_CHECK_THROWS(map.at(4), std::out_of_range);
+
+    std::vector<std::pair<int, std::string>> sorted{ { 2, "two" }, { 4, "four" }, { 6, "six" } };
+    map.insert_range(open_cpp_utils::sorted_unique, sorted);
+    OCU_CHECK(map.size() == 7);
+    OCU_CHECK(map.lower_bound(4)->second == "four");
+    OCU_CHECK(map.upper_bound(4)->second == "five");
+}
+
+OCU_TEST("flat_map/search_index_agrees_with_binary_search")
+{
+    flat_map<int, int> map;
+    for(int i = 0; i < 5000; ++i) map.try_emplace(i * 3, i);
+    map.build_search_index();
+    OCU_CHECK(map.has_search_index());
+
+    for(int k = -2; k < 15005; ++k)
+    {
+        auto it = map.find(k);
+        OCU_REQUIRE((it != map.end()) == (k >= 0 && k % 3 == 0 && k < 15000));
+        if(it != map.end()) OCU_CHECK(it->second == k / 3);
+    }
+
+    // Modifications drop the index rather than leave it stale
+    map.erase(9);
+    OCU_CHECK(!map.contains(9));
+    map.try_emplace(10, -1);
+    OCU_CHECK(map.find(10)->second == -1);
+}
+
+OCU_TEST("flat_map/set_matches_std_set")
+{
+    flat_set<std::string> set;
+    std::set<std::string> ref;
+    std::mt19937 rng(8);
+
+    std::vector<std::string> batch;
+    for(int i = 0; i < 500; ++i) batch.push_back(std::to_string(rng() % 300));
+    set.insert_range(batch);
+    ref.insert(batch.begin(), batch.end());
+
+    for(int i = 0; i < 100; ++i)
+    {
+        const std::string k = std::to_string(rng() % 300);
+        OCU_CHECK(set.erase(k) == ref.erase(k));
+    }
+    OCU_CHECK(std::vector<std::string>(set.begin(), set.end()) == std::vector<std::string>(ref.begin(), ref.end()));
+    for(int i = 0; i < 300; ++i) OCU_CHECK(set.contains(std::to_string(i)) == (ref.count(std::to_string(i)) != 0));
+}
+
+OCU_TEST("flat_map/throwing_insert_range_leaves_map_unchanged")
+{
+    std::vector<std::pair<brittle, int>> batch;
+    for(int k = 1; k < 40; k += 2) batch.emplace_back(k, k);
+
+    // Every budget fails at a different step, including inside the merge
+    for(int budget = 0; budget < 400; ++budget)
+    {
+        flat_map<brittle, int> map;
+        for(int k = 0; k < 40; k += 4) map.try_emplace(k, k);
+
+        brittle::budget = budget;
+        bool threw = false;
+        try
+        {
+            map.insert_range(batch);
+        }
+        catch(const std::runtime_error&)
+        {
+            threw = true;
+        }
+        brittle::budget = -1;
+
+        OCU_REQUIRE(map.size() == (threw ? 10u : 30u));
+        int last = -1;
+        for(const auto& [key, value] : map)
+        {
+            OCU_REQUIRE(key.v > last && value == key.v);
+            OCU_REQUIRE(threw ? key.v % 4 == 0 : key.v % 4 == 0 || key.v % 2 == 1);
+            last = key.v;
+        }
+    }
+}
+
+OCU_TEST("flat_map/throwing_set_insert_range_leaves_set_unchanged")
+{
+    std::vector<brittle> batch;
+    for(int k = 1; k < 40; k += 2) batch.emplace_back(k);
+
+    for(int budget = 0; budget < 400; ++budget)
+    {
+        flat_set<brittle> set;
+        for(int k = 0; k < 40; k += 4) set.insert(k);
+
+        brittle::budget = budget;
+        bool threw = false;
+        try
+        {
+            set.insert_range(batch);
+        }
+        catch(const std::runtime_error&)
+        {
+            threw = true;
+        }
+        brittle::budget = -1;
+
+        OCU_REQUIRE(set.size() == (threw ? 10u : 30u));
+        int last = -1;
+        for(const brittle& key : set)
+        {
+            OCU_REQUIRE(key.v > last);
+            OCU_REQUIRE(threw ? key.v % 4 == 0 : key.v % 4 == 0 || key.v % 2 == 1);
+            last = key.v;
+        }
+    }
+}
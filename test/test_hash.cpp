@@ -0,0 +1,158 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/hash.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using open_cpp_utils::fnv1a_32;
+using open_cpp_utils::fnv1a_64;
+using open_cpp_utils::hash;
+using open_cpp_utils::hash_state;
+using open_cpp_utils::make_perfect_hash_map;
+using open_cpp_utils::xxh64;
+using namespace open_cpp_utils::literals;
+
+namespace
+{
+
+struct point
+{
+    int         x, y;
+    std::string label;
+
+    friend void hash_append(hash_state& h, const point& p) { hash_append(h, p.x, p.y, p.label); }
+};
+
+/// Portable form of detail::accumulate_stripe, which the SIMD paths must reproduce exactly
+void scalar_stripe(std::uint64_t* acc, const char* p, const std::uint64_t* key)
+{
+    for(int i = 0; i < 8; ++i)
+    {
+        std::uint64_t d;
+        std::memcpy(&d, p + 8 * i, 8);
+        const std::uint64_t dk = d ^ key[i];
+        acc[i ^ 1] += d;
+        acc[i]     += (dk & 0xFFFFFFFFull) * (dk >> 32);
+    }
+}
+
+}
+
+OCU_TEST("hash/reference_values")
+{
+    static_assert(fnv1a_64("") == 0xCBF29CE484222325ull);
+    static_assert(fnv1a_64("a") == 0xAF63DC4C8601EC8Cull);
+    static_assert(fnv1a_32("a") == 0xE40C292Cu);
+    static_assert(xxh64("") == 0xEF46DB3751D8E999ull);
+    static_assert(xxh64("abc") == 0x44BC2CF5AD770999ull);
+    static_assert("abc"_hash == open_cpp_utils::string_hash("abc"));
+
+    // Runtime and compile-time evaluation must agree, including past the 32 byte bulk loop
+    const std::string long_text(100, 'q');
+    constexpr std::uint64_t expected = xxh64("qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqq");
+    OCU_CHECK(xxh64(long_text) == expected);
+}
+
+OCU_TEST("hash/simd_stripe_matches_scalar")
+{
+    std::mt19937_64 rng(11);
+    for(int round = 0; round < 1000; ++round)
+    {
+        alignas(32) std::uint64_t simd[8];
+        std::uint64_t             scalar[8];
+        for(int i = 0; i < 8; ++i) simd[i] = scalar[i] = rng();
+
+        char data[64];
+        for(char& c : data) c = static_cast<char>(rng());
+        const std::uint64_t* key = open_cpp_utils::detail::stripe_keys.data() + round % 16;
+
+        open_cpp_utils::detail::accumulate_stripe(simd, data, key);
+        scalar_stripe(scalar, data, key);
+        OCU_REQUIRE(std::equal(simd, simd + 8, scalar));
+    }
+}
+
+OCU_TEST("hash/bytes_depend_on_every_byte_and_length")
+{
+    std::mt19937 rng(12);
+    for(std::size_t len : { 1, 3, 4, 8, 15, 16, 17, 33, 255, 256, 257, 1023, 1024, 1025, 5000 })
+    {
+        std::vector<char> data(len);
+        for(char& c : data) c = static_cast<char>(rng());
+        const std::uint64_t base = open_cpp_utils::detail::hash_bytes(data.data(), len);
+
+        for(std::size_t i = 0; i < len; i += 1 + len / 16)
+        {
+            data[i] ^= 1;
+            OCU_CHECK(open_cpp_utils::detail::hash_bytes(data.data(), len) != base);
+            data[i] ^= 1;
+        }
+        OCU_CHECK(open_cpp_utils::detail::hash_bytes(data.data(), len, 1) != base);
+        if(len > 1) OCU_CHECK(open_cpp_utils::detail::hash_bytes(data.data(), len - 1) != base);
+    }
+}
+
+OCU_TEST("hash/hash_append_composites")
+{
+    const hash<point> h;
+    OCU_CHECK(h({ 1, 2, "a" }) == h({ 1, 2, "a" }));
+    OCU_CHECK(h({ 1, 2, "a" }) != h({ 2, 1, "a" }));
+    OCU_CHECK(h({ 1, 2, "a" }) != h({ 1, 2, "b" }));
+
+    // Length is part of the hash, so splitting a string differently changes the result
+    const hash<std::pair<std::string, std::string>> hp;
+    OCU_CHECK(hp({ "ab", "c" }) != hp({ "a", "bc" }));
+
+    OCU_CHECK(hash<double>{ }(0.0) == hash<double>{ }(-0.0));
+    OCU_CHECK(hash<std::string>{ }("text") == hash<std::string_view>{ }("text"));
+
+    std::set<std::size_t> seen;
+    for(int i = 0; i < 10000; ++i) seen.insert(hash<int>{ }(i));
+    OCU_CHECK(seen.size() == 10000);
+}
+
+OCU_TEST("hash/perfect_hash_map_lookup")
+{
+    static constexpr auto table = make_perfect_hash_map<int>({
+        { "open", 0 }, { "save", 1 }, { "quit", 2 }, { "close", 3 }, { "undo", 4 }, { "redo", 5 }, { "", 6 } });
+
+    static_assert(table.size() == 7);
+    static_assert(*table.find("quit") == 2);
+    static_assert(table.find("missing") == nullptr);
+
+    OCU_CHECK(table.at("") == 6);
+    OCU_CHECK(table.index_of("redo") == 5);
+    OCU_CHECK(!table.contains("ope"));
+    OCU_CHECK_THROWS(table.at("nope"), std::out_of_range);
+}
+
+OCU_TEST("hash/perfect_hash_map_runtime_build")
+{
+    std::vector<std::string> names;
+    for(int i = 0; i < 300; ++i) names.push_back("key_" + std::to_string(i));
+
+    std::pair<std::string_view, int> items[300];
+    for(int i = 0; i < 300; ++i) items[i] = { names[static_cast<std::size_t>(i)], i };
+    const auto table = make_perfect_hash_map(items);
+
+    for(int i = 0; i < 300; ++i) OCU_REQUIRE(table.at(names[static_cast<std::size_t>(i)]) == i);
+    OCU_CHECK(!table.contains("key_300"));
+
+    std::pair<std::string_view, int> dup[2] = { { "same", 0 }, { "same", 1 } };
+    OCU_CHECK_THROWS(make_perfect_hash_map(dup), std::invalid_argument);
+}
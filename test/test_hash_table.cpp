@@ -0,0 +1,162 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/hash_table.h>
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+using open_cpp_utils::hash_map;
+using open_cpp_utils::hash_set;
+
+namespace
+{
+
+/// Sends every key to one of four hashes so probing, tombstones and group wrap-around get exercised
+struct clumped_hash
+{
+    std::size_t operator()(int k) const noexcept { return static_cast<std::size_t>(k & 3); }
+};
+
+/// Counts live instances and throws from the copy constructor once copies_left runs out
+struct fragile
+{
+    static inline int live        = 0;
+    static inline int copies_left = 0;
+
+    explicit fragile(int) { ++live; }
+    fragile(const fragile&)
+    {
+        if(copies_left-- == 0) throw std::runtime_error("fragile copy");
+        ++live;
+    }
+    fragile(fragile&&) noexcept { ++live; }
+    ~fragile() { --live; }
+};
+
+using fragile_map = hash_map<int, fragile>;
+
+}
+
+OCU_TEST("hash_table/map_matches_unordered_map")
+{
+    hash_map<int, int>                 map;
+    std::unordered_map<int, int>       ref;
+    std::mt19937                       rng(1);
+
+    for(int step = 0; step < 200000; ++step)
+    {
+        const int key = static_cast<int>(rng() % 5000);
+        switch(rng() % 4)
+        {
+        case 0:
+        case 1: map[key] = step; ref[key] = step; break;
+        case 2: OCU_CHECK(map.erase(key) == ref.erase(key)); break;
+        case 3:
+        {
+            auto it = map.find(key);
+            auto rt = ref.find(key);
+            OCU_REQUIRE((it == map.end()) == (rt == ref.end()));
+            if(it != map.end()) OCU_CHECK(it->second == rt->second);
+            break;
+        }
+        }
+    }
+
+    OCU_CHECK(map.size() == ref.size());
+    std::size_t visited = 0;
+    for(const auto& [k, v] : map)
+    {
+        ++visited;
+        OCU_CHECK(ref.at(k) == v);
+    }
+    OCU_CHECK(visited == ref.size());
+}
+
+OCU_TEST("hash_table/colliding_hashes")
+{
+    hash_set<int, clumped_hash> set;
+    std::unordered_set<int>     ref;
+    std::mt19937                rng(2);
+
+    for(int step = 0; step < 20000; ++step)
+    {
+        const int key = static_cast<int>(rng() % 300);
+        if(rng() % 3) OCU_CHECK(set.insert(key).second == ref.insert(key).second);
+        else          OCU_CHECK(set.erase(key) == ref.erase(key));
+    }
+    OCU_CHECK(set.size() == ref.size());
+    for(int k = 0; k < 300; ++k) OCU_CHECK(set.contains(k) == (ref.count(k) != 0));
+}
+
+OCU_TEST("hash_table/erase_while_iterating")
+{
+    hash_map<int, std::string> map;
+    for(int i = 0; i < 1000; ++i) map.try_emplace(i, std::to_string(i));
+
+    for(auto it = map.begin(); it != map.end();)
+    {
+        if(it->first % 2) it = map.erase(it);
+        else              ++it;
+    }
+    OCU_CHECK(map.size() == 500);
+    for(int i = 0; i < 1000; ++i) OCU_CHECK(map.contains(i) == (i % 2 == 0));
+}
+
+OCU_TEST("hash_table/try_emplace_and_insert_or_assign")
+{
+    hash_map<std::string, int> map;
+    OCU_CHECK(map.try_emplace("a", 1).second);
+    OCU_CHECK(!map.try_emplace("a", 2).second);
+    OCU_CHECK(map.find("a")->second == 1);
+
+    OCU_CHECK(!map.insert_or_assign("a", 3).second);
+    OCU_CHECK(map.find("a")->second == 3);
+    OCU_CHECK(map.insert_or_assign("b", 4).second);
+    OCU_CHECK(map.size() == 2);
+}
+
+OCU_TEST("hash_table/copy_move_clear_reserve")
+{
+    hash_map<int, int> a;
+    for(int i = 0; i < 100; ++i) a[i] = i * i;
+
+    hash_map<int, int> b = a;
+    hash_map<int, int> c = std::move(a);
+    OCU_CHECK(b.size() == 100 && c.size() == 100);
+    OCU_CHECK(b.find(9)->second == 81 && c.find(9)->second == 81);
+
+    c.clear();
+    OCU_CHECK(c.empty());
+    OCU_CHECK(c.find(9) == c.end());
+
+    c.reserve(1000);
+    const std::size_t buckets = c.bucket_count();
+    for(int i = 0; i < 1000; ++i) c[i] = i;
+    OCU_CHECK(c.bucket_count() == buckets);
+}
+
+OCU_TEST("hash_table/throwing_copy_releases_partial_copy")
+{
+    {
+        fragile_map map;
+        for(int i = 0; i < 100; ++i) map.try_emplace(i, i);
+
+        fragile::copies_left = 50;
+        OCU_CHECK_THROWS(fragile_map(map), std::runtime_error);
+        OCU_CHECK(fragile::live == 100);
+
+        fragile::copies_left = 100;
+        const fragile_map copy(map);
+        OCU_CHECK(copy.size() == 100 && fragile::live == 200);
+    }
+    OCU_CHECK(fragile::live == 0);
+}
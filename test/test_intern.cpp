@@ -0,0 +1,61 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/intern.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using open_cpp_utils::interner;
+using open_cpp_utils::symbol;
+
+OCU_TEST("intern/same_string_same_symbol")
+{
+    interner strings;
+    const symbol a = strings.intern("alpha");
+    const symbol b = strings.intern("beta");
+    const symbol e = strings.intern("");
+
+    OCU_CHECK(a != b);
+    OCU_CHECK(strings.intern(std::string("alp") + "ha") == a);
+    OCU_CHECK(strings.view(a) == "alpha" && strings.view(b) == "beta");
+    OCU_CHECK(std::strcmp(strings.c_str(b), "beta") == 0);
+    OCU_CHECK(strings.view(e).empty());
+    OCU_CHECK(strings.find("beta") == b);
+    OCU_CHECK(!strings.find("gamma").has_value());
+}
+
+OCU_TEST("intern/threads_agree_on_symbols")
+{
+    constexpr int count = 5000;
+
+    interner                         strings;
+    std::vector<std::vector<symbol>> seen(4, std::vector<symbol>(count));
+    std::vector<std::thread>         threads;
+    for(int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&, t]
+        {
+            // Each thread walks the strings in a different order so insertions race; the strides are coprime to count
+            static constexpr int strides[] = { 1, 3, 7, 9 };
+            for(int i = 0; i < count; ++i)
+            {
+                const int j = (i * strides[t]) % count;
+                seen[t][j] = strings.intern("key " + std::to_string(j));
+            }
+        });
+    }
+    for(std::thread& t : threads) t.join();
+
+    for(int i = 0; i < count; ++i)
+    {
+        for(int t = 1; t < 4; ++t) OCU_CHECK(seen[t][i] == seen[0][i]);
+        OCU_CHECK(strings.view(seen[0][i]) == "key " + std::to_string(i));
+    }
+}
@@ -0,0 +1,50 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/memory_stats.h>
+#include <open-cpp-utils/hash_table.h>
+#include <open-cpp-utils/object_pool.h>
+#include <open-cpp-utils/small_vector.h>
+
+using namespace open_cpp_utils;
+
+static_assert(memory_tracking_enabled, "test_memory_stats must be built with OCU_TRACK_ALLOCATIONS");
+
+OCU_TEST("memory_stats/containers_report_and_return_their_memory")
+{
+    const memory_snapshot before = memory_stats();
+    {
+        object_pool<int> pool;
+        for(int i = 0; i < 1000; ++i) static_cast<void>(pool.acquire(i));
+
+        small_vector<int, 4> v;
+        for(int i = 0; i < 100; ++i) v.push_back(i);
+
+        hash_map<int, int> map;
+        for(int i = 0; i < 1000; ++i) map.emplace(i, i);
+
+        const memory_snapshot during = memory_stats();
+        for(const memory_tag tag : { memory_tag::object_pool, memory_tag::small_vector, memory_tag::hash_table })
+        {
+            OCU_CHECK(during[tag].bytes_live > before[tag].bytes_live);
+            OCU_CHECK(during[tag].allocations > before[tag].allocations);
+            OCU_CHECK(during[tag].bytes_peak >= during[tag].bytes_live);
+        }
+        OCU_CHECK(during[memory_tag::hash_table].rehashes > before[memory_tag::hash_table].rehashes);
+    }
+
+    const memory_snapshot after = memory_stats();
+    OCU_CHECK(after.bytes_live() == before.bytes_live());
+
+    reset_memory_peaks();
+    const memory_snapshot reset = memory_stats();
+    for(std::size_t t = 0; t < memory_tag_count; ++t)
+    {
+        const memory_tag tag = static_cast<memory_tag>(t);
+        OCU_CHECK(reset[tag].bytes_peak == reset[tag].bytes_live);
+    }
+}
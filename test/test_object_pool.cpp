@@ -0,0 +1,143 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/object_pool.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using open_cpp_utils::object_pool;
+
+namespace
+{
+
+struct counted
+{
+    static inline int live = 0;
+
+    explicit counted(int v) : value(v) { ++live; }
+    ~counted() { --live; }
+
+    int value;
+};
+
+/// Overwrites its whole storage before throwing, as a constructor that fails halfway through may
+struct scribbler
+{
+    explicit scribbler(bool fail)
+    {
+        std::fill(std::begin(bytes), std::end(bytes), static_cast<unsigned char>(0xFF));
+        if(fail) throw std::runtime_error("scribbler");
+    }
+
+    unsigned char bytes[16];
+};
+
+}
+
+OCU_TEST("object_pool/acquire_get_release")
+{
+    object_pool<std::string, 4> pool;
+    auto a = pool.acquire("alpha");
+    auto b = pool.acquire(3, 'b');
+
+    OCU_CHECK(pool.size() == 2);
+    OCU_CHECK(pool.valid(a) && pool.valid(b));
+    OCU_CHECK(pool[a] == "alpha");
+    OCU_CHECK(*pool.get(b) == "bbb");
+
+    pool.release(a);
+    OCU_CHECK(pool.size() == 1);
+    OCU_CHECK(!pool.valid(a));
+    OCU_CHECK(pool.get(a) == nullptr);
+    OCU_CHECK(pool.valid(b));
+}
+
+OCU_TEST("object_pool/stale_handle_after_reuse")
+{
+    object_pool<int, 4> pool;
+    auto a = pool.acquire(1);
+    pool.release(a);
+    auto b = pool.acquire(2);
+
+    OCU_CHECK(a.index() == b.index());
+    OCU_CHECK(!pool.valid(a));
+    OCU_CHECK(pool.get(b) != nullptr && *pool.get(b) == 2);
+}
+
+OCU_TEST("object_pool/pointers_stable_across_growth")
+{
+    object_pool<int, 8> pool;
+    auto first = pool.acquire(7);
+    int* p = pool.get(first);
+
+    std::vector<object_pool<int, 8>::handle> handles;
+    for(int i = 0; i < 1000; ++i) handles.push_back(pool.acquire(i));
+
+    OCU_CHECK(pool.get(first) == p);
+    OCU_CHECK(*p == 7);
+    OCU_CHECK(pool.capacity() >= 1001);
+    for(int i = 0; i < 1000; ++i) OCU_CHECK(pool[handles[static_cast<std::size_t>(i)]] == i);
+}
+
+OCU_TEST("object_pool/for_each_visits_live_objects")
+{
+    object_pool<int, 4> pool;
+    std::vector<object_pool<int, 4>::handle> handles;
+    for(int i = 0; i < 10; ++i) handles.push_back(pool.acquire(i));
+    for(int i = 0; i < 10; i += 2) pool.release(handles[static_cast<std::size_t>(i)]);
+
+    int sum = 0, count = 0;
+    pool.for_each([&](auto h, int& v) { OCU_CHECK(pool.valid(h)); sum += v; ++count; });
+    OCU_CHECK(count == 5);
+    OCU_CHECK(sum == 1 + 3 + 5 + 7 + 9);
+}
+
+OCU_TEST("object_pool/clear_and_destructor_run_destructors")
+{
+    {
+        object_pool<counted, 4> pool;
+        auto a = pool.acquire(1);
+        for(int i = 0; i < 6; ++i) static_cast<void>(pool.acquire(i));
+        OCU_CHECK(counted::live == 7);
+
+        pool.clear();
+        OCU_CHECK(counted::live == 0);
+        OCU_CHECK(pool.empty());
+        OCU_CHECK(!pool.valid(a));
+
+        static_cast<void>(pool.acquire(5));
+        static_cast<void>(pool.acquire(6));
+    }
+    OCU_CHECK(counted::live == 0);
+}
+
+OCU_TEST("object_pool/null_handle_is_invalid")
+{
+    object_pool<int> pool;
+    object_pool<int>::handle h;
+    OCU_CHECK(!h);
+    OCU_CHECK(!pool.valid(h));
+    static_cast<void>(pool.acquire(1));
+    OCU_CHECK(!pool.valid(h));
+}
+
+OCU_TEST("object_pool/throwing_constructor_keeps_the_slot_free")
+{
+    object_pool<scribbler, 8> pool;
+    pool.reserve(8);
+    static_cast<void>(pool.acquire(false));
+    OCU_CHECK_THROWS(pool.acquire(true), std::runtime_error);
+    OCU_CHECK(pool.size() == 1);
+
+    // The slot the failed constructor wrote over must still lead to the rest of the free list
+    for(int i = 0; i < 7; ++i) static_cast<void>(pool.acquire(false));
+    OCU_CHECK(pool.size() == 8);
+    OCU_CHECK(pool.capacity() == 8);
+}
@@ -0,0 +1,93 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/optional.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+
+using open_cpp_utils::max_value_niche;
+using open_cpp_utils::optional;
+
+static_assert(sizeof(optional<int*>) == sizeof(int*));
+static_assert(sizeof(optional<double>) == sizeof(double));
+static_assert(sizeof(optional<std::uint32_t, max_value_niche<std::uint32_t>>) == 4);
+static_assert(optional<int*>::uses_niche);
+static_assert(!optional<std::string>::uses_niche);
+static_assert(std::is_trivially_copyable_v<optional<int*>>);
+
+OCU_TEST("optional/niche_pointer")
+{
+    int x = 3;
+    optional<int*> p;
+    OCU_CHECK(!p);
+    p = &x;
+    OCU_REQUIRE(p.has_value());
+    OCU_CHECK(**p == 3);
+    p = nullptr;
+    OCU_CHECK(!p.has_value());
+}
+
+OCU_TEST("optional/floating_point_keeps_other_nans")
+{
+    optional<double> d = std::numeric_limits<double>::quiet_NaN();
+    OCU_CHECK(d.has_value());
+    OCU_CHECK(std::isnan(*d));
+
+    d.reset();
+    OCU_CHECK(!d);
+    OCU_CHECK(d.value_or(1.5) == 1.5);
+}
+
+OCU_TEST("optional/sentinel_niche")
+{
+    using index = optional<std::uint32_t, max_value_niche<std::uint32_t>>;
+    index i;
+    OCU_CHECK(!i);
+    i = 0u;
+    OCU_CHECK(i.has_value() && *i == 0);
+    OCU_CHECK(i == 0u);
+    OCU_CHECK(i != std::nullopt);
+}
+
+OCU_TEST("optional/fallback_storage_manages_lifetime")
+{
+    auto tracker = std::make_shared<int>(1);
+    {
+        optional<std::shared_ptr<int>> a = tracker;
+        optional<std::shared_ptr<int>> b = a;
+        OCU_CHECK(tracker.use_count() == 3);
+        b.reset();
+        OCU_CHECK(tracker.use_count() == 2);
+        b = std::move(a);
+        OCU_CHECK(tracker.use_count() == 2 || tracker.use_count() == 3);
+        a.reset();
+        OCU_CHECK(tracker.use_count() == 2);
+    }
+    OCU_CHECK(tracker.use_count() == 1);
+}
+
+OCU_TEST("optional/monadic_and_std_interop")
+{
+    optional<std::string> s = std::string("abc");
+    const auto len = s.transform([](const std::string& v) { return v.size(); });
+    OCU_CHECK(len.has_value() && *len == 3);
+
+    const auto none = optional<std::string>().and_then([](const std::string&) { return optional<int>(1); });
+    OCU_CHECK(!none);
+
+    OCU_CHECK(s.to_std() == std::optional<std::string>("abc"));
+    OCU_CHECK_THROWS(optional<int>().value(), std::bad_optional_access);
+
+    optional<int> a = 1, b;
+    a.swap(b);
+    OCU_CHECK(!a && b == 1);
+}
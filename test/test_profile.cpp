@@ -0,0 +1,73 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#define OCU_ENABLE_PROFILING 1
+
+#include "harness.h"
+
+#include <open-cpp-utils/profile.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using open_cpp_utils::profile_session;
+using open_cpp_utils::profile_zone;
+
+namespace
+{
+
+std::size_t occurrences(const std::string& text, const std::string& needle)
+{
+    std::size_t count = 0;
+    for(std::size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) ++count;
+    return count;
+}
+
+}
+
+OCU_TEST("profile/session_writes_chrome_trace")
+{
+    std::string json;
+    {
+        profile_session session([&](std::string_view piece) { json += piece; });
+        open_cpp_utils::profile_thread_name("test main");
+        for(int i = 0; i < 10; ++i)
+        {
+            OCU_ZONE("outer");
+            OCU_ZONE("inner");
+        }
+        std::thread worker([] { OCU_ZONE("worker zone"); });
+        worker.join();
+        OCU_COUNTER("queue", "depth", 3.0);
+        OCU_CHECK(session.dropped() == 0);
+    }
+
+    OCU_CHECK(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0) == 0);
+    OCU_CHECK(json.size() >= 3 && json.compare(json.size() - 3, 3, "]}\n") == 0);
+    OCU_CHECK(occurrences(json, "\"outer\"") == 10);
+    OCU_CHECK(occurrences(json, "\"inner\"") == 10);
+    OCU_CHECK(occurrences(json, "\"worker zone\"") == 1);
+    OCU_CHECK(occurrences(json, "test main") == 1);
+    OCU_CHECK(occurrences(json, "\"depth\"") == 1);
+}
+
+OCU_TEST("profile/zones_outside_a_session_are_not_recorded")
+{
+    {
+        OCU_ZONE("before");
+    }
+
+    std::string json;
+    {
+        profile_session session([&](std::string_view piece) { json += piece; });
+        OCU_CHECK_THROWS(profile_session([](std::string_view) { }), std::logic_error);
+    }
+    {
+        OCU_ZONE("after");
+    }
+    OCU_CHECK(json.find("before") == std::string::npos);
+    OCU_CHECK(json.find("after") == std::string::npos);
+}
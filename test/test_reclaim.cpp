@@ -0,0 +1,88 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/reclaim.h>
+
+#include <atomic>
+#include <thread>
+
+using open_cpp_utils::epoch_domain;
+using open_cpp_utils::epoch_guard;
+using open_cpp_utils::hazard_domain;
+using open_cpp_utils::hazard_pointer;
+
+namespace
+{
+
+struct tracked
+{
+    explicit tracked(std::atomic<int>& live) : live(live) { live.fetch_add(1); }
+    ~tracked() { live.fetch_sub(1); }
+
+    std::atomic<int>& live;
+};
+
+}
+
+OCU_TEST("reclaim/epoch_defers_until_unpinned")
+{
+    std::atomic<int> live{ 0 };
+    epoch_domain     domain;
+
+    std::atomic<bool> pinned{ false };
+    std::atomic<bool> release{ false };
+    std::thread reader([&]
+    {
+        epoch_guard guard(domain);
+        pinned.store(true);
+        while(!release.load()) std::this_thread::yield();
+    });
+    while(!pinned.load()) std::this_thread::yield();
+
+    domain.retire(new tracked(live));
+    for(int i = 0; i < 200; ++i) domain.retire(new tracked(live));
+    OCU_CHECK(live.load() == 201);
+    OCU_CHECK(domain.pending() == 201);
+
+    release.store(true);
+    reader.join();
+    domain.synchronize();
+    OCU_CHECK(live.load() == 0);
+    OCU_CHECK(domain.pending() == 0);
+}
+
+OCU_TEST("reclaim/epoch_destructor_frees_pending")
+{
+    std::atomic<int> live{ 0 };
+    {
+        epoch_domain domain;
+        std::thread([&] { domain.retire(new tracked(live)); }).join();
+        domain.retire(new tracked(live));
+        OCU_CHECK(live.load() == 2);
+    }
+    OCU_CHECK(live.load() == 0);
+}
+
+OCU_TEST("reclaim/hazard_keeps_protected_object")
+{
+    std::atomic<int> live{ 0 };
+    hazard_domain    domain;
+
+    std::atomic<tracked*> shared{ new tracked(live) };
+    {
+        hazard_pointer hp(domain);
+        tracked* p = hp.protect(shared);
+        shared.store(nullptr);
+        domain.retire(p);
+        domain.collect();
+        OCU_CHECK(live.load() == 1);
+        OCU_CHECK(domain.pending() == 1);
+    }
+    domain.collect();
+    OCU_CHECK(live.load() == 0);
+    OCU_CHECK(domain.pending() == 0);
+}
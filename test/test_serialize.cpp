@@ -0,0 +1,195 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/serialize.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using namespace open_cpp_utils;
+
+namespace
+{
+
+struct record
+{
+    std::int32_t                            id;
+    double                                  weight;
+    std::string                             name;
+    std::vector<std::uint16_t>              samples;
+    flat_map<std::uint64_t, std::string>    by_key;
+    hash_map<std::string, std::uint32_t>    by_name;
+    directed_tree<std::string>              tree;
+};
+
+struct other_record
+{
+    std::int32_t id;
+    double       weight;
+};
+
+/// Offset of the root value, from the header
+std::size_t root_of(const std::vector<std::byte>& bytes)
+{
+    std::uint64_t root;
+    std::memcpy(&root, bytes.data() + 24, sizeof(root));
+    return static_cast<std::size_t>(root);
+}
+
+std::uint64_t load_u64(const std::vector<std::byte>& bytes, std::size_t at)
+{
+    std::uint64_t v;
+    std::memcpy(&v, bytes.data() + at, sizeof(v));
+    return v;
+}
+
+/// Overwrites a stored scalar in place; the format is little-endian, as is every host these tests run on
+template<typename T>
+void patch(std::vector<std::byte>& bytes, std::size_t at, T value)
+{
+    std::memcpy(bytes.data() + at, &value, sizeof(value));
+}
+
+record make_record()
+{
+    record r{ 42, 2.5, "answer", { 1, 2, 3, 65535 }, { }, { }, { } };
+    for(std::uint64_t k = 0; k < 500; ++k) r.by_key.insert_or_assign(k * 3, std::to_string(k));
+    for(std::uint32_t k = 0; k < 500; ++k) r.by_name.try_emplace("name-" + std::to_string(k), k);
+
+    const tree_node root = r.tree.emplace_root("root");
+    const tree_node a    = r.tree.emplace_child(root, "a");
+    r.tree.emplace_child(root, "b");
+    r.tree.emplace_child(a, "a1");
+    return r;
+}
+
+}
+
+OCU_TEST("serialize/view_reads_in_place")
+{
+    const record                 source = make_record();
+    const std::vector<std::byte> bytes  = serialize(source);
+    const auto                   view   = view_serialized<record>(bytes);
+
+    OCU_CHECK(view.get<0>() == 42);
+    OCU_CHECK(view.get<1>() == 2.5);
+    OCU_CHECK(view.get<2>() == "answer");
+
+    const auto samples = view.get<3>();
+    OCU_REQUIRE(samples.size() == 4);
+    OCU_CHECK(samples[3] == 65535);
+
+    const auto by_key = view.get<4>();
+    OCU_CHECK(by_key.size() == 500);
+    OCU_CHECK(by_key.find(std::uint64_t(30)) == std::string_view("10"));
+    OCU_CHECK(!by_key.contains(std::uint64_t(31)));
+
+    const auto by_name = view.get<5>();
+    for(std::uint32_t k = 0; k < 500; k += 7) OCU_CHECK(by_name.find("name-" + std::to_string(k)) == k);
+    OCU_CHECK(!by_name.contains(std::string("name-500")));
+
+    const auto tree = view.get<6>();
+    OCU_REQUIRE(tree.size() == 4);
+    const tree_node a = tree.first_child(tree.root());
+    OCU_CHECK(tree[tree.root()] == "root" && tree[a] == "a");
+    OCU_CHECK(tree[tree.next_sibling(a)] == "b");
+    OCU_CHECK(tree[tree.first_child(a)] == "a1");
+    OCU_CHECK(tree.parent(tree.first_child(a)) == a);
+}
+
+OCU_TEST("serialize/deserialize_round_trips")
+{
+    const record source = make_record();
+    const record copy   = deserialize<record>(serialize(source));
+
+    OCU_CHECK(copy.id == source.id && copy.weight == source.weight && copy.name == source.name);
+    OCU_CHECK(copy.samples == source.samples);
+    OCU_REQUIRE(copy.by_key.size() == source.by_key.size());
+    for(const auto& [k, v] : source.by_key) OCU_CHECK(copy.by_key.at(k) == v);
+    OCU_REQUIRE(copy.by_name.size() == source.by_name.size());
+    for(const auto& [k, v] : source.by_name) OCU_CHECK(copy.by_name.at(k) == v);
+    OCU_REQUIRE(copy.tree.size() == 4);
+    OCU_CHECK(copy.tree[copy.tree.first_child(copy.tree.root())] == "a");
+}
+
+OCU_TEST("serialize/rejects_wrong_type_and_truncation")
+{
+    const std::vector<std::byte> bytes = serialize(make_record());
+
+    OCU_CHECK_THROWS(static_cast<void>(view_serialized<other_record>(bytes)), std::system_error);
+    OCU_CHECK_THROWS(static_cast<void>(view_serialized<record>(std::span(bytes).first(32))), std::system_error);
+
+    // Cutting the out-of-line arrays off leaves records that point past the end
+    const auto truncated = std::span(bytes).first(bytes.size() / 2);
+    OCU_CHECK_THROWS(deserialize<record>(truncated), std::system_error);
+}
+
+OCU_TEST("serialize/corrupt_maps_throw")
+{
+    using ordered = flat_map<std::uint32_t, std::uint32_t>;
+    using hashed  = hash_map<std::uint32_t, std::uint32_t>;
+
+    ordered o;
+    hashed  h;
+    for(std::uint32_t k = 0; k < 100; ++k)
+    {
+        o.insert_or_assign(k, k);
+        h.try_emplace(k, k);
+    }
+
+    // Fewer values than keys would let find index past the value array
+    std::vector<std::byte> bytes = serialize(o);
+    patch<std::uint64_t>(bytes, root_of(bytes) + 24, 50);
+    OCU_CHECK_THROWS(static_cast<void>(view_serialized<ordered>(bytes)), std::system_error);
+
+    bytes = serialize(h);
+    patch<std::uint64_t>(bytes, root_of(bytes) + 24, 50);
+    OCU_CHECK_THROWS(static_cast<void>(view_serialized<hashed>(bytes)), std::system_error);
+
+    bytes = serialize(h);
+    patch<std::uint64_t>(bytes, root_of(bytes) + 40, 3);
+    OCU_CHECK_THROWS(static_cast<void>(view_serialized<hashed>(bytes)), std::system_error);
+
+    // An index with no empty slot must still end the probe
+    bytes = serialize(h);
+    const std::size_t slots = static_cast<std::size_t>(load_u64(bytes, root_of(bytes) + 32));
+    const std::size_t count = static_cast<std::size_t>(load_u64(bytes, root_of(bytes) + 40));
+    for(std::size_t i = 0; i < count; ++i) patch<std::uint64_t>(bytes, slots + 8 * i, 0x1234567800000001ull);
+    const auto view = view_serialized<hashed>(bytes);
+    OCU_CHECK(!view.contains(std::uint32_t(1000)));
+
+    OCU_CHECK_THROWS(static_cast<void>(view.values()[view.size()]), std::out_of_range);
+}
+
+OCU_TEST("serialize/corrupt_trees_throw")
+{
+    using tree = directed_tree<std::uint32_t>;
+
+    tree t;
+    const tree_node root = t.emplace_root(0u);
+    for(std::uint32_t i = 1; i < 10; ++i) t.emplace_child(root, i);
+
+    std::vector<std::byte> bytes = serialize(t);
+    patch<std::uint64_t>(bytes, root_of(bytes) + 8, 5);
+    OCU_CHECK_THROWS(static_cast<void>(view_serialized<tree>(bytes)), std::system_error);
+
+    // Links beyond the node count throw when followed, and when rebuilding
+    bytes = serialize(t);
+    const std::size_t first_child = static_cast<std::size_t>(load_u64(bytes, root_of(bytes) + 16));
+    patch<std::uint32_t>(bytes, first_child, 1000);
+    const auto view = view_serialized<tree>(bytes);
+    OCU_CHECK_THROWS(static_cast<void>(view.first_child(view.root())), std::system_error);
+
+    bytes = serialize(t);
+    const std::size_t parent = static_cast<std::size_t>(load_u64(bytes, root_of(bytes)));
+    patch<std::uint32_t>(bytes, parent + 4, 1000);
+    OCU_CHECK_THROWS(deserialize<tree>(bytes), std::system_error);
+}
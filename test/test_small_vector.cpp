@@ -0,0 +1,124 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/small_vector.h>
+
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using open_cpp_utils::small_vector;
+
+namespace
+{
+
+template<typename V, typename W>
+bool same(const V& a, const W& b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+}
+
+OCU_TEST("small_vector/inline_until_capacity")
+{
+    small_vector<int, 4> v;
+    OCU_CHECK(v.is_inline());
+    for(int i = 0; i < 4; ++i) v.push_back(i);
+    OCU_CHECK(v.is_inline());
+    OCU_CHECK(v.capacity() == 4);
+
+    v.push_back(4);
+    OCU_CHECK(!v.is_inline());
+    OCU_CHECK(same(v, std::vector<int>{ 0, 1, 2, 3, 4 }));
+
+    v.resize(2);
+    v.shrink_to_fit();
+    OCU_CHECK(v.is_inline());
+    OCU_CHECK(same(v, std::vector<int>{ 0, 1 }));
+}
+
+OCU_TEST("small_vector/multi_insert_that_fits_stays_inline")
+{
+    small_vector<int, 8> v{ 1, 2, 3 };
+    v.insert(v.begin() + 1, 3, 9);
+    OCU_CHECK(v.is_inline());
+    OCU_CHECK(same(v, std::vector<int>{ 1, 9, 9, 9, 2, 3 }));
+
+    const int extra[] = { 7, 8 };
+    v.insert(v.end(), std::begin(extra), std::end(extra));
+    OCU_CHECK(v.is_inline());
+    OCU_CHECK(same(v, std::vector<int>{ 1, 9, 9, 9, 2, 3, 7, 8 }));
+}
+
+OCU_TEST("small_vector/matches_std_vector_under_random_edits")
+{
+    small_vector<std::string, 3> v;
+    std::vector<std::string>     ref;
+    std::mt19937 rng(7);
+
+    for(int step = 0; step < 4000; ++step)
+    {
+        const std::string s = std::to_string(rng() % 1000) + std::string(rng() % 40, 'x');
+        const std::size_t at = ref.empty() ? 0 : rng() % (ref.size() + 1);
+        switch(rng() % 6)
+        {
+        case 0: v.push_back(s); ref.push_back(s); break;
+        case 1: v.insert(v.begin() + at, s); ref.insert(ref.begin() + static_cast<std::ptrdiff_t>(at), s); break;
+        case 2: v.insert(v.begin() + at, 2, s); ref.insert(ref.begin() + static_cast<std::ptrdiff_t>(at), 2, s); break;
+        case 3:
+            if(at < ref.size())
+            {
+                v.erase(v.begin() + at);
+                ref.erase(ref.begin() + static_cast<std::ptrdiff_t>(at));
+            }
+            break;
+        case 4: if(!ref.empty()) { v.pop_back(); ref.pop_back(); } break;
+        case 5: if(ref.size() > 20) { v.resize(5); ref.resize(5); } break;
+        }
+        OCU_REQUIRE(same(v, ref));
+    }
+}
+
+OCU_TEST("small_vector/copy_move_swap")
+{
+    small_vector<std::string, 2> a{ "a", "b" };
+    small_vector<std::string, 2> b{ "c", "d", "e" };
+
+    small_vector<std::string, 2> c = a;
+    small_vector<std::string, 2> d = std::move(b);
+    OCU_CHECK(same(c, std::vector<std::string>{ "a", "b" }));
+    OCU_CHECK(same(d, std::vector<std::string>{ "c", "d", "e" }));
+
+    c.swap(d);
+    OCU_CHECK(same(d, std::vector<std::string>{ "a", "b" }));
+    OCU_CHECK(same(c, std::vector<std::string>{ "c", "d", "e" }));
+
+    a = c;
+    OCU_CHECK(same(a, c));
+    a = small_vector<std::string, 2>{ "z" };
+    OCU_CHECK(same(a, std::vector<std::string>{ "z" }));
+}
+
+OCU_TEST("small_vector/move_only_elements")
+{
+    small_vector<std::unique_ptr<int>, 2> v;
+    for(int i = 0; i < 10; ++i) v.push_back(std::make_unique<int>(i));
+    v.erase(v.begin() + 3, v.begin() + 5);
+    OCU_REQUIRE(v.size() == 8);
+    OCU_CHECK(*v[3] == 5);
+    OCU_CHECK(*v.back() == 9);
+}
+
+OCU_TEST("small_vector/at_throws_out_of_range")
+{
+    small_vector<int, 2> v{ 1 };
+    OCU_CHECK(v.at(0) == 1);
+    OCU_CHECK_THROWS(v.at(1), std::out_of_range);
+}
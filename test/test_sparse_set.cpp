@@ -0,0 +1,135 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/object_pool.h>
+#include <open-cpp-utils/sparse_set.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using open_cpp_utils::component_storage;
+using open_cpp_utils::sparse_set;
+
+OCU_TEST("sparse_set/matches_std_set")
+{
+    sparse_set<std::uint32_t> set;
+    std::set<std::uint32_t>   ref;
+    std::mt19937              rng(3);
+
+    for(int i = 0; i < 20000; ++i)
+    {
+        // Keys cluster in two ranges far apart so several pages stay unallocated
+        const std::uint32_t key = (rng() & 1 ? 0u : 1u << 20) + rng() % 3000;
+        if(rng() % 3 == 0)
+        {
+            OCU_CHECK(set.erase(key) == (ref.erase(key) == 1));
+        }
+        else
+        {
+            OCU_CHECK(set.insert(key).second == ref.insert(key).second);
+        }
+    }
+
+    OCU_REQUIRE(set.size() == ref.size());
+    for(const std::uint32_t key : ref) OCU_CHECK(set.contains(key));
+    for(std::uint32_t i = 0; i < set.size(); ++i) OCU_CHECK(set.index_of(set.ids()[i]) == i);
+    OCU_CHECK(!set.contains(1u << 30));
+
+    std::vector<std::uint32_t> ids(set.begin(), set.end());
+    std::sort(ids.begin(), ids.end());
+    OCU_CHECK(std::equal(ids.begin(), ids.end(), ref.begin(), ref.end()));
+
+    const open_cpp_utils::dynamic_bitset mask = set.key_mask();
+    OCU_CHECK(mask.count() == ref.size());
+}
+
+OCU_TEST("sparse_set/copy_is_independent")
+{
+    sparse_set<std::uint32_t> a;
+    for(std::uint32_t i = 0; i < 100; ++i) a.insert(i * 7);
+
+    sparse_set<std::uint32_t> b = a;
+    b.erase(0);
+    b.insert(5000);
+    OCU_CHECK(a.contains(0) && !a.contains(5000));
+    OCU_CHECK(!b.contains(0) && b.contains(5000));
+    OCU_CHECK(a.size() == 100 && b.size() == 100);
+}
+
+OCU_TEST("component_storage/components_follow_their_ids")
+{
+    component_storage<std::string, std::uint32_t> names;
+    for(std::uint32_t i = 0; i < 50; ++i) names.emplace(i, std::to_string(i));
+
+    for(std::uint32_t i = 0; i < 50; i += 2) OCU_CHECK(names.erase(i));
+    OCU_CHECK(!names.erase(0));
+    names.emplace(1, "one");
+
+    OCU_REQUIRE(names.size() == 25);
+    OCU_CHECK(names.get(1) == "one");
+    OCU_CHECK(names.find(2) == nullptr);
+
+    std::size_t visited = 0;
+    names.each([&](std::uint32_t id, const std::string& name)
+    {
+        ++visited;
+        OCU_CHECK(id == 1 ? name == "one" : name == std::to_string(id));
+    });
+    OCU_CHECK(visited == 25);
+}
+
+OCU_TEST("component_storage/join_visits_the_intersection")
+{
+    component_storage<int, std::uint32_t>   a;
+    component_storage<float, std::uint32_t> b;
+    for(std::uint32_t i = 0; i < 300; ++i) a.emplace(i, static_cast<int>(i));
+    for(std::uint32_t i = 0; i < 300; i += 3) b.emplace(i, static_cast<float>(i) * 0.5f);
+
+    std::size_t visited = 0;
+    open_cpp_utils::join(a, b).each([&](std::uint32_t id, int& x, float& y)
+    {
+        ++visited;
+        OCU_CHECK(id % 3 == 0);
+        OCU_CHECK(x == static_cast<int>(id) && y == static_cast<float>(id) * 0.5f);
+        x = -1;
+    });
+    OCU_CHECK(visited == 100);
+    OCU_CHECK(a.get(3) == -1 && a.get(4) == 4);
+}
+
+OCU_TEST("sparse_set/same_key_replaces_the_stale_member")
+{
+    open_cpp_utils::object_pool<int> pool;
+    const auto stale = pool.acquire(1);
+    pool.release(stale);
+    const auto fresh = pool.acquire(2);
+    OCU_REQUIRE(stale != fresh);
+
+    sparse_set<open_cpp_utils::pool_handle<int>> set;
+    set.insert(pool.acquire(3));
+    set.insert(stale);
+    OCU_CHECK(set.insert(fresh).second);
+    OCU_CHECK(set.size() == 2);
+    OCU_CHECK(set.contains(fresh) && !set.contains(stale));
+    for(std::uint32_t i = 0; i < set.size(); ++i) OCU_CHECK(set.index_of(set.ids()[i]) == i);
+
+    component_storage<std::string, open_cpp_utils::pool_handle<int>> names;
+    names.emplace(stale, "stale");
+    names.emplace(pool.acquire(4), "other");
+    names.emplace(fresh, "fresh");
+    OCU_REQUIRE(names.size() == 2);
+    OCU_CHECK(names.find(stale) == nullptr);
+    OCU_CHECK(names.get(fresh) == "fresh");
+    names.each([&](open_cpp_utils::pool_handle<int> id, const std::string& name)
+    {
+        OCU_CHECK(id == fresh ? name == "fresh" : name == "other");
+    });
+}
@@ -0,0 +1,84 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/startup.h>
+
+#include <atomic>
+#include <stdexcept>
+
+using open_cpp_utils::run_startup;
+using open_cpp_utils::startup_entry;
+using open_cpp_utils::thread_pool;
+
+namespace
+{
+
+std::atomic<int> g_tick{ 0 };
+int              g_config_at   = -1;
+int              g_window_at   = -1;
+int              g_audio_at    = -1;
+int              g_renderer_at = -1;
+
+}
+
+OCU_STARTUP(renderer, window, config)
+{
+    g_renderer_at = g_tick.fetch_add(1);
+}
+
+OCU_STARTUP(window, config)
+{
+    g_window_at = g_tick.fetch_add(1);
+}
+
+OCU_STARTUP(config)
+{
+    g_config_at = g_tick.fetch_add(1);
+}
+
+OCU_STARTUP(audio)
+{
+    g_audio_at = g_tick.fetch_add(1);
+}
+
+OCU_TEST("startup/runs_each_function_after_its_dependencies")
+{
+    thread_pool pool(2);
+    OCU_CHECK(run_startup(pool) == 4);
+    OCU_CHECK(g_config_at >= 0 && g_audio_at >= 0);
+    OCU_CHECK(g_config_at < g_window_at);
+    OCU_CHECK(g_window_at < g_renderer_at);
+
+    // Everything already ran, so a second call has nothing to do
+    OCU_CHECK(run_startup(pool) == 0);
+    OCU_CHECK(g_tick.load() == 4);
+}
+
+OCU_TEST("startup/late_registration_runs_on_next_call")
+{
+    static int late_ran = 0;
+    static constinit startup_entry late("late", [] { ++late_ran; }, "renderer");
+    static const open_cpp_utils::detail::startup_registrar registrar(late);
+
+    thread_pool pool(2);
+    OCU_CHECK(run_startup(pool) == 1);
+    OCU_CHECK(late_ran == 1);
+}
+
+// Runs last: the broken entry stays registered for the rest of the process
+OCU_TEST("startup/unknown_dependency_is_rejected_before_running")
+{
+    static int ran = 0;
+    static constinit startup_entry fine("fine", [] { ++ran; }, "");
+    static constinit startup_entry broken("broken", [] { ++ran; }, "nonexistent");
+    static const open_cpp_utils::detail::startup_registrar r1(fine);
+    static const open_cpp_utils::detail::startup_registrar r2(broken);
+
+    thread_pool pool(2);
+    OCU_CHECK_THROWS(run_startup(pool), std::logic_error);
+    OCU_CHECK(ran == 0);
+}
@@ -0,0 +1,127 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+#include "simd_levels.h"
+
+#include <open-cpp-utils/string_utils.h>
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace open_cpp_utils;
+
+namespace
+{
+
+/// Mostly ASCII with runs of multi-byte UTF-8, invalid bytes and delimiters, at lengths around every block size
+std::string random_text(std::mt19937& rng, std::size_t n)
+{
+    static constexpr std::string_view pieces[] = {
+        "a", "Z", " ", ",", "\t", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xc0\xaf", "\xed\xa0\x80", "\xff",
+        "\xf4\x90\x80\x80", "\xe2\x82",
+    };
+
+    std::string s;
+    while(s.size() < n)
+    {
+        const unsigned r = rng() % 64;
+        s += r < 40 ? pieces[r % 5] : pieces[r % std::size(pieces)];
+    }
+    s.resize(n);
+    return s;
+}
+
+}
+
+OCU_TEST("string_utils/kernels_match_scalar")
+{
+    const detail::string_kernels& scalar = detail::string_kernels_for(simd_level::scalar);
+    const byte_set                sets[] = { byte_set(" ,\t"), byte_set("aZ"), byte_set("\xc3\xff"), byte_set("") };
+    std::mt19937                  rng(11);
+
+    for(const simd_level level : test::vector_levels())
+    {
+        const detail::string_kernels& k = detail::string_kernels_for(level);
+        for(int round = 0; round < 2000; ++round)
+        {
+            const std::string a = random_text(rng, rng() % 300);
+            std::string       b = a;
+            for(char& c : b)
+            {
+                if(rng() % 200 == 0) c = static_cast<char>(rng());
+                else if(rng() % 4 == 0) c = ascii_to_upper(c);
+            }
+
+            for(const byte_set& set : sets)
+            {
+                OCU_CHECK(k.find(a.data(), a.size(), set, false) == scalar.find(a.data(), a.size(), set, false));
+                OCU_CHECK(k.find(a.data(), a.size(), set, true) == scalar.find(a.data(), a.size(), set, true));
+                const std::size_t n = std::min<std::size_t>(a.size(), 64);
+                OCU_CHECK(k.mask64(a.data(), n, set) == scalar.mask64(a.data(), n, set));
+            }
+            OCU_CHECK(k.imismatch(a.data(), b.data(), a.size()) == scalar.imismatch(a.data(), b.data(), a.size()));
+            OCU_CHECK(k.utf8(a.data(), a.size()) == scalar.utf8(a.data(), a.size()));
+        }
+    }
+}
+
+OCU_TEST("string_utils/utf8_validation")
+{
+    OCU_CHECK(is_valid_utf8(""));
+    OCU_CHECK(is_valid_utf8("plain ascii"));
+    OCU_CHECK(is_valid_utf8("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 \xf4\x8f\xbf\xbf"));
+    OCU_CHECK(!is_valid_utf8("\xc0\xaf"));              // overlong '/'
+    OCU_CHECK(!is_valid_utf8("\xe0\x80\xaf"));          // overlong 3-byte
+    OCU_CHECK(!is_valid_utf8("\xed\xa0\x80"));          // surrogate
+    OCU_CHECK(!is_valid_utf8("\xf4\x90\x80\x80"));      // past U+10FFFF
+    OCU_CHECK(!is_valid_utf8("\xe2\x82"));              // truncated
+    OCU_CHECK(!is_valid_utf8("\x80"));                  // stray continuation
+    OCU_CHECK(!is_valid_utf8(std::string(100, 'a') + "\xe2\x82"));
+}
+
+OCU_TEST("string_utils/case_insensitive")
+{
+    OCU_CHECK(iequals("Content-Length", "content-LENGTH"));
+    OCU_CHECK(!iequals("abc", "abd"));
+    OCU_CHECK(!iequals("abc", "abcd"));
+    OCU_CHECK(icompare("apple", "Banana") < 0);
+    OCU_CHECK(icompare("ABC", "abc") == 0);
+    OCU_CHECK(icompare("abc", "AB") > 0);
+    OCU_CHECK(ihash("Hello World") == ihash("hELLO wORLD"));
+    OCU_CHECK(ihash("Hello World") != ihash("Hello Worle"));
+    OCU_CHECK(find_first_of("hello, world", byte_set(",")) == 5);
+    OCU_CHECK(find_first_not_of("   x", byte_set(" ")) == 3);
+    OCU_CHECK(find_first_of("abc", byte_set("z")) == std::string_view::npos);
+}
+
+OCU_TEST("string_utils/split")
+{
+    const auto collect = [](split_view v)
+    {
+        std::vector<std::string_view> fields;
+        for(const std::string_view f : v) fields.push_back(f);
+        return fields;
+    };
+
+    OCU_CHECK(collect(split("a,,b", ",")) == (std::vector<std::string_view>{ "a", "", "b" }));
+    OCU_CHECK(collect(split("", ",")) == (std::vector<std::string_view>{ "" }));
+    OCU_CHECK(collect(split("  a  b ", " ", split_mode::skip_empty)) == (std::vector<std::string_view>{ "a", "b" }));
+
+    // Fields that straddle the 64-byte blocks the iterator scans
+    std::string              line;
+    std::vector<std::string> expected;
+    for(int i = 0; i < 100; ++i)
+    {
+        expected.push_back(std::string(static_cast<std::size_t>(i % 13), 'x'));
+        line += expected.back();
+        if(i != 99) line += ';';
+    }
+    const std::vector<std::string_view> fields = collect(split(line, ";"));
+    OCU_REQUIRE(fields.size() == expected.size());
+    for(std::size_t i = 0; i < fields.size(); ++i) OCU_CHECK(fields[i] == expected[i]);
+}
@@ -0,0 +1,108 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/thread_pool.h>
+
+#include <atomic>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using open_cpp_utils::parallel_for;
+using open_cpp_utils::parallel_reduce;
+using open_cpp_utils::task_graph;
+using open_cpp_utils::thread_pool;
+
+OCU_TEST("thread_pool/submit_returns_results")
+{
+    thread_pool pool(4);
+    std::vector<std::future<int>> futures;
+    for(int i = 0; i < 100; ++i) futures.push_back(pool.submit([i] { return i * 2; }));
+    for(int i = 0; i < 100; ++i) OCU_CHECK(futures[static_cast<std::size_t>(i)].get() == i * 2);
+
+    auto failing = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+    OCU_CHECK_THROWS(failing.get(), std::runtime_error);
+}
+
+OCU_TEST("thread_pool/parallel_for_visits_each_index_once")
+{
+    thread_pool pool(4);
+    std::vector<std::atomic<int>> hits(10007);
+    parallel_for(pool, 0, hits.size(), 0, [&](std::size_t i) { hits[i].fetch_add(1); });
+    for(auto& h : hits) OCU_REQUIRE(h.load() == 1);
+
+    std::atomic<std::size_t> total{ 0 };
+    parallel_for(pool, 5, 1005, 64, [&](std::size_t b, std::size_t e) { total.fetch_add(e - b); });
+    OCU_CHECK(total.load() == 1000);
+}
+
+OCU_TEST("thread_pool/parallel_for_rethrows")
+{
+    thread_pool pool(2);
+    OCU_CHECK_THROWS(parallel_for(pool, 0, 1000, 10, [](std::size_t i)
+    {
+        if(i == 517) throw std::runtime_error("index 517");
+    }), std::runtime_error);
+}
+
+OCU_TEST("thread_pool/parallel_reduce_is_ordered")
+{
+    thread_pool pool(4);
+    const auto sum = parallel_reduce(pool, 0, 100000, 0, std::uint64_t(0),
+                                     [](std::size_t i) { return std::uint64_t(i); }, std::plus<>{ });
+    OCU_CHECK(sum == std::uint64_t(99999) * 100000 / 2);
+
+    // Concatenation is not commutative, so this fails if partials are combined out of chunk order
+    const auto text = parallel_reduce(pool, 0, 200, 7, std::string(),
+                                      [](std::size_t i) { return std::string(1, char('a' + i % 26)); }, std::plus<>{ });
+    std::string expected;
+    for(std::size_t i = 0; i < 200; ++i) expected += char('a' + i % 26);
+    OCU_CHECK(text == expected);
+}
+
+OCU_TEST("thread_pool/task_graph_respects_edges")
+{
+    thread_pool pool(4);
+    task_graph graph;
+    std::atomic<int> stage{ 0 };
+    std::atomic<bool> ordered{ true };
+
+    auto a = graph.emplace([&] { stage.store(1); });
+    std::vector<task_graph::node> middle;
+    for(int i = 0; i < 16; ++i)
+    {
+        middle.push_back(graph.emplace([&] { if(stage.load() != 1) ordered.store(false); }));
+        graph.precede(a, middle.back());
+    }
+    auto z = graph.emplace([&] { stage.store(2); });
+    for(auto m : middle) graph.precede(m, z);
+
+    for(int run = 0; run < 20; ++run)
+    {
+        stage.store(0);
+        graph.run(pool);
+        OCU_CHECK(stage.load() == 2);
+    }
+    OCU_CHECK(ordered.load());
+}
+
+OCU_TEST("thread_pool/task_graph_rejects_cycles_and_rethrows")
+{
+    thread_pool pool(2);
+    task_graph cyclic;
+    auto a = cyclic.emplace([] { });
+    auto b = cyclic.emplace([] { });
+    cyclic.precede(a, b);
+    cyclic.precede(b, a);
+    OCU_CHECK_THROWS(cyclic.run(pool), std::logic_error);
+
+    task_graph failing;
+    failing.emplace([] { throw std::runtime_error("node"); });
+    OCU_CHECK_THROWS(failing.run(pool), std::runtime_error);
+}
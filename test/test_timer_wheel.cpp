@@ -0,0 +1,198 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/timer_wheel.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <random>
+#include <vector>
+
+using open_cpp_utils::timer_wheel;
+
+namespace
+{
+
+/// Makes every allocation in this program fail while set, to reach the wheel's out-of-memory paths
+bool fail_allocations = false;
+
+}
+
+void* operator new(std::size_t size)
+{
+    if(fail_allocations) throw std::bad_alloc();
+    if(void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+OCU_TEST("timer_wheel/fires_at_deadline_in_order")
+{
+    timer_wheel<int> wheel;
+    for(int d : { 5, 1, 300, 70000, 3, 1 << 20 }) wheel.schedule_at(static_cast<std::uint64_t>(d), d);
+
+    std::vector<int> fired;
+    wheel.advance_to(4, [&](int v) { fired.push_back(v); });
+    OCU_CHECK(fired == (std::vector<int>{ 1, 3 }));
+    OCU_CHECK(wheel.next_event() == std::uint64_t(5));
+
+    wheel.advance_to(std::uint64_t(1) << 21, [&](int v)
+    {
+        OCU_CHECK(static_cast<std::uint64_t>(v) <= wheel.now());
+        fired.push_back(v);
+    });
+    OCU_CHECK(fired == (std::vector<int>{ 1, 3, 5, 300, 70000, 1 << 20 }));
+    OCU_CHECK(wheel.empty());
+    OCU_CHECK(!wheel.next_event());
+}
+
+OCU_TEST("timer_wheel/cancel_and_reschedule")
+{
+    timer_wheel<int> wheel;
+    auto a = wheel.schedule(10, 1);
+    auto b = wheel.schedule(20, 2);
+    auto c = wheel.schedule(30, 3);
+
+    OCU_CHECK(wheel.cancel(b));
+    OCU_CHECK(!wheel.cancel(b));
+    OCU_CHECK(wheel.reschedule(c, 5));
+    OCU_CHECK(wheel.deadline(c) == 5);
+
+    std::vector<int> fired;
+    wheel.advance(100, [&](int v) { fired.push_back(v); });
+    OCU_CHECK(fired == (std::vector<int>{ 3, 1 }));
+    OCU_CHECK(!wheel.pending(a));
+    OCU_CHECK(!wheel.cancel(a));
+    OCU_CHECK(!wheel.reschedule(a, 1));
+}
+
+OCU_TEST("timer_wheel/matches_reference_under_random_use")
+{
+    timer_wheel<std::uint32_t> wheel;
+    std::multimap<std::uint64_t, std::uint32_t> ref;
+    std::map<std::uint32_t, timer_wheel<std::uint32_t>::timer> handles;
+    std::mt19937_64 rng(4);
+    std::uint32_t next_id = 0;
+
+    for(int step = 0; step < 5000; ++step)
+    {
+        const auto roll = rng() % 10;
+        if(roll < 6)
+        {
+            // Mix of near, mid-level and overflow deadlines
+            const std::uint64_t delay = rng() % 3 == 0 ? rng() % (std::uint64_t(1) << 34) : rng() % 2000;
+            const std::uint64_t deadline = std::max(wheel.now() + delay, wheel.now() + 1);
+            handles[next_id] = wheel.schedule_at(deadline, next_id);
+            ref.emplace(deadline, next_id);
+            ++next_id;
+        }
+        else if(roll < 8 && !handles.empty())
+        {
+            auto it = handles.begin();
+            std::advance(it, static_cast<std::ptrdiff_t>(rng() % handles.size()));
+            OCU_CHECK(wheel.cancel(it->second));
+            for(auto r = ref.begin(); r != ref.end(); ++r)
+            {
+                if(r->second == it->first) { ref.erase(r); break; }
+            }
+            handles.erase(it);
+        }
+        else
+        {
+            const std::uint64_t target = wheel.now() + rng() % 5000;
+            std::uint64_t last_deadline = 0;
+            wheel.advance_to(target, [&](std::uint32_t id)
+            {
+                auto r = ref.begin();
+                OCU_REQUIRE(r != ref.end() && r->first <= target);
+                // Timers sharing a tick may fire in any order
+                auto match = r;
+                while(match != ref.end() && match->first == r->first && match->second != id) ++match;
+                OCU_REQUIRE(match != ref.end() && match->first == r->first);
+                OCU_CHECK(match->first >= last_deadline);
+                last_deadline = match->first;
+                ref.erase(match);
+                handles.erase(id);
+            });
+            OCU_CHECK(ref.empty() || ref.begin()->first > target);
+        }
+        OCU_REQUIRE(wheel.size() == ref.size());
+    }
+}
+
+OCU_TEST("timer_wheel/callbacks_can_schedule")
+{
+    timer_wheel<> wheel;
+    int count = 0;
+    std::function<void()> again = [&]
+    {
+        if(++count < 10) wheel.schedule(1, again);
+    };
+    wheel.schedule(1, again);
+    wheel.advance_to(100);
+    OCU_CHECK(count == 10);
+    OCU_CHECK(wheel.empty());
+}
+
+OCU_TEST("timer_wheel/stale_handles_do_not_match_reused_slots")
+{
+    timer_wheel<int> wheel;
+    const auto stale = wheel.schedule(10, 0);
+    OCU_REQUIRE(wheel.cancel(stale));
+    // The pool hands the same slot back every time, so its 8-bit generation wraps well within this loop
+    for(int i = 1; i <= 300; ++i)
+    {
+        const auto fresh = wheel.schedule(10, i);
+        OCU_CHECK(!wheel.pending(stale));
+        OCU_CHECK(!wheel.cancel(stale));
+        OCU_CHECK(!wheel.reschedule(stale, 50));
+        OCU_REQUIRE(wheel.pending(fresh));
+        OCU_CHECK(wheel.deadline(fresh) == 10);
+        OCU_REQUIRE(wheel.cancel(fresh));
+    }
+    OCU_CHECK(wheel.empty());
+}
+
+OCU_TEST("timer_wheel/failed_allocation_keeps_timers_linked")
+{
+    timer_wheel<int> wheel;
+    const auto t = wheel.schedule_at(5, 5);
+
+    bool rescheduled = true;
+    bool scheduled   = true;
+    fail_allocations = true;
+    try
+    {
+        wheel.reschedule_at(t, 10);
+    }
+    catch(const std::bad_alloc&)
+    {
+        rescheduled = false;
+    }
+    try
+    {
+        static_cast<void>(wheel.schedule_at(20, 20));
+    }
+    catch(const std::bad_alloc&)
+    {
+        scheduled = false;
+    }
+    fail_allocations = false;
+
+    OCU_REQUIRE(!rescheduled && !scheduled);
+    OCU_CHECK(wheel.pending(t) && wheel.deadline(t) == 5);
+    OCU_CHECK(wheel.size() == 1);
+
+    std::vector<int> fired;
+    wheel.advance_to(30, [&](int v) { fired.push_back(v); });
+    OCU_CHECK(fired == (std::vector<int>{ 5 }));
+    OCU_CHECK(wheel.empty());
+}
@@ -0,0 +1,84 @@
+// =====================================================================================================================
+// open-cpp-utils - Open Source Utilities for C++
+// Licensed under the Apache License, Version 2.0. See LICENSE in the project root for details.
+// =====================================================================================================================
+
+#include "harness.h"
+
+#include <open-cpp-utils/unique_id.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using open_cpp_utils::snowflake_generator;
+using open_cpp_utils::unique_id;
+
+namespace
+{
+
+struct threaded_tag;
+struct small_tag;
+
+}
+
+OCU_TEST("unique_id/never_null_and_distinct")
+{
+    using id = unique_id<small_tag, std::uint32_t>;
+    OCU_CHECK(!id());
+
+    std::set<std::uint32_t> values;
+    for(int i = 0; i < 10000; ++i)
+    {
+        const id v = id::next();
+        OCU_REQUIRE(v);
+        OCU_CHECK(values.insert(v.value()).second);
+    }
+    OCU_CHECK(id::from_value(42).value() == 42);
+}
+
+OCU_TEST("unique_id/distinct_across_threads")
+{
+    using id = unique_id<threaded_tag>;
+    std::mutex mutex;
+    std::vector<std::uint64_t> all;
+    std::vector<std::thread> threads;
+
+    for(int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&]
+        {
+            std::vector<std::uint64_t> local;
+            for(int i = 0; i < 20000; ++i) local.push_back(id::next().value());
+            std::lock_guard lock(mutex);
+            all.insert(all.end(), local.begin(), local.end());
+        });
+    }
+    for(auto& t : threads) t.join();
+
+    std::sort(all.begin(), all.end());
+    OCU_CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+    OCU_CHECK(all.front() != 0);
+}
+
+OCU_TEST("unique_id/snowflake_increases_and_decomposes")
+{
+    snowflake_generator gen(513);
+    std::uint64_t last = 0;
+    for(int i = 0; i < 20000; ++i)
+    {
+        const std::uint64_t v = gen.next();
+        OCU_REQUIRE(v > last);
+        last = v;
+        OCU_CHECK(snowflake_generator::decompose(v).node == 513);
+    }
+
+    const auto age = std::chrono::system_clock::now() - gen.time_of(last);
+    OCU_CHECK(age < std::chrono::minutes(1));
+    OCU_CHECK(age > -std::chrono::minutes(1));
+    OCU_CHECK_THROWS(snowflake_generator(snowflake_generator::max_node + 1), std::invalid_argument);
+}